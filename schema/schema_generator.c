@@ -94,24 +94,32 @@ int main(int argc, char** argv)
 		"\tfloat w = 4;\n"
 		"}\n");
 
-	GHashTableIter iter;
-	const char* typeName;
-	ShovelerComponentType* componentType;
-	g_hash_table_iter_init(&iter, schema->componentTypes);
-	while (g_hash_table_iter_next(&iter, (gpointer*) &typeName, (gpointer*) &componentType)) {
-		int componentId = shovelerClientResolveComponentSchemaId(componentType->id);
+	for (guint index = 0; index < schema->componentTypes->len; index++) {
+		ShovelerComponentType* componentType = g_array_index(schema->componentTypes, ShovelerComponentType*, index);
+		if (componentType == NULL) {
+			continue;
+		}
+
+		// the client decodes components with the same descriptor, see spatialos_client_schema.h
+		const ShovelerClientSchemaComponentDescriptor* descriptor = shovelerClientGetSchemaComponentDescriptor(componentType);
 		GString* componentName = toUpperCamelCase(componentType->id);
-		g_string_append_printf(spatialosSchema, "component %s {\n\tid = %d;\n", componentName->str, componentId);
+		g_string_append_printf(spatialosSchema, "component %s {\n\tid = %d;\n", componentName->str, descriptor->schemaComponentId);
 		g_string_free(componentName, true);
 
-		for (int i = 0; i < componentType->numFields; i++) {
-			ShovelerComponentField* field = &componentType->fields[i];
+		for (int i = 0; i < descriptor->numFields; i++) {
+			const ShovelerClientSchemaFieldDescriptor* fieldDescriptor = &descriptor->fields[i];
 			g_string_append_printf(spatialosSchema, "\t%s%s%s %s = %d;\n",
-				field->isOptional ? "option<" : "",
-				fieldTypeToString(field->type),
-				field->isOptional ? ">" : "",
-				field->name,
-				i + 1);
+				fieldDescriptor->isOptional ? "option<" : "",
+				fieldTypeToString(fieldDescriptor->type),
+				fieldDescriptor->isOptional ? ">" : "",
+				fieldDescriptor->name,
+				fieldDescriptor->schemaFieldId);
+		}
+
+		if (componentType->id == shovelerComponentTypeIdPosition) {
+			// compact alternative to the coordinates field, see shoveler/position_encoding.h
+			g_string_append_printf(spatialosSchema, "\toption<uint64> quantized_origin = %d;\n", componentType->numFields + 1);
+			g_string_append_printf(spatialosSchema, "\toption<bytes> quantized_delta = %d;\n", componentType->numFields + 2);
 		}
 
 		g_string_append(spatialosSchema, "}\n\n");
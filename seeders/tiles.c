@@ -80,6 +80,8 @@ int main(int argc, char **argv)
 			query, shovelerWorkerSchemaComponentIdClientHeartbeatPing);
 		shovelerWorkerSchemaAddImprobableInterestQueryResultComponentId(
 			query, shovelerWorkerSchemaComponentIdClientInfo);
+		shovelerWorkerSchemaAddImprobableInterestQueryResultComponentId(
+			query, shovelerWorkerSchemaComponentIdPosition);
 
 		if(!writeEntity(snapshotOutputStream, &entity)) {
 			return EXIT_FAILURE;
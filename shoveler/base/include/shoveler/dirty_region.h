@@ -0,0 +1,45 @@
+#ifndef SHOVELER_DIRTY_REGION_H
+#define SHOVELER_DIRTY_REGION_H
+
+#include <stdbool.h> // bool
+
+#define SHOVELER_DIRTY_REGION_MAX_RECTANGLES 4
+
+/** Rectangle of texels [minX, maxX) x [minY, maxY). */
+typedef struct {
+  unsigned int minX;
+  unsigned int minY;
+  unsigned int maxX;
+  unsigned int maxY;
+} ShovelerDirtyRectangle;
+
+/**
+ * Set of rectangles covering everything that changed in an image since it was last uploaded.
+ *
+ * Added rectangles are merged with existing ones as long as that doesn't cover more texels than
+ * keeping them separate, e.g. if they overlap or are adjacent, so that writing the same area
+ * repeatedly only keeps one rectangle. Once the maximum number of rectangles is reached, the
+ * added one is merged with the rectangle it grows the least instead, which keeps the number of
+ * uploads per image bounded at the cost of uploading some unchanged texels.
+ */
+typedef struct {
+  int numRectangles;
+  ShovelerDirtyRectangle rectangles[SHOVELER_DIRTY_REGION_MAX_RECTANGLES];
+} ShovelerDirtyRegion;
+
+void shovelerDirtyRegionAdd(
+    ShovelerDirtyRegion* region,
+    unsigned int x,
+    unsigned int y,
+    unsigned int width,
+    unsigned int height);
+
+static inline void shovelerDirtyRegionClear(ShovelerDirtyRegion* region) {
+  region->numRectangles = 0;
+}
+
+static inline bool shovelerDirtyRegionIsEmpty(const ShovelerDirtyRegion* region) {
+  return region->numRectangles == 0;
+}
+
+#endif
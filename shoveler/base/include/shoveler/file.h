@@ -4,9 +4,27 @@
 #include <stdbool.h>
 #include <stddef.h> // size_t
 
+/**
+ * Read-only view of a file's contents.
+ *
+ * The data is memory mapped where possible, and otherwise read into a buffer owned by the mapped
+ * file. Either way it is borrowed from the mapped file, so it must not be modified and is only
+ * valid until the file is unmapped.
+ */
+typedef struct {
+  const unsigned char* data;
+  size_t size;
+  /** true if the data is memory mapped, false if it was read into a buffer instead */
+  bool mapped;
+} ShovelerMappedFile;
+
+/** Reads a file into a newly allocated, NUL terminated buffer to be freed with free. */
 bool shovelerFileRead(
     const char* filename, unsigned char** contentsPointer, size_t* contentsSizePointer);
 char* shovelerFileReadString(const char* filename);
+/** Maps a file read-only, falling back to reading it if mapping isn't possible. */
+ShovelerMappedFile* shovelerFileMap(const char* filename);
+void shovelerFileUnmap(ShovelerMappedFile* mappedFile);
 bool shovelerFileWrite(const char* filename, unsigned char* contents, size_t contentsSize);
 bool shovelerFileWriteString(const char* filename, const char* string);
 
@@ -6,6 +6,7 @@
 #include FT_FREETYPE_H
 
 #include <glib.h>
+#include <shoveler/file.h>
 
 typedef struct ShovelerFontsStruct {
   FT_Library library;
@@ -17,6 +18,11 @@ typedef struct ShovelerFontStruct {
   ShovelerFonts* fonts;
   char* name;
   FT_Face face;
+  /* buffer the font was loaded from, which the caller or the mapped file keeps alive */
+  const unsigned char* buffer;
+  int bufferSize;
+  /* mapping of the file the font was loaded from, or NULL if it was loaded from a buffer */
+  ShovelerMappedFile* mappedFile;
 } ShovelerFont;
 
 ShovelerFonts* shovelerFontsCreate();
@@ -25,6 +31,11 @@ ShovelerFont* shovelerFontsLoadFontFile(
 ShovelerFont* shovelerFontsLoadFontBuffer(
     ShovelerFonts* fonts, const char* name, const unsigned char* buffer, int bufferSize);
 bool shovelerFontsUnloadFont(ShovelerFonts* fonts, const char* name);
+/**
+ * Opens another face of the font from the same source in the given library, e.g. to rasterize
+ * glyphs on a different thread since faces can't be shared between threads.
+ */
+FT_Error shovelerFontOpenFace(ShovelerFont* font, FT_Library library, FT_Face* outputFace);
 void shovelerFontsFree(ShovelerFonts* fonts);
 
 #endif
@@ -2,6 +2,7 @@
 #define SHOVELER_FONT_ATLAS_H
 
 #include <glib.h>
+#include <stdbool.h> // bool
 #include <stdint.h> // uint32_t
 
 typedef struct ShovelerFontStruct ShovelerFont; // forward declaration: font.h
@@ -36,8 +37,45 @@ typedef struct ShovelerFontAtlasStruct {
   GHashTable* glyphs;
 } ShovelerFontAtlas;
 
+typedef void(ShovelerFontAtlasTaskFunction)(int taskIndex, void* taskUserData);
+typedef void(ShovelerFontAtlasRasterizeAdapterRunFunction)(
+    int numTasks, ShovelerFontAtlasTaskFunction* task, void* taskUserData, void* userData);
+
+// Adapter struct to make bulk glyph insertion rasterize glyphs on some worker pool.
+typedef struct ShovelerFontAtlasRasterizeAdapterStruct {
+  /**
+   * Calls task for every task index in [0, numTasks) on any threads, and returns once all of them
+   * have finished and their writes are visible to the calling thread.
+   */
+  ShovelerFontAtlasRasterizeAdapterRunFunction* run;
+  /** Number of tasks to split rasterization into, e.g. the number of worker threads. */
+  int numTasks;
+  void* userData;
+} ShovelerFontAtlasRasterizeAdapter;
+
 ShovelerFontAtlas* shovelerFontAtlasCreate(ShovelerFont* font, int fontSize, int padding);
 ShovelerFontAtlasGlyph* shovelerFontAtlasGetGlyph(ShovelerFontAtlas* fontAtlas, uint32_t codePoint);
+/**
+ * Rasterizes all given code points not in the atlas yet and inserts them in one go, returning the
+ * number of glyphs added.
+ *
+ * Compared to getting them one by one, the glyphs are inserted tallest first for tighter packing,
+ * and the atlas image is grown at most once up front rather than doubled repeatedly. If an adapter
+ * is passed, rasterization runs on its tasks, each opening its own face of the font.
+ */
+int shovelerFontAtlasAddGlyphs(
+    ShovelerFontAtlas* fontAtlas,
+    const uint32_t* codePoints,
+    int numCodePoints,
+    ShovelerFontAtlasRasterizeAdapter* adapter);
+/** Adds the glyphs of all code points in [firstCodePoint, lastCodePoint] in bulk. */
+int shovelerFontAtlasAddGlyphRange(
+    ShovelerFontAtlas* fontAtlas,
+    uint32_t firstCodePoint,
+    uint32_t lastCodePoint,
+    ShovelerFontAtlasRasterizeAdapter* adapter);
+/** Returns the fraction of the atlas image covered by glyphs, including their padding. */
+double shovelerFontAtlasGetDensity(ShovelerFontAtlas* fontAtlas);
 void shovelerFontAtlasValidateState(ShovelerFontAtlas* fontAtlas);
 void shovelerFontAtlasFree(ShovelerFontAtlas* fontAtlas);
 
@@ -2,12 +2,15 @@
 #define SHOVELER_IMAGE_H
 
 #include <shoveler/color.h>
+#include <shoveler/dirty_region.h>
 
 typedef struct ShovelerImageStruct {
   unsigned int width;
   unsigned int height;
   unsigned int channels;
   unsigned char* data;
+  /* texels changed since the image was last uploaded, consumed by the texture uploading it */
+  ShovelerDirtyRegion dirtyRegion;
 } ShovelerImage;
 
 ShovelerImage* shovelerImageCreate(unsigned int width, unsigned int height, unsigned int channels);
@@ -22,6 +25,9 @@ void shovelerImageSet(ShovelerImage* image, ShovelerColor color, unsigned char a
 void shovelerImageAddFrame(ShovelerImage* image, unsigned int size, ShovelerColor color);
 void shovelerImageAddSubImage(
     ShovelerImage* image, int xOffset, int yOffset, ShovelerImage* subImage);
+/** Marks texels as changed after writing them directly, e.g. through shovelerImageGet. */
+void shovelerImageMarkDirty(
+    ShovelerImage* image, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
 void shovelerImageFree(ShovelerImage* image);
 
 #define shovelerImageGet(image, x, y, c) \
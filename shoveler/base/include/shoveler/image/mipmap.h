@@ -0,0 +1,43 @@
+#ifndef SHOVELER_IMAGE_MIPMAP_H
+#define SHOVELER_IMAGE_MIPMAP_H
+
+#include <shoveler/image.h>
+
+typedef enum {
+  /* averages each 2x2 block of stored values, like glGenerateMipmap on a non-sRGB texture */
+  SHOVELER_IMAGE_MIPMAP_FILTER_BOX,
+  /*
+   * averages the color channels of RGB and RGBA images in linear space, treating them as sRGB
+   * encoded, so that downscaled detail doesn't darken. Alpha and the channels of one and two
+   * channel images, which hold coverage or other data rather than colors, are box filtered.
+   */
+  SHOVELER_IMAGE_MIPMAP_FILTER_GAMMA_CORRECT,
+} ShovelerImageMipmapFilter;
+
+/**
+ * Full mip chain of an image, computed on the CPU so that it can be built away from the render
+ * thread and uploaded with the image instead of having the driver generate it.
+ *
+ * Each level halves the previous one, rounding down but never below one pixel, down to a single
+ * pixel, which matches the levels allocated for a texture of the image. A level's pixel is the
+ * average of the 2x2 block at twice its coordinates, where coordinates past the last row or
+ * column are clamped to it, so that odd sizes drop their last row or column and a single pixel
+ * wide level averages its pixels with themselves. Averages round to nearest, with ties rounding
+ * up, so results are bit-exact across platforms.
+ */
+typedef struct ShovelerImageMipmapsStruct {
+  int numLevels;
+  /* level 0 is the image the chain was built from and is borrowed, all other levels are owned */
+  ShovelerImage** levels;
+} ShovelerImageMipmaps;
+
+int shovelerImageMipmapGetNumLevels(unsigned int width, unsigned int height);
+/** Creates the next smaller mip level of an image. */
+ShovelerImage* shovelerImageMipmapCreateLevel(
+    ShovelerImage* image, ShovelerImageMipmapFilter filter);
+/** Builds the mip chain of an image, which must outlive it. Safe to call from any thread. */
+ShovelerImageMipmaps* shovelerImageMipmapsCreate(
+    ShovelerImage* image, ShovelerImageMipmapFilter filter);
+void shovelerImageMipmapsFree(ShovelerImageMipmaps* mipmaps);
+
+#endif
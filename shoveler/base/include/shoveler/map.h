@@ -12,12 +12,16 @@ typedef struct {
   ShovelerMapChunk* chunks;
 } ShovelerMap;
 
+typedef bool(ShovelerMapTilePredicate)(ShovelerMapTileData tileData, void* userData);
+
 bool shovelerMapEntityHandleToChunkCoordinates(
     int64_t entityHandle,
     int64_t firstChunkEntityHandle,
     ShovelerMapDimensions dimensions,
     int* outputChunkX,
     int* outputChunkY);
+/** Creates a map of empty chunks, all tiles of which are zeroed. */
+ShovelerMap* shovelerMapCreate(int chunkSize, int numChunkRows, int numChunkColumns);
 ShovelerMap* shovelerMapGenerate(int chunkSize, int numChunkRows, int numChunkColumns);
 bool shovelerMapCheckTileCollision(
     ShovelerMap* map, ShovelerVector2 position, ShovelerVector2 size);
@@ -29,6 +33,21 @@ void shovelerMapWriteTile(
     ShovelerMapTileCoordinate tile,
     bool background,
     ShovelerMapTileData tileData);
+/**
+ * Appends the coordinates of all tiles in the given region of chunks that match the predicate to
+ * outputTiles, an array of ShovelerMapTileCoordinate. The region is clamped to the map, and each
+ * chunk is scanned directly on its tile arrays. Returns the number of appended tiles.
+ */
+int shovelerMapCollectTiles(
+    ShovelerMap* map,
+    int minChunkX,
+    int minChunkY,
+    int numChunksX,
+    int numChunksY,
+    bool background,
+    ShovelerMapTilePredicate* predicate,
+    void* userData,
+    GArray* outputTiles);
 ShovelerMapChunk* shovelerMapGetChunk(ShovelerMap* map, int chunkX, int chunkY);
 void shovelerMapFree(ShovelerMap* map);
 
@@ -2,6 +2,8 @@
 #define SHOVELER_RESOURCES_H
 
 #include <glib.h>
+#include <stdbool.h> // bool
+#include <stddef.h> // size_t
 
 struct ShovelerResourcesTypeLoaderStruct; // forward declaration
 struct ShovelerResourcesStruct; // forward declaration
@@ -14,6 +16,14 @@ typedef struct {
   const char* typeId;
   /** type specific resource data */
   void* data;
+  /** bytes of loaded resource data counted against the type's budget, zero while not loaded */
+  size_t numBytes;
+  /** whether the resource was requested and hasn't been loaded since */
+  bool isRequested;
+  /** number of acquired references that haven't been released yet */
+  int numReferences;
+  /** link in the type's queue of evictable resources, or NULL if it isn't evictable */
+  GList* evictableLink;
 } ShovelerResource;
 
 typedef void*(ShovelerResourcesTypeLoaderLoadFunction)(
@@ -22,6 +32,8 @@ typedef void*(ShovelerResourcesTypeLoaderLoadFunction)(
     int bufferSize);
 typedef void(ShovelerResourcesTypeLoaderFreeResourceFunction)(
     struct ShovelerResourcesTypeLoaderStruct* typeLoader, void* resourceData);
+typedef size_t(ShovelerResourcesTypeLoaderGetSizeFunction)(
+    struct ShovelerResourcesTypeLoaderStruct* typeLoader, void* resourceData);
 typedef void(ShovelerResourcesTypeLoaderFreeFunction)(
     struct ShovelerResourcesTypeLoaderStruct* typeLoader);
 
@@ -32,10 +44,32 @@ typedef struct ShovelerResourcesTypeLoaderStruct {
   void* defaultResourceData;
   void* data;
   ShovelerResourcesTypeLoaderLoadFunction* load;
+  /** optional, returns the bytes of memory used by loaded resource data, otherwise the size of the
+   * buffer it was loaded from is used */
+  ShovelerResourcesTypeLoaderGetSizeFunction* getSize;
   ShovelerResourcesTypeLoaderFreeResourceFunction* freeResourceData;
   ShovelerResourcesTypeLoaderFreeFunction* free;
 } ShovelerResourcesTypeLoader;
 
+typedef struct {
+  /** gets and acquires of loaded resources */
+  int numHits;
+  /** gets and acquires of resources that weren't loaded (yet) */
+  int numMisses;
+  int numEvictions;
+  size_t numResidentBytes;
+} ShovelerResourcesStatistics;
+
+/** Bookkeeping for a registered type loader, owned by the resources. */
+typedef struct {
+  ShovelerResourcesTypeLoader typeLoader;
+  /** maximum bytes of loaded resource data to keep, or zero to never evict */
+  size_t budgetBytes;
+  /** queue of loaded but unreferenced (ShovelerResource *), least recently used first */
+  GQueue* evictableResources;
+  ShovelerResourcesStatistics statistics;
+} ShovelerResourcesType;
+
 typedef void(ShovelerResourcesRequestFunction)(
     struct ShovelerResourcesStruct* resources,
     const char* typeId,
@@ -45,24 +79,53 @@ typedef void(ShovelerResourcesRequestFunction)(
 typedef struct ShovelerResourcesStruct {
   ShovelerResourcesRequestFunction* request;
   void* requestUserData;
-  /** map from (const char *) resource type id to (ShovelerResourcesTypeLoader *) */
-  GHashTable* typeLoaders;
+  /** map from (const char *) resource type id to (ShovelerResourcesType *) */
+  GHashTable* types;
   /** map from (char *) resource id to (ShovelerResource *) */
   GHashTable* resources;
 } ShovelerResources;
 
+/**
+ * Creates a resources store that loads resources on demand.
+ *
+ * Getting or acquiring a resource that isn't loaded returns it with its type's default data and
+ * calls the request function, which may fulfil the request right away or later by calling
+ * shovelerResourcesSet. Once set, the resource's data is replaced in place.
+ *
+ * Types can be given a byte budget. Loaded resources that aren't referenced then have their data
+ * evicted in least recently used order whenever their type exceeds it, which reverts them to the
+ * type's default data until they are requested and set again the next time they are needed.
+ * Resources themselves are only freed along with the store, so pointers returned by
+ * shovelerResourcesGet stay valid, but their data must be acquired to be kept loaded.
+ */
 ShovelerResources* shovelerResourcesCreate(
     ShovelerResourcesRequestFunction* request, void* userData);
 bool shovelerResourcesRegisterTypeLoader(
     ShovelerResources* resources, ShovelerResourcesTypeLoader typeLoader);
+/** Sets the byte budget for loaded resources of a type, evicting right away if it is exceeded. */
+bool shovelerResourcesSetTypeBudget(
+    ShovelerResources* resources, const char* typeId, size_t budgetBytes);
 ShovelerResource* shovelerResourcesGet(
     ShovelerResources* resources, const char* typeId, const char* resourceId);
+/** Like get, but also takes a reference that prevents eviction until it is released. */
+ShovelerResource* shovelerResourcesAcquire(
+    ShovelerResources* resources, const char* typeId, const char* resourceId);
+void shovelerResourcesRelease(ShovelerResources* resources, ShovelerResource* resource);
 bool shovelerResourcesSet(
     ShovelerResources* resources,
     const char* typeId,
     const char* resourceId,
     const unsigned char* buffer,
     int bufferSize);
+/** Like set, but loads the resource straight from a memory mapped file. */
+bool shovelerResourcesSetFile(
+    ShovelerResources* resources,
+    const char* typeId,
+    const char* resourceId,
+    const char* filename);
+/** Returns the statistics of the given type, or summed over all types if typeId is NULL. */
+ShovelerResourcesStatistics shovelerResourcesGetStatistics(
+    ShovelerResources* resources, const char* typeId);
 void shovelerResourcesFree(ShovelerResources* resources);
 
 #endif
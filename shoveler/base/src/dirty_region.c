@@ -0,0 +1,85 @@
+#include "shoveler/dirty_region.h"
+
+#include <assert.h> // assert
+#include <limits.h> // UINT_MAX
+
+static ShovelerDirtyRectangle getUnion(ShovelerDirtyRectangle a, ShovelerDirtyRectangle b);
+static unsigned long long getArea(ShovelerDirtyRectangle rectangle);
+static void removeRectangle(ShovelerDirtyRegion* region, int index);
+
+void shovelerDirtyRegionAdd(
+    ShovelerDirtyRegion* region,
+    unsigned int x,
+    unsigned int y,
+    unsigned int width,
+    unsigned int height) {
+  assert(UINT_MAX - x >= width);
+  assert(UINT_MAX - y >= height);
+
+  if (width == 0 || height == 0) {
+    return;
+  }
+
+  ShovelerDirtyRectangle rectangle;
+  rectangle.minX = x;
+  rectangle.minY = y;
+  rectangle.maxX = x + width;
+  rectangle.maxY = y + height;
+
+  // merging can make the rectangle mergeable with others, so repeat until nothing changes
+  bool merged = true;
+  while (merged) {
+    merged = false;
+
+    for (int i = 0; i < region->numRectangles; i++) {
+      ShovelerDirtyRectangle merge = getUnion(region->rectangles[i], rectangle);
+      if (getArea(merge) <= getArea(region->rectangles[i]) + getArea(rectangle)) {
+        removeRectangle(region, i);
+        rectangle = merge;
+        merged = true;
+        break;
+      }
+    }
+
+    if (!merged && region->numRectangles == SHOVELER_DIRTY_REGION_MAX_RECTANGLES) {
+      int bestIndex = 0;
+      unsigned long long bestGrowth = ULLONG_MAX;
+      for (int i = 0; i < region->numRectangles; i++) {
+        unsigned long long growth =
+            getArea(getUnion(region->rectangles[i], rectangle)) - getArea(region->rectangles[i]);
+        if (growth < bestGrowth) {
+          bestIndex = i;
+          bestGrowth = growth;
+        }
+      }
+
+      rectangle = getUnion(region->rectangles[bestIndex], rectangle);
+      removeRectangle(region, bestIndex);
+      merged = true;
+    }
+  }
+
+  assert(region->numRectangles < SHOVELER_DIRTY_REGION_MAX_RECTANGLES);
+  region->rectangles[region->numRectangles] = rectangle;
+  region->numRectangles++;
+}
+
+static ShovelerDirtyRectangle getUnion(ShovelerDirtyRectangle a, ShovelerDirtyRectangle b) {
+  ShovelerDirtyRectangle result;
+  result.minX = a.minX < b.minX ? a.minX : b.minX;
+  result.minY = a.minY < b.minY ? a.minY : b.minY;
+  result.maxX = a.maxX > b.maxX ? a.maxX : b.maxX;
+  result.maxY = a.maxY > b.maxY ? a.maxY : b.maxY;
+  return result;
+}
+
+static unsigned long long getArea(ShovelerDirtyRectangle rectangle) {
+  return (unsigned long long) (rectangle.maxX - rectangle.minX) *
+      (unsigned long long) (rectangle.maxY - rectangle.minY);
+}
+
+/** Removes the rectangle at index by moving the last one into its place. */
+static void removeRectangle(ShovelerDirtyRegion* region, int index) {
+  region->rectangles[index] = region->rectangles[region->numRectangles - 1];
+  region->numRectangles--;
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+extern "C" {
+#include "shoveler/dirty_region.h"
+#include "shoveler/image.h"
+}
+
+class ShovelerDirtyRegionTest : public ::testing::Test {
+public:
+  virtual void SetUp() { shovelerDirtyRegionClear(&region); }
+
+  ShovelerDirtyRegion region;
+};
+
+static void assertRectangle(
+    const ShovelerDirtyRectangle& rectangle,
+    unsigned int minX,
+    unsigned int minY,
+    unsigned int maxX,
+    unsigned int maxY) {
+  ASSERT_EQ(rectangle.minX, minX);
+  ASSERT_EQ(rectangle.minY, minY);
+  ASSERT_EQ(rectangle.maxX, maxX);
+  ASSERT_EQ(rectangle.maxY, maxY);
+}
+
+TEST_F(ShovelerDirtyRegionTest, ignoresEmpty) {
+  shovelerDirtyRegionAdd(&region, 3, 4, 0, 5);
+  shovelerDirtyRegionAdd(&region, 3, 4, 5, 0);
+
+  ASSERT_TRUE(shovelerDirtyRegionIsEmpty(&region));
+}
+
+TEST_F(ShovelerDirtyRegionTest, mergesRepeatedWrites) {
+  for (int i = 0; i < 10; i++) {
+    shovelerDirtyRegionAdd(&region, 2, 3, 1, 1);
+  }
+
+  ASSERT_EQ(region.numRectangles, 1);
+  assertRectangle(region.rectangles[0], 2, 3, 3, 4);
+}
+
+TEST_F(ShovelerDirtyRegionTest, mergesAdjacent) {
+  shovelerDirtyRegionAdd(&region, 0, 0, 2, 2);
+  shovelerDirtyRegionAdd(&region, 2, 0, 2, 2);
+  shovelerDirtyRegionAdd(&region, 0, 2, 4, 1);
+
+  ASSERT_EQ(region.numRectangles, 1);
+  assertRectangle(region.rectangles[0], 0, 0, 4, 3);
+}
+
+TEST_F(ShovelerDirtyRegionTest, mergesContained) {
+  shovelerDirtyRegionAdd(&region, 0, 0, 10, 10);
+  shovelerDirtyRegionAdd(&region, 4, 4, 2, 2);
+
+  ASSERT_EQ(region.numRectangles, 1);
+  assertRectangle(region.rectangles[0], 0, 0, 10, 10);
+}
+
+TEST_F(ShovelerDirtyRegionTest, keepsDistantSeparate) {
+  shovelerDirtyRegionAdd(&region, 0, 0, 1, 1);
+  shovelerDirtyRegionAdd(&region, 100, 100, 1, 1);
+
+  ASSERT_EQ(region.numRectangles, 2);
+  assertRectangle(region.rectangles[0], 0, 0, 1, 1);
+  assertRectangle(region.rectangles[1], 100, 100, 101, 101);
+}
+
+TEST_F(ShovelerDirtyRegionTest, chainsMerges) {
+  shovelerDirtyRegionAdd(&region, 0, 0, 1, 1);
+  shovelerDirtyRegionAdd(&region, 2, 0, 1, 1);
+  // bridges the gap between both, after which they cover exactly one row
+  shovelerDirtyRegionAdd(&region, 1, 0, 1, 1);
+
+  ASSERT_EQ(region.numRectangles, 1);
+  assertRectangle(region.rectangles[0], 0, 0, 3, 1);
+}
+
+TEST_F(ShovelerDirtyRegionTest, boundsNumRectangles) {
+  for (unsigned int i = 0; i < 10; i++) {
+    shovelerDirtyRegionAdd(&region, 10 * i, 10 * i, 1, 1);
+  }
+
+  ASSERT_EQ(region.numRectangles, SHOVELER_DIRTY_REGION_MAX_RECTANGLES);
+
+  // everything written must still be covered
+  for (unsigned int i = 0; i < 10; i++) {
+    bool covered = false;
+    for (int j = 0; j < region.numRectangles; j++) {
+      const ShovelerDirtyRectangle& rectangle = region.rectangles[j];
+      covered = covered || (rectangle.minX <= 10 * i && 10 * i < rectangle.maxX &&
+                            rectangle.minY <= 10 * i && 10 * i < rectangle.maxY);
+    }
+    ASSERT_TRUE(covered) << "texel " << 10 * i << " is not covered";
+  }
+}
+
+TEST_F(ShovelerDirtyRegionTest, imageMutatorsMarkDirty) {
+  ShovelerImage* image = shovelerImageCreate(8, 8, 4);
+  ASSERT_TRUE(shovelerDirtyRegionIsEmpty(&image->dirtyRegion));
+
+  shovelerImageClear(image);
+  ASSERT_EQ(image->dirtyRegion.numRectangles, 1);
+  assertRectangle(image->dirtyRegion.rectangles[0], 0, 0, 8, 8);
+  shovelerDirtyRegionClear(&image->dirtyRegion);
+
+  ShovelerImage* subImage = shovelerImageCreate(4, 4, 4);
+  shovelerImageClear(subImage);
+  shovelerImageAddSubImage(image, 6, -1, subImage);
+  ASSERT_EQ(image->dirtyRegion.numRectangles, 1);
+  assertRectangle(image->dirtyRegion.rectangles[0], 6, 0, 8, 3);
+  shovelerDirtyRegionClear(&image->dirtyRegion);
+
+  shovelerImageAddSubImage(image, 8, 8, subImage);
+  ASSERT_TRUE(shovelerDirtyRegionIsEmpty(&image->dirtyRegion));
+
+  shovelerImageFree(subImage);
+  shovelerImageFree(image);
+}
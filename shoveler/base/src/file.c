@@ -2,14 +2,29 @@
 
 #include <errno.h> // errno
 #include <glib.h>
-#include <stdio.h> // FILE, fopen, feof, fread, fclose
-#include <stdlib.h> // NULL stdlib
+#include <stdio.h> // FILE, fopen, fread, fclose, fileno
+#include <stdlib.h> // NULL malloc realloc free
 #include <string.h> // strdup strerror
+#include <sys/stat.h> // fstat
+
+#ifndef _WIN32
+#include <fcntl.h> // open
+#include <sys/mman.h> // mmap munmap
+#include <unistd.h> // close
+#endif
 
 #include "shoveler/log.h"
 
 #define READ_BUFFER_SIZE 4096
 
+typedef struct {
+  ShovelerMappedFile mappedFile;
+  /** buffer the file was read into if it couldn't be mapped */
+  unsigned char* buffer;
+} MappedFileStorage;
+
+static bool getRegularFileSize(int fileDescriptor, size_t* outputSize);
+
 bool shovelerFileRead(
     const char* filename, unsigned char** contentsPointer, size_t* contentsSizePointer) {
   FILE* file = fopen(filename, "rb");
@@ -18,36 +33,61 @@ bool shovelerFileRead(
     return false;
   }
 
-  GString* contents = g_string_new("");
-  unsigned char buffer[READ_BUFFER_SIZE];
+  // regular files are read in one go into a buffer of the right size, anything else in chunks
+  size_t expectedSize;
+  if (!getRegularFileSize(fileno(file), &expectedSize)) {
+    expectedSize = READ_BUFFER_SIZE;
+  }
 
-  while (!feof(file)) {
-    size_t numBytesRead = fread(buffer, 1, READ_BUFFER_SIZE, file);
+  size_t capacity = expectedSize + 1; // leave room to NUL terminate the contents
+  size_t size = 0;
+  unsigned char* contents = malloc(capacity);
+  while (true) {
+    if (size + 1 == capacity) {
+      // a full buffer usually means a regular file was read completely, so probe for another byte
+      // before growing it
+      int nextByte = fgetc(file);
+      if (nextByte == EOF) {
+        if (ferror(file)) {
+          shovelerLogError(
+              "Error when read file from '%s' after %zu bytes: %s.",
+              filename,
+              size,
+              strerror(errno));
+          free(contents);
+          fclose(file);
+          return false;
+        }
+        break;
+      }
+
+      capacity *= 2;
+      contents = realloc(contents, capacity);
+      contents[size++] = (unsigned char) nextByte;
+    }
+
+    size_t numBytesRead = fread(contents + size, 1, capacity - 1 - size, file);
+    size += numBytesRead;
 
     if (ferror(file)) {
       shovelerLogError(
-          "Error when read file from '%s' after %lu bytes: %s.",
-          filename,
-          contents->len,
-          strerror(errno));
-      g_string_free(contents, true);
+          "Error when read file from '%s' after %zu bytes: %s.", filename, size, strerror(errno));
+      free(contents);
       fclose(file);
       return false;
     }
 
-    g_string_append_len(contents, (gchar*) buffer, numBytesRead);
-
-    if (numBytesRead < READ_BUFFER_SIZE) {
+    if (numBytesRead == 0 || feof(file)) {
       break;
     }
   }
   fclose(file);
+  contents[size] = '\0';
 
-  *contentsPointer = (unsigned char*) contents->str;
-  *contentsSizePointer = contents->len;
+  *contentsPointer = contents;
+  *contentsSizePointer = size;
 
-  shovelerLogInfo("Successfully read %lu bytes from '%s'.", contents->len, filename);
-  g_string_free(contents, false);
+  shovelerLogInfo("Successfully read %zu bytes from '%s'.", size, filename);
   return true;
 }
 
@@ -61,6 +101,70 @@ char* shovelerFileReadString(const char* filename) {
   return (char*) contents;
 }
 
+ShovelerMappedFile* shovelerFileMap(const char* filename) {
+  MappedFileStorage* storage = malloc(sizeof(MappedFileStorage));
+  storage->buffer = NULL;
+
+#ifndef _WIN32
+  int fileDescriptor = open(filename, O_RDONLY);
+  if (fileDescriptor < 0) {
+    shovelerLogError("Failed to map file from '%s': %s.", filename, strerror(errno));
+    free(storage);
+    return NULL;
+  }
+
+  size_t fileSize;
+  if (getRegularFileSize(fileDescriptor, &fileSize) && fileSize > 0) {
+    void* data = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    int mapError = errno;
+    close(fileDescriptor); // the mapping stays valid after closing
+
+    if (data != MAP_FAILED) {
+      storage->mappedFile.data = data;
+      storage->mappedFile.size = fileSize;
+      storage->mappedFile.mapped = true;
+
+      shovelerLogTrace("Mapped %zu bytes from '%s'.", fileSize, filename);
+      return &storage->mappedFile;
+    }
+
+    shovelerLogWarning(
+        "Failed to map file from '%s', reading it instead: %s.", filename, strerror(mapError));
+  } else {
+    // empty or special files can't be mapped
+    close(fileDescriptor);
+  }
+#endif
+
+  size_t size;
+  if (!shovelerFileRead(filename, &storage->buffer, &size)) {
+    free(storage);
+    return NULL;
+  }
+
+  storage->mappedFile.data = storage->buffer;
+  storage->mappedFile.size = size;
+  storage->mappedFile.mapped = false;
+  return &storage->mappedFile;
+}
+
+void shovelerFileUnmap(ShovelerMappedFile* mappedFile) {
+  if (mappedFile == NULL) {
+    return;
+  }
+
+  MappedFileStorage* storage = (MappedFileStorage*) mappedFile;
+
+#ifndef _WIN32
+  if (mappedFile->mapped) {
+    munmap((void*) mappedFile->data, mappedFile->size);
+  }
+#endif
+
+  free(storage->buffer);
+  free(storage);
+}
+
 bool shovelerFileWrite(const char* filename, unsigned char* contents, size_t contentsSize) {
   FILE* file = fopen(filename, "wb+");
   if (file == NULL) {
@@ -84,3 +188,13 @@ bool shovelerFileWrite(const char* filename, unsigned char* contents, size_t con
 bool shovelerFileWriteString(const char* filename, const char* string) {
   return shovelerFileWrite(filename, (unsigned char*) string, strlen(string));
 }
+
+static bool getRegularFileSize(int fileDescriptor, size_t* outputSize) {
+  struct stat fileStat;
+  if (fstat(fileDescriptor, &fileStat) != 0 || (fileStat.st_mode & S_IFMT) != S_IFREG) {
+    return false;
+  }
+
+  *outputSize = (size_t) fileStat.st_size;
+  return true;
+}
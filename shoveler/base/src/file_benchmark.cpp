@@ -0,0 +1,227 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <glib.h>
+
+#include "shoveler/file.h"
+#include "shoveler/log.h"
+}
+
+/**
+ * Benchmark for reading large files, comparing the previous chunked read into a growing buffer
+ * with the preallocated read and with memory mapping.
+ *
+ * Each size gets a generated file in the given directory, which is read repeatedly in every mode.
+ * All modes sum up every byte they read, so that mapped pages are actually faulted in. The files
+ * stay in the page cache after the first repetition, so this measures copying overhead rather
+ * than disk throughput.
+ *
+ * Every measurement is written to stdout as a single line JSON object, so that the output of
+ * repeated runs can be collected and compared over time. Log messages go to stderr.
+ *
+ * Usage: shoveler_base_file_benchmark [--directory=.] [--max-size-mb=256] [--repetitions=5]
+ */
+
+struct BenchmarkOptions {
+  std::string directory;
+  int maxSizeMb;
+  int repetitions;
+};
+
+enum class ReadMode {
+  kChunked,
+  kRead,
+  kMap,
+};
+
+static bool parseOptions(int argc, char** argv, BenchmarkOptions* options);
+static bool writeFile(const std::string& filename, size_t size);
+static void runReads(const BenchmarkOptions& options, const std::string& filename, size_t size);
+static bool readChunked(const char* filename, unsigned char** contents, size_t* contentsSize);
+static uint64_t sumBytes(const unsigned char* data, size_t size);
+static const char* getModeName(ReadMode mode);
+static double elapsedMs(gint64 startTime);
+
+int main(int argc, char** argv) {
+  BenchmarkOptions options;
+  if (!parseOptions(argc, argv, &options)) {
+    fprintf(
+        stderr,
+        "Usage: %s [--directory=.] [--max-size-mb=256] [--repetitions=5]\n",
+        argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  shovelerLogInit("shoveler/", SHOVELER_LOG_LEVEL_WARNING_UP, stderr);
+
+  for (int sizeMb = 1; sizeMb <= options.maxSizeMb; sizeMb *= 4) {
+    size_t size = (size_t) sizeMb * 1024 * 1024;
+    std::string filename =
+        options.directory + "/shoveler_file_benchmark_" + std::to_string(sizeMb) + "mb.bin";
+    if (!writeFile(filename, size)) {
+      shovelerLogTerminate();
+      return EXIT_FAILURE;
+    }
+
+    runReads(options, filename, size);
+    remove(filename.c_str());
+  }
+
+  shovelerLogTerminate();
+  return EXIT_SUCCESS;
+}
+
+static bool parseOptions(int argc, char** argv, BenchmarkOptions* options) {
+  options->directory = ".";
+  options->maxSizeMb = 256;
+  options->repetitions = 5;
+
+  for (int i = 1; i < argc; i++) {
+    std::string argument = argv[i];
+    size_t separator = argument.find('=');
+    if (argument.compare(0, 2, "--") != 0 || separator == std::string::npos) {
+      return false;
+    }
+
+    std::string name = argument.substr(2, separator - 2);
+    std::string value = argument.substr(separator + 1);
+    if (name == "directory" && !value.empty()) {
+      options->directory = value;
+    } else if (name == "max-size-mb" && atoi(value.c_str()) > 0) {
+      options->maxSizeMb = atoi(value.c_str());
+    } else if (name == "repetitions" && atoi(value.c_str()) > 0) {
+      options->repetitions = atoi(value.c_str());
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static bool writeFile(const std::string& filename, size_t size) {
+  std::vector<unsigned char> contents(size);
+  uint32_t state = 1;
+  for (size_t i = 0; i < size; i++) {
+    state = state * 1664525u + 1013904223u;
+    contents[i] = (unsigned char) (state >> 24);
+  }
+
+  return shovelerFileWrite(filename.c_str(), contents.data(), contents.size());
+}
+
+static void runReads(const BenchmarkOptions& options, const std::string& filename, size_t size) {
+  const ReadMode modes[] = {ReadMode::kChunked, ReadMode::kRead, ReadMode::kMap};
+
+  for (ReadMode mode : modes) {
+    double totalMs = 0.0;
+    double minMs = 0.0;
+    uint64_t sum = 0;
+    bool mapped = false;
+
+    for (int repetition = 0; repetition < options.repetitions; repetition++) {
+      gint64 startTime = g_get_monotonic_time();
+
+      if (mode == ReadMode::kMap) {
+        ShovelerMappedFile* mappedFile = shovelerFileMap(filename.c_str());
+        if (mappedFile == NULL) {
+          return;
+        }
+        sum = sumBytes(mappedFile->data, mappedFile->size);
+        mapped = mappedFile->mapped;
+        shovelerFileUnmap(mappedFile);
+      } else {
+        unsigned char* contents;
+        size_t contentsSize;
+        bool read = mode == ReadMode::kChunked
+            ? readChunked(filename.c_str(), &contents, &contentsSize)
+            : shovelerFileRead(filename.c_str(), &contents, &contentsSize);
+        if (!read) {
+          return;
+        }
+        sum = sumBytes(contents, contentsSize);
+        free(contents);
+      }
+
+      double repetitionMs = elapsedMs(startTime);
+      totalMs += repetitionMs;
+      if (repetition == 0 || repetitionMs < minMs) {
+        minMs = repetitionMs;
+      }
+    }
+
+    double meanMs = totalMs / options.repetitions;
+    printf(
+        "{\"benchmark\": \"file_read\", \"mode\": \"%s\", \"mapped\": %s, \"size_bytes\": %zu, "
+        "\"repetitions\": %d, \"mean_ms\": %.3f, \"min_ms\": %.3f, \"mb_per_s\": %.1f, "
+        "\"checksum\": %llu}\n",
+        getModeName(mode),
+        mapped ? "true" : "false",
+        size,
+        options.repetitions,
+        meanMs,
+        minMs,
+        (double) size / (1024.0 * 1024.0) / (minMs / 1000.0),
+        (unsigned long long) sum);
+    fflush(stdout);
+  }
+}
+
+/** The read implementation before preallocation, appending 4096 byte chunks to a GString. */
+static bool readChunked(const char* filename, unsigned char** contents, size_t* contentsSize) {
+  FILE* file = fopen(filename, "rb");
+  if (file == NULL) {
+    return false;
+  }
+
+  GString* string = g_string_new("");
+  unsigned char buffer[4096];
+  while (!feof(file)) {
+    size_t numBytesRead = fread(buffer, 1, sizeof(buffer), file);
+    if (ferror(file)) {
+      g_string_free(string, true);
+      fclose(file);
+      return false;
+    }
+
+    g_string_append_len(string, (gchar*) buffer, numBytesRead);
+    if (numBytesRead < sizeof(buffer)) {
+      break;
+    }
+  }
+  fclose(file);
+
+  *contents = (unsigned char*) string->str;
+  *contentsSize = string->len;
+  g_string_free(string, false);
+  return true;
+}
+
+static uint64_t sumBytes(const unsigned char* data, size_t size) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < size; i++) {
+    sum += data[i];
+  }
+  return sum;
+}
+
+static const char* getModeName(ReadMode mode) {
+  switch (mode) {
+  case ReadMode::kChunked:
+    return "chunked";
+  case ReadMode::kRead:
+    return "read";
+  case ReadMode::kMap:
+    return "map";
+  }
+
+  return "unknown";
+}
+
+static double elapsedMs(gint64 startTime) {
+  return (double) (g_get_monotonic_time() - startTime) / 1000.0;
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifdef __GLIBC__
+#include <malloc.h> // malloc_usable_size
+#endif
+
+extern "C" {
+#include "shoveler/file.h"
+}
+
+class ShovelerFileTest : public ::testing::Test {
+public:
+  virtual void SetUp() { remove(testFilename); }
+
+  virtual void TearDown() { remove(testFilename); }
+
+  void writeTestFile(const std::string& contents) {
+    bool written = shovelerFileWrite(
+        testFilename, (unsigned char*) contents.data(), contents.size());
+    ASSERT_TRUE(written) << "test file should be written successfully";
+  }
+
+  const char* testFilename = "test.bin";
+};
+
+static std::string createContents(size_t size) {
+  std::string contents(size, '\0');
+  for (size_t i = 0; i < size; i++) {
+    contents[i] = (char) ((i * 31 + 7) % 251);
+  }
+  return contents;
+}
+
+TEST_F(ShovelerFileTest, readLargerThanChunk) {
+  std::string contents = createContents(100000);
+  writeTestFile(contents);
+
+  unsigned char* readContents;
+  size_t readContentsSize;
+  bool read = shovelerFileRead(testFilename, &readContents, &readContentsSize);
+  ASSERT_TRUE(read);
+  ASSERT_EQ(readContentsSize, contents.size());
+  ASSERT_EQ(memcmp(readContents, contents.data(), contents.size()), 0);
+  ASSERT_EQ(readContents[readContentsSize], '\0') << "contents should be NUL terminated";
+
+  free(readContents);
+}
+
+TEST_F(ShovelerFileTest, readWithoutGrowingBuffer) {
+#ifndef __GLIBC__
+  GTEST_SKIP() << "checking the allocated buffer size requires malloc_usable_size";
+#else
+  std::string contents = createContents(100000);
+  writeTestFile(contents);
+
+  unsigned char* readContents;
+  size_t readContentsSize;
+  bool read = shovelerFileRead(testFilename, &readContents, &readContentsSize);
+  ASSERT_TRUE(read);
+  ASSERT_EQ(readContentsSize, contents.size());
+  ASSERT_LT(malloc_usable_size(readContents), 2 * contents.size())
+      << "a regular file should be read into a buffer of its size without growing it";
+
+  free(readContents);
+#endif
+}
+
+TEST_F(ShovelerFileTest, readString) {
+  writeTestFile("hello world");
+
+  char* string = shovelerFileReadString(testFilename);
+  ASSERT_STREQ(string, "hello world");
+
+  free(string);
+}
+
+TEST_F(ShovelerFileTest, readMissing) {
+  unsigned char* readContents;
+  size_t readContentsSize;
+  ASSERT_FALSE(shovelerFileRead(testFilename, &readContents, &readContentsSize));
+  ASSERT_TRUE(shovelerFileMap(testFilename) == NULL);
+}
+
+TEST_F(ShovelerFileTest, map) {
+  std::string contents = createContents(100000);
+  writeTestFile(contents);
+
+  ShovelerMappedFile* mappedFile = shovelerFileMap(testFilename);
+  ASSERT_TRUE(mappedFile != NULL);
+  ASSERT_EQ(mappedFile->size, contents.size());
+  ASSERT_EQ(memcmp(mappedFile->data, contents.data(), contents.size()), 0);
+
+  shovelerFileUnmap(mappedFile);
+}
+
+TEST_F(ShovelerFileTest, mapEmpty) {
+  FILE* file = fopen(testFilename, "wb");
+  ASSERT_TRUE(file != NULL);
+  fclose(file);
+
+  ShovelerMappedFile* mappedFile = shovelerFileMap(testFilename);
+  ASSERT_TRUE(mappedFile != NULL) << "empty files should fall back to reading";
+  ASSERT_EQ(mappedFile->size, 0);
+  ASSERT_FALSE(mappedFile->mapped);
+
+  shovelerFileUnmap(mappedFile);
+}
@@ -1,5 +1,6 @@
 #include "shoveler/font.h"
 
+#include <limits.h> // INT_MAX
 #include <stdlib.h> // malloc free
 #include <string.h> // strdup
 
@@ -29,11 +30,30 @@ ShovelerFont* shovelerFontsLoadFontFile(
     return font;
   }
 
+  // the face reads from the mapped file directly instead of its own copy of the file
+  ShovelerMappedFile* mappedFile = shovelerFileMap(filename);
+  if (mappedFile == NULL) {
+    shovelerLogError("Failed to load font '%s' from '%s'.", name, filename);
+    return NULL;
+  }
+
+  if (mappedFile->size > INT_MAX) {
+    shovelerLogError(
+        "Failed to load font '%s' from '%s': File size %zu is too large.",
+        name,
+        filename,
+        mappedFile->size);
+    shovelerFileUnmap(mappedFile);
+    return NULL;
+  }
+
   FT_Face face;
-  FT_Error error = FT_New_Face(fonts->library, filename, 0, &face);
+  FT_Error error = FT_New_Memory_Face(
+      fonts->library, mappedFile->data, (FT_Long) mappedFile->size, 0, &face);
   if (error != FT_Err_Ok) {
     shovelerLogError(
         "Failed to load font '%s' from '%s': %s", name, filename, FT_Error_String(error));
+    shovelerFileUnmap(mappedFile);
     return NULL;
   }
 
@@ -41,6 +61,9 @@ ShovelerFont* shovelerFontsLoadFontFile(
   font->fonts = fonts;
   font->name = strdup(name);
   font->face = face;
+  font->buffer = mappedFile->data;
+  font->bufferSize = (int) mappedFile->size;
+  font->mappedFile = mappedFile;
   g_hash_table_insert(fonts->fonts, font->name, font);
 
   return font;
@@ -68,6 +91,9 @@ ShovelerFont* shovelerFontsLoadFontBuffer(
   font->fonts = fonts;
   font->name = strdup(name);
   font->face = face;
+  font->buffer = buffer;
+  font->bufferSize = bufferSize;
+  font->mappedFile = NULL;
   g_hash_table_insert(fonts->fonts, font->name, font);
 
   return font;
@@ -77,6 +103,10 @@ bool shovelerFontsUnloadFont(ShovelerFonts* font, const char* name) {
   return g_hash_table_remove(font->fonts, name);
 }
 
+FT_Error shovelerFontOpenFace(ShovelerFont* font, FT_Library library, FT_Face* outputFace) {
+  return FT_New_Memory_Face(library, font->buffer, font->bufferSize, 0, outputFace);
+}
+
 void shovelerFontsFree(ShovelerFonts* fonts) {
   if (fonts == NULL) {
     return;
@@ -93,6 +123,7 @@ static void freeFont(void* fontPointer) {
 
   free(font->name);
   FT_Done_Face(font->face);
+  shovelerFileUnmap(font->mappedFile);
 
   free(font);
 }
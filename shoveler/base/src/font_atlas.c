@@ -2,23 +2,52 @@
 
 #include <assert.h> // assert
 #include <limits.h> // UINT_MAX INT_MAX
-#include <stdlib.h> // malloc free
+#include <stdlib.h> // malloc free qsort
+#include <string.h> // memcpy
 
 #include "shoveler/font.h"
 #include "shoveler/image.h"
 #include "shoveler/log.h"
 
+typedef struct {
+  uint32_t codePoint;
+  unsigned int glyphIndex;
+  bool isRasterized;
+  FT_Bitmap bitmap;
+  int bearingX;
+  int bearingY;
+  int advance;
+} RasterizedGlyph;
+
+typedef struct {
+  ShovelerFontAtlas* fontAtlas;
+  RasterizedGlyph* glyphs;
+  int numGlyphs;
+  int numTasks;
+} RasterizeBatch;
+
+static bool rasterizeGlyph(
+    ShovelerFontAtlas* fontAtlas, FT_Face face, RasterizedGlyph* rasterizedGlyph);
+static ShovelerFontAtlasGlyph* addRasterizedGlyph(
+    ShovelerFontAtlas* fontAtlas, const RasterizedGlyph* rasterizedGlyph);
+static void rasterizeBatchTask(int taskIndex, void* batchPointer);
+static void rasterizeBatchRange(RasterizeBatch* batch, FT_Face face, int begin, int end);
+static int compareRasterizedGlyphHeight(const void* firstPointer, const void* secondPointer);
+static long long int getUsedArea(ShovelerFontAtlas* fontAtlas);
 static void insertGlyph(
     ShovelerFontAtlas* fontAtlas,
     FT_Bitmap glyph,
     int* outputPositionX,
     int* outputPositionY,
     bool* outputIsRotated);
-static void growImage(ShovelerFontAtlas* fontAtlas);
+static void growImage(ShovelerFontAtlas* fontAtlas, int size);
 static void addBitmapToImage(
     ShovelerImage* image, FT_Bitmap bitmap, int bottomLeftX, int bottomLeftY, bool isRotated);
 static ShovelerFontAtlasSkylineEdge* allocateSkylineEdge(int minX, int width, int height);
 
+/* bulk insertion grows the atlas until glyphs would cover at most this fraction of it */
+static const double bulkGrowDensity = 0.8;
+
 ShovelerFontAtlas* shovelerFontAtlasCreate(ShovelerFont* font, int fontSize, int padding) {
   assert(fontSize >= 0);
   assert(padding >= 0);
@@ -57,59 +86,124 @@ ShovelerFontAtlasGlyph* shovelerFontAtlasGetGlyph(
     return glyph;
   }
 
-  FT_Error error = FT_Load_Glyph(fontAtlas->font->face, glyphIndex, FT_LOAD_RENDER);
-  if (error != FT_Err_Ok) {
-    shovelerLogError(
-        "Failed to load missing glyph for font '%s': %s",
-        fontAtlas->font->name,
-        FT_Error_String(error));
+  RasterizedGlyph rasterizedGlyph;
+  rasterizedGlyph.codePoint = codePoint;
+  rasterizedGlyph.glyphIndex = glyphIndex;
+  if (!rasterizeGlyph(fontAtlas, fontAtlas->font->face, &rasterizedGlyph)) {
     return NULL;
   }
 
-  unsigned int bitmapWidth = fontAtlas->font->face->glyph->bitmap.width;
-  if (bitmapWidth > INT_MAX) {
-    shovelerLogError(
-        "Font face glyph bitmap width for code point %u out of bounds: %u",
-        (unsigned int) codePoint,
-        bitmapWidth);
-    return NULL;
+  return addRasterizedGlyph(fontAtlas, &rasterizedGlyph);
+}
+
+int shovelerFontAtlasAddGlyphs(
+    ShovelerFontAtlas* fontAtlas,
+    const uint32_t* codePoints,
+    int numCodePoints,
+    ShovelerFontAtlasRasterizeAdapter* adapter) {
+  GArray* rasterizedGlyphs =
+      g_array_new(/* zeroTerminated */ false, /* clear */ true, sizeof(RasterizedGlyph));
+  // several code points can map to the same glyph, e.g. the missing glyph
+  unsigned int* glyphIndices = malloc(numCodePoints * sizeof(unsigned int));
+  GHashTable* batchGlyphIndices = g_hash_table_new(g_int_hash, g_int_equal);
+  for (int i = 0; i < numCodePoints; i++) {
+    glyphIndices[i] = FT_Get_Char_Index(fontAtlas->font->face, codePoints[i]);
+    if (g_hash_table_contains(fontAtlas->glyphs, &glyphIndices[i]) ||
+        g_hash_table_contains(batchGlyphIndices, &glyphIndices[i])) {
+      continue;
+    }
+    g_hash_table_add(batchGlyphIndices, &glyphIndices[i]);
+
+    RasterizedGlyph rasterizedGlyph = {0};
+    rasterizedGlyph.codePoint = codePoints[i];
+    rasterizedGlyph.glyphIndex = glyphIndices[i];
+    g_array_append_val(rasterizedGlyphs, rasterizedGlyph);
+  }
+  g_hash_table_destroy(batchGlyphIndices);
+  free(glyphIndices);
+
+  RasterizeBatch batch;
+  batch.fontAtlas = fontAtlas;
+  batch.glyphs = (RasterizedGlyph*) rasterizedGlyphs->data;
+  batch.numGlyphs = (int) rasterizedGlyphs->len;
+  batch.numTasks = 1;
+  if (adapter != NULL && adapter->numTasks > 1 && batch.numGlyphs > 1) {
+    batch.numTasks = adapter->numTasks < batch.numGlyphs ? adapter->numTasks : batch.numGlyphs;
+    adapter->run(batch.numTasks, rasterizeBatchTask, &batch, adapter->userData);
+  } else {
+    rasterizeBatchRange(&batch, fontAtlas->font->face, 0, batch.numGlyphs);
   }
 
-  unsigned int bitmapHeight = fontAtlas->font->face->glyph->bitmap.rows;
-  if (bitmapHeight > INT_MAX) {
-    shovelerLogError(
-        "Font face glyph bitmap rows for code point %u out of bounds: %u",
-        (unsigned int) codePoint,
-        bitmapHeight);
-    return NULL;
+  // place the tallest glyphs first, so that later ones can fill the gaps next to them
+  qsort(batch.glyphs, batch.numGlyphs, sizeof(RasterizedGlyph), compareRasterizedGlyphHeight);
+
+  long long int requiredArea = getUsedArea(fontAtlas);
+  int requiredSize = 1;
+  for (int i = 0; i < batch.numGlyphs; i++) {
+    const RasterizedGlyph* rasterizedGlyph = &batch.glyphs[i];
+    if (!rasterizedGlyph->isRasterized) {
+      continue;
+    }
+
+    int placedGlyphWidth = 2 * fontAtlas->padding + (int) rasterizedGlyph->bitmap.width;
+    int placedGlyphHeight = 2 * fontAtlas->padding + (int) rasterizedGlyph->bitmap.rows;
+    requiredArea += (long long int) placedGlyphWidth * placedGlyphHeight;
+    if (placedGlyphWidth > requiredSize) {
+      requiredSize = placedGlyphWidth;
+    }
+    if (placedGlyphHeight > requiredSize) {
+      requiredSize = placedGlyphHeight;
+    }
   }
 
-  long advanceX = fontAtlas->font->face->glyph->advance.x;
-  if (advanceX > INT_MAX) {
-    shovelerLogError(
-        "Font face glyph bitmap advance X for code point %u out of bounds: %lu",
-        (unsigned int) codePoint,
-        advanceX);
-    return NULL;
+  int size = (int) fontAtlas->image->width;
+  while (size < requiredSize || (double) size * size * bulkGrowDensity < (double) requiredArea) {
+    size *= 2;
+  }
+  if (size > (int) fontAtlas->image->width) {
+    growImage(fontAtlas, size);
   }
 
-  glyph = malloc(sizeof(ShovelerFontAtlasGlyph));
-  glyph->index = glyphIndex;
-  glyph->width = (int) bitmapWidth;
-  glyph->height = (int) bitmapHeight;
-  glyph->bearingX = fontAtlas->font->face->glyph->bitmap_left;
-  glyph->bearingY = fontAtlas->font->face->glyph->bitmap_top;
-  glyph->advance = (int) advanceX;
-  insertGlyph(
-      fontAtlas,
-      fontAtlas->font->face->glyph->bitmap,
-      &glyph->minX,
-      &glyph->minY,
-      &glyph->isRotated);
+  int numAdded = 0;
+  for (int i = 0; i < batch.numGlyphs; i++) {
+    RasterizedGlyph* rasterizedGlyph = &batch.glyphs[i];
+    if (!rasterizedGlyph->isRasterized) {
+      continue;
+    }
 
-  g_hash_table_insert(fontAtlas->glyphs, &glyph->index, glyph);
+    addRasterizedGlyph(fontAtlas, rasterizedGlyph);
+    free(rasterizedGlyph->bitmap.buffer);
+    numAdded++;
+  }
 
-  return glyph;
+  g_array_free(rasterizedGlyphs, true);
+
+  return numAdded;
+}
+
+int shovelerFontAtlasAddGlyphRange(
+    ShovelerFontAtlas* fontAtlas,
+    uint32_t firstCodePoint,
+    uint32_t lastCodePoint,
+    ShovelerFontAtlasRasterizeAdapter* adapter) {
+  assert(firstCodePoint <= lastCodePoint);
+  assert(lastCodePoint - firstCodePoint < INT_MAX);
+
+  int numCodePoints = (int) (lastCodePoint - firstCodePoint) + 1;
+  uint32_t* codePoints = malloc(numCodePoints * sizeof(uint32_t));
+  for (int i = 0; i < numCodePoints; i++) {
+    codePoints[i] = firstCodePoint + (uint32_t) i;
+  }
+
+  int numAdded = shovelerFontAtlasAddGlyphs(fontAtlas, codePoints, numCodePoints, adapter);
+  free(codePoints);
+
+  return numAdded;
+}
+
+double shovelerFontAtlasGetDensity(ShovelerFontAtlas* fontAtlas) {
+  return (double) getUsedArea(fontAtlas) /
+      ((double) fontAtlas->image->width * (double) fontAtlas->image->height);
 }
 
 void shovelerFontAtlasValidateState(ShovelerFontAtlas* fontAtlas) {
@@ -170,6 +264,161 @@ void shovelerFontAtlasFree(ShovelerFontAtlas* fontAtlas) {
   free(fontAtlas);
 }
 
+static bool rasterizeGlyph(
+    ShovelerFontAtlas* fontAtlas, FT_Face face, RasterizedGlyph* rasterizedGlyph) {
+  rasterizedGlyph->isRasterized = false;
+
+  FT_Error error = FT_Load_Glyph(face, rasterizedGlyph->glyphIndex, FT_LOAD_RENDER);
+  if (error != FT_Err_Ok) {
+    shovelerLogError(
+        "Failed to load missing glyph for font '%s': %s",
+        fontAtlas->font->name,
+        FT_Error_String(error));
+    return false;
+  }
+
+  unsigned int bitmapWidth = face->glyph->bitmap.width;
+  if (bitmapWidth > INT_MAX) {
+    shovelerLogError(
+        "Font face glyph bitmap width for code point %u out of bounds: %u",
+        (unsigned int) rasterizedGlyph->codePoint,
+        bitmapWidth);
+    return false;
+  }
+
+  unsigned int bitmapHeight = face->glyph->bitmap.rows;
+  if (bitmapHeight > INT_MAX) {
+    shovelerLogError(
+        "Font face glyph bitmap rows for code point %u out of bounds: %u",
+        (unsigned int) rasterizedGlyph->codePoint,
+        bitmapHeight);
+    return false;
+  }
+
+  long advanceX = face->glyph->advance.x;
+  if (advanceX > INT_MAX) {
+    shovelerLogError(
+        "Font face glyph bitmap advance X for code point %u out of bounds: %lu",
+        (unsigned int) rasterizedGlyph->codePoint,
+        advanceX);
+    return false;
+  }
+
+  // only valid until the next glyph is loaded into the face
+  rasterizedGlyph->bitmap = face->glyph->bitmap;
+  rasterizedGlyph->bearingX = face->glyph->bitmap_left;
+  rasterizedGlyph->bearingY = face->glyph->bitmap_top;
+  rasterizedGlyph->advance = (int) advanceX;
+  rasterizedGlyph->isRasterized = true;
+  return true;
+}
+
+static ShovelerFontAtlasGlyph* addRasterizedGlyph(
+    ShovelerFontAtlas* fontAtlas, const RasterizedGlyph* rasterizedGlyph) {
+  assert(rasterizedGlyph->isRasterized);
+
+  ShovelerFontAtlasGlyph* glyph = malloc(sizeof(ShovelerFontAtlasGlyph));
+  glyph->index = rasterizedGlyph->glyphIndex;
+  glyph->width = (int) rasterizedGlyph->bitmap.width;
+  glyph->height = (int) rasterizedGlyph->bitmap.rows;
+  glyph->bearingX = rasterizedGlyph->bearingX;
+  glyph->bearingY = rasterizedGlyph->bearingY;
+  glyph->advance = rasterizedGlyph->advance;
+  insertGlyph(
+      fontAtlas, rasterizedGlyph->bitmap, &glyph->minX, &glyph->minY, &glyph->isRotated);
+
+  g_hash_table_insert(fontAtlas->glyphs, &glyph->index, glyph);
+
+  return glyph;
+}
+
+static void rasterizeBatchTask(int taskIndex, void* batchPointer) {
+  RasterizeBatch* batch = batchPointer;
+  ShovelerFont* font = batch->fontAtlas->font;
+
+  // FreeType faces and libraries can't be shared between threads, so every task opens its own
+  FT_Library library;
+  FT_Error error = FT_Init_FreeType(&library);
+  if (error != FT_Err_Ok) {
+    shovelerLogError("Failed to initialize freetype library: %s", FT_Error_String(error));
+    return;
+  }
+
+  FT_Face face;
+  error = shovelerFontOpenFace(font, library, &face);
+  if (error != FT_Err_Ok) {
+    shovelerLogError("Failed to open face of font '%s': %s", font->name, FT_Error_String(error));
+    FT_Done_FreeType(library);
+    return;
+  }
+
+  error = FT_Set_Pixel_Sizes(face, 0, (unsigned int) batch->fontAtlas->fontSize);
+  if (error == FT_Err_Ok) {
+    int begin = (int) ((long long int) taskIndex * batch->numGlyphs / batch->numTasks);
+    int end = (int) ((long long int) (taskIndex + 1) * batch->numGlyphs / batch->numTasks);
+    rasterizeBatchRange(batch, face, begin, end);
+  } else {
+    shovelerLogError(
+        "Failed to set pixel size to %u for font '%s': %s",
+        batch->fontAtlas->fontSize,
+        font->name,
+        FT_Error_String(error));
+  }
+
+  FT_Done_Face(face);
+  FT_Done_FreeType(library);
+}
+
+static void rasterizeBatchRange(RasterizeBatch* batch, FT_Face face, int begin, int end) {
+  for (int i = begin; i < end; i++) {
+    RasterizedGlyph* rasterizedGlyph = &batch->glyphs[i];
+    if (!rasterizeGlyph(batch->fontAtlas, face, rasterizedGlyph)) {
+      continue;
+    }
+
+    // copy the bitmap out of the face's glyph slot before the next glyph overwrites it
+    FT_Bitmap* bitmap = &rasterizedGlyph->bitmap;
+    unsigned char* buffer = malloc((size_t) bitmap->width * bitmap->rows + 1);
+    for (unsigned int row = 0; row < bitmap->rows; row++) {
+      memcpy(
+          buffer + (size_t) row * bitmap->width,
+          bitmap->buffer + (long long int) row * bitmap->pitch,
+          bitmap->width);
+    }
+    bitmap->buffer = buffer;
+    bitmap->pitch = (int) bitmap->width;
+  }
+}
+
+static int compareRasterizedGlyphHeight(const void* firstPointer, const void* secondPointer) {
+  const RasterizedGlyph* first = firstPointer;
+  const RasterizedGlyph* second = secondPointer;
+
+  // tallest first, then widest first
+  if (first->bitmap.rows != second->bitmap.rows) {
+    return first->bitmap.rows > second->bitmap.rows ? -1 : 1;
+  }
+  if (first->bitmap.width != second->bitmap.width) {
+    return first->bitmap.width > second->bitmap.width ? -1 : 1;
+  }
+
+  return 0;
+}
+
+static long long int getUsedArea(ShovelerFontAtlas* fontAtlas) {
+  long long int usedArea = 0;
+
+  GHashTableIter iter;
+  g_hash_table_iter_init(&iter, fontAtlas->glyphs);
+  ShovelerFontAtlasGlyph* glyph;
+  while (g_hash_table_iter_next(&iter, NULL, (gpointer*) &glyph)) {
+    usedArea += (long long int) (2 * fontAtlas->padding + glyph->width) *
+        (2 * fontAtlas->padding + glyph->height);
+  }
+
+  return usedArea;
+}
+
 static void insertGlyph(
     ShovelerFontAtlas* fontAtlas,
     FT_Bitmap glyph,
@@ -271,7 +520,7 @@ static void insertGlyph(
 
   if (bestStartSkylineEdgeIter == NULL) {
     // doesn't fit, grow and retry
-    growImage(fontAtlas);
+    growImage(fontAtlas, 2 * (int) fontAtlas->image->width);
     insertGlyph(fontAtlas, glyph, outputPositionX, outputPositionY, outputIsRotated);
     return;
   }
@@ -326,15 +575,18 @@ static void insertGlyph(
   bestEndSkylineEdge->height = bestHeight;
 }
 
-static void growImage(ShovelerFontAtlas* fontAtlas) {
+static void growImage(ShovelerFontAtlas* fontAtlas, int size) {
   ShovelerImage* oldImage = fontAtlas->image;
+  assert(size > (int) oldImage->width);
+  assert(oldImage->width == oldImage->height);
 
-  fontAtlas->image = shovelerImageCreate(2 * oldImage->width, 2 * oldImage->height, 1);
+  fontAtlas->image = shovelerImageCreate(size, size, 1);
   shovelerImageClear(fontAtlas->image);
   shovelerImageAddSubImage(fontAtlas->image, 0, 0, oldImage);
 
   g_queue_push_tail(
-      fontAtlas->skylineEdges, allocateSkylineEdge(oldImage->width, oldImage->width, 0));
+      fontAtlas->skylineEdges,
+      allocateSkylineEdge(oldImage->width, size - (int) oldImage->width, 0));
   shovelerImageFree(oldImage);
 }
 
@@ -364,6 +616,8 @@ static void addBitmapToImage(
       }
     }
   }
+
+  shovelerImageMarkDirty(image, bottomLeftX, bottomLeftY, rotatedBitmapWidth, rotatedBitmapHeight);
 }
 
 static ShovelerFontAtlasSkylineEdge* allocateSkylineEdge(int minX, int width, int height) {
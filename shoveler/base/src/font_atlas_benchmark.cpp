@@ -0,0 +1,220 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "shoveler/font.h"
+#include "shoveler/font_atlas.h"
+#include "shoveler/image.h"
+#include "shoveler/log.h"
+}
+
+/**
+ * Benchmark for building font atlases, comparing getting glyphs one by one with adding them in
+ * bulk, both on the calling thread and split across worker threads.
+ *
+ * Every measurement is written to stdout as a single line JSON object, so that the output of
+ * repeated runs can be collected and compared over time. Log messages go to stderr.
+ *
+ * Usage: shoveler_base_benchmark <font file> [--font-size=48] [--padding=1] [--threads=4]
+ *
+ * Code points the font doesn't contain all map to its missing glyph, so the CJK subset only
+ * exercises packing with a font that covers it.
+ */
+
+struct BenchmarkOptions {
+  std::string fontFile;
+  int fontSize;
+  int padding;
+  int numThreads;
+};
+
+struct CodePointSubset {
+  const char* name;
+  std::vector<uint32_t> codePoints;
+};
+
+enum class BuildMode {
+  kOneByOne,
+  kBulk,
+  kBulkThreaded,
+};
+
+static bool parseOptions(int argc, char** argv, BenchmarkOptions* options);
+static std::vector<CodePointSubset> createSubsets();
+static void addRange(std::vector<uint32_t>& codePoints, uint32_t first, uint32_t last);
+static void runBuild(
+    const BenchmarkOptions& options,
+    ShovelerFont* font,
+    const CodePointSubset& subset,
+    BuildMode mode);
+static void runThreads(
+    int numTasks, ShovelerFontAtlasTaskFunction* task, void* taskUserData, void* userData);
+static const char* getModeName(BuildMode mode);
+static double elapsedMs(gint64 startTime);
+
+int main(int argc, char** argv) {
+  BenchmarkOptions options;
+  if (!parseOptions(argc, argv, &options)) {
+    fprintf(
+        stderr,
+        "Usage: %s <font file> [--font-size=48] [--padding=1] [--threads=4]\n",
+        argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  shovelerLogInit("shoveler/", SHOVELER_LOG_LEVEL_WARNING_UP, stderr);
+
+  ShovelerFonts* fonts = shovelerFontsCreate();
+  ShovelerFont* font = shovelerFontsLoadFontFile(fonts, "benchmark", options.fontFile.c_str());
+  if (font == NULL) {
+    shovelerFontsFree(fonts);
+    shovelerLogTerminate();
+    return EXIT_FAILURE;
+  }
+
+  for (const CodePointSubset& subset : createSubsets()) {
+    runBuild(options, font, subset, BuildMode::kOneByOne);
+    runBuild(options, font, subset, BuildMode::kBulk);
+    runBuild(options, font, subset, BuildMode::kBulkThreaded);
+  }
+
+  shovelerFontsFree(fonts);
+  shovelerLogTerminate();
+  return EXIT_SUCCESS;
+}
+
+static bool parseOptions(int argc, char** argv, BenchmarkOptions* options) {
+  options->fontSize = 48;
+  options->padding = 1;
+  options->numThreads = 4;
+
+  if (argc < 2) {
+    return false;
+  }
+  options->fontFile = argv[1];
+
+  for (int i = 2; i < argc; i++) {
+    std::string argument = argv[i];
+    size_t separator = argument.find('=');
+    if (argument.compare(0, 2, "--") != 0 || separator == std::string::npos) {
+      return false;
+    }
+
+    std::string name = argument.substr(2, separator - 2);
+    int value = atoi(argument.substr(separator + 1).c_str());
+    if (name == "font-size" && value > 0) {
+      options->fontSize = value;
+    } else if (name == "padding" && value >= 0) {
+      options->padding = value;
+    } else if (name == "threads" && value > 0) {
+      options->numThreads = value;
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static std::vector<CodePointSubset> createSubsets() {
+  CodePointSubset ascii{"ascii", {}};
+  addRange(ascii.codePoints, 0x20, 0x7e);
+
+  CodePointSubset latin1{"latin1", {}};
+  addRange(latin1.codePoints, 0x20, 0x7e);
+  addRange(latin1.codePoints, 0xa0, 0xff);
+
+  // the first 2048 CJK unified ideographs
+  CodePointSubset cjk{"cjk", {}};
+  addRange(cjk.codePoints, 0x4e00, 0x55ff);
+
+  return {ascii, latin1, cjk};
+}
+
+static void addRange(std::vector<uint32_t>& codePoints, uint32_t first, uint32_t last) {
+  for (uint32_t codePoint = first; codePoint <= last; codePoint++) {
+    codePoints.push_back(codePoint);
+  }
+}
+
+static void runBuild(
+    const BenchmarkOptions& options,
+    ShovelerFont* font,
+    const CodePointSubset& subset,
+    BuildMode mode) {
+  ShovelerFontAtlas* fontAtlas = shovelerFontAtlasCreate(font, options.fontSize, options.padding);
+
+  ShovelerFontAtlasRasterizeAdapter adapter;
+  adapter.run = runThreads;
+  adapter.numTasks = options.numThreads;
+  adapter.userData = NULL;
+
+  gint64 startTime = g_get_monotonic_time();
+  switch (mode) {
+  case BuildMode::kOneByOne:
+    for (uint32_t codePoint : subset.codePoints) {
+      shovelerFontAtlasGetGlyph(fontAtlas, codePoint);
+    }
+    break;
+  case BuildMode::kBulk:
+    shovelerFontAtlasAddGlyphs(
+        fontAtlas, subset.codePoints.data(), (int) subset.codePoints.size(), NULL);
+    break;
+  case BuildMode::kBulkThreaded:
+    shovelerFontAtlasAddGlyphs(
+        fontAtlas, subset.codePoints.data(), (int) subset.codePoints.size(), &adapter);
+    break;
+  }
+  double totalMs = elapsedMs(startTime);
+  shovelerFontAtlasValidateState(fontAtlas);
+
+  printf(
+      "{\"benchmark\": \"font_atlas_build\", \"subset\": \"%s\", \"mode\": \"%s\", "
+      "\"threads\": %d, \"font_size\": %d, \"code_points\": %d, \"glyphs\": %d, "
+      "\"atlas_size\": %u, \"density\": %.3f, \"total_ms\": %.3f}\n",
+      subset.name,
+      getModeName(mode),
+      mode == BuildMode::kBulkThreaded ? options.numThreads : 1,
+      options.fontSize,
+      (int) subset.codePoints.size(),
+      (int) g_hash_table_size(fontAtlas->glyphs),
+      fontAtlas->image->width,
+      shovelerFontAtlasGetDensity(fontAtlas),
+      totalMs);
+  fflush(stdout);
+
+  shovelerFontAtlasFree(fontAtlas);
+}
+
+static void runThreads(
+    int numTasks, ShovelerFontAtlasTaskFunction* task, void* taskUserData, void* userData) {
+  std::vector<std::thread> threads;
+  for (int i = 0; i < numTasks; i++) {
+    threads.emplace_back(task, i, taskUserData);
+  }
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+static const char* getModeName(BuildMode mode) {
+  switch (mode) {
+  case BuildMode::kOneByOne:
+    return "one_by_one";
+  case BuildMode::kBulk:
+    return "bulk";
+  case BuildMode::kBulkThreaded:
+    return "bulk_threaded";
+  }
+
+  return "unknown";
+}
+
+static double elapsedMs(gint64 startTime) {
+  return (double) (g_get_monotonic_time() - startTime) / 1000.0;
+}
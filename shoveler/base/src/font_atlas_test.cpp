@@ -0,0 +1,394 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "shoveler/font.h"
+#include "shoveler/font_atlas.h"
+#include "shoveler/image.h"
+}
+
+static const int kNumRectangleGlyphs = 40;
+static const uint32_t kFirstCodePoint = 0x21;
+static const uint32_t kFirstAliasCodePoint = 0x61;
+static const uint32_t kUnmappedCodePoint = 0x1000;
+static const int kFontSize = 32;
+static const int kPadding = 1;
+
+static std::vector<unsigned char> createTestFont();
+
+class ShovelerFontAtlasTest : public ::testing::Test {
+public:
+  virtual void SetUp() {
+    fontBuffer = createTestFont();
+    fonts = shovelerFontsCreate();
+    font = shovelerFontsLoadFontBuffer(fonts, "test", fontBuffer.data(), (int) fontBuffer.size());
+    ASSERT_TRUE(font != NULL);
+  }
+
+  virtual void TearDown() { shovelerFontsFree(fonts); }
+
+  std::vector<unsigned char> fontBuffer;
+  ShovelerFonts* fonts;
+  ShovelerFont* font;
+};
+
+static void runTasksOnThreads(
+    int numTasks, ShovelerFontAtlasTaskFunction* task, void* taskUserData, void* userData) {
+  std::vector<std::thread> threads;
+  for (int i = 0; i < numTasks; i++) {
+    threads.emplace_back(task, i, taskUserData);
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST_F(ShovelerFontAtlasTest, addGlyphsDeduplicates) {
+  ShovelerFontAtlas* fontAtlas = shovelerFontAtlasCreate(font, kFontSize, kPadding);
+
+  // the alias code points map to the same glyphs, and unmapped ones all map to the missing glyph
+  const uint32_t codePoints[] = {
+      kFirstCodePoint,
+      kFirstAliasCodePoint,
+      kFirstCodePoint + 1,
+      kFirstAliasCodePoint + 1,
+      kUnmappedCodePoint,
+      kUnmappedCodePoint + 1,
+      kFirstCodePoint};
+  int numAdded = shovelerFontAtlasAddGlyphs(fontAtlas, codePoints, 7, /* adapter */ NULL);
+  ASSERT_EQ(numAdded, 3);
+  ASSERT_EQ(g_hash_table_size(fontAtlas->glyphs), 3);
+
+  const uint32_t moreCodePoints[] = {kFirstAliasCodePoint, kFirstCodePoint + 2};
+  int numMoreAdded = shovelerFontAtlasAddGlyphs(fontAtlas, moreCodePoints, 2, /* adapter */ NULL);
+  ASSERT_EQ(numMoreAdded, 1) << "glyphs already in the atlas should not be added again";
+  ASSERT_EQ(g_hash_table_size(fontAtlas->glyphs), 4);
+
+  ShovelerFontAtlasGlyph* glyph = shovelerFontAtlasGetGlyph(fontAtlas, kFirstAliasCodePoint + 2);
+  ASSERT_EQ(glyph, shovelerFontAtlasGetGlyph(fontAtlas, kFirstCodePoint + 2));
+  ASSERT_GT(glyph->width, 0);
+  ASSERT_GT(glyph->height, 0);
+  ASSERT_EQ(g_hash_table_size(fontAtlas->glyphs), 4);
+
+  shovelerFontAtlasValidateState(fontAtlas);
+  shovelerFontAtlasFree(fontAtlas);
+}
+
+TEST_F(ShovelerFontAtlasTest, addGlyphRange) {
+  ShovelerFontAtlas* fontAtlas = shovelerFontAtlasCreate(font, kFontSize, kPadding);
+
+  // the range covers all rectangle glyphs twice, plus unmapped code points in between
+  uint32_t lastCodePoint = kFirstAliasCodePoint + kNumRectangleGlyphs - 1;
+  int numAdded = shovelerFontAtlasAddGlyphRange(
+      fontAtlas, kFirstCodePoint, lastCodePoint, /* adapter */ NULL);
+  ASSERT_EQ(numAdded, kNumRectangleGlyphs + 1);
+  ASSERT_EQ(g_hash_table_size(fontAtlas->glyphs), kNumRectangleGlyphs + 1);
+
+  int numAddedAgain = shovelerFontAtlasAddGlyphRange(
+      fontAtlas, kFirstCodePoint, lastCodePoint, /* adapter */ NULL);
+  ASSERT_EQ(numAddedAgain, 0);
+
+  shovelerFontAtlasValidateState(fontAtlas);
+  shovelerFontAtlasFree(fontAtlas);
+}
+
+TEST_F(ShovelerFontAtlasTest, addGlyphsGrowsToFinalSize) {
+  ShovelerFontAtlas* fontAtlas = shovelerFontAtlasCreate(font, kFontSize, kPadding);
+  ASSERT_EQ(fontAtlas->image->width, 1);
+
+  shovelerFontAtlasAddGlyphRange(
+      fontAtlas,
+      kFirstCodePoint,
+      kFirstCodePoint + kNumRectangleGlyphs - 1,
+      /* adapter */ NULL);
+
+  // the smallest power of two fitting every glyph at the bulk insertion density
+  long long int usedArea = 0;
+  int maxDimension = 1;
+  GHashTableIter iter;
+  g_hash_table_iter_init(&iter, fontAtlas->glyphs);
+  ShovelerFontAtlasGlyph* glyph;
+  while (g_hash_table_iter_next(&iter, NULL, (gpointer*) &glyph)) {
+    int placedWidth = glyph->width + 2 * kPadding;
+    int placedHeight = glyph->height + 2 * kPadding;
+    usedArea += (long long int) placedWidth * placedHeight;
+    maxDimension = std::max(maxDimension, std::max(placedWidth, placedHeight));
+  }
+  int expectedSize = 1;
+  while (expectedSize < maxDimension || (double) expectedSize * expectedSize * 0.8 < usedArea) {
+    expectedSize *= 2;
+  }
+
+  ASSERT_EQ(fontAtlas->image->width, expectedSize)
+      << "the image should be grown once to its final size, without further doubling";
+  ASSERT_EQ(fontAtlas->image->height, expectedSize);
+  ASSERT_GT(shovelerFontAtlasGetDensity(fontAtlas), 0.2);
+
+  shovelerFontAtlasValidateState(fontAtlas);
+  shovelerFontAtlasFree(fontAtlas);
+}
+
+TEST_F(ShovelerFontAtlasTest, threadedRasterizationMatchesSingleTask) {
+  ShovelerFontAtlas* singleTaskAtlas = shovelerFontAtlasCreate(font, kFontSize, kPadding);
+  ShovelerFontAtlas* threadedAtlas = shovelerFontAtlasCreate(font, kFontSize, kPadding);
+
+  ShovelerFontAtlasRasterizeAdapter singleTaskAdapter;
+  singleTaskAdapter.run = runTasksOnThreads;
+  singleTaskAdapter.numTasks = 1;
+  singleTaskAdapter.userData = NULL;
+  ShovelerFontAtlasRasterizeAdapter threadedAdapter;
+  threadedAdapter.run = runTasksOnThreads;
+  threadedAdapter.numTasks = 4;
+  threadedAdapter.userData = NULL;
+
+  uint32_t lastCodePoint = kFirstAliasCodePoint + kNumRectangleGlyphs - 1;
+  int numSingleTaskAdded = shovelerFontAtlasAddGlyphRange(
+      singleTaskAtlas, kFirstCodePoint, lastCodePoint, &singleTaskAdapter);
+  int numThreadedAdded = shovelerFontAtlasAddGlyphRange(
+      threadedAtlas, kFirstCodePoint, lastCodePoint, &threadedAdapter);
+  ASSERT_EQ(numSingleTaskAdded, kNumRectangleGlyphs + 1);
+  ASSERT_EQ(numThreadedAdded, numSingleTaskAdded);
+  ASSERT_EQ(g_hash_table_size(threadedAtlas->glyphs), g_hash_table_size(singleTaskAtlas->glyphs));
+
+  GHashTableIter iter;
+  g_hash_table_iter_init(&iter, singleTaskAtlas->glyphs);
+  ShovelerFontAtlasGlyph* glyph;
+  while (g_hash_table_iter_next(&iter, NULL, (gpointer*) &glyph)) {
+    ShovelerFontAtlasGlyph* threadedGlyph =
+        (ShovelerFontAtlasGlyph*) g_hash_table_lookup(threadedAtlas->glyphs, &glyph->index);
+    ASSERT_TRUE(threadedGlyph != NULL) << glyph->index;
+    ASSERT_EQ(threadedGlyph->minX, glyph->minX) << glyph->index;
+    ASSERT_EQ(threadedGlyph->minY, glyph->minY) << glyph->index;
+    ASSERT_EQ(threadedGlyph->width, glyph->width) << glyph->index;
+    ASSERT_EQ(threadedGlyph->height, glyph->height) << glyph->index;
+    ASSERT_EQ(threadedGlyph->bearingX, glyph->bearingX) << glyph->index;
+    ASSERT_EQ(threadedGlyph->bearingY, glyph->bearingY) << glyph->index;
+    ASSERT_EQ(threadedGlyph->advance, glyph->advance) << glyph->index;
+    ASSERT_EQ(threadedGlyph->isRotated, glyph->isRotated) << glyph->index;
+  }
+
+  ShovelerImage* singleTaskImage = singleTaskAtlas->image;
+  ShovelerImage* threadedImage = threadedAtlas->image;
+  ASSERT_EQ(threadedImage->width, singleTaskImage->width);
+  ASSERT_EQ(threadedImage->height, singleTaskImage->height);
+  ASSERT_EQ(
+      memcmp(
+          threadedImage->data,
+          singleTaskImage->data,
+          (size_t) singleTaskImage->width * singleTaskImage->height * singleTaskImage->channels),
+      0);
+
+  shovelerFontAtlasValidateState(singleTaskAtlas);
+  shovelerFontAtlasValidateState(threadedAtlas);
+  shovelerFontAtlasFree(threadedAtlas);
+  shovelerFontAtlasFree(singleTaskAtlas);
+}
+
+static void appendUint16(std::vector<unsigned char>& output, uint16_t value) {
+  output.push_back((unsigned char) (value >> 8));
+  output.push_back((unsigned char) value);
+}
+
+static void appendUint32(std::vector<unsigned char>& output, uint32_t value) {
+  appendUint16(output, (uint16_t) (value >> 16));
+  appendUint16(output, (uint16_t) value);
+}
+
+static void appendPadding(std::vector<unsigned char>& output) {
+  while (output.size() % 4 != 0) {
+    output.push_back(0);
+  }
+}
+
+/**
+ * Builds a minimal TrueType font whose glyphs 1 to kNumRectangleGlyphs are filled rectangles of
+ * varying size. Both the code points starting at kFirstCodePoint and those starting at
+ * kFirstAliasCodePoint map to them, and all other code points map to the empty missing glyph 0.
+ */
+static std::vector<unsigned char> createTestFont() {
+  const int numGlyphs = kNumRectangleGlyphs + 1;
+  std::vector<int> glyphWidths(numGlyphs, 0);
+  std::vector<int> glyphHeights(numGlyphs, 0);
+  for (int glyph = 1; glyph < numGlyphs; glyph++) {
+    glyphWidths[glyph] = 150 + (glyph * 7 % 11) * 60;
+    glyphHeights[glyph] = 150 + (glyph * 5 % 13) * 60;
+  }
+
+  std::vector<unsigned char> cmap;
+  appendUint16(cmap, 0); // version
+  appendUint16(cmap, 1); // number of subtables
+  appendUint16(cmap, 3); // platform: windows
+  appendUint16(cmap, 1); // encoding: unicode BMP
+  appendUint32(cmap, 12); // subtable offset
+  const uint16_t startCodes[] = {
+      (uint16_t) kFirstCodePoint, (uint16_t) kFirstAliasCodePoint, 0xFFFF};
+  const uint16_t endCodes[] = {
+      (uint16_t) (kFirstCodePoint + kNumRectangleGlyphs - 1),
+      (uint16_t) (kFirstAliasCodePoint + kNumRectangleGlyphs - 1),
+      0xFFFF};
+  const int numSegments = 3;
+  appendUint16(cmap, 4); // format
+  appendUint16(cmap, 16 + 8 * numSegments); // length
+  appendUint16(cmap, 0); // language
+  appendUint16(cmap, 2 * numSegments);
+  appendUint16(cmap, 4); // search range
+  appendUint16(cmap, 1); // entry selector
+  appendUint16(cmap, 2 * numSegments - 4); // range shift
+  for (uint16_t endCode : endCodes) {
+    appendUint16(cmap, endCode);
+  }
+  appendUint16(cmap, 0); // reserved
+  for (uint16_t startCode : startCodes) {
+    appendUint16(cmap, startCode);
+  }
+  for (uint16_t startCode : startCodes) {
+    // maps the start code of every segment to glyph 1, wrapping around at 2^16
+    appendUint16(cmap, (uint16_t) (1 - startCode));
+  }
+  for (int i = 0; i < numSegments; i++) {
+    appendUint16(cmap, 0); // range offset
+  }
+
+  std::vector<unsigned char> glyf;
+  std::vector<unsigned char> loca;
+  for (int glyph = 0; glyph < numGlyphs; glyph++) {
+    appendUint32(loca, (uint32_t) glyf.size());
+    if (glyph == 0) {
+      continue; // empty outline
+    }
+
+    int minX = 50;
+    int maxX = minX + glyphWidths[glyph];
+    int maxY = glyphHeights[glyph];
+    appendUint16(glyf, 1); // number of contours
+    appendUint16(glyf, (uint16_t) minX);
+    appendUint16(glyf, 0);
+    appendUint16(glyf, (uint16_t) maxX);
+    appendUint16(glyf, (uint16_t) maxY);
+    appendUint16(glyf, 3); // end point of the contour
+    appendUint16(glyf, 0); // instruction length
+    for (int point = 0; point < 4; point++) {
+      glyf.push_back(0x01); // on curve, with 16 bit coordinate deltas
+    }
+    // clockwise from the bottom left corner
+    const int deltasX[] = {minX, 0, maxX - minX, 0};
+    const int deltasY[] = {0, maxY, 0, -maxY};
+    for (int deltaX : deltasX) {
+      appendUint16(glyf, (uint16_t) deltaX);
+    }
+    for (int deltaY : deltasY) {
+      appendUint16(glyf, (uint16_t) deltaY);
+    }
+    appendPadding(glyf);
+  }
+  appendUint32(loca, (uint32_t) glyf.size());
+
+  std::vector<unsigned char> head;
+  appendUint32(head, 0x00010000); // version
+  appendUint32(head, 0x00010000); // font revision
+  appendUint32(head, 0); // checksum adjustment
+  appendUint32(head, 0x5F0F3CF5); // magic number
+  appendUint16(head, 0x0003); // flags
+  appendUint16(head, 1000); // units per em
+  appendUint32(head, 0); // created
+  appendUint32(head, 0);
+  appendUint32(head, 0); // modified
+  appendUint32(head, 0);
+  appendUint16(head, 0); // bounding box
+  appendUint16(head, 0);
+  appendUint16(head, 1000);
+  appendUint16(head, 1000);
+  appendUint16(head, 0); // mac style
+  appendUint16(head, 8); // lowest recommended pixels per em
+  appendUint16(head, 2); // font direction hint
+  appendUint16(head, 1); // long loca offsets
+  appendUint16(head, 0); // glyph data format
+
+  std::vector<unsigned char> hhea;
+  appendUint32(hhea, 0x00010000); // version
+  appendUint16(hhea, 1000); // ascender
+  appendUint16(hhea, 0); // descender
+  appendUint16(hhea, 0); // line gap
+  appendUint16(hhea, 1100); // maximum advance width
+  appendUint16(hhea, 0); // minimum left side bearing
+  appendUint16(hhea, 0); // minimum right side bearing
+  appendUint16(hhea, 1000); // maximum extent
+  appendUint16(hhea, 1); // caret slope rise
+  appendUint16(hhea, 0); // caret slope run
+  appendUint16(hhea, 0); // caret offset
+  for (int i = 0; i < 4; i++) {
+    appendUint16(hhea, 0); // reserved
+  }
+  appendUint16(hhea, 0); // metric data format
+  appendUint16(hhea, (uint16_t) numGlyphs);
+
+  std::vector<unsigned char> hmtx;
+  for (int glyph = 0; glyph < numGlyphs; glyph++) {
+    appendUint16(hmtx, (uint16_t) (glyphWidths[glyph] + 100)); // advance width
+    appendUint16(hmtx, glyph == 0 ? 0 : 50); // left side bearing
+  }
+
+  std::vector<unsigned char> maxp;
+  appendUint32(maxp, 0x00010000); // version
+  appendUint16(maxp, (uint16_t) numGlyphs);
+  appendUint16(maxp, 4); // maximum points
+  appendUint16(maxp, 1); // maximum contours
+  appendUint16(maxp, 0); // maximum composite points
+  appendUint16(maxp, 0); // maximum composite contours
+  appendUint16(maxp, 2); // maximum zones
+  for (int i = 0; i < 8; i++) {
+    appendUint16(maxp, 0); // no instructions, storage or components
+  }
+
+  struct Table {
+    const char* tag;
+    std::vector<unsigned char>* data;
+  };
+  // sorted by tag as required by the table directory
+  const Table tables[] = {
+      {"cmap", &cmap},
+      {"glyf", &glyf},
+      {"head", &head},
+      {"hhea", &hhea},
+      {"hmtx", &hmtx},
+      {"loca", &loca},
+      {"maxp", &maxp},
+  };
+  const int numTables = 7;
+
+  std::vector<unsigned char> font;
+  appendUint32(font, 0x00010000); // TrueType outlines
+  appendUint16(font, numTables);
+  appendUint16(font, 64); // search range
+  appendUint16(font, 2); // entry selector
+  appendUint16(font, 16 * numTables - 64); // range shift
+
+  uint32_t tableOffset = 12 + 16 * numTables;
+  for (const Table& table : tables) {
+    size_t tableSize = table.data->size();
+    appendPadding(*table.data);
+
+    uint32_t checksum = 0;
+    for (size_t i = 0; i < table.data->size(); i += 4) {
+      checksum += ((uint32_t) (*table.data)[i] << 24) | ((uint32_t) (*table.data)[i + 1] << 16) |
+          ((uint32_t) (*table.data)[i + 2] << 8) | (uint32_t) (*table.data)[i + 3];
+    }
+
+    font.insert(font.end(), table.tag, table.tag + 4);
+    appendUint32(font, checksum);
+    appendUint32(font, tableOffset);
+    appendUint32(font, (uint32_t) tableSize);
+    tableOffset += (uint32_t) table.data->size();
+  }
+  for (const Table& table : tables) {
+    font.insert(font.end(), table.data->begin(), table.data->end());
+  }
+
+  return font;
+}
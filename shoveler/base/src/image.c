@@ -2,11 +2,44 @@
 
 #include <assert.h> // assert
 #include <limits.h> // UINT_MAX
+#include <stddef.h> // ptrdiff_t size_t
+#include <stdint.h> // int64_t
 #include <stdlib.h> // malloc, free
 #include <string.h> // memcpy, memset
 
-static unsigned int getBorderDistance(
-    unsigned int width, unsigned int height, unsigned int i, unsigned int j);
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SHOVELER_IMAGE_USE_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SHOVELER_IMAGE_USE_NEON
+#endif
+
+/* side length in pixels of the square tiles that transposing walks the image in */
+#define TRANSPOSE_TILE_SIZE 16
+
+static size_t getStride(ShovelerImage* image);
+static void flipRow(
+    unsigned char* target, const unsigned char* source, unsigned int width, unsigned int channels);
+static void transpose(
+    unsigned char* target,
+    ptrdiff_t targetStride,
+    const unsigned char* source,
+    ptrdiff_t sourceStride,
+    unsigned int width,
+    unsigned int height,
+    unsigned int channels);
+static void transposeTile(
+    unsigned char* target,
+    ptrdiff_t targetStride,
+    const unsigned char* source,
+    ptrdiff_t sourceStride,
+    unsigned int width,
+    unsigned int height,
+    unsigned int channels);
+static inline void copyPixel(
+    unsigned char* target, const unsigned char* source, unsigned int channels);
+static inline void setFramePixel(unsigned char* target, ShovelerColor color, unsigned char alpha);
 static unsigned int minInt(unsigned int a, unsigned int b);
 
 ShovelerImage* shovelerImageCreate(unsigned int width, unsigned int height, unsigned int channels) {
@@ -21,6 +54,7 @@ ShovelerImage* shovelerImageCreate(unsigned int width, unsigned int height, unsi
   image->height = height;
   image->channels = channels;
   image->data = malloc(width * height * channels * sizeof(unsigned char));
+  shovelerDirtyRegionClear(&image->dirtyRegion);
   return image;
 }
 
@@ -36,12 +70,9 @@ ShovelerImage* shovelerImageCreateCopy(ShovelerImage* input) {
 ShovelerImage* shovelerImageCreateFlippedX(ShovelerImage* input) {
   ShovelerImage* image = shovelerImageCreate(input->width, input->height, input->channels);
 
-  for (unsigned int i = 0; i < image->width; i++) {
-    for (unsigned int j = 0; j < image->height; j++) {
-      for (unsigned int c = 0; c < image->channels; c++) {
-        shovelerImageGet(image, i, j, c) = shovelerImageGet(input, image->width - i - 1, j, c);
-      }
-    }
+  size_t stride = getStride(image);
+  for (unsigned int j = 0; j < image->height; j++) {
+    flipRow(image->data + j * stride, input->data + j * stride, image->width, image->channels);
   }
 
   return image;
@@ -50,12 +81,9 @@ ShovelerImage* shovelerImageCreateFlippedX(ShovelerImage* input) {
 ShovelerImage* shovelerImageCreateFlippedY(ShovelerImage* input) {
   ShovelerImage* image = shovelerImageCreate(input->width, input->height, input->channels);
 
-  for (unsigned int i = 0; i < image->width; i++) {
-    for (unsigned int j = 0; j < image->height; j++) {
-      for (unsigned int c = 0; c < image->channels; c++) {
-        shovelerImageGet(image, i, j, c) = shovelerImageGet(input, i, image->height - j - 1, c);
-      }
-    }
+  size_t stride = getStride(image);
+  for (unsigned int j = 0; j < image->height; j++) {
+    memcpy(image->data + j * stride, input->data + (image->height - j - 1) * stride, stride);
   }
 
   return image;
@@ -64,13 +92,16 @@ ShovelerImage* shovelerImageCreateFlippedY(ShovelerImage* input) {
 ShovelerImage* shovelerImageCreateRotatedClockwise(ShovelerImage* input) {
   ShovelerImage* image = shovelerImageCreate(input->height, input->width, input->channels);
 
-  for (unsigned int i = 0; i < image->width; i++) {
-    for (unsigned int j = 0; j < image->height; j++) {
-      for (unsigned int c = 0; c < image->channels; c++) {
-        shovelerImageGet(image, j, image->width - i - 1, c) = shovelerImageGet(input, i, j, c);
-      }
-    }
-  }
+  // the transposed input with its rows in reverse order
+  ptrdiff_t stride = (ptrdiff_t) getStride(image);
+  transpose(
+      image->data + (image->height - 1) * stride,
+      -stride,
+      input->data,
+      (ptrdiff_t) getStride(input),
+      input->width,
+      input->height,
+      input->channels);
 
   return image;
 }
@@ -78,13 +109,16 @@ ShovelerImage* shovelerImageCreateRotatedClockwise(ShovelerImage* input) {
 ShovelerImage* shovelerImageCreateRotatedCounterClockwise(ShovelerImage* input) {
   ShovelerImage* image = shovelerImageCreate(input->height, input->width, input->channels);
 
-  for (unsigned int i = 0; i < image->width; i++) {
-    for (unsigned int j = 0; j < image->height; j++) {
-      for (unsigned int c = 0; c < image->channels; c++) {
-        shovelerImageGet(image, image->height - j - 1, i, c) = shovelerImageGet(input, i, j, c);
-      }
-    }
-  }
+  // the transposed input after flipping it in y
+  ptrdiff_t inputStride = (ptrdiff_t) getStride(input);
+  transpose(
+      image->data,
+      (ptrdiff_t) getStride(image),
+      input->data + (input->height - 1) * inputStride,
+      -inputStride,
+      input->width,
+      input->height,
+      input->channels);
 
   return image;
 }
@@ -92,59 +126,60 @@ ShovelerImage* shovelerImageCreateRotatedCounterClockwise(ShovelerImage* input)
 ShovelerImage* shovelerImageCreateAnimationTileset(ShovelerImage* input, int shiftAmount) {
   assert(input->width == input->height);
   unsigned int size = input->width;
+  unsigned int channels = input->channels;
 
-  ShovelerImage* moveImage = shovelerImageCreate(size, size, input->channels);
-  shovelerImageClear(moveImage);
-  shovelerImageAddSubImage(moveImage, shiftAmount, 0, input);
-  ShovelerImage* moveImage2 = shovelerImageCreateFlippedX(moveImage);
-
-  ShovelerImage* image = shovelerImageCreate(4 * size, 3 * size, input->channels);
+  ShovelerImage* image = shovelerImageCreate(4 * size, 3 * size, channels);
   shovelerImageClear(image);
-  shovelerImageAddSubImage(image, 0, 0, input);
-  shovelerImageAddSubImage(image, 0, size, moveImage);
-  shovelerImageAddSubImage(image, 0, 2 * size, moveImage2);
-
-  ShovelerImage* downImage = shovelerImageCreateFlippedY(input);
-  ShovelerImage* downMoveImage = shovelerImageCreateFlippedY(moveImage);
-  ShovelerImage* downMoveImage2 = shovelerImageCreateFlippedY(moveImage2);
-  shovelerImageAddSubImage(image, size, 0, downImage);
-  shovelerImageAddSubImage(image, size, size, downMoveImage);
-  shovelerImageAddSubImage(image, size, 2 * size, downMoveImage2);
-
-  ShovelerImage* leftImage = shovelerImageCreateRotatedCounterClockwise(input);
-  ShovelerImage* leftMoveImage = shovelerImageCreateRotatedCounterClockwise(moveImage);
-  ShovelerImage* leftMoveImage2 = shovelerImageCreateRotatedCounterClockwise(moveImage2);
-  shovelerImageAddSubImage(image, 2 * size, 0, leftImage);
-  shovelerImageAddSubImage(image, 2 * size, size, leftMoveImage);
-  shovelerImageAddSubImage(image, 2 * size, 2 * size, leftMoveImage2);
-
-  ShovelerImage* rightImage = shovelerImageCreateRotatedClockwise(input);
-  ShovelerImage* rightMoveImage = shovelerImageCreateRotatedClockwise(moveImage);
-  ShovelerImage* rightMoveImage2 = shovelerImageCreateRotatedClockwise(moveImage2);
-  shovelerImageAddSubImage(image, 3 * size, 0, rightImage);
-  shovelerImageAddSubImage(image, 3 * size, size, rightMoveImage);
-  shovelerImageAddSubImage(image, 3 * size, 2 * size, rightMoveImage2);
-
-  shovelerImageFree(moveImage);
-  shovelerImageFree(moveImage2);
-
-  shovelerImageFree(downImage);
-  shovelerImageFree(downMoveImage);
-  shovelerImageFree(downMoveImage2);
-
-  shovelerImageFree(leftImage);
-  shovelerImageFree(leftMoveImage);
-  shovelerImageFree(leftMoveImage2);
-
-  shovelerImageFree(rightImage);
-  shovelerImageFree(rightMoveImage);
-  shovelerImageFree(rightMoveImage2);
+
+  // Every tile is written straight into the tileset: the first column holds the input, the input
+  // shifted in x and that shifted input flipped in x, and the other columns hold these three tiles
+  // flipped in y, rotated counter clockwise and rotated clockwise.
+  ptrdiff_t stride = (ptrdiff_t) getStride(image);
+  ptrdiff_t inputStride = (ptrdiff_t) getStride(input);
+  unsigned char* tiles[3];
+  for (unsigned int row = 0; row < 3; row++) {
+    tiles[row] = image->data + row * size * stride;
+  }
+
+  for (unsigned int j = 0; j < size; j++) {
+    memcpy(tiles[0] + j * stride, input->data + j * inputStride, inputStride);
+  }
+
+  int64_t shiftedStart = shiftAmount > 0 ? shiftAmount : 0;
+  int64_t shiftedEnd = (int64_t) shiftAmount + size < size ? (int64_t) shiftAmount + size : size;
+  if (shiftedStart < shiftedEnd) {
+    for (unsigned int j = 0; j < size; j++) {
+      memcpy(
+          tiles[1] + j * stride + shiftedStart * channels,
+          input->data + j * inputStride + (shiftedStart - shiftAmount) * channels,
+          (shiftedEnd - shiftedStart) * channels);
+    }
+  }
+
+  for (unsigned int j = 0; j < size; j++) {
+    flipRow(tiles[2] + j * stride, tiles[1] + j * stride, size, channels);
+  }
+
+  for (unsigned int row = 0; row < 3; row++) {
+    unsigned char* tile = tiles[row];
+    unsigned char* downTile = tile + size * channels;
+    unsigned char* leftTile = tile + 2 * size * channels;
+    unsigned char* rightTile = tile + 3 * size * channels;
+
+    for (unsigned int j = 0; j < size; j++) {
+      memcpy(downTile + j * stride, tile + (size - j - 1) * stride, size * channels);
+    }
+
+    transpose(leftTile, stride, tile + (size - 1) * stride, -stride, size, size, channels);
+    transpose(rightTile + (size - 1) * stride, -stride, tile, stride, size, size, channels);
+  }
 
   return image;
 }
 
 void shovelerImageClear(ShovelerImage* image) {
   memset(image->data, 0, image->width * image->height * image->channels * sizeof(unsigned char));
+  shovelerImageMarkDirty(image, 0, 0, image->width, image->height);
 }
 
 void shovelerImageSet(ShovelerImage* image, ShovelerColor color, unsigned char alpha) {
@@ -165,23 +200,44 @@ void shovelerImageSet(ShovelerImage* image, ShovelerColor color, unsigned char a
       }
     }
   }
+
+  shovelerImageMarkDirty(image, 0, 0, image->width, image->height);
 }
 
 void shovelerImageAddFrame(ShovelerImage* image, unsigned int size, ShovelerColor color) {
   assert(image->channels == 4);
 
-  for (unsigned int i = 0; i < image->width; i++) {
-    for (unsigned int j = 0; j < image->height; j++) {
-      unsigned int borderDistance = getBorderDistance(image->width, image->height, i, j);
-      if (borderDistance < size) {
-        unsigned char alpha = 255.0 * ((double) (size - borderDistance) / size);
-        shovelerImageGet(image, i, j, 0) = color.r;
-        shovelerImageGet(image, i, j, 1) = color.r;
-        shovelerImageGet(image, i, j, 2) = color.r;
-        shovelerImageGet(image, i, j, 3) = alpha;
+  // no pixel is further than this from the border, so only the first few distances need an alpha
+  unsigned int maxBorderDistance = (minInt(image->width, image->height) - 1) / 2;
+  unsigned int numAlphas = minInt(size, maxBorderDistance + 1);
+  unsigned char* alphas = malloc(numAlphas * sizeof(unsigned char));
+  for (unsigned int borderDistance = 0; borderDistance < numAlphas; borderDistance++) {
+    alphas[borderDistance] = 255.0 * ((double) (size - borderDistance) / size);
+  }
+
+  size_t stride = getStride(image);
+  for (unsigned int j = 0; j < image->height; j++) {
+    unsigned char* row = image->data + j * stride;
+    unsigned int rowBorderDistance = minInt(j, image->height - 1 - j);
+
+    if (rowBorderDistance < numAlphas) {
+      for (unsigned int i = 0; i < image->width; i++) {
+        unsigned int borderDistance =
+            minInt(rowBorderDistance, minInt(i, image->width - 1 - i));
+        setFramePixel(row + i * 4, color, alphas[borderDistance]);
+      }
+    } else {
+      // only the left and right ends of this row are closer to the border than size
+      for (unsigned int i = 0; i < numAlphas; i++) {
+        setFramePixel(row + i * 4, color, alphas[i]);
+        setFramePixel(row + (image->width - 1 - i) * 4, color, alphas[i]);
       }
     }
   }
+
+  free(alphas);
+
+  shovelerImageMarkDirty(image, 0, 0, image->width, image->height);
 }
 
 void shovelerImageAddSubImage(
@@ -196,31 +252,41 @@ void shovelerImageAddSubImage(
           subImage->height); // adding yOffset to subImage->height will never overflow
   assert(image->channels == subImage->channels);
 
-  for (unsigned int i = 0; i < subImage->width; i++) {
-    if (xOffset < 0 && (unsigned int) -xOffset > i) {
-      continue; // would result in negative imageI
-    }
+  // clip the sub image against the image once, then copy whatever is left row by row
+  int64_t minX = xOffset > 0 ? xOffset : 0;
+  int64_t maxX = (int64_t) xOffset + subImage->width;
+  maxX = maxX < image->width ? maxX : image->width;
+  int64_t minY = yOffset > 0 ? yOffset : 0;
+  int64_t maxY = (int64_t) yOffset + subImage->height;
+  maxY = maxY < image->height ? maxY : image->height;
+  if (minX >= maxX || minY >= maxY) {
+    return;
+  }
 
-    unsigned int imageI = xOffset + i;
-    if (imageI >= image->width) {
-      continue;
-    }
+  size_t stride = getStride(image);
+  size_t subImageStride = getStride(subImage);
+  size_t rowSize = (size_t) (maxX - minX) * image->channels;
+  for (int64_t y = minY; y < maxY; y++) {
+    memcpy(
+        image->data + y * stride + minX * image->channels,
+        subImage->data + (y - yOffset) * subImageStride + (minX - xOffset) * image->channels,
+        rowSize);
+  }
 
-    for (unsigned int j = 0; j < subImage->height; j++) {
-      if (yOffset < 0 && (unsigned int) -yOffset > j) {
-        continue; // would result in negative imageJ
-      }
+  shovelerImageMarkDirty(
+      image,
+      (unsigned int) minX,
+      (unsigned int) minY,
+      (unsigned int) (maxX - minX),
+      (unsigned int) (maxY - minY));
+}
 
-      unsigned int imageJ = yOffset + j;
-      if (imageJ >= image->height) {
-        continue;
-      }
+void shovelerImageMarkDirty(
+    ShovelerImage* image, unsigned int x, unsigned int y, unsigned int width, unsigned int height) {
+  assert(x <= image->width && width <= image->width - x);
+  assert(y <= image->height && height <= image->height - y);
 
-      for (unsigned int c = 0; c < subImage->channels; c++) {
-        shovelerImageGet(image, imageI, imageJ, c) = shovelerImageGet(subImage, i, j, c);
-      }
-    }
-  }
+  shovelerDirtyRegionAdd(&image->dirtyRegion, x, y, width, height);
 }
 
 void shovelerImageFree(ShovelerImage* image) {
@@ -232,16 +298,166 @@ void shovelerImageFree(ShovelerImage* image) {
   free(image);
 }
 
-static unsigned int getBorderDistance(
-    unsigned int width, unsigned int height, unsigned int i, unsigned int j) {
-  assert(i < width);
-  assert(j < height);
+static size_t getStride(ShovelerImage* image) {
+  return (size_t) image->width * image->channels * sizeof(unsigned char);
+}
+
+static void flipRow(
+    unsigned char* target, const unsigned char* source, unsigned int width, unsigned int channels) {
+  unsigned int i = 0;
+
+#if defined(SHOVELER_IMAGE_USE_SSE2) || defined(SHOVELER_IMAGE_USE_NEON)
+  if (channels == 4) {
+    // reverse four pixels at a time by reversing the 32 bit lanes of a vector
+    for (; i + 4 <= width; i += 4) {
+      const unsigned char* sourcePixels = source + (width - i - 4) * 4;
+#ifdef SHOVELER_IMAGE_USE_SSE2
+      __m128i pixels = _mm_loadu_si128((const __m128i*) sourcePixels);
+      pixels = _mm_shuffle_epi32(pixels, _MM_SHUFFLE(0, 1, 2, 3));
+      _mm_storeu_si128((__m128i*) (target + i * 4), pixels);
+#else
+      uint32x4_t pixels = vreinterpretq_u32_u8(vld1q_u8(sourcePixels));
+      pixels = vrev64q_u32(pixels);
+      pixels = vextq_u32(pixels, pixels, 2);
+      vst1q_u8(target + i * 4, vreinterpretq_u8_u32(pixels));
+#endif
+    }
+  }
+#endif
+
+  for (; i < width; i++) {
+    copyPixel(target + i * channels, source + (width - i - 1) * channels, channels);
+  }
+}
+
+/**
+ * Writes the transpose of the width times height source to the height times width target, so that
+ * target pixel (x, y) is source pixel (y, x). Strides may be negative to walk rows in reverse.
+ */
+static void transpose(
+    unsigned char* target,
+    ptrdiff_t targetStride,
+    const unsigned char* source,
+    ptrdiff_t sourceStride,
+    unsigned int width,
+    unsigned int height,
+    unsigned int channels) {
+  for (unsigned int y = 0; y < height; y += TRANSPOSE_TILE_SIZE) {
+    unsigned int tileHeight = minInt(TRANSPOSE_TILE_SIZE, height - y);
+    for (unsigned int x = 0; x < width; x += TRANSPOSE_TILE_SIZE) {
+      unsigned int tileWidth = minInt(TRANSPOSE_TILE_SIZE, width - x);
+      transposeTile(
+          target + (ptrdiff_t) x * targetStride + y * channels,
+          targetStride,
+          source + (ptrdiff_t) y * sourceStride + x * channels,
+          sourceStride,
+          tileWidth,
+          tileHeight,
+          channels);
+    }
+  }
+}
+
+static void transposeTile(
+    unsigned char* target,
+    ptrdiff_t targetStride,
+    const unsigned char* source,
+    ptrdiff_t sourceStride,
+    unsigned int width,
+    unsigned int height,
+    unsigned int channels) {
+  unsigned int y = 0;
+
+#if defined(SHOVELER_IMAGE_USE_SSE2) || defined(SHOVELER_IMAGE_USE_NEON)
+  if (channels == 4) {
+    // transpose blocks of four by four pixels in registers, treating each pixel as a 32 bit lane
+    for (; y + 4 <= height; y += 4) {
+      unsigned int x = 0;
+      for (; x + 4 <= width; x += 4) {
+        const unsigned char* sourceBlock = source + (ptrdiff_t) y * sourceStride + x * 4;
+        unsigned char* targetBlock = target + (ptrdiff_t) x * targetStride + y * 4;
+#ifdef SHOVELER_IMAGE_USE_SSE2
+        __m128i row0 = _mm_loadu_si128((const __m128i*) sourceBlock);
+        __m128i row1 = _mm_loadu_si128((const __m128i*) (sourceBlock + sourceStride));
+        __m128i row2 = _mm_loadu_si128((const __m128i*) (sourceBlock + 2 * sourceStride));
+        __m128i row3 = _mm_loadu_si128((const __m128i*) (sourceBlock + 3 * sourceStride));
+        __m128i low01 = _mm_unpacklo_epi32(row0, row1);
+        __m128i low23 = _mm_unpacklo_epi32(row2, row3);
+        __m128i high01 = _mm_unpackhi_epi32(row0, row1);
+        __m128i high23 = _mm_unpackhi_epi32(row2, row3);
+        _mm_storeu_si128((__m128i*) targetBlock, _mm_unpacklo_epi64(low01, low23));
+        _mm_storeu_si128(
+            (__m128i*) (targetBlock + targetStride), _mm_unpackhi_epi64(low01, low23));
+        _mm_storeu_si128(
+            (__m128i*) (targetBlock + 2 * targetStride), _mm_unpacklo_epi64(high01, high23));
+        _mm_storeu_si128(
+            (__m128i*) (targetBlock + 3 * targetStride), _mm_unpackhi_epi64(high01, high23));
+#else
+        uint32x4_t row0 = vreinterpretq_u32_u8(vld1q_u8(sourceBlock));
+        uint32x4_t row1 = vreinterpretq_u32_u8(vld1q_u8(sourceBlock + sourceStride));
+        uint32x4_t row2 = vreinterpretq_u32_u8(vld1q_u8(sourceBlock + 2 * sourceStride));
+        uint32x4_t row3 = vreinterpretq_u32_u8(vld1q_u8(sourceBlock + 3 * sourceStride));
+        uint32x4x2_t rows01 = vtrnq_u32(row0, row1);
+        uint32x4x2_t rows23 = vtrnq_u32(row2, row3);
+        uint32x4_t column0 = vcombine_u32(vget_low_u32(rows01.val[0]), vget_low_u32(rows23.val[0]));
+        uint32x4_t column1 = vcombine_u32(vget_low_u32(rows01.val[1]), vget_low_u32(rows23.val[1]));
+        uint32x4_t column2 =
+            vcombine_u32(vget_high_u32(rows01.val[0]), vget_high_u32(rows23.val[0]));
+        uint32x4_t column3 =
+            vcombine_u32(vget_high_u32(rows01.val[1]), vget_high_u32(rows23.val[1]));
+        vst1q_u8(targetBlock, vreinterpretq_u8_u32(column0));
+        vst1q_u8(targetBlock + targetStride, vreinterpretq_u8_u32(column1));
+        vst1q_u8(targetBlock + 2 * targetStride, vreinterpretq_u8_u32(column2));
+        vst1q_u8(targetBlock + 3 * targetStride, vreinterpretq_u8_u32(column3));
+#endif
+      }
+
+      for (; x < width; x++) {
+        for (unsigned int blockY = y; blockY < y + 4; blockY++) {
+          copyPixel(
+              target + (ptrdiff_t) x * targetStride + blockY * 4,
+              source + (ptrdiff_t) blockY * sourceStride + x * 4,
+              4);
+        }
+      }
+    }
+  }
+#endif
+
+  for (; y < height; y++) {
+    for (unsigned int x = 0; x < width; x++) {
+      copyPixel(
+          target + (ptrdiff_t) x * targetStride + y * channels,
+          source + (ptrdiff_t) y * sourceStride + x * channels,
+          channels);
+    }
+  }
+}
+
+static inline void copyPixel(
+    unsigned char* target, const unsigned char* source, unsigned int channels) {
+  // constant sizes for the common channel counts let the copies compile down to single moves
+  switch (channels) {
+  case 1:
+    target[0] = source[0];
+    break;
+  case 3:
+    memcpy(target, source, 3);
+    break;
+  case 4:
+    memcpy(target, source, 4);
+    break;
+  default:
+    memcpy(target, source, channels);
+    break;
+  }
+}
 
-  unsigned int xLow = i;
-  unsigned int xHigh = width - 1 - i;
-  unsigned int yLow = j;
-  unsigned int yHigh = height - 1 - j;
-  return minInt(xLow, minInt(xHigh, minInt(yLow, yHigh)));
+static inline void setFramePixel(unsigned char* target, ShovelerColor color, unsigned char alpha) {
+  target[0] = color.r;
+  target[1] = color.r;
+  target[2] = color.r;
+  target[3] = alpha;
 }
 
 static unsigned int minInt(unsigned int a, unsigned int b) {
@@ -0,0 +1,164 @@
+#include "shoveler/image/mipmap.h"
+
+#include <assert.h> // assert
+#include <stdint.h> // uint16_t uint32_t
+#include <stdlib.h> // malloc free
+
+/**
+ * sRGB encoded values decoded to linear intensities scaled to 16 bits.
+ *
+ * The table is written out rather than computed with pow at runtime, so that the gamma correct
+ * filter gives the same results with every math library.
+ */
+static const uint16_t srgbToLinear[256] = {
+    0, 20, 40, 60, 80, 99, 119, 139, 159, 179, 199, 219,
+    241, 264, 288, 313, 340, 367, 396, 427, 458, 491, 526, 562,
+    599, 637, 677, 718, 761, 805, 851, 898, 947, 997, 1048, 1101,
+    1156, 1212, 1270, 1330, 1391, 1453, 1517, 1583, 1651, 1720, 1790, 1863,
+    1937, 2013, 2090, 2170, 2250, 2333, 2418, 2504, 2592, 2681, 2773, 2866,
+    2961, 3058, 3157, 3258, 3360, 3464, 3570, 3678, 3788, 3900, 4014, 4129,
+    4247, 4366, 4488, 4611, 4736, 4864, 4993, 5124, 5257, 5392, 5530, 5669,
+    5810, 5953, 6099, 6246, 6395, 6547, 6700, 6856, 7014, 7174, 7335, 7500,
+    7666, 7834, 8004, 8177, 8352, 8528, 8708, 8889, 9072, 9258, 9445, 9635,
+    9828, 10022, 10219, 10417, 10619, 10822, 11028, 11235, 11446, 11658, 11873, 12090,
+    12309, 12530, 12754, 12980, 13209, 13440, 13673, 13909, 14146, 14387, 14629, 14874,
+    15122, 15371, 15623, 15878, 16135, 16394, 16656, 16920, 17187, 17456, 17727, 18001,
+    18277, 18556, 18837, 19121, 19407, 19696, 19987, 20281, 20577, 20876, 21177, 21481,
+    21787, 22096, 22407, 22721, 23038, 23357, 23678, 24002, 24329, 24658, 24990, 25325,
+    25662, 26001, 26344, 26688, 27036, 27386, 27739, 28094, 28452, 28813, 29176, 29542,
+    29911, 30282, 30656, 31033, 31412, 31794, 32179, 32567, 32957, 33350, 33745, 34143,
+    34544, 34948, 35355, 35764, 36176, 36591, 37008, 37429, 37852, 38278, 38706, 39138,
+    39572, 40009, 40449, 40891, 41337, 41785, 42236, 42690, 43147, 43606, 44069, 44534,
+    45002, 45473, 45947, 46423, 46903, 47385, 47871, 48359, 48850, 49344, 49841, 50341,
+    50844, 51349, 51858, 52369, 52884, 53401, 53921, 54445, 54971, 55500, 56032, 56567,
+    57105, 57646, 58190, 58737, 59287, 59840, 60396, 60955, 61517, 62082, 62650, 63221,
+    63795, 64372, 64952, 65535,
+};
+
+static void filterRow(
+    unsigned char* target,
+    const unsigned char* sourceRow0,
+    const unsigned char* sourceRow1,
+    unsigned int sourceWidth,
+    unsigned int targetWidth,
+    unsigned int channels,
+    ShovelerImageMipmapFilter filter);
+static unsigned char encodeLinear(uint32_t linear);
+static unsigned int getLevelSize(unsigned int size);
+
+int shovelerImageMipmapGetNumLevels(unsigned int width, unsigned int height) {
+  unsigned int size = width > height ? width : height;
+
+  int numLevels = 1;
+  while (size > 1) {
+    size /= 2;
+    numLevels++;
+  }
+
+  return numLevels;
+}
+
+ShovelerImage* shovelerImageMipmapCreateLevel(
+    ShovelerImage* image, ShovelerImageMipmapFilter filter) {
+  ShovelerImage* level = shovelerImageCreate(
+      getLevelSize(image->width), getLevelSize(image->height), image->channels);
+
+  size_t sourceStride = (size_t) image->width * image->channels;
+  size_t targetStride = (size_t) level->width * level->channels;
+  for (unsigned int j = 0; j < level->height; j++) {
+    unsigned int sourceJ0 = 2 * j;
+    unsigned int sourceJ1 = sourceJ0 + 1 < image->height ? sourceJ0 + 1 : image->height - 1;
+    filterRow(
+        level->data + j * targetStride,
+        image->data + sourceJ0 * sourceStride,
+        image->data + sourceJ1 * sourceStride,
+        image->width,
+        level->width,
+        image->channels,
+        filter);
+  }
+
+  return level;
+}
+
+ShovelerImageMipmaps* shovelerImageMipmapsCreate(
+    ShovelerImage* image, ShovelerImageMipmapFilter filter) {
+  ShovelerImageMipmaps* mipmaps = malloc(sizeof(ShovelerImageMipmaps));
+  mipmaps->numLevels = shovelerImageMipmapGetNumLevels(image->width, image->height);
+  mipmaps->levels = malloc(mipmaps->numLevels * sizeof(ShovelerImage*));
+  mipmaps->levels[0] = image;
+
+  for (int i = 1; i < mipmaps->numLevels; i++) {
+    mipmaps->levels[i] = shovelerImageMipmapCreateLevel(mipmaps->levels[i - 1], filter);
+  }
+
+  return mipmaps;
+}
+
+void shovelerImageMipmapsFree(ShovelerImageMipmaps* mipmaps) {
+  if (mipmaps == NULL) {
+    return;
+  }
+
+  for (int i = 1; i < mipmaps->numLevels; i++) {
+    shovelerImageFree(mipmaps->levels[i]);
+  }
+
+  free(mipmaps->levels);
+  free(mipmaps);
+}
+
+static void filterRow(
+    unsigned char* target,
+    const unsigned char* sourceRow0,
+    const unsigned char* sourceRow1,
+    unsigned int sourceWidth,
+    unsigned int targetWidth,
+    unsigned int channels,
+    ShovelerImageMipmapFilter filter) {
+  unsigned int numColorChannels = 0;
+  if (filter == SHOVELER_IMAGE_MIPMAP_FILTER_GAMMA_CORRECT && channels >= 3) {
+    numColorChannels = 3;
+  }
+
+  for (unsigned int i = 0; i < targetWidth; i++) {
+    unsigned int sourceI0 = 2 * i;
+    unsigned int sourceI1 = sourceI0 + 1 < sourceWidth ? sourceI0 + 1 : sourceWidth - 1;
+    const unsigned char* topLeft = sourceRow0 + sourceI0 * channels;
+    const unsigned char* topRight = sourceRow0 + sourceI1 * channels;
+    const unsigned char* bottomLeft = sourceRow1 + sourceI0 * channels;
+    const unsigned char* bottomRight = sourceRow1 + sourceI1 * channels;
+
+    unsigned int c = 0;
+    for (; c < numColorChannels; c++) {
+      uint32_t sum = (uint32_t) srgbToLinear[topLeft[c]] + srgbToLinear[topRight[c]] +
+          srgbToLinear[bottomLeft[c]] + srgbToLinear[bottomRight[c]];
+      target[i * channels + c] = encodeLinear((sum + 2) / 4);
+    }
+
+    for (; c < channels; c++) {
+      unsigned int sum = topLeft[c] + topRight[c] + bottomLeft[c] + bottomRight[c];
+      target[i * channels + c] = (unsigned char) ((sum + 2) / 4);
+    }
+  }
+}
+
+/** Returns the sRGB value whose linear intensity is closest, preferring the larger one on ties. */
+static unsigned char encodeLinear(uint32_t linear) {
+  // Binary search for the first value decoding to at least the given intensity, written so that
+  // the comparisons compile to conditional moves rather than hard to predict branches.
+  unsigned int low = 0;
+  for (unsigned int step = 128; step > 0; step /= 2) {
+    low = srgbToLinear[low + step - 1] < linear ? low + step : low;
+  }
+
+  if (low > 0 && linear - srgbToLinear[low - 1] < srgbToLinear[low] - linear) {
+    return (unsigned char) (low - 1);
+  }
+
+  return (unsigned char) low;
+}
+
+static unsigned int getLevelSize(unsigned int size) {
+  return size > 1 ? size / 2 : 1;
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include "image_testing.h"
+
+extern "C" {
+#include "shoveler/image.h"
+#include "shoveler/image/mipmap.h"
+}
+
+class ShovelerImageMipmapTest : public ::testing::Test {};
+
+static ShovelerImage* createImage(
+    unsigned int width, unsigned int height, unsigned int channels, const unsigned char* data) {
+  ShovelerImage* image = shovelerImageCreate(width, height, channels);
+  memcpy(image->data, data, width * height * channels);
+  return image;
+}
+
+TEST_F(ShovelerImageMipmapTest, numLevels) {
+  ASSERT_EQ(shovelerImageMipmapGetNumLevels(1, 1), 1);
+  ASSERT_EQ(shovelerImageMipmapGetNumLevels(2, 1), 2);
+  ASSERT_EQ(shovelerImageMipmapGetNumLevels(3, 3), 2);
+  ASSERT_EQ(shovelerImageMipmapGetNumLevels(16, 4), 5);
+  ASSERT_EQ(shovelerImageMipmapGetNumLevels(5, 1024), 11);
+  ASSERT_EQ(shovelerImageMipmapGetNumLevels(1023, 1), 10);
+}
+
+TEST_F(ShovelerImageMipmapTest, boxRounding) {
+  const unsigned char data[] = {1, 2, 3, 4, 0, 0, 0, 1, 255, 254, 255, 255};
+  ShovelerImage* image = createImage(2, 2, 3, data);
+
+  ShovelerImage* level = shovelerImageMipmapCreateLevel(image, SHOVELER_IMAGE_MIPMAP_FILTER_BOX);
+  ASSERT_EQ(level->width, 1);
+  ASSERT_EQ(level->height, 1);
+  // (1 + 4 + 0 + 254 + 2) / 4, (2 + 0 + 1 + 255 + 2) / 4 with a tie, (3 + 0 + 255 + 255 + 2) / 4
+  ASSERT_EQ(shovelerImageGet(level, 0, 0, 0), 65);
+  ASSERT_EQ(shovelerImageGet(level, 0, 0, 1), 65);
+  ASSERT_EQ(shovelerImageGet(level, 0, 0, 2), 128);
+
+  shovelerImageFree(level);
+  shovelerImageFree(image);
+}
+
+TEST_F(ShovelerImageMipmapTest, boxOddSize) {
+  // 5x3, of which the last column and row are dropped
+  const unsigned char data[] = {
+      0, 4, 8, 12, 99, //
+      4, 8, 12, 16, 99, //
+      99, 99, 99, 99, 99};
+  ShovelerImage* image = createImage(5, 3, 1, data);
+
+  ShovelerImage* level = shovelerImageMipmapCreateLevel(image, SHOVELER_IMAGE_MIPMAP_FILTER_BOX);
+  ASSERT_EQ(level->width, 2);
+  ASSERT_EQ(level->height, 1);
+  ASSERT_EQ(shovelerImageGet(level, 0, 0, 0), 4);
+  ASSERT_EQ(shovelerImageGet(level, 1, 0, 0), 12);
+
+  shovelerImageFree(level);
+  shovelerImageFree(image);
+}
+
+TEST_F(ShovelerImageMipmapTest, boxSinglePixelWide) {
+  const unsigned char data[] = {10, 21, 30, 41};
+  ShovelerImage* image = createImage(1, 4, 1, data);
+
+  ShovelerImage* level = shovelerImageMipmapCreateLevel(image, SHOVELER_IMAGE_MIPMAP_FILTER_BOX);
+  ASSERT_EQ(level->width, 1);
+  ASSERT_EQ(level->height, 2);
+  // the single column is clamped, so each pixel counts twice: (2 * 10 + 2 * 21 + 2) / 4
+  ASSERT_EQ(shovelerImageGet(level, 0, 0, 0), 16);
+  ASSERT_EQ(shovelerImageGet(level, 0, 1, 0), 36);
+
+  shovelerImageFree(level);
+  shovelerImageFree(image);
+}
+
+TEST_F(ShovelerImageMipmapTest, chain) {
+  ShovelerImage* image = shovelerImageCreate(16, 4, 4);
+  for (unsigned int i = 0; i < 16 * 4 * 4; i++) {
+    image->data[i] = (unsigned char) (i * 37);
+  }
+
+  ShovelerImageMipmaps* mipmaps =
+      shovelerImageMipmapsCreate(image, SHOVELER_IMAGE_MIPMAP_FILTER_BOX);
+  ASSERT_EQ(mipmaps->numLevels, 5);
+  ASSERT_EQ(mipmaps->levels[0], image);
+
+  const unsigned int expectedWidths[] = {16, 8, 4, 2, 1};
+  const unsigned int expectedHeights[] = {4, 2, 1, 1, 1};
+  for (int i = 1; i < mipmaps->numLevels; i++) {
+    ASSERT_EQ(mipmaps->levels[i]->width, expectedWidths[i]);
+    ASSERT_EQ(mipmaps->levels[i]->height, expectedHeights[i]);
+    ASSERT_EQ(mipmaps->levels[i]->channels, 4);
+
+    ShovelerImage* expectedLevel =
+        shovelerImageMipmapCreateLevel(mipmaps->levels[i - 1], SHOVELER_IMAGE_MIPMAP_FILTER_BOX);
+    ASSERT_EQ(*mipmaps->levels[i], *expectedLevel) << "level " << i;
+    shovelerImageFree(expectedLevel);
+  }
+
+  shovelerImageMipmapsFree(mipmaps);
+  shovelerImageFree(image);
+}
+
+TEST_F(ShovelerImageMipmapTest, gammaCorrectUniform) {
+  // every uniform color has to survive decoding to linear and encoding back unchanged
+  for (unsigned int value = 0; value < 256; value++) {
+    ShovelerImage* image = shovelerImageCreate(2, 2, 4);
+    memset(image->data, value, 2 * 2 * 4);
+
+    ShovelerImage* level =
+        shovelerImageMipmapCreateLevel(image, SHOVELER_IMAGE_MIPMAP_FILTER_GAMMA_CORRECT);
+    for (unsigned int c = 0; c < 4; c++) {
+      ASSERT_EQ(shovelerImageGet(level, 0, 0, c), value) << "channel " << c;
+    }
+
+    shovelerImageFree(level);
+    shovelerImageFree(image);
+  }
+}
+
+TEST_F(ShovelerImageMipmapTest, gammaCorrectCheckerboard) {
+  const unsigned char data[] = {
+      0, 0, 0, 0, 255, 255, 255, 255, //
+      255, 255, 255, 255, 0, 0, 0, 0};
+  ShovelerImage* image = createImage(2, 2, 4, data);
+
+  ShovelerImage* boxLevel =
+      shovelerImageMipmapCreateLevel(image, SHOVELER_IMAGE_MIPMAP_FILTER_BOX);
+  ShovelerImage* gammaCorrectLevel =
+      shovelerImageMipmapCreateLevel(image, SHOVELER_IMAGE_MIPMAP_FILTER_GAMMA_CORRECT);
+  for (unsigned int c = 0; c < 3; c++) {
+    ASSERT_EQ(shovelerImageGet(boxLevel, 0, 0, c), 128);
+    // half the linear intensity of white is brighter than half the encoded value
+    ASSERT_EQ(shovelerImageGet(gammaCorrectLevel, 0, 0, c), 188);
+  }
+  // alpha is linear either way
+  ASSERT_EQ(shovelerImageGet(boxLevel, 0, 0, 3), 128);
+  ASSERT_EQ(shovelerImageGet(gammaCorrectLevel, 0, 0, 3), 128);
+
+  shovelerImageFree(boxLevel);
+  shovelerImageFree(gammaCorrectLevel);
+  shovelerImageFree(image);
+}
+
+TEST_F(ShovelerImageMipmapTest, gammaCorrectSingleChannelIsBox) {
+  const unsigned char data[] = {0, 255, 255, 0, 17, 200, 3, 90};
+  ShovelerImage* image = createImage(4, 2, 1, data);
+
+  ShovelerImage* boxLevel =
+      shovelerImageMipmapCreateLevel(image, SHOVELER_IMAGE_MIPMAP_FILTER_BOX);
+  ShovelerImage* gammaCorrectLevel =
+      shovelerImageMipmapCreateLevel(image, SHOVELER_IMAGE_MIPMAP_FILTER_GAMMA_CORRECT);
+  ASSERT_EQ(*gammaCorrectLevel, *boxLevel);
+
+  shovelerImageFree(boxLevel);
+  shovelerImageFree(gammaCorrectLevel);
+  shovelerImageFree(image);
+}
@@ -2,13 +2,14 @@
 
 #include <assert.h> // assert
 #include <glib.h>
-#include <limits.h> // UINT_MAX
+#include <limits.h> // INT_MAX UINT_MAX
 #include <png.h>
 #include <setjmp.h> // setjmp
 #include <stdio.h> // fread
 #include <stdlib.h> // malloc, free
 #include <string.h> // memcpy
 
+#include "shoveler/file.h"
 #include "shoveler/input_stream.h"
 #include "shoveler/log.h"
 
@@ -32,14 +33,24 @@ static void handlePngReadWarning(png_structp png, png_const_charp warning);
 static void freeRowPointers(png_uint_32 height, png_bytep* rowPointers);
 
 ShovelerImage* shovelerImagePngReadFile(const char* filename) {
-  ShovelerInputStream* inputStream = shovelerInputStreamCreateFile(filename);
-  if (inputStream == NULL) {
+  ShovelerMappedFile* mappedFile = shovelerFileMap(filename);
+  if (mappedFile == NULL) {
     return NULL;
   }
 
-  ShovelerImage* image = readPng(inputStream);
+  ShovelerImage* image;
+  if (mappedFile->size <= INT_MAX) {
+    // decode straight from the mapping rather than through stdio
+    image = shovelerImagePngReadBuffer(mappedFile->data, (int) mappedFile->size);
+  } else {
+    shovelerLogError(
+        "Failed to read PNG image from '%s': File size %zu is too large.",
+        filename,
+        mappedFile->size);
+    image = NULL;
+  }
 
-  shovelerInputStreamFree(inputStream);
+  shovelerFileUnmap(mappedFile);
 
   return image;
 }
@@ -0,0 +1,250 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "image_testing.h"
+
+extern "C" {
+#include <glib.h>
+
+#include "shoveler/image.h"
+#include "shoveler/log.h"
+}
+
+/**
+ * Benchmark for the image transforms, comparing the original per pixel implementations kept in
+ * image_testing with the row oriented and vectorized ones in image.c.
+ *
+ * Every transform runs on square noise images of increasing size with three and four channels,
+ * the latter being the case covered by SSE2 and NEON. Each result is checked against the
+ * reference result before timing, so a mismatch fails the benchmark instead of reporting numbers.
+ *
+ * Every measurement is written to stdout as a single line JSON object, so that the output of
+ * repeated runs can be collected and compared over time. Log messages go to stderr.
+ *
+ * Usage: shoveler_base_image_benchmark [--max-size=1024] [--repetitions=10]
+ */
+
+struct BenchmarkOptions {
+  unsigned int maxSize;
+  int repetitions;
+};
+
+enum class Transform {
+  kFlipX,
+  kFlipY,
+  kRotateClockwise,
+  kRotateCounterClockwise,
+  kAddSubImage,
+  kAddFrame,
+  kAnimationTileset,
+};
+
+static bool parseOptions(int argc, char** argv, BenchmarkOptions* options);
+static ShovelerImage* createNoiseImage(unsigned int size, unsigned int channels);
+static bool runTransform(
+    const BenchmarkOptions& options,
+    Transform transform,
+    ShovelerImage* input,
+    ShovelerImage* canvas);
+static ShovelerImage* applyTransform(
+    Transform transform, bool reference, ShovelerImage* input, ShovelerImage* canvas);
+static const char* getTransformName(Transform transform);
+static double elapsedMs(gint64 startTime);
+
+int main(int argc, char** argv) {
+  BenchmarkOptions options;
+  if (!parseOptions(argc, argv, &options)) {
+    fprintf(stderr, "Usage: %s [--max-size=1024] [--repetitions=10]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  shovelerLogInit("shoveler/", SHOVELER_LOG_LEVEL_WARNING_UP, stderr);
+
+  const Transform transforms[] = {
+      Transform::kFlipX,
+      Transform::kFlipY,
+      Transform::kRotateClockwise,
+      Transform::kRotateCounterClockwise,
+      Transform::kAddSubImage,
+      Transform::kAddFrame,
+      Transform::kAnimationTileset,
+  };
+
+  bool success = true;
+  for (unsigned int size = 64; size <= options.maxSize; size *= 4) {
+    for (unsigned int channels = 3; channels <= 4; channels++) {
+      ShovelerImage* input = createNoiseImage(size, channels);
+      ShovelerImage* canvas = createNoiseImage(size, channels);
+
+      for (Transform transform : transforms) {
+        if (transform == Transform::kAddFrame && channels != 4) {
+          continue;
+        }
+
+        success = runTransform(options, transform, input, canvas) && success;
+      }
+
+      shovelerImageFree(input);
+      shovelerImageFree(canvas);
+    }
+  }
+
+  shovelerLogTerminate();
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static bool parseOptions(int argc, char** argv, BenchmarkOptions* options) {
+  options->maxSize = 1024;
+  options->repetitions = 10;
+
+  for (int i = 1; i < argc; i++) {
+    std::string argument = argv[i];
+    size_t separator = argument.find('=');
+    if (argument.compare(0, 2, "--") != 0 || separator == std::string::npos) {
+      return false;
+    }
+
+    std::string name = argument.substr(2, separator - 2);
+    std::string value = argument.substr(separator + 1);
+    if (name == "max-size" && atoi(value.c_str()) >= 64) {
+      options->maxSize = (unsigned int) atoi(value.c_str());
+    } else if (name == "repetitions" && atoi(value.c_str()) > 0) {
+      options->repetitions = atoi(value.c_str());
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static ShovelerImage* createNoiseImage(unsigned int size, unsigned int channels) {
+  ShovelerImage* image = shovelerImageCreate(size, size, channels);
+  uint32_t state = size * 7919u + channels;
+  for (unsigned int i = 0; i < size * size * channels; i++) {
+    state = state * 1664525u + 1013904223u;
+    image->data[i] = (unsigned char) (state >> 24);
+  }
+  return image;
+}
+
+static bool runTransform(
+    const BenchmarkOptions& options,
+    Transform transform,
+    ShovelerImage* input,
+    ShovelerImage* canvas) {
+  ShovelerImage* result = applyTransform(transform, /* reference */ false, input, canvas);
+  ShovelerImage* referenceResult = applyTransform(transform, /* reference */ true, input, canvas);
+  bool matches = *result == *referenceResult;
+  shovelerImageFree(result);
+  shovelerImageFree(referenceResult);
+  if (!matches) {
+    fprintf(
+        stderr,
+        "%s on a %ux%u image with %u channels doesn't match the reference.\n",
+        getTransformName(transform),
+        input->width,
+        input->height,
+        input->channels);
+    return false;
+  }
+
+  double minMs[2] = {0.0, 0.0};
+  for (int reference = 0; reference < 2; reference++) {
+    for (int repetition = 0; repetition < options.repetitions; repetition++) {
+      gint64 startTime = g_get_monotonic_time();
+      ShovelerImage* image = applyTransform(transform, reference != 0, input, canvas);
+      double repetitionMs = elapsedMs(startTime);
+      shovelerImageFree(image);
+
+      if (repetition == 0 || repetitionMs < minMs[reference]) {
+        minMs[reference] = repetitionMs;
+      }
+    }
+  }
+
+  printf(
+      "{\"benchmark\": \"image_transform\", \"transform\": \"%s\", \"size\": %u, "
+      "\"channels\": %u, \"repetitions\": %d, \"reference_min_ms\": %.3f, \"min_ms\": %.3f, "
+      "\"speedup\": %.2f}\n",
+      getTransformName(transform),
+      input->width,
+      input->channels,
+      options.repetitions,
+      minMs[1],
+      minMs[0],
+      minMs[0] > 0.0 ? minMs[1] / minMs[0] : 0.0);
+  fflush(stdout);
+  return true;
+}
+
+/** Returns a new image holding the transform's result, drawing onto a copy of canvas if needed. */
+static ShovelerImage* applyTransform(
+    Transform transform, bool reference, ShovelerImage* input, ShovelerImage* canvas) {
+  switch (transform) {
+  case Transform::kFlipX:
+    return reference ? shovelerImageReferenceCreateFlippedX(input)
+                     : shovelerImageCreateFlippedX(input);
+  case Transform::kFlipY:
+    return reference ? shovelerImageReferenceCreateFlippedY(input)
+                     : shovelerImageCreateFlippedY(input);
+  case Transform::kRotateClockwise:
+    return reference ? shovelerImageReferenceCreateRotatedClockwise(input)
+                     : shovelerImageCreateRotatedClockwise(input);
+  case Transform::kRotateCounterClockwise:
+    return reference ? shovelerImageReferenceCreateRotatedCounterClockwise(input)
+                     : shovelerImageCreateRotatedCounterClockwise(input);
+  case Transform::kAddSubImage: {
+    ShovelerImage* image = shovelerImageCreateCopy(canvas);
+    int offset = (int) input->width / 4;
+    if (reference) {
+      shovelerImageReferenceAddSubImage(image, offset, offset, input);
+    } else {
+      shovelerImageAddSubImage(image, offset, offset, input);
+    }
+    return image;
+  }
+  case Transform::kAddFrame: {
+    ShovelerImage* image = shovelerImageCreateCopy(canvas);
+    unsigned int frameSize = input->width / 8;
+    if (reference) {
+      shovelerImageReferenceAddFrame(image, frameSize, shovelerColor(255, 200, 255));
+    } else {
+      shovelerImageAddFrame(image, frameSize, shovelerColor(255, 200, 255));
+    }
+    return image;
+  }
+  case Transform::kAnimationTileset:
+    return reference ? shovelerImageReferenceCreateAnimationTileset(input, 1)
+                     : shovelerImageCreateAnimationTileset(input, 1);
+  }
+
+  return NULL;
+}
+
+static const char* getTransformName(Transform transform) {
+  switch (transform) {
+  case Transform::kFlipX:
+    return "flip_x";
+  case Transform::kFlipY:
+    return "flip_y";
+  case Transform::kRotateClockwise:
+    return "rotate_clockwise";
+  case Transform::kRotateCounterClockwise:
+    return "rotate_counter_clockwise";
+  case Transform::kAddSubImage:
+    return "add_sub_image";
+  case Transform::kAddFrame:
+    return "add_frame";
+  case Transform::kAnimationTileset:
+    return "animation_tileset";
+  }
+
+  return "unknown";
+}
+
+static double elapsedMs(gint64 startTime) {
+  return (double) (g_get_monotonic_time() - startTime) / 1000.0;
+}
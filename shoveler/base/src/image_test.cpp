@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include "image_testing.h"
+
+extern "C" {
+#include "shoveler/image.h"
+}
+
+class ShovelerImageTest : public ::testing::Test {
+public:
+  /** Deterministic noise, so that every pixel and channel of a transform is distinguishable. */
+  static ShovelerImage* createNoiseImage(
+      unsigned int width, unsigned int height, unsigned int channels) {
+    ShovelerImage* image = shovelerImageCreate(width, height, channels);
+    uint32_t state = width * 7919u + height * 104729u + channels;
+    for (unsigned int i = 0; i < width * height * channels; i++) {
+      state = state * 1664525u + 1013904223u;
+      image->data[i] = (unsigned char) (state >> 24);
+    }
+    return image;
+  }
+
+  static bool dirtyRegionsEqual(const ShovelerDirtyRegion& a, const ShovelerDirtyRegion& b) {
+    return a.numRectangles == b.numRectangles &&
+        memcmp(a.rectangles, b.rectangles, a.numRectangles * sizeof(ShovelerDirtyRectangle)) == 0;
+  }
+};
+
+// sizes around the vector width and the transpose tile size, to cover every remainder path
+static const unsigned int sizes[] = {1, 2, 3, 4, 5, 7, 8, 15, 16, 17, 31, 33, 64};
+static const unsigned int channelCounts[] = {1, 2, 3, 4};
+
+TEST_F(ShovelerImageTest, flipMatchesReference) {
+  for (unsigned int channels : channelCounts) {
+    for (unsigned int width : sizes) {
+      for (unsigned int height : {1u, 3u, 4u, 17u}) {
+        ShovelerImage* input = createNoiseImage(width, height, channels);
+
+        ShovelerImage* flippedX = shovelerImageCreateFlippedX(input);
+        ShovelerImage* referenceFlippedX = shovelerImageReferenceCreateFlippedX(input);
+        ASSERT_EQ(*flippedX, *referenceFlippedX) << width << "x" << height << "x" << channels;
+
+        ShovelerImage* flippedY = shovelerImageCreateFlippedY(input);
+        ShovelerImage* referenceFlippedY = shovelerImageReferenceCreateFlippedY(input);
+        ASSERT_EQ(*flippedY, *referenceFlippedY) << width << "x" << height << "x" << channels;
+
+        shovelerImageFree(input);
+        shovelerImageFree(flippedX);
+        shovelerImageFree(referenceFlippedX);
+        shovelerImageFree(flippedY);
+        shovelerImageFree(referenceFlippedY);
+      }
+    }
+  }
+}
+
+TEST_F(ShovelerImageTest, rotateMatchesReference) {
+  for (unsigned int channels : channelCounts) {
+    for (unsigned int size : sizes) {
+      ShovelerImage* input = createNoiseImage(size, size, channels);
+
+      ShovelerImage* clockwise = shovelerImageCreateRotatedClockwise(input);
+      ShovelerImage* referenceClockwise = shovelerImageReferenceCreateRotatedClockwise(input);
+      ASSERT_EQ(*clockwise, *referenceClockwise) << size << "x" << size << "x" << channels;
+
+      ShovelerImage* counterClockwise = shovelerImageCreateRotatedCounterClockwise(input);
+      ShovelerImage* referenceCounterClockwise =
+          shovelerImageReferenceCreateRotatedCounterClockwise(input);
+      ASSERT_EQ(*counterClockwise, *referenceCounterClockwise)
+          << size << "x" << size << "x" << channels;
+
+      shovelerImageFree(input);
+      shovelerImageFree(clockwise);
+      shovelerImageFree(referenceClockwise);
+      shovelerImageFree(counterClockwise);
+      shovelerImageFree(referenceCounterClockwise);
+    }
+  }
+}
+
+TEST_F(ShovelerImageTest, rotateNonSquare) {
+  ShovelerImage* input = createNoiseImage(19, 6, 4);
+
+  ShovelerImage* clockwise = shovelerImageCreateRotatedClockwise(input);
+  ShovelerImage* counterClockwise = shovelerImageCreateRotatedCounterClockwise(input);
+  ASSERT_EQ(clockwise->width, 6);
+  ASSERT_EQ(clockwise->height, 19);
+  ASSERT_EQ(counterClockwise->width, 6);
+  ASSERT_EQ(counterClockwise->height, 19);
+
+  for (unsigned int x = 0; x < input->width; x++) {
+    for (unsigned int y = 0; y < input->height; y++) {
+      for (unsigned int c = 0; c < input->channels; c++) {
+        ASSERT_EQ(
+            shovelerImageGet(clockwise, y, input->width - x - 1, c),
+            shovelerImageGet(input, x, y, c));
+        ASSERT_EQ(
+            shovelerImageGet(counterClockwise, input->height - y - 1, x, c),
+            shovelerImageGet(input, x, y, c));
+      }
+    }
+  }
+
+  shovelerImageFree(input);
+  shovelerImageFree(clockwise);
+  shovelerImageFree(counterClockwise);
+}
+
+TEST_F(ShovelerImageTest, addSubImageMatchesReference) {
+  ShovelerImage* subImage = createNoiseImage(7, 5, 3);
+  const int offsets[] = {-8, -7, -3, 0, 2, 6, 9, 12};
+
+  for (int xOffset : offsets) {
+    for (int yOffset : offsets) {
+      ShovelerImage* image = createNoiseImage(10, 9, 3);
+      ShovelerImage* referenceImage = shovelerImageCreateCopy(image);
+
+      shovelerImageAddSubImage(image, xOffset, yOffset, subImage);
+      shovelerImageReferenceAddSubImage(referenceImage, xOffset, yOffset, subImage);
+      ASSERT_EQ(*image, *referenceImage) << "offset (" << xOffset << ", " << yOffset << ")";
+      ASSERT_TRUE(dirtyRegionsEqual(image->dirtyRegion, referenceImage->dirtyRegion))
+          << "offset (" << xOffset << ", " << yOffset << ")";
+
+      shovelerImageFree(image);
+      shovelerImageFree(referenceImage);
+    }
+  }
+
+  shovelerImageFree(subImage);
+}
+
+TEST_F(ShovelerImageTest, addFrameMatchesReference) {
+  ShovelerColor color = shovelerColor(200, 100, 50);
+
+  for (unsigned int width : {1u, 2u, 5u, 16u, 23u}) {
+    for (unsigned int height : {1u, 4u, 9u, 16u}) {
+      for (unsigned int frameSize : {0u, 1u, 2u, 3u, 8u, 40u}) {
+        ShovelerImage* image = createNoiseImage(width, height, 4);
+        ShovelerImage* referenceImage = shovelerImageCreateCopy(image);
+
+        shovelerImageAddFrame(image, frameSize, color);
+        shovelerImageReferenceAddFrame(referenceImage, frameSize, color);
+        ASSERT_EQ(*image, *referenceImage)
+            << width << "x" << height << " with frame size " << frameSize;
+
+        shovelerImageFree(image);
+        shovelerImageFree(referenceImage);
+      }
+    }
+  }
+}
+
+TEST_F(ShovelerImageTest, animationTilesetMatchesReference) {
+  for (unsigned int channels : channelCounts) {
+    for (unsigned int size : {1u, 4u, 5u, 16u, 17u}) {
+      for (int shiftAmount : {-20, -2, 0, 1, 3, 20}) {
+        ShovelerImage* input = createNoiseImage(size, size, channels);
+
+        ShovelerImage* tileset = shovelerImageCreateAnimationTileset(input, shiftAmount);
+        ShovelerImage* referenceTileset =
+            shovelerImageReferenceCreateAnimationTileset(input, shiftAmount);
+        ASSERT_EQ(*tileset, *referenceTileset)
+            << size << "x" << size << "x" << channels << " shifted by " << shiftAmount;
+
+        shovelerImageFree(input);
+        shovelerImageFree(tileset);
+        shovelerImageFree(referenceTileset);
+      }
+    }
+  }
+}
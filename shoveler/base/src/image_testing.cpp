@@ -1,7 +1,13 @@
 #include "image_testing.h"
 
+#include <cassert> // assert
+#include <climits> // UINT_MAX
 #include <cstring> // memcmp
 
+static unsigned int getBorderDistance(
+    unsigned int width, unsigned int height, unsigned int i, unsigned int j);
+static unsigned int minInt(unsigned int a, unsigned int b);
+
 bool operator==(const ShovelerImage& a, const ShovelerImage& b) {
   return a.width == b.width && a.height == b.height && a.channels == b.channels &&
       memcmp(a.data, b.data, a.width * a.height * a.channels * sizeof(unsigned char)) == 0;
@@ -28,3 +34,204 @@ std::ostream& operator<<(std::ostream& stream, const ShovelerImage& image) {
 
   return stream;
 }
+
+ShovelerImage* shovelerImageReferenceCreateFlippedX(ShovelerImage* input) {
+  ShovelerImage* image = shovelerImageCreate(input->width, input->height, input->channels);
+
+  for (unsigned int i = 0; i < image->width; i++) {
+    for (unsigned int j = 0; j < image->height; j++) {
+      for (unsigned int c = 0; c < image->channels; c++) {
+        shovelerImageGet(image, i, j, c) = shovelerImageGet(input, image->width - i - 1, j, c);
+      }
+    }
+  }
+
+  return image;
+}
+
+ShovelerImage* shovelerImageReferenceCreateFlippedY(ShovelerImage* input) {
+  ShovelerImage* image = shovelerImageCreate(input->width, input->height, input->channels);
+
+  for (unsigned int i = 0; i < image->width; i++) {
+    for (unsigned int j = 0; j < image->height; j++) {
+      for (unsigned int c = 0; c < image->channels; c++) {
+        shovelerImageGet(image, i, j, c) = shovelerImageGet(input, i, image->height - j - 1, c);
+      }
+    }
+  }
+
+  return image;
+}
+
+ShovelerImage* shovelerImageReferenceCreateRotatedClockwise(ShovelerImage* input) {
+  ShovelerImage* image = shovelerImageCreate(input->height, input->width, input->channels);
+
+  for (unsigned int i = 0; i < image->width; i++) {
+    for (unsigned int j = 0; j < image->height; j++) {
+      for (unsigned int c = 0; c < image->channels; c++) {
+        shovelerImageGet(image, j, image->width - i - 1, c) = shovelerImageGet(input, i, j, c);
+      }
+    }
+  }
+
+  return image;
+}
+
+ShovelerImage* shovelerImageReferenceCreateRotatedCounterClockwise(ShovelerImage* input) {
+  ShovelerImage* image = shovelerImageCreate(input->height, input->width, input->channels);
+
+  for (unsigned int i = 0; i < image->width; i++) {
+    for (unsigned int j = 0; j < image->height; j++) {
+      for (unsigned int c = 0; c < image->channels; c++) {
+        shovelerImageGet(image, image->height - j - 1, i, c) = shovelerImageGet(input, i, j, c);
+      }
+    }
+  }
+
+  return image;
+}
+
+ShovelerImage* shovelerImageReferenceCreateAnimationTileset(ShovelerImage* input, int shiftAmount) {
+  assert(input->width == input->height);
+  unsigned int size = input->width;
+
+  ShovelerImage* moveImage = shovelerImageCreate(size, size, input->channels);
+  shovelerImageClear(moveImage);
+  shovelerImageReferenceAddSubImage(moveImage, shiftAmount, 0, input);
+  ShovelerImage* moveImage2 = shovelerImageReferenceCreateFlippedX(moveImage);
+
+  ShovelerImage* image = shovelerImageCreate(4 * size, 3 * size, input->channels);
+  shovelerImageClear(image);
+  shovelerImageReferenceAddSubImage(image, 0, 0, input);
+  shovelerImageReferenceAddSubImage(image, 0, size, moveImage);
+  shovelerImageReferenceAddSubImage(image, 0, 2 * size, moveImage2);
+
+  ShovelerImage* downImage = shovelerImageReferenceCreateFlippedY(input);
+  ShovelerImage* downMoveImage = shovelerImageReferenceCreateFlippedY(moveImage);
+  ShovelerImage* downMoveImage2 = shovelerImageReferenceCreateFlippedY(moveImage2);
+  shovelerImageReferenceAddSubImage(image, size, 0, downImage);
+  shovelerImageReferenceAddSubImage(image, size, size, downMoveImage);
+  shovelerImageReferenceAddSubImage(image, size, 2 * size, downMoveImage2);
+
+  ShovelerImage* leftImage = shovelerImageReferenceCreateRotatedCounterClockwise(input);
+  ShovelerImage* leftMoveImage = shovelerImageReferenceCreateRotatedCounterClockwise(moveImage);
+  ShovelerImage* leftMoveImage2 = shovelerImageReferenceCreateRotatedCounterClockwise(moveImage2);
+  shovelerImageReferenceAddSubImage(image, 2 * size, 0, leftImage);
+  shovelerImageReferenceAddSubImage(image, 2 * size, size, leftMoveImage);
+  shovelerImageReferenceAddSubImage(image, 2 * size, 2 * size, leftMoveImage2);
+
+  ShovelerImage* rightImage = shovelerImageReferenceCreateRotatedClockwise(input);
+  ShovelerImage* rightMoveImage = shovelerImageReferenceCreateRotatedClockwise(moveImage);
+  ShovelerImage* rightMoveImage2 = shovelerImageReferenceCreateRotatedClockwise(moveImage2);
+  shovelerImageReferenceAddSubImage(image, 3 * size, 0, rightImage);
+  shovelerImageReferenceAddSubImage(image, 3 * size, size, rightMoveImage);
+  shovelerImageReferenceAddSubImage(image, 3 * size, 2 * size, rightMoveImage2);
+
+  shovelerImageFree(moveImage);
+  shovelerImageFree(moveImage2);
+
+  shovelerImageFree(downImage);
+  shovelerImageFree(downMoveImage);
+  shovelerImageFree(downMoveImage2);
+
+  shovelerImageFree(leftImage);
+  shovelerImageFree(leftMoveImage);
+  shovelerImageFree(leftMoveImage2);
+
+  shovelerImageFree(rightImage);
+  shovelerImageFree(rightMoveImage);
+  shovelerImageFree(rightMoveImage2);
+
+  return image;
+}
+
+void shovelerImageReferenceAddFrame(ShovelerImage* image, unsigned int size, ShovelerColor color) {
+  assert(image->channels == 4);
+
+  for (unsigned int i = 0; i < image->width; i++) {
+    for (unsigned int j = 0; j < image->height; j++) {
+      unsigned int borderDistance = getBorderDistance(image->width, image->height, i, j);
+      if (borderDistance < size) {
+        unsigned char alpha = 255.0 * ((double) (size - borderDistance) / size);
+        shovelerImageGet(image, i, j, 0) = color.r;
+        shovelerImageGet(image, i, j, 1) = color.r;
+        shovelerImageGet(image, i, j, 2) = color.r;
+        shovelerImageGet(image, i, j, 3) = alpha;
+      }
+    }
+  }
+
+  shovelerImageMarkDirty(image, 0, 0, image->width, image->height);
+}
+
+void shovelerImageReferenceAddSubImage(
+    ShovelerImage* image, int xOffset, int yOffset, ShovelerImage* subImage) {
+  assert(
+      xOffset < 0 ||
+      UINT_MAX - (unsigned int) xOffset >=
+          subImage->width); // adding xOffset to subImage->width will never overflow
+  assert(
+      yOffset < 0 ||
+      UINT_MAX - (unsigned int) yOffset >=
+          subImage->height); // adding yOffset to subImage->height will never overflow
+  assert(image->channels == subImage->channels);
+
+  unsigned int minI = UINT_MAX;
+  unsigned int maxI = 0;
+  unsigned int minJ = UINT_MAX;
+  unsigned int maxJ = 0;
+  for (unsigned int i = 0; i < subImage->width; i++) {
+    if (xOffset < 0 && (unsigned int) -xOffset > i) {
+      continue; // would result in negative imageI
+    }
+
+    unsigned int imageI = xOffset + i;
+    if (imageI >= image->width) {
+      continue;
+    }
+
+    for (unsigned int j = 0; j < subImage->height; j++) {
+      if (yOffset < 0 && (unsigned int) -yOffset > j) {
+        continue; // would result in negative imageJ
+      }
+
+      unsigned int imageJ = yOffset + j;
+      if (imageJ >= image->height) {
+        continue;
+      }
+
+      for (unsigned int c = 0; c < subImage->channels; c++) {
+        shovelerImageGet(image, imageI, imageJ, c) = shovelerImageGet(subImage, i, j, c);
+      }
+
+      minI = imageI < minI ? imageI : minI;
+      maxI = imageI > maxI ? imageI : maxI;
+      minJ = imageJ < minJ ? imageJ : minJ;
+      maxJ = imageJ > maxJ ? imageJ : maxJ;
+    }
+  }
+
+  if (minI <= maxI && minJ <= maxJ) {
+    shovelerImageMarkDirty(image, minI, minJ, maxI - minI + 1, maxJ - minJ + 1);
+  }
+}
+
+static unsigned int getBorderDistance(
+    unsigned int width, unsigned int height, unsigned int i, unsigned int j) {
+  assert(i < width);
+  assert(j < height);
+
+  unsigned int xLow = i;
+  unsigned int xHigh = width - 1 - i;
+  unsigned int yLow = j;
+  unsigned int yHigh = height - 1 - j;
+  return minInt(xLow, minInt(xHigh, minInt(yLow, yHigh)));
+}
+
+static unsigned int minInt(unsigned int a, unsigned int b) {
+  if (a < b) {
+    return a;
+  } else {
+    return b;
+  }
+}
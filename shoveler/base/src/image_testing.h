@@ -11,4 +11,17 @@ bool operator==(const ShovelerImage& a, const ShovelerImage& b);
 bool operator!=(const ShovelerImage& a, const ShovelerImage& b);
 std::ostream& operator<<(std::ostream& stream, const ShovelerImage& image);
 
+/*
+ * The original per pixel implementations of the image transforms, which the optimized ones must
+ * match bit for bit. The rotations only handle square images.
+ */
+ShovelerImage* shovelerImageReferenceCreateFlippedX(ShovelerImage* input);
+ShovelerImage* shovelerImageReferenceCreateFlippedY(ShovelerImage* input);
+ShovelerImage* shovelerImageReferenceCreateRotatedClockwise(ShovelerImage* input);
+ShovelerImage* shovelerImageReferenceCreateRotatedCounterClockwise(ShovelerImage* input);
+ShovelerImage* shovelerImageReferenceCreateAnimationTileset(ShovelerImage* input, int shiftAmount);
+void shovelerImageReferenceAddFrame(ShovelerImage* image, unsigned int size, ShovelerColor color);
+void shovelerImageReferenceAddSubImage(
+    ShovelerImage* image, int xOffset, int yOffset, ShovelerImage* subImage);
+
 #endif
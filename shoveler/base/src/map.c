@@ -33,6 +33,24 @@ bool shovelerMapEntityHandleToChunkCoordinates(
   return true;
 }
 
+ShovelerMap* shovelerMapCreate(int chunkSize, int numChunkRows, int numChunkColumns) {
+  ShovelerMap* map = malloc(sizeof(ShovelerMap));
+  map->dimensions = shovelerMapDimensions(chunkSize, numChunkRows, numChunkColumns);
+  map->chunks = malloc(numChunkRows * numChunkColumns * sizeof(ShovelerMapChunk));
+
+  for (int chunkX = 0; chunkX < numChunkColumns; chunkX++) {
+    for (int chunkY = 0; chunkY < numChunkRows; chunkY++) {
+      ShovelerMapChunk* chunk = shovelerMapGetChunk(map, chunkX, chunkY);
+      shovelerMapChunkInit(chunk, chunkSize);
+      chunk->position = shovelerVector2(
+          (float) (-map->dimensions.halfMapWidth + chunkX * chunkSize) + 0.5f * (float) chunkSize,
+          (float) (-map->dimensions.halfMapHeight + chunkY * chunkSize) + 0.5f * (float) chunkSize);
+    }
+  }
+
+  return map;
+}
+
 ShovelerMap* shovelerMapGenerate(int chunkSize, int numChunkRows, int numChunkColumns) {
   ShovelerMap* map = malloc(sizeof(ShovelerMap));
   map->dimensions = shovelerMapDimensions(chunkSize, numChunkRows, numChunkColumns);
@@ -133,6 +151,63 @@ void shovelerMapWriteTile(
       chunk, map->dimensions.chunkSize, tile.tileX, tile.tileY, background, tileData);
 }
 
+int shovelerMapCollectTiles(
+    ShovelerMap* map,
+    int minChunkX,
+    int minChunkY,
+    int numChunksX,
+    int numChunksY,
+    bool background,
+    ShovelerMapTilePredicate* predicate,
+    void* userData,
+    GArray* outputTiles) {
+  int chunkSize = map->dimensions.chunkSize;
+  int beginChunkX = minChunkX > 0 ? minChunkX : 0;
+  int beginChunkY = minChunkY > 0 ? minChunkY : 0;
+  int endChunkX = minChunkX + numChunksX;
+  int endChunkY = minChunkY + numChunksY;
+  if (endChunkX > map->dimensions.numChunkColumns) {
+    endChunkX = map->dimensions.numChunkColumns;
+  }
+  if (endChunkY > map->dimensions.numChunkRows) {
+    endChunkY = map->dimensions.numChunkRows;
+  }
+
+  int numCollected = 0;
+  for (int chunkX = beginChunkX; chunkX < endChunkX; chunkX++) {
+    for (int chunkY = beginChunkY; chunkY < endChunkY; chunkY++) {
+      ShovelerMapChunk* chunk = shovelerMapGetChunk(map, chunkX, chunkY);
+      ShovelerMapChunkTilesData* tilesData =
+          background ? &chunk->backgroundTiles : &chunk->foregroundTiles;
+
+      for (int tileY = 0; tileY < chunkSize; tileY++) {
+        for (int tileX = 0; tileX < chunkSize; tileX++) {
+          int index = tileY * chunkSize + tileX;
+
+          ShovelerMapTileData tileData;
+          tileData.tilesetColumn = tilesData->tilesetColumns[index];
+          tileData.tilesetRow = tilesData->tilesetRows[index];
+          tileData.tilesetId = tilesData->tilesetIds[index];
+          tileData.tilesetCollider = tilesData->tilesetColliders[index];
+          if (!predicate(tileData, userData)) {
+            continue;
+          }
+
+          ShovelerMapTileCoordinate tile;
+          tile.chunkX = chunkX;
+          tile.chunkY = chunkY;
+          tile.tileX = tileX;
+          tile.tileY = tileY;
+          g_array_append_val(outputTiles, tile);
+          numCollected++;
+        }
+      }
+    }
+  }
+
+  return numCollected;
+}
+
 ShovelerMapChunk* shovelerMapGetChunk(ShovelerMap* map, int chunkX, int chunkY) {
   assert(chunkX >= 0);
   assert(chunkX < map->dimensions.numChunkColumns);
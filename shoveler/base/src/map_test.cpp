@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <glib.h>
+
+#include "shoveler/map.h"
+}
+
+static const int chunkSize = 4;
+static const int numChunkRows = 3;
+static const int numChunkColumns = 2;
+
+class ShovelerMapTest : public ::testing::Test {
+public:
+  virtual void SetUp() {
+    map = shovelerMapCreate(chunkSize, numChunkRows, numChunkColumns);
+    tiles = g_array_new(
+        /* zeroTerminated */ false, /* clear */ false, sizeof(ShovelerMapTileCoordinate));
+  }
+
+  virtual void TearDown() {
+    g_array_free(tiles, /* freeSegment */ true);
+    shovelerMapFree(map);
+  }
+
+  ShovelerMap* map;
+  GArray* tiles;
+};
+
+static bool isTilesetColumn(ShovelerMapTileData tileData, void* userData) {
+  return tileData.tilesetColumn == *(unsigned char*) userData;
+}
+
+static ShovelerMapTileCoordinate tileCoordinate(int chunkX, int chunkY, int tileX, int tileY) {
+  ShovelerMapTileCoordinate tile;
+  tile.chunkX = chunkX;
+  tile.chunkY = chunkY;
+  tile.tileX = tileX;
+  tile.tileY = tileY;
+  return tile;
+}
+
+TEST_F(ShovelerMapTest, createEmpty) {
+  ASSERT_EQ(map->dimensions.halfMapWidth, 4);
+  ASSERT_EQ(map->dimensions.halfMapHeight, 6);
+
+  for (int chunkX = 0; chunkX < numChunkColumns; chunkX++) {
+    for (int chunkY = 0; chunkY < numChunkRows; chunkY++) {
+      ShovelerMapChunk* chunk = shovelerMapGetChunk(map, chunkX, chunkY);
+      ASSERT_FLOAT_EQ(chunk->position.values[0], -4.0f + chunkX * chunkSize + 2.0f);
+      ASSERT_FLOAT_EQ(chunk->position.values[1], -6.0f + chunkY * chunkSize + 2.0f);
+
+      for (int tileX = 0; tileX < chunkSize; tileX++) {
+        for (int tileY = 0; tileY < chunkSize; tileY++) {
+          ShovelerMapTileData tileData = shovelerMapLookupTile(
+              map, tileCoordinate(chunkX, chunkY, tileX, tileY), /* background */ true);
+          ASSERT_EQ(tileData.tilesetColumn, 0);
+          ASSERT_EQ(tileData.tilesetRow, 0);
+          ASSERT_EQ(tileData.tilesetId, 0);
+          ASSERT_EQ(tileData.tilesetCollider, 0);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(ShovelerMapTest, writeLookup) {
+  ShovelerMapTileData tileData = shovelerMapTileData();
+  tileData.tilesetColumn = 6;
+  tileData.tilesetRow = 1;
+  tileData.tilesetId = 2;
+  ShovelerMapTileCoordinate tile = tileCoordinate(1, 2, 3, 0);
+  shovelerMapWriteTile(map, tile, /* background */ true, tileData);
+
+  ShovelerMapTileData background = shovelerMapLookupTile(map, tile, /* background */ true);
+  ASSERT_EQ(background.tilesetColumn, 6);
+  ASSERT_EQ(background.tilesetRow, 1);
+  ASSERT_EQ(background.tilesetId, 2);
+
+  ShovelerMapTileData foreground = shovelerMapLookupTile(map, tile, /* background */ false);
+  ASSERT_EQ(foreground.tilesetColumn, 0);
+
+  // the tile arrays of a chunk are laid out row by row
+  ShovelerMapChunk* chunk = shovelerMapGetChunk(map, 1, 2);
+  ASSERT_EQ(chunk->backgroundTiles.tilesetColumns[0 * chunkSize + 3], 6);
+}
+
+TEST_F(ShovelerMapTest, collectTiles) {
+  ShovelerMapTileData tileData = shovelerMapTileData();
+  tileData.tilesetColumn = 3;
+  shovelerMapWriteTile(map, tileCoordinate(0, 0, 1, 1), /* background */ true, tileData);
+  shovelerMapWriteTile(map, tileCoordinate(1, 1, 2, 3), /* background */ true, tileData);
+  shovelerMapWriteTile(map, tileCoordinate(1, 2, 0, 0), /* background */ true, tileData);
+  shovelerMapWriteTile(map, tileCoordinate(1, 1, 0, 0), /* background */ false, tileData);
+
+  unsigned char tilesetColumn = 3;
+  int numCollected = shovelerMapCollectTiles(
+      map,
+      /* minChunkX */ 1,
+      /* minChunkY */ 1,
+      /* numChunksX */ 1,
+      /* numChunksY */ 1,
+      /* background */ true,
+      isTilesetColumn,
+      &tilesetColumn,
+      tiles);
+  ASSERT_EQ(numCollected, 1);
+  ASSERT_EQ(tiles->len, 1);
+  ShovelerMapTileCoordinate collected = g_array_index(tiles, ShovelerMapTileCoordinate, 0);
+  ASSERT_EQ(collected.chunkX, 1);
+  ASSERT_EQ(collected.chunkY, 1);
+  ASSERT_EQ(collected.tileX, 2);
+  ASSERT_EQ(collected.tileY, 3);
+
+  // regions reaching outside of the map are clamped
+  numCollected = shovelerMapCollectTiles(
+      map,
+      /* minChunkX */ -5,
+      /* minChunkY */ -5,
+      /* numChunksX */ 10,
+      /* numChunksY */ 10,
+      /* background */ true,
+      isTilesetColumn,
+      &tilesetColumn,
+      tiles);
+  ASSERT_EQ(numCollected, 3);
+  ASSERT_EQ(tiles->len, 4);
+
+  tilesetColumn = 0;
+  numCollected = shovelerMapCollectTiles(
+      map,
+      /* minChunkX */ 0,
+      /* minChunkY */ 0,
+      /* numChunksX */ numChunkColumns,
+      /* numChunksY */ numChunkRows,
+      /* background */ false,
+      isTilesetColumn,
+      &tilesetColumn,
+      tiles);
+  ASSERT_EQ(numCollected, numChunkColumns * numChunkRows * chunkSize * chunkSize - 1);
+}
@@ -1,21 +1,34 @@
 #include "shoveler/resources.h"
 
 #include <assert.h> // assert
+#include <limits.h> // INT_MAX
 #include <stdlib.h> // malloc, free
 #include <string.h> // memcpy, strcmp, strdup
 
+#include "shoveler/file.h"
 #include "shoveler/log.h"
 
-static void freeTypeLoader(void* typeLoaderPointer);
+static ShovelerResource* getResource(
+    ShovelerResources* resources, const char* typeId, const char* resourceId);
+static void requestResource(
+    ShovelerResources* resources,
+    ShovelerResourcesType* type,
+    ShovelerResource* resource,
+    const char* typeId,
+    const char* resourceId);
+static void touchResource(ShovelerResourcesType* type, ShovelerResource* resource);
+static void evictResources(ShovelerResources* resources, ShovelerResourcesType* type);
+static void removeEvictable(ShovelerResourcesType* type, ShovelerResource* resource);
+static void freeType(void* typePointer);
 static void freeResource(void* resourcePointer);
-static void freeResourceData(ShovelerResourcesTypeLoader* typeLoader, ShovelerResource* resource);
+static void freeResourceData(ShovelerResourcesType* type, ShovelerResource* resource);
 
 ShovelerResources* shovelerResourcesCreate(
     ShovelerResourcesRequestFunction* request, void* userData) {
   ShovelerResources* resources = malloc(sizeof(ShovelerResources));
   resources->request = request;
   resources->requestUserData = userData;
-  resources->typeLoaders = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, freeTypeLoader);
+  resources->types = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, freeType);
   resources->resources = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, freeResource);
 
   return resources;
@@ -23,7 +36,7 @@ ShovelerResources* shovelerResourcesCreate(
 
 bool shovelerResourcesRegisterTypeLoader(
     ShovelerResources* resources, ShovelerResourcesTypeLoader typeLoader) {
-  if (g_hash_table_lookup(resources->typeLoaders, typeLoader.typeId) != NULL) {
+  if (g_hash_table_lookup(resources->types, typeLoader.typeId) != NULL) {
     shovelerLogError(
         "Failed to register resources type loader for '%s' because a type loader for this type "
         "already exists",
@@ -31,49 +44,61 @@ bool shovelerResourcesRegisterTypeLoader(
     return false;
   }
 
-  ShovelerResourcesTypeLoader* typeLoaderCopy = malloc(sizeof(ShovelerResourcesTypeLoader));
-  memcpy(typeLoaderCopy, &typeLoader, sizeof(ShovelerResourcesTypeLoader));
-  return g_hash_table_insert(resources->typeLoaders, (void*) typeLoader.typeId, typeLoaderCopy);
+  ShovelerResourcesType* type = malloc(sizeof(ShovelerResourcesType));
+  memcpy(&type->typeLoader, &typeLoader, sizeof(ShovelerResourcesTypeLoader));
+  type->budgetBytes = 0;
+  type->evictableResources = g_queue_new();
+  type->statistics.numHits = 0;
+  type->statistics.numMisses = 0;
+  type->statistics.numEvictions = 0;
+  type->statistics.numResidentBytes = 0;
+  return g_hash_table_insert(resources->types, (void*) typeLoader.typeId, type);
+}
+
+bool shovelerResourcesSetTypeBudget(
+    ShovelerResources* resources, const char* typeId, size_t budgetBytes) {
+  ShovelerResourcesType* type = g_hash_table_lookup(resources->types, typeId);
+  if (type == NULL) {
+    shovelerLogError("Failed to set budget of unknown resource type '%s'.", typeId);
+    return false;
+  }
+
+  type->budgetBytes = budgetBytes;
+  evictResources(resources, type);
+
+  return true;
 }
 
 ShovelerResource* shovelerResourcesGet(
     ShovelerResources* resources, const char* typeId, const char* resourceId) {
-  ShovelerResourcesTypeLoader* typeLoader =
-      (ShovelerResourcesTypeLoader*) g_hash_table_lookup(resources->typeLoaders, typeId);
-  if (typeLoader == NULL) {
-    shovelerLogError("Failed to request resource '%s' of unknown type '%s'.", resourceId, typeId);
-    return NULL;
-  }
+  return getResource(resources, typeId, resourceId);
+}
 
-  ShovelerResource* resource =
-      (ShovelerResource*) g_hash_table_lookup(resources->resources, resourceId);
+ShovelerResource* shovelerResourcesAcquire(
+    ShovelerResources* resources, const char* typeId, const char* resourceId) {
+  ShovelerResource* resource = getResource(resources, typeId, resourceId);
   if (resource == NULL) {
-    shovelerLogTrace(
-        "Requested unloaded resource '%s' of type '%s', loading...", resourceId, typeId);
+    return NULL;
+  }
 
-    resource = malloc(sizeof(ShovelerResource));
-    resource->resources = resources;
-    resource->id = strdup(resourceId);
-    resource->typeId = typeId;
-    resource->data = typeLoader->defaultResourceData;
+  ShovelerResourcesType* type = g_hash_table_lookup(resources->types, resource->typeId);
+  removeEvictable(type, resource);
+  resource->numReferences++;
 
-    g_hash_table_insert(resources->resources, resource->id, resource);
+  return resource;
+}
 
-    if (resources->request != NULL) {
-      resources->request(resources, typeId, resourceId, resources->requestUserData);
-    }
-  }
+void shovelerResourcesRelease(ShovelerResources* resources, ShovelerResource* resource) {
+  assert(resource->numReferences > 0);
 
-  if (strcmp(resource->typeId, typeId) != 0) {
-    shovelerLogError(
-        "Requested resource '%s' of type '%s' but it is already loaded as type '%d'.",
-        resourceId,
-        typeId,
-        resource->typeId);
-    return NULL;
+  resource->numReferences--;
+  if (resource->numReferences > 0) {
+    return;
   }
 
-  return resource;
+  ShovelerResourcesType* type = g_hash_table_lookup(resources->types, resource->typeId);
+  touchResource(type, resource);
+  evictResources(resources, type);
 }
 
 bool shovelerResourcesSet(
@@ -82,9 +107,8 @@ bool shovelerResourcesSet(
     const char* resourceId,
     const unsigned char* buffer,
     int bufferSize) {
-  ShovelerResourcesTypeLoader* typeLoader =
-      (ShovelerResourcesTypeLoader*) g_hash_table_lookup(resources->typeLoaders, typeId);
-  if (typeLoader == NULL) {
+  ShovelerResourcesType* type = g_hash_table_lookup(resources->types, typeId);
+  if (type == NULL) {
     shovelerLogError(
         "Failed to load resource '%s' of unknown type '%s' (%d bytes).",
         resourceId,
@@ -92,6 +116,7 @@ bool shovelerResourcesSet(
         bufferSize);
     return false;
   }
+  ShovelerResourcesTypeLoader* typeLoader = &type->typeLoader;
 
   ShovelerResource* resource =
       (ShovelerResource*) g_hash_table_lookup(resources->resources, resourceId);
@@ -107,6 +132,10 @@ bool shovelerResourcesSet(
     resource->id = strdup(resourceId);
     resource->typeId = typeLoader->typeId;
     resource->data = typeLoader->defaultResourceData;
+    resource->numBytes = 0;
+    resource->isRequested = false;
+    resource->numReferences = 0;
+    resource->evictableLink = NULL;
 
     g_hash_table_insert(resources->resources, resource->id, resource);
   } else {
@@ -117,7 +146,7 @@ bool shovelerResourcesSet(
         bufferSize);
   }
 
-  freeResourceData(typeLoader, resource);
+  freeResourceData(type, resource);
 
   resource->data = typeLoader->load(typeLoader, buffer, bufferSize);
   if (resource->data == NULL) {
@@ -130,22 +159,203 @@ bool shovelerResourcesSet(
     return false;
   }
 
+  if (typeLoader->getSize != NULL) {
+    resource->numBytes = typeLoader->getSize(typeLoader, resource->data);
+  } else {
+    resource->numBytes = (size_t) bufferSize;
+  }
+  type->statistics.numResidentBytes += resource->numBytes;
+  resource->isRequested = false;
+
   shovelerLogTrace("Loaded resource '%s' of type '%s'.", resourceId, typeId);
+
+  touchResource(type, resource);
+  evictResources(resources, type);
+
   return true;
 }
 
+bool shovelerResourcesSetFile(
+    ShovelerResources* resources,
+    const char* typeId,
+    const char* resourceId,
+    const char* filename) {
+  ShovelerMappedFile* mappedFile = shovelerFileMap(filename);
+  if (mappedFile == NULL) {
+    shovelerLogError(
+        "Failed to load resource '%s' of type '%s' from '%s'.", resourceId, typeId, filename);
+    return false;
+  }
+
+  if (mappedFile->size > INT_MAX) {
+    shovelerLogError(
+        "Failed to load resource '%s' of type '%s' from '%s': File size %zu is too large.",
+        resourceId,
+        typeId,
+        filename,
+        mappedFile->size);
+    shovelerFileUnmap(mappedFile);
+    return false;
+  }
+
+  // type loaders don't keep the buffer, so the mapping can go right after loading
+  bool loaded = shovelerResourcesSet(
+      resources, typeId, resourceId, mappedFile->data, (int) mappedFile->size);
+  shovelerFileUnmap(mappedFile);
+
+  return loaded;
+}
+
+ShovelerResourcesStatistics shovelerResourcesGetStatistics(
+    ShovelerResources* resources, const char* typeId) {
+  ShovelerResourcesStatistics statistics = {0, 0, 0, 0};
+
+  GHashTableIter iter;
+  const char* currentTypeId;
+  ShovelerResourcesType* type;
+  g_hash_table_iter_init(&iter, resources->types);
+  while (g_hash_table_iter_next(&iter, (gpointer*) &currentTypeId, (gpointer*) &type)) {
+    if (typeId != NULL && strcmp(currentTypeId, typeId) != 0) {
+      continue;
+    }
+
+    statistics.numHits += type->statistics.numHits;
+    statistics.numMisses += type->statistics.numMisses;
+    statistics.numEvictions += type->statistics.numEvictions;
+    statistics.numResidentBytes += type->statistics.numResidentBytes;
+  }
+
+  return statistics;
+}
+
 void shovelerResourcesFree(ShovelerResources* resources) {
   if (resources == NULL) {
     return;
   }
 
   g_hash_table_destroy(resources->resources);
-  g_hash_table_destroy(resources->typeLoaders);
+  g_hash_table_destroy(resources->types);
   free(resources);
 }
 
-static void freeTypeLoader(void* typeLoaderPointer) {
-  ShovelerResourcesTypeLoader* typeLoader = (ShovelerResourcesTypeLoader*) typeLoaderPointer;
+static ShovelerResource* getResource(
+    ShovelerResources* resources, const char* typeId, const char* resourceId) {
+  ShovelerResourcesType* type = g_hash_table_lookup(resources->types, typeId);
+  if (type == NULL) {
+    shovelerLogError("Failed to request resource '%s' of unknown type '%s'.", resourceId, typeId);
+    return NULL;
+  }
+
+  ShovelerResource* resource =
+      (ShovelerResource*) g_hash_table_lookup(resources->resources, resourceId);
+  if (resource == NULL) {
+    shovelerLogTrace(
+        "Requested unloaded resource '%s' of type '%s', loading...", resourceId, typeId);
+
+    resource = malloc(sizeof(ShovelerResource));
+    resource->resources = resources;
+    resource->id = strdup(resourceId);
+    resource->typeId = type->typeLoader.typeId;
+    resource->data = type->typeLoader.defaultResourceData;
+    resource->numBytes = 0;
+    resource->isRequested = false;
+    resource->numReferences = 0;
+    resource->evictableLink = NULL;
+
+    g_hash_table_insert(resources->resources, resource->id, resource);
+    type->statistics.numMisses++;
+    requestResource(resources, type, resource, typeId, resourceId);
+
+    return resource;
+  }
+
+  if (strcmp(resource->typeId, typeId) != 0) {
+    shovelerLogError(
+        "Requested resource '%s' of type '%s' but it is already loaded as type '%s'.",
+        resourceId,
+        typeId,
+        resource->typeId);
+    return NULL;
+  }
+
+  if (resource->data == type->typeLoader.defaultResourceData) {
+    type->statistics.numMisses++;
+    if (!resource->isRequested) {
+      shovelerLogTrace(
+          "Requested evicted resource '%s' of type '%s', loading again...", resourceId, typeId);
+      requestResource(resources, type, resource, typeId, resourceId);
+    }
+  } else {
+    type->statistics.numHits++;
+    touchResource(type, resource);
+  }
+
+  return resource;
+}
+
+static void requestResource(
+    ShovelerResources* resources,
+    ShovelerResourcesType* type,
+    ShovelerResource* resource,
+    const char* typeId,
+    const char* resourceId) {
+  if (resources->request == NULL) {
+    return;
+  }
+
+  // the request might be fulfilled right away, which must not evict the resource before the caller
+  // got it
+  resource->isRequested = true;
+  resource->numReferences++;
+  resources->request(resources, typeId, resourceId, resources->requestUserData);
+  resource->numReferences--;
+  touchResource(type, resource);
+}
+
+/** Marks a loaded resource that isn't referenced as the most recently used evictable one. */
+static void touchResource(ShovelerResourcesType* type, ShovelerResource* resource) {
+  if (resource->numReferences > 0 || resource->data == type->typeLoader.defaultResourceData) {
+    return;
+  }
+
+  removeEvictable(type, resource);
+  g_queue_push_tail(type->evictableResources, resource);
+  resource->evictableLink = g_queue_peek_tail_link(type->evictableResources);
+}
+
+static void evictResources(ShovelerResources* resources, ShovelerResourcesType* type) {
+  if (type->budgetBytes == 0) {
+    return;
+  }
+
+  while (type->statistics.numResidentBytes > type->budgetBytes &&
+         !g_queue_is_empty(type->evictableResources)) {
+    ShovelerResource* resource = g_queue_peek_head(type->evictableResources);
+    shovelerLogTrace(
+        "Evicting resource '%s' of type '%s' (%zu bytes) to stay within budget of %zu bytes.",
+        resource->id,
+        resource->typeId,
+        resource->numBytes,
+        type->budgetBytes);
+
+    // only the data is freed, so that callers holding on to the resource don't dangle
+    type->statistics.numEvictions++;
+    freeResourceData(type, resource);
+  }
+}
+
+static void removeEvictable(ShovelerResourcesType* type, ShovelerResource* resource) {
+  if (resource->evictableLink == NULL) {
+    return;
+  }
+
+  g_queue_delete_link(type->evictableResources, resource->evictableLink);
+  resource->evictableLink = NULL;
+}
+
+static void freeType(void* typePointer) {
+  ShovelerResourcesType* type = (ShovelerResourcesType*) typePointer;
+  ShovelerResourcesTypeLoader* typeLoader = &type->typeLoader;
 
   if (typeLoader->freeResourceData != NULL) {
     typeLoader->freeResourceData(typeLoader, typeLoader->defaultResourceData);
@@ -155,23 +365,34 @@ static void freeTypeLoader(void* typeLoaderPointer) {
     typeLoader->free(typeLoader);
   }
 
-  free(typeLoader);
+  g_queue_free(type->evictableResources);
+  free(type);
 }
 
 static void freeResource(void* resourcePointer) {
   ShovelerResource* resource = (ShovelerResource*) resourcePointer;
 
-  ShovelerResourcesTypeLoader* typeLoader = (ShovelerResourcesTypeLoader*) g_hash_table_lookup(
-      resource->resources->typeLoaders, resource->typeId);
-  assert(typeLoader != NULL);
+  ShovelerResourcesType* type = (ShovelerResourcesType*) g_hash_table_lookup(
+      resource->resources->types, resource->typeId);
+  assert(type != NULL);
 
-  freeResourceData(typeLoader, resource);
+  freeResourceData(type, resource);
   free(resource->id);
   free(resource);
 }
 
-static void freeResourceData(ShovelerResourcesTypeLoader* typeLoader, ShovelerResource* resource) {
-  if (typeLoader->freeResourceData != NULL && resource->data != typeLoader->defaultResourceData) {
+static void freeResourceData(ShovelerResourcesType* type, ShovelerResource* resource) {
+  ShovelerResourcesTypeLoader* typeLoader = &type->typeLoader;
+  if (resource->data == typeLoader->defaultResourceData) {
+    return;
+  }
+
+  removeEvictable(type, resource);
+  type->statistics.numResidentBytes -= resource->numBytes;
+  resource->numBytes = 0;
+
+  if (typeLoader->freeResourceData != NULL) {
     typeLoader->freeResourceData(typeLoader, resource->data);
   }
+  resource->data = typeLoader->defaultResourceData;
 }
@@ -5,6 +5,7 @@
 
 static void* loadPng(
     ShovelerResourcesTypeLoader* typeLoader, const unsigned char* buffer, int bufferSize);
+static size_t getPngSize(ShovelerResourcesTypeLoader* typeLoader, void* resourceData);
 static void freePng(ShovelerResourcesTypeLoader* typeLoader, void* resourceData);
 static void freeTypeLoader(ShovelerResourcesTypeLoader* typeLoader);
 static ShovelerImage* createDefaultImage();
@@ -15,6 +16,7 @@ bool shovelerResourcesImagePngRegister(ShovelerResources* resources) {
   imagePngTypeLoader.defaultResourceData = createDefaultImage();
   imagePngTypeLoader.data = NULL;
   imagePngTypeLoader.load = loadPng;
+  imagePngTypeLoader.getSize = getPngSize;
   imagePngTypeLoader.freeResourceData = freePng;
   imagePngTypeLoader.free = freeTypeLoader;
   return shovelerResourcesRegisterTypeLoader(resources, imagePngTypeLoader);
@@ -25,6 +27,11 @@ static void* loadPng(
   return shovelerImagePngReadBuffer(buffer, bufferSize);
 }
 
+static size_t getPngSize(ShovelerResourcesTypeLoader* typeLoader, void* resourceData) {
+  ShovelerImage* pngImage = (ShovelerImage*) resourceData;
+  return (size_t) pngImage->width * pngImage->height * pngImage->channels;
+}
+
 static void freePng(ShovelerResourcesTypeLoader* typeLoader, void* resourceData) {
   ShovelerImage* pngImage = (ShovelerImage*) resourceData;
   shovelerImageFree(pngImage);
@@ -25,6 +25,7 @@ public:
     testTypeLoader.defaultResourceData = (void*) testDefaultResourceData;
     testTypeLoader.data = this;
     testTypeLoader.load = loadResource;
+    testTypeLoader.getSize = NULL;
     testTypeLoader.freeResourceData = freeResourceData;
     testTypeLoader.free = freeTypeLoader;
     bool typeLoaderRegistered = shovelerResourcesRegisterTypeLoader(resources, testTypeLoader);
@@ -37,6 +38,7 @@ public:
     lastLoadBuffer = NULL;
     lastLoadBufferSize = 0;
     nextLoadResourceData = NULL;
+    numRequests = 0;
 
     freeResourceDataArguments.clear();
 
@@ -63,6 +65,7 @@ public:
   const unsigned char* lastLoadBuffer;
   int lastLoadBufferSize;
   void* nextLoadResourceData;
+  int numRequests;
 
   std::vector<void*> freeResourceDataArguments;
 
@@ -197,12 +200,142 @@ TEST_F(ShovelerResourcesTest, loadAndRequest) {
       << "resource data should be set to correct loaded data";
 }
 
+TEST_F(ShovelerResourcesTest, countsHitsAndMisses) {
+  const char* testResourceId = "test resource id";
+  unsigned char testResourceBuffer = 42;
+  const char* testResourceData = "test resource data";
+
+  shovelerResourcesGet(resources, testTypeId, testResourceId);
+  shovelerResourcesGet(resources, testTypeId, testResourceId);
+  ASSERT_EQ(numRequests, 1) << "pending resource should only be requested once";
+
+  nextLoadResourceData = (void*) testResourceData;
+  shovelerResourcesSet(resources, testTypeId, testResourceId, &testResourceBuffer, 10);
+  shovelerResourcesGet(resources, testTypeId, testResourceId);
+
+  ShovelerResourcesStatistics statistics = shovelerResourcesGetStatistics(resources, testTypeId);
+  ASSERT_EQ(statistics.numMisses, 2);
+  ASSERT_EQ(statistics.numHits, 1);
+  ASSERT_EQ(statistics.numEvictions, 0);
+  ASSERT_EQ(statistics.numResidentBytes, 10);
+}
+
+TEST_F(ShovelerResourcesTest, evictsLeastRecentlyUsedOverBudget) {
+  unsigned char testResourceBuffer = 42;
+  const char* testResourceData = "test resource data";
+  shovelerResourcesSetTypeBudget(resources, testTypeId, 25);
+
+  nextLoadResourceData = (void*) testResourceData;
+  shovelerResourcesSet(resources, testTypeId, "first", &testResourceBuffer, 10);
+  shovelerResourcesSet(resources, testTypeId, "second", &testResourceBuffer, 10);
+  // using the first makes the second the least recently used
+  shovelerResourcesGet(resources, testTypeId, "first");
+  shovelerResourcesSet(resources, testTypeId, "third", &testResourceBuffer, 10);
+
+  ShovelerResourcesStatistics statistics = shovelerResourcesGetStatistics(resources, testTypeId);
+  ASSERT_EQ(statistics.numEvictions, 1);
+  ASSERT_EQ(statistics.numResidentBytes, 20);
+  ASSERT_EQ(freeResourceDataArguments.size(), 1);
+
+  ShovelerResource* resource = shovelerResourcesGet(resources, testTypeId, "second");
+  ASSERT_EQ(resource->data, testDefaultResourceData) << "evicted resource should be unloaded";
+  ASSERT_STREQ(lastRequestResourceId, "second") << "evicted resource should be requested again";
+  ASSERT_EQ(shovelerResourcesGet(resources, testTypeId, "first")->data, testResourceData);
+}
+
+TEST_F(ShovelerResourcesTest, evictionKeepsResource) {
+  unsigned char testResourceBuffer = 42;
+  const char* testResourceData = "test resource data";
+  shovelerResourcesSetTypeBudget(resources, testTypeId, 15);
+
+  nextLoadResourceData = (void*) testResourceData;
+  shovelerResourcesSet(resources, testTypeId, "first", &testResourceBuffer, 10);
+  ShovelerResource* first = shovelerResourcesGet(resources, testTypeId, "first");
+  shovelerResourcesSet(resources, testTypeId, "second", &testResourceBuffer, 10);
+
+  ASSERT_EQ(shovelerResourcesGetStatistics(resources, testTypeId).numEvictions, 1);
+  ASSERT_EQ(first->data, testDefaultResourceData)
+      << "evicted resource should still be valid with its default data";
+  ASSERT_EQ(numRequests, 0);
+
+  ASSERT_EQ(shovelerResourcesGet(resources, testTypeId, "first"), first);
+  ASSERT_EQ(numRequests, 1) << "evicted resource should be requested again";
+  shovelerResourcesGet(resources, testTypeId, "first");
+  ASSERT_EQ(numRequests, 1) << "evicted resource should only be requested again once";
+
+  shovelerResourcesSet(resources, testTypeId, "first", &testResourceBuffer, 10);
+  ASSERT_EQ(first->data, testResourceData) << "resource should be reloaded in place";
+}
+
+TEST_F(ShovelerResourcesTest, neverEvictsAcquired) {
+  unsigned char testResourceBuffer = 42;
+  const char* testResourceData = "test resource data";
+  shovelerResourcesSetTypeBudget(resources, testTypeId, 15);
+
+  ShovelerResource* first = shovelerResourcesAcquire(resources, testTypeId, "first");
+  ShovelerResource* second = shovelerResourcesAcquire(resources, testTypeId, "second");
+  nextLoadResourceData = (void*) testResourceData;
+  shovelerResourcesSet(resources, testTypeId, "first", &testResourceBuffer, 10);
+  shovelerResourcesSet(resources, testTypeId, "second", &testResourceBuffer, 10);
+
+  ASSERT_EQ(shovelerResourcesGetStatistics(resources, testTypeId).numResidentBytes, 20)
+      << "budget should be exceeded while both are acquired";
+  ASSERT_EQ(first->data, testResourceData);
+  ASSERT_EQ(second->data, testResourceData);
+
+  shovelerResourcesRelease(resources, second);
+  ShovelerResourcesStatistics statistics = shovelerResourcesGetStatistics(resources, testTypeId);
+  ASSERT_EQ(statistics.numEvictions, 1);
+  ASSERT_EQ(statistics.numResidentBytes, 10);
+  ASSERT_EQ(first->data, testResourceData);
+
+  shovelerResourcesRelease(resources, first);
+  ASSERT_EQ(shovelerResourcesGetStatistics(resources, testTypeId).numEvictions, 1)
+      << "releasing within budget should not evict";
+}
+
+TEST_F(ShovelerResourcesTest, countsReferences) {
+  unsigned char testResourceBuffer = 42;
+  const char* testResourceData = "test resource data";
+  shovelerResourcesSetTypeBudget(resources, testTypeId, 5);
+
+  ShovelerResource* resource = shovelerResourcesAcquire(resources, testTypeId, "first");
+  shovelerResourcesAcquire(resources, testTypeId, "first");
+  nextLoadResourceData = (void*) testResourceData;
+  shovelerResourcesSet(resources, testTypeId, "first", &testResourceBuffer, 10);
+
+  shovelerResourcesRelease(resources, resource);
+  ASSERT_EQ(resource->data, testResourceData) << "one reference should still be held";
+  ASSERT_EQ(shovelerResourcesGetStatistics(resources, testTypeId).numEvictions, 0);
+
+  shovelerResourcesRelease(resources, resource);
+  ASSERT_EQ(shovelerResourcesGetStatistics(resources, testTypeId).numEvictions, 1);
+  ASSERT_EQ(shovelerResourcesGetStatistics(resources, testTypeId).numResidentBytes, 0);
+}
+
+TEST_F(ShovelerResourcesTest, shrinkingBudgetEvicts) {
+  unsigned char testResourceBuffer = 42;
+  const char* testResourceData = "test resource data";
+
+  nextLoadResourceData = (void*) testResourceData;
+  shovelerResourcesSet(resources, testTypeId, "first", &testResourceBuffer, 10);
+  shovelerResourcesSet(resources, testTypeId, "second", &testResourceBuffer, 10);
+  ASSERT_EQ(shovelerResourcesGetStatistics(resources, NULL).numEvictions, 0)
+      << "resources without budget should never be evicted";
+
+  shovelerResourcesSetTypeBudget(resources, testTypeId, 10);
+  ShovelerResourcesStatistics statistics = shovelerResourcesGetStatistics(resources, NULL);
+  ASSERT_EQ(statistics.numEvictions, 1);
+  ASSERT_EQ(statistics.numResidentBytes, 10);
+}
+
 static void requestResources(
     ShovelerResources* resources, const char* typeId, const char* resourceId, void* testPointer) {
   ShovelerResourcesTest* test = (ShovelerResourcesTest*) testPointer;
   test->lastRequestResources = resources;
   test->lastRequestTypeId = typeId;
   test->lastRequestResourceId = resourceId;
+  test->numRequests++;
 }
 
 static void* loadResource(
@@ -19,6 +19,7 @@ typedef struct ShovelerSceneStruct ShovelerScene;
 typedef struct ShovelerShaderCacheStruct ShovelerShaderCache;
 typedef struct ShovelerSystemStruct ShovelerSystem;
 typedef struct ShovelerWorldStruct ShovelerWorld;
+typedef struct ShovelerWorldChangeConsumerStruct ShovelerWorldChangeConsumer;
 
 typedef void(ShovelerClientSystemUpdateAuthoritativeComponentFunction)(
     ShovelerClientSystem* clientSystem,
@@ -43,6 +44,8 @@ typedef struct ShovelerClientSystemStruct {
   void* updateAuthoritativeComponentUserData;
   ShovelerInputKeyCallback* keyCallback;
   ShovelerExecutorCallback* updateWorldCountersExecutorCallback;
+  ShovelerWorldChangeConsumer* tilemapCollidersChangeConsumer;
+  ShovelerExecutorCallback* updateTilemapCollidersExecutorCallback;
   struct {
     unsigned int numEntities;
     unsigned int numComponents;
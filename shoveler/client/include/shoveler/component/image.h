@@ -8,12 +8,34 @@
 
 typedef struct ShovelerClientSystemStruct ShovelerClientSystem;
 typedef struct ShovelerImageStruct ShovelerImage;
+typedef struct ShovelerImageMipmapsStruct ShovelerImageMipmaps;
+
+/* decoded image of an active image component, along with the mip chain built while decoding it */
+typedef struct {
+  ShovelerImage* image;
+  /* only built if a texture depended on the image, and handed over to the first one uploading it */
+  ShovelerImageMipmaps* mipmaps;
+} ShovelerClientImage;
 
 void shovelerClientSystemAddImageSystem(ShovelerClientSystem* clientSystem);
 
 static inline ShovelerImage* shovelerComponentGetImage(ShovelerComponent* component) {
   assert(component->type->id == shovelerComponentTypeIdImage);
-  return component->systemData;
+  ShovelerClientImage* clientImage = (ShovelerClientImage*) component->systemData;
+  return clientImage->image;
+}
+
+/**
+ * Hands the image's mip chain over to the caller, which has to free it. Returns NULL if it was
+ * never built or has been taken before, in which case the driver has to generate mipmaps instead.
+ */
+static inline ShovelerImageMipmaps* shovelerComponentTakeImageMipmaps(
+    ShovelerComponent* component) {
+  assert(component->type->id == shovelerComponentTypeIdImage);
+  ShovelerClientImage* clientImage = (ShovelerClientImage*) component->systemData;
+  ShovelerImageMipmaps* mipmaps = clientImage->mipmaps;
+  clientImage->mipmaps = NULL;
+  return mipmaps;
 }
 
 #endif
@@ -13,7 +13,7 @@ void shovelerClientSystemAddTextureSystem(ShovelerClientSystem* clientSystem);
 
 static inline ShovelerTexture* shovelerComponentGetTexture(ShovelerComponent* component) {
   assert(component->type->id == shovelerComponentTypeIdTexture);
-  return component->systemData;
+  return (ShovelerTexture*) component->systemData;
 }
 
 #endif
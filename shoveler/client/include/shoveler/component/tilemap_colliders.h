@@ -7,12 +7,22 @@
 #include <shoveler/schema/opengl.h>
 
 typedef struct ShovelerClientSystemStruct ShovelerClientSystem;
+typedef struct ShovelerTilemapCollidersStruct
+    ShovelerTilemapColliders; // forward declaration: tilemap_colliders.h
 
 void shovelerClientSystemAddTilemapCollidersSystem(ShovelerClientSystem* clientSystem);
+/**
+ * Applies the colliders field updates of active tilemap colliders components since the last call,
+ * coalescing several updates to one component into one. Returns the number of updated components.
+ *
+ * Called on every update of the client system's executor, i.e. once per frame.
+ */
+int shovelerClientSystemUpdateTilemapColliders(ShovelerClientSystem* clientSystem);
 
-static inline const bool* shovelerComponentGetTilemapColliders(ShovelerComponent* component) {
+static inline const ShovelerTilemapColliders* shovelerComponentGetTilemapColliders(
+    ShovelerComponent* component) {
   assert(component->type->id == shovelerComponentTypeIdTilemapColliders);
-  return component->systemData;
+  return (const ShovelerTilemapColliders*) component->systemData;
 }
 
 #endif
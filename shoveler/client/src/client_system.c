@@ -125,6 +125,8 @@ ShovelerClientSystem* shovelerClientSystemCreate(
 void shovelerClientSystemFree(ShovelerClientSystem* clientSystem) {
   shovelerExecutorRemoveCallback(
       clientSystem->executor, clientSystem->updateWorldCountersExecutorCallback);
+  shovelerExecutorRemoveCallback(
+      clientSystem->executor, clientSystem->updateTilemapCollidersExecutorCallback);
   shovelerInputRemoveKeyCallback(clientSystem->input, clientSystem->keyCallback);
   shovelerWorldFree(clientSystem->world);
   shovelerSchemaFree(clientSystem->schema);
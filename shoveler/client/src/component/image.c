@@ -1,19 +1,43 @@
 #include "shoveler/component/image.h"
 
 #include <assert.h>
+#include <stdlib.h> // malloc free
+#include <string.h> // memcpy
 
 #include "shoveler/client_system.h"
 #include "shoveler/component/resource.h"
 #include "shoveler/component_system.h"
 #include "shoveler/image.h"
+#include "shoveler/image/mipmap.h"
 #include "shoveler/image/png.h"
 #include "shoveler/image/ppm.h"
 #include "shoveler/log.h"
 #include "shoveler/schema.h"
+#include "shoveler/schema/opengl.h"
 #include "shoveler/system.h"
 
-static void* activateImageComponent(ShovelerComponent* component, void* clientSystemPointer);
+typedef struct {
+  long long int entityId;
+  ShovelerComponentImageFormat format;
+  /* private copy, since the resource may be updated or removed while the job runs */
+  unsigned char* bufferData;
+  int bufferSize;
+  /* whether a texture will upload the image, which is the only consumer of its mip chain */
+  bool buildMipmaps;
+  ShovelerImage* image;
+  ShovelerImageMipmaps* mipmaps;
+} DecodeJob;
+
+static void* prepareImageActivation(ShovelerComponent* component, void* clientSystemPointer);
+static void runImageActivation(void* jobPointer, void* clientSystemPointer);
+static void* commitImageActivation(
+    ShovelerComponent* component, void* jobPointer, void* clientSystemPointer);
+static void discardImageActivation(void* jobPointer, void* clientSystemPointer);
 static void deactivateImageComponent(ShovelerComponent* component, void* clientSystemPointer);
+static void checkTextureReverseDependency(
+    ShovelerComponent* sourceComponent,
+    ShovelerComponent* targetComponent,
+    void* buildMipmapsPointer);
 
 void shovelerClientSystemAddImageSystem(ShovelerClientSystem* clientSystem) {
   ShovelerComponentType* componentType =
@@ -22,12 +46,15 @@ void shovelerClientSystemAddImageSystem(ShovelerClientSystem* clientSystem) {
 
   ShovelerComponentSystem* componentSystem =
       shovelerSystemForComponentType(clientSystem->system, componentType);
-  componentSystem->activateComponent = activateImageComponent;
+  componentSystem->prepareActivation = prepareImageActivation;
+  componentSystem->runActivation = runImageActivation;
+  componentSystem->commitActivation = commitImageActivation;
+  componentSystem->discardActivation = discardImageActivation;
   componentSystem->deactivateComponent = deactivateImageComponent;
   componentSystem->callbackUserData = clientSystem;
 }
 
-static void* activateImageComponent(ShovelerComponent* component, void* clientSystemPointer) {
+static void* prepareImageActivation(ShovelerComponent* component, void* clientSystemPointer) {
   ShovelerComponent* resourceComponent =
       shovelerComponentGetDependency(component, SHOVELER_COMPONENT_IMAGE_FIELD_ID_RESOURCE);
   assert(resourceComponent != NULL);
@@ -36,24 +63,96 @@ static void* activateImageComponent(ShovelerComponent* component, void* clientSy
   int bufferSize;
   shovelerComponentGetResource(resourceComponent, &bufferData, &bufferSize);
 
-  ShovelerComponentImageFormat format =
+  DecodeJob* job = malloc(sizeof(DecodeJob));
+  job->entityId = component->entityId;
+  job->format =
       shovelerComponentGetFieldValueInt(component, SHOVELER_COMPONENT_IMAGE_FIELD_ID_FORMAT);
-  switch (format) {
+  job->bufferData = malloc(bufferSize * sizeof(unsigned char));
+  memcpy(job->bufferData, bufferData, bufferSize * sizeof(unsigned char));
+  job->bufferSize = bufferSize;
+  job->buildMipmaps = false;
+  component->worldAdapter->forEachReverseDependency(
+      component,
+      checkTextureReverseDependency,
+      &job->buildMipmaps,
+      component->worldAdapter->userData);
+  job->image = NULL;
+  job->mipmaps = NULL;
+
+  return job;
+}
+
+static void runImageActivation(void* jobPointer, void* clientSystemPointer) {
+  DecodeJob* job = jobPointer;
+
+  switch (job->format) {
   case SHOVELER_COMPONENT_IMAGE_FORMAT_PNG:
-    return shovelerImagePngReadBuffer(bufferData, bufferSize);
+    job->image = shovelerImagePngReadBuffer(job->bufferData, job->bufferSize);
+    break;
   case SHOVELER_COMPONENT_IMAGE_FORMAT_PPM:
-    return shovelerImagePpmReadBuffer(bufferData, bufferSize);
+    job->image = shovelerImagePpmReadBuffer(job->bufferData, job->bufferSize);
+    break;
   default:
     shovelerLogWarning(
         "Failed to activate entity %lld component image: Unknown format value %d.",
-        component->entityId,
-        format);
+        job->entityId,
+        job->format);
+    break;
+  }
+
+  // the encoded data isn't needed anymore once decoded
+  free(job->bufferData);
+  job->bufferData = NULL;
+
+  // Building the mip chain here keeps it off the render thread, which would otherwise have the
+  // driver generate it when textures upload the image. The box filter matches what the driver
+  // does for the non-sRGB formats textures are created with.
+  if (job->image != NULL && job->buildMipmaps) {
+    job->mipmaps = shovelerImageMipmapsCreate(job->image, SHOVELER_IMAGE_MIPMAP_FILTER_BOX);
+  }
+}
+
+static void* commitImageActivation(
+    ShovelerComponent* component, void* jobPointer, void* clientSystemPointer) {
+  DecodeJob* job = jobPointer;
+
+  if (job->image == NULL) {
+    free(job);
     return NULL;
   }
+
+  ShovelerClientImage* clientImage = malloc(sizeof(ShovelerClientImage));
+  clientImage->image = job->image;
+  clientImage->mipmaps = job->mipmaps;
+  free(job);
+
+  return clientImage;
+}
+
+static void discardImageActivation(void* jobPointer, void* clientSystemPointer) {
+  DecodeJob* job = jobPointer;
+
+  shovelerImageMipmapsFree(job->mipmaps);
+  shovelerImageFree(job->image);
+  free(job->bufferData);
+  free(job);
 }
 
 static void deactivateImageComponent(ShovelerComponent* component, void* clientSystemPointer) {
-  ShovelerImage* image = component->systemData;
+  ShovelerClientImage* clientImage = component->systemData;
+
+  shovelerImageMipmapsFree(clientImage->mipmaps);
+  shovelerImageFree(clientImage->image);
+  free(clientImage);
+}
 
-  shovelerImageFree(image);
+static void checkTextureReverseDependency(
+    ShovelerComponent* sourceComponent,
+    ShovelerComponent* targetComponent,
+    void* buildMipmapsPointer) {
+  bool* buildMipmaps = buildMipmapsPointer;
+
+  if (sourceComponent->type->id == shovelerComponentTypeIdTexture) {
+    *buildMipmaps = true;
+  }
 }
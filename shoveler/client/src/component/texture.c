@@ -6,6 +6,7 @@
 #include "shoveler/component/image.h"
 #include "shoveler/component/text_texture_renderer.h"
 #include "shoveler/component_system.h"
+#include "shoveler/image/mipmap.h"
 #include "shoveler/log.h"
 #include "shoveler/schema.h"
 #include "shoveler/system.h"
@@ -49,8 +50,17 @@ static void* activateTextureComponent(ShovelerComponent* component, void* client
     ShovelerImage* image = shovelerComponentGetImage(imageComponent);
     assert(image != NULL);
 
+    // upload the mip chain built on the activation thread instead of generating it here, and drop
+    // it right after since the texture keeps its own copy
     texture = shovelerTextureCreate2d(image, false);
-    shovelerTextureUpdate(texture);
+    ShovelerImageMipmaps* mipmaps = shovelerComponentTakeImageMipmaps(imageComponent);
+    if (mipmaps != NULL) {
+      shovelerTextureUpdateWithMipmaps(texture, mipmaps);
+      shovelerImageMipmapsFree(mipmaps);
+    } else {
+      // another texture took the mip chain already or it was never built
+      shovelerTextureUpdate(texture);
+    }
   } break;
   case SHOVELER_COMPONENT_TEXTURE_TYPE_TEXT: {
     if (!shovelerComponentHasFieldValue(
@@ -97,5 +107,20 @@ static void* activateTextureComponent(ShovelerComponent* component, void* client
 static void deactivateTextureComponent(ShovelerComponent* component, void* clientSystemPointer) {
   ShovelerTexture* texture = (ShovelerTexture*) component->systemData;
 
+  ShovelerComponentTextureType type =
+      shovelerComponentGetFieldValueInt(component, SHOVELER_COMPONENT_TEXTURE_FIELD_ID_TYPE);
+  if (type == SHOVELER_COMPONENT_TEXTURE_TYPE_TEXT) {
+    // text textures are shared through the renderer's cache, which is still active at this point
+    ShovelerComponent* textTextureRendererComponent = shovelerComponentGetDependency(
+        component, SHOVELER_COMPONENT_TEXTURE_FIELD_ID_TEXT_TEXTURE_RENDERER);
+    assert(textTextureRendererComponent != NULL);
+    ShovelerTextTextureRenderer* textTextureRenderer =
+        shovelerComponentGetTextTextureRenderer(textTextureRendererComponent);
+    assert(textTextureRenderer != NULL);
+
+    shovelerTextTextureRendererRelease(textTextureRenderer, texture);
+    return;
+  }
+
   shovelerTextureFree(texture);
 }
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <string>
+
+extern "C" {
+#include <glad/glad.h>
+
+#include "shoveler/client_system.h"
+#include "shoveler/component.h"
+#include "shoveler/component/image.h"
+#include "shoveler/component/texture.h"
+#include "shoveler/schema.h"
+#include "shoveler/schema/base.h"
+#include "shoveler/schema/opengl.h"
+#include "shoveler/system.h"
+#include "shoveler/texture.h"
+#include "shoveler/world.h"
+}
+
+static const long long int resourceEntityId = 1;
+static const long long int imageEntityId = 2;
+static const long long int textureEntityId1 = 3;
+static const long long int textureEntityId2 = 4;
+
+/** Counts the OpenGL calls made by textures, so that they can be tested without a context. */
+struct FakeOpenGLCalls {
+  int numLevelUploads = 0;
+  int numGenerateMipmaps = 0;
+};
+
+static FakeOpenGLCalls fakeOpenGLCalls;
+
+static void updateAuthoritativeComponent(
+    ShovelerWorld* world,
+    ShovelerComponent* component,
+    int fieldId,
+    const ShovelerComponentField* field,
+    const ShovelerComponentFieldValue* value,
+    void* testPointer) {}
+
+static void APIENTRY fakeGenTextures(GLsizei n, GLuint* textures) {
+  for (GLsizei i = 0; i < n; i++) {
+    textures[i] = 1;
+  }
+}
+static void APIENTRY fakeDeleteTextures(GLsizei n, const GLuint* textures) {}
+static void APIENTRY fakeBindTexture(GLenum target, GLuint texture) {}
+static void APIENTRY fakeTexStorage2D(
+    GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height) {}
+static void APIENTRY fakePixelStorei(GLenum pname, GLint param) {}
+static void APIENTRY fakeTexSubImage2D(
+    GLenum target,
+    GLint level,
+    GLint xoffset,
+    GLint yoffset,
+    GLsizei width,
+    GLsizei height,
+    GLenum format,
+    GLenum type,
+    const void* pixels) {
+  fakeOpenGLCalls.numLevelUploads++;
+}
+static void APIENTRY fakeGenerateMipmap(GLenum target) { fakeOpenGLCalls.numGenerateMipmaps++; }
+static GLenum APIENTRY fakeGetError() { return GL_NO_ERROR; }
+
+class ShovelerClientTextureTest : public ::testing::Test {
+public:
+  virtual void SetUp() {
+    fakeOpenGLCalls = FakeOpenGLCalls{};
+    glad_glGenTextures = fakeGenTextures;
+    glad_glDeleteTextures = fakeDeleteTextures;
+    glad_glBindTexture = fakeBindTexture;
+    glad_glTexStorage2D = fakeTexStorage2D;
+    glad_glPixelStorei = fakePixelStorei;
+    glad_glTexSubImage2D = fakeTexSubImage2D;
+    glad_glGenerateMipmap = fakeGenerateMipmap;
+    glad_glGetError = fakeGetError;
+
+    clientSystem = (ShovelerClientSystem*) calloc(1, sizeof(ShovelerClientSystem));
+    clientSystem->system = shovelerSystemCreate();
+    clientSystem->schema = shovelerSchemaCreate();
+    clientSystem->world = shovelerWorldCreate(
+        clientSystem->schema, clientSystem->system, updateAuthoritativeComponent, this);
+    shovelerSchemaBaseRegister(clientSystem->schema);
+    shovelerSchemaOpenglRegister(clientSystem->schema);
+    shovelerClientSystemAddImageSystem(clientSystem);
+    shovelerClientSystemAddTextureSystem(clientSystem);
+
+    // a 4x4 image has a mip chain of three levels
+    std::string ppm = "P3\n4 4\n255\n";
+    for (int i = 0; i < 4 * 4; i++) {
+      ppm += "255 0 0\n";
+    }
+
+    resourceComponent = addComponent(resourceEntityId, shovelerComponentTypeIdResource);
+    shovelerComponentUpdateCanonicalFieldBytes(
+        resourceComponent,
+        SHOVELER_COMPONENT_RESOURCE_FIELD_ID_BUFFER,
+        (const unsigned char*) ppm.data(),
+        (int) ppm.size());
+
+    imageComponent = addComponent(imageEntityId, shovelerComponentTypeIdImage);
+    shovelerComponentUpdateCanonicalFieldInt(
+        imageComponent,
+        SHOVELER_COMPONENT_IMAGE_FIELD_ID_FORMAT,
+        SHOVELER_COMPONENT_IMAGE_FORMAT_PPM);
+    shovelerComponentUpdateCanonicalFieldEntityId(
+        imageComponent, SHOVELER_COMPONENT_IMAGE_FIELD_ID_RESOURCE, resourceEntityId);
+  }
+
+  virtual void TearDown() {
+    shovelerWorldFree(clientSystem->world);
+    shovelerSchemaFree(clientSystem->schema);
+    shovelerSystemFree(clientSystem->system);
+    free(clientSystem);
+  }
+
+  ShovelerComponent* addComponent(long long int entityId, const char* componentTypeId) {
+    ShovelerWorldEntity* entity = shovelerWorldGetEntity(clientSystem->world, entityId);
+    if (entity == NULL) {
+      entity = shovelerWorldAddEntity(clientSystem->world, entityId);
+    }
+
+    return shovelerWorldEntityAddComponent(entity, componentTypeId);
+  }
+
+  ShovelerComponent* addImageTexture(long long int entityId) {
+    ShovelerComponent* component = addComponent(entityId, shovelerComponentTypeIdTexture);
+    shovelerComponentUpdateCanonicalFieldInt(
+        component, SHOVELER_COMPONENT_TEXTURE_FIELD_ID_TYPE, SHOVELER_COMPONENT_TEXTURE_TYPE_IMAGE);
+    shovelerComponentUpdateCanonicalFieldEntityId(
+        component, SHOVELER_COMPONENT_TEXTURE_FIELD_ID_IMAGE, imageEntityId);
+    return component;
+  }
+
+  void activateImage() {
+    ASSERT_TRUE(shovelerComponentActivate(resourceComponent));
+    ASSERT_TRUE(shovelerComponentActivate(imageComponent));
+  }
+
+  ShovelerClientSystem* clientSystem;
+  ShovelerComponent* resourceComponent;
+  ShovelerComponent* imageComponent;
+};
+
+TEST_F(ShovelerClientTextureTest, uploadMipmapsBuiltForTexture) {
+  ShovelerComponent* textureComponent = addImageTexture(textureEntityId1);
+
+  activateImage();
+
+  ASSERT_TRUE(shovelerComponentIsActive(textureComponent));
+  ShovelerTexture* texture = shovelerComponentGetTexture(textureComponent);
+  ASSERT_TRUE(texture->uploaded);
+  ASSERT_EQ(fakeOpenGLCalls.numLevelUploads, 3);
+  ASSERT_EQ(fakeOpenGLCalls.numGenerateMipmaps, 0);
+  ASSERT_TRUE(shovelerComponentTakeImageMipmaps(imageComponent) == NULL)
+      << "the uploaded mip chain should have been handed over to the texture";
+}
+
+TEST_F(ShovelerClientTextureTest, uploadSecondTextureWithoutMipmaps) {
+  ShovelerComponent* textureComponent1 = addImageTexture(textureEntityId1);
+  ShovelerComponent* textureComponent2 = addImageTexture(textureEntityId2);
+
+  activateImage();
+
+  ASSERT_TRUE(shovelerComponentIsActive(textureComponent1));
+  ASSERT_TRUE(shovelerComponentIsActive(textureComponent2));
+  ASSERT_TRUE(shovelerComponentGetTexture(textureComponent1)->uploaded);
+  ASSERT_TRUE(shovelerComponentGetTexture(textureComponent2)->uploaded)
+      << "the texture that didn't get the mip chain should still be uploaded";
+  ASSERT_EQ(fakeOpenGLCalls.numLevelUploads, 3 + 1);
+  ASSERT_EQ(fakeOpenGLCalls.numGenerateMipmaps, 1);
+}
+
+TEST_F(ShovelerClientTextureTest, uploadReactivatedTextureWithoutMipmaps) {
+  ShovelerComponent* textureComponent = addImageTexture(textureEntityId1);
+  activateImage();
+  fakeOpenGLCalls = FakeOpenGLCalls{};
+
+  // updating the dependency field deactivates the texture while the image stays active
+  shovelerComponentUpdateCanonicalFieldEntityId(
+      textureComponent, SHOVELER_COMPONENT_TEXTURE_FIELD_ID_IMAGE, imageEntityId);
+  ASSERT_FALSE(shovelerComponentIsActive(textureComponent));
+  ASSERT_TRUE(shovelerComponentIsActive(imageComponent));
+
+  ASSERT_TRUE(shovelerComponentActivate(textureComponent));
+
+  ASSERT_TRUE(shovelerComponentGetTexture(textureComponent)->uploaded);
+  ASSERT_EQ(fakeOpenGLCalls.numLevelUploads, 1);
+  ASSERT_EQ(fakeOpenGLCalls.numGenerateMipmaps, 1);
+}
+
+TEST_F(ShovelerClientTextureTest, uploadWithoutMipmapsNeverBuilt) {
+  activateImage();
+  ShovelerComponent* textureComponent = addImageTexture(textureEntityId1);
+
+  ASSERT_TRUE(shovelerComponentActivate(textureComponent));
+
+  ASSERT_TRUE(shovelerComponentGetTexture(textureComponent)->uploaded)
+      << "a texture added after the image was decoded should still be uploaded";
+  ASSERT_EQ(fakeOpenGLCalls.numLevelUploads, 1);
+  ASSERT_EQ(fakeOpenGLCalls.numGenerateMipmaps, 1);
+}
@@ -40,7 +40,8 @@ static void* activateTilemapComponent(ShovelerComponent* component, void* client
   ShovelerComponent* collidersComponent =
       shovelerComponentGetDependency(component, SHOVELER_COMPONENT_TILEMAP_FIELD_ID_COLLIDERS);
   assert(collidersComponent != NULL);
-  const bool* colliders = shovelerComponentGetTilemapColliders(collidersComponent);
+  const ShovelerTilemapColliders* colliders =
+      shovelerComponentGetTilemapColliders(collidersComponent);
   assert(colliders != NULL);
   int numCollidersColumns = shovelerComponentGetFieldValueInt(
       collidersComponent, SHOVELER_COMPONENT_TILEMAP_COLLIDERS_OPTION_NUM_COLUMNS);
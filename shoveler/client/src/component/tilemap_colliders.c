@@ -1,12 +1,14 @@
 #include "shoveler/component/tilemap_colliders.h"
 
 #include <assert.h>
-#include <stdlib.h>
 
 #include "shoveler/client_system.h"
 #include "shoveler/component_system.h"
+#include "shoveler/executor.h"
 #include "shoveler/schema.h"
 #include "shoveler/system.h"
+#include "shoveler/tilemap_colliders.h"
+#include "shoveler/world.h"
 
 static void* activateTilemapCollidersComponent(
     ShovelerComponent* component, void* clientSystemPointer);
@@ -18,7 +20,10 @@ static bool liveUpdateCollidersOption(
     const ShovelerComponentField* field,
     ShovelerComponentFieldValue* fieldValue,
     void* clientSystemPointer);
-static void updateColliders(ShovelerComponent* component, bool* colliders);
+static void updateColliders(ShovelerComponent* component, ShovelerTilemapColliders* colliders);
+static void updateChangedColliders(
+    ShovelerWorld* world, const ShovelerWorldChange* change, void* numUpdatedPointer);
+static void updateTilemapCollidersExecutorCallback(void* clientSystemPointer);
 
 void shovelerClientSystemAddTilemapCollidersSystem(ShovelerClientSystem* clientSystem) {
   ShovelerComponentType* componentType =
@@ -32,6 +37,27 @@ void shovelerClientSystemAddTilemapCollidersSystem(ShovelerClientSystem* clientS
   componentSystem->fieldOptions[SHOVELER_COMPONENT_TILEMAP_COLLIDERS_OPTION_COLLIDERS]
       .liveUpdateField = liveUpdateCollidersOption;
   componentSystem->callbackUserData = clientSystem;
+
+  clientSystem->tilemapCollidersChangeConsumer =
+      shovelerWorldAddChangeConsumer(clientSystem->world, shovelerComponentTypeIdTilemapColliders);
+  // an interval of a single millisecond runs the update on every executor update, once per frame
+  clientSystem->updateTilemapCollidersExecutorCallback = shovelerExecutorSchedulePeriodic(
+      clientSystem->executor,
+      /* timeoutMs */ 0,
+      /* intervalMs */ 1,
+      updateTilemapCollidersExecutorCallback,
+      clientSystem);
+}
+
+int shovelerClientSystemUpdateTilemapColliders(ShovelerClientSystem* clientSystem) {
+  int numUpdated = 0;
+  shovelerWorldConsumeChanges(
+      clientSystem->world,
+      clientSystem->tilemapCollidersChangeConsumer,
+      updateChangedColliders,
+      &numUpdated);
+
+  return numUpdated;
 }
 
 static void* activateTilemapCollidersComponent(
@@ -41,7 +67,7 @@ static void* activateTilemapCollidersComponent(
   int numRows = shovelerComponentGetFieldValueInt(
       component, SHOVELER_COMPONENT_TILEMAP_COLLIDERS_OPTION_NUM_ROWS);
 
-  bool* colliders = malloc(numColumns * numRows * sizeof(bool));
+  ShovelerTilemapColliders* colliders = shovelerTilemapCollidersCreate(numColumns, numRows);
   updateColliders(component, colliders);
 
   return colliders;
@@ -49,9 +75,9 @@ static void* activateTilemapCollidersComponent(
 
 static void deactivateTilemapCollidersComponent(
     ShovelerComponent* component, void* clientSystemPointer) {
-  bool* colliders = (bool*) component->systemData;
+  ShovelerTilemapColliders* colliders = component->systemData;
 
-  free(colliders);
+  shovelerTilemapCollidersFree(colliders);
 }
 
 static bool liveUpdateCollidersOption(
@@ -60,34 +86,50 @@ static bool liveUpdateCollidersOption(
     const ShovelerComponentField* field,
     ShovelerComponentFieldValue* fieldValue,
     void* clientSystemPointer) {
-  bool* colliders = (bool*) component->systemData;
-  assert(colliders != NULL);
-
-  updateColliders(component, colliders);
-
+  // Colliders are rebuilt from the latest value once per frame instead, no matter how many updates
+  // arrived since the last one.
   return false; // don't propagate
 }
 
-static void updateColliders(ShovelerComponent* component, bool* colliders) {
-  int numColumns = shovelerComponentGetFieldValueInt(
-      component, SHOVELER_COMPONENT_TILEMAP_COLLIDERS_OPTION_NUM_COLUMNS);
-  int numRows = shovelerComponentGetFieldValueInt(
-      component, SHOVELER_COMPONENT_TILEMAP_COLLIDERS_OPTION_NUM_ROWS);
-
+static void updateColliders(ShovelerComponent* component, ShovelerTilemapColliders* colliders) {
   const unsigned char* collidersOption;
+  int collidersOptionSize;
   shovelerComponentGetFieldValueBytes(
       component,
       SHOVELER_COMPONENT_TILEMAP_COLLIDERS_OPTION_COLLIDERS,
       &collidersOption,
-      /* outputSize */ NULL);
+      &collidersOptionSize);
   assert(collidersOption != NULL);
+  assert(collidersOptionSize >= colliders->numColumns * colliders->numRows);
+
+  shovelerTilemapCollidersUpdate(colliders, collidersOption);
+}
 
-  for (int row = 0; row < numRows; ++row) {
-    int rowIndex = row * numColumns;
-    for (int column = 0; column < numColumns; ++column) {
-      int columnIndex = rowIndex + column;
+static void updateChangedColliders(
+    ShovelerWorld* world, const ShovelerWorldChange* change, void* numUpdatedPointer) {
+  int* numUpdated = numUpdatedPointer;
 
-      colliders[columnIndex] = collidersOption[columnIndex];
-    }
+  if (change->fieldId != SHOVELER_COMPONENT_TILEMAP_COLLIDERS_OPTION_COLLIDERS) {
+    return;
   }
+
+  ShovelerWorldEntity* entity = shovelerWorldGetEntity(world, change->entityId);
+  if (entity == NULL) {
+    return;
+  }
+
+  // inactive components pick up the latest value when they are activated
+  ShovelerComponent* component = shovelerWorldEntityGetComponent(entity, change->componentTypeId);
+  if (component == NULL || component->systemData == NULL) {
+    return;
+  }
+
+  updateColliders(component, component->systemData);
+  (*numUpdated)++;
+}
+
+static void updateTilemapCollidersExecutorCallback(void* clientSystemPointer) {
+  ShovelerClientSystem* clientSystem = clientSystemPointer;
+
+  shovelerClientSystemUpdateTilemapColliders(clientSystem);
 }
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <vector>
+
+extern "C" {
+#include "shoveler/client_system.h"
+#include "shoveler/component.h"
+#include "shoveler/component/tilemap_colliders.h"
+#include "shoveler/executor.h"
+#include "shoveler/schema.h"
+#include "shoveler/schema/base.h"
+#include "shoveler/schema/opengl.h"
+#include "shoveler/system.h"
+#include "shoveler/tilemap_colliders.h"
+#include "shoveler/world.h"
+}
+
+static const long long int entityId = 1;
+static const int numColumns = 4;
+static const int numRows = 2;
+
+static void updateAuthoritativeComponent(
+    ShovelerWorld* world,
+    ShovelerComponent* component,
+    int fieldId,
+    const ShovelerComponentField* field,
+    const ShovelerComponentFieldValue* value,
+    void* testPointer) {}
+
+class ShovelerClientTilemapCollidersTest : public ::testing::Test {
+public:
+  virtual void SetUp() {
+    clientSystem = (ShovelerClientSystem*) calloc(1, sizeof(ShovelerClientSystem));
+    clientSystem->system = shovelerSystemCreate();
+    clientSystem->schema = shovelerSchemaCreate();
+    clientSystem->world = shovelerWorldCreate(
+        clientSystem->schema, clientSystem->system, updateAuthoritativeComponent, this);
+    clientSystem->executor = shovelerExecutorCreateDirect();
+    shovelerSchemaBaseRegister(clientSystem->schema);
+    shovelerSchemaOpenglRegister(clientSystem->schema);
+    shovelerClientSystemAddTilemapCollidersSystem(clientSystem);
+
+    ShovelerWorldEntity* entity = shovelerWorldAddEntity(clientSystem->world, entityId);
+    component = shovelerWorldEntityAddComponent(entity, shovelerComponentTypeIdTilemapColliders);
+    shovelerComponentUpdateCanonicalFieldInt(
+        component, SHOVELER_COMPONENT_TILEMAP_COLLIDERS_OPTION_NUM_COLUMNS, numColumns);
+    shovelerComponentUpdateCanonicalFieldInt(
+        component, SHOVELER_COMPONENT_TILEMAP_COLLIDERS_OPTION_NUM_ROWS, numRows);
+    updateColliding(/* collidingColumn */ 0);
+    ASSERT_TRUE(shovelerComponentActivate(component));
+    // consume the updates from before the activation, like the first frame would
+    shovelerClientSystemUpdateTilemapColliders(clientSystem);
+  }
+
+  virtual void TearDown() {
+    shovelerExecutorRemoveCallback(
+        clientSystem->executor, clientSystem->updateTilemapCollidersExecutorCallback);
+    shovelerWorldFree(clientSystem->world);
+    shovelerExecutorFree(clientSystem->executor);
+    shovelerSchemaFree(clientSystem->schema);
+    shovelerSystemFree(clientSystem->system);
+    free(clientSystem);
+  }
+
+  /** Updates the colliders option so that only the given column of the first row collides. */
+  void updateColliding(int collidingColumn) {
+    std::vector<unsigned char> colliders(numColumns * numRows, 0);
+    colliders[collidingColumn] = 1;
+    shovelerComponentUpdateCanonicalFieldBytes(
+        component,
+        SHOVELER_COMPONENT_TILEMAP_COLLIDERS_OPTION_COLLIDERS,
+        colliders.data(),
+        (int) colliders.size());
+  }
+
+  bool isColliding(int column) {
+    const ShovelerTilemapColliders* colliders = shovelerComponentGetTilemapColliders(component);
+    return shovelerTilemapCollidersIntersectRange(colliders, column, 0, column, 0);
+  }
+
+  ShovelerClientSystem* clientSystem;
+  ShovelerComponent* component;
+};
+
+TEST_F(ShovelerClientTilemapCollidersTest, coalesceUpdates) {
+  for (int i = 0; i < 10; i++) {
+    updateColliding(i % numColumns);
+  }
+  ASSERT_TRUE(isColliding(0)) << "colliders should only be updated once per frame";
+
+  ASSERT_EQ(shovelerClientSystemUpdateTilemapColliders(clientSystem), 1)
+      << "ten updates should cost a single colliders update";
+  ASSERT_FALSE(isColliding(0));
+  ASSERT_TRUE(isColliding(9 % numColumns)) << "the last update should win";
+  ASSERT_EQ(shovelerClientSystemUpdateTilemapColliders(clientSystem), 0);
+}
+
+TEST_F(ShovelerClientTilemapCollidersTest, updateOnExecutorUpdate) {
+  updateColliding(2);
+
+  shovelerExecutorUpdate(clientSystem->executor, /* elapsedUs */ 16000);
+
+  ASSERT_FALSE(isColliding(0));
+  ASSERT_TRUE(isColliding(2));
+}
+
+TEST_F(ShovelerClientTilemapCollidersTest, skipInactive) {
+  shovelerComponentDeactivate(component);
+  updateColliding(3);
+
+  ASSERT_EQ(shovelerClientSystemUpdateTilemapColliders(clientSystem), 0);
+
+  ASSERT_TRUE(shovelerComponentActivate(component));
+  ASSERT_TRUE(isColliding(3)) << "activation should pick up the latest colliders";
+}
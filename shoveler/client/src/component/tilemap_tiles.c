@@ -56,6 +56,8 @@ static void* activateTilemapTilesComponent(
     assert(image != NULL);
 
     texture = shovelerTextureCreate2d(image, false);
+    // as for tiles from configuration options, mipmaps of the tile indices would never be sampled
+    texture->generateMipmaps = false;
     shovelerTextureUpdate(texture);
   } else if (!isImageResourceEntityDefinition && isConfigurationOptionDefinition) {
     int numColumns = shovelerComponentGetFieldValueInt(
@@ -64,8 +66,12 @@ static void* activateTilemapTilesComponent(
         component, SHOVELER_COMPONENT_TILEMAP_TILES_OPTION_NUM_ROWS);
 
     ShovelerImage* tilemapImage = shovelerImageCreate(numColumns, numRows, /* channels */ 3);
+    shovelerImageClear(tilemapImage);
     texture = shovelerTextureCreate2d(tilemapImage, true);
+    // tiles are looked up texel by texel, so mipmaps would never be sampled
+    texture->generateMipmaps = false;
     updateTiles(component, texture);
+    shovelerTextureUpdate(texture);
   } else {
     shovelerLogWarning(
         "Failed to activate tilemap tiles of entity %lld because it doesn't provide either an "
@@ -133,13 +139,20 @@ static void updateTiles(ShovelerComponent* component, ShovelerTexture* texture)
     for (int column = 0; column < numColumns; ++column) {
       int columnIndex = rowIndex + column;
 
-      shovelerImageGet(tilemapImage, column, row, 0) = tilesetColumns[columnIndex];
-      shovelerImageGet(tilemapImage, column, row, 1) = tilesetRows[columnIndex];
-      shovelerImageGet(tilemapImage, column, row, 2) = tilesetIds[columnIndex];
+      unsigned char* texel = &shovelerImageGet(tilemapImage, column, row, 0);
+      if (texel[0] == tilesetColumns[columnIndex] && texel[1] == tilesetRows[columnIndex] &&
+          texel[2] == tilesetIds[columnIndex]) {
+        continue;
+      }
+
+      texel[0] = tilesetColumns[columnIndex];
+      texel[1] = tilesetRows[columnIndex];
+      texel[2] = tilesetIds[columnIndex];
+      shovelerImageMarkDirty(tilemapImage, column, row, 1, 1);
     }
   }
 
-  shovelerTextureUpdate(texture);
+  // uploaded when the texture is next used
 }
 
 static bool isComponentImageResourceEntityDefinition(ShovelerComponent* component) {
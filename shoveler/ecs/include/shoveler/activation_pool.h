@@ -0,0 +1,91 @@
+#ifndef SHOVELER_ACTIVATION_POOL_H
+#define SHOVELER_ACTIVATION_POOL_H
+
+#include <glib.h>
+#include <stdbool.h> // bool
+
+typedef struct ShovelerActivationTaskStruct ShovelerActivationTask; // forward declaration: below
+typedef struct ShovelerComponentStruct ShovelerComponent; // forward declaration: component.h
+typedef struct ShovelerComponentSystemAdapterStruct
+    ShovelerComponentSystemAdapter; // forward declaration: component.h
+
+typedef void(ShovelerActivationPoolAdapterSubmitFunction)(
+    ShovelerActivationTask* task, void* userData);
+typedef bool(ShovelerActivationPoolAdapterIsFinishedFunction)(
+    ShovelerActivationTask* task, bool wait, void* userData);
+typedef void(ShovelerActivationPoolAdapterReleaseFunction)(
+    ShovelerActivationTask* task, void* userData);
+
+// Adapter struct to make an activation pool run its tasks on some worker pool.
+typedef struct ShovelerActivationPoolAdapterStruct {
+  /** Arranges for shovelerActivationTaskRun to be called on the task, on any thread. */
+  ShovelerActivationPoolAdapterSubmitFunction* submit;
+  /**
+   * Returns true if the task has finished running, blocking until it has if wait is true.
+   *
+   * Returning true must make all writes of the finished task visible to the calling thread.
+   */
+  ShovelerActivationPoolAdapterIsFinishedFunction* isFinished;
+  /** Optional, called once a finished task was committed or discarded and is about to be freed. */
+  ShovelerActivationPoolAdapterReleaseFunction* release;
+  void* userData;
+} ShovelerActivationPoolAdapter;
+
+typedef struct ShovelerActivationPoolStruct {
+  ShovelerActivationPoolAdapter* adapter;
+  /** queue of (ShovelerActivationTask *) in order of submission */
+  GQueue* tasks;
+  int numCommitted;
+  int numDiscarded;
+} ShovelerActivationPool;
+
+typedef struct ShovelerActivationTaskStruct {
+  ShovelerActivationPool* pool;
+  /** component to commit the job to, or NULL if the activation was cancelled */
+  ShovelerComponent* component;
+  ShovelerComponentSystemAdapter* systemAdapter;
+  void* job;
+} ShovelerActivationTask;
+
+/**
+ * Creates a pool that runs the CPU heavy part of deferrable component activations elsewhere.
+ *
+ * Activations are committed back on the main thread in the order they were submitted, no matter in
+ * which order the adapter finishes running them. Since a component is only submitted once all of
+ * its dependencies are active, this also commits them in dependency order, and the result is
+ * deterministic regardless of how the adapter schedules its worker threads.
+ *
+ * Apart from shovelerActivationTaskRun, all functions must be called on the main thread. The caller
+ * retains ownership of the adapter.
+ */
+ShovelerActivationPool* shovelerActivationPoolCreate(ShovelerActivationPoolAdapter* adapter);
+ShovelerActivationTask* shovelerActivationPoolSubmit(
+    ShovelerActivationPool* pool, ShovelerComponent* component, void* job);
+/**
+ * Commits finished activations in submission order, stopping at the first unfinished one unless
+ * wait is true. Activations that are submitted while committing, e.g. of reverse dependencies,
+ * are committed in the same call if they are finished in time. Returns the number of components
+ * that were activated.
+ */
+int shovelerActivationPoolCommit(ShovelerActivationPool* pool, bool wait);
+/**
+ * Waits for all cancelled tasks and discards them, keeping the others queued. Returns the number of
+ * discarded tasks.
+ *
+ * Discarding calls back into the system adapter of the cancelled component, so this must happen
+ * before that system is freed. shovelerWorldFree takes care of this for the components of its world.
+ */
+int shovelerActivationPoolDiscardCancelled(ShovelerActivationPool* pool);
+int shovelerActivationPoolGetNumPending(ShovelerActivationPool* pool);
+/**
+ * Waits for all pending tasks and discards them. Should be freed after the world using it, but
+ * before the systems of any components that are still pending.
+ */
+void shovelerActivationPoolFree(ShovelerActivationPool* pool);
+
+/** Runs the task's job. This is the only function that may be called from a worker thread. */
+void shovelerActivationTaskRun(ShovelerActivationTask* task);
+/** Cancels the task, so that its job is discarded rather than committed once it finishes. */
+void shovelerActivationTaskCancel(ShovelerActivationTask* task);
+
+#endif
@@ -7,6 +7,10 @@
 #include <shoveler/types.h>
 #include <stdbool.h> // bool
 
+typedef struct ShovelerActivationPoolStruct
+    ShovelerActivationPool; // forward declaration: activation_pool.h
+typedef struct ShovelerActivationTaskStruct
+    ShovelerActivationTask; // forward declaration: activation_pool.h
 typedef struct ShovelerComponentStruct ShovelerComponent; // forward declaration: below
 typedef struct ShovelerComponentTypeStruct
     ShovelerComponentType; // forward declaration: component_type.h
@@ -42,6 +46,8 @@ typedef void(ShovelerComponentWorldAdapterForEachReverseDependencyFunction)(
     ShovelerComponentWorldAdapterForEachReverseDependencyCallbackFunction* callbackFunction,
     void* callbackUserData,
     void* adapterUserData);
+typedef void(ShovelerComponentWorldAdapterOnUpdateFieldFunction)(
+    ShovelerComponent* component, int fieldId, const ShovelerComponentField* field, void* userData);
 
 // Adapter struct to make a component integrate with a world.
 typedef struct ShovelerComponentWorldAdapterStruct {
@@ -50,6 +56,12 @@ typedef struct ShovelerComponentWorldAdapterStruct {
   ShovelerComponentWorldAdapterAddDependencyFunction* addDependency;
   ShovelerComponentWorldAdapterRemoveDependencyFunction* removeDependency;
   ShovelerComponentWorldAdapterForEachReverseDependencyFunction* forEachReverseDependency;
+  /** Optional, called after a field value of the component was successfully updated. */
+  ShovelerComponentWorldAdapterOnUpdateFieldFunction* onUpdateField;
+  /**
+   * Optional pool to run deferrable activations on, or NULL to always activate synchronously.
+   */
+  ShovelerActivationPool* activationPool;
   void* userData;
 } ShovelerComponentWorldAdapter;
 
@@ -77,6 +89,14 @@ typedef bool(ShovelerComponentSystemAdapterUpdateComponentFunction)(
     ShovelerComponent* component, double dt, void* userData);
 typedef void(ShovelerComponentSystemAdapterDeactivateComponentFunction)(
     ShovelerComponent* component, void* userData);
+typedef bool(ShovelerComponentSystemAdapterCanDeferActivationFunction)(
+    ShovelerComponent* component, void* userData);
+typedef void*(ShovelerComponentSystemAdapterPrepareActivationFunction)(
+    ShovelerComponent* component, void* userData);
+typedef void(ShovelerComponentSystemAdapterRunActivationFunction)(void* job, void* userData);
+typedef void*(ShovelerComponentSystemAdapterCommitActivationFunction)(
+    ShovelerComponent* component, void* job, void* userData);
+typedef void(ShovelerComponentSystemAdapterDiscardActivationFunction)(void* job, void* userData);
 
 // Adapter struct to make a component integrate with a system.
 typedef struct ShovelerComponentSystemAdapterStruct {
@@ -108,6 +128,28 @@ typedef struct ShovelerComponentSystemAdapterStruct {
   ShovelerComponentSystemAdapterUpdateComponentFunction* updateComponent;
   /** Deactivates the specified component and frees its data. */
   ShovelerComponentSystemAdapterDeactivateComponentFunction* deactivateComponent;
+  /**
+   * Returns true if the component is activated in the three deferrable steps below instead of by
+   * activateComponent.
+   */
+  ShovelerComponentSystemAdapterCanDeferActivationFunction* canDeferActivation;
+  /**
+   * Copies everything the activation needs out of the component and its dependencies into a new
+   * job, returning NULL on failure. Called on the main thread.
+   */
+  ShovelerComponentSystemAdapterPrepareActivationFunction* prepareActivation;
+  /**
+   * Performs the CPU heavy part of the activation. Only touches the job and may be called on any
+   * thread of the world's activation pool.
+   */
+  ShovelerComponentSystemAdapterRunActivationFunction* runActivation;
+  /**
+   * Takes ownership of a finished job and turns it into the component's system data, returning
+   * NULL on failure. Called on the main thread, in order of preparation.
+   */
+  ShovelerComponentSystemAdapterCommitActivationFunction* commitActivation;
+  /** Frees a finished job whose activation was cancelled before it could be committed. */
+  ShovelerComponentSystemAdapterDiscardActivationFunction* discardActivation;
   void* userData;
 } ShovelerComponentSystemAdapter;
 
@@ -121,6 +163,8 @@ typedef struct ShovelerComponentStruct {
   // array of ShovelerEntityComponentId
   GArray* dependencies;
   void* systemData;
+  /** task of a deferred activation that hasn't been committed yet, or NULL */
+  ShovelerActivationTask* pendingActivation;
 } ShovelerComponent;
 
 ShovelerComponent* shovelerComponentCreate(
@@ -145,6 +189,14 @@ bool shovelerComponentClearField(ShovelerComponent* component, int id, bool isCa
 const ShovelerComponentFieldValue* shovelerComponentGetFieldValue(
     ShovelerComponent* component, int id);
 bool shovelerComponentIsActive(ShovelerComponent* component);
+/** Returns true if the component is waiting for a deferred activation to be committed. */
+bool shovelerComponentIsActivating(ShovelerComponent* component);
+/**
+ * Commits a finished deferred activation job of the component, taking ownership of the job.
+ *
+ * This is called by the activation pool on the main thread and shouldn't be called directly.
+ */
+bool shovelerComponentCommitActivation(ShovelerComponent* component, void* job);
 bool shovelerComponentUpdate(ShovelerComponent* component, double dt);
 void shovelerComponentDelegate(ShovelerComponent* component);
 bool shovelerComponentIsAuthoritative(ShovelerComponent* component);
@@ -29,6 +29,12 @@ typedef bool(ShovelerComponentSystemUpdateComponentFunction)(
     ShovelerComponent* component, double dt, void* userData);
 typedef void(ShovelerComponentSystemDeactivateComponentFunction)(
     ShovelerComponent* component, void* userData);
+typedef void*(ShovelerComponentSystemPrepareActivationFunction)(
+    ShovelerComponent* component, void* userData);
+typedef void(ShovelerComponentSystemRunActivationFunction)(void* job, void* userData);
+typedef void*(ShovelerComponentSystemCommitActivationFunction)(
+    ShovelerComponent* component, void* job, void* userData);
+typedef void(ShovelerComponentSystemDiscardActivationFunction)(void* job, void* userData);
 
 typedef struct ShovelerComponentSystemFieldOptionsStruct {
   ShovelerComponentSystemLiveUpdateFieldFunction* liveUpdateField;
@@ -44,6 +50,15 @@ typedef struct ShovelerComponentSystemStruct {
   ShovelerComponentSystemActivateComponentFunction* activateComponent;
   ShovelerComponentSystemUpdateComponentFunction* updateComponent;
   ShovelerComponentSystemDeactivateComponentFunction* deactivateComponent;
+  /**
+   * If all four of the following are set, they are used instead of activateComponent so that the
+   * CPU heavy runActivation can be deferred to the world's activation pool. It must only touch the
+   * job it is passed and the callback user data in a thread safe way.
+   */
+  ShovelerComponentSystemPrepareActivationFunction* prepareActivation;
+  ShovelerComponentSystemRunActivationFunction* runActivation;
+  ShovelerComponentSystemCommitActivationFunction* commitActivation;
+  ShovelerComponentSystemDiscardActivationFunction* discardActivation;
   void* callbackUserData;
 } ShovelerComponentSystem;
 
@@ -3,9 +3,13 @@
 
 typedef struct ShovelerComponentFieldStruct
     ShovelerComponentField; // forward declaration: component_field.h
+typedef struct ShovelerComponentTypeIdHandleStruct
+    ShovelerComponentTypeIdHandle; // forward declaration: component_type_id.h
 
 typedef struct ShovelerComponentTypeStruct {
+  /** canonical interned id pointer, equal to idHandle->id */
   const char* id;
+  const ShovelerComponentTypeIdHandle* idHandle;
   int numFields;
   ShovelerComponentField* fields;
 } ShovelerComponentType;
@@ -15,7 +19,8 @@ typedef struct ShovelerComponentTypeStruct {
  *
  * The specified ID should be a statically defined string with external linkage that will be used
  * as unique identifier for the component type. It is a string so it can be easily printed as part
- * of log messages.
+ * of log messages. The ID is interned, so if another pointer to the same string was interned
+ * before, the type's id is set to that canonical pointer instead.
  *
  * A component type can be created with any number of fields that will be instantiated on each
  * component instance of this type. The caller retains ownership of the passed fields.
@@ -0,0 +1,39 @@
+#ifndef SHOVELER_COMPONENT_TYPE_ID_H
+#define SHOVELER_COMPONENT_TYPE_ID_H
+
+#include <glib.h>
+
+/**
+ * Interned handle of a component type id string.
+ *
+ * There is exactly one handle per distinct id string. Its id pointer is the canonical pointer for
+ * that string, so interned ids can be compared and hashed by pointer, and its dense index can be
+ * used to address per type arrays instead of string keyed hash tables.
+ */
+typedef struct ShovelerComponentTypeIdHandleStruct {
+  /** canonical id pointer, i.e. the first pointer interned for this string */
+  const char* id;
+  /** dense index in [0, shovelerComponentTypeIdGetNumInterned()) */
+  int index;
+} ShovelerComponentTypeIdHandle;
+
+/**
+ * Interns the given component type id, returning its handle.
+ *
+ * If the id string wasn't interned before, the passed pointer becomes its canonical pointer and
+ * therefore must remain valid for the lifetime of the program, e.g. a statically defined string.
+ *
+ * The intern table is process global and not thread safe. Types are expected to be interned while
+ * setting up the schema, before any worker threads are started.
+ */
+const ShovelerComponentTypeIdHandle* shovelerComponentTypeIdIntern(const char* componentTypeId);
+/**
+ * Returns the handle of an already interned component type id, or NULL if it wasn't interned.
+ *
+ * Canonical pointers are resolved with a single pointer hash lookup, other pointers fall back to
+ * comparing the string contents.
+ */
+const ShovelerComponentTypeIdHandle* shovelerComponentTypeIdLookup(const char* componentTypeId);
+int shovelerComponentTypeIdGetNumInterned();
+
+#endif
@@ -37,7 +37,8 @@ static inline guint shovelerEntityComponentIdHash(gconstpointer entityComponentI
       (const ShovelerEntityComponentId*) entityComponentIdPointer;
 
   guint entityIdHash = g_int64_hash(&entityComponentId->entityId);
-  guint componentTypeIdHash = g_str_hash(entityComponentId->componentTypeId);
+  // component type ids are interned, so they are hashed by pointer just like they are compared
+  guint componentTypeIdHash = g_direct_hash(entityComponentId->componentTypeId);
 
   return shovelerHashCombine(entityIdHash, componentTypeIdHash);
 }
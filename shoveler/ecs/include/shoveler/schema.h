@@ -6,8 +6,8 @@
 typedef struct ShovelerComponentTypeStruct ShovelerComponentType;
 
 typedef struct ShovelerSchemaStruct {
-  /** map from string component type id to (ShovelerComponentType *) */
-  GHashTable* componentTypes;
+  /** array of (ShovelerComponentType *) indexed by interned component type id index */
+  GArray* componentTypes;
 } ShovelerSchema;
 
 ShovelerSchema* shovelerSchemaCreate();
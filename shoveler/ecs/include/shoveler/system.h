@@ -7,8 +7,8 @@ typedef struct ShovelerComponentSystemStruct ShovelerComponentSystem;
 typedef struct ShovelerComponentTypeStruct ShovelerComponentType;
 
 typedef struct ShovelerSystemStruct {
-  /** map from string component type id to (ShovelerComponentSystem *) */
-  GHashTable* componentSystems;
+  /** array of (ShovelerComponentSystem *) indexed by interned component type id index */
+  GArray* componentSystems;
   int numActiveComponents;
 } ShovelerSystem;
 
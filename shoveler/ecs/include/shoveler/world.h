@@ -2,7 +2,9 @@
 #define SHOVELER_WORLD_H
 
 #include <glib.h>
+#include <stdint.h> // uint64_t
 
+typedef struct ShovelerActivationPoolStruct ShovelerActivationPool;
 typedef struct ShovelerComponentStruct ShovelerComponent;
 typedef struct ShovelerComponentFieldStruct ShovelerComponentField;
 typedef struct ShovelerComponentFieldValueStruct ShovelerComponentFieldValue;
@@ -14,6 +16,9 @@ typedef struct ShovelerSchemaStruct ShovelerSchema;
 typedef struct ShovelerSystemStruct ShovelerSystem;
 typedef struct ShovelerWorldStruct ShovelerWorld;
 
+/** Field id recorded in a world change when a component was added or removed. */
+#define SHOVELER_WORLD_CHANGE_COMPONENT_FIELD_ID -1
+
 typedef void(ShovelerWorldUpdateAuthoritativeComponentFunction)(
     ShovelerWorld* world,
     ShovelerComponent* component,
@@ -32,8 +37,10 @@ typedef struct ShovelerWorldStruct {
   GHashTable* entities;
   /** map from source (ShovelerEntityComponentId *) to array of (ShovelerEntityComponentId *) */
   GHashTable* dependencies;
-  /** map from target (ShovelerEntityComponentId *) to array of (ShovelerEntityComponentId *) */
+  /** map from target (ShovelerEntityComponentId *) to array of source (ShovelerComponent *) */
   GHashTable* reverseDependencies;
+  /** set of private reverse dependency edges keyed by source component and target */
+  GHashTable* reverseDependencyEdges;
   /** array of (ShovelerWorldDependencyCallback) */
   GArray* dependencyCallbacks;
   ShovelerSchema* schema;
@@ -41,6 +48,14 @@ typedef struct ShovelerWorldStruct {
   ShovelerWorldUpdateAuthoritativeComponentFunction* updateAuthoritativeComponent;
   void* updateAuthoritativeComponentUserData;
   ShovelerComponentWorldAdapter* componentWorldAdapter;
+  /** generation counter incremented for every recorded change */
+  uint64_t changeGeneration;
+  /** array of (ShovelerWorldChange *) in order of their first recording */
+  GArray* changes;
+  /** set of owned (ShovelerWorldChange *) keyed by entity id, component type id and field id */
+  GHashTable* changeIndex;
+  /** array of (ShovelerWorldChangeConsumer *) */
+  GArray* changeConsumers;
   int numComponentDependencies;
   int numComponents;
 } ShovelerWorld;
@@ -67,12 +82,42 @@ typedef struct {
   void* userData;
 } ShovelerWorldDependencyCallback;
 
+/**
+ * Entry of the world change journal.
+ *
+ * Multiple changes to the same field of the same component are coalesced into a single entry,
+ * whose generation is bumped to the one of the most recent change.
+ */
+typedef struct ShovelerWorldChangeStruct {
+  long long int entityId;
+  const char* componentTypeId;
+  /** changed field id, or SHOVELER_WORLD_CHANGE_COMPONENT_FIELD_ID for component add or remove */
+  int fieldId;
+  uint64_t generation;
+} ShovelerWorldChange;
+
+typedef struct ShovelerWorldChangeConsumerStruct {
+  /** component type id to consume changes for, or NULL to consume changes for all types */
+  const char* componentTypeId;
+  /** generation up to which this consumer has already seen changes */
+  uint64_t generation;
+} ShovelerWorldChangeConsumer;
+
+typedef void(ShovelerWorldChangeCallbackFunction)(
+    ShovelerWorld* world, const ShovelerWorldChange* change, void* userData);
+
 ShovelerWorld* shovelerWorldCreate(
     ShovelerSchema* schema,
     ShovelerSystem* system,
     ShovelerWorldUpdateAuthoritativeComponentFunction* updateAuthoritativeComponent,
     void* updateAuthoritativeComponentUserData);
 ShovelerComponentWorldAdapter* shovelerWorldGetComponentAdapter(ShovelerWorld* world);
+/**
+ * Sets the pool that components with deferrable activations are activated on, or NULL to activate
+ * them synchronously. Only affects activations started after this call, so it should be set before
+ * adding components. The caller retains ownership of the pool.
+ */
+void shovelerWorldSetActivationPool(ShovelerWorld* world, ShovelerActivationPool* activationPool);
 ShovelerWorldEntity* shovelerWorldAddEntity(ShovelerWorld* world, long long int entityId);
 bool shovelerWorldRemoveEntity(ShovelerWorld* world, long long int entityId);
 ShovelerComponent* shovelerWorldEntityAddComponent(
@@ -86,6 +131,25 @@ const ShovelerWorldDependencyCallback* shovelerWorldAddDependencyCallback(
     ShovelerWorld* world, ShovelerWorldDependencyCallbackFunction* function, void* userData);
 bool shovelerWorldRemoveDependencyCallback(
     ShovelerWorld* world, const ShovelerWorldDependencyCallback* callback);
+/**
+ * Registers a consumer of the world change journal, which will see all changes recorded after this
+ * call. Changes are only recorded while at least one consumer is registered.
+ */
+ShovelerWorldChangeConsumer* shovelerWorldAddChangeConsumer(
+    ShovelerWorld* world, const char* componentTypeId);
+/**
+ * Calls the passed function once for every coalesced change the consumer hasn't seen yet, in the
+ * order the changes were first recorded. Note that changes can refer to components or entities that
+ * have since been removed. Changes recorded from within the callback are seen by the next call.
+ *
+ * Returns the number of changes passed to the callback.
+ */
+int shovelerWorldConsumeChanges(
+    ShovelerWorld* world,
+    ShovelerWorldChangeConsumer* consumer,
+    ShovelerWorldChangeCallbackFunction* function,
+    void* userData);
+bool shovelerWorldRemoveChangeConsumer(ShovelerWorld* world, ShovelerWorldChangeConsumer* consumer);
 void shovelerWorldFree(ShovelerWorld* world);
 
 static inline ShovelerWorldEntity* shovelerWorldGetEntity(
@@ -0,0 +1,134 @@
+#include "shoveler/activation_pool.h"
+
+#include <assert.h> // assert
+#include <stdlib.h> // malloc free
+
+#include "shoveler/component.h"
+#include "shoveler/component_type.h"
+#include "shoveler/log.h"
+
+static void finishTask(ShovelerActivationPool* pool, ShovelerActivationTask* task);
+static void discardTask(ShovelerActivationPool* pool, ShovelerActivationTask* task);
+
+ShovelerActivationPool* shovelerActivationPoolCreate(ShovelerActivationPoolAdapter* adapter) {
+  ShovelerActivationPool* pool = malloc(sizeof(ShovelerActivationPool));
+  pool->adapter = adapter;
+  pool->tasks = g_queue_new();
+  pool->numCommitted = 0;
+  pool->numDiscarded = 0;
+
+  return pool;
+}
+
+ShovelerActivationTask* shovelerActivationPoolSubmit(
+    ShovelerActivationPool* pool, ShovelerComponent* component, void* job) {
+  ShovelerActivationTask* task = malloc(sizeof(ShovelerActivationTask));
+  task->pool = pool;
+  task->component = component;
+  task->systemAdapter = component->systemAdapter;
+  task->job = job;
+
+  g_queue_push_tail(pool->tasks, task);
+  pool->adapter->submit(task, pool->adapter->userData);
+
+  return task;
+}
+
+int shovelerActivationPoolCommit(ShovelerActivationPool* pool, bool wait) {
+  int numActivated = 0;
+
+  while (!g_queue_is_empty(pool->tasks)) {
+    ShovelerActivationTask* task = g_queue_peek_head(pool->tasks);
+    if (!pool->adapter->isFinished(task, wait, pool->adapter->userData)) {
+      // keep the submission order, even if later tasks have finished already
+      break;
+    }
+    g_queue_pop_head(pool->tasks);
+
+    if (task->component == NULL) {
+      discardTask(pool, task);
+      continue;
+    }
+
+    assert(task->component->pendingActivation == task);
+    if (shovelerComponentCommitActivation(task->component, task->job)) {
+      numActivated++;
+    }
+    pool->numCommitted++;
+
+    finishTask(pool, task);
+  }
+
+  return numActivated;
+}
+
+int shovelerActivationPoolDiscardCancelled(ShovelerActivationPool* pool) {
+  int numDiscarded = 0;
+
+  GList* iter = g_queue_peek_head_link(pool->tasks);
+  while (iter != NULL) {
+    GList* next = iter->next;
+
+    ShovelerActivationTask* task = iter->data;
+    if (task->component == NULL) {
+      g_queue_delete_link(pool->tasks, iter);
+      pool->adapter->isFinished(task, /* wait */ true, pool->adapter->userData);
+      discardTask(pool, task);
+      numDiscarded++;
+    }
+
+    iter = next;
+  }
+
+  return numDiscarded;
+}
+
+int shovelerActivationPoolGetNumPending(ShovelerActivationPool* pool) {
+  return (int) g_queue_get_length(pool->tasks);
+}
+
+void shovelerActivationPoolFree(ShovelerActivationPool* pool) {
+  if (pool == NULL) {
+    return;
+  }
+
+  while (!g_queue_is_empty(pool->tasks)) {
+    ShovelerActivationTask* task = g_queue_pop_head(pool->tasks);
+    if (task->component != NULL) {
+      shovelerLogWarning(
+          "Discarding pending activation of component '%s' of entity %lld because its activation "
+          "pool is freed.",
+          task->component->type->id,
+          task->component->entityId);
+      task->component->pendingActivation = NULL;
+      task->component = NULL;
+    }
+
+    pool->adapter->isFinished(task, /* wait */ true, pool->adapter->userData);
+    discardTask(pool, task);
+  }
+
+  g_queue_free(pool->tasks);
+  free(pool);
+}
+
+void shovelerActivationTaskRun(ShovelerActivationTask* task) {
+  task->systemAdapter->runActivation(task->job, task->systemAdapter->userData);
+}
+
+void shovelerActivationTaskCancel(ShovelerActivationTask* task) { task->component = NULL; }
+
+static void finishTask(ShovelerActivationPool* pool, ShovelerActivationTask* task) {
+  if (pool->adapter->release != NULL) {
+    pool->adapter->release(task, pool->adapter->userData);
+  }
+
+  free(task);
+}
+
+static void discardTask(ShovelerActivationPool* pool, ShovelerActivationTask* task) {
+  task->systemAdapter->discardActivation(task->job, task->systemAdapter->userData);
+  pool->numDiscarded++;
+
+  finishTask(pool, task);
+}
@@ -0,0 +1,322 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include "shoveler/activation_pool.h"
+#include "shoveler/component.h"
+#include "shoveler/component_system.h"
+#include "shoveler/component_type.h"
+#include "shoveler/log.h"
+#include "shoveler/schema.h"
+#include "shoveler/system.h"
+#include "shoveler/world.h"
+#include "test_component_types.h"
+}
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+
+const long long int entityId1 = 1;
+const long long int entityId2 = 2;
+const long long int entityId3 = 3;
+
+/** Job of the fake CPU heavy systems, which "decode" a snapshot of the component's field. */
+struct FakeActivationJob {
+  long long int entityId;
+  std::string input;
+  std::string output;
+};
+
+static void updateAuthoritativeComponent(
+    ShovelerWorld* world,
+    ShovelerComponent* component,
+    int fieldId,
+    const ShovelerComponentField* field,
+    const ShovelerComponentFieldValue* value,
+    void* userData);
+
+// activation pool adapter methods
+static void submit(ShovelerActivationTask* task, void* userData);
+static bool isFinished(ShovelerActivationTask* task, bool wait, void* userData);
+static void release(ShovelerActivationTask* task, void* userData);
+
+// fake system methods
+static void* prepareActivation(ShovelerComponent* component, void* userData);
+static void runActivation(void* job, void* userData);
+static void* commitActivation(ShovelerComponent* component, void* job, void* userData);
+static void discardActivation(void* job, void* userData);
+static void deactivateComponent(ShovelerComponent* component, void* userData);
+
+class ShovelerActivationPoolTest : public ::testing::Test {
+public:
+  virtual void SetUp() {
+    schema = shovelerSchemaCreate();
+    ShovelerComponentType* componentType1 = shovelerCreateTestComponentType1();
+    ShovelerComponentType* componentType2 = shovelerCreateTestComponentType2();
+    shovelerSchemaAddComponentType(schema, componentType1);
+    shovelerSchemaAddComponentType(schema, componentType2);
+
+    system = shovelerSystemCreate();
+    ShovelerComponentSystem* componentSystem1 =
+        shovelerSystemForComponentType(system, componentType1);
+    ShovelerComponentSystem* componentSystem2 =
+        shovelerSystemForComponentType(system, componentType2);
+    for (ShovelerComponentSystem* componentSystem : {componentSystem1, componentSystem2}) {
+      componentSystem->prepareActivation = prepareActivation;
+      componentSystem->runActivation = runActivation;
+      componentSystem->commitActivation = commitActivation;
+      componentSystem->discardActivation = discardActivation;
+      componentSystem->deactivateComponent = deactivateComponent;
+      componentSystem->callbackUserData = this;
+    }
+
+    world = shovelerWorldCreate(schema, system, updateAuthoritativeComponent, this);
+
+    poolAdapter.submit = submit;
+    poolAdapter.isFinished = isFinished;
+    poolAdapter.release = release;
+    poolAdapter.userData = this;
+    pool = shovelerActivationPoolCreate(&poolAdapter);
+    shovelerWorldSetActivationPool(world, pool);
+  }
+
+  virtual void TearDown() {
+    shovelerLogTrace("Tearing down test case.");
+    if (world != NULL) {
+      shovelerWorldFree(world);
+    }
+    shovelerActivationPoolFree(pool);
+    if (system != NULL) {
+      shovelerSystemFree(system);
+    }
+    shovelerSchemaFree(schema);
+  }
+
+  ShovelerComponent* addComponent(long long int entityId, const char* componentTypeId) {
+    ShovelerWorldEntity* entity = shovelerWorldGetEntity(world, entityId);
+    if (entity == NULL) {
+      entity = shovelerWorldAddEntity(world, entityId);
+    }
+
+    return shovelerWorldEntityAddComponent(entity, componentTypeId);
+  }
+
+  void runSubmitted(int index) {
+    ShovelerActivationTask* task = submitted[index];
+    shovelerActivationTaskRun(task);
+    finished.insert(task);
+  }
+
+  ShovelerSchema* schema;
+  ShovelerSystem* system;
+  ShovelerWorld* world;
+  ShovelerActivationPoolAdapter poolAdapter;
+  ShovelerActivationPool* pool;
+
+  std::vector<ShovelerActivationTask*> submitted;
+  std::set<ShovelerActivationTask*> finished;
+  int numReleased = 0;
+
+  std::vector<long long int> runCalls;
+  std::vector<std::pair<long long int, std::string>> commitCalls;
+  std::vector<long long int> discardCalls;
+};
+
+TEST_F(ShovelerActivationPoolTest, commitInSubmissionOrder) {
+  std::vector<ShovelerComponent*> components;
+  for (long long int entityId : {entityId1, entityId2, entityId3}) {
+    ShovelerComponent* component = addComponent(entityId, componentType2Id);
+    ASSERT_FALSE(shovelerComponentActivate(component));
+    ASSERT_TRUE(shovelerComponentIsActivating(component));
+    components.push_back(component);
+  }
+  ASSERT_EQ(shovelerActivationPoolGetNumPending(pool), 3);
+
+  runSubmitted(2);
+  runSubmitted(1);
+  ASSERT_EQ(shovelerActivationPoolCommit(pool, /* wait */ false), 0)
+      << "the first submitted activation hasn't finished yet";
+  ASSERT_THAT(commitCalls, IsEmpty());
+
+  runSubmitted(0);
+  int numActivated = shovelerActivationPoolCommit(pool, /* wait */ false);
+
+  ASSERT_EQ(numActivated, 3);
+  ASSERT_THAT(runCalls, ElementsAre(entityId3, entityId2, entityId1));
+  ASSERT_THAT(
+      commitCalls,
+      ElementsAre(
+          Pair(entityId1, "decoded"), Pair(entityId2, "decoded"), Pair(entityId3, "decoded")));
+  for (ShovelerComponent* component : components) {
+    ASSERT_TRUE(shovelerComponentIsActive(component));
+    ASSERT_FALSE(shovelerComponentIsActivating(component));
+  }
+  ASSERT_EQ(shovelerActivationPoolGetNumPending(pool), 0);
+  ASSERT_EQ(numReleased, 3);
+}
+
+TEST_F(ShovelerActivationPoolTest, commitInDependencyOrder) {
+  ShovelerComponent* dependencyComponent = addComponent(entityId1, componentType2Id);
+  ShovelerComponent* component = addComponent(entityId2, componentType1Id);
+  shovelerComponentUpdateCanonicalFieldEntityId(
+      component, COMPONENT_TYPE_1_FIELD_DEPENDENCY_REACTIVATE, entityId1);
+
+  ASSERT_FALSE(shovelerComponentActivate(component));
+  ASSERT_FALSE(shovelerComponentIsActivating(component))
+      << "activation isn't deferred while dependencies are inactive";
+  ASSERT_FALSE(shovelerComponentActivate(dependencyComponent));
+  ASSERT_TRUE(shovelerComponentIsActivating(dependencyComponent));
+
+  int numActivated = shovelerActivationPoolCommit(pool, /* wait */ true);
+
+  ASSERT_EQ(numActivated, 2) << "reverse dependency activation is committed in the same call";
+  ASSERT_THAT(commitCalls, ElementsAre(Pair(entityId1, "decoded"), Pair(entityId2, "decoded")));
+  ASSERT_TRUE(shovelerComponentIsActive(dependencyComponent));
+  ASSERT_TRUE(shovelerComponentIsActive(component));
+}
+
+TEST_F(ShovelerActivationPoolTest, restartOnFieldUpdate) {
+  ShovelerComponent* component = addComponent(entityId1, componentType2Id);
+  shovelerComponentActivate(component);
+  ShovelerActivationTask* firstTask = component->pendingActivation;
+
+  shovelerComponentUpdateCanonicalFieldString(
+      component, COMPONENT_TYPE_2_FIELD_PRIMITIVE_LIVE_UPDATE, "updated");
+  ASSERT_TRUE(shovelerComponentIsActivating(component));
+  ASSERT_NE(component->pendingActivation, firstTask);
+
+  int numActivated = shovelerActivationPoolCommit(pool, /* wait */ true);
+
+  ASSERT_EQ(numActivated, 1);
+  ASSERT_THAT(discardCalls, ElementsAre(entityId1));
+  ASSERT_THAT(commitCalls, ElementsAre(Pair(entityId1, "decoded updated")));
+  ASSERT_EQ(pool->numDiscarded, 1);
+  ASSERT_EQ(pool->numCommitted, 1);
+}
+
+TEST_F(ShovelerActivationPoolTest, discardRemovedComponent) {
+  ShovelerComponent* component = addComponent(entityId1, componentType2Id);
+  shovelerComponentActivate(component);
+  runSubmitted(0);
+
+  shovelerWorldRemoveEntity(world, entityId1);
+  int numActivated = shovelerActivationPoolCommit(pool, /* wait */ false);
+
+  ASSERT_EQ(numActivated, 0);
+  ASSERT_THAT(commitCalls, IsEmpty());
+  ASSERT_THAT(discardCalls, ElementsAre(entityId1));
+  ASSERT_EQ(numReleased, 1);
+}
+
+TEST_F(ShovelerActivationPoolTest, freeSystemWithCancelledTaskQueued) {
+  ShovelerComponent* component = addComponent(entityId1, componentType2Id);
+  shovelerComponentActivate(component);
+  shovelerWorldRemoveEntity(world, entityId1);
+  ShovelerComponent* otherComponent = addComponent(entityId2, componentType2Id);
+  shovelerComponentActivate(otherComponent);
+  ASSERT_EQ(shovelerActivationPoolGetNumPending(pool), 2);
+
+  shovelerWorldFree(world);
+  world = NULL;
+  shovelerSystemFree(system);
+  system = NULL;
+
+  ASSERT_EQ(shovelerActivationPoolGetNumPending(pool), 0)
+      << "cancelled tasks are discarded before their system is freed";
+  ASSERT_THAT(discardCalls, ElementsAre(entityId1, entityId2));
+  ASSERT_THAT(commitCalls, IsEmpty());
+  ASSERT_EQ(numReleased, 2);
+}
+
+TEST_F(ShovelerActivationPoolTest, activateSynchronouslyWithoutPool) {
+  shovelerWorldSetActivationPool(world, NULL);
+  ShovelerComponent* component = addComponent(entityId1, componentType2Id);
+
+  ASSERT_TRUE(shovelerComponentActivate(component));
+
+  ASSERT_TRUE(shovelerComponentIsActive(component));
+  ASSERT_THAT(submitted, IsEmpty());
+  ASSERT_THAT(runCalls, ElementsAre(entityId1));
+  ASSERT_THAT(commitCalls, ElementsAre(Pair(entityId1, "decoded")));
+}
+
+static void updateAuthoritativeComponent(
+    ShovelerWorld* world,
+    ShovelerComponent* component,
+    int fieldId,
+    const ShovelerComponentField* field,
+    const ShovelerComponentFieldValue* value,
+    void* testPointer) {}
+
+static void submit(ShovelerActivationTask* task, void* testPointer) {
+  ShovelerActivationPoolTest* test = (ShovelerActivationPoolTest*) testPointer;
+  test->submitted.push_back(task);
+}
+
+static bool isFinished(ShovelerActivationTask* task, bool wait, void* testPointer) {
+  ShovelerActivationPoolTest* test = (ShovelerActivationPoolTest*) testPointer;
+  if (test->finished.count(task) > 0) {
+    return true;
+  }
+
+  if (!wait) {
+    return false;
+  }
+
+  // emulate blocking on a worker by running the task right away
+  shovelerActivationTaskRun(task);
+  test->finished.insert(task);
+  return true;
+}
+
+static void release(ShovelerActivationTask* task, void* testPointer) {
+  ShovelerActivationPoolTest* test = (ShovelerActivationPoolTest*) testPointer;
+  test->submitted.erase(std::find(test->submitted.begin(), test->submitted.end(), task));
+  test->finished.erase(task);
+  test->numReleased++;
+}
+
+static void* prepareActivation(ShovelerComponent* component, void* testPointer) {
+  FakeActivationJob* job = new FakeActivationJob{};
+  job->entityId = component->entityId;
+  if (component->type->id == componentType2Id) {
+    const ShovelerComponentFieldValue* value =
+        shovelerComponentGetFieldValue(component, COMPONENT_TYPE_2_FIELD_PRIMITIVE_LIVE_UPDATE);
+    if (value->stringValue != NULL) {
+      job->input = value->stringValue;
+    }
+  }
+  return job;
+}
+
+static void runActivation(void* jobPointer, void* testPointer) {
+  ShovelerActivationPoolTest* test = (ShovelerActivationPoolTest*) testPointer;
+  FakeActivationJob* job = (FakeActivationJob*) jobPointer;
+  job->output = job->input.empty() ? "decoded" : "decoded " + job->input;
+  test->runCalls.push_back(job->entityId);
+}
+
+static void* commitActivation(ShovelerComponent* component, void* jobPointer, void* testPointer) {
+  ShovelerActivationPoolTest* test = (ShovelerActivationPoolTest*) testPointer;
+  FakeActivationJob* job = (FakeActivationJob*) jobPointer;
+  test->commitCalls.emplace_back(job->entityId, job->output);
+  return job;
+}
+
+static void discardActivation(void* jobPointer, void* testPointer) {
+  ShovelerActivationPoolTest* test = (ShovelerActivationPoolTest*) testPointer;
+  FakeActivationJob* job = (FakeActivationJob*) jobPointer;
+  test->discardCalls.push_back(job->entityId);
+  delete job;
+}
+
+static void deactivateComponent(ShovelerComponent* component, void* testPointer) {
+  delete (FakeActivationJob*) component->systemData;
+}
@@ -4,6 +4,7 @@
 #include <stdlib.h> // malloc free
 #include <string.h> // strdup memcpy memset
 
+#include "shoveler/activation_pool.h"
 #include "shoveler/component_field.h"
 #include "shoveler/component_type.h"
 #include "shoveler/entity_component_id.h"
@@ -27,6 +28,8 @@ static void addDependency(
     ShovelerComponent* component, long long int targetEntityId, const char* targetComponentTypeId);
 static void removeDependency(
     ShovelerComponent* component, long long int targetEntityId, const char* targetComponentTypeId);
+static bool activateDeferred(ShovelerComponent* component);
+static bool finishActivation(ShovelerComponent* component);
 static bool checkDependenciesActive(ShovelerComponent* component);
 static long long int toDependencyTargetEntityId(
     ShovelerComponent* component, long long int entityIdValue);
@@ -47,6 +50,7 @@ ShovelerComponent* shovelerComponentCreate(
   component->dependencies =
       g_array_new(/* zeroTerminated */ false, /* clear */ true, sizeof(ShovelerEntityComponentId));
   component->systemData = NULL;
+  component->pendingActivation = NULL;
 
   if (component->type->numFields > 0) {
     component->fieldValues =
@@ -74,6 +78,11 @@ bool shovelerComponentActivate(ShovelerComponent* component) {
     return true;
   }
 
+  if (component->pendingActivation != NULL) {
+    // already waiting for the deferred activation to be committed
+    return false;
+  }
+
   bool requiresAuthority =
       component->systemAdapter->requiresAuthority(component, component->systemAdapter->userData);
   if (requiresAuthority && !component->isAuthoritative) {
@@ -84,25 +93,37 @@ bool shovelerComponentActivate(ShovelerComponent* component) {
     return false;
   }
 
+  if (component->systemAdapter->canDeferActivation(component, component->systemAdapter->userData)) {
+    return activateDeferred(component);
+  }
+
   component->systemData =
       component->systemAdapter->activateComponent(component, component->systemAdapter->userData);
-  if (component->systemData == NULL) {
-    return false;
-  }
 
-  shovelerLogTrace(
-      "Activated component '%s' of entity %lld.", component->type->id, component->entityId);
+  return finishActivation(component);
+}
 
-  component->worldAdapter->forEachReverseDependency(
-      component,
-      activateReverseDependency,
-      /* callbackUserData */ NULL,
-      component->worldAdapter->userData);
+bool shovelerComponentCommitActivation(ShovelerComponent* component, void* job) {
+  component->pendingActivation = NULL;
+  component->systemData = component->systemAdapter->commitActivation(
+      component, job, component->systemAdapter->userData);
 
-  return true;
+  return finishActivation(component);
 }
 
 void shovelerComponentDeactivate(ShovelerComponent* component) {
+  if (component->pendingActivation != NULL) {
+    // nothing depending on the component can be active yet, so only the job needs to be dropped
+    shovelerActivationTaskCancel(component->pendingActivation);
+    component->pendingActivation = NULL;
+
+    shovelerLogTrace(
+        "Cancelled deferred activation of component '%s' of entity %lld.",
+        component->type->id,
+        component->entityId);
+    return;
+  }
+
   if (component->systemData == NULL) {
     return;
   }
@@ -152,12 +173,14 @@ bool shovelerComponentUpdateField(
   }
 
   bool wasActive = component->systemData != NULL;
+  bool wasActivating = component->pendingActivation != NULL;
   bool canLiveUpdate = component->systemAdapter->canLiveUpdateField(
       component, fieldId, field, component->systemAdapter->userData);
   bool isDependencyUpdate = field->dependencyComponentTypeId != NULL;
 
-  if (wasActive && !canLiveUpdate) {
-    // cannot live update, so deactivate before updating
+  if ((wasActive && !canLiveUpdate) || wasActivating) {
+    // cannot live update, or a deferred activation was prepared from the previous value, so
+    // deactivate before updating
     shovelerComponentDeactivate(component);
   }
 
@@ -178,6 +201,11 @@ bool shovelerComponentUpdateField(
     wasActive = component->systemData != NULL;
   }
 
+  if (component->worldAdapter->onUpdateField != NULL) {
+    component->worldAdapter->onUpdateField(
+        component, fieldId, field, component->worldAdapter->userData);
+  }
+
   if (wasActive) {
     if (canLiveUpdate) {
       // live update value
@@ -196,6 +224,9 @@ bool shovelerComponentUpdateField(
       // cannot live update, so try reactivating again
       shovelerComponentActivate(component);
     }
+  } else if (wasActivating) {
+    // restart the deferred activation with the new value
+    shovelerComponentActivate(component);
   }
 
   return true;
@@ -225,6 +256,10 @@ bool shovelerComponentIsActive(ShovelerComponent* component) {
   return component->systemData != NULL;
 }
 
+bool shovelerComponentIsActivating(ShovelerComponent* component) {
+  return component->pendingActivation != NULL;
+}
+
 bool shovelerComponentUpdate(ShovelerComponent* component, double dt) {
   if (!shovelerComponentIsActive(component)) {
     return false;
@@ -254,7 +289,9 @@ bool shovelerComponentIsAuthoritative(ShovelerComponent* component) {
 void shovelerComponentUndelegate(ShovelerComponent* component) {
   bool requiresAuthority =
       component->systemAdapter->requiresAuthority(component, component->systemAdapter->userData);
-  if (shovelerComponentIsActive(component) && requiresAuthority) {
+  bool isActiveOrActivating =
+      shovelerComponentIsActive(component) || shovelerComponentIsActivating(component);
+  if (isActiveOrActivating && requiresAuthority) {
     shovelerComponentDeactivate(component);
   }
 
@@ -337,6 +374,13 @@ void shovelerComponentFree(ShovelerComponent* component) {
 
 static void updateReverseDependency(
     ShovelerComponent* sourceComponent, ShovelerComponent* targetComponent, void* unused) {
+  if (sourceComponent->pendingActivation != NULL) {
+    // the deferred activation might have been prepared from the target's previous state
+    shovelerComponentDeactivate(sourceComponent);
+    shovelerComponentActivate(sourceComponent);
+    return;
+  }
+
   if (sourceComponent->systemData == NULL) {
     // no need to update the reverse dependency if it isn't active
     return;
@@ -451,9 +495,9 @@ static void addFieldDependencies(
     }
   }
 
-  // If the component system is activate and one of the added dependencies' isn't, we need to
-  // deactivate it.
-  if (component->systemData != NULL) {
+  // If the component system is active or activating and one of the added dependencies' isn't, we
+  // need to deactivate it.
+  if (component->systemData != NULL || component->pendingActivation != NULL) {
     if (!checkDependenciesActive(component)) {
       shovelerComponentDeactivate(component);
     }
@@ -520,6 +564,47 @@ static void removeDependency(
   assert(dependencyRemoved);
 }
 
+static bool activateDeferred(ShovelerComponent* component) {
+  void* job =
+      component->systemAdapter->prepareActivation(component, component->systemAdapter->userData);
+  if (job == NULL) {
+    return false;
+  }
+
+  ShovelerActivationPool* activationPool = component->worldAdapter->activationPool;
+  if (activationPool == NULL) {
+    // no pool to defer to, so run the job right away
+    component->systemAdapter->runActivation(job, component->systemAdapter->userData);
+    return shovelerComponentCommitActivation(component, job);
+  }
+
+  component->pendingActivation = shovelerActivationPoolSubmit(activationPool, component, job);
+
+  shovelerLogTrace(
+      "Deferred activation of component '%s' of entity %lld.",
+      component->type->id,
+      component->entityId);
+
+  return false;
+}
+
+static bool finishActivation(ShovelerComponent* component) {
+  if (component->systemData == NULL) {
+    return false;
+  }
+
+  shovelerLogTrace(
+      "Activated component '%s' of entity %lld.", component->type->id, component->entityId);
+
+  component->worldAdapter->forEachReverseDependency(
+      component,
+      activateReverseDependency,
+      /* callbackUserData */ NULL,
+      component->worldAdapter->userData);
+
+  return true;
+}
+
 static bool checkDependenciesActive(ShovelerComponent* component) {
   for (int i = 0; i < component->dependencies->len; i++) {
     const ShovelerEntityComponentId* dependency =
@@ -32,6 +32,12 @@ static bool liveUpdateDependencyField(
 static void* activateComponent(ShovelerComponent* component, void* componentSystemPointer);
 static bool updateComponent(ShovelerComponent* component, double dt, void* componentSystemPointer);
 static void deactivateComponent(ShovelerComponent* component, void* componentSystemPointer);
+static bool canDeferActivation(ShovelerComponent* component, void* componentSystemPointer);
+static void* prepareActivation(ShovelerComponent* component, void* componentSystemPointer);
+static void runActivation(void* job, void* componentSystemPointer);
+static void* commitActivation(
+    ShovelerComponent* component, void* job, void* componentSystemPointer);
+static void discardActivation(void* job, void* componentSystemPointer);
 
 ShovelerComponentSystem* shovelerComponentSystemCreate(
     ShovelerSystem* system, ShovelerComponentType* componentType) {
@@ -45,6 +51,11 @@ ShovelerComponentSystem* shovelerComponentSystemCreate(
   componentSystem->componentAdapter->activateComponent = activateComponent;
   componentSystem->componentAdapter->updateComponent = updateComponent;
   componentSystem->componentAdapter->deactivateComponent = deactivateComponent;
+  componentSystem->componentAdapter->canDeferActivation = canDeferActivation;
+  componentSystem->componentAdapter->prepareActivation = prepareActivation;
+  componentSystem->componentAdapter->runActivation = runActivation;
+  componentSystem->componentAdapter->commitActivation = commitActivation;
+  componentSystem->componentAdapter->discardActivation = discardActivation;
   componentSystem->componentAdapter->userData = componentSystem;
   componentSystem->system = system;
   componentSystem->componentType = componentType;
@@ -58,6 +69,10 @@ ShovelerComponentSystem* shovelerComponentSystemCreate(
   componentSystem->activateComponent = NULL;
   componentSystem->updateComponent = NULL;
   componentSystem->deactivateComponent = NULL;
+  componentSystem->prepareActivation = NULL;
+  componentSystem->runActivation = NULL;
+  componentSystem->commitActivation = NULL;
+  componentSystem->discardActivation = NULL;
 
   return componentSystem;
 }
@@ -164,3 +179,40 @@ static void deactivateComponent(ShovelerComponent* component, void* componentSys
     componentSystem->system->numActiveComponents--;
   }
 }
+
+static bool canDeferActivation(ShovelerComponent* component, void* componentSystemPointer) {
+  ShovelerComponentSystem* componentSystem = componentSystemPointer;
+
+  return componentSystem->prepareActivation != NULL && componentSystem->runActivation != NULL &&
+      componentSystem->commitActivation != NULL && componentSystem->discardActivation != NULL;
+}
+
+static void* prepareActivation(ShovelerComponent* component, void* componentSystemPointer) {
+  ShovelerComponentSystem* componentSystem = componentSystemPointer;
+
+  return componentSystem->prepareActivation(component, componentSystem->callbackUserData);
+}
+
+static void runActivation(void* job, void* componentSystemPointer) {
+  ShovelerComponentSystem* componentSystem = componentSystemPointer;
+
+  componentSystem->runActivation(job, componentSystem->callbackUserData);
+}
+
+static void* commitActivation(
+    ShovelerComponent* component, void* job, void* componentSystemPointer) {
+  ShovelerComponentSystem* componentSystem = componentSystemPointer;
+
+  void* activation =
+      componentSystem->commitActivation(component, job, componentSystem->callbackUserData);
+  if (activation) {
+    componentSystem->system->numActiveComponents++;
+  }
+  return activation;
+}
+
+static void discardActivation(void* job, void* componentSystemPointer) {
+  ShovelerComponentSystem* componentSystem = componentSystemPointer;
+
+  componentSystem->discardActivation(job, componentSystem->callbackUserData);
+}
@@ -44,6 +44,8 @@ static void forEachReverseDependency(
     ShovelerComponentWorldAdapterForEachReverseDependencyCallbackFunction* callbackFunction,
     void* callbackUserData,
     void* adapterUserData);
+static void onUpdateField(
+    ShovelerComponent* component, int fieldId, const ShovelerComponentField* field, void* userData);
 
 // system adapter methods
 static bool requiresAuthority(ShovelerComponent* component, void* userData);
@@ -66,6 +68,7 @@ static bool liveUpdateDependencyField(
 static void* activateComponent(ShovelerComponent* component, void* userData);
 static bool updateComponent(ShovelerComponent* component, double dt, void* userData);
 static void deactivateComponent(ShovelerComponent* component, void* userData);
+static bool canDeferActivation(ShovelerComponent* component, void* userData);
 
 class ShovelerComponentTest : public ::testing::Test {
 public:
@@ -75,6 +78,8 @@ public:
     worldAdapter.addDependency = addDependency;
     worldAdapter.removeDependency = removeDependency;
     worldAdapter.forEachReverseDependency = forEachReverseDependency;
+    worldAdapter.onUpdateField = onUpdateField;
+    worldAdapter.activationPool = NULL;
     worldAdapter.userData = this;
 
     systemAdapter.requiresAuthority = requiresAuthority;
@@ -85,6 +90,11 @@ public:
     systemAdapter.activateComponent = activateComponent;
     systemAdapter.updateComponent = updateComponent;
     systemAdapter.deactivateComponent = deactivateComponent;
+    systemAdapter.canDeferActivation = canDeferActivation;
+    systemAdapter.prepareActivation = NULL;
+    systemAdapter.runActivation = NULL;
+    systemAdapter.commitActivation = NULL;
+    systemAdapter.discardActivation = NULL;
     systemAdapter.userData = this;
 
     componentType1 = shovelerCreateTestComponentType1();
@@ -128,6 +138,7 @@ public:
   std::vector<UpdateAuthoritativeComponentCall> updateAuthoritativeComponentCalls;
 
   std::map<std::pair<long long int, std::string>, std::set<ShovelerComponent*>> reverseDependencies;
+  std::vector<std::pair<ShovelerComponent*, int>> updatedFields;
 
   bool propagateNextLiveUpdate = false;
   struct LiveUpdateCall {
@@ -235,6 +246,20 @@ TEST_F(ShovelerComponentTest, updateConfiguration) {
 
   int secondValue = shovelerComponentGetFieldValueInt(component1, COMPONENT_TYPE_1_FIELD_PRIMITIVE);
   ASSERT_EQ(secondValue, newConfigurationValue);
+  ASSERT_THAT(
+      updatedFields,
+      ElementsAre(std::make_pair(component1, (int) COMPONENT_TYPE_1_FIELD_PRIMITIVE)));
+}
+
+TEST_F(ShovelerComponentTest, updateConfigurationWithoutUpdateFieldCallback) {
+  worldAdapter.onUpdateField = NULL;
+
+  bool updated =
+      shovelerComponentUpdateCanonicalFieldInt(component1, COMPONENT_TYPE_1_FIELD_PRIMITIVE, 27);
+  ASSERT_TRUE(updated);
+
+  ASSERT_EQ(shovelerComponentGetFieldValueInt(component1, COMPONENT_TYPE_1_FIELD_PRIMITIVE), 27);
+  ASSERT_THAT(updatedFields, IsEmpty());
 }
 
 TEST_F(ShovelerComponentTest, updateConfigurationWithReactivation) {
@@ -551,6 +576,15 @@ static void forEachReverseDependency(
   }
 }
 
+static void onUpdateField(
+    ShovelerComponent* component,
+    int fieldId,
+    const ShovelerComponentField* field,
+    void* testPointer) {
+  ShovelerComponentTest* test = (ShovelerComponentTest*) testPointer;
+  test->updatedFields.emplace_back(component, fieldId);
+}
+
 static bool requiresAuthority(ShovelerComponent* component, void* testPointer) {
   ShovelerComponentTest* test = (ShovelerComponentTest*) testPointer;
 
@@ -636,3 +670,5 @@ static void deactivateComponent(ShovelerComponent* component, void* testPointer)
   ShovelerComponentTest* test = (ShovelerComponentTest*) testPointer;
   test->deactivateCalls.emplace_back(component);
 }
+
+static bool canDeferActivation(ShovelerComponent* component, void* testPointer) { return false; }
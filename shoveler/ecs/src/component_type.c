@@ -4,13 +4,15 @@
 #include <stdlib.h> // malloc free
 
 #include "shoveler/component_field.h"
+#include "shoveler/component_type_id.h"
 
 ShovelerComponentType* shovelerComponentTypeCreate(
     const char* id, int numFields, const ShovelerComponentField* fields) {
   assert(numFields >= 0);
 
   ShovelerComponentType* componentType = malloc(sizeof(ShovelerComponentType));
-  componentType->id = id;
+  componentType->idHandle = shovelerComponentTypeIdIntern(id);
+  componentType->id = componentType->idHandle->id;
   componentType->numFields = numFields;
   componentType->fields = NULL;
 
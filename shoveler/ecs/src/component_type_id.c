@@ -0,0 +1,58 @@
+#include "shoveler/component_type_id.h"
+
+#include <assert.h> // assert
+#include <stdlib.h> // malloc
+
+static void ensureTables();
+
+/** map from canonical id pointer to (ShovelerComponentTypeIdHandle *) */
+static GHashTable* handlesByPointer = NULL;
+/** map from id string contents to (ShovelerComponentTypeIdHandle *) */
+static GHashTable* handlesByString = NULL;
+static int numInterned = 0;
+
+const ShovelerComponentTypeIdHandle* shovelerComponentTypeIdIntern(const char* componentTypeId) {
+  assert(componentTypeId != NULL);
+
+  const ShovelerComponentTypeIdHandle* existingHandle =
+      shovelerComponentTypeIdLookup(componentTypeId);
+  if (existingHandle != NULL) {
+    return existingHandle;
+  }
+
+  ensureTables();
+
+  ShovelerComponentTypeIdHandle* handle = malloc(sizeof(ShovelerComponentTypeIdHandle));
+  handle->id = componentTypeId;
+  handle->index = numInterned++;
+  g_hash_table_insert(handlesByPointer, (gpointer) handle->id, handle);
+  g_hash_table_insert(handlesByString, (gpointer) handle->id, handle);
+
+  return handle;
+}
+
+const ShovelerComponentTypeIdHandle* shovelerComponentTypeIdLookup(const char* componentTypeId) {
+  if (handlesByPointer == NULL || componentTypeId == NULL) {
+    return NULL;
+  }
+
+  const ShovelerComponentTypeIdHandle* handle =
+      g_hash_table_lookup(handlesByPointer, componentTypeId);
+  if (handle != NULL) {
+    return handle;
+  }
+
+  return g_hash_table_lookup(handlesByString, componentTypeId);
+}
+
+int shovelerComponentTypeIdGetNumInterned() { return numInterned; }
+
+static void ensureTables() {
+  if (handlesByPointer != NULL) {
+    return;
+  }
+
+  // handles are never freed since their canonical pointers may be held anywhere
+  handlesByPointer = g_hash_table_new(g_direct_hash, g_direct_equal);
+  handlesByString = g_hash_table_new(g_str_hash, g_str_equal);
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+extern "C" {
+#include "shoveler/component_type.h"
+#include "shoveler/component_type_id.h"
+#include "shoveler/schema.h"
+#include "test_component_types.h"
+}
+
+static const char* internedTypeId = "component_type_id_test_interned";
+static const char* unknownTypeId = "component_type_id_test_unknown";
+
+class ShovelerComponentTypeIdTest : public ::testing::Test {};
+
+TEST_F(ShovelerComponentTypeIdTest, internCanonicalizesEqualStrings) {
+  char internedTypeIdCopy[64];
+  strcpy(internedTypeIdCopy, internedTypeId);
+
+  const ShovelerComponentTypeIdHandle* handle = shovelerComponentTypeIdIntern(internedTypeId);
+  const ShovelerComponentTypeIdHandle* copyHandle =
+      shovelerComponentTypeIdIntern(internedTypeIdCopy);
+
+  ASSERT_EQ(handle, copyHandle);
+  ASSERT_EQ(handle->id, internedTypeId);
+  ASSERT_GE(handle->index, 0);
+  ASSERT_LT(handle->index, shovelerComponentTypeIdGetNumInterned());
+  ASSERT_EQ(shovelerComponentTypeIdLookup(internedTypeId), handle);
+  ASSERT_EQ(shovelerComponentTypeIdLookup(internedTypeIdCopy), handle);
+  ASSERT_EQ(shovelerComponentTypeIdLookup(unknownTypeId), nullptr);
+}
+
+TEST_F(ShovelerComponentTypeIdTest, schemaResolvesNonCanonicalIds) {
+  ShovelerSchema* schema = shovelerSchemaCreate();
+  ShovelerComponentType* componentType = shovelerCreateTestComponentType1();
+  ASSERT_TRUE(shovelerSchemaAddComponentType(schema, componentType));
+
+  char componentType1IdCopy[64];
+  strcpy(componentType1IdCopy, componentType1Id);
+
+  ASSERT_EQ(componentType->id, componentType->idHandle->id);
+  ASSERT_EQ(shovelerSchemaGetComponentType(schema, componentType1Id), componentType);
+  ASSERT_EQ(shovelerSchemaGetComponentType(schema, componentType1IdCopy), componentType);
+  ASSERT_EQ(shovelerSchemaGetComponentType(schema, componentType2Id), nullptr);
+  ASSERT_EQ(shovelerSchemaGetComponentType(schema, unknownTypeId), nullptr);
+
+  shovelerSchemaFree(schema);
+}
@@ -4,31 +4,43 @@
 #include <stdlib.h> // malloc, free
 
 #include "shoveler/component_type.h"
-
-static void freeComponentType(void* componentTypePointer);
+#include "shoveler/component_type_id.h"
 
 ShovelerSchema* shovelerSchemaCreate() {
   ShovelerSchema* schema = malloc(sizeof(ShovelerSchema));
-  schema->componentTypes = g_hash_table_new_full(
-      g_str_hash, g_str_equal, /* key_destroy_func */ NULL, freeComponentType);
+  schema->componentTypes =
+      g_array_new(/* zeroTerminated */ false, /* clear */ true, sizeof(ShovelerComponentType*));
   return schema;
 }
 
 bool shovelerSchemaAddComponentType(ShovelerSchema* schema, ShovelerComponentType* componentType) {
-  return g_hash_table_insert(schema->componentTypes, (gpointer) componentType->id, componentType);
+  int index = componentType->idHandle->index;
+  if (index >= schema->componentTypes->len) {
+    g_array_set_size(schema->componentTypes, index + 1);
+  }
+
+  ShovelerComponentType** slot =
+      &g_array_index(schema->componentTypes, ShovelerComponentType*, index);
+  bool inserted = *slot == NULL;
+  shovelerComponentTypeFree(*slot);
+  *slot = componentType;
+  return inserted;
 }
 
 ShovelerComponentType* shovelerSchemaGetComponentType(
     ShovelerSchema* schema, const char* componentTypeId) {
-  return g_hash_table_lookup(schema->componentTypes, componentTypeId);
+  const ShovelerComponentTypeIdHandle* idHandle = shovelerComponentTypeIdLookup(componentTypeId);
+  if (idHandle == NULL || idHandle->index >= schema->componentTypes->len) {
+    return NULL;
+  }
+
+  return g_array_index(schema->componentTypes, ShovelerComponentType*, idHandle->index);
 }
 
 void shovelerSchemaFree(ShovelerSchema* schema) {
-  g_hash_table_destroy(schema->componentTypes);
+  for (guint i = 0; i < schema->componentTypes->len; i++) {
+    shovelerComponentTypeFree(g_array_index(schema->componentTypes, ShovelerComponentType*, i));
+  }
+  g_array_free(schema->componentTypes, /* freeSegment */ true);
   free(schema);
 }
-
-static void freeComponentType(void* componentTypePointer) {
-  ShovelerComponentType* componentType = componentTypePointer;
-  shovelerComponentTypeFree(componentType);
-}
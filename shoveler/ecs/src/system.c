@@ -5,13 +5,12 @@
 
 #include "shoveler/component_system.h"
 #include "shoveler/component_type.h"
-
-static void freeComponentSystem(void* shovelerComponentSystemPointer);
+#include "shoveler/component_type_id.h"
 
 ShovelerSystem* shovelerSystemCreate() {
   ShovelerSystem* system = malloc(sizeof(ShovelerSystem));
-  system->componentSystems = g_hash_table_new_full(
-      g_str_hash, g_str_equal, /* key_destroy_func */ NULL, freeComponentSystem);
+  system->componentSystems =
+      g_array_new(/* zeroTerminated */ false, /* clear */ true, sizeof(ShovelerComponentSystem*));
   system->numActiveComponents = 0;
 
   return system;
@@ -19,24 +18,28 @@ ShovelerSystem* shovelerSystemCreate() {
 
 ShovelerComponentSystem* shovelerSystemForComponentType(
     ShovelerSystem* system, ShovelerComponentType* componentType) {
-  ShovelerComponentSystem* componentSystem =
-      g_hash_table_lookup(system->componentSystems, componentType->id);
-  if (componentSystem == NULL) {
-    componentSystem = shovelerComponentSystemCreate(system, componentType);
-    bool inserted = g_hash_table_insert(
-        system->componentSystems, (gpointer) componentType->id, componentSystem);
-    assert(inserted);
+  int index = componentType->idHandle->index;
+  if (index >= system->componentSystems->len) {
+    g_array_set_size(system->componentSystems, index + 1);
+  }
+
+  ShovelerComponentSystem** slot =
+      &g_array_index(system->componentSystems, ShovelerComponentSystem*, index);
+  if (*slot == NULL) {
+    *slot = shovelerComponentSystemCreate(system, componentType);
   }
 
-  return componentSystem;
+  return *slot;
 }
 
 void shovelerSystemFree(ShovelerSystem* system) {
-  g_hash_table_destroy(system->componentSystems);
+  for (guint i = 0; i < system->componentSystems->len; i++) {
+    ShovelerComponentSystem* componentSystem =
+        g_array_index(system->componentSystems, ShovelerComponentSystem*, i);
+    if (componentSystem != NULL) {
+      shovelerComponentSystemFree(componentSystem);
+    }
+  }
+  g_array_free(system->componentSystems, /* freeSegment */ true);
   free(system);
 }
-
-static void freeComponentSystem(void* shovelerComponentSystemPointer) {
-  ShovelerComponentSystem* componentSystem = shovelerComponentSystemPointer;
-  shovelerComponentSystemFree(componentSystem);
-}
@@ -0,0 +1,5 @@
+#include "test_component_types.h"
+
+const char* const componentType1Id = "component_type_1";
+const char* const componentType2Id = "component_type_2";
+const char* const componentType3Id = "component_type_3";
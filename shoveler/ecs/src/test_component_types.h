@@ -1,11 +1,13 @@
 #ifndef SHOVELER_TEST_COMPONENT_TYPES_H
 #define SHOVELER_TEST_COMPONENT_TYPES_H
 
+#include "shoveler/component_field.h"
 #include "shoveler/component_type.h"
 
-static const char* componentType1Id = "component_type_1";
-static const char* componentType2Id = "component_type_2";
-static const char* componentType3Id = "component_type_3";
+// defined once in test_component_types.c since component type ids are interned by pointer
+extern const char* const componentType1Id;
+extern const char* const componentType2Id;
+extern const char* const componentType3Id;
 
 static const char* componentType1FieldPrimitive = "primitive";
 static const char* componentType1FieldDependencyLiveUpdate = "dependency_live_update";
@@ -3,14 +3,27 @@
 #include <glib.h>
 #include <stdlib.h> // malloc free
 
+#include "shoveler/activation_pool.h"
 #include "shoveler/component.h"
 #include "shoveler/component_system.h"
 #include "shoveler/component_type.h"
 #include "shoveler/entity_component_id.h"
+#include "shoveler/hash.h"
 #include "shoveler/log.h"
 #include "shoveler/schema.h"
 #include "shoveler/system.h"
 
+typedef struct {
+  ShovelerComponent* sourceComponent;
+  ShovelerEntityComponentId target;
+  /** number of dependencies from the source component to the target */
+  int count;
+  /** array of source (ShovelerComponent *) for the target, shared by all its edges */
+  GArray* sourceComponents;
+  /** index of the source component in the sourceComponents array */
+  int index;
+} ReverseDependencyEdge;
+
 static ShovelerComponent* getComponent(
     ShovelerComponent* component,
     long long int entityId,
@@ -37,8 +50,25 @@ static void forEachReverseDependency(
     ShovelerComponentWorldAdapterForEachReverseDependencyCallbackFunction* callbackFunction,
     void* callbackUserData,
     void* adapterUserData);
+static void onUpdateField(
+    ShovelerComponent* component, int fieldId, const ShovelerComponentField* field, void* userData);
 static bool removeDependencyListEntry(
     GArray* dependencyList, const ShovelerEntityComponentId* entry);
+static void addReverseDependency(
+    ShovelerWorld* world,
+    ShovelerComponent* sourceComponent,
+    const ShovelerEntityComponentId* target);
+static bool removeReverseDependency(
+    ShovelerWorld* world,
+    ShovelerComponent* sourceComponent,
+    const ShovelerEntityComponentId* target);
+static guint reverseDependencyEdgeHash(gconstpointer edgePointer);
+static gboolean reverseDependencyEdgeEqual(gconstpointer aPointer, gconstpointer bPointer);
+static void recordChange(
+    ShovelerWorld* world, long long int entityId, const char* componentTypeId, int fieldId);
+static void trimChanges(ShovelerWorld* world);
+static guint changeHash(gconstpointer changePointer);
+static gboolean changeEqual(gconstpointer aPointer, gconstpointer bPointer);
 static void freeEntity(void* entityPointer);
 static void freeComponent(void* componentPointer);
 static void freeDependencyArray(void* dependencyArrayPointer);
@@ -54,6 +84,8 @@ ShovelerWorld* shovelerWorldCreate(
       shovelerEntityComponentIdHash, shovelerEntityComponentIdEqual, free, freeDependencyArray);
   world->reverseDependencies = g_hash_table_new_full(
       shovelerEntityComponentIdHash, shovelerEntityComponentIdEqual, free, freeDependencyArray);
+  world->reverseDependencyEdges = g_hash_table_new_full(
+      reverseDependencyEdgeHash, reverseDependencyEdgeEqual, free, NULL);
   world->dependencyCallbacks = g_array_new(
       /* zeroTerminated */ false, /* clear */ true, sizeof(ShovelerWorldDependencyCallback));
   world->schema = schema;
@@ -66,7 +98,15 @@ ShovelerWorld* shovelerWorldCreate(
   world->componentWorldAdapter->addDependency = addDependency;
   world->componentWorldAdapter->removeDependency = removeDependency;
   world->componentWorldAdapter->forEachReverseDependency = forEachReverseDependency;
+  world->componentWorldAdapter->onUpdateField = onUpdateField;
+  world->componentWorldAdapter->activationPool = NULL;
   world->componentWorldAdapter->userData = world;
+  world->changeGeneration = 0;
+  world->changes = g_array_new(
+      /* zeroTerminated */ false, /* clear */ true, sizeof(ShovelerWorldChange*));
+  world->changeIndex = g_hash_table_new_full(changeHash, changeEqual, free, NULL);
+  world->changeConsumers = g_array_new(
+      /* zeroTerminated */ false, /* clear */ true, sizeof(ShovelerWorldChangeConsumer*));
   world->numComponentDependencies = 0;
   world->numComponents = 0;
 
@@ -77,6 +117,10 @@ ShovelerComponentWorldAdapter* shovelerWorldGetComponentAdapter(ShovelerWorld* w
   return world->componentWorldAdapter;
 }
 
+void shovelerWorldSetActivationPool(ShovelerWorld* world, ShovelerActivationPool* activationPool) {
+  world->componentWorldAdapter->activationPool = activationPool;
+}
+
 ShovelerWorldEntity* shovelerWorldAddEntity(ShovelerWorld* world, long long int entityId) {
   ShovelerWorldEntity* entity = malloc(sizeof(ShovelerWorldEntity));
   entity->world = world;
@@ -157,6 +201,7 @@ ShovelerComponent* shovelerWorldEntityAddComponent(
   }
 
   world->numComponents++;
+  recordChange(world, entity->id, component->type->id, SHOVELER_WORLD_CHANGE_COMPONENT_FIELD_ID);
   shovelerLogTrace("Added component '%s' to entity %lld.", componentTypeId, entity->id);
   return component;
 }
@@ -172,6 +217,7 @@ bool shovelerWorldEntityRemoveComponent(ShovelerWorldEntity* entity, const char*
   world->numComponents--;
   shovelerLogTrace("Removed component '%s' from entity %lld.", componentTypeId, entity->id);
 
+  recordChange(world, entity->id, component->type->id, SHOVELER_WORLD_CHANGE_COMPONENT_FIELD_ID);
   g_hash_table_remove(entity->components, componentTypeId);
 
   return true;
@@ -228,11 +274,78 @@ bool shovelerWorldRemoveDependencyCallback(
   return true;
 }
 
+ShovelerWorldChangeConsumer* shovelerWorldAddChangeConsumer(
+    ShovelerWorld* world, const char* componentTypeId) {
+  ShovelerWorldChangeConsumer* consumer = malloc(sizeof(ShovelerWorldChangeConsumer));
+  consumer->componentTypeId = componentTypeId;
+  consumer->generation = world->changeGeneration;
+
+  g_array_append_val(world->changeConsumers, consumer);
+  return consumer;
+}
+
+int shovelerWorldConsumeChanges(
+    ShovelerWorld* world,
+    ShovelerWorldChangeConsumer* consumer,
+    ShovelerWorldChangeCallbackFunction* function,
+    void* userData) {
+  uint64_t previousGeneration = consumer->generation;
+  uint64_t currentGeneration = world->changeGeneration;
+  consumer->generation = currentGeneration;
+
+  // the callback might record further changes, so don't cache the length
+  int numConsumed = 0;
+  for (int i = 0; i < world->changes->len; i++) {
+    const ShovelerWorldChange* change = g_array_index(world->changes, ShovelerWorldChange*, i);
+    if (change->generation <= previousGeneration || change->generation > currentGeneration) {
+      continue;
+    }
+
+    if (consumer->componentTypeId != NULL &&
+        change->componentTypeId != consumer->componentTypeId) {
+      continue;
+    }
+
+    function(world, change, userData);
+    numConsumed++;
+  }
+
+  trimChanges(world);
+
+  return numConsumed;
+}
+
+bool shovelerWorldRemoveChangeConsumer(
+    ShovelerWorld* world, ShovelerWorldChangeConsumer* consumer) {
+  for (int i = 0; i < world->changeConsumers->len; i++) {
+    if (g_array_index(world->changeConsumers, ShovelerWorldChangeConsumer*, i) == consumer) {
+      g_array_remove_index_fast(world->changeConsumers, i);
+      free(consumer);
+      trimChanges(world);
+      return true;
+    }
+  }
+
+  return false;
+}
+
 void shovelerWorldFree(ShovelerWorld* world) {
   g_hash_table_destroy(world->entities);
+  if (world->componentWorldAdapter->activationPool != NULL) {
+    // the components' pending activations were cancelled above, so discard them while their systems
+    // are still alive
+    shovelerActivationPoolDiscardCancelled(world->componentWorldAdapter->activationPool);
+  }
+  g_hash_table_destroy(world->reverseDependencyEdges);
   g_hash_table_destroy(world->reverseDependencies);
   g_hash_table_destroy(world->dependencies);
   g_array_free(world->dependencyCallbacks, /* freeSegment */ true);
+  g_hash_table_destroy(world->changeIndex);
+  g_array_free(world->changes, /* freeSegment */ true);
+  for (int i = 0; i < world->changeConsumers->len; i++) {
+    free(g_array_index(world->changeConsumers, ShovelerWorldChangeConsumer*, i));
+  }
+  g_array_free(world->changeConsumers, /* freeSegment */ true);
   free(world->componentWorldAdapter);
   free(world);
 }
@@ -284,17 +397,8 @@ static void addDependency(
     g_hash_table_insert(world->dependencies, dependenciesKey, dependencies);
   }
 
-  GArray* reverseDependencies = g_hash_table_lookup(world->reverseDependencies, &dependencyTarget);
-  if (reverseDependencies == NULL) {
-    ShovelerEntityComponentId* reverseDependenciesKey =
-        shovelerEntityComponentIdCopy(&dependencyTarget);
-    reverseDependencies = g_array_new(
-        /* zeroTerminated */ false, /* clear */ true, sizeof(ShovelerEntityComponentId));
-    g_hash_table_insert(world->reverseDependencies, reverseDependenciesKey, reverseDependencies);
-  }
-
   g_array_append_val(dependencies, dependencyTarget);
-  g_array_append_val(reverseDependencies, dependencySource);
+  addReverseDependency(world, component, &dependencyTarget);
 
   for (int i = 0; i < world->dependencyCallbacks->len; i++) {
     ShovelerWorldDependencyCallback* callback =
@@ -331,14 +435,11 @@ static bool removeDependency(
     return false;
   }
 
-  GArray* reverseDependencies = g_hash_table_lookup(world->reverseDependencies, &dependencyTarget);
-  assert(reverseDependencies != NULL);
-
   if (!removeDependencyListEntry(dependencies, &dependencyTarget)) {
     return false;
   }
 
-  bool reverseDependencyRemoved = removeDependencyListEntry(reverseDependencies, &dependencySource);
+  bool reverseDependencyRemoved = removeReverseDependency(world, component, &dependencyTarget);
   assert(reverseDependencyRemoved);
 
   for (int i = 0; i < world->dependencyCallbacks->len; i++) {
@@ -370,25 +471,25 @@ static void forEachReverseDependency(
   ShovelerEntityComponentId dependencyTarget =
       shovelerEntityComponentId(targetComponent->entityId, targetComponent->type->id);
 
-  GArray* reverseDependencies = g_hash_table_lookup(world->reverseDependencies, &dependencyTarget);
-  if (reverseDependencies != NULL) {
-    for (int i = 0; i < reverseDependencies->len; i++) {
-      const ShovelerEntityComponentId* dependencySource =
-          &g_array_index(reverseDependencies, ShovelerEntityComponentId, i);
-
-      ShovelerWorldEntity* sourceEntity =
-          g_hash_table_lookup(world->entities, &dependencySource->entityId);
-      if (sourceEntity != NULL) {
-        ShovelerComponent* sourceComponent =
-            g_hash_table_lookup(sourceEntity->components, dependencySource->componentTypeId);
-        if (sourceComponent != NULL) {
-          callbackFunction(sourceComponent, targetComponent, callbackUserData);
-        }
-      }
+  GArray* sourceComponents = g_hash_table_lookup(world->reverseDependencies, &dependencyTarget);
+  if (sourceComponents != NULL) {
+    for (int i = 0; i < sourceComponents->len; i++) {
+      ShovelerComponent* sourceComponent = g_array_index(sourceComponents, ShovelerComponent*, i);
+      callbackFunction(sourceComponent, targetComponent, callbackUserData);
     }
   }
 }
 
+static void onUpdateField(
+    ShovelerComponent* component,
+    int fieldId,
+    const ShovelerComponentField* field,
+    void* worldPointer) {
+  ShovelerWorld* world = (ShovelerWorld*) worldPointer;
+
+  recordChange(world, component->entityId, component->type->id, fieldId);
+}
+
 static bool removeDependencyListEntry(
     GArray* dependencyList, const ShovelerEntityComponentId* entry) {
   for (int i = 0; i < dependencyList->len; i++) {
@@ -402,6 +503,161 @@ static bool removeDependencyListEntry(
   return false;
 }
 
+static void addReverseDependency(
+    ShovelerWorld* world,
+    ShovelerComponent* sourceComponent,
+    const ShovelerEntityComponentId* target) {
+  ReverseDependencyEdge lookupEdge;
+  lookupEdge.sourceComponent = sourceComponent;
+  lookupEdge.target = *target;
+
+  ReverseDependencyEdge* edge = g_hash_table_lookup(world->reverseDependencyEdges, &lookupEdge);
+  if (edge != NULL) {
+    // the source already depends on this target through another field
+    edge->count++;
+    return;
+  }
+
+  GArray* sourceComponents = g_hash_table_lookup(world->reverseDependencies, target);
+  if (sourceComponents == NULL) {
+    ShovelerEntityComponentId* sourceComponentsKey = shovelerEntityComponentIdCopy(target);
+    sourceComponents =
+        g_array_new(/* zeroTerminated */ false, /* clear */ true, sizeof(ShovelerComponent*));
+    g_hash_table_insert(world->reverseDependencies, sourceComponentsKey, sourceComponents);
+  }
+
+  edge = malloc(sizeof(ReverseDependencyEdge));
+  *edge = lookupEdge;
+  edge->count = 1;
+  edge->sourceComponents = sourceComponents;
+  edge->index = sourceComponents->len;
+  g_array_append_val(sourceComponents, sourceComponent);
+  g_hash_table_add(world->reverseDependencyEdges, edge);
+}
+
+static bool removeReverseDependency(
+    ShovelerWorld* world,
+    ShovelerComponent* sourceComponent,
+    const ShovelerEntityComponentId* target) {
+  ReverseDependencyEdge lookupEdge;
+  lookupEdge.sourceComponent = sourceComponent;
+  lookupEdge.target = *target;
+
+  ReverseDependencyEdge* edge = g_hash_table_lookup(world->reverseDependencyEdges, &lookupEdge);
+  if (edge == NULL) {
+    return false;
+  }
+
+  edge->count--;
+  if (edge->count > 0) {
+    return true;
+  }
+
+  // move the last source into the removed slot and fix up its edge index
+  GArray* sourceComponents = edge->sourceComponents;
+  int lastIndex = sourceComponents->len - 1;
+  if (edge->index != lastIndex) {
+    lookupEdge.sourceComponent = g_array_index(sourceComponents, ShovelerComponent*, lastIndex);
+    ReverseDependencyEdge* movedEdge =
+        g_hash_table_lookup(world->reverseDependencyEdges, &lookupEdge);
+    assert(movedEdge != NULL);
+
+    movedEdge->index = edge->index;
+    g_array_index(sourceComponents, ShovelerComponent*, edge->index) = movedEdge->sourceComponent;
+  }
+  g_array_set_size(sourceComponents, lastIndex);
+
+  // the edge set owns the edge, so this also frees it
+  g_hash_table_remove(world->reverseDependencyEdges, edge);
+
+  return true;
+}
+
+static guint reverseDependencyEdgeHash(gconstpointer edgePointer) {
+  const ReverseDependencyEdge* edge = (const ReverseDependencyEdge*) edgePointer;
+
+  guint hash = g_direct_hash(edge->sourceComponent);
+  hash = shovelerHashCombine(hash, g_int64_hash(&edge->target.entityId));
+  hash = shovelerHashCombine(hash, g_direct_hash(edge->target.componentTypeId));
+  return hash;
+}
+
+static gboolean reverseDependencyEdgeEqual(gconstpointer aPointer, gconstpointer bPointer) {
+  const ReverseDependencyEdge* a = (const ReverseDependencyEdge*) aPointer;
+  const ReverseDependencyEdge* b = (const ReverseDependencyEdge*) bPointer;
+
+  return a->sourceComponent == b->sourceComponent &&
+      shovelerEntityComponentIdEqual(&a->target, &b->target);
+}
+
+static void recordChange(
+    ShovelerWorld* world, long long int entityId, const char* componentTypeId, int fieldId) {
+  if (world->changeConsumers->len == 0) {
+    // nobody is listening, so don't bother recording anything
+    return;
+  }
+
+  world->changeGeneration++;
+
+  ShovelerWorldChange lookupChange;
+  lookupChange.entityId = entityId;
+  lookupChange.componentTypeId = componentTypeId;
+  lookupChange.fieldId = fieldId;
+
+  ShovelerWorldChange* change = g_hash_table_lookup(world->changeIndex, &lookupChange);
+  if (change == NULL) {
+    change = malloc(sizeof(ShovelerWorldChange));
+    *change = lookupChange;
+    g_array_append_val(world->changes, change);
+    g_hash_table_add(world->changeIndex, change);
+  }
+
+  change->generation = world->changeGeneration;
+}
+
+static void trimChanges(ShovelerWorld* world) {
+  // changes at or below the generation every consumer has already seen can be dropped
+  uint64_t minGeneration = world->changeGeneration;
+  for (int i = 0; i < world->changeConsumers->len; i++) {
+    const ShovelerWorldChangeConsumer* consumer =
+        g_array_index(world->changeConsumers, ShovelerWorldChangeConsumer*, i);
+    if (consumer->generation < minGeneration) {
+      minGeneration = consumer->generation;
+    }
+  }
+
+  int numKept = 0;
+  for (int i = 0; i < world->changes->len; i++) {
+    ShovelerWorldChange* change = g_array_index(world->changes, ShovelerWorldChange*, i);
+    if (change->generation <= minGeneration) {
+      // the index owns the change, so this also frees it
+      g_hash_table_remove(world->changeIndex, change);
+      continue;
+    }
+
+    g_array_index(world->changes, ShovelerWorldChange*, numKept) = change;
+    numKept++;
+  }
+  g_array_set_size(world->changes, numKept);
+}
+
+static guint changeHash(gconstpointer changePointer) {
+  const ShovelerWorldChange* change = (const ShovelerWorldChange*) changePointer;
+
+  guint hash = g_int64_hash(&change->entityId);
+  hash = shovelerHashCombine(hash, g_direct_hash(change->componentTypeId));
+  hash = shovelerHashCombine(hash, g_int_hash(&change->fieldId));
+  return hash;
+}
+
+static gboolean changeEqual(gconstpointer aPointer, gconstpointer bPointer) {
+  const ShovelerWorldChange* a = (const ShovelerWorldChange*) aPointer;
+  const ShovelerWorldChange* b = (const ShovelerWorldChange*) bPointer;
+
+  return a->entityId == b->entityId && a->componentTypeId == b->componentTypeId &&
+      a->fieldId == b->fieldId;
+}
+
 static void freeEntity(void* entityPointer) {
   ShovelerWorldEntity* entity = entityPointer;
 
@@ -0,0 +1,533 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "shoveler/component.h"
+#include "shoveler/component_field.h"
+#include "shoveler/component_system.h"
+#include "shoveler/component_type.h"
+#include "shoveler/component_type_id.h"
+#include "shoveler/log.h"
+#include "shoveler/schema.h"
+#include "shoveler/system.h"
+#include "shoveler/world.h"
+#include "test_component_types.h"
+}
+
+/**
+ * Microbenchmark suite for the ECS core.
+ *
+ * Every measurement is written to stdout as a single line JSON object, so that the output of
+ * repeated runs can be collected and compared over time. Log messages go to stderr.
+ *
+ * Usage: shoveler_ecs_benchmark [--entities=1000,10000] [--chain-depth=4] [--fields=4]
+ *                               [--filter=<benchmark name substring>]
+ *
+ * The schema shape is a chain of component types: every entity has one component of each type,
+ * each one depending on the previous type's component of the same entity. Every type has the given
+ * number of int fields in addition to its dependency field.
+ */
+
+struct BenchmarkOptions {
+  std::vector<int> numEntities;
+  int chainDepth;
+  int numFields;
+  std::string filter;
+};
+
+struct BenchmarkWorld {
+  ShovelerSchema* schema;
+  ShovelerSystem* system;
+  ShovelerWorld* world;
+  std::vector<ShovelerComponentType*> chainComponentTypes;
+};
+
+static const long long int firstEntityId = 1;
+static const long long int tilesetEntityId = 1;
+static const long long int firstChunkEntityId = 2;
+static const int numTilesetUpdates = 100;
+static const int numResolutionTypes = 32;
+static const int numResolutions = 10000000;
+
+static bool parseOptions(int argc, char** argv, BenchmarkOptions* options);
+static bool shouldRun(const BenchmarkOptions& options, const char* benchmark);
+static const char* getLeakedName(std::vector<const char*>& names, const char* format, int index);
+static BenchmarkWorld createBenchmarkWorld(const BenchmarkOptions& options, bool liveUpdate);
+static void addChainEntity(BenchmarkWorld& benchmarkWorld, long long int entityId);
+static void freeBenchmarkWorld(BenchmarkWorld& benchmarkWorld);
+static void updateAuthoritativeComponent(
+    ShovelerWorld* world,
+    ShovelerComponent* component,
+    int fieldId,
+    const ShovelerComponentField* field,
+    const ShovelerComponentFieldValue* value,
+    void* userData);
+static double elapsedMs(gint64 startTime);
+static void report(
+    const BenchmarkOptions& options,
+    const char* benchmark,
+    const char* metric,
+    int numEntities,
+    long long int numOperations,
+    double totalMs);
+
+/** Adds entities with a single root component and removes them again. */
+static void benchmarkEntityAddRemove(const BenchmarkOptions& options, int numEntities) {
+  BenchmarkWorld benchmarkWorld = createBenchmarkWorld(options, /* liveUpdate */ false);
+  const char* rootComponentTypeId = benchmarkWorld.chainComponentTypes[0]->id;
+
+  gint64 addStartTime = g_get_monotonic_time();
+  for (int i = 0; i < numEntities; i++) {
+    ShovelerWorldEntity* entity = shovelerWorldAddEntity(benchmarkWorld.world, firstEntityId + i);
+    ShovelerComponent* component = shovelerWorldEntityAddComponent(entity, rootComponentTypeId);
+    shovelerComponentActivate(component);
+  }
+  report(options, "entity_add_remove", "add", numEntities, numEntities, elapsedMs(addStartTime));
+
+  gint64 removeStartTime = g_get_monotonic_time();
+  for (int i = 0; i < numEntities; i++) {
+    shovelerWorldRemoveEntity(benchmarkWorld.world, firstEntityId + i);
+  }
+  report(
+      options, "entity_add_remove", "remove", numEntities, numEntities, elapsedMs(removeStartTime));
+
+  freeBenchmarkWorld(benchmarkWorld);
+}
+
+/**
+ * Adds the dependency chain of every entity from the deepest component up, so that adding the root
+ * component last activates the whole chain, then removes the root again to deactivate it.
+ */
+static void benchmarkDependencyChain(const BenchmarkOptions& options, int numEntities) {
+  BenchmarkWorld benchmarkWorld = createBenchmarkWorld(options, /* liveUpdate */ false);
+  long long int numComponents = (long long int) numEntities * options.chainDepth;
+
+  gint64 addStartTime = g_get_monotonic_time();
+  for (int i = 0; i < numEntities; i++) {
+    addChainEntity(benchmarkWorld, firstEntityId + i);
+  }
+  report(options, "dependency_chain", "add", numEntities, numComponents, elapsedMs(addStartTime));
+
+  long long int numActiveComponents = 0;
+  for (int i = 0; i < numEntities; i++) {
+    ShovelerWorldEntity* entity = shovelerWorldGetEntity(benchmarkWorld.world, firstEntityId + i);
+    for (ShovelerComponentType* componentType : benchmarkWorld.chainComponentTypes) {
+      ShovelerComponent* component = shovelerWorldEntityGetComponent(entity, componentType->id);
+      numActiveComponents += shovelerComponentIsActive(component) ? 1 : 0;
+    }
+  }
+  if (numActiveComponents != numComponents) {
+    shovelerLogError(
+        "Only %lld of %lld dependency chain components were activated.",
+        numActiveComponents,
+        numComponents);
+  }
+
+  const char* rootComponentTypeId = benchmarkWorld.chainComponentTypes[0]->id;
+  gint64 removeStartTime = g_get_monotonic_time();
+  for (int i = 0; i < numEntities; i++) {
+    ShovelerWorldEntity* entity = shovelerWorldGetEntity(benchmarkWorld.world, firstEntityId + i);
+    shovelerWorldEntityRemoveComponent(entity, rootComponentTypeId);
+  }
+  report(
+      options,
+      "dependency_chain",
+      "remove_root",
+      numEntities,
+      numComponents,
+      elapsedMs(removeStartTime));
+
+  freeBenchmarkWorld(benchmarkWorld);
+}
+
+/**
+ * Updates a field of every root component, either through a live update or by reactivating the
+ * component and with it the rest of its entity's chain.
+ */
+static void benchmarkFieldUpdate(const BenchmarkOptions& options, int numEntities, bool liveUpdate) {
+  BenchmarkWorld benchmarkWorld = createBenchmarkWorld(options, liveUpdate);
+  const char* rootComponentTypeId = benchmarkWorld.chainComponentTypes[0]->id;
+
+  std::vector<ShovelerComponent*> rootComponents;
+  for (int i = 0; i < numEntities; i++) {
+    addChainEntity(benchmarkWorld, firstEntityId + i);
+    ShovelerWorldEntity* entity = shovelerWorldGetEntity(benchmarkWorld.world, firstEntityId + i);
+    rootComponents.push_back(shovelerWorldEntityGetComponent(entity, rootComponentTypeId));
+  }
+
+  gint64 updateStartTime = g_get_monotonic_time();
+  for (int i = 0; i < numEntities; i++) {
+    shovelerComponentUpdateCanonicalFieldInt(rootComponents[i], /* fieldId */ 0, i + 1);
+  }
+  report(
+      options,
+      "field_update",
+      liveUpdate ? "live" : "reactivate",
+      numEntities,
+      numEntities,
+      elapsedMs(updateStartTime));
+
+  freeBenchmarkWorld(benchmarkWorld);
+}
+
+/**
+ * Models many tilemap chunks sharing a single tileset: every chunk entity has a component that
+ * depends on the same target component, which is then live updated and finally unsubscribed from
+ * in random order, as happens when chunks leave a client's interest.
+ */
+static void benchmarkReverseDependencyFanOut(const BenchmarkOptions& options, int numChunks) {
+  ShovelerSchema* schema = shovelerSchemaCreate();
+  ShovelerComponentType* chunkComponentType = shovelerCreateTestComponentType1();
+  ShovelerComponentType* tilesetComponentType = shovelerCreateTestComponentType2();
+  shovelerSchemaAddComponentType(schema, chunkComponentType);
+  shovelerSchemaAddComponentType(schema, tilesetComponentType);
+
+  ShovelerSystem* system = shovelerSystemCreate();
+  ShovelerComponentSystem* chunkComponentSystem =
+      shovelerSystemForComponentType(system, chunkComponentType);
+  chunkComponentSystem->fieldOptions[COMPONENT_TYPE_1_FIELD_DEPENDENCY_LIVE_UPDATE]
+      .liveUpdateDependencyField = shovelerComponentSystemLiveUpdateDependencyFieldNoop;
+  ShovelerComponentSystem* tilesetComponentSystem =
+      shovelerSystemForComponentType(system, tilesetComponentType);
+  tilesetComponentSystem->fieldOptions[COMPONENT_TYPE_2_FIELD_PRIMITIVE_LIVE_UPDATE]
+      .liveUpdateField = shovelerComponentSystemLiveUpdateFieldPropagate;
+
+  ShovelerWorld* world =
+      shovelerWorldCreate(schema, system, updateAuthoritativeComponent, /* userData */ NULL);
+
+  ShovelerWorldEntity* tilesetEntity = shovelerWorldAddEntity(world, tilesetEntityId);
+  ShovelerComponent* tilesetComponent =
+      shovelerWorldEntityAddComponent(tilesetEntity, componentType2Id);
+  shovelerComponentActivate(tilesetComponent);
+
+  gint64 subscribeStartTime = g_get_monotonic_time();
+  for (int i = 0; i < numChunks; i++) {
+    ShovelerWorldEntity* chunkEntity = shovelerWorldAddEntity(world, firstChunkEntityId + i);
+    ShovelerComponent* chunkComponent =
+        shovelerWorldEntityAddComponent(chunkEntity, componentType1Id);
+    shovelerComponentUpdateCanonicalFieldEntityId(
+        chunkComponent, COMPONENT_TYPE_1_FIELD_DEPENDENCY_LIVE_UPDATE, tilesetEntityId);
+    shovelerComponentActivate(chunkComponent);
+  }
+  report(options, "fan_out", "subscribe", numChunks, numChunks, elapsedMs(subscribeStartTime));
+
+  gint64 updateStartTime = g_get_monotonic_time();
+  for (int i = 0; i < numTilesetUpdates; i++) {
+    shovelerComponentUpdateCanonicalFieldString(
+        tilesetComponent, COMPONENT_TYPE_2_FIELD_PRIMITIVE_LIVE_UPDATE, i % 2 == 0 ? "a" : "b");
+  }
+  report(
+      options,
+      "fan_out",
+      "tileset_update",
+      numChunks,
+      numTilesetUpdates,
+      elapsedMs(updateStartTime));
+
+  std::vector<long long int> chunkEntityIds;
+  for (int i = 0; i < numChunks; i++) {
+    chunkEntityIds.push_back(firstChunkEntityId + i);
+  }
+  std::shuffle(chunkEntityIds.begin(), chunkEntityIds.end(), std::mt19937(/* seed */ 27));
+
+  gint64 unsubscribeStartTime = g_get_monotonic_time();
+  for (long long int chunkEntityId : chunkEntityIds) {
+    shovelerWorldRemoveEntity(world, chunkEntityId);
+  }
+  report(
+      options, "fan_out", "unsubscribe", numChunks, numChunks, elapsedMs(unsubscribeStartTime));
+
+  shovelerWorldFree(world);
+  shovelerSystemFree(system);
+  shovelerSchemaFree(schema);
+}
+
+/** Frees a world in which every entity has an active dependency chain. */
+static void benchmarkTeardown(const BenchmarkOptions& options, int numEntities) {
+  BenchmarkWorld benchmarkWorld = createBenchmarkWorld(options, /* liveUpdate */ false);
+  for (int i = 0; i < numEntities; i++) {
+    addChainEntity(benchmarkWorld, firstEntityId + i);
+  }
+
+  gint64 freeStartTime = g_get_monotonic_time();
+  shovelerWorldFree(benchmarkWorld.world);
+  benchmarkWorld.world = NULL;
+  report(
+      options,
+      "teardown",
+      "free",
+      numEntities,
+      (long long int) numEntities * options.chainDepth,
+      elapsedMs(freeStartTime));
+
+  freeBenchmarkWorld(benchmarkWorld);
+}
+
+/**
+ * Resolves component types by id the way a schema does on every component add, comparing a string
+ * keyed hash table with the interned dense index lookup.
+ */
+static void benchmarkComponentTypeResolution(const BenchmarkOptions& options) {
+  static std::vector<const char*> resolutionTypeIds;
+
+  std::vector<const char*> componentTypeIds;
+  ShovelerSchema* schema = shovelerSchemaCreate();
+  GHashTable* componentTypesByString = g_hash_table_new(g_str_hash, g_str_equal);
+  for (int i = 0; i < numResolutionTypes; i++) {
+    const char* componentTypeId =
+        getLeakedName(resolutionTypeIds, "benchmark_resolution_type_%d", i);
+    ShovelerComponentType* componentType =
+        shovelerComponentTypeCreate(componentTypeId, /* numFields */ 0, /* fields */ NULL);
+    shovelerSchemaAddComponentType(schema, componentType);
+    g_hash_table_insert(componentTypesByString, (gpointer) componentType->id, componentType);
+    componentTypeIds.push_back(componentType->id);
+  }
+
+  std::vector<int> lookupOrder;
+  std::mt19937 random(/* seed */ 28);
+  for (int i = 0; i < 1024; i++) {
+    lookupOrder.push_back((int) (random() % numResolutionTypes));
+  }
+
+  // accumulate the results so that the lookups can't be optimized out
+  uintptr_t stringChecksum = 0;
+  gint64 stringStartTime = g_get_monotonic_time();
+  for (int i = 0; i < numResolutions; i++) {
+    const char* componentTypeId = componentTypeIds[lookupOrder[i % lookupOrder.size()]];
+    stringChecksum += (uintptr_t) g_hash_table_lookup(componentTypesByString, componentTypeId);
+  }
+  report(options, "type_resolution", "string_hash", 0, numResolutions, elapsedMs(stringStartTime));
+
+  uintptr_t internedChecksum = 0;
+  gint64 internedStartTime = g_get_monotonic_time();
+  for (int i = 0; i < numResolutions; i++) {
+    const char* componentTypeId = componentTypeIds[lookupOrder[i % lookupOrder.size()]];
+    internedChecksum += (uintptr_t) shovelerSchemaGetComponentType(schema, componentTypeId);
+  }
+  report(options, "type_resolution", "interned", 0, numResolutions, elapsedMs(internedStartTime));
+
+  if (stringChecksum != internedChecksum) {
+    shovelerLogError("Component type resolution results differ between lookup methods.");
+  }
+
+  g_hash_table_destroy(componentTypesByString);
+  shovelerSchemaFree(schema);
+}
+
+int main(int argc, char** argv) {
+  BenchmarkOptions options;
+  if (!parseOptions(argc, argv, &options)) {
+    fprintf(
+        stderr,
+        "usage: %s [--entities=1000,10000] [--chain-depth=4] [--fields=4] [--filter=name]\n",
+        argv[0]);
+    return 1;
+  }
+
+  shovelerLogInit("shoveler/", SHOVELER_LOG_LEVEL_WARNING_UP, stderr);
+
+  for (int numEntities : options.numEntities) {
+    if (shouldRun(options, "entity_add_remove")) {
+      benchmarkEntityAddRemove(options, numEntities);
+    }
+    if (shouldRun(options, "dependency_chain")) {
+      benchmarkDependencyChain(options, numEntities);
+    }
+    if (shouldRun(options, "field_update")) {
+      benchmarkFieldUpdate(options, numEntities, /* liveUpdate */ true);
+      benchmarkFieldUpdate(options, numEntities, /* liveUpdate */ false);
+    }
+    if (shouldRun(options, "fan_out")) {
+      benchmarkReverseDependencyFanOut(options, numEntities);
+    }
+    if (shouldRun(options, "teardown")) {
+      benchmarkTeardown(options, numEntities);
+    }
+  }
+
+  if (shouldRun(options, "type_resolution")) {
+    benchmarkComponentTypeResolution(options);
+  }
+
+  shovelerLogTerminate();
+
+  return 0;
+}
+
+static bool parseOptions(int argc, char** argv, BenchmarkOptions* options) {
+  options->chainDepth = 4;
+  options->numFields = 4;
+
+  for (int i = 1; i < argc; i++) {
+    std::string argument = argv[i];
+    size_t separator = argument.find('=');
+    if (argument.compare(0, 2, "--") != 0 || separator == std::string::npos) {
+      return false;
+    }
+
+    std::string name = argument.substr(2, separator - 2);
+    std::string value = argument.substr(separator + 1);
+    if (name == "entities") {
+      size_t start = 0;
+      while (start <= value.size()) {
+        size_t end = value.find(',', start);
+        if (end == std::string::npos) {
+          end = value.size();
+        }
+        int numEntities = atoi(value.substr(start, end - start).c_str());
+        if (numEntities <= 0) {
+          return false;
+        }
+        options->numEntities.push_back(numEntities);
+        start = end + 1;
+      }
+    } else if (name == "chain-depth") {
+      options->chainDepth = atoi(value.c_str());
+    } else if (name == "fields") {
+      options->numFields = atoi(value.c_str());
+    } else if (name == "filter") {
+      options->filter = value;
+    } else {
+      return false;
+    }
+  }
+
+  if (options->numEntities.empty()) {
+    options->numEntities = {1000, 10000};
+  }
+
+  // the field update benchmarks need at least one int field on the root component
+  return options->chainDepth > 0 && options->numFields > 0;
+}
+
+static bool shouldRun(const BenchmarkOptions& options, const char* benchmark) {
+  return options.filter.empty() || strstr(benchmark, options.filter.c_str()) != NULL;
+}
+
+/**
+ * Returns a formatted name that lives until the end of the program, which is required for both
+ * component type ids and field names. Names are cached by index so repeated runs don't leak more.
+ */
+static const char* getLeakedName(std::vector<const char*>& names, const char* format, int index) {
+  while ((int) names.size() <= index) {
+    char* name = (char*) malloc(64);
+    snprintf(name, 64, format, (int) names.size());
+    names.push_back(name);
+  }
+
+  return names[index];
+}
+
+static BenchmarkWorld createBenchmarkWorld(const BenchmarkOptions& options, bool liveUpdate) {
+  static std::vector<const char*> chainTypeIds;
+  static std::vector<const char*> fieldNames;
+  static const char* dependencyFieldName = "dependency";
+
+  BenchmarkWorld benchmarkWorld;
+  benchmarkWorld.schema = shovelerSchemaCreate();
+  benchmarkWorld.system = shovelerSystemCreate();
+
+  std::vector<ShovelerComponentField> fields;
+  for (int depth = 0; depth < options.chainDepth; depth++) {
+    fields.clear();
+    for (int fieldId = 0; fieldId < options.numFields; fieldId++) {
+      fields.push_back(shovelerComponentField(
+          getLeakedName(fieldNames, "field_%d", fieldId),
+          SHOVELER_COMPONENT_FIELD_TYPE_INT,
+          /* isOptional */ false));
+    }
+    if (depth > 0) {
+      fields.push_back(shovelerComponentFieldDependency(
+          dependencyFieldName,
+          benchmarkWorld.chainComponentTypes[depth - 1]->id,
+          /* isArray */ false,
+          /* isOptional */ false));
+    }
+
+    ShovelerComponentType* componentType = shovelerComponentTypeCreate(
+        getLeakedName(chainTypeIds, "benchmark_chain_type_%d", depth),
+        (int) fields.size(),
+        fields.data());
+    shovelerSchemaAddComponentType(benchmarkWorld.schema, componentType);
+    benchmarkWorld.chainComponentTypes.push_back(componentType);
+
+    ShovelerComponentSystem* componentSystem =
+        shovelerSystemForComponentType(benchmarkWorld.system, componentType);
+    if (liveUpdate) {
+      for (int fieldId = 0; fieldId < options.numFields; fieldId++) {
+        componentSystem->fieldOptions[fieldId].liveUpdateField =
+            shovelerComponentSystemLiveUpdateFieldNoop;
+      }
+    }
+  }
+
+  benchmarkWorld.world = shovelerWorldCreate(
+      benchmarkWorld.schema,
+      benchmarkWorld.system,
+      updateAuthoritativeComponent,
+      /* userData */ NULL);
+
+  return benchmarkWorld;
+}
+
+static void addChainEntity(BenchmarkWorld& benchmarkWorld, long long int entityId) {
+  ShovelerWorldEntity* entity = shovelerWorldAddEntity(benchmarkWorld.world, entityId);
+
+  for (int depth = (int) benchmarkWorld.chainComponentTypes.size() - 1; depth >= 0; depth--) {
+    ShovelerComponentType* componentType = benchmarkWorld.chainComponentTypes[depth];
+    ShovelerComponent* component = shovelerWorldEntityAddComponent(entity, componentType->id);
+    if (depth > 0) {
+      // the dependency field is always the last one
+      shovelerComponentUpdateCanonicalFieldEntityId(
+          component, componentType->numFields - 1, entityId);
+    }
+    shovelerComponentActivate(component);
+  }
+}
+
+static void freeBenchmarkWorld(BenchmarkWorld& benchmarkWorld) {
+  if (benchmarkWorld.world != NULL) {
+    shovelerWorldFree(benchmarkWorld.world);
+  }
+  shovelerSystemFree(benchmarkWorld.system);
+  shovelerSchemaFree(benchmarkWorld.schema);
+}
+
+static void updateAuthoritativeComponent(
+    ShovelerWorld* world,
+    ShovelerComponent* component,
+    int fieldId,
+    const ShovelerComponentField* field,
+    const ShovelerComponentFieldValue* value,
+    void* userData) {}
+
+static double elapsedMs(gint64 startTime) {
+  return (double) (g_get_monotonic_time() - startTime) / 1000.0;
+}
+
+static void report(
+    const BenchmarkOptions& options,
+    const char* benchmark,
+    const char* metric,
+    int numEntities,
+    long long int numOperations,
+    double totalMs) {
+  printf(
+      "{\"benchmark\": \"%s\", \"metric\": \"%s\", \"entities\": %d, \"chain_depth\": %d, "
+      "\"fields\": %d, \"operations\": %lld, \"total_ms\": %.3f, \"ns_per_op\": %.2f}\n",
+      benchmark,
+      metric,
+      numEntities,
+      options.chainDepth,
+      options.numFields,
+      numOperations,
+      totalMs,
+      numOperations > 0 ? totalMs * 1000000.0 / numOperations : 0.0);
+  fflush(stdout);
+}
@@ -18,6 +18,8 @@ extern "C" {
 using ::testing::ElementsAre;
 using ::testing::IsEmpty;
 using ::testing::SizeIs;
+using ::testing::UnorderedElementsAre;
+using ::testing::UnorderedElementsAreArray;
 
 const long long int entityId1 = 1;
 const long long int entityId2 = 2;
@@ -43,6 +45,11 @@ static void dependencyCallback(
     bool added,
     void* userData);
 
+static void changeCallback(
+    ShovelerWorld* world, const ShovelerWorldChange* change, void* userData);
+static void reverseDependencyCallback(
+    ShovelerComponent* sourceComponent, ShovelerComponent* targetComponent, void* userData);
+
 static void* activateComponent(ShovelerComponent* component, void* userData);
 static void deactivateComponent(ShovelerComponent* component, void* userData);
 
@@ -74,6 +81,12 @@ MATCHER_P4(
       call.dependencyTarget.componentTypeId == targetComponentTypeId && !call.added;
 }
 
+MATCHER_P3(IsChange, entityId, componentTypeId, fieldId, "") {
+  const ShovelerWorldChange& change = arg;
+  return change.entityId == entityId && change.componentTypeId == componentTypeId &&
+      change.fieldId == fieldId;
+}
+
 class ShovelerWorldTest : public ::testing::Test {
 public:
   virtual void SetUp() {
@@ -126,6 +139,8 @@ public:
   std::vector<UpdateAuthoritativeComponentCall> updateAuthoritativeComponentCalls;
 
   std::vector<DependencyCallbackCall> dependencyCallbackCalls;
+  std::vector<ShovelerWorldChange> changeCallbackCalls;
+  std::vector<ShovelerComponent*> reverseDependencyCallbackCalls;
   std::vector<ShovelerComponent*> activateCalls;
   std::vector<ShovelerComponent*> deactivateCalls;
 };
@@ -217,6 +232,111 @@ TEST_F(ShovelerWorldTest, addRemoveDependency) {
   ASSERT_THAT(deactivateCalls, ElementsAre(component1));
 }
 
+TEST_F(ShovelerWorldTest, forEachReverseDependency) {
+  const int numSourceEntities = 5;
+  ShovelerWorldEntity* targetEntity = shovelerWorldAddEntity(world, entityId1);
+  ShovelerComponent* targetComponent =
+      shovelerWorldEntityAddComponent(targetEntity, componentType2Id);
+
+  std::vector<ShovelerComponent*> sourceComponents;
+  for (int i = 0; i < numSourceEntities; i++) {
+    ShovelerWorldEntity* sourceEntity = shovelerWorldAddEntity(world, entityId2 + i);
+    ShovelerComponent* sourceComponent =
+        shovelerWorldEntityAddComponent(sourceEntity, componentType1Id);
+    shovelerComponentUpdateCanonicalFieldEntityId(
+        sourceComponent, COMPONENT_TYPE_1_FIELD_DEPENDENCY_LIVE_UPDATE, entityId1);
+    shovelerComponentUpdateCanonicalFieldEntityId(
+        sourceComponent, COMPONENT_TYPE_1_FIELD_DEPENDENCY_REACTIVATE, entityId1);
+    sourceComponents.push_back(sourceComponent);
+  }
+  ASSERT_EQ(world->numComponentDependencies, 2 * numSourceEntities);
+
+  ShovelerComponentWorldAdapter* adapter = shovelerWorldGetComponentAdapter(world);
+  adapter->forEachReverseDependency(
+      targetComponent, reverseDependencyCallback, this, adapter->userData);
+  ASSERT_THAT(reverseDependencyCallbackCalls, UnorderedElementsAreArray(sourceComponents))
+      << "each source is only visited once even if it depends on the target twice";
+  reverseDependencyCallbackCalls.clear();
+
+  shovelerComponentClearField(
+      sourceComponents[0], COMPONENT_TYPE_1_FIELD_DEPENDENCY_LIVE_UPDATE, /* isCanonical */ true);
+  shovelerComponentClearField(
+      sourceComponents[1], COMPONENT_TYPE_1_FIELD_DEPENDENCY_LIVE_UPDATE, /* isCanonical */ true);
+  shovelerComponentClearField(
+      sourceComponents[1], COMPONENT_TYPE_1_FIELD_DEPENDENCY_REACTIVATE, /* isCanonical */ true);
+  shovelerWorldRemoveEntity(world, entityId2 + 2);
+
+  adapter->forEachReverseDependency(
+      targetComponent, reverseDependencyCallback, this, adapter->userData);
+  ASSERT_THAT(
+      reverseDependencyCallbackCalls,
+      UnorderedElementsAre(sourceComponents[0], sourceComponents[3], sourceComponents[4]));
+}
+
+TEST_F(ShovelerWorldTest, consumeCoalescedChanges) {
+  ShovelerWorldEntity* entity1 = shovelerWorldAddEntity(world, entityId1);
+  ShovelerComponent* component1 = shovelerWorldEntityAddComponent(entity1, componentType1Id);
+  ShovelerWorldChangeConsumer* consumer = shovelerWorldAddChangeConsumer(world, componentType1Id);
+
+  for (int i = 0; i < 10; i++) {
+    shovelerComponentUpdateCanonicalFieldInt(component1, COMPONENT_TYPE_1_FIELD_PRIMITIVE, i);
+  }
+
+  int numConsumed = shovelerWorldConsumeChanges(world, consumer, changeCallback, this);
+  ASSERT_EQ(numConsumed, 1);
+  ASSERT_THAT(
+      changeCallbackCalls,
+      ElementsAre(IsChange(entityId1, componentType1Id, COMPONENT_TYPE_1_FIELD_PRIMITIVE)));
+  ASSERT_EQ(changeCallbackCalls[0].generation, 10);
+  changeCallbackCalls.clear();
+
+  int numConsumedAgain = shovelerWorldConsumeChanges(world, consumer, changeCallback, this);
+  ASSERT_EQ(numConsumedAgain, 0);
+  ASSERT_THAT(changeCallbackCalls, IsEmpty());
+  ASSERT_EQ(world->changes->len, 0) << "changes seen by all consumers are trimmed";
+}
+
+TEST_F(ShovelerWorldTest, consumeChangesPerConsumer) {
+  ShovelerWorldChangeConsumer* consumer1 = shovelerWorldAddChangeConsumer(world, componentType1Id);
+  ShovelerWorldChangeConsumer* consumerAll =
+      shovelerWorldAddChangeConsumer(world, /* componentTypeId */ NULL);
+
+  ShovelerWorldEntity* entity1 = shovelerWorldAddEntity(world, entityId1);
+  ShovelerComponent* component1 = shovelerWorldEntityAddComponent(entity1, componentType1Id);
+  ShovelerComponent* component2 = shovelerWorldEntityAddComponent(entity1, componentType2Id);
+
+  shovelerWorldConsumeChanges(world, consumer1, changeCallback, this);
+  ASSERT_THAT(
+      changeCallbackCalls,
+      ElementsAre(
+          IsChange(entityId1, componentType1Id, SHOVELER_WORLD_CHANGE_COMPONENT_FIELD_ID)));
+  changeCallbackCalls.clear();
+
+  shovelerComponentUpdateCanonicalFieldInt(component1, COMPONENT_TYPE_1_FIELD_PRIMITIVE, 42);
+  shovelerComponentUpdateCanonicalFieldString(
+      component2, COMPONENT_TYPE_2_FIELD_PRIMITIVE_LIVE_UPDATE, "test");
+  shovelerWorldEntityRemoveComponent(entity1, componentType2Id);
+
+  shovelerWorldConsumeChanges(world, consumerAll, changeCallback, this);
+  ASSERT_THAT(
+      changeCallbackCalls,
+      ElementsAre(
+          IsChange(entityId1, componentType1Id, SHOVELER_WORLD_CHANGE_COMPONENT_FIELD_ID),
+          IsChange(entityId1, componentType2Id, SHOVELER_WORLD_CHANGE_COMPONENT_FIELD_ID),
+          IsChange(entityId1, componentType1Id, COMPONENT_TYPE_1_FIELD_PRIMITIVE),
+          IsChange(entityId1, componentType2Id, COMPONENT_TYPE_2_FIELD_PRIMITIVE_LIVE_UPDATE)));
+  changeCallbackCalls.clear();
+
+  shovelerWorldConsumeChanges(world, consumer1, changeCallback, this);
+  ASSERT_THAT(
+      changeCallbackCalls,
+      ElementsAre(IsChange(entityId1, componentType1Id, COMPONENT_TYPE_1_FIELD_PRIMITIVE)));
+
+  bool removed = shovelerWorldRemoveChangeConsumer(world, consumer1);
+  ASSERT_TRUE(removed);
+  ASSERT_EQ(world->changes->len, 0);
+}
+
 static void updateAuthoritativeComponent(
     ShovelerWorld* world,
     ShovelerComponent* component,
@@ -240,6 +360,18 @@ static void dependencyCallback(
       DependencyCallbackCall{world, *dependencySource, *dependencyTarget, added});
 }
 
+static void changeCallback(
+    ShovelerWorld* world, const ShovelerWorldChange* change, void* testPointer) {
+  ShovelerWorldTest* test = (ShovelerWorldTest*) testPointer;
+  test->changeCallbackCalls.emplace_back(*change);
+}
+
+static void reverseDependencyCallback(
+    ShovelerComponent* sourceComponent, ShovelerComponent* targetComponent, void* testPointer) {
+  ShovelerWorldTest* test = (ShovelerWorldTest*) testPointer;
+  test->reverseDependencyCallbackCalls.emplace_back(sourceComponent);
+}
+
 static void* activateComponent(ShovelerComponent* component, void* testPointer) {
   ShovelerWorldTest* test = (ShovelerWorldTest*) testPointer;
   test->activateCalls.emplace_back(component);
@@ -23,6 +23,7 @@
 #include <shoveler/texture.h>
 #include <shoveler/tile_sprite_animation.h>
 #include <shoveler/tilemap.h>
+#include <shoveler/tilemap_colliders.h>
 #include <shoveler/tileset.h>
 #include <shoveler/types.h>
 #include <stdlib.h> // EXIT_FAILURE, EXIT_SUCCESS
@@ -91,8 +92,9 @@ int main(int argc, char* argv[]) {
   shovelerImageGet(tilesImage, 1, 1, 2) = 2; // full tileset
   ShovelerTexture* tilesTexture = shovelerTextureCreate2d(tilesImage, true);
   shovelerTextureUpdate(tilesTexture);
-  bool collidingTiles[4] = {false, false, false, true};
-  ShovelerTilemap* tilemap = shovelerTilemapCreate(tilesTexture, collidingTiles);
+  ShovelerTilemapColliders* tilemapColliders = shovelerTilemapCollidersCreate(2, 2);
+  shovelerTilemapCollidersSet(tilemapColliders, /* column */ 1, /* row */ 1, true);
+  ShovelerTilemap* tilemap = shovelerTilemapCreate(tilesTexture, tilemapColliders);
   ShovelerSprite* tilemapSprite = shovelerSpriteTilemapCreate(tilemapMaterial, tilemap);
   tilemapSprite->size = shovelerVector2(10.0f, 10.0f);
   shovelerCanvasAddSprite(canvas, /* layerId */ 0, tilemapSprite);
@@ -185,6 +187,7 @@ int main(int argc, char* argv[]) {
   shovelerSpriteFree(characterSprite);
   shovelerSpriteFree(tileSprite);
   shovelerTilemapFree(tilemap);
+  shovelerTilemapCollidersFree(tilemapColliders);
   shovelerTextureFree(tilesTexture);
   shovelerTilemapFree(borderTilemap);
   shovelerTextureFree(borderTilesTexture);
@@ -154,7 +154,7 @@ int main(int argc, char* argv[]) {
   shovelerSpriteFree(screenspaceTextSprite);
   shovelerSpriteFree(textSprite);
   shovelerSamplerFree(textureSampler);
-  shovelerTextureFree(shovelerTextTexture);
+  shovelerTextTextureRendererRelease(textTextureRenderer, shovelerTextTexture);
   shovelerTextTextureRendererFree(textTextureRenderer);
   shovelerFontAtlasTextureFree(fontAtlasTexture);
   shovelerFontAtlasFree(fontAtlas);
@@ -0,0 +1,33 @@
+#ifndef SHOVELER_FRAMEBUFFER_POOL_H
+#define SHOVELER_FRAMEBUFFER_POOL_H
+
+#include <glad/glad.h>
+#include <glib.h>
+
+typedef struct ShovelerFramebufferStruct ShovelerFramebuffer; // forward declaration: framebuffer.h
+
+/**
+ * Pool of released color only framebuffers, reused for later requests of exactly the same size
+ * instead of creating new ones, so that content is never stretched to fit a larger framebuffer.
+ */
+typedef struct ShovelerFramebufferPoolStruct {
+  int channels;
+  int bitsPerChannel;
+  int maxFramebuffersPerBucket;
+  /** map from size (gint64 *) to owning (GQueue *) of released (ShovelerFramebuffer *) */
+  GHashTable* buckets;
+  int numCreated;
+  int numReused;
+} ShovelerFramebufferPool;
+
+ShovelerFramebufferPool* shovelerFramebufferPoolCreate(
+    int channels, int bitsPerChannel, int maxFramebuffersPerBucket);
+/** Returns a framebuffer of the requested size, with both dimensions being at least one. */
+ShovelerFramebuffer* shovelerFramebufferPoolAcquire(
+    ShovelerFramebufferPool* pool, GLsizei width, GLsizei height);
+/** Returns an acquired framebuffer to the pool, freeing it if its bucket is already full. */
+void shovelerFramebufferPoolRelease(
+    ShovelerFramebufferPool* pool, ShovelerFramebuffer* framebuffer);
+void shovelerFramebufferPoolFree(ShovelerFramebufferPool* pool);
+
+#endif
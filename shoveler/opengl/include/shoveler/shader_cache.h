@@ -3,6 +3,7 @@
 
 #include <glib.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef struct ShovelerCameraStruct ShovelerCamera; // forward declaration: camera.h
 typedef struct ShovelerLightStruct ShovelerLight; // forward declaration: light.h
@@ -12,25 +13,51 @@ typedef struct ShovelerSceneStruct ShovelerScene; // forward declaration: scene.
 typedef struct ShovelerShaderStruct ShovelerShader; // forward declaration: shader.h
 typedef struct ShovelerShaderKeyStruct ShovelerShaderKey; // forward declaration: shader.h
 
+typedef void(ShovelerShaderCacheFreeShaderFunction)(void* shaderPointer);
+
+/** Number of pointers in a shader key, i.e. scene, camera, light, model, material and user data. */
+#define SHOVELER_SHADER_CACHE_NUM_KEY_PARTS 6
+
+typedef struct {
+  /* 64-bit hash of the shader key, computed once on insertion and compared before the key */
+  uint64_t hash;
+  /* NULL if the bucket is empty */
+  ShovelerShader* shader;
+  /* dense handles of the pointers in the shader key, in key order */
+  unsigned int handles[SHOVELER_SHADER_CACHE_NUM_KEY_PARTS];
+  /* generations of those handles on insertion, the entry is stale once any of them moved on */
+  unsigned int generations[SHOVELER_SHADER_CACHE_NUM_KEY_PARTS];
+} ShovelerShaderCacheEntry;
+
+/**
+ * Cache of shaders by shader key.
+ *
+ * Every pointer in a key is given a dense integer handle with a generation counter. Invalidating
+ * a scene, camera, light, model, material or user data only bumps the generation of its handle,
+ * which makes every entry inserted with the previous generation stale. Stale entries are evicted
+ * lazily, either when a lookup runs into them or when the table runs out of space.
+ *
+ * Lookups hash the key once and probe a single open addressing table, so that neither they nor
+ * insertions touch any per pointer bookkeeping beyond resolving handles on insertion.
+ */
 typedef struct ShovelerShaderCacheStruct {
-  /** map from (ShovelerShaderKey *) to (ShovelerShader *) */
-  GHashTable* shaders;
-  /** map from (ShovelerScene *) to set of (ShovelerShaderKey *) */
-  GHashTable* sceneShaderKeys;
-  /** map from (ShovelerCamera *) to set of (ShovelerShaderKey *) */
-  GHashTable* cameraShaderKeys;
-  /** map from (ShovelerLight *) to set of (ShovelerShaderKey *) */
-  GHashTable* lightShaderKeys;
-  /** map from (ShovelerModel *) to set of (ShovelerShaderKey *) */
-  GHashTable* modelShaderKeys;
-  /** map from (ShovelerMaterial *) to set of (ShovelerShaderKey *) */
-  GHashTable* materialShaderKeys;
-  /** map from (void *) to set of (ShovelerShaderKey *) */
-  GHashTable* userDataShaderKeys;
+  ShovelerShaderCacheFreeShaderFunction* freeShader;
+  /** open addressing table with linear probing, its capacity is a power of two */
+  ShovelerShaderCacheEntry* entries;
+  unsigned int capacity;
+  /** number of occupied buckets, including stale entries that weren't evicted yet */
+  unsigned int numEntries;
+  /** for each key part, map from pointer to its handle plus one */
+  GHashTable* handles[SHOVELER_SHADER_CACHE_NUM_KEY_PARTS];
+  /** current generation of each handle */
+  unsigned int* generations;
+  unsigned int numHandles;
+  unsigned int handlesCapacity;
+  /** handles of invalidated pointers, reused for the next new ones */
+  unsigned int* freeHandles;
+  unsigned int numFreeHandles;
 } ShovelerShaderCache;
 
-typedef void(ShovelerShaderCacheFreeShaderFunction)(void* shaderPointer);
-
 ShovelerShaderCache* shovelerShaderCacheCreate();
 ShovelerShaderCache* shovelerShaderCacheCreateWithCustomFree(
     ShovelerShaderCacheFreeShaderFunction* freeShader);
@@ -0,0 +1,75 @@
+#ifndef SHOVELER_TEXT_TEXTURE_CACHE_H
+#define SHOVELER_TEXT_TEXTURE_CACHE_H
+
+#include <glib.h>
+#include <stdbool.h> // bool
+#include <stddef.h> // size_t
+
+typedef struct ShovelerFontAtlasStruct ShovelerFontAtlas; // forward declaration: font_atlas.h
+typedef struct ShovelerTextureStruct ShovelerTexture; // forward declaration: texture.h
+
+typedef struct ShovelerTextTextureCacheKeyStruct {
+  char* text;
+  ShovelerFontAtlas* fontAtlas;
+  int fontSize;
+} ShovelerTextTextureCacheKey;
+
+typedef struct ShovelerTextTextureCacheEntryStruct {
+  ShovelerTextTextureCacheKey key;
+  ShovelerTexture* texture;
+  size_t numBytes;
+  /* number of acquired references that haven't been released yet */
+  int numReferences;
+  /* link in the queue of unreferenced entries, or NULL while referenced */
+  GList* unreferencedLink;
+} ShovelerTextTextureCacheEntry;
+
+typedef void(ShovelerTextTextureCacheFreeTextureFunction)(
+    ShovelerTexture* texture, void* userData);
+
+/**
+ * Least recently used cache of rendered text textures.
+ *
+ * Textures are reference counted: each successful acquire must be matched by a release. Entries
+ * that are no longer referenced stay cached, and are only evicted in least recently released
+ * order once the textures in the cache exceed the budget. Referenced entries are never evicted,
+ * so the budget can temporarily be exceeded if more text is in use than fits into it.
+ */
+typedef struct ShovelerTextTextureCacheStruct {
+  size_t budgetBytes;
+  size_t numBytes;
+  /** map from (ShovelerTextTextureCacheKey *) to owning (ShovelerTextTextureCacheEntry *) */
+  GHashTable* entries;
+  /** map from (ShovelerTexture *) to (ShovelerTextTextureCacheEntry *) */
+  GHashTable* textureEntries;
+  /** queue of unreferenced (ShovelerTextTextureCacheEntry *), least recently released first */
+  GQueue* unreferencedEntries;
+  ShovelerTextTextureCacheFreeTextureFunction* freeTexture;
+  void* freeTextureUserData;
+  int numHits;
+  int numMisses;
+  int numEvictions;
+} ShovelerTextTextureCache;
+
+ShovelerTextTextureCache* shovelerTextTextureCacheCreate(
+    size_t budgetBytes,
+    ShovelerTextTextureCacheFreeTextureFunction* freeTexture,
+    void* freeTextureUserData);
+/** Returns a new reference to the cached texture for the given key, or NULL on a miss. */
+ShovelerTexture* shovelerTextTextureCacheAcquire(
+    ShovelerTextTextureCache* cache, const char* text, ShovelerFontAtlas* fontAtlas, int fontSize);
+/**
+ * Inserts a texture rendered after a miss, transferring ownership over it to the cache and
+ * returning it as a new reference.
+ */
+ShovelerTexture* shovelerTextTextureCacheInsert(
+    ShovelerTextTextureCache* cache,
+    const char* text,
+    ShovelerFontAtlas* fontAtlas,
+    int fontSize,
+    ShovelerTexture* texture,
+    size_t numBytes);
+bool shovelerTextTextureCacheRelease(ShovelerTextTextureCache* cache, ShovelerTexture* texture);
+void shovelerTextTextureCacheFree(ShovelerTextTextureCache* cache);
+
+#endif
@@ -9,12 +9,16 @@
 typedef struct ShovelerDrawableStruct ShovelerDrawable; // forward declaration: drawable.h
 typedef struct ShovelerFontAtlasTextureStruct
     ShovelerFontAtlasTexture; // forward declaration: font_atlas_texture.h
+typedef struct ShovelerFramebufferPoolStruct
+    ShovelerFramebufferPool; // forward declaration: framebuffer_pool.h
 typedef struct ShovelerMaterialStruct ShovelerMaterial; // forward declaration: material.h
 typedef struct ShovelerModelStruct ShovelerModel; // forward declaration: model.h
 typedef struct ShovelerRenderStateStruct ShovelerRenderState; // forward declaration: render_state.h
 typedef struct ShovelerSceneStruct ShovelerScene; // forward declaration: scene.h
 typedef struct ShovelerShaderCacheStruct ShovelerShaderCache; // forward declaration: shader_cache.h
 typedef struct ShovelerSpriteStruct ShovelerSprite; // forward declaration: sprite.h
+typedef struct ShovelerTextTextureCacheStruct
+    ShovelerTextTextureCache; // forward declaration: text_texture_cache.h
 typedef struct ShovelerTextureStruct ShovelerTexture; // forward declaration: texture.h
 
 typedef struct ShovelerTextTextureStruct {
@@ -31,13 +35,27 @@ typedef struct ShovelerTextTextureRendererStruct {
   ShovelerModel* textModel;
   ShovelerCanvas* textCanvas;
   ShovelerSprite* textSprite;
+  ShovelerTextTextureCache* textureCache;
+  ShovelerFramebufferPool* framebufferPool;
+  /** map from cached (ShovelerTexture *) to the (ShovelerFramebuffer *) it was rendered with */
+  GHashTable* textureFramebuffers;
 } ShovelerTextTextureRenderer;
 
+#define SHOVELER_TEXT_TEXTURE_RENDERER_CACHE_BUDGET_BYTES (4 * 1024 * 1024)
+#define SHOVELER_TEXT_TEXTURE_RENDERER_MAX_POOLED_FRAMEBUFFERS_PER_BUCKET 4
+
 /** Create a renderer with the caller retaining ownership over the passed font atlas texture. */
 ShovelerTextTextureRenderer* shovelerTextTextureRendererCreate(
     ShovelerFontAtlasTexture* fontAtlasTexture, ShovelerShaderCache* shaderCache);
+/**
+ * Returns a texture with the given text rendered into it, which is shared with other callers
+ * rendering the same text and must be released with shovelerTextTextureRendererRelease instead
+ * of being freed.
+ */
 ShovelerTexture* shovelerTextTextureRendererRender(
     ShovelerTextTextureRenderer* renderer, const char* text, ShovelerRenderState* renderState);
+bool shovelerTextTextureRendererRelease(
+    ShovelerTextTextureRenderer* renderer, ShovelerTexture* texture);
 void shovelerTextTextureRendererFree(ShovelerTextTextureRenderer* renderer);
 
 #endif
@@ -5,6 +5,7 @@
 #include <stdbool.h> // bool
 
 typedef struct ShovelerImageStruct ShovelerImage; // forward declaration: image.h
+typedef struct ShovelerImageMipmapsStruct ShovelerImageMipmaps; // forward declaration: mipmap.h
 
 typedef struct ShovelerTextureStruct {
   unsigned int width;
@@ -12,6 +13,10 @@ typedef struct ShovelerTextureStruct {
   unsigned int channels;
   ShovelerImage* image;
   bool manageImage;
+  /* whether the image was uploaded in full at least once, after which only its dirty region is */
+  bool uploaded;
+  /* regenerate mipmaps after each upload, can be turned off for textures sampled without them */
+  bool generateMipmaps;
   GLuint target;
   GLuint texture;
   GLuint internalFormat;
@@ -27,7 +32,21 @@ ShovelerTexture* shovelerTextureCreateRenderTarget(
     int bitsPerChannel);
 ShovelerTexture* shovelerTextureCreateDepthTarget(
     unsigned int width, unsigned int height, GLsizei samples);
+/** Uploads the whole image, regardless of which parts of it changed. */
 bool shovelerTextureUpdate(ShovelerTexture* texture);
+/**
+ * Uploads the whole image along with a mip chain built from it on the CPU, instead of having the
+ * driver generate mipmaps on the render thread. Later flushes of a dirty region fall back to
+ * generating them again.
+ */
+bool shovelerTextureUpdateWithMipmaps(ShovelerTexture* texture, ShovelerImageMipmaps* mipmaps);
+/**
+ * Uploads only the dirty region of the image, or the whole image if it was never uploaded.
+ *
+ * This is called by shovelerTextureUse, so that all changes made to the image in a frame are
+ * uploaded once before it is next sampled.
+ */
+bool shovelerTextureFlush(ShovelerTexture* texture);
 bool shovelerTextureUse(ShovelerTexture* texture, GLuint unitIndex);
 void shovelerTextureFree(ShovelerTexture* texture);
 
@@ -11,24 +11,28 @@ typedef struct ShovelerModelStruct ShovelerModel; // forward declaration: model.
 typedef struct ShovelerRenderStateStruct ShovelerRenderState; // forward declaration: render_state.h
 typedef struct ShovelerSceneStruct ShovelerScene; // forward declaration: scene.h
 typedef struct ShovelerTextureStruct ShovelerTexture; // forward declaration: texture.h
+typedef struct ShovelerTilemapCollidersStruct
+    ShovelerTilemapColliders; // forward declaration: tilemap_colliders.h
 typedef struct ShovelerTilesetStruct ShovelerTileset; // forward declaration: tileset.h
 
 typedef struct ShovelerTilemapStruct {
   ShovelerTexture* tiles;
   /** list of (ShovelerTileset *) */
   GQueue* tilesets;
-  /**
-   * Array of booleans indicating colliding tiles, where tile (column, row) is at position [row *
-   * numColumns + column].
-   */
-  const bool* collidingTiles;
+  /** colliding tiles with the same dimensions as the tiles texture, or NULL if none collide */
+  const ShovelerTilemapColliders* colliders;
 } ShovelerTilemap;
 
-/** Creates a tilemap from a texture and an array of colliding tiles, with the caller retaining
- * ownership over both. */
-ShovelerTilemap* shovelerTilemapCreate(ShovelerTexture* tiles, const bool* collidingTiles);
+/** Creates a tilemap from a texture and its colliding tiles, with the caller retaining ownership
+ * over both. */
+ShovelerTilemap* shovelerTilemapCreate(
+    ShovelerTexture* tiles, const ShovelerTilemapColliders* colliders);
 /** Adds a tileset to the tilemap, returning its index. */
 int shovelerTilemapAddTileset(ShovelerTilemap* tilemap, ShovelerTileset* tileset);
+/**
+ * Returns true if the object intersects any colliding tile of the tilemap spanning the bounding
+ * box, with row zero at the bottom of the bounding box.
+ */
 bool shovelerTilemapIntersect(
     ShovelerTilemap* tilemap,
     const ShovelerBoundingBox2* boundingBox,
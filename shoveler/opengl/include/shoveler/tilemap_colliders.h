@@ -0,0 +1,41 @@
+#ifndef SHOVELER_TILEMAP_COLLIDERS_H
+#define SHOVELER_TILEMAP_COLLIDERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Packed bitset of colliding tiles, where tile (column, row) is bit (column % 64) of word [row *
+ * numWordsPerRow + column / 64]. Padding bits past the last column of a row are always zero, so
+ * that whole words can be tested at once.
+ */
+typedef struct ShovelerTilemapCollidersStruct {
+  int numColumns;
+  int numRows;
+  int numWordsPerRow;
+  uint64_t* words;
+} ShovelerTilemapColliders;
+
+/** Creates colliders for the given dimensions, with no tile colliding initially. */
+ShovelerTilemapColliders* shovelerTilemapCollidersCreate(int numColumns, int numRows);
+/** Sets colliding tiles from an array of numColumns * numRows bytes, nonzero meaning colliding. */
+void shovelerTilemapCollidersUpdate(
+    ShovelerTilemapColliders* colliders, const unsigned char* collidingTiles);
+void shovelerTilemapCollidersSet(
+    ShovelerTilemapColliders* colliders, int column, int row, bool colliding);
+/** Returns true if any tile in the inclusive range is colliding, clamping it to the tilemap. */
+bool shovelerTilemapCollidersIntersectRange(
+    const ShovelerTilemapColliders* colliders,
+    int minColumn,
+    int minRow,
+    int maxColumn,
+    int maxRow);
+void shovelerTilemapCollidersFree(ShovelerTilemapColliders* colliders);
+
+static inline bool shovelerTilemapCollidersGet(
+    const ShovelerTilemapColliders* colliders, int column, int row) {
+  uint64_t word = colliders->words[row * colliders->numWordsPerRow + column / 64];
+  return (word >> (column % 64)) & 1;
+}
+
+#endif
@@ -23,11 +23,13 @@ bool shovelerFontAtlasTextureUpdate(ShovelerFontAtlasTexture* fontAtlasTexture)
     shovelerTextureFree(fontAtlasTexture->texture);
     fontAtlasTexture->atlasImageSize = fontAtlasTexture->fontAtlas->image->width;
     fontAtlasTexture->texture = shovelerTextureCreate2d(fontAtlasTexture->fontAtlas->image, false);
+    // text is sampled without mipmaps
+    fontAtlasTexture->texture->generateMipmaps = false;
     newTextureGenerated = true;
   }
 
-  // TODO: only update the texture if the font atlas is "dirty"
-  shovelerTextureUpdate(fontAtlasTexture->texture);
+  // only uploads the glyphs added since the last update
+  shovelerTextureFlush(fontAtlasTexture->texture);
 
   return newTextureGenerated;
 }
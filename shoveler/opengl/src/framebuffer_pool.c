@@ -0,0 +1,88 @@
+#include "shoveler/framebuffer_pool.h"
+
+#include <assert.h> // assert
+#include <stdlib.h> // malloc free
+
+#include "shoveler/framebuffer.h"
+
+static gint64* createBucketKey(GLsizei width, GLsizei height);
+static void freeBucket(void* bucketPointer);
+
+ShovelerFramebufferPool* shovelerFramebufferPoolCreate(
+    int channels, int bitsPerChannel, int maxFramebuffersPerBucket) {
+  assert(maxFramebuffersPerBucket >= 0);
+
+  ShovelerFramebufferPool* pool = malloc(sizeof(ShovelerFramebufferPool));
+  pool->channels = channels;
+  pool->bitsPerChannel = bitsPerChannel;
+  pool->maxFramebuffersPerBucket = maxFramebuffersPerBucket;
+  pool->buckets = g_hash_table_new_full(g_int64_hash, g_int64_equal, free, freeBucket);
+  pool->numCreated = 0;
+  pool->numReused = 0;
+
+  return pool;
+}
+
+ShovelerFramebuffer* shovelerFramebufferPoolAcquire(
+    ShovelerFramebufferPool* pool, GLsizei width, GLsizei height) {
+  if (width < 1) {
+    width = 1;
+  }
+  if (height < 1) {
+    height = 1;
+  }
+
+  gint64 bucketKey = (gint64) width << 32 | (gint64) height;
+  GQueue* bucket = g_hash_table_lookup(pool->buckets, &bucketKey);
+  if (bucket != NULL && !g_queue_is_empty(bucket)) {
+    pool->numReused++;
+    return g_queue_pop_head(bucket);
+  }
+
+  pool->numCreated++;
+  return shovelerFramebufferCreateColorOnly(
+      width, height, /* samples */ 1, pool->channels, pool->bitsPerChannel);
+}
+
+void shovelerFramebufferPoolRelease(
+    ShovelerFramebufferPool* pool, ShovelerFramebuffer* framebuffer) {
+  gint64 bucketKey = (gint64) framebuffer->width << 32 | (gint64) framebuffer->height;
+  GQueue* bucket = g_hash_table_lookup(pool->buckets, &bucketKey);
+  if (bucket == NULL) {
+    bucket = g_queue_new();
+    g_hash_table_insert(
+        pool->buckets, createBucketKey(framebuffer->width, framebuffer->height), bucket);
+  }
+
+  if ((int) g_queue_get_length(bucket) >= pool->maxFramebuffersPerBucket) {
+    shovelerFramebufferFree(framebuffer, /* keepTargets */ false);
+    return;
+  }
+
+  g_queue_push_tail(bucket, framebuffer);
+}
+
+void shovelerFramebufferPoolFree(ShovelerFramebufferPool* pool) {
+  if (pool == NULL) {
+    return;
+  }
+
+  g_hash_table_destroy(pool->buckets);
+  free(pool);
+}
+
+static gint64* createBucketKey(GLsizei width, GLsizei height) {
+  gint64* bucketKey = malloc(sizeof(gint64));
+  *bucketKey = (gint64) width << 32 | (gint64) height;
+  return bucketKey;
+}
+
+static void freeBucket(void* bucketPointer) {
+  GQueue* bucket = bucketPointer;
+
+  for (GList* iter = bucket->head; iter != NULL; iter = iter->next) {
+    shovelerFramebufferFree(iter->data, /* keepTargets */ false);
+  }
+
+  g_queue_free(bucket);
+}
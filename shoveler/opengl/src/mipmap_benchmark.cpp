@@ -0,0 +1,267 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glib.h>
+
+#include "shoveler/image.h"
+#include "shoveler/image/mipmap.h"
+#include "shoveler/log.h"
+#include "shoveler/texture.h"
+}
+
+/**
+ * Benchmark for mipmapping large animation tilesets, comparing the driver generating mipmaps on
+ * the render thread with building the mip chain on the CPU and uploading all of its levels.
+ *
+ * The CPU chain is built with both filters on the calling thread, and with the box filter for one
+ * tileset per worker thread at once, which is how image components build them on activation
+ * threads. If an OpenGL context can be created from a hidden window, the render thread cost of
+ * both upload paths is measured as well, waiting for the driver to finish after each upload.
+ *
+ * Every measurement is written to stdout as a single line JSON object, so that the output of
+ * repeated runs can be collected and compared over time. Log messages go to stderr.
+ *
+ * Usage: shoveler_opengl_mipmap_benchmark [--max-tile-size=1024] [--repetitions=5] [--threads=4]
+ */
+
+struct BenchmarkOptions {
+  unsigned int maxTileSize;
+  int repetitions;
+  int numThreads;
+};
+
+static bool parseOptions(int argc, char** argv, BenchmarkOptions* options);
+static ShovelerImage* createTileset(unsigned int tileSize);
+static void runCpu(const BenchmarkOptions& options, ShovelerImage* tileset);
+static void runCpuThreads(const BenchmarkOptions& options, ShovelerImage* tileset);
+static void runUpload(const BenchmarkOptions& options, ShovelerImage* tileset);
+static GLFWwindow* createContext();
+static void printMeasurement(
+    const char* mode, ShovelerImage* tileset, int numThreads, int repetitions, double minMs);
+static double elapsedMs(gint64 startTime);
+
+int main(int argc, char** argv) {
+  BenchmarkOptions options;
+  if (!parseOptions(argc, argv, &options)) {
+    fprintf(
+        stderr,
+        "Usage: %s [--max-tile-size=1024] [--repetitions=5] [--threads=4]\n",
+        argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  shovelerLogInit("shoveler/", SHOVELER_LOG_LEVEL_WARNING_UP, stderr);
+
+  GLFWwindow* window = createContext();
+
+  for (unsigned int tileSize = 128; tileSize <= options.maxTileSize; tileSize *= 2) {
+    ShovelerImage* tileset = createTileset(tileSize);
+
+    runCpu(options, tileset);
+    runCpuThreads(options, tileset);
+    if (window != NULL) {
+      runUpload(options, tileset);
+    }
+
+    shovelerImageFree(tileset);
+  }
+
+  if (window != NULL) {
+    glfwDestroyWindow(window);
+    glfwTerminate();
+  }
+
+  shovelerLogTerminate();
+  return EXIT_SUCCESS;
+}
+
+static bool parseOptions(int argc, char** argv, BenchmarkOptions* options) {
+  options->maxTileSize = 1024;
+  options->repetitions = 5;
+  options->numThreads = 4;
+
+  for (int i = 1; i < argc; i++) {
+    std::string argument = argv[i];
+    size_t separator = argument.find('=');
+    if (argument.compare(0, 2, "--") != 0 || separator == std::string::npos) {
+      return false;
+    }
+
+    std::string name = argument.substr(2, separator - 2);
+    std::string value = argument.substr(separator + 1);
+    if (name == "max-tile-size" && atoi(value.c_str()) >= 128) {
+      options->maxTileSize = (unsigned int) atoi(value.c_str());
+    } else if (name == "repetitions" && atoi(value.c_str()) > 0) {
+      options->repetitions = atoi(value.c_str());
+    } else if (name == "threads" && atoi(value.c_str()) > 0) {
+      options->numThreads = atoi(value.c_str());
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/** Creates a 4x3 tile RGBA animation tileset from a noisy character tile. */
+static ShovelerImage* createTileset(unsigned int tileSize) {
+  ShovelerImage* tile = shovelerImageCreate(tileSize, tileSize, 4);
+  uint32_t state = tileSize;
+  for (unsigned int i = 0; i < tileSize * tileSize * 4; i++) {
+    state = state * 1664525u + 1013904223u;
+    tile->data[i] = (unsigned char) (state >> 24);
+  }
+
+  ShovelerImage* tileset = shovelerImageCreateAnimationTileset(tile, 1);
+  shovelerImageFree(tile);
+  return tileset;
+}
+
+static void runCpu(const BenchmarkOptions& options, ShovelerImage* tileset) {
+  const ShovelerImageMipmapFilter filters[] = {
+      SHOVELER_IMAGE_MIPMAP_FILTER_BOX, SHOVELER_IMAGE_MIPMAP_FILTER_GAMMA_CORRECT};
+
+  for (ShovelerImageMipmapFilter filter : filters) {
+    double minMs = 0.0;
+    for (int repetition = 0; repetition < options.repetitions; repetition++) {
+      gint64 startTime = g_get_monotonic_time();
+      ShovelerImageMipmaps* mipmaps = shovelerImageMipmapsCreate(tileset, filter);
+      double repetitionMs = elapsedMs(startTime);
+      shovelerImageMipmapsFree(mipmaps);
+
+      if (repetition == 0 || repetitionMs < minMs) {
+        minMs = repetitionMs;
+      }
+    }
+
+    printMeasurement(
+        filter == SHOVELER_IMAGE_MIPMAP_FILTER_BOX ? "cpu_box" : "cpu_gamma_correct",
+        tileset,
+        1,
+        options.repetitions,
+        minMs);
+  }
+}
+
+static void runCpuThreads(const BenchmarkOptions& options, ShovelerImage* tileset) {
+  double minMs = 0.0;
+  for (int repetition = 0; repetition < options.repetitions; repetition++) {
+    std::vector<ShovelerImageMipmaps*> mipmaps(options.numThreads);
+    std::vector<std::thread> threads;
+
+    gint64 startTime = g_get_monotonic_time();
+    for (int i = 0; i < options.numThreads; i++) {
+      threads.emplace_back([&mipmaps, tileset, i]() {
+        mipmaps[i] = shovelerImageMipmapsCreate(tileset, SHOVELER_IMAGE_MIPMAP_FILTER_BOX);
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    // report the time per tileset, so that it compares directly to the single threaded modes
+    double repetitionMs = elapsedMs(startTime) / options.numThreads;
+
+    for (ShovelerImageMipmaps* threadMipmaps : mipmaps) {
+      shovelerImageMipmapsFree(threadMipmaps);
+    }
+
+    if (repetition == 0 || repetitionMs < minMs) {
+      minMs = repetitionMs;
+    }
+  }
+
+  printMeasurement(
+      "cpu_box_threads", tileset, options.numThreads, options.repetitions, minMs);
+}
+
+static void runUpload(const BenchmarkOptions& options, ShovelerImage* tileset) {
+  ShovelerImageMipmaps* mipmaps =
+      shovelerImageMipmapsCreate(tileset, SHOVELER_IMAGE_MIPMAP_FILTER_BOX);
+
+  for (int withMipmaps = 0; withMipmaps < 2; withMipmaps++) {
+    double minMs = 0.0;
+    for (int repetition = 0; repetition < options.repetitions; repetition++) {
+      ShovelerTexture* texture = shovelerTextureCreate2d(tileset, /* manageImage */ false);
+      glFinish();
+
+      gint64 startTime = g_get_monotonic_time();
+      if (withMipmaps) {
+        shovelerTextureUpdateWithMipmaps(texture, mipmaps);
+      } else {
+        shovelerTextureUpdate(texture);
+      }
+      glFinish();
+      double repetitionMs = elapsedMs(startTime);
+
+      shovelerTextureFree(texture);
+
+      if (repetition == 0 || repetitionMs < minMs) {
+        minMs = repetitionMs;
+      }
+    }
+
+    printMeasurement(
+        withMipmaps ? "upload_levels" : "driver_generate",
+        tileset,
+        1,
+        options.repetitions,
+        minMs);
+  }
+
+  shovelerImageMipmapsFree(mipmaps);
+}
+
+static GLFWwindow* createContext() {
+  if (!glfwInit()) {
+    shovelerLogWarning("Failed to initialize glfw, only measuring CPU mip chains.");
+    return NULL;
+  }
+
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_API);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+  GLFWwindow* window = glfwCreateWindow(1, 1, "shoveler mipmap benchmark", NULL, NULL);
+  if (window == NULL) {
+    shovelerLogWarning("Failed to create glfw window, only measuring CPU mip chains.");
+    glfwTerminate();
+    return NULL;
+  }
+
+  glfwMakeContextCurrent(window);
+  if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+    shovelerLogWarning("Failed to load OpenGL functions, only measuring CPU mip chains.");
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return NULL;
+  }
+
+  return window;
+}
+
+static void printMeasurement(
+    const char* mode, ShovelerImage* tileset, int numThreads, int repetitions, double minMs) {
+  printf(
+      "{\"benchmark\": \"mipmap\", \"mode\": \"%s\", \"width\": %u, \"height\": %u, "
+      "\"threads\": %d, \"repetitions\": %d, \"min_ms\": %.3f}\n",
+      mode,
+      tileset->width,
+      tileset->height,
+      numThreads,
+      repetitions,
+      minMs);
+  fflush(stdout);
+}
+
+static double elapsedMs(gint64 startTime) {
+  return (double) (g_get_monotonic_time() - startTime) / 1000.0;
+}
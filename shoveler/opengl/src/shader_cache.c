@@ -1,7 +1,7 @@
 #include "shoveler/shader_cache.h"
 
-#include <assert.h> // assert
-#include <stdlib.h> // malloc free
+#include <stdlib.h> // malloc realloc free
+#include <string.h> // memcmp
 
 #include "shoveler/camera.h"
 #include "shoveler/light.h"
@@ -9,8 +9,34 @@
 #include "shoveler/model.h"
 #include "shoveler/shader.h"
 
+#define INITIAL_CAPACITY 64
+#define INITIAL_HANDLES_CAPACITY 16
+
+typedef enum {
+  KEY_PART_SCENE,
+  KEY_PART_CAMERA,
+  KEY_PART_LIGHT,
+  KEY_PART_MODEL,
+  KEY_PART_MATERIAL,
+  KEY_PART_USER_DATA,
+} KeyPart;
+
 static void freeShader(void* shaderPointer);
-static void freeSet(void* setPointer);
+static void getKeyParts(
+    const ShovelerShaderKey* shaderKey, void* keyParts[SHOVELER_SHADER_CACHE_NUM_KEY_PARTS]);
+static uint64_t hashKey(const ShovelerShaderKey* shaderKey);
+static bool findEntry(
+    ShovelerShaderCache* cache,
+    const ShovelerShaderKey* shaderKey,
+    uint64_t hash,
+    unsigned int* index);
+static bool isStale(ShovelerShaderCache* cache, const ShovelerShaderCacheEntry* entry);
+static void evictEntry(ShovelerShaderCache* cache, unsigned int index);
+static void removeEntry(ShovelerShaderCache* cache, unsigned int index);
+static void reserveEntry(ShovelerShaderCache* cache);
+static void rehash(ShovelerShaderCache* cache, unsigned int capacity);
+static unsigned int acquireHandle(ShovelerShaderCache* cache, KeyPart keyPart, void* pointer);
+static void invalidate(ShovelerShaderCache* cache, KeyPart keyPart, void* pointer);
 
 ShovelerShaderCache* shovelerShaderCacheCreate() {
   return shovelerShaderCacheCreateWithCustomFree(freeShader);
@@ -19,219 +45,300 @@ ShovelerShaderCache* shovelerShaderCacheCreate() {
 ShovelerShaderCache* shovelerShaderCacheCreateWithCustomFree(
     ShovelerShaderCacheFreeShaderFunction* freeShader) {
   ShovelerShaderCache* cache = malloc(sizeof(ShovelerShaderCache));
-  cache->shaders =
-      g_hash_table_new_full(shovelerShaderKeyHash, shovelerShaderKeyEqual, NULL, freeShader);
-  cache->sceneShaderKeys = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, freeSet);
-  cache->cameraShaderKeys = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, freeSet);
-  cache->lightShaderKeys = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, freeSet);
-  cache->modelShaderKeys = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, freeSet);
-  cache->materialShaderKeys = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, freeSet);
-  cache->userDataShaderKeys = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, freeSet);
+  cache->freeShader = freeShader;
+  cache->entries = calloc(INITIAL_CAPACITY, sizeof(ShovelerShaderCacheEntry));
+  cache->capacity = INITIAL_CAPACITY;
+  cache->numEntries = 0;
+  for (int i = 0; i < SHOVELER_SHADER_CACHE_NUM_KEY_PARTS; i++) {
+    cache->handles[i] = g_hash_table_new(g_direct_hash, g_direct_equal);
+  }
+  cache->generations = malloc(INITIAL_HANDLES_CAPACITY * sizeof(unsigned int));
+  cache->numHandles = 0;
+  cache->handlesCapacity = INITIAL_HANDLES_CAPACITY;
+  cache->freeHandles = malloc(INITIAL_HANDLES_CAPACITY * sizeof(unsigned int));
+  cache->numFreeHandles = 0;
 
   return cache;
 }
 
 void shovelerShaderCacheInsert(ShovelerShaderCache* cache, ShovelerShader* shader) {
-  g_hash_table_insert(cache->shaders, &shader->key, shader);
+  uint64_t hash = hashKey(&shader->key);
 
-  GHashTable* sceneKeys = g_hash_table_lookup(cache->sceneShaderKeys, shader->key.scene);
-  if (sceneKeys == NULL) {
-    sceneKeys = g_hash_table_new(shovelerShaderKeyHash, shovelerShaderKeyEqual);
-    g_hash_table_insert(cache->sceneShaderKeys, shader->key.scene, sceneKeys);
+  unsigned int index;
+  if (findEntry(cache, &shader->key, hash, &index)) {
+    // replace the previous shader for this key, whether it was still valid or not
+    ShovelerShaderCacheEntry* entry = &cache->entries[index];
+    if (entry->shader != shader && cache->freeShader != NULL) {
+      cache->freeShader(entry->shader);
+    }
+    removeEntry(cache, index);
   }
-  g_hash_table_add(sceneKeys, &shader->key);
 
-  GHashTable* cameraKeys = g_hash_table_lookup(cache->cameraShaderKeys, shader->key.camera);
-  if (cameraKeys == NULL) {
-    cameraKeys = g_hash_table_new(shovelerShaderKeyHash, shovelerShaderKeyEqual);
-    g_hash_table_insert(cache->cameraShaderKeys, shader->key.camera, cameraKeys);
-  }
-  g_hash_table_add(cameraKeys, &shader->key);
+  reserveEntry(cache);
 
-  GHashTable* lightKeys = g_hash_table_lookup(cache->lightShaderKeys, shader->key.light);
-  if (lightKeys == NULL) {
-    lightKeys = g_hash_table_new(shovelerShaderKeyHash, shovelerShaderKeyEqual);
-    g_hash_table_insert(cache->lightShaderKeys, shader->key.light, lightKeys);
-  }
-  g_hash_table_add(lightKeys, &shader->key);
+  ShovelerShaderCacheEntry entry;
+  entry.hash = hash;
+  entry.shader = shader;
 
-  GHashTable* modelKeys = g_hash_table_lookup(cache->modelShaderKeys, shader->key.model);
-  if (modelKeys == NULL) {
-    modelKeys = g_hash_table_new(shovelerShaderKeyHash, shovelerShaderKeyEqual);
-    g_hash_table_insert(cache->modelShaderKeys, shader->key.model, modelKeys);
+  void* keyParts[SHOVELER_SHADER_CACHE_NUM_KEY_PARTS];
+  getKeyParts(&shader->key, keyParts);
+  for (int i = 0; i < SHOVELER_SHADER_CACHE_NUM_KEY_PARTS; i++) {
+    entry.handles[i] = acquireHandle(cache, (KeyPart) i, keyParts[i]);
+    entry.generations[i] = cache->generations[entry.handles[i]];
   }
-  g_hash_table_add(modelKeys, &shader->key);
 
-  GHashTable* materialKeys = g_hash_table_lookup(cache->materialShaderKeys, shader->key.material);
-  if (materialKeys == NULL) {
-    materialKeys = g_hash_table_new(shovelerShaderKeyHash, shovelerShaderKeyEqual);
-    g_hash_table_insert(cache->materialShaderKeys, shader->key.material, materialKeys);
+  unsigned int mask = cache->capacity - 1;
+  index = hash & mask;
+  while (cache->entries[index].shader != NULL) {
+    index = (index + 1) & mask;
   }
-  g_hash_table_add(materialKeys, &shader->key);
 
-  GHashTable* userDataKeys = g_hash_table_lookup(cache->userDataShaderKeys, shader->key.userData);
-  if (userDataKeys == NULL) {
-    userDataKeys = g_hash_table_new(shovelerShaderKeyHash, shovelerShaderKeyEqual);
-    g_hash_table_insert(cache->userDataShaderKeys, shader->key.userData, userDataKeys);
-  }
-  g_hash_table_add(userDataKeys, &shader->key);
+  cache->entries[index] = entry;
+  cache->numEntries++;
 }
 
 bool shovelerShaderCacheRemove(ShovelerShaderCache* cache, const ShovelerShaderKey* shaderKey) {
-  ShovelerShader* shader = g_hash_table_lookup(cache->shaders, shaderKey);
-  if (shader == NULL) {
+  unsigned int index;
+  if (!findEntry(cache, shaderKey, hashKey(shaderKey), &index)) {
     return false;
   }
 
-  GHashTable* sceneKeys = g_hash_table_lookup(cache->sceneShaderKeys, shaderKey->scene);
-  assert(sceneKeys != NULL);
-  bool sceneKeyRemoved = g_hash_table_remove(sceneKeys, shaderKey);
-  assert(sceneKeyRemoved);
+  bool stale = isStale(cache, &cache->entries[index]);
+  evictEntry(cache, index);
 
-  GHashTable* cameraKeys = g_hash_table_lookup(cache->cameraShaderKeys, shaderKey->camera);
-  assert(cameraKeys != NULL);
-  bool cameraKeyRemoved = g_hash_table_remove(cameraKeys, shaderKey);
-  assert(cameraKeyRemoved);
+  // stale entries count as already removed by their invalidation
+  return !stale;
+}
+
+ShovelerShader* shovelerShaderCacheLookup(
+    ShovelerShaderCache* cache, const ShovelerShaderKey* shaderKey) {
+  unsigned int index;
+  if (!findEntry(cache, shaderKey, hashKey(shaderKey), &index)) {
+    return NULL;
+  }
 
-  GHashTable* lightKeys = g_hash_table_lookup(cache->lightShaderKeys, shaderKey->light);
-  assert(lightKeys != NULL);
-  bool lightKeyRemoved = g_hash_table_remove(lightKeys, shaderKey);
-  assert(lightKeyRemoved);
+  if (isStale(cache, &cache->entries[index])) {
+    evictEntry(cache, index);
+    return NULL;
+  }
 
-  GHashTable* modelKeys = g_hash_table_lookup(cache->modelShaderKeys, shaderKey->model);
-  assert(modelKeys != NULL);
-  bool modelKeyRemoved = g_hash_table_remove(modelKeys, shaderKey);
-  assert(modelKeyRemoved);
+  return cache->entries[index].shader;
+}
 
-  GHashTable* materialKeys = g_hash_table_lookup(cache->materialShaderKeys, shaderKey->material);
-  assert(materialKeys != NULL);
-  bool materialKeyRemoved = g_hash_table_remove(materialKeys, shaderKey);
-  assert(materialKeyRemoved);
+void shovelerShaderCacheInvalidateScene(ShovelerShaderCache* cache, ShovelerScene* scene) {
+  invalidate(cache, KEY_PART_SCENE, scene);
+}
 
-  GHashTable* userDataKeys = g_hash_table_lookup(cache->userDataShaderKeys, shaderKey->userData);
-  assert(userDataKeys != NULL);
-  bool userDataKeyRemoved = g_hash_table_remove(userDataKeys, shaderKey);
-  assert(userDataKeyRemoved);
+void shovelerShaderCacheInvalidateCamera(ShovelerShaderCache* cache, ShovelerCamera* camera) {
+  invalidate(cache, KEY_PART_CAMERA, camera);
+}
 
-  // make sure we remove the shader itself last, because the key tables use the shader key from the
-  // stored shader
-  g_hash_table_remove(cache->shaders, shaderKey);
-  return true;
+void shovelerShaderCacheInvalidateLight(ShovelerShaderCache* cache, ShovelerLight* light) {
+  invalidate(cache, KEY_PART_LIGHT, light);
 }
 
-ShovelerShader* shovelerShaderCacheLookup(
-    ShovelerShaderCache* cache, const ShovelerShaderKey* shaderKey) {
-  return g_hash_table_lookup(cache->shaders, shaderKey);
-}
-
-void shovelerShaderCacheInvalidateScene(
-    ShovelerShaderCache* cache, struct ShovelerSceneStruct* scene) {
-  GHashTable* sceneKeys = g_hash_table_lookup(cache->sceneShaderKeys, scene);
-  if (sceneKeys != NULL) {
-    // get keys list because the keys set will be modified while we iterate over the list
-    GList* sceneKeysList = g_hash_table_get_keys(sceneKeys);
-    for (GList* iter = sceneKeysList; iter != NULL; iter = iter->next) {
-      const ShovelerShaderKey* shaderKey = iter->data;
-      bool removed = shovelerShaderCacheRemove(cache, shaderKey);
-      assert(removed);
+void shovelerShaderCacheInvalidateModel(ShovelerShaderCache* cache, ShovelerModel* model) {
+  invalidate(cache, KEY_PART_MODEL, model);
+}
+
+void shovelerShaderCacheInvalidateMaterial(ShovelerShaderCache* cache, ShovelerMaterial* material) {
+  invalidate(cache, KEY_PART_MATERIAL, material);
+}
+
+void shovelerShaderCacheInvalidateUserData(ShovelerShaderCache* cache, void* userData) {
+  invalidate(cache, KEY_PART_USER_DATA, userData);
+}
+
+void shovelerShaderCacheFree(ShovelerShaderCache* cache) {
+  if (cache->freeShader != NULL) {
+    for (unsigned int i = 0; i < cache->capacity; i++) {
+      if (cache->entries[i].shader != NULL) {
+        cache->freeShader(cache->entries[i].shader);
+      }
     }
-    g_list_free(sceneKeysList);
-    g_hash_table_remove(cache->sceneShaderKeys, scene);
   }
+
+  free(cache->freeHandles);
+  free(cache->generations);
+  for (int i = 0; i < SHOVELER_SHADER_CACHE_NUM_KEY_PARTS; i++) {
+    g_hash_table_destroy(cache->handles[i]);
+  }
+  free(cache->entries);
+  free(cache);
 }
 
-void shovelerShaderCacheInvalidateCamera(ShovelerShaderCache* cache, ShovelerCamera* camera) {
-  GHashTable* cameraKeys = g_hash_table_lookup(cache->cameraShaderKeys, camera);
-  if (cameraKeys != NULL) {
-    // get keys list because the keys set will be modified while we iterate over the list
-    GList* cameraKeysList = g_hash_table_get_keys(cameraKeys);
-    for (GList* iter = cameraKeysList; iter != NULL; iter = iter->next) {
-      const ShovelerShaderKey* shaderKey = iter->data;
-      bool removed = shovelerShaderCacheRemove(cache, shaderKey);
-      assert(removed);
-    }
-    g_list_free(cameraKeysList);
-    g_hash_table_remove(cache->cameraShaderKeys, camera);
+static void freeShader(void* shaderPointer) {
+  ShovelerShader* shader = shaderPointer;
+  shovelerShaderFree(shader);
+}
+
+static void getKeyParts(
+    const ShovelerShaderKey* shaderKey, void* keyParts[SHOVELER_SHADER_CACHE_NUM_KEY_PARTS]) {
+  keyParts[KEY_PART_SCENE] = shaderKey->scene;
+  keyParts[KEY_PART_CAMERA] = shaderKey->camera;
+  keyParts[KEY_PART_LIGHT] = shaderKey->light;
+  keyParts[KEY_PART_MODEL] = shaderKey->model;
+  keyParts[KEY_PART_MATERIAL] = shaderKey->material;
+  keyParts[KEY_PART_USER_DATA] = shaderKey->userData;
+}
+
+static uint64_t hashKey(const ShovelerShaderKey* shaderKey) {
+  void* keyParts[SHOVELER_SHADER_CACHE_NUM_KEY_PARTS];
+  getKeyParts(shaderKey, keyParts);
+
+  // multiplicative mixing of each pointer, with a final avalanche so the low bits used for
+  // probing depend on all of them
+  uint64_t hash = 0;
+  for (int i = 0; i < SHOVELER_SHADER_CACHE_NUM_KEY_PARTS; i++) {
+    hash = (hash ^ (uint64_t) (uintptr_t) keyParts[i]) * UINT64_C(0x9e3779b97f4a7c15);
+    hash ^= hash >> 29;
   }
+  hash ^= hash >> 32;
+  hash *= UINT64_C(0xd6e8feb86659fd93);
+  hash ^= hash >> 32;
+
+  return hash;
 }
 
-void shovelerShaderCacheInvalidateLight(ShovelerShaderCache* cache, ShovelerLight* light) {
-  GHashTable* lightKeys = g_hash_table_lookup(cache->lightShaderKeys, light);
-  if (lightKeys != NULL) {
-    // get keys list because the keys set will be modified while we iterate over the list
-    GList* lightKeysList = g_hash_table_get_keys(lightKeys);
-    for (GList* iter = lightKeysList; iter != NULL; iter = iter->next) {
-      const ShovelerShaderKey* shaderKey = iter->data;
-      bool removed = shovelerShaderCacheRemove(cache, shaderKey);
-      assert(removed);
+static bool findEntry(
+    ShovelerShaderCache* cache,
+    const ShovelerShaderKey* shaderKey,
+    uint64_t hash,
+    unsigned int* index) {
+  unsigned int mask = cache->capacity - 1;
+  for (unsigned int i = hash & mask; cache->entries[i].shader != NULL; i = (i + 1) & mask) {
+    const ShovelerShaderCacheEntry* entry = &cache->entries[i];
+    if (entry->hash == hash &&
+        memcmp(&entry->shader->key, shaderKey, sizeof(ShovelerShaderKey)) == 0) {
+      *index = i;
+      return true;
     }
-    g_list_free(lightKeysList);
-    g_hash_table_remove(cache->lightShaderKeys, light);
   }
+
+  return false;
 }
 
-void shovelerShaderCacheInvalidateModel(ShovelerShaderCache* cache, ShovelerModel* model) {
-  GHashTable* modelKeys = g_hash_table_lookup(cache->modelShaderKeys, model);
-  if (modelKeys != NULL) {
-    // get keys list because the keys set will be modified while we iterate over the list
-    GList* modelKeysList = g_hash_table_get_keys(modelKeys);
-    for (GList* iter = modelKeysList; iter != NULL; iter = iter->next) {
-      const ShovelerShaderKey* shaderKey = iter->data;
-      bool removed = shovelerShaderCacheRemove(cache, shaderKey);
-      assert(removed);
+static bool isStale(ShovelerShaderCache* cache, const ShovelerShaderCacheEntry* entry) {
+  for (int i = 0; i < SHOVELER_SHADER_CACHE_NUM_KEY_PARTS; i++) {
+    if (cache->generations[entry->handles[i]] != entry->generations[i]) {
+      return true;
     }
-    g_list_free(modelKeysList);
-    g_hash_table_remove(cache->modelShaderKeys, model);
   }
+
+  return false;
 }
 
-void shovelerShaderCacheInvalidateMaterial(ShovelerShaderCache* cache, ShovelerMaterial* material) {
-  GHashTable* materialKeys = g_hash_table_lookup(cache->materialShaderKeys, material);
-  if (materialKeys != NULL) {
-    // get keys list because the keys set will be modified while we iterate over the list
-    GList* materialKeysList = g_hash_table_get_keys(materialKeys);
-    for (GList* iter = materialKeysList; iter != NULL; iter = iter->next) {
-      const ShovelerShaderKey* shaderKey = iter->data;
-      bool removed = shovelerShaderCacheRemove(cache, shaderKey);
-      assert(removed);
+static void evictEntry(ShovelerShaderCache* cache, unsigned int index) {
+  if (cache->freeShader != NULL) {
+    cache->freeShader(cache->entries[index].shader);
+  }
+
+  removeEntry(cache, index);
+}
+
+/** Removes an entry by shifting back the entries probed past it, so no tombstones are needed. */
+static void removeEntry(ShovelerShaderCache* cache, unsigned int index) {
+  unsigned int mask = cache->capacity - 1;
+  unsigned int hole = index;
+  for (unsigned int i = (index + 1) & mask; cache->entries[i].shader != NULL; i = (i + 1) & mask) {
+    // an entry can fill the hole if the hole lies between its home bucket and where it is now
+    unsigned int home = cache->entries[i].hash & mask;
+    if (((i - home) & mask) >= ((i - hole) & mask)) {
+      cache->entries[hole] = cache->entries[i];
+      hole = i;
     }
-    g_list_free(materialKeysList);
-    g_hash_table_remove(cache->materialShaderKeys, material);
   }
+
+  cache->entries[hole].shader = NULL;
+  cache->numEntries--;
 }
 
-void shovelerShaderCacheInvalidateUserData(ShovelerShaderCache* cache, void* userData) {
-  GHashTable* userDataKeys = g_hash_table_lookup(cache->userDataShaderKeys, userData);
-  if (userDataKeys != NULL) {
-    // get keys list because the keys set will be modified while we iterate over the list
-    GList* userDataKeysList = g_hash_table_get_keys(userDataKeys);
-    for (GList* iter = userDataKeysList; iter != NULL; iter = iter->next) {
-      const ShovelerShaderKey* shaderKey = iter->data;
-      bool removed = shovelerShaderCacheRemove(cache, shaderKey);
-      assert(removed);
+/** Makes room for one more entry, evicting all stale entries first if the table is too full. */
+static void reserveEntry(ShovelerShaderCache* cache) {
+  if (4 * (cache->numEntries + 1) <= 3 * cache->capacity) {
+    return;
+  }
+
+  for (unsigned int i = 0; i < cache->capacity; i++) {
+    ShovelerShaderCacheEntry* entry = &cache->entries[i];
+    if (entry->shader != NULL && isStale(cache, entry)) {
+      if (cache->freeShader != NULL) {
+        cache->freeShader(entry->shader);
+      }
+      entry->shader = NULL;
+      cache->numEntries--;
     }
-    g_list_free(userDataKeysList);
-    g_hash_table_remove(cache->userDataShaderKeys, userData);
   }
+
+  unsigned int capacity = cache->capacity;
+  while (4 * (cache->numEntries + 1) > 3 * capacity) {
+    capacity *= 2;
+  }
+
+  // rehash even at the same capacity, since evicting above left holes in probe sequences
+  rehash(cache, capacity);
 }
 
-void shovelerShaderCacheFree(ShovelerShaderCache* cache) {
-  g_hash_table_destroy(cache->userDataShaderKeys);
-  g_hash_table_destroy(cache->materialShaderKeys);
-  g_hash_table_destroy(cache->modelShaderKeys);
-  g_hash_table_destroy(cache->lightShaderKeys);
-  g_hash_table_destroy(cache->cameraShaderKeys);
-  g_hash_table_destroy(cache->sceneShaderKeys);
-  g_hash_table_destroy(cache->shaders);
-  free(cache);
+static void rehash(ShovelerShaderCache* cache, unsigned int capacity) {
+  ShovelerShaderCacheEntry* entries = calloc(capacity, sizeof(ShovelerShaderCacheEntry));
+  unsigned int mask = capacity - 1;
+
+  for (unsigned int i = 0; i < cache->capacity; i++) {
+    const ShovelerShaderCacheEntry* entry = &cache->entries[i];
+    if (entry->shader == NULL) {
+      continue;
+    }
+
+    unsigned int index = entry->hash & mask;
+    while (entries[index].shader != NULL) {
+      index = (index + 1) & mask;
+    }
+    entries[index] = *entry;
+  }
+
+  free(cache->entries);
+  cache->entries = entries;
+  cache->capacity = capacity;
 }
 
-static void freeShader(void* shaderPointer) {
-  ShovelerShader* shader = shaderPointer;
-  shovelerShaderFree(shader);
+static unsigned int acquireHandle(ShovelerShaderCache* cache, KeyPart keyPart, void* pointer) {
+  // handles are stored offset by one so that a missing pointer can be told apart from handle 0
+  uintptr_t storedHandle = (uintptr_t) g_hash_table_lookup(cache->handles[keyPart], pointer);
+  if (storedHandle != 0) {
+    return (unsigned int) (storedHandle - 1);
+  }
+
+  unsigned int handle;
+  if (cache->numFreeHandles > 0) {
+    handle = cache->freeHandles[--cache->numFreeHandles];
+  } else {
+    if (cache->numHandles == cache->handlesCapacity) {
+      cache->handlesCapacity *= 2;
+      cache->generations =
+          realloc(cache->generations, cache->handlesCapacity * sizeof(unsigned int));
+      cache->freeHandles =
+          realloc(cache->freeHandles, cache->handlesCapacity * sizeof(unsigned int));
+    }
+
+    handle = cache->numHandles++;
+    cache->generations[handle] = 0;
+  }
+
+  g_hash_table_insert(cache->handles[keyPart], pointer, (void*) ((uintptr_t) handle + 1));
+  return handle;
 }
 
-static void freeSet(void* setPointer) {
-  GHashTable* set = setPointer;
-  g_hash_table_destroy(set);
+static void invalidate(ShovelerShaderCache* cache, KeyPart keyPart, void* pointer) {
+  uintptr_t storedHandle = (uintptr_t) g_hash_table_lookup(cache->handles[keyPart], pointer);
+  if (storedHandle == 0) {
+    return;
+  }
+
+  // The pointer gives up its handle, since it is usually invalidated because its object is freed
+  // and the address may be reused. Bumping the generation makes every entry using the handle
+  // stale, including once it is handed out again.
+  unsigned int handle = (unsigned int) (storedHandle - 1);
+  g_hash_table_remove(cache->handles[keyPart], pointer);
+  cache->generations[handle]++;
+  cache->freeHandles[cache->numFreeHandles++] = handle;
 }
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <cstdio>
 #include <string>
+#include <vector>
 
 extern "C" {
 #include "shoveler/camera.h"
@@ -169,3 +171,134 @@ TEST_F(ShovelerShaderCacheTest, invalidateUserData) {
   ShovelerShader* lookup3 = shovelerShaderCacheLookup(cache, &shaderKey3);
   ASSERT_TRUE(lookup3 == NULL);
 }
+
+TEST_F(ShovelerShaderCacheTest, reinsertAfterInvalidate) {
+  // the model is invalidated and another one allocated at the same address
+  shovelerShaderCacheInsert(cache, &shader);
+  shovelerShaderCacheInvalidateModel(cache, &model);
+  ASSERT_TRUE(shovelerShaderCacheLookup(cache, &shaderKey) == NULL);
+  ASSERT_FALSE(shovelerShaderCacheRemove(cache, &shaderKey));
+
+  shovelerShaderCacheInsert(cache, &shader);
+  ASSERT_EQ(shovelerShaderCacheLookup(cache, &shaderKey), &shader);
+  ShovelerShader* lookup2 = shovelerShaderCacheLookup(cache, &shaderKey2);
+  ASSERT_TRUE(lookup2 == NULL);
+}
+
+TEST_F(ShovelerShaderCacheTest, invalidateSharedAddress) {
+  // user data may point anywhere, including at another part of the key
+  ShovelerShaderKey shaderKey3 = {NULL, NULL, NULL, NULL, NULL, (void*) &scene};
+  ShovelerShader shader3;
+  shader3.key = shaderKey3;
+
+  shovelerShaderCacheInsert(cache, &shader);
+  shovelerShaderCacheInsert(cache, &shader3);
+  shovelerShaderCacheInvalidateUserData(cache, &scene);
+
+  ShovelerShader* lookup = shovelerShaderCacheLookup(cache, &shaderKey);
+  ASSERT_EQ(lookup, &shader);
+  ShovelerShader* lookup3 = shovelerShaderCacheLookup(cache, &shaderKey3);
+  ASSERT_TRUE(lookup3 == NULL);
+}
+
+static int numFreedShaders = 0;
+
+static void countFreedShader(void* shaderPointer) { numFreedShaders++; }
+
+TEST_F(ShovelerShaderCacheTest, manyShaders) {
+  const int numShaders = 1000;
+  std::vector<ShovelerModel> models(numShaders);
+  std::vector<ShovelerShader> shaders(numShaders);
+
+  numFreedShaders = 0;
+  ShovelerShaderCache* countingCache = shovelerShaderCacheCreateWithCustomFree(countFreedShader);
+
+  for (int i = 0; i < numShaders; i++) {
+    shaders[i].key = {&scene, &camera, &light, &models[i], &material, NULL};
+    shovelerShaderCacheInsert(countingCache, &shaders[i]);
+  }
+
+  for (int i = 0; i < numShaders; i += 2) {
+    ASSERT_TRUE(shovelerShaderCacheRemove(countingCache, &shaders[i].key));
+  }
+  ASSERT_EQ(numFreedShaders, numShaders / 2);
+
+  for (int i = 0; i < numShaders; i++) {
+    ShovelerShader* lookup = shovelerShaderCacheLookup(countingCache, &shaders[i].key);
+    if (i % 2 == 0) {
+      ASSERT_TRUE(lookup == NULL) << i;
+    } else {
+      ASSERT_EQ(lookup, &shaders[i]) << i;
+    }
+  }
+
+  // stale shaders are only evicted lazily, but still freed exactly once
+  shovelerShaderCacheInvalidateCamera(countingCache, &camera);
+  ASSERT_TRUE(shovelerShaderCacheLookup(countingCache, &shaders[1].key) == NULL);
+  ASSERT_EQ(numFreedShaders, numShaders / 2 + 1);
+
+  shovelerShaderCacheFree(countingCache);
+  ASSERT_EQ(numFreedShaders, numShaders);
+}
+
+/**
+ * Measures inserting, looking up and invalidating shaders for a scene of many models, as a
+ * baseline against which changes to the cache can be compared. Run it explicitly with
+ * --gtest_also_run_disabled_tests --gtest_filter=*benchmark, it prints one JSON line per
+ * operation.
+ */
+TEST_F(ShovelerShaderCacheTest, DISABLED_benchmark) {
+  const int numModels = 10000;
+  const int numLookupRounds = 100;
+  std::vector<ShovelerModel> models(numModels);
+  std::vector<ShovelerShader> shaders(numModels);
+  for (int i = 0; i < numModels; i++) {
+    shaders[i].key = {&scene, &camera, &light, &models[i], &material, NULL};
+  }
+
+  ShovelerShaderCache* benchmarkCache = shovelerShaderCacheCreateWithCustomFree(NULL);
+
+  auto printMeasurement = [](const char* operation, int numOperations, gint64 startTime) {
+    double elapsedNs = (double) (g_get_monotonic_time() - startTime) * 1000.0;
+    printf(
+        "{\"benchmark\": \"shader_cache\", \"operation\": \"%s\", \"operations\": %d, "
+        "\"ns_per_operation\": %.1f}\n",
+        operation,
+        numOperations,
+        elapsedNs / numOperations);
+  };
+
+  gint64 startTime = g_get_monotonic_time();
+  for (int i = 0; i < numModels; i++) {
+    shovelerShaderCacheInsert(benchmarkCache, &shaders[i]);
+  }
+  printMeasurement("insert", numModels, startTime);
+
+  startTime = g_get_monotonic_time();
+  int numFound = 0;
+  for (int round = 0; round < numLookupRounds; round++) {
+    for (int i = 0; i < numModels; i++) {
+      numFound += shovelerShaderCacheLookup(benchmarkCache, &shaders[i].key) != NULL;
+    }
+  }
+  printMeasurement("lookup", numLookupRounds * numModels, startTime);
+  ASSERT_EQ(numFound, numLookupRounds * numModels);
+
+  startTime = g_get_monotonic_time();
+  for (int i = 0; i < numModels; i++) {
+    shovelerShaderCacheInvalidateModel(benchmarkCache, &models[i]);
+  }
+  printMeasurement("invalidate_model", numModels, startTime);
+
+  startTime = g_get_monotonic_time();
+  for (int i = 0; i < numModels; i++) {
+    shovelerShaderCacheInsert(benchmarkCache, &shaders[i]);
+  }
+  printMeasurement("reinsert_after_invalidate", numModels, startTime);
+
+  startTime = g_get_monotonic_time();
+  shovelerShaderCacheInvalidateScene(benchmarkCache, &scene);
+  printMeasurement("invalidate_scene", 1, startTime);
+
+  shovelerShaderCacheFree(benchmarkCache);
+}
@@ -0,0 +1,153 @@
+#include "shoveler/text_texture_cache.h"
+
+#include <assert.h> // assert
+#include <stdlib.h> // malloc free
+#include <string.h> // strcmp strdup
+
+#include "shoveler/hash.h"
+
+static guint hashKey(gconstpointer keyPointer);
+static gboolean equalKeys(gconstpointer firstKeyPointer, gconstpointer secondKeyPointer);
+static void evictUnreferenced(ShovelerTextTextureCache* cache);
+static void freeEntry(ShovelerTextTextureCache* cache, ShovelerTextTextureCacheEntry* entry);
+
+ShovelerTextTextureCache* shovelerTextTextureCacheCreate(
+    size_t budgetBytes,
+    ShovelerTextTextureCacheFreeTextureFunction* freeTexture,
+    void* freeTextureUserData) {
+  ShovelerTextTextureCache* cache = malloc(sizeof(ShovelerTextTextureCache));
+  cache->budgetBytes = budgetBytes;
+  cache->numBytes = 0;
+  cache->entries = g_hash_table_new(hashKey, equalKeys);
+  cache->textureEntries = g_hash_table_new(g_direct_hash, g_direct_equal);
+  cache->unreferencedEntries = g_queue_new();
+  cache->freeTexture = freeTexture;
+  cache->freeTextureUserData = freeTextureUserData;
+  cache->numHits = 0;
+  cache->numMisses = 0;
+  cache->numEvictions = 0;
+
+  return cache;
+}
+
+ShovelerTexture* shovelerTextTextureCacheAcquire(
+    ShovelerTextTextureCache* cache, const char* text, ShovelerFontAtlas* fontAtlas, int fontSize) {
+  ShovelerTextTextureCacheKey key;
+  key.text = (char*) text; // won't be modified
+  key.fontAtlas = fontAtlas;
+  key.fontSize = fontSize;
+
+  ShovelerTextTextureCacheEntry* entry = g_hash_table_lookup(cache->entries, &key);
+  if (entry == NULL) {
+    cache->numMisses++;
+    return NULL;
+  }
+
+  if (entry->numReferences == 0) {
+    g_queue_delete_link(cache->unreferencedEntries, entry->unreferencedLink);
+    entry->unreferencedLink = NULL;
+  }
+
+  entry->numReferences++;
+  cache->numHits++;
+  return entry->texture;
+}
+
+ShovelerTexture* shovelerTextTextureCacheInsert(
+    ShovelerTextTextureCache* cache,
+    const char* text,
+    ShovelerFontAtlas* fontAtlas,
+    int fontSize,
+    ShovelerTexture* texture,
+    size_t numBytes) {
+  ShovelerTextTextureCacheEntry* entry = malloc(sizeof(ShovelerTextTextureCacheEntry));
+  entry->key.text = strdup(text);
+  entry->key.fontAtlas = fontAtlas;
+  entry->key.fontSize = fontSize;
+  entry->texture = texture;
+  entry->numBytes = numBytes;
+  entry->numReferences = 1;
+  entry->unreferencedLink = NULL;
+
+  assert(!g_hash_table_contains(cache->entries, &entry->key));
+  assert(!g_hash_table_contains(cache->textureEntries, texture));
+  g_hash_table_insert(cache->entries, &entry->key, entry);
+  g_hash_table_insert(cache->textureEntries, texture, entry);
+  cache->numBytes += numBytes;
+
+  evictUnreferenced(cache);
+
+  return texture;
+}
+
+bool shovelerTextTextureCacheRelease(ShovelerTextTextureCache* cache, ShovelerTexture* texture) {
+  ShovelerTextTextureCacheEntry* entry = g_hash_table_lookup(cache->textureEntries, texture);
+  if (entry == NULL) {
+    return false;
+  }
+
+  assert(entry->numReferences > 0);
+  entry->numReferences--;
+  if (entry->numReferences == 0) {
+    g_queue_push_tail(cache->unreferencedEntries, entry);
+    entry->unreferencedLink = g_queue_peek_tail_link(cache->unreferencedEntries);
+    evictUnreferenced(cache);
+  }
+
+  return true;
+}
+
+void shovelerTextTextureCacheFree(ShovelerTextTextureCache* cache) {
+  if (cache == NULL) {
+    return;
+  }
+
+  GHashTableIter iter;
+  ShovelerTextTextureCacheEntry* entry;
+  g_hash_table_iter_init(&iter, cache->entries);
+  while (g_hash_table_iter_next(&iter, NULL, (gpointer*) &entry)) {
+    freeEntry(cache, entry);
+  }
+
+  g_queue_free(cache->unreferencedEntries);
+  g_hash_table_destroy(cache->textureEntries);
+  g_hash_table_destroy(cache->entries);
+  free(cache);
+}
+
+static guint hashKey(gconstpointer keyPointer) {
+  const ShovelerTextTextureCacheKey* key = keyPointer;
+
+  return shovelerHashCombine(
+      g_str_hash(key->text),
+      shovelerHashCombine(g_direct_hash(key->fontAtlas), g_int_hash(&key->fontSize)));
+}
+
+static gboolean equalKeys(gconstpointer firstKeyPointer, gconstpointer secondKeyPointer) {
+  const ShovelerTextTextureCacheKey* firstKey = firstKeyPointer;
+  const ShovelerTextTextureCacheKey* secondKey = secondKeyPointer;
+
+  return firstKey->fontAtlas == secondKey->fontAtlas &&
+      firstKey->fontSize == secondKey->fontSize && strcmp(firstKey->text, secondKey->text) == 0;
+}
+
+static void evictUnreferenced(ShovelerTextTextureCache* cache) {
+  while (cache->numBytes > cache->budgetBytes &&
+         !g_queue_is_empty(cache->unreferencedEntries)) {
+    ShovelerTextTextureCacheEntry* entry = g_queue_pop_head(cache->unreferencedEntries);
+    entry->unreferencedLink = NULL;
+
+    g_hash_table_remove(cache->entries, &entry->key);
+    g_hash_table_remove(cache->textureEntries, entry->texture);
+    cache->numBytes -= entry->numBytes;
+    cache->numEvictions++;
+
+    freeEntry(cache, entry);
+  }
+}
+
+static void freeEntry(ShovelerTextTextureCache* cache, ShovelerTextTextureCacheEntry* entry) {
+  cache->freeTexture(entry->texture, cache->freeTextureUserData);
+  free(entry->key.text);
+  free(entry);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+extern "C" {
+#include "shoveler/text_texture_cache.h"
+#include "shoveler/texture.h"
+}
+
+static void freeTexture(ShovelerTexture* texture, void* testPointer);
+
+class ShovelerTextTextureCacheTest : public ::testing::Test {
+public:
+  virtual void SetUp() {
+    fontAtlas = (ShovelerFontAtlas*) &fontAtlasStorage;
+    otherFontAtlas = (ShovelerFontAtlas*) &otherFontAtlasStorage;
+    cache = shovelerTextTextureCacheCreate(/* budgetBytes */ 100, freeTexture, this);
+  }
+
+  virtual void TearDown() { shovelerTextTextureCacheFree(cache); }
+
+  ShovelerTexture* insert(const char* text, ShovelerTexture* texture, size_t numBytes) {
+    return shovelerTextTextureCacheInsert(cache, text, fontAtlas, 12, texture, numBytes);
+  }
+
+  int fontAtlasStorage;
+  int otherFontAtlasStorage;
+  ShovelerFontAtlas* fontAtlas;
+  ShovelerFontAtlas* otherFontAtlas;
+  ShovelerTexture textures[4];
+  std::vector<ShovelerTexture*> freedTextures;
+
+  ShovelerTextTextureCache* cache;
+};
+
+TEST_F(ShovelerTextTextureCacheTest, hitAfterInsert) {
+  ASSERT_TRUE(shovelerTextTextureCacheAcquire(cache, "foo", fontAtlas, 12) == NULL);
+  ASSERT_EQ(insert("foo", &textures[0], 10), &textures[0]);
+
+  ShovelerTexture* texture = shovelerTextTextureCacheAcquire(cache, "foo", fontAtlas, 12);
+  ASSERT_EQ(texture, &textures[0]);
+  ASSERT_EQ(cache->numHits, 1);
+  ASSERT_EQ(cache->numMisses, 1);
+  ASSERT_EQ(g_hash_table_size(cache->entries), 1);
+}
+
+TEST_F(ShovelerTextTextureCacheTest, keyIncludesFontAtlasAndSize) {
+  insert("foo", &textures[0], 10);
+
+  ASSERT_TRUE(shovelerTextTextureCacheAcquire(cache, "bar", fontAtlas, 12) == NULL);
+  ASSERT_TRUE(shovelerTextTextureCacheAcquire(cache, "foo", otherFontAtlas, 12) == NULL);
+  ASSERT_TRUE(shovelerTextTextureCacheAcquire(cache, "foo", fontAtlas, 13) == NULL);
+  ASSERT_EQ(cache->numMisses, 3);
+  ASSERT_EQ(cache->numHits, 0);
+}
+
+TEST_F(ShovelerTextTextureCacheTest, keepsReleasedWithinBudget) {
+  insert("foo", &textures[0], 60);
+  ASSERT_TRUE(shovelerTextTextureCacheRelease(cache, &textures[0]));
+
+  ASSERT_TRUE(freedTextures.empty());
+  ASSERT_EQ(shovelerTextTextureCacheAcquire(cache, "foo", fontAtlas, 12), &textures[0]);
+  ASSERT_EQ(cache->numEvictions, 0);
+}
+
+TEST_F(ShovelerTextTextureCacheTest, neverEvictsReferenced) {
+  insert("foo", &textures[0], 60);
+  insert("bar", &textures[1], 60);
+
+  ASSERT_TRUE(freedTextures.empty());
+  ASSERT_EQ(cache->numBytes, 120);
+
+  // releasing any of them brings the cache back within budget
+  shovelerTextTextureCacheRelease(cache, &textures[1]);
+  ASSERT_EQ(freedTextures.size(), 1);
+  ASSERT_EQ(freedTextures[0], &textures[1]);
+  ASSERT_EQ(cache->numBytes, 60);
+  ASSERT_EQ(cache->numEvictions, 1);
+}
+
+TEST_F(ShovelerTextTextureCacheTest, evictsLeastRecentlyReleased) {
+  insert("first", &textures[0], 40);
+  insert("second", &textures[1], 40);
+  shovelerTextTextureCacheRelease(cache, &textures[0]);
+  shovelerTextTextureCacheRelease(cache, &textures[1]);
+
+  // reacquiring and releasing the first makes the second the least recently released
+  shovelerTextTextureCacheAcquire(cache, "first", fontAtlas, 12);
+  shovelerTextTextureCacheRelease(cache, &textures[0]);
+
+  insert("third", &textures[2], 40);
+  ASSERT_EQ(freedTextures.size(), 1);
+  ASSERT_EQ(freedTextures[0], &textures[1]);
+  ASSERT_TRUE(shovelerTextTextureCacheAcquire(cache, "second", fontAtlas, 12) == NULL);
+  ASSERT_EQ(shovelerTextTextureCacheAcquire(cache, "first", fontAtlas, 12), &textures[0]);
+}
+
+TEST_F(ShovelerTextTextureCacheTest, countsReferences) {
+  insert("foo", &textures[0], 60);
+  shovelerTextTextureCacheAcquire(cache, "foo", fontAtlas, 12);
+  insert("bar", &textures[1], 60);
+  shovelerTextTextureCacheRelease(cache, &textures[1]);
+  ASSERT_EQ(freedTextures.size(), 1);
+
+  // one reference is still held after the first release
+  shovelerTextTextureCacheRelease(cache, &textures[0]);
+  ASSERT_EQ(shovelerTextTextureCacheAcquire(cache, "foo", fontAtlas, 12), &textures[0]);
+  ASSERT_EQ(freedTextures.size(), 1);
+}
+
+TEST_F(ShovelerTextTextureCacheTest, releaseUnknown) {
+  ASSERT_FALSE(shovelerTextTextureCacheRelease(cache, &textures[0]));
+}
+
+TEST_F(ShovelerTextTextureCacheTest, freeReleasesAll) {
+  insert("foo", &textures[0], 10);
+  insert("bar", &textures[1], 10);
+  shovelerTextTextureCacheRelease(cache, &textures[1]);
+
+  shovelerTextTextureCacheFree(cache);
+  ASSERT_EQ(freedTextures.size(), 2);
+
+  cache = shovelerTextTextureCacheCreate(/* budgetBytes */ 100, freeTexture, this);
+}
+
+static void freeTexture(ShovelerTexture* texture, void* testPointer) {
+  ShovelerTextTextureCacheTest* test = (ShovelerTextTextureCacheTest*) testPointer;
+  test->freedTextures.push_back(texture);
+}
@@ -1,5 +1,6 @@
 #include "shoveler/text_texture_renderer.h"
 
+#include <assert.h> // assert
 #include <math.h> // ceilf
 #include <stdlib.h> // malloc free
 #include <string.h> // strdup
@@ -8,14 +9,18 @@
 #include "shoveler/font_atlas.h"
 #include "shoveler/font_atlas_texture.h"
 #include "shoveler/framebuffer.h"
+#include "shoveler/framebuffer_pool.h"
 #include "shoveler/material/canvas.h"
 #include "shoveler/material/text.h"
 #include "shoveler/model.h"
 #include "shoveler/scene.h"
 #include "shoveler/shader_cache.h"
 #include "shoveler/sprite/text.h"
+#include "shoveler/text_texture_cache.h"
 #include "shoveler/texture.h"
 
+static void freeCachedTexture(ShovelerTexture* texture, void* rendererPointer);
+
 ShovelerTextTextureRenderer* shovelerTextTextureRendererCreate(
     ShovelerFontAtlasTexture* fontAtlasTexture, ShovelerShaderCache* shaderCache) {
   ShovelerTextTextureRenderer* renderer = malloc(sizeof(ShovelerTextTextureRenderer));
@@ -36,11 +41,26 @@ ShovelerTextTextureRenderer* shovelerTextTextureRendererCreate(
   shovelerCanvasAddSprite(renderer->textCanvas, /* layerId */ 0, renderer->textSprite);
   shovelerMaterialCanvasSetActive(renderer->canvasMaterial, renderer->textCanvas);
 
+  renderer->textureCache = shovelerTextTextureCacheCreate(
+      SHOVELER_TEXT_TEXTURE_RENDERER_CACHE_BUDGET_BYTES, freeCachedTexture, renderer);
+  renderer->framebufferPool = shovelerFramebufferPoolCreate(
+      /* channels */ 1,
+      /* bitsPerChannel */ 8,
+      SHOVELER_TEXT_TEXTURE_RENDERER_MAX_POOLED_FRAMEBUFFERS_PER_BUCKET);
+  renderer->textureFramebuffers = g_hash_table_new(g_direct_hash, g_direct_equal);
+
   return renderer;
 }
 
 ShovelerTexture* shovelerTextTextureRendererRender(
     ShovelerTextTextureRenderer* renderer, const char* text, ShovelerRenderState* renderState) {
+  ShovelerFontAtlas* fontAtlas = renderer->fontAtlasTexture->fontAtlas;
+  ShovelerTexture* cachedTexture =
+      shovelerTextTextureCacheAcquire(renderer->textureCache, text, fontAtlas, fontAtlas->fontSize);
+  if (cachedTexture != NULL) {
+    return cachedTexture;
+  }
+
   float currentWidth = 0.0f;
   float currentHeightTop = 0.0f;
   float currentHeightBottom = 0.0f;
@@ -51,8 +71,7 @@ ShovelerTexture* shovelerTextTextureRendererRender(
 
     currentWidth = currentOriginX;
 
-    ShovelerFontAtlasGlyph* glyph =
-        shovelerFontAtlasGetGlyph(renderer->fontAtlasTexture->fontAtlas, character);
+    ShovelerFontAtlasGlyph* glyph = shovelerFontAtlasGetGlyph(fontAtlas, character);
 
     currentWidth += glyph->bearingX;
     currentWidth += glyph->width;
@@ -81,15 +100,28 @@ ShovelerTexture* shovelerTextTextureRendererRender(
       shovelerVector2(0.5f * width, 0.5f * height),
       shovelerVector2(width, height));
 
-  ShovelerFramebuffer* framebuffer = shovelerFramebufferCreateColorOnly(width, height, 1, 1, 8);
+  // pooled framebuffers have exactly the size of the text, so glyphs are rendered pixel for pixel
+  ShovelerFramebuffer* framebuffer =
+      shovelerFramebufferPoolAcquire(renderer->framebufferPool, width, height);
   shovelerSceneRenderFrame(renderer->textScene, NULL, framebuffer, renderState);
 
   ShovelerTexture* texture = framebuffer->renderTarget;
-  shovelerFramebufferFree(framebuffer, /* keepTargets */ true);
-  return texture;
+
+  g_hash_table_insert(renderer->textureFramebuffers, texture, framebuffer);
+  size_t numBytes = (size_t) framebuffer->width * (size_t) framebuffer->height;
+  return shovelerTextTextureCacheInsert(
+      renderer->textureCache, text, fontAtlas, fontAtlas->fontSize, texture, numBytes);
+}
+
+bool shovelerTextTextureRendererRelease(
+    ShovelerTextTextureRenderer* renderer, ShovelerTexture* texture) {
+  return shovelerTextTextureCacheRelease(renderer->textureCache, texture);
 }
 
 void shovelerTextTextureRendererFree(ShovelerTextTextureRenderer* renderer) {
+  shovelerTextTextureCacheFree(renderer->textureCache);
+  g_hash_table_destroy(renderer->textureFramebuffers);
+  shovelerFramebufferPoolFree(renderer->framebufferPool);
   shovelerSpriteFree(renderer->textSprite);
   shovelerCanvasFree(renderer->textCanvas);
   shovelerSceneRemoveModel(renderer->textScene, renderer->textModel);
@@ -99,3 +131,13 @@ void shovelerTextTextureRendererFree(ShovelerTextTextureRenderer* renderer) {
   shovelerSceneFree(renderer->textScene);
   free(renderer);
 }
+
+static void freeCachedTexture(ShovelerTexture* texture, void* rendererPointer) {
+  ShovelerTextTextureRenderer* renderer = rendererPointer;
+
+  ShovelerFramebuffer* framebuffer = g_hash_table_lookup(renderer->textureFramebuffers, texture);
+  assert(framebuffer != NULL);
+  g_hash_table_remove(renderer->textureFramebuffers, texture);
+
+  shovelerFramebufferPoolRelease(renderer->framebufferPool, framebuffer);
+}
@@ -5,9 +5,11 @@
 #include <stdlib.h> // malloc, free
 
 #include "shoveler/image.h"
+#include "shoveler/image/mipmap.h"
 #include "shoveler/log.h"
 #include "shoveler/opengl.h"
 
+static void uploadLevel(ShovelerTexture* texture, GLint level, ShovelerImage* image);
 static int getNumMipmapLevels(int width, int height);
 
 ShovelerTexture* shovelerTextureCreate2d(ShovelerImage* image, bool manageImage) {
@@ -20,6 +22,8 @@ ShovelerTexture* shovelerTextureCreate2d(ShovelerImage* image, bool manageImage)
   texture->channels = image->channels;
   texture->image = image;
   texture->manageImage = manageImage;
+  texture->uploaded = false;
+  texture->generateMipmaps = true;
   texture->target = GL_TEXTURE_2D;
   glGenTextures(1, &texture->texture);
   glBindTexture(texture->target, texture->texture);
@@ -43,7 +47,7 @@ ShovelerTexture* shovelerTextureCreate2d(ShovelerImage* image, bool manageImage)
     break;
   }
 
-  int numMipmapLevels = getNumMipmapLevels(texture->image->width, texture->image->width);
+  int numMipmapLevels = getNumMipmapLevels(texture->image->width, texture->image->height);
   glTexStorage2D(
       texture->target,
       numMipmapLevels,
@@ -70,6 +74,9 @@ ShovelerTexture* shovelerTextureCreateRenderTarget(
   texture->height = height;
   texture->channels = channels;
   texture->image = NULL;
+  texture->manageImage = false;
+  texture->uploaded = false;
+  texture->generateMipmaps = false;
   texture->target = samples > 1 ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
   glGenTextures(1, &texture->texture);
   glBindTexture(texture->target, texture->texture);
@@ -135,6 +142,9 @@ ShovelerTexture* shovelerTextureCreateDepthTarget(
   texture->height = height;
   texture->channels = 1;
   texture->image = NULL;
+  texture->manageImage = false;
+  texture->uploaded = false;
+  texture->generateMipmaps = false;
   texture->target = samples > 1 ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
   glGenTextures(1, &texture->texture);
   glBindTexture(texture->target, texture->texture);
@@ -157,24 +167,87 @@ bool shovelerTextureUpdate(ShovelerTexture* texture) {
     return false;
   }
 
+  glBindTexture(texture->target, texture->texture);
+  uploadLevel(texture, 0, texture->image);
+  if (texture->generateMipmaps) {
+    glGenerateMipmap(texture->target);
+  }
+
+  texture->uploaded = true;
+  shovelerDirtyRegionClear(&texture->image->dirtyRegion);
+  return shovelerOpenGLCheckSuccess();
+}
+
+bool shovelerTextureUpdateWithMipmaps(ShovelerTexture* texture, ShovelerImageMipmaps* mipmaps) {
+  if (texture->image == NULL) {
+    return false;
+  }
+
+  assert(mipmaps->levels[0] == texture->image);
+  assert(mipmaps->numLevels == getNumMipmapLevels(texture->width, texture->height));
+
+  glBindTexture(texture->target, texture->texture);
+  for (int level = 0; level < mipmaps->numLevels; level++) {
+    uploadLevel(texture, level, mipmaps->levels[level]);
+  }
+
+  texture->uploaded = true;
+  shovelerDirtyRegionClear(&texture->image->dirtyRegion);
+  return shovelerOpenGLCheckSuccess();
+}
+
+bool shovelerTextureFlush(ShovelerTexture* texture) {
+  if (texture->image == NULL) {
+    return true;
+  }
+
+  if (!texture->uploaded) {
+    return shovelerTextureUpdate(texture);
+  }
+
+  ShovelerDirtyRegion* dirtyRegion = &texture->image->dirtyRegion;
+  if (shovelerDirtyRegionIsEmpty(dirtyRegion)) {
+    return true;
+  }
+
   glBindTexture(texture->target, texture->texture);
   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-  glTexSubImage2D(
-      texture->target,
-      0,
-      0,
-      0,
-      texture->width,
-      texture->height,
-      texture->format,
-      GL_UNSIGNED_BYTE,
-      texture->image->data);
-  glGenerateMipmap(texture->target);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, texture->width);
+  for (int i = 0; i < dirtyRegion->numRectangles; i++) {
+    const ShovelerDirtyRectangle* rectangle = &dirtyRegion->rectangles[i];
+    const unsigned char* data = texture->image->data +
+        ((size_t) rectangle->minY * texture->width + rectangle->minX) * texture->channels;
+    glTexSubImage2D(
+        texture->target,
+        0,
+        rectangle->minX,
+        rectangle->minY,
+        rectangle->maxX - rectangle->minX,
+        rectangle->maxY - rectangle->minY,
+        texture->format,
+        GL_UNSIGNED_BYTE,
+        data);
+  }
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+  if (texture->generateMipmaps) {
+    glGenerateMipmap(texture->target);
+  }
+
+  shovelerDirtyRegionClear(dirtyRegion);
   return shovelerOpenGLCheckSuccess();
 }
 
 bool shovelerTextureUse(ShovelerTexture* texture, GLuint unitIndex) {
   glActiveTexture(GL_TEXTURE0 + unitIndex);
+
+  // flush on the unit the texture is bound to anyway, so no other unit's binding changes
+  if (texture->uploaded && !shovelerDirtyRegionIsEmpty(&texture->image->dirtyRegion)) {
+    if (!shovelerTextureFlush(texture)) {
+      return false;
+    }
+  }
+
   glBindTexture(texture->target, texture->texture);
   return shovelerOpenGLCheckSuccess();
 }
@@ -192,6 +265,20 @@ void shovelerTextureFree(ShovelerTexture* texture) {
   free(texture);
 }
 
+static void uploadLevel(ShovelerTexture* texture, GLint level, ShovelerImage* image) {
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage2D(
+      texture->target,
+      level,
+      0,
+      0,
+      image->width,
+      image->height,
+      texture->format,
+      GL_UNSIGNED_BYTE,
+      image->data);
+}
+
 static int getNumMipmapLevels(int width, int height) {
   return floor(log2(fmax(width, height))) + 1;
 }
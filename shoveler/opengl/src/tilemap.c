@@ -1,5 +1,7 @@
 #include "shoveler/material/tilemap.h"
 
+#include <assert.h> // assert
+#include <math.h> // floorf, ceilf
 #include <stdlib.h> // malloc, free
 #include <string.h> // memmove
 
@@ -13,13 +15,18 @@
 #include "shoveler/shader.h"
 #include "shoveler/texture.h"
 #include "shoveler/tilemap.h"
+#include "shoveler/tilemap_colliders.h"
 #include "shoveler/tileset.h"
 
-ShovelerTilemap* shovelerTilemapCreate(ShovelerTexture* tiles, const bool* collidingTiles) {
+ShovelerTilemap* shovelerTilemapCreate(
+    ShovelerTexture* tiles, const ShovelerTilemapColliders* colliders) {
+  assert(colliders == NULL ||
+         (colliders->numColumns == tiles->width && colliders->numRows == tiles->height));
+
   ShovelerTilemap* tilemap = malloc(sizeof(ShovelerTilemap));
   tilemap->tiles = tiles;
   tilemap->tilesets = g_queue_new();
-  tilemap->collidingTiles = collidingTiles;
+  tilemap->colliders = colliders;
 
   return tilemap;
 }
@@ -33,40 +40,41 @@ bool shovelerTilemapIntersect(
     ShovelerTilemap* tilemap,
     const ShovelerBoundingBox2* boundingBox,
     const ShovelerBoundingBox2* object) {
-  if (tilemap->collidingTiles == NULL) {
+  const ShovelerTilemapColliders* colliders = tilemap->colliders;
+  if (colliders == NULL) {
     return false;
   }
 
   ShovelerVector2 size =
       shovelerVector2LinearCombination(1.0f, boundingBox->max, -1.0f, boundingBox->min);
+  if (!(size.values[0] > 0.0f && size.values[1] > 0.0f)) {
+    return false;
+  }
 
-  unsigned int numColumns = tilemap->tiles->width;
-  unsigned int numRows = tilemap->tiles->height;
-
-  float columnStride = size.values[0] / numColumns;
-  float rowStride = size.values[1] / numRows;
-
-  for (unsigned int row = 0; row < numRows; row++) {
-    unsigned int rowIndex = row * numRows;
-    float rowCoordinate = boundingBox->min.values[1] + row * rowStride;
-
-    for (unsigned int column = 0; column < numColumns; column++) {
-      if (!tilemap->collidingTiles[rowIndex + column]) {
-        continue;
-      }
-
-      float columnCoordinate = boundingBox->min.values[0] + column * columnStride;
-
-      ShovelerBoundingBox2 tileBoundingBox = shovelerBoundingBox2(
-          shovelerVector2(columnCoordinate, rowCoordinate),
-          shovelerVector2(columnCoordinate + columnStride, rowCoordinate + rowStride));
-      if (shovelerBoundingBox2Intersect(object, &tileBoundingBox)) {
-        return true;
-      }
-    }
+  // Tile (column, row) spans [column, column + 1] x [row, row + 1] in tile coordinates, and
+  // intersects the object if it overlaps it with nonzero area, matching
+  // shovelerBoundingBox2Intersect.
+  float minColumn = (object->min.values[0] - boundingBox->min.values[0]) * colliders->numColumns /
+      size.values[0];
+  float maxColumn = (object->max.values[0] - boundingBox->min.values[0]) * colliders->numColumns /
+      size.values[0];
+  float minRow =
+      (object->min.values[1] - boundingBox->min.values[1]) * colliders->numRows / size.values[1];
+  float maxRow =
+      (object->max.values[1] - boundingBox->min.values[1]) * colliders->numRows / size.values[1];
+
+  // reject before converting to int, so that objects far outside the tilemap can't overflow
+  if (!(maxColumn > 0.0f && minColumn < colliders->numColumns && maxRow > 0.0f &&
+        minRow < colliders->numRows)) {
+    return false;
   }
 
-  return false;
+  return shovelerTilemapCollidersIntersectRange(
+      colliders,
+      minColumn < 0.0f ? 0 : (int) floorf(minColumn),
+      minRow < 0.0f ? 0 : (int) floorf(minRow),
+      maxColumn > colliders->numColumns ? colliders->numColumns - 1 : (int) ceilf(maxColumn) - 1,
+      maxRow > colliders->numRows ? colliders->numRows - 1 : (int) ceilf(maxRow) - 1);
 }
 
 bool shovelerTilemapRender(
@@ -0,0 +1,113 @@
+#include "shoveler/tilemap_colliders.h"
+
+#include <assert.h> // assert
+#include <stdlib.h> // malloc, calloc, free
+#include <string.h> // memset
+
+ShovelerTilemapColliders* shovelerTilemapCollidersCreate(int numColumns, int numRows) {
+  assert(numColumns >= 0);
+  assert(numRows >= 0);
+
+  ShovelerTilemapColliders* colliders = malloc(sizeof(ShovelerTilemapColliders));
+  colliders->numColumns = numColumns;
+  colliders->numRows = numRows;
+  colliders->numWordsPerRow = (numColumns + 63) / 64;
+  // allocate one spare word so that empty colliders still get a valid buffer
+  colliders->words = calloc((size_t) colliders->numWordsPerRow * numRows + 1, sizeof(uint64_t));
+
+  return colliders;
+}
+
+void shovelerTilemapCollidersUpdate(
+    ShovelerTilemapColliders* colliders, const unsigned char* collidingTiles) {
+  size_t numWords = (size_t) colliders->numWordsPerRow * colliders->numRows;
+  memset(colliders->words, 0, numWords * sizeof(uint64_t));
+
+  for (int row = 0; row < colliders->numRows; row++) {
+    const unsigned char* rowTiles = collidingTiles + row * colliders->numColumns;
+    uint64_t* rowWords = colliders->words + row * colliders->numWordsPerRow;
+
+    for (int column = 0; column < colliders->numColumns; column++) {
+      rowWords[column / 64] |= (uint64_t) (rowTiles[column] != 0) << (column % 64);
+    }
+  }
+}
+
+void shovelerTilemapCollidersSet(
+    ShovelerTilemapColliders* colliders, int column, int row, bool colliding) {
+  assert(column >= 0 && column < colliders->numColumns);
+  assert(row >= 0 && row < colliders->numRows);
+
+  uint64_t* word = &colliders->words[row * colliders->numWordsPerRow + column / 64];
+  uint64_t mask = (uint64_t) 1 << (column % 64);
+  if (colliding) {
+    *word |= mask;
+  } else {
+    *word &= ~mask;
+  }
+}
+
+bool shovelerTilemapCollidersIntersectRange(
+    const ShovelerTilemapColliders* colliders,
+    int minColumn,
+    int minRow,
+    int maxColumn,
+    int maxRow) {
+  if (minColumn < 0) {
+    minColumn = 0;
+  }
+  if (minRow < 0) {
+    minRow = 0;
+  }
+  if (maxColumn >= colliders->numColumns) {
+    maxColumn = colliders->numColumns - 1;
+  }
+  if (maxRow >= colliders->numRows) {
+    maxRow = colliders->numRows - 1;
+  }
+  if (minColumn > maxColumn || minRow > maxRow) {
+    return false;
+  }
+
+  int minWord = minColumn / 64;
+  int maxWord = maxColumn / 64;
+  uint64_t minWordMask = ~(uint64_t) 0 << (minColumn % 64);
+  uint64_t maxWordMask = ~(uint64_t) 0 >> (63 - maxColumn % 64);
+
+  if (minWord == maxWord) {
+    // the common case of a range within a single word only needs one test per row
+    uint64_t mask = minWordMask & maxWordMask;
+    const uint64_t* word = colliders->words + minRow * colliders->numWordsPerRow + minWord;
+    for (int row = minRow; row <= maxRow; row++, word += colliders->numWordsPerRow) {
+      if (*word & mask) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  for (int row = minRow; row <= maxRow; row++) {
+    const uint64_t* rowWords = colliders->words + row * colliders->numWordsPerRow;
+
+    uint64_t collidingBits = (rowWords[minWord] & minWordMask) | (rowWords[maxWord] & maxWordMask);
+    for (int wordIndex = minWord + 1; wordIndex < maxWord; wordIndex++) {
+      collidingBits |= rowWords[wordIndex];
+    }
+
+    if (collidingBits != 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void shovelerTilemapCollidersFree(ShovelerTilemapColliders* colliders) {
+  if (colliders == NULL) {
+    return;
+  }
+
+  free(colliders->words);
+  free(colliders);
+}
@@ -1,44 +1,94 @@
 #include <gtest/gtest.h>
 
+#include <cstdint>
+#include <cstdio>
 #include <string>
+#include <vector>
 
 extern "C" {
+#include <glib.h>
+
 #include "shoveler/image.h"
 #include "shoveler/texture.h"
 #include "shoveler/tilemap.h"
+#include "shoveler/tilemap_colliders.h"
 }
 
 class ShovelerTilemapTest : public ::testing::Test {
 public:
   virtual void SetUp() {
-    memset(collidingTiles, 0, 10 * 10 * sizeof(bool));
-    collidingTiles[1 * 10 + 1] = true;
-    collidingTiles[1 * 10 + 9] = true;
-    collidingTiles[9 * 10 + 1] = true;
-    collidingTiles[9 * 10 + 9] = true;
+    colliders = shovelerTilemapCollidersCreate(10, 10);
+    shovelerTilemapCollidersSet(colliders, 1, 1, true);
+    shovelerTilemapCollidersSet(colliders, 9, 1, true);
+    shovelerTilemapCollidersSet(colliders, 1, 9, true);
+    shovelerTilemapCollidersSet(colliders, 9, 9, true);
 
     tilesData = shovelerImageCreate(10, 10, 3);
     tiles.width = 10;
     tiles.height = 10;
     tiles.image = tilesData;
 
-    tilemap = shovelerTilemapCreate(&tiles, collidingTiles);
+    tilemap = shovelerTilemapCreate(&tiles, colliders);
 
     boundingBox = shovelerBoundingBox2(shovelerVector2(0.0f, 0.0f), shovelerVector2(10.0f, 10.0f));
   }
 
   virtual void TearDown() {
     shovelerTilemapFree(tilemap);
+    shovelerTilemapCollidersFree(colliders);
     shovelerImageFree(tilesData);
   }
 
-  bool collidingTiles[10 * 10];
+  ShovelerTilemapColliders* colliders;
   ShovelerImage* tilesData;
   ShovelerTexture tiles;
   ShovelerTilemap* tilemap;
   ShovelerBoundingBox2 boundingBox;
 };
 
+/** Generates pseudo random colliding tiles, with the given percentage of tiles colliding. */
+static std::vector<unsigned char> createCollidingTiles(
+    int numColumns, int numRows, int collidingPercentage, uint32_t seed) {
+  std::vector<unsigned char> collidingTiles(numColumns * numRows);
+  uint32_t state = seed;
+  for (unsigned char& collidingTile : collidingTiles) {
+    state = state * 1664525u + 1013904223u;
+    collidingTile = (state >> 16) % 100 < (uint32_t) collidingPercentage ? 1 : 0;
+  }
+  return collidingTiles;
+}
+
+/** Tests every tile separately, like intersection did before colliders were packed. */
+static bool intersectReference(
+    const std::vector<unsigned char>& collidingTiles,
+    int numColumns,
+    int numRows,
+    const ShovelerBoundingBox2* boundingBox,
+    const ShovelerBoundingBox2* object) {
+  float columnStride = (boundingBox->max.values[0] - boundingBox->min.values[0]) / numColumns;
+  float rowStride = (boundingBox->max.values[1] - boundingBox->min.values[1]) / numRows;
+
+  for (int row = 0; row < numRows; row++) {
+    float rowCoordinate = boundingBox->min.values[1] + row * rowStride;
+
+    for (int column = 0; column < numColumns; column++) {
+      if (!collidingTiles[row * numColumns + column]) {
+        continue;
+      }
+
+      float columnCoordinate = boundingBox->min.values[0] + column * columnStride;
+      ShovelerBoundingBox2 tileBoundingBox = shovelerBoundingBox2(
+          shovelerVector2(columnCoordinate, rowCoordinate),
+          shovelerVector2(columnCoordinate + columnStride, rowCoordinate + rowStride));
+      if (shovelerBoundingBox2Intersect(object, &tileBoundingBox)) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
 TEST_F(ShovelerTilemapTest, intersection) {
   ShovelerBoundingBox2 intersectingBox =
       shovelerBoundingBox2(shovelerVector2(0.0f, 0.0f), shovelerVector2(5.0f, 5.0f));
@@ -69,10 +119,210 @@ TEST_F(ShovelerTilemapTest, noIntersection) {
 }
 
 TEST_F(ShovelerTilemapTest, disableThenIntersect) {
-  collidingTiles[1 * 10 + 1] = false;
+  shovelerTilemapCollidersSet(colliders, 1, 1, false);
 
   ShovelerBoundingBox2 noLongerIntersectingBox =
       shovelerBoundingBox2(shovelerVector2(0.0f, 0.0f), shovelerVector2(5.0f, 5.0f));
   bool intersects = shovelerTilemapIntersect(tilemap, &boundingBox, &noLongerIntersectingBox);
   ASSERT_FALSE(intersects);
 }
+
+TEST_F(ShovelerTilemapTest, touchingIsNotIntersecting) {
+  ShovelerBoundingBox2 touchingBox =
+      shovelerBoundingBox2(shovelerVector2(2.0f, 0.0f), shovelerVector2(9.0f, 2.0f));
+  ASSERT_FALSE(shovelerTilemapIntersect(tilemap, &boundingBox, &touchingBox));
+
+  ShovelerBoundingBox2 outsideBox =
+      shovelerBoundingBox2(shovelerVector2(-5.0f, -5.0f), shovelerVector2(0.0f, 20.0f));
+  ASSERT_FALSE(shovelerTilemapIntersect(tilemap, &boundingBox, &outsideBox));
+
+  ShovelerBoundingBox2 enclosingBox =
+      shovelerBoundingBox2(shovelerVector2(-1e30f, -1e30f), shovelerVector2(1e30f, 1e30f));
+  ASSERT_TRUE(shovelerTilemapIntersect(tilemap, &boundingBox, &enclosingBox));
+}
+
+TEST_F(ShovelerTilemapTest, intersectionNonSquare) {
+  // rows used to be indexed by the number of rows rather than columns
+  ShovelerTilemapColliders* wideColliders = shovelerTilemapCollidersCreate(100, 3);
+  shovelerTilemapCollidersSet(wideColliders, 70, 2, true);
+  ShovelerImage* wideTilesData = shovelerImageCreate(100, 3, 3);
+  ShovelerTexture wideTiles;
+  wideTiles.width = 100;
+  wideTiles.height = 3;
+  wideTiles.image = wideTilesData;
+  ShovelerTilemap* wideTilemap = shovelerTilemapCreate(&wideTiles, wideColliders);
+  ShovelerBoundingBox2 wideBoundingBox =
+      shovelerBoundingBox2(shovelerVector2(0.0f, 0.0f), shovelerVector2(100.0f, 3.0f));
+
+  ShovelerBoundingBox2 intersectingBox =
+      shovelerBoundingBox2(shovelerVector2(70.5f, 2.5f), shovelerVector2(70.6f, 2.6f));
+  ASSERT_TRUE(shovelerTilemapIntersect(wideTilemap, &wideBoundingBox, &intersectingBox));
+
+  ShovelerBoundingBox2 aliasedBox =
+      shovelerBoundingBox2(shovelerVector2(76.5f, 0.5f), shovelerVector2(76.6f, 0.6f));
+  ASSERT_FALSE(shovelerTilemapIntersect(wideTilemap, &wideBoundingBox, &aliasedBox));
+
+  shovelerTilemapFree(wideTilemap);
+  shovelerImageFree(wideTilesData);
+  shovelerTilemapCollidersFree(wideColliders);
+}
+
+TEST_F(ShovelerTilemapTest, intersectRangeAcrossWords) {
+  ShovelerTilemapColliders* wideColliders = shovelerTilemapCollidersCreate(200, 2);
+  shovelerTilemapCollidersSet(wideColliders, 63, 0, true);
+  shovelerTilemapCollidersSet(wideColliders, 199, 1, true);
+
+  ASSERT_TRUE(shovelerTilemapCollidersGet(wideColliders, 63, 0));
+  ASSERT_FALSE(shovelerTilemapCollidersGet(wideColliders, 64, 0));
+  ASSERT_TRUE(shovelerTilemapCollidersIntersectRange(wideColliders, 63, 0, 63, 0));
+  ASSERT_TRUE(shovelerTilemapCollidersIntersectRange(wideColliders, 0, 0, 199, 0));
+  ASSERT_TRUE(shovelerTilemapCollidersIntersectRange(wideColliders, 10, 0, 150, 1));
+  ASSERT_FALSE(shovelerTilemapCollidersIntersectRange(wideColliders, 64, 0, 198, 1));
+  ASSERT_FALSE(shovelerTilemapCollidersIntersectRange(wideColliders, 0, 1, 198, 1));
+  ASSERT_TRUE(shovelerTilemapCollidersIntersectRange(wideColliders, 199, 1, 1000, 1000));
+  ASSERT_FALSE(shovelerTilemapCollidersIntersectRange(wideColliders, 200, 0, 1000, 1));
+  ASSERT_FALSE(shovelerTilemapCollidersIntersectRange(wideColliders, 70, 0, 60, 1));
+
+  shovelerTilemapCollidersFree(wideColliders);
+}
+
+TEST_F(ShovelerTilemapTest, intersectionMatchesReference) {
+  const int numColumns = 130;
+  const int numRows = 70;
+  std::vector<unsigned char> collidingTiles =
+      createCollidingTiles(numColumns, numRows, /* collidingPercentage */ 2, /* seed */ 1);
+
+  ShovelerTilemapColliders* referenceColliders =
+      shovelerTilemapCollidersCreate(numColumns, numRows);
+  shovelerTilemapCollidersUpdate(referenceColliders, collidingTiles.data());
+  for (int row = 0; row < numRows; row++) {
+    for (int column = 0; column < numColumns; column++) {
+      ASSERT_EQ(
+          shovelerTilemapCollidersGet(referenceColliders, column, row),
+          collidingTiles[row * numColumns + column] != 0);
+    }
+  }
+
+  ShovelerImage* referenceTilesData = shovelerImageCreate(numColumns, numRows, 3);
+  ShovelerTexture referenceTiles;
+  referenceTiles.width = numColumns;
+  referenceTiles.height = numRows;
+  referenceTiles.image = referenceTilesData;
+  ShovelerTilemap* referenceTilemap = shovelerTilemapCreate(&referenceTiles, referenceColliders);
+  ShovelerBoundingBox2 referenceBoundingBox = shovelerBoundingBox2(
+      shovelerVector2(-10.0f, 5.0f), shovelerVector2(-10.0f + numColumns, 5.0f + numRows));
+
+  uint32_t state = 2;
+  auto random = [&state](int range) {
+    state = state * 1664525u + 1013904223u;
+    return (int) ((state >> 8) % (uint32_t) range);
+  };
+
+  int numIntersecting = 0;
+  for (int i = 0; i < 2000; i++) {
+    // quarter tile coordinates hit tile edges exactly, and reach beyond the tilemap on all sides
+    float minX = -20.0f + random(4 * (numColumns + 20)) / 4.0f;
+    float minY = -5.0f + random(4 * (numRows + 20)) / 4.0f;
+    float width = random(4 * 80) / 4.0f;
+    float height = random(4 * 20) / 4.0f;
+    ShovelerBoundingBox2 object = shovelerBoundingBox2(
+        shovelerVector2(minX, minY), shovelerVector2(minX + width, minY + height));
+
+    bool expected = intersectReference(
+        collidingTiles, numColumns, numRows, &referenceBoundingBox, &object);
+    bool intersects = shovelerTilemapIntersect(referenceTilemap, &referenceBoundingBox, &object);
+    ASSERT_EQ(intersects, expected) << "object (" << minX << ", " << minY << ") size (" << width
+                                    << ", " << height << ")";
+    numIntersecting += intersects ? 1 : 0;
+  }
+  ASSERT_GT(numIntersecting, 0);
+  ASSERT_LT(numIntersecting, 2000);
+
+  shovelerTilemapFree(referenceTilemap);
+  shovelerImageFree(referenceTilesData);
+  shovelerTilemapCollidersFree(referenceColliders);
+}
+
+/**
+ * Compares intersecting boxes with a 256x256 tilemap against testing every tile separately. Run
+ * it explicitly with --gtest_also_run_disabled_tests --gtest_filter=*benchmark, it prints one
+ * JSON line per query size and implementation.
+ */
+TEST_F(ShovelerTilemapTest, DISABLED_benchmark) {
+  const int numColumns = 256;
+  const int numRows = 256;
+  const int numQueries = 20000;
+  const int numReferenceQueries = 200;
+  const float querySizes[] = {0.5f, 2.0f, 16.0f, 100.0f};
+
+  std::vector<unsigned char> collidingTiles =
+      createCollidingTiles(numColumns, numRows, /* collidingPercentage */ 1, /* seed */ 3);
+  ShovelerTilemapColliders* benchmarkColliders =
+      shovelerTilemapCollidersCreate(numColumns, numRows);
+  shovelerTilemapCollidersUpdate(benchmarkColliders, collidingTiles.data());
+  ShovelerImage* benchmarkTilesData = shovelerImageCreate(numColumns, numRows, 3);
+  ShovelerTexture benchmarkTiles;
+  benchmarkTiles.width = numColumns;
+  benchmarkTiles.height = numRows;
+  benchmarkTiles.image = benchmarkTilesData;
+  ShovelerTilemap* benchmarkTilemap = shovelerTilemapCreate(&benchmarkTiles, benchmarkColliders);
+  ShovelerBoundingBox2 benchmarkBoundingBox =
+      shovelerBoundingBox2(shovelerVector2(0.0f, 0.0f), shovelerVector2(512.0f, 512.0f));
+
+  auto printMeasurement = [](const char* implementation,
+                             float querySize,
+                             int queries,
+                             int intersecting,
+                             gint64 startTime) {
+    double elapsedNs = (double) (g_get_monotonic_time() - startTime) * 1000.0;
+    printf(
+        "{\"benchmark\": \"tilemap_intersect\", \"implementation\": \"%s\", \"columns\": 256, "
+        "\"rows\": 256, \"query_size\": %.1f, \"queries\": %d, \"intersecting\": %d, "
+        "\"ns_per_query\": %.1f}\n",
+        implementation,
+        querySize,
+        queries,
+        intersecting,
+        elapsedNs / queries);
+  };
+
+  for (float querySize : querySizes) {
+    std::vector<ShovelerBoundingBox2> objects(numQueries);
+    uint32_t state = 4;
+    for (ShovelerBoundingBox2& object : objects) {
+      state = state * 1664525u + 1013904223u;
+      float minX = (float) ((state >> 8) % 5120) / 10.0f - querySize / 2.0f;
+      state = state * 1664525u + 1013904223u;
+      float minY = (float) ((state >> 8) % 5120) / 10.0f - querySize / 2.0f;
+      object = shovelerBoundingBox2(
+          shovelerVector2(minX, minY), shovelerVector2(minX + querySize, minY + querySize));
+    }
+
+    gint64 startTime = g_get_monotonic_time();
+    int numIntersecting = 0;
+    for (const ShovelerBoundingBox2& object : objects) {
+      numIntersecting +=
+          shovelerTilemapIntersect(benchmarkTilemap, &benchmarkBoundingBox, &object) ? 1 : 0;
+    }
+    printMeasurement("bitset", querySize, numQueries, numIntersecting, startTime);
+
+    startTime = g_get_monotonic_time();
+    int numReferenceIntersecting = 0;
+    for (int i = 0; i < numReferenceQueries; i++) {
+      numReferenceIntersecting += intersectReference(
+                                      collidingTiles,
+                                      numColumns,
+                                      numRows,
+                                      &benchmarkBoundingBox,
+                                      &objects[i])
+          ? 1
+          : 0;
+    }
+    printMeasurement(
+        "per_tile", querySize, numReferenceQueries, numReferenceIntersecting, startTime);
+  }
+
+  shovelerTilemapFree(benchmarkTilemap);
+  shovelerImageFree(benchmarkTilesData);
+  shovelerTilemapCollidersFree(benchmarkColliders);
+}
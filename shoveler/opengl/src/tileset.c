@@ -73,6 +73,7 @@ ShovelerTileset* shovelerTilesetCreate(
 
   tileset->manageTexture = true;
   tileset->texture = shovelerTextureCreate2d(paddedImage, true);
+  tileset->texture->generateMipmaps = false;
   shovelerTextureUpdate(tileset->texture);
 
   // create a sampler without mipmapping to prevent seam artifacts between tiles
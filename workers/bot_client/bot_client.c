@@ -9,6 +9,8 @@
 #include <shoveler/constants.h>
 #include <shoveler/connect.h>
 #include <shoveler/log.h>
+#include <shoveler/map_layout.h>
+#include <shoveler/position_publisher.h>
 #include <shoveler/resources/image_png.h>
 #include <shoveler/resources.h>
 #include <shoveler/spatialos_schema.h>
@@ -26,6 +28,7 @@ typedef struct {
 typedef struct {
 	uint32_t componentId;
 	bool authoritative;
+	ShovelerWorkerPositionStream positionStream;
 	union {
 		ShovelerVector3 position;
 		TilemapTiles tilemapTiles;
@@ -50,7 +53,10 @@ typedef struct {
 		kLeft,
 		kRight
 	} direction;
-	ShovelerVector3 lastImprobablePosition;
+	ShovelerWorkerPositionPublisher positionPublisher;
+	ShovelerWorkerPositionPublisher improbablePositionPublisher;
+	ShovelerWorkerPositionStream positionStream;
+	bool quantizedPositions;
 	int64_t lastHeartbeatPongTime;
 	double meanHeartbeatLatencyMs;
 	double meanTimeSinceLastHeartbeatPongMs;
@@ -64,6 +70,9 @@ static void clientPingTick(void *clientContextPointer);
 static void clientDirectionChange(void *clientContextPointer);
 static void clientStatus(void *clientContextPointer);
 static void move(ClientContext *context, Component *positionComponent, int dtMs);
+static bool readPositionCoordinates(Component *positionComponent, Schema_Object *fields);
+static void publishPosition(ShovelerVector3 coordinates, void *clientContextPointer);
+static void publishImprobablePosition(ShovelerVector3 coordinates, void *clientContextPointer);
 static bool validatePosition(ClientContext *context, ShovelerVector3 coordinates);
 static bool validatePoint(ClientContext *context, ShovelerVector3 coordinates);
 static int64_t getChunkBackgroundEntityId(int chunkX, int chunkZ);
@@ -79,9 +88,9 @@ static const int64_t clientStatusTimeoutMs = 2449;
 static const float velocity = 1.5f;
 static const int directionChangeChancePercent = 10;
 static const int tickRateHz = 30;
-static const int halfMapWidth = 100;
-static const int halfMapHeight = 100;
-static const int chunkSize = 10;
+static const int halfMapWidth = shovelerWorkerMapNumChunkColumns * shovelerWorkerMapChunkSize / 2;
+static const int halfMapHeight = shovelerWorkerMapNumChunkRows * shovelerWorkerMapChunkSize / 2;
+static const int chunkSize = shovelerWorkerMapChunkSize;
 static const int64_t firstChunkEntityId = 12;
 static const double characterSize = 0.9;
 static const float improbablePositionUpdateDistance = 1.0f;
@@ -136,7 +145,15 @@ int main(int argc, char **argv) {
 	context.clientEntityId = 0;
 	context.clientEntityId = 0;
 	context.direction = kUp;
-	context.lastImprobablePosition = shovelerVector3(0.0f, 0.0f, 0.0f);
+	shovelerWorkerPositionPublisherInit(&context.positionPublisher, shovelerWorkerPositionPublisherDefaultSettings(), publishPosition, &context);
+	ShovelerWorkerPositionPublisherSettings improbablePositionPublisherSettings = shovelerWorkerPositionPublisherDefaultSettings();
+	improbablePositionPublisherSettings.minDistance = improbablePositionUpdateDistance;
+	improbablePositionPublisherSettings.extrapolationTolerance = 0.0f;
+	shovelerWorkerPositionPublisherInit(&context.improbablePositionPublisher, improbablePositionPublisherSettings, publishImprobablePosition, &context);
+	context.positionStream.hasOrigin = false;
+	context.positionStream.origin = 0;
+	context.quantizedPositions = false;
+	shovelerWorkerConfigurationParseBoolFlag(context.connection, "quantized_positions", &context.quantizedPositions);
 	context.clientEntityId = 0;
 	context.lastHeartbeatPongTime = g_get_monotonic_time();
 	context.meanHeartbeatLatencyMs = 0.0;
@@ -285,6 +302,8 @@ int main(int argc, char **argv) {
 				if(positionComponent) {
 					if(positionComponent->authoritative) {
 						move(&context, positionComponent, dtUs / 1000);
+						shovelerWorkerPositionPublisherUpdate(&context.positionPublisher, positionComponent->position, tickStartTime);
+						shovelerWorkerPositionPublisherUpdate(&context.improbablePositionPublisher, positionComponent->position, tickStartTime);
 					}
 				}
 			}
@@ -321,17 +340,12 @@ static void onAddComponent(ClientContext *context, const Worker_AddComponentOp *
 	Schema_Object *fields = Schema_GetComponentDataFields(op->data.schema_type);
 
 	if(component->componentId == shovelerWorkerSchemaComponentIdPosition) {
-		Schema_Object *coordinates = Schema_GetObject(fields, shovelerWorkerSchemaPositionFieldIdCoordinates);
-		if (coordinates == NULL) {
+		if(!readPositionCoordinates(component, fields)) {
 			shovelerLogWarning(
 				"Received add entity %"PRId64" position component without coordinates.",
 				op->entity_id);
 			return;
 		}
-
-		component->position.values[0] = Schema_GetFloat(coordinates, shovelerWorkerSchemaVector3FieldIdX);
-		component->position.values[1] = Schema_GetFloat(coordinates, shovelerWorkerSchemaVector3FieldIdY);
-		component->position.values[2] = Schema_GetFloat(coordinates, shovelerWorkerSchemaVector3FieldIdZ);
 	} else if(component->componentId == shovelerWorkerSchemaComponentIdTilemapTiles) {
 		component->tilemapTiles.tilesetColumns = g_string_new("");
 		component->tilemapTiles.tilesetRows = g_string_new("");
@@ -397,17 +411,12 @@ static void onComponentUpdate(ClientContext *context, const Worker_ComponentUpda
 		context->meanHeartbeatLatencyMs *= (1.0 - meanHeartbeatMovingExponentialFactor);
 		context->meanHeartbeatLatencyMs += meanHeartbeatMovingExponentialFactor * 0.001 * (double) (context->lastHeartbeatPongTime - lastPing);
 	} else if(component->componentId == shovelerWorkerSchemaComponentIdPosition) {
-		Schema_Object *coordinates = Schema_GetObject(fields, shovelerWorkerSchemaPositionFieldIdCoordinates);
-		if (coordinates == NULL) {
+		if(!readPositionCoordinates(component, fields)) {
 			shovelerLogWarning(
 				"Received update entity %"PRId64" position component without coordinates.",
 				op->entity_id);
 			return;
 		}
-
-		component->position.values[0] = Schema_GetFloat(coordinates, shovelerWorkerSchemaVector3FieldIdX);
-		component->position.values[1] = Schema_GetFloat(coordinates, shovelerWorkerSchemaVector3FieldIdY);
-		component->position.values[2] = Schema_GetFloat(coordinates, shovelerWorkerSchemaVector3FieldIdZ);
 	} else if(op->update.component_id == shovelerWorkerSchemaComponentIdTilemapTiles) {
 		g_string_set_size(component->tilemapTiles.tilesetColumns, 0);
 		g_string_set_size(component->tilemapTiles.tilesetRows, 0);
@@ -488,6 +497,10 @@ static void onComponentAuthorityChange(ClientContext *context, const Worker_Comp
 			shovelerLogWarning("Lost client authority over entity %lld.", op->entity_id);
 			context->clientEntityId = 0;
 			shovelerExecutorRemoveCallback(context->executor, context->clientPingTickCallback);
+		} else if(componentId == shovelerWorkerSchemaComponentIdPosition) {
+			shovelerWorkerPositionPublisherReset(&context->positionPublisher);
+			shovelerWorkerPositionPublisherReset(&context->improbablePositionPublisher);
+			context->positionStream.hasOrigin = false;
 		}
 	}
 }
@@ -558,43 +571,60 @@ static void move(ClientContext *context, Component *positionComponent, int dtMs)
 	}
 
 	positionComponent->position = coordinates;
+}
 
-	{
-		Schema_ComponentUpdate *componentUpdate = Schema_CreateComponentUpdate();
-		Schema_Object *fields = Schema_GetComponentUpdateFields(componentUpdate);
-		Schema_Object *coordinatesObject = Schema_AddObject(fields, shovelerWorkerSchemaPositionFieldIdCoordinates);
-		Schema_AddFloat(coordinatesObject, shovelerWorkerSchemaVector3FieldIdX, coordinates.values[0]);
-		Schema_AddFloat(coordinatesObject, shovelerWorkerSchemaVector3FieldIdY, coordinates.values[1]);
-		Schema_AddFloat(coordinatesObject, shovelerWorkerSchemaVector3FieldIdZ, coordinates.values[2]);
-
-		Worker_ComponentUpdate update;
-		update.component_id = shovelerWorkerSchemaComponentIdPosition;
-		update.schema_type = componentUpdate;
+/** Reads quantized coordinates if the position carries them, and the plain coordinates field otherwise. */
+static bool readPositionCoordinates(Component *positionComponent, Schema_Object *fields)
+{
+	if(shovelerWorkerSchemaGetPositionQuantizedCoordinates(fields, &positionComponent->positionStream, &positionComponent->position)) {
+		return true;
+	}
 
-		Worker_Connection_SendComponentUpdate(context->connection, context->clientEntityId, &update);
-		shovelerLogTrace("Sent position update for client entity %lld to (%.2f, %.2f, %.2f).", context->clientEntityId, coordinates.values[0], coordinates.values[1], coordinates.values[2]);
+	Schema_Object *coordinates = Schema_GetObject(fields, shovelerWorkerSchemaPositionFieldIdCoordinates);
+	if(coordinates == NULL) {
+		return false;
 	}
 
+	positionComponent->position.values[0] = Schema_GetFloat(coordinates, shovelerWorkerSchemaVector3FieldIdX);
+	positionComponent->position.values[1] = Schema_GetFloat(coordinates, shovelerWorkerSchemaVector3FieldIdY);
+	positionComponent->position.values[2] = Schema_GetFloat(coordinates, shovelerWorkerSchemaVector3FieldIdZ);
+	return true;
+}
+
+static void publishPosition(ShovelerVector3 coordinates, void *clientContextPointer)
+{
+	ClientContext *context = (ClientContext *) clientContextPointer;
+
+	Schema_ComponentUpdate *componentUpdate = Schema_CreateComponentUpdate();
+	shovelerWorkerSchemaAddPositionUpdateCoordinates(componentUpdate, &context->positionStream, context->quantizedPositions, coordinates);
+
+	Worker_ComponentUpdate update;
+	update.component_id = shovelerWorkerSchemaComponentIdPosition;
+	update.schema_type = componentUpdate;
+
+	Worker_Connection_SendComponentUpdate(context->connection, context->clientEntityId, &update);
+	shovelerLogTrace("Sent position update for client entity %lld to (%.2f, %.2f, %.2f).", context->clientEntityId, coordinates.values[0], coordinates.values[1], coordinates.values[2]);
+}
+
+static void publishImprobablePosition(ShovelerVector3 coordinates, void *clientContextPointer)
+{
+	ClientContext *context = (ClientContext *) clientContextPointer;
+
 	ShovelerVector3 improbablePosition = shovelerVector3(coordinates.values[0], coordinates.values[2], coordinates.values[1]);
-	ShovelerVector3 diff = shovelerVector3LinearCombination(1.0f, improbablePosition, -1.0f, context->lastImprobablePosition);
-	float difference2 = shovelerVector3Dot(diff, diff);
-	if(difference2 > improbablePositionUpdateDistance) {
-		Schema_ComponentUpdate *componentUpdate = Schema_CreateComponentUpdate();
-		Schema_Object *fields = Schema_GetComponentUpdateFields(componentUpdate);
-		Schema_Object *coordinatesObject = Schema_AddObject(fields, shovelerWorkerSchemaImprobablePositionFieldIdCoords);
-		Schema_AddDouble(coordinatesObject, shovelerWorkerSchemaImprobableCoordinatesFieldIdX, improbablePosition.values[0]);
-		Schema_AddDouble(coordinatesObject, shovelerWorkerSchemaImprobableCoordinatesFieldIdY, improbablePosition.values[1]);
-		Schema_AddDouble(coordinatesObject, shovelerWorkerSchemaImprobableCoordinatesFieldIdZ, improbablePosition.values[2]);
-
-		Worker_ComponentUpdate update;
-		update.component_id = shovelerWorkerSchemaComponentIdImprobablePosition;
-		update.schema_type = componentUpdate;
-
-		Worker_Connection_SendComponentUpdate(context->connection, context->clientEntityId, &update);
-		shovelerLogTrace("Sent Improbable position update for client entity %lld to (%.2f, %.2f, %.2f).", context->clientEntityId, improbablePosition.values[0], improbablePosition.values[1], improbablePosition.values[2]);
-
-		context->lastImprobablePosition = improbablePosition;
-	}
+
+	Schema_ComponentUpdate *componentUpdate = Schema_CreateComponentUpdate();
+	Schema_Object *fields = Schema_GetComponentUpdateFields(componentUpdate);
+	Schema_Object *coordinatesObject = Schema_AddObject(fields, shovelerWorkerSchemaImprobablePositionFieldIdCoords);
+	Schema_AddDouble(coordinatesObject, shovelerWorkerSchemaImprobableCoordinatesFieldIdX, improbablePosition.values[0]);
+	Schema_AddDouble(coordinatesObject, shovelerWorkerSchemaImprobableCoordinatesFieldIdY, improbablePosition.values[1]);
+	Schema_AddDouble(coordinatesObject, shovelerWorkerSchemaImprobableCoordinatesFieldIdZ, improbablePosition.values[2]);
+
+	Worker_ComponentUpdate update;
+	update.component_id = shovelerWorkerSchemaComponentIdImprobablePosition;
+	update.schema_type = componentUpdate;
+
+	Worker_Connection_SendComponentUpdate(context->connection, context->clientEntityId, &update);
+	shovelerLogTrace("Sent Improbable position update for client entity %lld to (%.2f, %.2f, %.2f).", context->clientEntityId, improbablePosition.values[0], improbablePosition.values[1], improbablePosition.values[2]);
 }
 
 static bool validatePosition(ClientContext *context, ShovelerVector3 coordinates) {
@@ -0,0 +1,207 @@
+#include "activation_threads.h"
+
+#include <stdbool.h> // bool
+#include <stdlib.h> // malloc free
+#include <string.h> // strerror
+
+#include <glib.h>
+#include <shoveler/log.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+struct ShovelerClientActivationThreadsStruct {
+	ShovelerActivationPoolAdapter adapter;
+	int numThreads;
+	/* set of finished (ShovelerActivationTask *) that weren't released yet */
+	GHashTable* finishedTasks;
+#ifndef _WIN32
+	pthread_t* threads;
+	pthread_mutex_t mutex;
+	pthread_cond_t wakeCondition;
+	pthread_cond_t finishedCondition;
+	/* queue of submitted (ShovelerActivationTask *) that no thread picked up yet */
+	GQueue* queue;
+	bool shutdown;
+#endif
+};
+
+static void submitTask(ShovelerActivationTask* task, void* threadsPointer);
+static bool isTaskFinished(ShovelerActivationTask* task, bool wait, void* threadsPointer);
+static void releaseTask(ShovelerActivationTask* task, void* threadsPointer);
+#ifndef _WIN32
+static void* runThread(void* threadsPointer);
+#endif
+
+ShovelerClientActivationThreads* shovelerClientActivationThreadsCreate(int numThreads)
+{
+	ShovelerClientActivationThreads* threads = malloc(sizeof(ShovelerClientActivationThreads));
+	threads->adapter.submit = submitTask;
+	threads->adapter.isFinished = isTaskFinished;
+	threads->adapter.release = releaseTask;
+	threads->adapter.userData = threads;
+	threads->numThreads = 0;
+	threads->finishedTasks = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+#ifdef _WIN32
+	if (numThreads > 0) {
+		shovelerLogWarning("Activation threads are not supported on this platform, activating components synchronously.");
+	}
+#else
+	threads->threads = NULL;
+	pthread_mutex_init(&threads->mutex, NULL);
+	pthread_cond_init(&threads->wakeCondition, NULL);
+	pthread_cond_init(&threads->finishedCondition, NULL);
+	threads->queue = g_queue_new();
+	threads->shutdown = false;
+
+	if (numThreads > 0) {
+		threads->threads = malloc(numThreads * sizeof(pthread_t));
+		for (int i = 0; i < numThreads; i++) {
+			int error = pthread_create(&threads->threads[i], NULL, runThread, threads);
+			if (error != 0) {
+				shovelerLogError("Failed to start activation thread %d: %s", i, strerror(error));
+				break;
+			}
+
+			threads->numThreads++;
+		}
+	}
+
+	if (threads->numThreads > 0) {
+		shovelerLogInfo("Running deferred component activations on %d threads.", threads->numThreads);
+	}
+#endif
+
+	return threads;
+}
+
+ShovelerActivationPoolAdapter* shovelerClientActivationThreadsGetAdapter(ShovelerClientActivationThreads* threads)
+{
+	return &threads->adapter;
+}
+
+int shovelerClientActivationThreadsGetNumThreads(ShovelerClientActivationThreads* threads)
+{
+	return threads->numThreads;
+}
+
+void shovelerClientActivationThreadsFree(ShovelerClientActivationThreads* threads)
+{
+	if (threads == NULL) {
+		return;
+	}
+
+#ifndef _WIN32
+	pthread_mutex_lock(&threads->mutex);
+	threads->shutdown = true;
+	pthread_cond_broadcast(&threads->wakeCondition);
+	pthread_mutex_unlock(&threads->mutex);
+
+	for (int i = 0; i < threads->numThreads; i++) {
+		pthread_join(threads->threads[i], NULL);
+	}
+
+	if (!g_queue_is_empty(threads->queue)) {
+		shovelerLogWarning("Freeing activation threads with %u tasks that never ran.", g_queue_get_length(threads->queue));
+	}
+
+	free(threads->threads);
+	g_queue_free(threads->queue);
+	pthread_cond_destroy(&threads->finishedCondition);
+	pthread_cond_destroy(&threads->wakeCondition);
+	pthread_mutex_destroy(&threads->mutex);
+#endif
+
+	g_hash_table_destroy(threads->finishedTasks);
+	free(threads);
+}
+
+static void submitTask(ShovelerActivationTask* task, void* threadsPointer)
+{
+	ShovelerClientActivationThreads* threads = threadsPointer;
+
+	if (threads->numThreads == 0) {
+		shovelerActivationTaskRun(task);
+		g_hash_table_add(threads->finishedTasks, task);
+		return;
+	}
+
+#ifndef _WIN32
+	pthread_mutex_lock(&threads->mutex);
+	g_queue_push_tail(threads->queue, task);
+	pthread_cond_signal(&threads->wakeCondition);
+	pthread_mutex_unlock(&threads->mutex);
+#endif
+}
+
+static bool isTaskFinished(ShovelerActivationTask* task, bool wait, void* threadsPointer)
+{
+	ShovelerClientActivationThreads* threads = threadsPointer;
+
+	if (threads->numThreads == 0) {
+		return g_hash_table_contains(threads->finishedTasks, task);
+	}
+
+#ifndef _WIN32
+	// taking the mutex makes the writes of the thread that ran the task visible to this one
+	pthread_mutex_lock(&threads->mutex);
+	bool finished = g_hash_table_contains(threads->finishedTasks, task);
+	while (wait && !finished) {
+		pthread_cond_wait(&threads->finishedCondition, &threads->mutex);
+		finished = g_hash_table_contains(threads->finishedTasks, task);
+	}
+	pthread_mutex_unlock(&threads->mutex);
+
+	return finished;
+#else
+	return false;
+#endif
+}
+
+static void releaseTask(ShovelerActivationTask* task, void* threadsPointer)
+{
+	ShovelerClientActivationThreads* threads = threadsPointer;
+
+#ifndef _WIN32
+	if (threads->numThreads > 0) {
+		pthread_mutex_lock(&threads->mutex);
+		g_hash_table_remove(threads->finishedTasks, task);
+		pthread_mutex_unlock(&threads->mutex);
+		return;
+	}
+#endif
+
+	g_hash_table_remove(threads->finishedTasks, task);
+}
+
+#ifndef _WIN32
+static void* runThread(void* threadsPointer)
+{
+	ShovelerClientActivationThreads* threads = threadsPointer;
+
+	pthread_mutex_lock(&threads->mutex);
+	while (true) {
+		while (g_queue_is_empty(threads->queue) && !threads->shutdown) {
+			pthread_cond_wait(&threads->wakeCondition, &threads->mutex);
+		}
+
+		if (threads->shutdown) {
+			break;
+		}
+
+		ShovelerActivationTask* task = g_queue_pop_head(threads->queue);
+		pthread_mutex_unlock(&threads->mutex);
+
+		shovelerActivationTaskRun(task);
+
+		pthread_mutex_lock(&threads->mutex);
+		g_hash_table_add(threads->finishedTasks, task);
+		pthread_cond_broadcast(&threads->finishedCondition);
+	}
+	pthread_mutex_unlock(&threads->mutex);
+
+	return NULL;
+}
+#endif
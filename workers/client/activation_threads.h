@@ -0,0 +1,28 @@
+#ifndef SHOVELER_CLIENT_ACTIVATION_THREADS_H
+#define SHOVELER_CLIENT_ACTIVATION_THREADS_H
+
+#include <shoveler/activation_pool.h>
+
+typedef struct ShovelerClientActivationThreadsStruct ShovelerClientActivationThreads;
+
+/**
+ * Worker threads that run the CPU heavy part of deferred component activations, such as decoding
+ * image resources, so that they don't stall rendering.
+ *
+ * The threads are handed to an activation pool through the returned adapter. Tasks are picked up
+ * in submission order by whichever thread is idle, and the pool commits them back on the main
+ * thread once they finished. Cancelled tasks still run to completion, but are discarded instead
+ * of committed.
+ *
+ * With zero threads, or on platforms without pthreads, tasks run synchronously as soon as they are
+ * submitted. They are still only committed by the pool, so this is a deterministic mode with the
+ * same commit order that e.g. tests and replays can rely on.
+ */
+ShovelerClientActivationThreads* shovelerClientActivationThreadsCreate(int numThreads);
+/** Returns the adapter to create an activation pool with, owned by the threads. */
+ShovelerActivationPoolAdapter* shovelerClientActivationThreadsGetAdapter(ShovelerClientActivationThreads* threads);
+int shovelerClientActivationThreadsGetNumThreads(ShovelerClientActivationThreads* threads);
+/** Stops the threads. The activation pool using them must have been freed before. */
+void shovelerClientActivationThreadsFree(ShovelerClientActivationThreads* threads);
+
+#endif
@@ -0,0 +1,123 @@
+/**
+ * Runs batches of fake activation tasks on the client's activation threads, with and without
+ * worker threads, and checks that every task runs exactly once and that its writes are visible to
+ * the main thread once the adapter reports it as finished.
+ *
+ * Usage: activation_threads_test
+ */
+#include <stdbool.h> // bool
+#include <stdint.h> // uint32_t
+#include <stdio.h> // fprintf printf
+#include <stdlib.h> // EXIT_FAILURE EXIT_SUCCESS malloc free
+
+#include <shoveler/activation_pool.h>
+#include <shoveler/component.h>
+
+#include "activation_threads.h"
+
+typedef struct {
+	int index;
+	int numRuns;
+	uint32_t result;
+} Job;
+
+static bool runBatch(int numThreads, int numTasks);
+static void runJob(void* jobPointer, void* userData);
+static uint32_t computeResult(int index);
+
+int main(int argc, char** argv)
+{
+	if (argc != 1) {
+		fprintf(stderr, "Usage:\n\t%s\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	bool success = true;
+	success = runBatch(/* numThreads */ 0, /* numTasks */ 64) && success;
+	success = runBatch(/* numThreads */ 1, /* numTasks */ 64) && success;
+	success = runBatch(/* numThreads */ 4, /* numTasks */ 256) && success;
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static bool runBatch(int numThreads, int numTasks)
+{
+	ShovelerClientActivationThreads* threads = shovelerClientActivationThreadsCreate(numThreads);
+	ShovelerActivationPoolAdapter* adapter = shovelerClientActivationThreadsGetAdapter(threads);
+
+	ShovelerComponentSystemAdapter systemAdapter;
+	systemAdapter.runActivation = runJob;
+	systemAdapter.userData = NULL;
+
+	Job* jobs = malloc(numTasks * sizeof(Job));
+	ShovelerActivationTask* tasks = malloc(numTasks * sizeof(ShovelerActivationTask));
+	for (int i = 0; i < numTasks; i++) {
+		jobs[i].index = i;
+		jobs[i].numRuns = 0;
+		jobs[i].result = 0;
+
+		tasks[i].pool = NULL;
+		tasks[i].component = NULL;
+		tasks[i].systemAdapter = &systemAdapter;
+		tasks[i].job = &jobs[i];
+		adapter->submit(&tasks[i], adapter->userData);
+	}
+
+	bool success = true;
+	if (numThreads == 0) {
+		// the deterministic mode runs everything right on submission
+		for (int i = 0; i < numTasks; i++) {
+			if (!adapter->isFinished(&tasks[i], /* wait */ false, adapter->userData)) {
+				fprintf(stderr, "%d threads: task %d didn't run synchronously.\n", numThreads, i);
+				success = false;
+			}
+		}
+	}
+
+	for (int i = 0; i < numTasks; i++) {
+		if (!adapter->isFinished(&tasks[i], /* wait */ true, adapter->userData)) {
+			fprintf(stderr, "%d threads: task %d isn't finished after waiting for it.\n", numThreads, i);
+			success = false;
+			continue;
+		}
+
+		if (jobs[i].numRuns != 1 || jobs[i].result != computeResult(i)) {
+			fprintf(stderr, "%d threads: task %d ran %d times with result %u.\n", numThreads, i, jobs[i].numRuns, jobs[i].result);
+			success = false;
+		}
+
+		adapter->release(&tasks[i], adapter->userData);
+		if (adapter->isFinished(&tasks[i], /* wait */ false, adapter->userData)) {
+			fprintf(stderr, "%d threads: task %d is still tracked after releasing it.\n", numThreads, i);
+			success = false;
+		}
+	}
+
+	printf("%d threads: %d tasks %s\n", shovelerClientActivationThreadsGetNumThreads(threads), numTasks, success ? "passed" : "FAILED");
+
+	shovelerClientActivationThreadsFree(threads);
+	free(tasks);
+	free(jobs);
+
+	return success;
+}
+
+static void runJob(void* jobPointer, void* userData)
+{
+	Job* job = jobPointer;
+	job->numRuns++;
+	job->result = computeResult(job->index);
+}
+
+static uint32_t computeResult(int index)
+{
+	// enough busy work for tasks to overlap between threads
+	uint32_t state = (uint32_t) index + 1;
+	for (int i = 0; i < 10000; i++) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+	}
+
+	return state;
+}
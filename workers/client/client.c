@@ -5,6 +5,7 @@
 
 #include <improbable/c_schema.h>
 #include <improbable/c_worker.h>
+#include <shoveler/activation_pool.h>
 #include <shoveler/camera/perspective.h>
 #include <shoveler/constants.h>
 #include <shoveler/component.h>
@@ -15,6 +16,7 @@
 #include <shoveler/entity_component_id.h>
 #include <shoveler/global.h>
 #include <shoveler/log.h>
+#include <shoveler/position_publisher.h>
 #include <shoveler/resources/image_png.h>
 #include <shoveler/resources.h>
 #include <shoveler/spatialos_schema.h>
@@ -22,8 +24,10 @@
 #include <shoveler/worker_log.h>
 #include <shoveler/world.h>
 
+#include "activation_threads.h"
 #include "configuration.h"
 #include "interest.h"
+#include "interest_scheduler.h"
 #include "spatialos_client_schema.h"
 
 typedef struct {
@@ -37,16 +41,23 @@ typedef struct {
 	bool clientInterestAuthoritative;
 	bool absoluteInterest;
 	bool restrictController;
-	bool worldDependenciesUpdated;
-	double lastInterestUpdatePositionY;
-	double edgeLength;
-	ShovelerVector3 lastImprobablePosition;
+	ShovelerClientInterestScheduler interestScheduler;
+	ShovelerWorkerPositionPublisher positionPublisher;
+	ShovelerWorkerPositionPublisher improbablePositionPublisher;
+	ShovelerWorkerPositionStream positionStream;
+	/* map from entity ID to EntityPositionStream of received quantized positions */
+	GHashTable* positionStreams;
 	bool improbablePositionAuthoritative;
 	int64_t lastHeartbeatPongTime;
 	double meanHeartbeatLatencyMs;
 	double meanTimeSinceLastHeartbeatPongMs;
 } ClientContext;
 
+typedef struct {
+	long long int entityId;
+	ShovelerWorkerPositionStream stream;
+} EntityPositionStream;
+
 static const long long int bootstrapEntityId = 1;
 static const int64_t clientPingTimeoutMs = 999;
 static const int64_t clientStatusTimeoutMs = 2449;
@@ -58,6 +69,7 @@ static void onAddComponent(ClientContext* context, const Worker_AddComponentOp*
 static void onAuthorityChange(ClientContext* context, const Worker_ComponentSetAuthorityChangeOp* op);
 static void onUpdateComponent(ClientContext* context, const Worker_ComponentUpdateOp* op);
 static void onRemoveComponent(ClientContext* context, const Worker_RemoveComponentOp* op);
+static ShovelerWorkerPositionStream* getEntityPositionStream(ClientContext* context, long long int entityId, const char* componentTypeId);
 static void updateGame(ShovelerGame* game, double dt);
 static void updateAuthoritativeWorldComponentFunction(
 	ShovelerClientSystem* clientSystem,
@@ -65,12 +77,16 @@ static void updateAuthoritativeWorldComponentFunction(
 	const ShovelerComponentField* field,
 	const ShovelerComponentFieldValue* value,
 	void* clientContextPointer);
+static void publishClientPosition(ClientContext* context);
+static void publishPosition(ShovelerVector3 coordinates, void* clientContextPointer);
+static void publishImprobablePosition(ShovelerVector3 position, void* clientContextPointer);
 static void clientPingTick(void* clientContextPointer);
 static void clientStatus(void* clientContextPointer);
 static void mouseButtonEvent(ShovelerInput* input, int button, int action, int mods, void* clientContextPointer);
 static void dependencyChanged(ShovelerWorld* world, const ShovelerEntityComponentId* dependencySource, const ShovelerEntityComponentId* dependencyTarget, bool added, void* clientContextPointer);
 static void updateInterest(ClientContext* context, bool absoluteInterest, ShovelerVector3 position, double edgeLength);
-static void updateEdgeLength(ClientContext* context, ShovelerVector3 position);
+static void sendInterest(double edgeLength, ShovelerVector3 center, void* clientContextPointer);
+static void updateInterestScheduler(ClientContext* context, ShovelerVector3 position);
 static void keyHandler(ShovelerInput* input, int key, int scancode, int action, int mods, void* clientContextPointer);
 static ShovelerVector3 getEntitySpatialOsPosition(ShovelerWorld* world, ShovelerCoordinateMapping mappingX, ShovelerCoordinateMapping mappingY, ShovelerCoordinateMapping mappingZ, long long int entityId);
 
@@ -163,10 +179,15 @@ int main(int argc, char** argv)
 	context.clientInterestAuthoritative = false;
 	context.absoluteInterest = false;
 	context.restrictController = true;
-	context.worldDependenciesUpdated = false;
-	context.lastInterestUpdatePositionY = 0.0f;
-	context.edgeLength = 20.5f;
-	context.lastImprobablePosition = shovelerVector3(0.0f, 0.0f, 0.0f);
+	shovelerClientInterestSchedulerInit(&context.interestScheduler, shovelerClientInterestSchedulerDefaultSettings(), sendInterest, &context);
+	shovelerWorkerPositionPublisherInit(&context.positionPublisher, shovelerWorkerPositionPublisherDefaultSettings(), publishPosition, &context);
+	ShovelerWorkerPositionPublisherSettings improbablePositionPublisherSettings = shovelerWorkerPositionPublisherDefaultSettings();
+	improbablePositionPublisherSettings.minDistance = improbablePositionUpdateDistance;
+	improbablePositionPublisherSettings.extrapolationTolerance = 0.0f;
+	shovelerWorkerPositionPublisherInit(&context.improbablePositionPublisher, improbablePositionPublisherSettings, publishImprobablePosition, &context);
+	context.positionStream.hasOrigin = false;
+	context.positionStream.origin = 0;
+	context.positionStreams = g_hash_table_new_full(g_int64_hash, g_int64_equal, /* keyDestroyFunc */ NULL, free);
 	context.improbablePositionAuthoritative = false;
 	context.lastHeartbeatPongTime = g_get_monotonic_time();
 	context.meanHeartbeatLatencyMs = 0.0;
@@ -183,6 +204,10 @@ int main(int argc, char** argv)
 		&context);
 	context.world = clientSystem->world;
 
+	ShovelerClientActivationThreads* activationThreads = shovelerClientActivationThreadsCreate(clientConfiguration.activationThreads);
+	ShovelerActivationPool* activationPool = shovelerActivationPoolCreate(shovelerClientActivationThreadsGetAdapter(activationThreads));
+	shovelerWorldSetActivationPool(context.world, activationPool);
+
 	shovelerInputAddKeyCallback(game->input, keyHandler, &context);
 	shovelerInputAddMouseButtonCallback(game->input, mouseButtonEvent, &context);
 	ShovelerExecutorCallback* clientStatusCallback = shovelerExecutorSchedulePeriodic(game->updateExecutor, 0, clientStatusTimeoutMs, clientStatus, &context);
@@ -193,14 +218,15 @@ int main(int argc, char** argv)
 	game->controller->lockTiltX = clientConfiguration.controllerLockTiltX;
 	game->controller->lockTiltY = clientConfiguration.controllerLockTiltY;
 
+	// Nothing is loaded through these resources until the schema has a resource request channel, so
+	// their type budgets and eviction don't bound the client's memory yet. Resource data still comes
+	// in as resource components and stays loaded for as long as those are part of the world.
 	ShovelerResources* resources = shovelerResourcesCreate(/* TODO: on demand resource loading */ NULL, NULL);
 	shovelerResourcesImagePngRegister(resources);
 
 	shovelerWorldAddDependencyCallback(context.world, dependencyChanged, &context);
 
 	while (shovelerGameIsRunning(game) && !context.disconnected) {
-		context.worldDependenciesUpdated = false;
-
 		Worker_OpList* opList = Worker_Connection_GetOpList(connection, 0);
 		for (size_t i = 0; i < opList->op_count; ++i) {
 			Worker_Op* op = &opList->ops[i];
@@ -223,6 +249,7 @@ int main(int argc, char** argv)
 				break;
 			case WORKER_OP_TYPE_REMOVE_ENTITY:
 				shovelerWorldRemoveEntity(context.world, op->op.add_entity.entity_id);
+				g_hash_table_remove(context.positionStreams, &op->op.remove_entity.entity_id);
 				break;
 			case WORKER_OP_TYPE_RESERVE_ENTITY_IDS_RESPONSE:
 				shovelerLogTrace("WORKER_OP_TYPE_RESERVE_ENTITY_IDS_RESPONSE");
@@ -271,13 +298,17 @@ int main(int argc, char** argv)
 		}
 		Worker_OpList_Destroy(opList);
 
+		// complete activations whose images finished decoding in the background since the last frame
+		shovelerActivationPoolCommit(activationPool, /* wait */ false);
+
 		shovelerGameRenderFrame(game);
+		publishClientPosition(&context);
 
 		ShovelerVector3 position = getEntitySpatialOsPosition(context.world, clientConfiguration.positionMappingX, clientConfiguration.positionMappingY, clientConfiguration.positionMappingZ, context.clientEntityId);
-		updateEdgeLength(&context, position);
+		updateInterestScheduler(&context, position);
 
-		if (context.clientInterestAuthoritative && context.worldDependenciesUpdated) {
-			updateInterest(&context, context.absoluteInterest, position, context.edgeLength);
+		if (context.clientInterestAuthoritative) {
+			shovelerClientInterestSchedulerUpdate(&context.interestScheduler, g_get_monotonic_time());
 		}
 	}
 	shovelerLogInfo("Exiting main loop, goodbye.");
@@ -285,7 +316,11 @@ int main(int argc, char** argv)
 	Worker_Connection_Destroy(connection);
 
 	shovelerExecutorRemoveCallback(game->updateExecutor, clientStatusCallback);
+	shovelerWorldSetActivationPool(context.world, NULL);
+	shovelerActivationPoolFree(activationPool);
+	shovelerClientActivationThreadsFree(activationThreads);
 	shovelerClientSystemFree(clientSystem);
+	g_hash_table_destroy(context.positionStreams);
 	shovelerGameFree(game);
 	shovelerResourcesFree(resources);
 	shovelerGlobalUninit();
@@ -335,7 +370,6 @@ static void onAddComponent(ClientContext* context, const Worker_AddComponentOp*
 			float mappedCoordinatesX = shovelerCoordinateMap(coordinates, context->clientConfiguration->positionMappingX);
 			float mappedCoordinatesY = shovelerCoordinateMap(coordinates, context->clientConfiguration->positionMappingY);
 			float mappedCoordinatesZ = shovelerCoordinateMap(coordinates, context->clientConfiguration->positionMappingZ);
-			context->lastImprobablePosition = shovelerVector3(mappedCoordinatesX, mappedCoordinatesY, mappedCoordinatesZ);
 
 			shovelerLogTrace("Added Improbable Position component to client entity %lld with mapped coordinates (%.2f, %.2f, %.2f).", op->entity_id, mappedCoordinatesX, mappedCoordinatesY, mappedCoordinatesZ);
 
@@ -363,6 +397,7 @@ static void onAddComponent(ClientContext* context, const Worker_AddComponentOp*
 		world,
 		component,
 		op->data.schema_type,
+		getEntityPositionStream(context, op->entity_id, componentTypeId),
 		context->clientConfiguration->positionMappingX,
 		context->clientConfiguration->positionMappingY,
 		context->clientConfiguration->positionMappingZ);
@@ -400,7 +435,7 @@ static void onAuthorityChange(ClientContext* context, const Worker_ComponentSetA
 
 		shovelerLogTrace("Received authority over interest component of client entity %lld.", op->entity_id);
 		context->clientInterestAuthoritative = true;
-		context->worldDependenciesUpdated = true;
+		shovelerClientInterestSchedulerTrigger(&context->interestScheduler);
 		shovelerLogTrace("Received authority over Improbable position component of client entity %lld.", op->entity_id);
 		context->improbablePositionAuthoritative = true;
 	} else if (op->authority == WORKER_AUTHORITY_NOT_AUTHORITATIVE) {
@@ -414,8 +449,13 @@ static void onAuthorityChange(ClientContext* context, const Worker_ComponentSetA
 
 		shovelerLogWarning("Lost interest authority over client entity %lld.", op->entity_id);
 		context->clientInterestAuthoritative = false;
+		shovelerClientInterestSchedulerReset(&context->interestScheduler);
 		shovelerLogWarning("Lost Improbable position authority over client entity %lld.", op->entity_id);
 		context->improbablePositionAuthoritative = false;
+
+		shovelerWorkerPositionPublisherReset(&context->positionPublisher);
+		shovelerWorkerPositionPublisherReset(&context->improbablePositionPublisher);
+		context->positionStream.hasOrigin = false;
 	}
 }
 
@@ -483,6 +523,7 @@ static void onUpdateComponent(ClientContext* context, const Worker_ComponentUpda
 		world,
 		component,
 		op->update.schema_type,
+		getEntityPositionStream(context, op->entity_id, componentTypeId),
 		context->clientConfiguration->positionMappingX,
 		context->clientConfiguration->positionMappingY,
 		context->clientConfiguration->positionMappingZ);
@@ -520,6 +561,28 @@ static void onRemoveComponent(ClientContext* context, const Worker_RemoveCompone
 
 	shovelerLogTrace("Removing entity %lld component %d (%s).", op->entity_id, op->component_id, componentTypeId);
 	shovelerWorldEntityRemoveComponent(entity, componentTypeId);
+
+	if (componentTypeId == shovelerComponentTypeIdPosition) {
+		g_hash_table_remove(context->positionStreams, &op->entity_id);
+	}
+}
+
+static ShovelerWorkerPositionStream* getEntityPositionStream(ClientContext* context, long long int entityId, const char* componentTypeId)
+{
+	if (componentTypeId != shovelerComponentTypeIdPosition) {
+		return NULL;
+	}
+
+	EntityPositionStream* entityPositionStream = g_hash_table_lookup(context->positionStreams, &entityId);
+	if (entityPositionStream == NULL) {
+		entityPositionStream = malloc(sizeof(EntityPositionStream));
+		entityPositionStream->entityId = entityId;
+		entityPositionStream->stream.hasOrigin = false;
+		entityPositionStream->stream.origin = 0;
+		g_hash_table_insert(context->positionStreams, &entityPositionStream->entityId, entityPositionStream);
+	}
+
+	return &entityPositionStream->stream;
 }
 
 static void updateGame(ShovelerGame* game, double dt)
@@ -536,36 +599,68 @@ static void updateAuthoritativeWorldComponentFunction(
 {
 	ClientContext* context = (ClientContext*) clientContextPointer;
 
-	{
-		Schema_ComponentUpdate* componentUpdate = shovelerClientCreateComponentUpdate(component, field, value);
+	// moving the client entity changes its coordinates every frame, which are published separately
+	if (component->type->id == shovelerComponentTypeIdPosition && field == &component->type->fields[SHOVELER_COMPONENT_POSITION_FIELD_ID_COORDINATES]) {
+		return;
+	}
 
-		Worker_ComponentUpdate update;
-		update.component_id = shovelerClientResolveComponentSchemaId(component->type->id);
-		update.schema_type = componentUpdate;
+	Schema_ComponentUpdate* componentUpdate = shovelerClientCreateComponentUpdate(component, field, value);
 
-		Worker_Connection_SendComponentUpdate(context->connection, component->entityId, &update);
-	}
+	Worker_ComponentUpdate update;
+	update.component_id = shovelerClientResolveComponentSchemaId(component->type->id);
+	update.schema_type = componentUpdate;
 
-	// check if we also need to update our Improbable position
-	if (component->type->id == shovelerComponentTypeIdPosition && context->improbablePositionAuthoritative) {
-		const ShovelerVector3* position = shovelerComponentGetPosition(component);
-		ShovelerVector3 difference = shovelerVector3LinearCombination(1.0f, *position, -1.0f, context->lastImprobablePosition);
-		float distance2 = shovelerVector3Dot(difference, difference);
+	Worker_Connection_SendComponentUpdate(context->connection, component->entityId, &update);
+}
 
-		if (distance2 > improbablePositionUpdateDistance * improbablePositionUpdateDistance) {
-			Schema_ComponentUpdate* componentUpdate = shovelerClientCreateImprobablePositionUpdate(*position, context->clientConfiguration->positionMappingX, context->clientConfiguration->positionMappingY, context->clientConfiguration->positionMappingZ);
+static void publishClientPosition(ClientContext* context)
+{
+	ShovelerWorldEntity* entity = shovelerWorldGetEntity(context->world, context->clientEntityId);
+	if (entity == NULL) {
+		return;
+	}
 
-			Worker_ComponentUpdate update;
-			update.component_id = shovelerWorkerSchemaComponentIdImprobablePosition;
-			update.schema_type = componentUpdate;
+	ShovelerComponent* component = shovelerWorldEntityGetComponent(entity, shovelerComponentTypeIdPosition);
+	if (component == NULL || !shovelerComponentIsAuthoritative(component)) {
+		return;
+	}
 
-			Worker_Connection_SendComponentUpdate(context->connection, component->entityId, &update);
+	int64_t now = g_get_monotonic_time();
+	ShovelerVector3 coordinates = shovelerComponentGetFieldValueVector3(component, SHOVELER_COMPONENT_POSITION_FIELD_ID_COORDINATES);
+	shovelerWorkerPositionPublisherUpdate(&context->positionPublisher, coordinates, now);
 
-			context->lastImprobablePosition = *position;
-		}
+	if (context->improbablePositionAuthoritative && shovelerComponentIsActive(component)) {
+		shovelerWorkerPositionPublisherUpdate(&context->improbablePositionPublisher, *shovelerComponentGetPosition(component), now);
 	}
 }
 
+static void publishPosition(ShovelerVector3 coordinates, void* clientContextPointer)
+{
+	ClientContext* context = (ClientContext*) clientContextPointer;
+
+	Schema_ComponentUpdate* componentUpdate = Schema_CreateComponentUpdate();
+	shovelerWorkerSchemaAddPositionUpdateCoordinates(componentUpdate, &context->positionStream, context->clientConfiguration->quantizedPositions, coordinates);
+
+	Worker_ComponentUpdate update;
+	update.component_id = shovelerWorkerSchemaComponentIdPosition;
+	update.schema_type = componentUpdate;
+
+	Worker_Connection_SendComponentUpdate(context->connection, context->clientEntityId, &update);
+}
+
+static void publishImprobablePosition(ShovelerVector3 position, void* clientContextPointer)
+{
+	ClientContext* context = (ClientContext*) clientContextPointer;
+
+	Schema_ComponentUpdate* componentUpdate = shovelerClientCreateImprobablePositionUpdate(position, context->clientConfiguration->positionMappingX, context->clientConfiguration->positionMappingY, context->clientConfiguration->positionMappingZ);
+
+	Worker_ComponentUpdate update;
+	update.component_id = shovelerWorkerSchemaComponentIdImprobablePosition;
+	update.schema_type = componentUpdate;
+
+	Worker_Connection_SendComponentUpdate(context->connection, context->clientEntityId, &update);
+}
+
 static void clientPingTick(void* clientContextPointer)
 {
 	ClientContext* context = (ClientContext*) clientContextPointer;
@@ -679,7 +774,7 @@ static void mouseButtonEvent(ShovelerInput* input, int button, int action, int m
 static void dependencyChanged(ShovelerWorld* world, const ShovelerEntityComponentId* dependencySource, const ShovelerEntityComponentId* dependencyTarget, bool added, void* clientContextPointer)
 {
 	ClientContext* context = (ClientContext*) clientContextPointer;
-	context->worldDependenciesUpdated = true;
+	shovelerClientInterestSchedulerTrigger(&context->interestScheduler);
 }
 
 static void updateInterest(ClientContext* context, bool absoluteInterest, ShovelerVector3 position, double edgeLength)
@@ -701,24 +796,25 @@ static void updateInterest(ClientContext* context, bool absoluteInterest, Shovel
 	shovelerLogInfo("Sent interest update with %d queries.", numQueries);
 }
 
-static void updateEdgeLength(ClientContext* context, ShovelerVector3 position)
+static void sendInterest(double edgeLength, ShovelerVector3 center, void* clientContextPointer)
 {
-	if (context->absoluteInterest) {
-		return;
-	}
+	ClientContext* context = (ClientContext*) clientContextPointer;
+	updateInterest(context, context->absoluteInterest, center, edgeLength);
+}
 
-	double positionChangeY = fabs(position.values[1] - context->lastInterestUpdatePositionY);
-	if (fabs(positionChangeY) < 0.5f) {
+static void updateInterestScheduler(ClientContext* context, ShovelerVector3 position)
+{
+	if (context->absoluteInterest) {
+		shovelerClientInterestSchedulerUpdateCenter(&context->interestScheduler, position);
 		return;
 	}
 
-	context->edgeLength = 20.5f * position.values[1] / 5.0f;
-	if (context->edgeLength < 20.5f) {
-		context->edgeLength = 20.5f;
+	double targetEdgeLength = 20.5f * position.values[1] / 5.0f;
+	if (targetEdgeLength < 20.5f) {
+		targetEdgeLength = 20.5f;
 	}
 
-	context->lastInterestUpdatePositionY = position.values[1];
-	context->worldDependenciesUpdated = true;
+	shovelerClientInterestSchedulerUpdateEdgeLength(&context->interestScheduler, targetEdgeLength);
 }
 
 static void keyHandler(ShovelerInput* input, int key, int scancode, int action, int mods, void* clientContextPointer)
@@ -729,9 +825,8 @@ static void keyHandler(ShovelerInput* input, int key, int scancode, int action,
 		shovelerLogInfo("F7 key pressed, changing to %s interest.", context->absoluteInterest ? "relative" : "absolute");
 		context->absoluteInterest = !context->absoluteInterest;
 
-		ShovelerVector3 position = getEntitySpatialOsPosition(context->world, context->clientConfiguration->positionMappingX, context->clientConfiguration->positionMappingY, context->clientConfiguration->positionMappingZ, context->clientEntityId);
-		updateEdgeLength(context, position);
-		updateInterest(context, context->absoluteInterest, position, context->edgeLength);
+		// the switch is picked up by the scheduler at the end of the frame
+		shovelerClientInterestSchedulerTrigger(&context->interestScheduler);
 	}
 
 	if (key == GLFW_KEY_F8 && action == GLFW_PRESS) {
@@ -26,6 +26,8 @@ bool shovelerClientGetWorkerConfiguration(Worker_Connection *connection, Shovele
 	outputClientConfiguration->positionMappingZ = SHOVELER_COORDINATE_MAPPING_POSITIVE_Z;
 	outputClientConfiguration->hidePlayerClientEntityModel = true;
 	outputClientConfiguration->gameType = SHOVELER_WORKER_GAME_TYPE_LIGHTS;
+	outputClientConfiguration->quantizedPositions = false;
+	outputClientConfiguration->activationThreads = 2;
 
 	shovelerWorkerConfigurationParseVector3Flag(connection, "controller_frame_position", &outputClientConfiguration->controllerSettings.frame.position);
 	shovelerWorkerConfigurationParseVector3Flag(connection, "controller_frame_direction", &outputClientConfiguration->controllerSettings.frame.direction);
@@ -44,6 +46,8 @@ bool shovelerClientGetWorkerConfiguration(Worker_Connection *connection, Shovele
 	shovelerWorkerConfigurationParseCoordinateMappingFlag(connection, "position_mapping_z", &outputClientConfiguration->positionMappingZ);
 	shovelerWorkerConfigurationParseBoolFlag(connection, "hide_player_client_entity_model", &outputClientConfiguration->hidePlayerClientEntityModel);
 	shovelerWorkerConfigurationParseGameTypeFlag(connection, "game_type", &outputClientConfiguration->gameType);
+	shovelerWorkerConfigurationParseBoolFlag(connection, "quantized_positions", &outputClientConfiguration->quantizedPositions);
+	shovelerWorkerConfigurationParseIntFlag(connection, "activation_threads", &outputClientConfiguration->activationThreads);
 
 	return true;
 }
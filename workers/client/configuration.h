@@ -19,6 +19,8 @@ typedef struct {
 	ShovelerCoordinateMapping positionMappingZ;
 	bool hidePlayerClientEntityModel;
 	ShovelerWorkerGameType gameType;
+	bool quantizedPositions;
+	int activationThreads;
 } ShovelerClientConfiguration;
 
 bool shovelerClientGetWorkerConfiguration(Worker_Connection *connection, ShovelerClientConfiguration *outputClientConfiguration);
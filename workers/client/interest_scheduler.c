@@ -0,0 +1,104 @@
+#include "interest_scheduler.h"
+
+static float groundDistanceSquared(ShovelerVector3 a, ShovelerVector3 b);
+
+ShovelerClientInterestSchedulerSettings shovelerClientInterestSchedulerDefaultSettings()
+{
+	ShovelerClientInterestSchedulerSettings settings;
+	settings.minIntervalUs = 250 * 1000;
+	settings.growMargin = 0.1;
+	settings.shrinkThreshold = 0.25;
+	settings.recenterThreshold = 0.25;
+	return settings;
+}
+
+void shovelerClientInterestSchedulerInit(ShovelerClientInterestScheduler* scheduler, ShovelerClientInterestSchedulerSettings settings, ShovelerClientInterestSendFunction* send, void* userData)
+{
+	scheduler->settings = settings;
+	scheduler->send = send;
+	scheduler->userData = userData;
+	scheduler->hasEdgeLength = false;
+	scheduler->edgeLength = 0.0;
+	scheduler->center = shovelerVector3(0.0f, 0.0f, 0.0f);
+	scheduler->numTriggers = 0;
+	scheduler->numSent = 0;
+	shovelerClientInterestSchedulerReset(scheduler);
+}
+
+void shovelerClientInterestSchedulerTrigger(ShovelerClientInterestScheduler* scheduler)
+{
+	scheduler->pending = true;
+	scheduler->numTriggers++;
+}
+
+void shovelerClientInterestSchedulerUpdateEdgeLength(ShovelerClientInterestScheduler* scheduler, double targetEdgeLength)
+{
+	ShovelerClientInterestSchedulerSettings* settings = &scheduler->settings;
+
+	if (!scheduler->hasEdgeLength) {
+		scheduler->hasEdgeLength = true;
+		scheduler->edgeLength = targetEdgeLength;
+		shovelerClientInterestSchedulerTrigger(scheduler);
+		return;
+	}
+
+	bool grow = targetEdgeLength > scheduler->edgeLength;
+	bool shrink = targetEdgeLength < (1.0 - settings->shrinkThreshold) * scheduler->edgeLength;
+	if (!grow && !shrink) {
+		return;
+	}
+
+	scheduler->edgeLength = (1.0 + settings->growMargin) * targetEdgeLength;
+	shovelerClientInterestSchedulerTrigger(scheduler);
+}
+
+void shovelerClientInterestSchedulerUpdateCenter(ShovelerClientInterestScheduler* scheduler, ShovelerVector3 center)
+{
+	scheduler->center = center;
+
+	if (scheduler->pending || !scheduler->hasSent) {
+		// the center is picked up when sending anyway
+		return;
+	}
+
+	double recenterDistance = scheduler->settings.recenterThreshold * scheduler->edgeLength;
+	if (groundDistanceSquared(center, scheduler->sentCenter) > recenterDistance * recenterDistance) {
+		shovelerClientInterestSchedulerTrigger(scheduler);
+	}
+}
+
+bool shovelerClientInterestSchedulerUpdate(ShovelerClientInterestScheduler* scheduler, int64_t now)
+{
+	if (!scheduler->pending) {
+		return false;
+	}
+
+	if (scheduler->hasSent && now - scheduler->sentTime < scheduler->settings.minIntervalUs) {
+		return false;
+	}
+
+	scheduler->pending = false;
+	scheduler->hasSent = true;
+	scheduler->sentTime = now;
+	scheduler->sentCenter = scheduler->center;
+	scheduler->numSent++;
+
+	scheduler->send(scheduler->edgeLength, scheduler->center, scheduler->userData);
+	return true;
+}
+
+void shovelerClientInterestSchedulerReset(ShovelerClientInterestScheduler* scheduler)
+{
+	scheduler->sentCenter = shovelerVector3(0.0f, 0.0f, 0.0f);
+	scheduler->pending = false;
+	scheduler->hasSent = false;
+	scheduler->sentTime = 0;
+}
+
+/** Compares positions on the ground plane of the interest box, ignoring the vertical coordinate. */
+static float groundDistanceSquared(ShovelerVector3 a, ShovelerVector3 b)
+{
+	float dx = a.values[0] - b.values[0];
+	float dz = a.values[2] - b.values[2];
+	return dx * dx + dz * dz;
+}
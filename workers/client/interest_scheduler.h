@@ -0,0 +1,63 @@
+#ifndef SHOVELER_CLIENT_INTEREST_SCHEDULER_H
+#define SHOVELER_CLIENT_INTEREST_SCHEDULER_H
+
+#include <stdbool.h> // bool
+#include <stdint.h> // int64_t
+
+#include <shoveler/types.h>
+
+typedef void(ShovelerClientInterestSendFunction)(double edgeLength, ShovelerVector3 center, void* userData);
+
+typedef struct {
+	/* minimum time between two sent interest queries */
+	int64_t minIntervalUs;
+	/* fraction of the target edge length added on top when the edge length changes, so that
+	 * slightly zooming out further doesn't immediately need another query */
+	double growMargin;
+	/* fraction by which the target edge length must fall below the current one before it shrinks */
+	double shrinkThreshold;
+	/* fraction of the edge length the center of an absolute query may drift before it is moved */
+	double recenterThreshold;
+} ShovelerClientInterestSchedulerSettings;
+
+/**
+ * Decides when the client's interest query needs to be recomputed and sent.
+ *
+ * Everything that invalidates the query only marks it as pending, and the owner calls update once
+ * per frame to send it. Triggers in between coalesce into a single query, which is sent once the
+ * minimum interval since the last one passed.
+ *
+ * The edge length follows the target derived from the zoom level with hysteresis: it grows as soon
+ * as the target exceeds it, then overshooting the target by the grow margin, and only shrinks
+ * again once the target falls below it by the shrink threshold. The center of absolute queries
+ * similarly only moves once it drifted away by the recenter threshold.
+ */
+typedef struct {
+	ShovelerClientInterestSchedulerSettings settings;
+	ShovelerClientInterestSendFunction* send;
+	void* userData;
+	bool hasEdgeLength;
+	double edgeLength;
+	ShovelerVector3 center;
+	ShovelerVector3 sentCenter;
+	bool pending;
+	bool hasSent;
+	int64_t sentTime;
+	int numTriggers;
+	int numSent;
+} ShovelerClientInterestScheduler;
+
+ShovelerClientInterestSchedulerSettings shovelerClientInterestSchedulerDefaultSettings();
+void shovelerClientInterestSchedulerInit(ShovelerClientInterestScheduler* scheduler, ShovelerClientInterestSchedulerSettings settings, ShovelerClientInterestSendFunction* send, void* userData);
+/** Marks the query as pending, e.g. because the world's dependencies changed. */
+void shovelerClientInterestSchedulerTrigger(ShovelerClientInterestScheduler* scheduler);
+/** Passes the edge length the current zoom level asks for, triggering if it leaves the hysteresis band. */
+void shovelerClientInterestSchedulerUpdateEdgeLength(ShovelerClientInterestScheduler* scheduler, double targetEdgeLength);
+/** Passes the center of absolute queries, triggering if it drifted too far from the sent one. */
+void shovelerClientInterestSchedulerUpdateCenter(ShovelerClientInterestScheduler* scheduler, ShovelerVector3 center);
+/** Sends a pending query if the minimum interval allows it at time now in microseconds, returning true if it did. */
+bool shovelerClientInterestSchedulerUpdate(ShovelerClientInterestScheduler* scheduler, int64_t now);
+/** Forgets about sent queries, e.g. after losing authority, so that the next one is sent right away. */
+void shovelerClientInterestSchedulerReset(ShovelerClientInterestScheduler* scheduler);
+
+#endif
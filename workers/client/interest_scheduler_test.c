@@ -0,0 +1,258 @@
+/**
+ * Drives the interest scheduler with synthetic zoom, dependency and movement traces, counting the
+ * queries it sends against the ones sent by resending on every change, and checks that the
+ * minimum interval is respected and the final query covers the final view.
+ *
+ * Usage: interest_scheduler_test
+ */
+#include <inttypes.h> // PRId64
+#include <math.h> // fabs sin M_PI
+#include <stdbool.h> // bool
+#include <stdint.h> // int64_t uint32_t
+#include <stdio.h> // fprintf printf
+#include <stdlib.h> // EXIT_FAILURE EXIT_SUCCESS
+
+#include <shoveler/types.h>
+
+#include "interest_scheduler.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+typedef struct {
+	/* camera height, which determines the zoom level */
+	double height;
+	ShovelerVector3 position;
+	int numDependencyChanges;
+} Frame;
+
+typedef struct {
+	const char* name;
+	int numFrames;
+	bool absoluteInterest;
+	void (*getFrame)(int frame, uint32_t* randomState, Frame* outputFrame);
+	/* maximum number of queries the scheduler may send */
+	int maxSent;
+} Trace;
+
+typedef struct {
+	int64_t time;
+	int64_t lastSendTime;
+	int64_t minIntervalUs;
+	double edgeLength;
+	ShovelerVector3 center;
+	int numSent;
+	bool rateViolated;
+} Receiver;
+
+static bool runTrace(const Trace* trace);
+static void zoomOutAndIn(int frame, uint32_t* randomState, Frame* outputFrame);
+static void jitterAtBoundary(int frame, uint32_t* randomState, Frame* outputFrame);
+static void walkAlongChunkBorder(int frame, uint32_t* randomState, Frame* outputFrame);
+static void walkAbsolute(int frame, uint32_t* randomState, Frame* outputFrame);
+static double getTargetEdgeLength(double height);
+static void receive(double edgeLength, ShovelerVector3 center, void* receiverPointer);
+static uint32_t nextRandom(uint32_t* state);
+
+static const int frameRateHz = 60;
+static const double minEdgeLength = 20.5;
+/* camera height change after which the client used to resend its interest */
+static const double legacyHeightThreshold = 0.5;
+
+int main(int argc, char** argv)
+{
+	if (argc != 1) {
+		fprintf(stderr, "Usage:\n\t%s\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	Trace traces[] = {
+		{"zoom out and back in", 7 * frameRateHz, false, zoomOutAndIn, 30},
+		{"zoom jitter at a boundary", 10 * frameRateHz, false, jitterAtBoundary, 2},
+		{"walk along a chunk border", 10 * frameRateHz, false, walkAlongChunkBorder, 41},
+		{"walk with absolute interest", 20 * frameRateHz, true, walkAbsolute, 12},
+	};
+	int numTraces = sizeof(traces) / sizeof(traces[0]);
+
+	bool success = true;
+	for (int i = 0; i < numTraces; i++) {
+		success = runTrace(&traces[i]) && success;
+	}
+
+	if (!success) {
+		return EXIT_FAILURE;
+	}
+
+	printf("All interest scheduler traces passed.\n");
+	return EXIT_SUCCESS;
+}
+
+static bool runTrace(const Trace* trace)
+{
+	ShovelerClientInterestSchedulerSettings settings = shovelerClientInterestSchedulerDefaultSettings();
+
+	Receiver receiver;
+	receiver.time = 0;
+	receiver.lastSendTime = 0;
+	receiver.minIntervalUs = settings.minIntervalUs;
+	receiver.edgeLength = 0.0;
+	receiver.center = shovelerVector3(0.0f, 0.0f, 0.0f);
+	receiver.numSent = 0;
+	receiver.rateViolated = false;
+
+	ShovelerClientInterestScheduler scheduler;
+	shovelerClientInterestSchedulerInit(&scheduler, settings, receive, &receiver);
+
+	uint32_t randomState = 42;
+	int64_t frameUs = 1000 * 1000 / frameRateHz;
+	int numLegacySent = 0;
+	double legacyHeight = 0.0;
+	Frame frame = {0.0, {{0.0f, 0.0f, 0.0f}}, 0};
+	int numFrames = trace->numFrames + frameRateHz; // settle for another second
+	for (int i = 0; i < numFrames; i++) {
+		if (i < trace->numFrames) {
+			trace->getFrame(i, &randomState, &frame);
+		} else {
+			frame.numDependencyChanges = 0;
+		}
+
+		// like the client used to: resend whenever anything changed during the frame
+		bool legacySend = i == 0 || frame.numDependencyChanges > 0;
+		if (!trace->absoluteInterest && fabs(frame.height - legacyHeight) >= legacyHeightThreshold) {
+			legacyHeight = frame.height;
+			legacySend = true;
+		}
+		if (legacySend) {
+			numLegacySent++;
+		}
+
+		for (int j = 0; j < frame.numDependencyChanges; j++) {
+			shovelerClientInterestSchedulerTrigger(&scheduler);
+		}
+		shovelerClientInterestSchedulerUpdateEdgeLength(&scheduler, getTargetEdgeLength(frame.height));
+		if (trace->absoluteInterest) {
+			shovelerClientInterestSchedulerUpdateCenter(&scheduler, frame.position);
+		}
+
+		receiver.time = i * frameUs;
+		shovelerClientInterestSchedulerUpdate(&scheduler, receiver.time);
+	}
+
+	printf(
+		"%s: sent %d queries for %d triggers, resending on every change would have sent %d\n",
+		trace->name,
+		scheduler.numSent,
+		scheduler.numTriggers,
+		numLegacySent);
+
+	bool success = true;
+	if (scheduler.numSent != receiver.numSent) {
+		fprintf(stderr, "%s: scheduler counted %d queries but %d were received\n", trace->name, scheduler.numSent, receiver.numSent);
+		success = false;
+	}
+
+	if (receiver.numSent > trace->maxSent) {
+		fprintf(stderr, "%s: expected at most %d queries\n", trace->name, trace->maxSent);
+		success = false;
+	}
+
+	if (receiver.rateViolated) {
+		fprintf(stderr, "%s: queries were sent more often than every %" PRId64 "us\n", trace->name, settings.minIntervalUs);
+		success = false;
+	}
+
+	if (scheduler.pending) {
+		fprintf(stderr, "%s: a query is still pending after settling\n", trace->name);
+		success = false;
+	}
+
+	double targetEdgeLength = getTargetEdgeLength(frame.height);
+	if (receiver.edgeLength < targetEdgeLength || receiver.edgeLength * (1.0 - settings.shrinkThreshold) > targetEdgeLength) {
+		fprintf(stderr, "%s: final edge length %.2f doesn't fit the final target %.2f\n", trace->name, receiver.edgeLength, targetEdgeLength);
+		success = false;
+	}
+
+	if (trace->absoluteInterest) {
+		double dx = receiver.center.values[0] - frame.position.values[0];
+		double dz = receiver.center.values[2] - frame.position.values[2];
+		double recenterDistance = settings.recenterThreshold * receiver.edgeLength;
+		if (dx * dx + dz * dz > recenterDistance * recenterDistance) {
+			fprintf(stderr, "%s: final center is further than %.2f from the final position\n", trace->name, recenterDistance);
+			success = false;
+		}
+	}
+
+	return success;
+}
+
+static void zoomOutAndIn(int frame, uint32_t* randomState, Frame* outputFrame)
+{
+	// zoom out from the default height over three seconds, hold for a second, and zoom back in
+	double t = (double) frame / frameRateHz;
+	double zoom = t < 3.0 ? t / 3.0 : (t < 4.0 ? 1.0 : (7.0 - t) / 3.0);
+
+	outputFrame->height = 5.0 + 35.0 * zoom;
+	outputFrame->position = shovelerVector3(0.0f, (float) outputFrame->height, 0.0f);
+	outputFrame->numDependencyChanges = 0;
+}
+
+static void jitterAtBoundary(int frame, uint32_t* randomState, Frame* outputFrame)
+{
+	// hovering the zoom around a level, e.g. on a touchpad
+	double t = (double) frame / frameRateHz;
+
+	outputFrame->height = 12.0 + 0.6 * sin(2.0 * M_PI * 2.0 * t);
+	outputFrame->position = shovelerVector3(0.0f, (float) outputFrame->height, 0.0f);
+	outputFrame->numDependencyChanges = 0;
+}
+
+static void walkAlongChunkBorder(int frame, uint32_t* randomState, Frame* outputFrame)
+{
+	// entities on both sides keep entering and leaving view, each changing a few dependencies
+	outputFrame->height = 5.0;
+	outputFrame->position = shovelerVector3(0.0f, 5.0f, (float) frame * 1.5f / frameRateHz);
+	outputFrame->numDependencyChanges = nextRandom(randomState) % 4 == 0 ? 1 + nextRandom(randomState) % 3 : 0;
+}
+
+static void walkAbsolute(int frame, uint32_t* randomState, Frame* outputFrame)
+{
+	// walk at bot speed, turning every five seconds
+	int leg = frame / (5 * frameRateHz);
+	float legProgress = (float) (frame % (5 * frameRateHz)) * 1.5f / frameRateHz;
+	float x = 7.5f * (float) ((leg + 1) / 2) + (leg % 2 == 0 ? legProgress : 0.0f);
+	float z = 7.5f * (float) (leg / 2) + (leg % 2 == 1 ? legProgress : 0.0f);
+
+	outputFrame->height = 5.0;
+	outputFrame->position = shovelerVector3(x, 5.0f, z);
+	outputFrame->numDependencyChanges = 0;
+}
+
+static double getTargetEdgeLength(double height)
+{
+	double edgeLength = minEdgeLength * height / 5.0;
+	if (edgeLength < minEdgeLength) {
+		edgeLength = minEdgeLength;
+	}
+
+	return edgeLength;
+}
+
+static void receive(double edgeLength, ShovelerVector3 center, void* receiverPointer)
+{
+	Receiver* receiver = (Receiver*) receiverPointer;
+	if (receiver->numSent > 0 && receiver->time - receiver->lastSendTime < receiver->minIntervalUs) {
+		receiver->rateViolated = true;
+	}
+
+	receiver->edgeLength = edgeLength;
+	receiver->center = center;
+	receiver->numSent++;
+	receiver->lastSendTime = receiver->time;
+}
+
+static uint32_t nextRandom(uint32_t* state)
+{
+	*state = *state * 1664525u + 1013904223u;
+	return *state >> 8;
+}
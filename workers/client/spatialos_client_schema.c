@@ -8,23 +8,28 @@
 #include <shoveler/component.h>
 #include <shoveler/component_field.h>
 #include <shoveler/component_type.h>
+#include <shoveler/component_type_id.h>
 #include <shoveler/log.h>
 #include <shoveler/schema/base.h>
 #include <shoveler/schema/opengl.h>
 #include <shoveler/spatialos_schema.h>
 #include <shoveler/world.h>
 
-static void updateComponentField(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set);
-static void updateEntityIdfield(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set);
-static void updateEntityIdArrayfield(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId);
-static void updateFloatfield(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set);
-static void updateBoolfield(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set);
-static void updateIntfield(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set);
-static void updateStringfield(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set);
-static void updateVector2field(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set);
-static void updateVector3field(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set);
-static void updateVector4field(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set);
-static void updateBytesfield(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set);
+static int resolveComponentSchemaIdUncached(const char* componentTypeId);
+static ShovelerClientSchemaComponentDescriptor* createComponentDescriptor(const ShovelerComponentType* componentType);
+static ShovelerClientSchemaDecodeFieldFunction* getDecodeFieldFunction(ShovelerComponentFieldType type);
+static bool decodeEntityIdField(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue);
+static bool decodeEntityIdArrayField(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue);
+static bool decodeFloatField(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue);
+static bool decodeBoolField(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue);
+static bool decodeIntField(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue);
+static bool decodeStringField(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue);
+static bool decodeVector2Field(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue);
+static bool decodeVector3Field(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue);
+static bool decodeVector4Field(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue);
+static bool decodeBytesField(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue);
+static void applyField(ShovelerComponent* component, const ShovelerClientSchemaFieldDescriptor* fieldDescriptor, Schema_Object* fields);
+static void updatePositionQuantizedCoordinates(ShovelerComponent* component, Schema_Object* fields, ShovelerWorkerPositionStream* positionStream);
 
 const char* shovelerClientResolveComponentTypeId(int componentId)
 {
@@ -82,7 +87,34 @@ const char* shovelerClientResolveComponentTypeId(int componentId)
 	}
 }
 
+/** array of int schema component ids indexed by interned component type id index, -1 if unresolved */
+static GArray* componentSchemaIds = NULL;
+
 int shovelerClientResolveComponentSchemaId(const char* componentTypeId)
+{
+	const ShovelerComponentTypeIdHandle* idHandle = shovelerComponentTypeIdLookup(componentTypeId);
+	if (idHandle == NULL) {
+		return resolveComponentSchemaIdUncached(componentTypeId);
+	}
+
+	if (componentSchemaIds == NULL) {
+		componentSchemaIds = g_array_new(/* zeroTerminated */ false, /* clear */ false, sizeof(int));
+	}
+
+	while (idHandle->index >= componentSchemaIds->len) {
+		int unresolved = -1;
+		g_array_append_val(componentSchemaIds, unresolved);
+	}
+
+	int* componentSchemaId = &g_array_index(componentSchemaIds, int, idHandle->index);
+	if (*componentSchemaId < 0) {
+		*componentSchemaId = resolveComponentSchemaIdUncached(idHandle->id);
+	}
+
+	return *componentSchemaId;
+}
+
+static int resolveComponentSchemaIdUncached(const char* componentTypeId)
 {
 	if (componentTypeId == shovelerComponentTypeIdPosition) {
 		return shovelerWorkerSchemaComponentIdPosition;
@@ -162,19 +194,47 @@ int shovelerClientResolveComponentSchemaId(const char* componentTypeId)
 	return 0;
 }
 
-void shovelerClientApplyComponentData(ShovelerWorld* world, ShovelerComponent* component, Schema_ComponentData* componentData, ShovelerCoordinateMapping mappingX, ShovelerCoordinateMapping mappingY, ShovelerCoordinateMapping mappingZ)
+/** array of (ShovelerClientSchemaComponentDescriptor *) indexed by interned component type id index, NULL if not built yet */
+static GArray* componentDescriptors = NULL;
+/** scratch space for decoded values that can't point into the schema object */
+static GString* decodeBuffer = NULL;
+/** scratch space for the field IDs present in a component update */
+static GArray* updateSchemaFieldIds = NULL;
+
+const ShovelerClientSchemaComponentDescriptor* shovelerClientGetSchemaComponentDescriptor(const ShovelerComponentType* componentType)
+{
+	if (componentDescriptors == NULL) {
+		componentDescriptors = g_array_new(/* zeroTerminated */ false, /* clear */ true, sizeof(ShovelerClientSchemaComponentDescriptor*));
+	}
+
+	int index = componentType->idHandle->index;
+	if (index >= (int) componentDescriptors->len) {
+		g_array_set_size(componentDescriptors, index + 1);
+	}
+
+	ShovelerClientSchemaComponentDescriptor** descriptor = &g_array_index(componentDescriptors, ShovelerClientSchemaComponentDescriptor*, index);
+	if (*descriptor == NULL) {
+		*descriptor = createComponentDescriptor(componentType);
+	}
+
+	return *descriptor;
+}
+
+void shovelerClientApplyComponentData(ShovelerWorld* world, ShovelerComponent* component, Schema_ComponentData* componentData, ShovelerWorkerPositionStream* positionStream, ShovelerCoordinateMapping mappingX, ShovelerCoordinateMapping mappingY, ShovelerCoordinateMapping mappingZ)
 {
 	Schema_Object* fields = Schema_GetComponentDataFields(componentData);
+	const ShovelerClientSchemaComponentDescriptor* descriptor = shovelerClientGetSchemaComponentDescriptor(component->type);
 
-	for (int fieldId = 0; fieldId < component->type->numFields; fieldId++) {
-		Schema_FieldId spatialosFieldId = fieldId + 1;
-		ShovelerComponentField* field = &component->type->fields[fieldId];
+	for (int i = 0; i < descriptor->numFields; i++) {
+		applyField(component, &descriptor->fields[i], fields);
+	}
 
-		updateComponentField(component, field, fieldId, fields, spatialosFieldId, field->isOptional);
+	if (positionStream != NULL) {
+		updatePositionQuantizedCoordinates(component, fields, positionStream);
 	}
 }
 
-void shovelerClientApplyComponentUpdate(ShovelerWorld* world, ShovelerComponent* component, Schema_ComponentUpdate* componentUpdate, ShovelerCoordinateMapping mappingX, ShovelerCoordinateMapping mappingY, ShovelerCoordinateMapping mappingZ)
+void shovelerClientApplyComponentUpdate(ShovelerWorld* world, ShovelerComponent* component, Schema_ComponentUpdate* componentUpdate, ShovelerWorkerPositionStream* positionStream, ShovelerCoordinateMapping mappingX, ShovelerCoordinateMapping mappingY, ShovelerCoordinateMapping mappingZ)
 {
 	Schema_Object* fields = Schema_GetComponentUpdateFields(componentUpdate);
 
@@ -184,6 +244,13 @@ void shovelerClientApplyComponentUpdate(ShovelerWorld* world, ShovelerComponent*
 		Schema_FieldId spatialosFieldId = Schema_IndexComponentUpdateClearedField(componentUpdate, i);
 		assert(spatialosFieldId < INT_MAX);
 		int fieldId = (int) spatialosFieldId - 1;
+		if (fieldId >= component->type->numFields) {
+			if (positionStream != NULL && spatialosFieldId == shovelerWorkerSchemaPositionFieldIdQuantizedOrigin) {
+				positionStream->hasOrigin = false;
+			}
+			continue;
+		}
+
 		ShovelerComponentField* field = &component->type->fields[fieldId];
 
 		if (field->type != SHOVELER_COMPONENT_FIELD_TYPE_ENTITY_ID_ARRAY && !field->isOptional) {
@@ -195,11 +262,34 @@ void shovelerClientApplyComponentUpdate(ShovelerWorld* world, ShovelerComponent*
 		shovelerLogTrace("Cleared entity %lld component '%s' option '%s'.", component->entityId, component->type->id, field->name);
 	}
 
-	for (int fieldId = 0; fieldId < component->type->numFields; fieldId++) {
-		Schema_FieldId spatialosFieldId = fieldId + 1;
-		ShovelerComponentField* field = &component->type->fields[fieldId];
+	// only visit the fields present in the update, which usually are few
+	const ShovelerClientSchemaComponentDescriptor* descriptor = shovelerClientGetSchemaComponentDescriptor(component->type);
+	uint32_t numSchemaFieldIds = Schema_GetUniqueFieldIdCount(fields);
+	if (updateSchemaFieldIds == NULL) {
+		updateSchemaFieldIds = g_array_new(/* zeroTerminated */ false, /* clear */ false, sizeof(Schema_FieldId));
+	}
+	g_array_set_size(updateSchemaFieldIds, numSchemaFieldIds);
+	Schema_GetUniqueFieldIds(fields, (Schema_FieldId*) updateSchemaFieldIds->data);
+
+	for (uint32_t i = 0; i < numSchemaFieldIds; i++) {
+		Schema_FieldId schemaFieldId = g_array_index(updateSchemaFieldIds, Schema_FieldId, i);
+		if (schemaFieldId == 0 || schemaFieldId > (Schema_FieldId) descriptor->numFields) {
+			continue;
+		}
 
-		updateComponentField(component, field, fieldId, fields, spatialosFieldId, /* clear_if_not_set */ false);
+		applyField(component, &descriptor->fields[schemaFieldId - 1], fields);
+	}
+
+	// an empty entity ID list isn't distinguishable from a missing one, so missing lists are reset
+	for (int i = 0; i < descriptor->numEntityIdArrayFields; i++) {
+		const ShovelerClientSchemaFieldDescriptor* fieldDescriptor = &descriptor->fields[descriptor->entityIdArrayFields[i]];
+		if (Schema_GetEntityIdCount(fields, fieldDescriptor->schemaFieldId) == 0) {
+			applyField(component, fieldDescriptor, fields);
+		}
+	}
+
+	if (positionStream != NULL) {
+		updatePositionQuantizedCoordinates(component, fields, positionStream);
 	}
 }
 
@@ -362,238 +452,233 @@ Schema_ComponentUpdate* shovelerClientCreateImprobablePositionUpdate(ShovelerVec
 	return update;
 }
 
-static void updateComponentField(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set)
+static ShovelerClientSchemaComponentDescriptor* createComponentDescriptor(const ShovelerComponentType* componentType)
 {
-	switch (field->type) {
-	case SHOVELER_COMPONENT_FIELD_TYPE_ENTITY_ID: {
-		updateEntityIdfield(component, field, fieldId, fields, spatialosFieldId, clear_if_not_set);
-	}
-		break;
-	case SHOVELER_COMPONENT_FIELD_TYPE_ENTITY_ID_ARRAY: {
-		updateEntityIdArrayfield(component, field, fieldId, fields, spatialosFieldId);
-	}
-		break;
-	case SHOVELER_COMPONENT_FIELD_TYPE_FLOAT: {
-		updateFloatfield(component, field, fieldId, fields, spatialosFieldId, clear_if_not_set);
-	}
-		break;
-	case SHOVELER_COMPONENT_FIELD_TYPE_BOOL: {
-		updateBoolfield(component, field, fieldId, fields, spatialosFieldId, clear_if_not_set);
-	}
-		break;
-	case SHOVELER_COMPONENT_FIELD_TYPE_INT: {
-		updateIntfield(component, field, fieldId, fields, spatialosFieldId, clear_if_not_set);
-	}
-		break;
-	case SHOVELER_COMPONENT_FIELD_TYPE_STRING: {
-		updateStringfield(component, field, fieldId, fields, spatialosFieldId, clear_if_not_set);
-	}
-		break;
-	case SHOVELER_COMPONENT_FIELD_TYPE_VECTOR2: {
-		updateVector2field(component, field, fieldId, fields, spatialosFieldId, clear_if_not_set);
-	}
-		break;
-	case SHOVELER_COMPONENT_FIELD_TYPE_VECTOR3: {
-		updateVector3field(component, field, fieldId, fields, spatialosFieldId, clear_if_not_set);
-	}
-		break;
-	case SHOVELER_COMPONENT_FIELD_TYPE_VECTOR4: {
-		updateVector4field(component, field, fieldId, fields, spatialosFieldId, clear_if_not_set);
-	}
-		break;
-	case SHOVELER_COMPONENT_FIELD_TYPE_BYTES: {
-		updateBytesfield(component, field, fieldId, fields, spatialosFieldId, clear_if_not_set);
-	}
-		break;
+	ShovelerClientSchemaComponentDescriptor* descriptor = malloc(sizeof(ShovelerClientSchemaComponentDescriptor));
+	descriptor->componentType = componentType;
+	descriptor->schemaComponentId = shovelerClientResolveComponentSchemaId(componentType->id);
+	descriptor->numFields = componentType->numFields;
+	descriptor->fields = malloc(componentType->numFields * sizeof(ShovelerClientSchemaFieldDescriptor));
+	descriptor->numEntityIdArrayFields = 0;
+	descriptor->entityIdArrayFields = malloc(componentType->numFields * sizeof(int));
+
+	for (int fieldId = 0; fieldId < componentType->numFields; fieldId++) {
+		const ShovelerComponentField* field = &componentType->fields[fieldId];
+
+		ShovelerClientSchemaFieldDescriptor* fieldDescriptor = &descriptor->fields[fieldId];
+		fieldDescriptor->schemaFieldId = fieldId + 1;
+		fieldDescriptor->fieldId = fieldId;
+		fieldDescriptor->type = field->type;
+		fieldDescriptor->isOptional = field->isOptional;
+		fieldDescriptor->name = field->name;
+		fieldDescriptor->decode = getDecodeFieldFunction(field->type);
+
+		if (field->type == SHOVELER_COMPONENT_FIELD_TYPE_ENTITY_ID_ARRAY) {
+			descriptor->entityIdArrayFields[descriptor->numEntityIdArrayFields++] = fieldId;
+		}
 	}
+
+	return descriptor;
 }
 
-static void updateEntityIdfield(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set)
+static ShovelerClientSchemaDecodeFieldFunction* getDecodeFieldFunction(ShovelerComponentFieldType type)
 {
-	if (Schema_GetEntityIdCount(fields, spatialosFieldId) == 0) {
-		if (!clear_if_not_set) {
-			return;
-		}
-
-		shovelerComponentClearField(component, fieldId, /* isCanonical */ true);
-		shovelerLogTrace("Cleared entity %lld component '%s' option '%s'.", component->entityId, component->type->id, field->name);
-	} else {
-		long long int entityIdValue = Schema_GetEntityId(fields, spatialosFieldId);
-		shovelerComponentUpdateCanonicalFieldEntityId(component, fieldId, entityIdValue);
-
-		shovelerLogTrace("Updated entity %lld component '%s' option '%s' to entity ID value %lld.", component->entityId, component->type->id, field->name, entityIdValue);
+	switch (type) {
+	case SHOVELER_COMPONENT_FIELD_TYPE_ENTITY_ID:
+		return decodeEntityIdField;
+	case SHOVELER_COMPONENT_FIELD_TYPE_ENTITY_ID_ARRAY:
+		return decodeEntityIdArrayField;
+	case SHOVELER_COMPONENT_FIELD_TYPE_FLOAT:
+		return decodeFloatField;
+	case SHOVELER_COMPONENT_FIELD_TYPE_BOOL:
+		return decodeBoolField;
+	case SHOVELER_COMPONENT_FIELD_TYPE_INT:
+		return decodeIntField;
+	case SHOVELER_COMPONENT_FIELD_TYPE_STRING:
+		return decodeStringField;
+	case SHOVELER_COMPONENT_FIELD_TYPE_VECTOR2:
+		return decodeVector2Field;
+	case SHOVELER_COMPONENT_FIELD_TYPE_VECTOR3:
+		return decodeVector3Field;
+	case SHOVELER_COMPONENT_FIELD_TYPE_VECTOR4:
+		return decodeVector4Field;
+	case SHOVELER_COMPONENT_FIELD_TYPE_BYTES:
+		return decodeBytesField;
+	default:
+		assert(false);
+		return NULL;
 	}
 }
 
-static void updateEntityIdArrayfield(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId)
+static bool decodeEntityIdField(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue)
 {
-	int numEntityIds = Schema_GetEntityIdCount(fields, spatialosFieldId);
-
-	long long int* entityIdArrayValue = malloc(numEntityIds * sizeof(long long int));
-	for (int j = 0; j < numEntityIds; j++) {
-		entityIdArrayValue[j] = Schema_IndexEntityId(fields, spatialosFieldId, j);
+	if (Schema_GetEntityIdCount(fields, schemaFieldId) == 0) {
+		return false;
 	}
 
-	shovelerComponentUpdateCanonicalFieldEntityIdArray(component, fieldId, entityIdArrayValue, numEntityIds);
-
-	free(entityIdArrayValue);
-
-	shovelerLogTrace("Updated entity %lld component '%s' option '%s' to entity ID list value with %d element(s).", component->entityId, component->type->id, field->name, numEntityIds);
+	outputValue->type = SHOVELER_COMPONENT_FIELD_TYPE_ENTITY_ID;
+	outputValue->isSet = true;
+	outputValue->entityIdValue = Schema_GetEntityId(fields, schemaFieldId);
+	return true;
 }
 
-static void updateFloatfield(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set)
+static bool decodeEntityIdArrayField(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue)
 {
-	if (Schema_GetFloatCount(fields, spatialosFieldId) == 0) {
-		if (!clear_if_not_set) {
-			return;
-		}
-
-		shovelerComponentClearField(component, fieldId, /* isCanonical */ true);
-		shovelerLogTrace("Cleared entity %lld component '%s' option '%s'.", component->entityId, component->type->id, field->name);
-	} else {
-		float floatValue = Schema_GetFloat(fields, spatialosFieldId);
-		shovelerComponentUpdateCanonicalFieldFloat(component, fieldId, floatValue);
+	uint32_t numEntityIds = Schema_GetEntityIdCount(fields, schemaFieldId);
+	assert(numEntityIds <= INT_MAX);
 
-		shovelerLogTrace("Updated entity %lld component '%s' option '%s' to float value %f.", component->entityId, component->type->id, field->name, floatValue);
+	if (decodeBuffer == NULL) {
+		decodeBuffer = g_string_new("");
 	}
+	g_string_set_size(decodeBuffer, numEntityIds * sizeof(Schema_EntityId));
+	Schema_GetEntityIdList(fields, schemaFieldId, (Schema_EntityId*) decodeBuffer->str);
+
+	outputValue->type = SHOVELER_COMPONENT_FIELD_TYPE_ENTITY_ID_ARRAY;
+	outputValue->isSet = true;
+	outputValue->entityIdArrayValue.entityIds = (long long int*) decodeBuffer->str;
+	outputValue->entityIdArrayValue.size = (int) numEntityIds;
+	return true;
 }
 
-static void updateBoolfield(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set)
+static bool decodeFloatField(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue)
 {
-	if (Schema_GetBoolCount(fields, spatialosFieldId) == 0) {
-		if (!clear_if_not_set) {
-			return;
-		}
-
-		shovelerComponentClearField(component, fieldId, /* isCanonical */ true);
-		shovelerLogTrace("Cleared entity %lld component '%s' option '%s'.", component->entityId, component->type->id, field->name);
-	} else {
-		bool boolValue = Schema_GetBool(fields, spatialosFieldId);
-		shovelerComponentUpdateCanonicalFieldBool(component, fieldId, boolValue);
-
-		shovelerLogTrace("Updated entity %lld component '%s' option '%s' to bool value %s.", component->entityId, component->type->id, field->name, boolValue ? "true" : "false");
+	if (Schema_GetFloatCount(fields, schemaFieldId) == 0) {
+		return false;
 	}
+
+	outputValue->type = SHOVELER_COMPONENT_FIELD_TYPE_FLOAT;
+	outputValue->isSet = true;
+	outputValue->floatValue = Schema_GetFloat(fields, schemaFieldId);
+	return true;
 }
 
-static void updateIntfield(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set)
+static bool decodeBoolField(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue)
 {
-	if (Schema_GetInt32Count(fields, spatialosFieldId) == 0) {
-		if (!clear_if_not_set) {
-			return;
-		}
-
-		shovelerComponentClearField(component, fieldId, /* isCanonical */ true);
-		shovelerLogTrace("Cleared entity %lld component '%s' option '%s'.", component->entityId, component->type->id, field->name);
-	} else {
-		int intValue = Schema_GetInt32(fields, spatialosFieldId);
-		shovelerComponentUpdateCanonicalFieldInt(component, fieldId, intValue);
-
-		shovelerLogTrace("Updated entity %lld component '%s' option '%s' to int value %d.", component->entityId, component->type->id, field->name, intValue);
+	if (Schema_GetBoolCount(fields, schemaFieldId) == 0) {
+		return false;
 	}
+
+	outputValue->type = SHOVELER_COMPONENT_FIELD_TYPE_BOOL;
+	outputValue->isSet = true;
+	outputValue->boolValue = Schema_GetBool(fields, schemaFieldId);
+	return true;
 }
 
-static void updateStringfield(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set)
+static bool decodeIntField(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue)
 {
-	if (Schema_GetBytesCount(fields, spatialosFieldId) == 0) {
-		if (!clear_if_not_set) {
-			return;
-		}
-
-		shovelerComponentClearField(component, fieldId, /* isCanonical */ true);
-		shovelerLogTrace("Cleared entity %lld component '%s' option '%s'.", component->entityId, component->type->id, field->name);
-	} else {
-		int bytesLength = (int) Schema_GetBytesLength(fields, spatialosFieldId);
-		const char* bytesValue = (const char*) Schema_GetBytes(fields, spatialosFieldId);
-
-		GString* stringValue = g_string_new("");
-		g_string_append_len(stringValue, bytesValue, bytesLength);
-
-		shovelerComponentUpdateCanonicalFieldString(component, fieldId, stringValue->str);
-
-		shovelerLogTrace("Updated entity %lld component '%s' option '%s' to string value '%s'.", component->entityId, component->type->id, field->name, stringValue->str);
-
-		g_string_free(stringValue, /* free_segment */ true);
+	if (Schema_GetInt32Count(fields, schemaFieldId) == 0) {
+		return false;
 	}
+
+	outputValue->type = SHOVELER_COMPONENT_FIELD_TYPE_INT;
+	outputValue->isSet = true;
+	outputValue->intValue = Schema_GetInt32(fields, schemaFieldId);
+	return true;
 }
 
-static void updateVector2field(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set)
+static bool decodeStringField(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue)
 {
-	if (Schema_GetObjectCount(fields, spatialosFieldId) == 0) {
-		if (!clear_if_not_set) {
-			return;
-		}
-
-		shovelerComponentClearField(component, fieldId, /* isCanonical */ true);
-		shovelerLogTrace("Cleared entity %lld component '%s' option '%s'.", component->entityId, component->type->id, field->name);
-	} else {
-		Schema_Object* vector2 = Schema_GetObject(fields, spatialosFieldId);
-		float x = Schema_GetFloat(vector2, shovelerWorkerSchemaVector2FieldIdX);
-		float y = Schema_GetFloat(vector2, shovelerWorkerSchemaVector2FieldIdY);
-
-		shovelerComponentUpdateCanonicalFieldVector2(component, fieldId, shovelerVector2(x, y));
+	if (Schema_GetBytesCount(fields, schemaFieldId) == 0) {
+		return false;
+	}
 
-		shovelerLogTrace("Updated entity %lld component '%s' option '%s' to vector2 value (%f, %f).", component->entityId, component->type->id, field->name, x, y);
+	// schema strings aren't null terminated
+	if (decodeBuffer == NULL) {
+		decodeBuffer = g_string_new("");
 	}
+	g_string_truncate(decodeBuffer, 0);
+	g_string_append_len(decodeBuffer, (const char*) Schema_GetBytes(fields, schemaFieldId), (gssize) Schema_GetBytesLength(fields, schemaFieldId));
+
+	outputValue->type = SHOVELER_COMPONENT_FIELD_TYPE_STRING;
+	outputValue->isSet = true;
+	outputValue->stringValue = decodeBuffer->str;
+	return true;
 }
 
-static void updateVector3field(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set)
+static bool decodeVector2Field(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue)
 {
-	if (Schema_GetObjectCount(fields, spatialosFieldId) == 0) {
-		if (!clear_if_not_set) {
-			return;
-		}
+	if (Schema_GetObjectCount(fields, schemaFieldId) == 0) {
+		return false;
+	}
 
-		shovelerComponentClearField(component, fieldId, /* isCanonical */ true);
-		shovelerLogTrace("Cleared entity %lld component '%s' option '%s'.", component->entityId, component->type->id, field->name);
-	} else {
-		Schema_Object* vector3 = Schema_GetObject(fields, spatialosFieldId);
-		float x = Schema_GetFloat(vector3, shovelerWorkerSchemaVector3FieldIdX);
-		float y = Schema_GetFloat(vector3, shovelerWorkerSchemaVector3FieldIdY);
-		float z = Schema_GetFloat(vector3, shovelerWorkerSchemaVector3FieldIdZ);
+	Schema_Object* vector2 = Schema_GetObject(fields, schemaFieldId);
+	outputValue->type = SHOVELER_COMPONENT_FIELD_TYPE_VECTOR2;
+	outputValue->isSet = true;
+	outputValue->vector2Value = shovelerVector2(
+		Schema_GetFloat(vector2, shovelerWorkerSchemaVector2FieldIdX),
+		Schema_GetFloat(vector2, shovelerWorkerSchemaVector2FieldIdY));
+	return true;
+}
 
-		shovelerComponentUpdateCanonicalFieldVector3(component, fieldId, shovelerVector3(x, y, z));
+static bool decodeVector3Field(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue)
+{
+	if (Schema_GetObjectCount(fields, schemaFieldId) == 0) {
+		return false;
+	}
+
+	Schema_Object* vector3 = Schema_GetObject(fields, schemaFieldId);
+	outputValue->type = SHOVELER_COMPONENT_FIELD_TYPE_VECTOR3;
+	outputValue->isSet = true;
+	outputValue->vector3Value = shovelerVector3(
+		Schema_GetFloat(vector3, shovelerWorkerSchemaVector3FieldIdX),
+		Schema_GetFloat(vector3, shovelerWorkerSchemaVector3FieldIdY),
+		Schema_GetFloat(vector3, shovelerWorkerSchemaVector3FieldIdZ));
+	return true;
+}
 
-		shovelerLogTrace("Updated entity %lld component '%s' option '%s' to vector3 value (%f, %f, %f).", component->entityId, component->type->id, field->name, x, y, z);
-	}
+static bool decodeVector4Field(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue)
+{
+	if (Schema_GetObjectCount(fields, schemaFieldId) == 0) {
+		return false;
+	}
+
+	Schema_Object* vector4 = Schema_GetObject(fields, schemaFieldId);
+	outputValue->type = SHOVELER_COMPONENT_FIELD_TYPE_VECTOR4;
+	outputValue->isSet = true;
+	outputValue->vector4Value = shovelerVector4(
+		Schema_GetFloat(vector4, shovelerWorkerSchemaVector4FieldIdX),
+		Schema_GetFloat(vector4, shovelerWorkerSchemaVector4FieldIdY),
+		Schema_GetFloat(vector4, shovelerWorkerSchemaVector4FieldIdZ),
+		Schema_GetFloat(vector4, shovelerWorkerSchemaVector4FieldIdW));
+	return true;
 }
 
-static void updateVector4field(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set)
+static bool decodeBytesField(Schema_Object* fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue* outputValue)
 {
-	if (Schema_GetObjectCount(fields, spatialosFieldId) == 0) {
-		if (!clear_if_not_set) {
-			return;
-		}
+	if (Schema_GetBytesCount(fields, schemaFieldId) == 0) {
+		return false;
+	}
 
-		shovelerComponentClearField(component, fieldId, /* isCanonical */ true);
-		shovelerLogTrace("Cleared entity %lld component '%s' option '%s'.", component->entityId, component->type->id, field->name);
-	} else {
-		Schema_Object* vector4 = Schema_GetObject(fields, spatialosFieldId);
-		float x = Schema_GetFloat(vector4, shovelerWorkerSchemaVector4FieldIdX);
-		float y = Schema_GetFloat(vector4, shovelerWorkerSchemaVector4FieldIdY);
-		float z = Schema_GetFloat(vector4, shovelerWorkerSchemaVector4FieldIdZ);
-		float w = Schema_GetFloat(vector4, shovelerWorkerSchemaVector4FieldIdW);
+	uint32_t bytesLength = Schema_GetBytesLength(fields, schemaFieldId);
+	assert(bytesLength <= INT_MAX);
 
-		shovelerComponentUpdateCanonicalFieldVector4(component, fieldId, shovelerVector4(x, y, z, w));
+	outputValue->type = SHOVELER_COMPONENT_FIELD_TYPE_BYTES;
+	outputValue->isSet = true;
+	outputValue->bytesValue.data = (unsigned char*) Schema_GetBytes(fields, schemaFieldId); // won't be modified
+	outputValue->bytesValue.size = (int) bytesLength;
+	return true;
+}
 
-		shovelerLogTrace("Updated entity %lld component '%s' option '%s' to vector4 value (%f, %f, %f, %f).", component->entityId, component->type->id, field->name, x, y, z, w);
+static void applyField(ShovelerComponent* component, const ShovelerClientSchemaFieldDescriptor* fieldDescriptor, Schema_Object* fields)
+{
+	ShovelerComponentFieldValue value;
+	if (fieldDescriptor->decode(fields, fieldDescriptor->schemaFieldId, &value)) {
+		shovelerComponentUpdateField(component, fieldDescriptor->fieldId, &value, /* isCanonical */ true);
+		shovelerLogTrace("Updated entity %lld component '%s' option '%s'.", component->entityId, component->type->id, fieldDescriptor->name);
+	} else if (fieldDescriptor->isOptional) {
+		shovelerComponentClearField(component, fieldDescriptor->fieldId, /* isCanonical */ true);
+		shovelerLogTrace("Cleared entity %lld component '%s' option '%s'.", component->entityId, component->type->id, fieldDescriptor->name);
 	}
 }
 
-static void updateBytesfield(ShovelerComponent* component, ShovelerComponentField* field, int fieldId, Schema_Object* fields, Schema_FieldId spatialosFieldId, bool clear_if_not_set)
+static void updatePositionQuantizedCoordinates(ShovelerComponent* component, Schema_Object* fields, ShovelerWorkerPositionStream* positionStream)
 {
-	if (Schema_GetBytesCount(fields, spatialosFieldId) == 0) {
-		if (!clear_if_not_set) {
-			return;
-		}
-
-		shovelerComponentClearField(component, fieldId, /* isCanonical */ true);
-		shovelerLogTrace("Cleared entity %lld component '%s' option '%s'.", component->entityId, component->type->id, field->name);
-	} else {
-		int bytesLength = (int) Schema_GetBytesLength(fields, spatialosFieldId);
-		const unsigned char* bytesValue = Schema_GetBytes(fields, spatialosFieldId);
+	ShovelerVector3 coordinates;
+	if (!shovelerWorkerSchemaGetPositionQuantizedCoordinates(fields, positionStream, &coordinates)) {
+		return;
+	}
 
-		shovelerComponentUpdateCanonicalFieldBytes(component, fieldId, bytesValue, bytesLength);
+	shovelerComponentUpdateCanonicalFieldVector3(component, SHOVELER_COMPONENT_POSITION_FIELD_ID_COORDINATES, coordinates);
 
-		shovelerLogTrace("Updated entity %lld component '%s' option '%s' to %d bytes value.", component->entityId, component->type->id, field->name, bytesLength);
-	}
+	shovelerLogTrace("Updated entity %lld component '%s' to quantized coordinates (%f, %f, %f).", component->entityId, component->type->id, coordinates.values[0], coordinates.values[1], coordinates.values[2]);
 }
@@ -1,18 +1,54 @@
 #ifndef SHOVELER_CLIENT_SPATIALOS_CLIENT_SCHEMA_H
 #define SHOVELER_CLIENT_SPATIALOS_CLIENT_SCHEMA_H
 
+#include <stdbool.h> // bool
+
 #include <improbable/c_schema.h>
+#include <shoveler/component_field.h>
+#include <shoveler/position_encoding.h>
 #include <shoveler/types.h>
 
 typedef struct ShovelerComponentStruct ShovelerComponent;
-typedef struct ShovelerComponentFieldStruct ShovelerComponentField;
-typedef struct ShovelerComponentFieldValueStruct ShovelerComponentFieldValue;
+typedef struct ShovelerComponentTypeStruct ShovelerComponentType;
 typedef struct ShovelerWorldStruct ShovelerWorld;
 
+/** Decodes a field into outputValue, returning false if it isn't set in fields. */
+typedef bool(ShovelerClientSchemaDecodeFieldFunction)(Schema_Object *fields, Schema_FieldId schemaFieldId, ShovelerComponentFieldValue *outputValue);
+
+typedef struct {
+	Schema_FieldId schemaFieldId;
+	int fieldId;
+	ShovelerComponentFieldType type;
+	bool isOptional;
+	const char *name;
+	ShovelerClientSchemaDecodeFieldFunction *decode;
+} ShovelerClientSchemaFieldDescriptor;
+
+/**
+ * Table mapping the schema fields of a component to the fields of its ECS component type.
+ *
+ * Both the generated schema and the client's decoding are driven by these tables, so they can't
+ * disagree. Fields are indexed by schema field ID minus one, which lets a component update look up
+ * the fields it contains directly. Decoded entity ID array and string values point into a scratch
+ * buffer that is reused by the next decode, and bytes values point into the schema object.
+ */
+typedef struct {
+	const ShovelerComponentType *componentType;
+	int schemaComponentId;
+	int numFields;
+	ShovelerClientSchemaFieldDescriptor *fields;
+	/** indices into fields of the entity ID array fields, which updates not containing them reset to empty */
+	int numEntityIdArrayFields;
+	int *entityIdArrayFields;
+} ShovelerClientSchemaComponentDescriptor;
+
 const char *shovelerClientResolveComponentTypeId(int componentId);
 int shovelerClientResolveComponentSchemaId(const char *componentTypeId);
-void shovelerClientApplyComponentData(ShovelerWorld *world, ShovelerComponent *component, Schema_ComponentData *componentData, ShovelerCoordinateMapping mappingX, ShovelerCoordinateMapping mappingY, ShovelerCoordinateMapping mappingZ);
-void shovelerClientApplyComponentUpdate(ShovelerWorld *world, ShovelerComponent *component, Schema_ComponentUpdate *componentUpdate, ShovelerCoordinateMapping mappingX, ShovelerCoordinateMapping mappingY, ShovelerCoordinateMapping mappingZ);
+/** Returns the descriptor of the component type, building it on first use. */
+const ShovelerClientSchemaComponentDescriptor *shovelerClientGetSchemaComponentDescriptor(const ShovelerComponentType *componentType);
+/** The position stream receives the quantized position origin of position components, and is NULL for all others. */
+void shovelerClientApplyComponentData(ShovelerWorld *world, ShovelerComponent *component, Schema_ComponentData *componentData, ShovelerWorkerPositionStream *positionStream, ShovelerCoordinateMapping mappingX, ShovelerCoordinateMapping mappingY, ShovelerCoordinateMapping mappingZ);
+void shovelerClientApplyComponentUpdate(ShovelerWorld *world, ShovelerComponent *component, Schema_ComponentUpdate *componentUpdate, ShovelerWorkerPositionStream *positionStream, ShovelerCoordinateMapping mappingX, ShovelerCoordinateMapping mappingY, ShovelerCoordinateMapping mappingZ);
 Schema_ComponentUpdate *shovelerClientCreateComponentUpdate(ShovelerComponent *component, const ShovelerComponentField *field, const ShovelerComponentFieldValue *value);
 Schema_ComponentUpdate *shovelerClientCreateImprobablePositionUpdate(ShovelerVector3 position, ShovelerCoordinateMapping mappingX, ShovelerCoordinateMapping mappingY, ShovelerCoordinateMapping mappingZ);
 
@@ -0,0 +1,402 @@
+/**
+ * Decodes the component data and updates of a worker op recording into component field values,
+ * once probing every field by type like the client used to and once with the component
+ * descriptors, reporting the time per component and checking both decode the same values.
+ *
+ * Record a client session with SHOVELER_WORKER_RECORD_FILE set to obtain a recording.
+ *
+ * Usage: spatialos_client_schema_benchmark <recording file> [num iterations]
+ */
+#include <stdbool.h> // bool
+#include <stdint.h> // int64_t uint32_t uint64_t
+#include <stdio.h> // fprintf printf
+#include <stdlib.h> // atoi malloc free EXIT_FAILURE EXIT_SUCCESS
+#include <string.h> // memcpy
+
+#include <glib.h>
+#include <improbable/c_schema.h>
+#include <improbable/c_worker.h>
+#include <shoveler/component_field.h>
+#include <shoveler/component_type.h>
+#include <shoveler/global.h>
+#include <shoveler/log.h>
+#include <shoveler/op_recording.h>
+#include <shoveler/schema.h>
+#include <shoveler/schema/base.h>
+#include <shoveler/schema/opengl.h>
+#include <shoveler/spatialos_schema.h>
+
+#include "spatialos_client_schema.h"
+
+typedef struct {
+	const ShovelerClientSchemaComponentDescriptor* descriptor;
+	Schema_Object* fields;
+	bool isUpdate;
+} Sample;
+
+typedef struct {
+	int64_t decodeUs;
+	int64_t numDecodedFields;
+	uint64_t checksum;
+} Result;
+
+static void collectSamples(ShovelerSchema* schema, Worker_OpList* opList, GArray* samples);
+static void addSample(ShovelerSchema* schema, GArray* samples, Worker_ComponentId componentId, Schema_Object* fields, bool isUpdate);
+static Result decodeLegacy(GArray* samples, int numIterations);
+static Result decodeDescriptors(GArray* samples, int numIterations);
+static bool decodeLegacyField(const ShovelerComponentField* field, Schema_Object* fields, Schema_FieldId schemaFieldId, GString* stringValue, ShovelerComponentFieldValue* outputValue);
+static void accumulate(Result* result, const ShovelerComponentFieldValue* value);
+static uint64_t hashValue(const ShovelerComponentFieldValue* value);
+static uint64_t hashFloat(float value);
+
+int main(int argc, char** argv)
+{
+	shovelerLogInit("shoveler-spatialos/", SHOVELER_LOG_LEVEL_WARNING_UP, stderr);
+	shovelerGlobalInit();
+
+	if (argc != 2 && argc != 3) {
+		shovelerLogError("Usage:\n\t%s <recording file> [num iterations]", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	int numIterations = argc == 3 ? atoi(argv[2]) : 100;
+	if (numIterations <= 0) {
+		shovelerLogError("Number of iterations must be positive.");
+		return EXIT_FAILURE;
+	}
+
+	ShovelerWorkerRecording* recording = shovelerWorkerRecordingRead(argv[1]);
+	if (recording == NULL) {
+		shovelerLogError("Failed to read recording from '%s'.", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	ShovelerSchema* schema = shovelerSchemaCreate();
+	shovelerSchemaBaseRegister(schema);
+	shovelerSchemaOpenglRegister(schema);
+
+	// keep the op lists alive since the samples point into them
+	GArray* opLists = g_array_new(/* zeroTerminated */ false, /* clear */ false, sizeof(Worker_OpList*));
+	GArray* samples = g_array_new(/* zeroTerminated */ false, /* clear */ false, sizeof(Sample));
+	for (guint i = 0; i < recording->records->len; i++) {
+		const ShovelerWorkerRecord* record = &g_array_index(recording->records, ShovelerWorkerRecord, i);
+		if (record->type != SHOVELER_WORKER_RECORD_TYPE_OP_LIST) {
+			continue;
+		}
+
+		Worker_OpList* opList = shovelerWorkerRecordDecodeOpList(record);
+		if (opList == NULL) {
+			shovelerLogError("Failed to decode op list record %u.", i);
+			return EXIT_FAILURE;
+		}
+
+		g_array_append_val(opLists, opList);
+		collectSamples(schema, opList, samples);
+	}
+
+	if (samples->len == 0) {
+		shovelerLogError("Recording doesn't contain any shoveler component data or updates.");
+		return EXIT_FAILURE;
+	}
+
+	Result legacy = decodeLegacy(samples, numIterations);
+	Result descriptors = decodeDescriptors(samples, numIterations);
+
+	double numDecodes = (double) samples->len * numIterations;
+	printf("Decoded %u components %d times.\n", samples->len, numIterations);
+	printf("probing fields: %.3fus per component, %lld fields\n", (double) legacy.decodeUs / numDecodes, (long long int) legacy.numDecodedFields);
+	printf("descriptors: %.3fus per component, %lld fields\n", (double) descriptors.decodeUs / numDecodes, (long long int) descriptors.numDecodedFields);
+
+	bool success = legacy.numDecodedFields == descriptors.numDecodedFields && legacy.checksum == descriptors.checksum;
+	if (!success) {
+		fprintf(stderr, "Decoded values differ between both decoders.\n");
+	}
+
+	for (guint i = 0; i < opLists->len; i++) {
+		shovelerWorkerRecordFreeOpList(g_array_index(opLists, Worker_OpList*, i));
+	}
+	g_array_free(opLists, /* freeSegment */ true);
+	g_array_free(samples, /* freeSegment */ true);
+	shovelerSchemaFree(schema);
+	shovelerWorkerRecordingFree(recording);
+
+	shovelerGlobalUninit();
+	shovelerLogTerminate();
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static void collectSamples(ShovelerSchema* schema, Worker_OpList* opList, GArray* samples)
+{
+	for (size_t i = 0; i < opList->op_count; i++) {
+		Worker_Op* op = &opList->ops[i];
+		switch (op->op_type) {
+		case WORKER_OP_TYPE_ADD_COMPONENT: {
+			Worker_ComponentData* data = &op->op.add_component.data;
+			addSample(schema, samples, data->component_id, Schema_GetComponentDataFields(data->schema_type), /* isUpdate */ false);
+		} break;
+		case WORKER_OP_TYPE_COMPONENT_UPDATE: {
+			Worker_ComponentUpdate* update = &op->op.component_update.update;
+			addSample(schema, samples, update->component_id, Schema_GetComponentUpdateFields(update->schema_type), /* isUpdate */ true);
+		} break;
+		default:
+			break;
+		}
+	}
+}
+
+static void addSample(ShovelerSchema* schema, GArray* samples, Worker_ComponentId componentId, Schema_Object* fields, bool isUpdate)
+{
+	const char* componentTypeId = shovelerClientResolveComponentTypeId(componentId);
+	if (componentTypeId == NULL) {
+		return;
+	}
+
+	ShovelerComponentType* componentType = shovelerSchemaGetComponentType(schema, componentTypeId);
+	if (componentType == NULL) {
+		return;
+	}
+
+	Sample sample;
+	sample.descriptor = shovelerClientGetSchemaComponentDescriptor(componentType);
+	sample.fields = fields;
+	sample.isUpdate = isUpdate;
+	g_array_append_val(samples, sample);
+}
+
+/** Mirrors how the client decoded components before, checking every field of the type by its type. */
+static Result decodeLegacy(GArray* samples, int numIterations)
+{
+	Result result = {0, 0, 0};
+	GString* stringValue = g_string_new("");
+
+	int64_t startTime = g_get_monotonic_time();
+	for (int iteration = 0; iteration < numIterations; iteration++) {
+		for (guint i = 0; i < samples->len; i++) {
+			const Sample* sample = &g_array_index(samples, Sample, i);
+			const ShovelerComponentType* componentType = sample->descriptor->componentType;
+
+			for (int fieldId = 0; fieldId < componentType->numFields; fieldId++) {
+				const ShovelerComponentField* field = &componentType->fields[fieldId];
+
+				ShovelerComponentFieldValue value;
+				if (!decodeLegacyField(field, sample->fields, fieldId + 1, stringValue, &value)) {
+					continue;
+				}
+
+				accumulate(&result, &value);
+
+				if (value.type == SHOVELER_COMPONENT_FIELD_TYPE_ENTITY_ID_ARRAY) {
+					free(value.entityIdArrayValue.entityIds);
+				}
+			}
+		}
+	}
+	result.decodeUs = g_get_monotonic_time() - startTime;
+
+	g_string_free(stringValue, /* freeSegment */ true);
+
+	return result;
+}
+
+static Result decodeDescriptors(GArray* samples, int numIterations)
+{
+	Result result = {0, 0, 0};
+	GArray* schemaFieldIds = g_array_new(/* zeroTerminated */ false, /* clear */ false, sizeof(Schema_FieldId));
+
+	int64_t startTime = g_get_monotonic_time();
+	for (int iteration = 0; iteration < numIterations; iteration++) {
+		for (guint i = 0; i < samples->len; i++) {
+			const Sample* sample = &g_array_index(samples, Sample, i);
+			const ShovelerClientSchemaComponentDescriptor* descriptor = sample->descriptor;
+
+			if (!sample->isUpdate) {
+				for (int j = 0; j < descriptor->numFields; j++) {
+					const ShovelerClientSchemaFieldDescriptor* fieldDescriptor = &descriptor->fields[j];
+
+					ShovelerComponentFieldValue value;
+					if (fieldDescriptor->decode(sample->fields, fieldDescriptor->schemaFieldId, &value)) {
+						accumulate(&result, &value);
+					}
+				}
+				continue;
+			}
+
+			uint32_t numSchemaFieldIds = Schema_GetUniqueFieldIdCount(sample->fields);
+			g_array_set_size(schemaFieldIds, numSchemaFieldIds);
+			Schema_GetUniqueFieldIds(sample->fields, (Schema_FieldId*) schemaFieldIds->data);
+
+			for (uint32_t j = 0; j < numSchemaFieldIds; j++) {
+				Schema_FieldId schemaFieldId = g_array_index(schemaFieldIds, Schema_FieldId, j);
+				if (schemaFieldId == 0 || schemaFieldId > (Schema_FieldId) descriptor->numFields) {
+					continue;
+				}
+
+				const ShovelerClientSchemaFieldDescriptor* fieldDescriptor = &descriptor->fields[schemaFieldId - 1];
+
+				ShovelerComponentFieldValue value;
+				if (fieldDescriptor->decode(sample->fields, schemaFieldId, &value)) {
+					accumulate(&result, &value);
+				}
+			}
+
+			for (int j = 0; j < descriptor->numEntityIdArrayFields; j++) {
+				const ShovelerClientSchemaFieldDescriptor* fieldDescriptor = &descriptor->fields[descriptor->entityIdArrayFields[j]];
+				if (Schema_GetEntityIdCount(sample->fields, fieldDescriptor->schemaFieldId) != 0) {
+					continue; // already decoded above
+				}
+
+				ShovelerComponentFieldValue value;
+				if (fieldDescriptor->decode(sample->fields, fieldDescriptor->schemaFieldId, &value)) {
+					accumulate(&result, &value);
+				}
+			}
+		}
+	}
+	result.decodeUs = g_get_monotonic_time() - startTime;
+
+	g_array_free(schemaFieldIds, /* freeSegment */ true);
+
+	return result;
+}
+
+static bool decodeLegacyField(const ShovelerComponentField* field, Schema_Object* fields, Schema_FieldId schemaFieldId, GString* stringValue, ShovelerComponentFieldValue* outputValue)
+{
+	outputValue->type = field->type;
+	outputValue->isSet = true;
+
+	switch (field->type) {
+	case SHOVELER_COMPONENT_FIELD_TYPE_ENTITY_ID:
+		if (Schema_GetEntityIdCount(fields, schemaFieldId) == 0) {
+			return false;
+		}
+		outputValue->entityIdValue = Schema_GetEntityId(fields, schemaFieldId);
+		return true;
+	case SHOVELER_COMPONENT_FIELD_TYPE_ENTITY_ID_ARRAY: {
+		int numEntityIds = Schema_GetEntityIdCount(fields, schemaFieldId);
+		long long int* entityIds = malloc(numEntityIds * sizeof(long long int));
+		for (int j = 0; j < numEntityIds; j++) {
+			entityIds[j] = Schema_IndexEntityId(fields, schemaFieldId, j);
+		}
+		outputValue->entityIdArrayValue.entityIds = entityIds;
+		outputValue->entityIdArrayValue.size = numEntityIds;
+		return true;
+	}
+	case SHOVELER_COMPONENT_FIELD_TYPE_FLOAT:
+		if (Schema_GetFloatCount(fields, schemaFieldId) == 0) {
+			return false;
+		}
+		outputValue->floatValue = Schema_GetFloat(fields, schemaFieldId);
+		return true;
+	case SHOVELER_COMPONENT_FIELD_TYPE_BOOL:
+		if (Schema_GetBoolCount(fields, schemaFieldId) == 0) {
+			return false;
+		}
+		outputValue->boolValue = Schema_GetBool(fields, schemaFieldId);
+		return true;
+	case SHOVELER_COMPONENT_FIELD_TYPE_INT:
+		if (Schema_GetInt32Count(fields, schemaFieldId) == 0) {
+			return false;
+		}
+		outputValue->intValue = Schema_GetInt32(fields, schemaFieldId);
+		return true;
+	case SHOVELER_COMPONENT_FIELD_TYPE_STRING:
+		if (Schema_GetBytesCount(fields, schemaFieldId) == 0) {
+			return false;
+		}
+		g_string_truncate(stringValue, 0);
+		g_string_append_len(stringValue, (const char*) Schema_GetBytes(fields, schemaFieldId), (gssize) Schema_GetBytesLength(fields, schemaFieldId));
+		outputValue->stringValue = stringValue->str;
+		return true;
+	case SHOVELER_COMPONENT_FIELD_TYPE_VECTOR2: {
+		if (Schema_GetObjectCount(fields, schemaFieldId) == 0) {
+			return false;
+		}
+		Schema_Object* vector2 = Schema_GetObject(fields, schemaFieldId);
+		outputValue->vector2Value = shovelerVector2(
+			Schema_GetFloat(vector2, shovelerWorkerSchemaVector2FieldIdX),
+			Schema_GetFloat(vector2, shovelerWorkerSchemaVector2FieldIdY));
+		return true;
+	}
+	case SHOVELER_COMPONENT_FIELD_TYPE_VECTOR3: {
+		if (Schema_GetObjectCount(fields, schemaFieldId) == 0) {
+			return false;
+		}
+		Schema_Object* vector3 = Schema_GetObject(fields, schemaFieldId);
+		outputValue->vector3Value = shovelerVector3(
+			Schema_GetFloat(vector3, shovelerWorkerSchemaVector3FieldIdX),
+			Schema_GetFloat(vector3, shovelerWorkerSchemaVector3FieldIdY),
+			Schema_GetFloat(vector3, shovelerWorkerSchemaVector3FieldIdZ));
+		return true;
+	}
+	case SHOVELER_COMPONENT_FIELD_TYPE_VECTOR4: {
+		if (Schema_GetObjectCount(fields, schemaFieldId) == 0) {
+			return false;
+		}
+		Schema_Object* vector4 = Schema_GetObject(fields, schemaFieldId);
+		outputValue->vector4Value = shovelerVector4(
+			Schema_GetFloat(vector4, shovelerWorkerSchemaVector4FieldIdX),
+			Schema_GetFloat(vector4, shovelerWorkerSchemaVector4FieldIdY),
+			Schema_GetFloat(vector4, shovelerWorkerSchemaVector4FieldIdZ),
+			Schema_GetFloat(vector4, shovelerWorkerSchemaVector4FieldIdW));
+		return true;
+	}
+	case SHOVELER_COMPONENT_FIELD_TYPE_BYTES:
+		if (Schema_GetBytesCount(fields, schemaFieldId) == 0) {
+			return false;
+		}
+		outputValue->bytesValue.data = (unsigned char*) Schema_GetBytes(fields, schemaFieldId);
+		outputValue->bytesValue.size = (int) Schema_GetBytesLength(fields, schemaFieldId);
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void accumulate(Result* result, const ShovelerComponentFieldValue* value)
+{
+	result->numDecodedFields++;
+	result->checksum += hashValue(value);
+}
+
+static uint64_t hashValue(const ShovelerComponentFieldValue* value)
+{
+	uint64_t hash = (uint64_t) value->type;
+	switch (value->type) {
+	case SHOVELER_COMPONENT_FIELD_TYPE_ENTITY_ID:
+		return hash + (uint64_t) value->entityIdValue;
+	case SHOVELER_COMPONENT_FIELD_TYPE_ENTITY_ID_ARRAY:
+		for (int i = 0; i < value->entityIdArrayValue.size; i++) {
+			hash = 31 * hash + (uint64_t) value->entityIdArrayValue.entityIds[i];
+		}
+		return hash;
+	case SHOVELER_COMPONENT_FIELD_TYPE_FLOAT:
+		return hash + hashFloat(value->floatValue);
+	case SHOVELER_COMPONENT_FIELD_TYPE_BOOL:
+		return hash + (value->boolValue ? 1 : 0);
+	case SHOVELER_COMPONENT_FIELD_TYPE_INT:
+		return hash + (uint64_t) value->intValue;
+	case SHOVELER_COMPONENT_FIELD_TYPE_STRING:
+		return hash + g_str_hash(value->stringValue);
+	case SHOVELER_COMPONENT_FIELD_TYPE_VECTOR2:
+		return hash + hashFloat(value->vector2Value.values[0]) + 3 * hashFloat(value->vector2Value.values[1]);
+	case SHOVELER_COMPONENT_FIELD_TYPE_VECTOR3:
+		return hash + hashFloat(value->vector3Value.values[0]) + 3 * hashFloat(value->vector3Value.values[1]) + 5 * hashFloat(value->vector3Value.values[2]);
+	case SHOVELER_COMPONENT_FIELD_TYPE_VECTOR4:
+		return hash + hashFloat(value->vector4Value.values[0]) + 3 * hashFloat(value->vector4Value.values[1]) + 5 * hashFloat(value->vector4Value.values[2]) + 7 * hashFloat(value->vector4Value.values[3]);
+	case SHOVELER_COMPONENT_FIELD_TYPE_BYTES:
+		for (int i = 0; i < value->bytesValue.size; i++) {
+			hash = 31 * hash + value->bytesValue.data[i];
+		}
+		return hash;
+	default:
+		return hash;
+	}
+}
+
+static uint64_t hashFloat(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
@@ -15,5 +15,7 @@ bool shovelerWorkerConfigurationParseVector3Flag(Worker_Connection *connection,
 bool shovelerWorkerConfigurationParseBoolFlag(Worker_Connection *connection, const char *flagName, bool *outputValue);
 bool shovelerWorkerConfigurationParseCoordinateMappingFlag(Worker_Connection *connection, const char *flagName, ShovelerCoordinateMapping *outputValue);
 bool shovelerWorkerConfigurationParseGameTypeFlag(Worker_Connection *connection, const char *flagName, ShovelerWorkerGameType *outputValue);
+/** On success, the caller takes ownership of the returned string and must free it. */
+bool shovelerWorkerConfigurationParseStringFlag(Worker_Connection *connection, const char *flagName, char **outputValue);
 
 #endif
@@ -0,0 +1,16 @@
+#ifndef SHOVELER_WORKER_COMMON_MAP_LAYOUT_H
+#define SHOVELER_WORKER_COMMON_MAP_LAYOUT_H
+
+/**
+ * Layout of the chunked map shared by the server, the clients and the bots. The map is centered
+ * around the world origin, and quantized positions cover it together with the height range.
+ */
+enum {
+	shovelerWorkerMapNumChunkColumns = 20,
+	shovelerWorkerMapNumChunkRows = 20,
+	shovelerWorkerMapChunkSize = 10,
+	shovelerWorkerMapHeightMin = -128,
+	shovelerWorkerMapHeightSize = 256,
+};
+
+#endif
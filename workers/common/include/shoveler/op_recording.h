@@ -0,0 +1,83 @@
+#ifndef SHOVELER_WORKER_COMMON_OP_RECORDING_H
+#define SHOVELER_WORKER_COMMON_OP_RECORDING_H
+
+#include <stdbool.h> // bool
+#include <stdint.h> // uint8_t uint32_t int64_t
+#include <stdio.h> // FILE
+
+#include <glib.h>
+#include <improbable/c_schema.h>
+#include <improbable/c_worker.h>
+
+typedef enum {
+	SHOVELER_WORKER_RECORD_TYPE_CONNECT,
+	SHOVELER_WORKER_RECORD_TYPE_WORKER_FLAG,
+	SHOVELER_WORKER_RECORD_TYPE_OP_LIST,
+	SHOVELER_WORKER_RECORD_TYPE_SEND_COMPONENT_UPDATE,
+	SHOVELER_WORKER_RECORD_TYPE_SEND_COMMAND_REQUEST,
+	SHOVELER_WORKER_RECORD_TYPE_SEND_COMMAND_RESPONSE,
+	SHOVELER_WORKER_RECORD_TYPE_SEND_COMMAND_FAILURE,
+	SHOVELER_WORKER_RECORD_TYPE_SEND_CREATE_ENTITY_REQUEST,
+	SHOVELER_WORKER_RECORD_TYPE_SEND_DELETE_ENTITY_REQUEST,
+	SHOVELER_WORKER_RECORD_TYPE_SEND_RESERVE_ENTITY_IDS_REQUEST,
+	SHOVELER_WORKER_RECORD_TYPE_NUM_TYPES,
+} ShovelerWorkerRecordType;
+
+/**
+ * Writes everything a worker receives from and sends to its connection to a local file.
+ *
+ * The file is a sequence of records, each consisting of a uint32 type, a uint32 payload length and
+ * the payload. Every send record starts with the int64 value the send call returned, so that a
+ * replay can hand out the same request IDs as the recorded run. Schema data is stored in its wire
+ * format. Metrics and entity query ops are not recorded.
+ */
+typedef struct {
+	FILE *file;
+	GString *payload;
+} ShovelerWorkerOpRecorder;
+
+typedef struct {
+	ShovelerWorkerRecordType type;
+	int64_t sendResult;
+	const uint8_t *payload;
+	uint32_t payloadLength;
+} ShovelerWorkerRecord;
+
+typedef struct {
+	/* file contents, all decoded strings point into here */
+	uint8_t *contents;
+	size_t length;
+	/* array of ShovelerWorkerRecord */
+	GArray *records;
+} ShovelerWorkerRecording;
+
+ShovelerWorkerOpRecorder *shovelerWorkerOpRecorderCreate(const char *filename);
+void shovelerWorkerOpRecorderWriteConnect(ShovelerWorkerOpRecorder *recorder, Worker_EntityId workerEntityId);
+void shovelerWorkerOpRecorderWriteWorkerFlag(ShovelerWorkerOpRecorder *recorder, const char *name, const char *value);
+void shovelerWorkerOpRecorderWriteOpList(ShovelerWorkerOpRecorder *recorder, const Worker_OpList *opList);
+void shovelerWorkerOpRecorderWriteSendComponentUpdate(ShovelerWorkerOpRecorder *recorder, int64_t result, Worker_EntityId entityId, const Worker_ComponentUpdate *componentUpdate);
+void shovelerWorkerOpRecorderWriteSendCommandRequest(ShovelerWorkerOpRecorder *recorder, Worker_RequestId requestId, Worker_EntityId entityId, const Worker_CommandRequest *commandRequest);
+void shovelerWorkerOpRecorderWriteSendCommandResponse(ShovelerWorkerOpRecorder *recorder, int64_t result, Worker_RequestId requestId, const Worker_CommandResponse *commandResponse);
+void shovelerWorkerOpRecorderWriteSendCommandFailure(ShovelerWorkerOpRecorder *recorder, int64_t result, Worker_RequestId requestId, const char *message);
+void shovelerWorkerOpRecorderWriteSendCreateEntityRequest(ShovelerWorkerOpRecorder *recorder, Worker_RequestId requestId, uint32_t componentCount, const Worker_ComponentData *components, const Worker_EntityId *entityId);
+void shovelerWorkerOpRecorderWriteSendDeleteEntityRequest(ShovelerWorkerOpRecorder *recorder, Worker_RequestId requestId, Worker_EntityId entityId);
+void shovelerWorkerOpRecorderWriteSendReserveEntityIdsRequest(ShovelerWorkerOpRecorder *recorder, Worker_RequestId requestId, uint32_t numberOfEntityIds);
+void shovelerWorkerOpRecorderFree(ShovelerWorkerOpRecorder *recorder);
+
+/** Reads a recording written by ShovelerWorkerOpRecorder, returning NULL if it is malformed. */
+ShovelerWorkerRecording *shovelerWorkerRecordingRead(const char *filename);
+/** Returns true and writes the entity ID if the record is a connect record. */
+bool shovelerWorkerRecordDecodeConnect(const ShovelerWorkerRecord *record, Worker_EntityId *outputWorkerEntityId);
+/** Returns true and writes the flag name and value (may be NULL) if the record is a worker flag record. */
+bool shovelerWorkerRecordDecodeWorkerFlag(const ShovelerWorkerRecord *record, const char **outputName, const char **outputValue);
+/** Decodes an op list record into a newly allocated op list, to be freed with shovelerWorkerRecordFreeOpList. */
+Worker_OpList *shovelerWorkerRecordDecodeOpList(const ShovelerWorkerRecord *record);
+void shovelerWorkerRecordFreeOpList(Worker_OpList *opList);
+void shovelerWorkerRecordingFree(ShovelerWorkerRecording *recording);
+
+static inline bool shovelerWorkerRecordIsSend(const ShovelerWorkerRecord *record)
+{
+	return record->type >= SHOVELER_WORKER_RECORD_TYPE_SEND_COMPONENT_UPDATE;
+}
+
+#endif
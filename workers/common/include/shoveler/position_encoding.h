@@ -0,0 +1,57 @@
+#ifndef SHOVELER_WORKER_COMMON_POSITION_ENCODING_H
+#define SHOVELER_WORKER_COMMON_POSITION_ENCODING_H
+
+#include <stdbool.h> // bool
+#include <stdint.h> // uint64_t
+
+#include <shoveler/types.h>
+
+#define SHOVELER_WORKER_POSITION_ENCODING_MAX_DELTA_LENGTH 6
+
+/**
+ * Compact wire encoding for position coordinates in a chunked world.
+ *
+ * The first two coordinates are quantized to 16 bits relative to the origin of the chunk they are
+ * in, and the third one to 16 bits within a fixed height range. Together with the chunk indices
+ * this packs into a single 64 bit integer.
+ *
+ * Subsequent positions are sent as deltas against such a packed origin, as one zigzag varint per
+ * coordinate. Since consecutive chunks continue each other's quantization grid, deltas can cross
+ * chunk borders. Once a delta no longer fits into two bytes per coordinate, the encoder starts
+ * over from a new origin. Deltas stay relative to the origin rather than to the previous position,
+ * so that the latest origin and delta always decode on their own.
+ */
+typedef struct {
+	ShovelerVector2 worldMin;
+	float chunkSize;
+	int numChunkColumns;
+	int numChunkRows;
+	float heightMin;
+	float heightSize;
+} ShovelerWorkerPositionEncoding;
+
+/** The origin state shared by consecutive encoded positions of one entity, on both ends. */
+typedef struct {
+	bool hasOrigin;
+	uint64_t origin;
+} ShovelerWorkerPositionStream;
+
+/** Columns and rows are limited to 256 chunks each. */
+ShovelerWorkerPositionEncoding shovelerWorkerPositionEncoding(ShovelerVector2 worldMin, float chunkSize, int numChunkColumns, int numChunkRows, float heightMin, float heightSize);
+/** Packs coordinates into a single integer, returning false if they lie outside of the world. */
+bool shovelerWorkerPositionEncodingQuantize(const ShovelerWorkerPositionEncoding *encoding, ShovelerVector3 coordinates, uint64_t *outputQuantized);
+/** Unpacks to the center of the quantization cell, which quantizes back to the same value. */
+ShovelerVector3 shovelerWorkerPositionEncodingDequantize(const ShovelerWorkerPositionEncoding *encoding, uint64_t quantized);
+/**
+ * Encodes coordinates as a delta against the stream's origin, moving the origin to the coordinates
+ * first if there is none yet or the delta would get too large.
+ *
+ * Returns the number of bytes written to outputDelta, which must have room for
+ * SHOVELER_WORKER_POSITION_ENCODING_MAX_DELTA_LENGTH bytes, or -1 if the coordinates lie outside of
+ * the world.
+ */
+int shovelerWorkerPositionEncodingEncode(const ShovelerWorkerPositionEncoding *encoding, ShovelerWorkerPositionStream *stream, ShovelerVector3 coordinates, bool *outputNewOrigin, unsigned char *outputDelta);
+/** Decodes a delta against the stream's origin, returning false if there is no origin or the delta is malformed. */
+bool shovelerWorkerPositionEncodingDecode(const ShovelerWorkerPositionEncoding *encoding, const ShovelerWorkerPositionStream *stream, const unsigned char *delta, int deltaLength, ShovelerVector3 *outputCoordinates);
+
+#endif
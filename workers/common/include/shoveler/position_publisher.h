@@ -0,0 +1,59 @@
+#ifndef SHOVELER_WORKER_COMMON_POSITION_PUBLISHER_H
+#define SHOVELER_WORKER_COMMON_POSITION_PUBLISHER_H
+
+#include <stdbool.h> // bool
+#include <stdint.h> // int64_t
+
+#include <shoveler/types.h>
+
+typedef void (ShovelerWorkerPositionPublishFunction)(ShovelerVector3 position, void *userData);
+
+typedef struct {
+	/* minimum time between two published positions, i.e. the inverse of the maximum update rate */
+	int64_t minIntervalUs;
+	/* while moving, positions closer than this to the last published one are not published */
+	float minDistance;
+	/* while moving at constant velocity, positions closer than this to where the last published
+	 * position would have been extrapolated to are not published, or zero to disable */
+	float extrapolationTolerance;
+	/* maximum time to suppress positions by extrapolation, so that receivers not extrapolating
+	 * themselves still see progress */
+	int64_t maxExtrapolationUs;
+} ShovelerWorkerPositionPublisherSettings;
+
+/**
+ * Decides which positions of a moving entity are worth sending as a component update.
+ *
+ * The owner passes the entity's current position once per tick, and the publisher calls publish
+ * for those it lets through. Positions in between are coalesced, i.e. only the latest one is ever
+ * published. A position is published while moving if the maximum rate allows it, it moved at
+ * least minDistance away from the last published position, and it deviates from the dead reckoned
+ * last published position by more than the extrapolation tolerance.
+ *
+ * As soon as the position stops changing between two ticks, the final resting position is
+ * published regardless of distance and extrapolation, as soon as the rate allows it. The first
+ * position is always published right away.
+ */
+typedef struct {
+	ShovelerWorkerPositionPublisherSettings settings;
+	ShovelerWorkerPositionPublishFunction *publish;
+	void *userData;
+	bool hasPosition;
+	ShovelerVector3 position;
+	int64_t time;
+	bool hasPublished;
+	ShovelerVector3 publishedPosition;
+	ShovelerVector3 publishedVelocity;
+	int64_t publishedTime;
+	int numUpdates;
+	int numPublished;
+} ShovelerWorkerPositionPublisher;
+
+ShovelerWorkerPositionPublisherSettings shovelerWorkerPositionPublisherDefaultSettings();
+void shovelerWorkerPositionPublisherInit(ShovelerWorkerPositionPublisher *publisher, ShovelerWorkerPositionPublisherSettings settings, ShovelerWorkerPositionPublishFunction *publish, void *userData);
+/** Passes the current position at time now in microseconds, returning true if it was published. */
+bool shovelerWorkerPositionPublisherUpdate(ShovelerWorkerPositionPublisher *publisher, ShovelerVector3 position, int64_t now);
+/** Forgets all state, e.g. after losing authority, so that the next position is published right away. */
+void shovelerWorkerPositionPublisherReset(ShovelerWorkerPositionPublisher *publisher);
+
+#endif
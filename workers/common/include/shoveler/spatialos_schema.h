@@ -4,6 +4,7 @@
 #include <improbable/c_schema.h>
 #include <improbable/c_worker.h>
 
+#include <shoveler/position_encoding.h>
 #include <shoveler/types.h>
 
 enum {
@@ -126,6 +127,8 @@ enum {
 	shovelerWorkerSchemaPositionFieldIdPositionType = 1,
 	shovelerWorkerSchemaPositionFieldIdCoordinates = 2,
 	shovelerWorkerSchemaPositionFieldIdRelativeParentPosition = 3,
+	shovelerWorkerSchemaPositionFieldIdQuantizedOrigin = 4,
+	shovelerWorkerSchemaPositionFieldIdQuantizedDelta = 5,
 };
 
 enum {
@@ -412,6 +415,19 @@ Worker_ComponentData shovelerWorkerSchemaCreateImprobablePositionComponent(doubl
 Worker_ComponentData shovelerWorkerSchemaCreateImprobableAuthorityDelegationComponent();
 Worker_ComponentData shovelerWorkerSchemaCreateImprobableInterestComponent();
 Worker_ComponentData shovelerWorkerSchemaCreatePositionComponent(ShovelerVector3 positionCoordinates);
+/** Returns the quantized position encoding matching the layout of the world's chunks. */
+ShovelerWorkerPositionEncoding shovelerWorkerSchemaGetPositionEncoding();
+/**
+ * Sets the coordinates in a position component update, quantized against the stream if requested
+ * and within the encoding's range. Otherwise, the plain coordinates field is set and quantized
+ * coordinates sent earlier are cleared.
+ */
+void shovelerWorkerSchemaAddPositionUpdateCoordinates(Schema_ComponentUpdate *componentUpdate, ShovelerWorkerPositionStream *stream, bool quantized, ShovelerVector3 coordinates);
+/**
+ * Reads quantized coordinates from position component data or update fields, first taking over a
+ * new origin into the stream if there is one. Returns false if the fields don't carry any.
+ */
+bool shovelerWorkerSchemaGetPositionQuantizedCoordinates(Schema_Object *positionFields, ShovelerWorkerPositionStream *stream, ShovelerVector3 *outputCoordinates);
 Worker_ComponentData shovelerWorkerSchemaCreateBootstrapComponent();
 Worker_ComponentData shovelerWorkerSchemaCreateDrawableCubeComponent();
 Worker_ComponentData shovelerWorkerSchemaCreateDrawableQuadComponent();
@@ -127,6 +127,19 @@ bool shovelerWorkerConfigurationParseGameTypeFlag(Worker_Connection *connection,
 	return true;
 }
 
+bool shovelerWorkerConfigurationParseStringFlag(Worker_Connection *connection, const char *flagName, char **outputValue)
+{
+	char *stringValue;
+	Worker_Connection_GetWorkerFlag(connection, flagName, &stringValue, workerFlagCallback);
+	if(stringValue == NULL) {
+		return false;
+	}
+
+	shovelerLogInfo("Parsed configuration flag '%s' with value '%s'.", flagName, stringValue);
+	*outputValue = stringValue;
+	return true;
+}
+
 static void workerFlagCallback(void *targetPointer, const char *value)
 {
 	char **target = (char **) targetPointer;
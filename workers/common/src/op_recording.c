@@ -0,0 +1,667 @@
+#include "shoveler/op_recording.h"
+
+#include <errno.h> // errno
+#include <stdlib.h> // malloc calloc free
+#include <string.h> // memcpy strerror strlen
+
+#include <shoveler/log.h>
+
+#define NULL_STRING_LENGTH UINT32_MAX
+
+typedef struct {
+	const uint8_t *data;
+	uint32_t length;
+	uint32_t position;
+	bool failed;
+} RecordReader;
+
+static void writeRecord(ShovelerWorkerOpRecorder *recorder, ShovelerWorkerRecordType type);
+static void appendUint8(GString *payload, uint8_t value);
+static void appendUint32(GString *payload, uint32_t value);
+static void appendInt64(GString *payload, int64_t value);
+static void appendString(GString *payload, const char *value);
+static void appendObject(GString *payload, const Schema_Object *object);
+static void appendComponentData(GString *payload, const Worker_ComponentData *componentData);
+static void appendComponentUpdate(GString *payload, const Worker_ComponentUpdate *componentUpdate);
+static bool appendOp(GString *payload, const Worker_Op *op);
+static uint8_t readUint8(RecordReader *reader);
+static uint32_t readUint32(RecordReader *reader);
+static int64_t readInt64(RecordReader *reader);
+static const char *readString(RecordReader *reader);
+static void readObject(RecordReader *reader, Schema_Object *object);
+static void readComponentData(RecordReader *reader, Worker_ComponentData *componentData);
+static void readComponentUpdate(RecordReader *reader, Worker_ComponentUpdate *componentUpdate);
+static void readOp(RecordReader *reader, Worker_Op *op);
+static void freeOp(Worker_Op *op);
+
+ShovelerWorkerOpRecorder *shovelerWorkerOpRecorderCreate(const char *filename)
+{
+	FILE *file = fopen(filename, "wb");
+	if(file == NULL) {
+		shovelerLogError("Failed to open op recording file '%s' for writing: %s", filename, strerror(errno));
+		return NULL;
+	}
+
+	ShovelerWorkerOpRecorder *recorder = malloc(sizeof(ShovelerWorkerOpRecorder));
+	recorder->file = file;
+	recorder->payload = g_string_new("");
+
+	shovelerLogInfo("Recording worker connection to '%s'.", filename);
+	return recorder;
+}
+
+void shovelerWorkerOpRecorderWriteConnect(ShovelerWorkerOpRecorder *recorder, Worker_EntityId workerEntityId)
+{
+	appendInt64(recorder->payload, workerEntityId);
+	writeRecord(recorder, SHOVELER_WORKER_RECORD_TYPE_CONNECT);
+}
+
+void shovelerWorkerOpRecorderWriteWorkerFlag(ShovelerWorkerOpRecorder *recorder, const char *name, const char *value)
+{
+	appendString(recorder->payload, name);
+	appendString(recorder->payload, value);
+	writeRecord(recorder, SHOVELER_WORKER_RECORD_TYPE_WORKER_FLAG);
+}
+
+void shovelerWorkerOpRecorderWriteOpList(ShovelerWorkerOpRecorder *recorder, const Worker_OpList *opList)
+{
+	// patched below once we know how many ops were actually recorded
+	appendUint32(recorder->payload, 0);
+
+	uint32_t numRecordedOps = 0;
+	for(uint32_t i = 0; i < opList->op_count; i++) {
+		if(appendOp(recorder->payload, &opList->ops[i])) {
+			numRecordedOps++;
+		}
+	}
+
+	for(int i = 0; i < 4; i++) {
+		recorder->payload->str[i] = (char) ((numRecordedOps >> (8 * i)) & 0xff);
+	}
+
+	writeRecord(recorder, SHOVELER_WORKER_RECORD_TYPE_OP_LIST);
+}
+
+void shovelerWorkerOpRecorderWriteSendComponentUpdate(ShovelerWorkerOpRecorder *recorder, int64_t result, Worker_EntityId entityId, const Worker_ComponentUpdate *componentUpdate)
+{
+	appendInt64(recorder->payload, result);
+	appendInt64(recorder->payload, entityId);
+	appendComponentUpdate(recorder->payload, componentUpdate);
+	writeRecord(recorder, SHOVELER_WORKER_RECORD_TYPE_SEND_COMPONENT_UPDATE);
+}
+
+void shovelerWorkerOpRecorderWriteSendCommandRequest(ShovelerWorkerOpRecorder *recorder, Worker_RequestId requestId, Worker_EntityId entityId, const Worker_CommandRequest *commandRequest)
+{
+	appendInt64(recorder->payload, requestId);
+	appendInt64(recorder->payload, entityId);
+	appendUint32(recorder->payload, commandRequest->component_id);
+	appendUint32(recorder->payload, commandRequest->command_index);
+	appendObject(recorder->payload, Schema_GetCommandRequestObject(commandRequest->schema_type));
+	writeRecord(recorder, SHOVELER_WORKER_RECORD_TYPE_SEND_COMMAND_REQUEST);
+}
+
+void shovelerWorkerOpRecorderWriteSendCommandResponse(ShovelerWorkerOpRecorder *recorder, int64_t result, Worker_RequestId requestId, const Worker_CommandResponse *commandResponse)
+{
+	appendInt64(recorder->payload, result);
+	appendInt64(recorder->payload, requestId);
+	appendUint32(recorder->payload, commandResponse->component_id);
+	appendUint32(recorder->payload, commandResponse->command_index);
+	appendObject(recorder->payload, Schema_GetCommandResponseObject(commandResponse->schema_type));
+	writeRecord(recorder, SHOVELER_WORKER_RECORD_TYPE_SEND_COMMAND_RESPONSE);
+}
+
+void shovelerWorkerOpRecorderWriteSendCommandFailure(ShovelerWorkerOpRecorder *recorder, int64_t result, Worker_RequestId requestId, const char *message)
+{
+	appendInt64(recorder->payload, result);
+	appendInt64(recorder->payload, requestId);
+	appendString(recorder->payload, message);
+	writeRecord(recorder, SHOVELER_WORKER_RECORD_TYPE_SEND_COMMAND_FAILURE);
+}
+
+void shovelerWorkerOpRecorderWriteSendCreateEntityRequest(ShovelerWorkerOpRecorder *recorder, Worker_RequestId requestId, uint32_t componentCount, const Worker_ComponentData *components, const Worker_EntityId *entityId)
+{
+	appendInt64(recorder->payload, requestId);
+	appendUint8(recorder->payload, entityId != NULL);
+	appendInt64(recorder->payload, entityId != NULL ? *entityId : 0);
+	appendUint32(recorder->payload, componentCount);
+	for(uint32_t i = 0; i < componentCount; i++) {
+		appendComponentData(recorder->payload, &components[i]);
+	}
+	writeRecord(recorder, SHOVELER_WORKER_RECORD_TYPE_SEND_CREATE_ENTITY_REQUEST);
+}
+
+void shovelerWorkerOpRecorderWriteSendDeleteEntityRequest(ShovelerWorkerOpRecorder *recorder, Worker_RequestId requestId, Worker_EntityId entityId)
+{
+	appendInt64(recorder->payload, requestId);
+	appendInt64(recorder->payload, entityId);
+	writeRecord(recorder, SHOVELER_WORKER_RECORD_TYPE_SEND_DELETE_ENTITY_REQUEST);
+}
+
+void shovelerWorkerOpRecorderWriteSendReserveEntityIdsRequest(ShovelerWorkerOpRecorder *recorder, Worker_RequestId requestId, uint32_t numberOfEntityIds)
+{
+	appendInt64(recorder->payload, requestId);
+	appendUint32(recorder->payload, numberOfEntityIds);
+	writeRecord(recorder, SHOVELER_WORKER_RECORD_TYPE_SEND_RESERVE_ENTITY_IDS_REQUEST);
+}
+
+void shovelerWorkerOpRecorderFree(ShovelerWorkerOpRecorder *recorder)
+{
+	if(recorder == NULL) {
+		return;
+	}
+
+	fclose(recorder->file);
+	g_string_free(recorder->payload, true);
+	free(recorder);
+}
+
+ShovelerWorkerRecording *shovelerWorkerRecordingRead(const char *filename)
+{
+	FILE *file = fopen(filename, "rb");
+	if(file == NULL) {
+		shovelerLogError("Failed to open op recording file '%s' for reading: %s", filename, strerror(errno));
+		return NULL;
+	}
+
+	fseek(file, 0, SEEK_END);
+	long fileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	ShovelerWorkerRecording *recording = malloc(sizeof(ShovelerWorkerRecording));
+	recording->contents = malloc(fileSize > 0 ? fileSize : 1);
+	recording->length = fread(recording->contents, 1, fileSize, file);
+	recording->records = g_array_new(/* zeroTerminated */ false, /* clear */ true, sizeof(ShovelerWorkerRecord));
+	fclose(file);
+
+	RecordReader reader = {recording->contents, (uint32_t) recording->length, 0, false};
+	while(reader.position < reader.length) {
+		ShovelerWorkerRecord record;
+		record.type = readUint32(&reader);
+		record.payloadLength = readUint32(&reader);
+		if(reader.failed || record.type >= SHOVELER_WORKER_RECORD_TYPE_NUM_TYPES || record.payloadLength > reader.length - reader.position) {
+			shovelerLogError("Failed to read op recording file '%s': malformed record at offset %u.", filename, reader.position);
+			shovelerWorkerRecordingFree(recording);
+			return NULL;
+		}
+
+		record.payload = reader.data + reader.position;
+		reader.position += record.payloadLength;
+
+		record.sendResult = 0;
+		if(shovelerWorkerRecordIsSend(&record)) {
+			RecordReader payloadReader = {record.payload, record.payloadLength, 0, false};
+			record.sendResult = readInt64(&payloadReader);
+		}
+
+		g_array_append_val(recording->records, record);
+	}
+
+	shovelerLogInfo("Read op recording file '%s' with %u records.", filename, recording->records->len);
+	return recording;
+}
+
+bool shovelerWorkerRecordDecodeConnect(const ShovelerWorkerRecord *record, Worker_EntityId *outputWorkerEntityId)
+{
+	if(record->type != SHOVELER_WORKER_RECORD_TYPE_CONNECT) {
+		return false;
+	}
+
+	RecordReader reader = {record->payload, record->payloadLength, 0, false};
+	*outputWorkerEntityId = readInt64(&reader);
+	return !reader.failed;
+}
+
+bool shovelerWorkerRecordDecodeWorkerFlag(const ShovelerWorkerRecord *record, const char **outputName, const char **outputValue)
+{
+	if(record->type != SHOVELER_WORKER_RECORD_TYPE_WORKER_FLAG) {
+		return false;
+	}
+
+	RecordReader reader = {record->payload, record->payloadLength, 0, false};
+	*outputName = readString(&reader);
+	*outputValue = readString(&reader);
+	return !reader.failed && *outputName != NULL;
+}
+
+Worker_OpList *shovelerWorkerRecordDecodeOpList(const ShovelerWorkerRecord *record)
+{
+	if(record->type != SHOVELER_WORKER_RECORD_TYPE_OP_LIST) {
+		return NULL;
+	}
+
+	RecordReader reader = {record->payload, record->payloadLength, 0, false};
+	uint32_t opCount = readUint32(&reader);
+	if(reader.failed || opCount > record->payloadLength) {
+		return NULL;
+	}
+
+	Worker_OpList *opList = malloc(sizeof(Worker_OpList));
+	opList->op_count = opCount;
+	opList->ops = calloc(opCount > 0 ? opCount : 1, sizeof(Worker_Op));
+	for(uint32_t i = 0; i < opCount; i++) {
+		readOp(&reader, &opList->ops[i]);
+	}
+
+	if(reader.failed) {
+		shovelerLogWarning("Failed to decode recorded op list, replaying it as an empty op list.");
+		shovelerWorkerRecordFreeOpList(opList);
+
+		opList = malloc(sizeof(Worker_OpList));
+		opList->op_count = 0;
+		opList->ops = NULL;
+	}
+
+	return opList;
+}
+
+void shovelerWorkerRecordFreeOpList(Worker_OpList *opList)
+{
+	for(uint32_t i = 0; i < opList->op_count; i++) {
+		freeOp(&opList->ops[i]);
+	}
+
+	free(opList->ops);
+	free(opList);
+}
+
+void shovelerWorkerRecordingFree(ShovelerWorkerRecording *recording)
+{
+	if(recording == NULL) {
+		return;
+	}
+
+	g_array_free(recording->records, true);
+	free(recording->contents);
+	free(recording);
+}
+
+static void writeRecord(ShovelerWorkerOpRecorder *recorder, ShovelerWorkerRecordType type)
+{
+	uint8_t header[8];
+	uint32_t payloadLength = (uint32_t) recorder->payload->len;
+	for(int i = 0; i < 4; i++) {
+		header[i] = (uint8_t) ((type >> (8 * i)) & 0xff);
+		header[4 + i] = (uint8_t) ((payloadLength >> (8 * i)) & 0xff);
+	}
+
+	fwrite(header, 1, sizeof(header), recorder->file);
+	fwrite(recorder->payload->str, 1, payloadLength, recorder->file);
+	g_string_truncate(recorder->payload, 0);
+}
+
+static void appendUint8(GString *payload, uint8_t value)
+{
+	g_string_append_c(payload, (char) value);
+}
+
+static void appendUint32(GString *payload, uint32_t value)
+{
+	for(int i = 0; i < 4; i++) {
+		g_string_append_c(payload, (char) ((value >> (8 * i)) & 0xff));
+	}
+}
+
+static void appendInt64(GString *payload, int64_t value)
+{
+	uint64_t unsignedValue = (uint64_t) value;
+	for(int i = 0; i < 8; i++) {
+		g_string_append_c(payload, (char) ((unsignedValue >> (8 * i)) & 0xff));
+	}
+}
+
+static void appendString(GString *payload, const char *value)
+{
+	if(value == NULL) {
+		appendUint32(payload, NULL_STRING_LENGTH);
+		return;
+	}
+
+	uint32_t length = (uint32_t) strlen(value);
+	appendUint32(payload, length);
+	// include the null terminator so that decoded strings can point into the recording
+	g_string_append_len(payload, value, length + 1);
+}
+
+static void appendObject(GString *payload, const Schema_Object *object)
+{
+	uint32_t length = Schema_GetWriteBufferLength(object);
+	appendUint32(payload, length);
+
+	size_t offset = payload->len;
+	g_string_set_size(payload, offset + length);
+	if(!Schema_SerializeToBuffer(object, (uint8_t *) payload->str + offset, length)) {
+		shovelerLogWarning("Failed to serialize schema object for op recording: %s", Schema_GetError(object));
+		memset(payload->str + offset, 0, length);
+	}
+}
+
+static void appendComponentData(GString *payload, const Worker_ComponentData *componentData)
+{
+	appendUint32(payload, componentData->component_id);
+	appendObject(payload, Schema_GetComponentDataFields(componentData->schema_type));
+}
+
+static void appendComponentUpdate(GString *payload, const Worker_ComponentUpdate *componentUpdate)
+{
+	appendUint32(payload, componentUpdate->component_id);
+	appendObject(payload, Schema_GetComponentUpdateFields(componentUpdate->schema_type));
+	appendObject(payload, Schema_GetComponentUpdateEvents(componentUpdate->schema_type));
+
+	uint32_t numClearedFields = Schema_GetComponentUpdateClearedFieldCount(componentUpdate->schema_type);
+	appendUint32(payload, numClearedFields);
+	if(numClearedFields > 0) {
+		Schema_FieldId *clearedFields = malloc(numClearedFields * sizeof(Schema_FieldId));
+		Schema_GetComponentUpdateClearedFieldList(componentUpdate->schema_type, clearedFields);
+		for(uint32_t i = 0; i < numClearedFields; i++) {
+			appendUint32(payload, clearedFields[i]);
+		}
+		free(clearedFields);
+	}
+}
+
+static bool appendOp(GString *payload, const Worker_Op *op)
+{
+	switch(op->op_type) {
+		case WORKER_OP_TYPE_DISCONNECT:
+			appendUint8(payload, op->op_type);
+			appendUint8(payload, op->op.disconnect.connection_status_code);
+			appendString(payload, op->op.disconnect.reason);
+			return true;
+		case WORKER_OP_TYPE_FLAG_UPDATE:
+			appendUint8(payload, op->op_type);
+			appendString(payload, op->op.flag_update.name);
+			appendString(payload, op->op.flag_update.value);
+			return true;
+		case WORKER_OP_TYPE_CRITICAL_SECTION:
+			appendUint8(payload, op->op_type);
+			appendUint8(payload, op->op.critical_section.in_critical_section);
+			return true;
+		case WORKER_OP_TYPE_ADD_ENTITY:
+			appendUint8(payload, op->op_type);
+			appendInt64(payload, op->op.add_entity.entity_id);
+			return true;
+		case WORKER_OP_TYPE_REMOVE_ENTITY:
+			appendUint8(payload, op->op_type);
+			appendInt64(payload, op->op.remove_entity.entity_id);
+			return true;
+		case WORKER_OP_TYPE_RESERVE_ENTITY_IDS_RESPONSE:
+			appendUint8(payload, op->op_type);
+			appendInt64(payload, op->op.reserve_entity_ids_response.request_id);
+			appendUint8(payload, op->op.reserve_entity_ids_response.status_code);
+			appendString(payload, op->op.reserve_entity_ids_response.message);
+			appendInt64(payload, op->op.reserve_entity_ids_response.first_entity_id);
+			appendUint32(payload, op->op.reserve_entity_ids_response.number_of_entity_ids);
+			return true;
+		case WORKER_OP_TYPE_CREATE_ENTITY_RESPONSE:
+			appendUint8(payload, op->op_type);
+			appendInt64(payload, op->op.create_entity_response.request_id);
+			appendUint8(payload, op->op.create_entity_response.status_code);
+			appendString(payload, op->op.create_entity_response.message);
+			appendInt64(payload, op->op.create_entity_response.entity_id);
+			return true;
+		case WORKER_OP_TYPE_DELETE_ENTITY_RESPONSE:
+			appendUint8(payload, op->op_type);
+			appendInt64(payload, op->op.delete_entity_response.request_id);
+			appendInt64(payload, op->op.delete_entity_response.entity_id);
+			appendUint8(payload, op->op.delete_entity_response.status_code);
+			appendString(payload, op->op.delete_entity_response.message);
+			return true;
+		case WORKER_OP_TYPE_ADD_COMPONENT:
+			appendUint8(payload, op->op_type);
+			appendInt64(payload, op->op.add_component.entity_id);
+			appendComponentData(payload, &op->op.add_component.data);
+			return true;
+		case WORKER_OP_TYPE_REMOVE_COMPONENT:
+			appendUint8(payload, op->op_type);
+			appendInt64(payload, op->op.remove_component.entity_id);
+			appendUint32(payload, op->op.remove_component.component_id);
+			return true;
+		case WORKER_OP_TYPE_COMPONENT_SET_AUTHORITY_CHANGE:
+			// the canonical component set data isn't recorded since none of the workers read it
+			appendUint8(payload, op->op_type);
+			appendInt64(payload, op->op.component_set_authority_change.entity_id);
+			appendUint32(payload, op->op.component_set_authority_change.component_set_id);
+			appendUint8(payload, op->op.component_set_authority_change.authority);
+			return true;
+		case WORKER_OP_TYPE_COMPONENT_UPDATE:
+			appendUint8(payload, op->op_type);
+			appendInt64(payload, op->op.component_update.entity_id);
+			appendComponentUpdate(payload, &op->op.component_update.update);
+			return true;
+		case WORKER_OP_TYPE_COMMAND_REQUEST:
+			appendUint8(payload, op->op_type);
+			appendInt64(payload, op->op.command_request.request_id);
+			appendInt64(payload, op->op.command_request.entity_id);
+			appendInt64(payload, op->op.command_request.caller_worker_entity_id);
+			appendUint32(payload, op->op.command_request.request.component_id);
+			appendUint32(payload, op->op.command_request.request.command_index);
+			appendObject(payload, Schema_GetCommandRequestObject(op->op.command_request.request.schema_type));
+			return true;
+		case WORKER_OP_TYPE_COMMAND_RESPONSE: {
+			bool hasResponse = op->op.command_response.response.schema_type != NULL;
+			appendUint8(payload, op->op_type);
+			appendInt64(payload, op->op.command_response.request_id);
+			appendInt64(payload, op->op.command_response.entity_id);
+			appendUint8(payload, op->op.command_response.status_code);
+			appendString(payload, op->op.command_response.message);
+			appendUint32(payload, op->op.command_response.response.component_id);
+			appendUint32(payload, op->op.command_response.response.command_index);
+			appendUint8(payload, hasResponse);
+			if(hasResponse) {
+				appendObject(payload, Schema_GetCommandResponseObject(op->op.command_response.response.schema_type));
+			}
+		} return true;
+		default:
+			// metrics and entity query responses aren't needed to replay the workers
+			return false;
+	}
+}
+
+static uint8_t readUint8(RecordReader *reader)
+{
+	if(reader->failed || reader->length - reader->position < 1) {
+		reader->failed = true;
+		return 0;
+	}
+
+	return reader->data[reader->position++];
+}
+
+static uint32_t readUint32(RecordReader *reader)
+{
+	if(reader->failed || reader->length - reader->position < 4) {
+		reader->failed = true;
+		return 0;
+	}
+
+	uint32_t value = 0;
+	for(int i = 0; i < 4; i++) {
+		value |= ((uint32_t) reader->data[reader->position++]) << (8 * i);
+	}
+	return value;
+}
+
+static int64_t readInt64(RecordReader *reader)
+{
+	if(reader->failed || reader->length - reader->position < 8) {
+		reader->failed = true;
+		return 0;
+	}
+
+	uint64_t value = 0;
+	for(int i = 0; i < 8; i++) {
+		value |= ((uint64_t) reader->data[reader->position++]) << (8 * i);
+	}
+	return (int64_t) value;
+}
+
+static const char *readString(RecordReader *reader)
+{
+	uint32_t length = readUint32(reader);
+	if(reader->failed || length == NULL_STRING_LENGTH) {
+		return NULL;
+	}
+
+	if(reader->length - reader->position < length + 1 || reader->data[reader->position + length] != '\0') {
+		reader->failed = true;
+		return NULL;
+	}
+
+	const char *value = (const char *) reader->data + reader->position;
+	reader->position += length + 1;
+	return value;
+}
+
+static void readObject(RecordReader *reader, Schema_Object *object)
+{
+	uint32_t length = readUint32(reader);
+	if(reader->failed || reader->length - reader->position < length) {
+		reader->failed = true;
+		return;
+	}
+
+	if(!Schema_MergeFromBuffer(object, reader->data + reader->position, length)) {
+		shovelerLogWarning("Failed to merge recorded schema object: %s", Schema_GetError(object));
+		reader->failed = true;
+	}
+	reader->position += length;
+}
+
+static void readComponentData(RecordReader *reader, Worker_ComponentData *componentData)
+{
+	memset(componentData, 0, sizeof(Worker_ComponentData));
+	componentData->component_id = readUint32(reader);
+	componentData->schema_type = Schema_CreateComponentData();
+	readObject(reader, Schema_GetComponentDataFields(componentData->schema_type));
+}
+
+static void readComponentUpdate(RecordReader *reader, Worker_ComponentUpdate *componentUpdate)
+{
+	memset(componentUpdate, 0, sizeof(Worker_ComponentUpdate));
+	componentUpdate->component_id = readUint32(reader);
+	componentUpdate->schema_type = Schema_CreateComponentUpdate();
+	readObject(reader, Schema_GetComponentUpdateFields(componentUpdate->schema_type));
+	readObject(reader, Schema_GetComponentUpdateEvents(componentUpdate->schema_type));
+
+	uint32_t numClearedFields = readUint32(reader);
+	for(uint32_t i = 0; i < numClearedFields && !reader->failed; i++) {
+		Schema_AddComponentUpdateClearedField(componentUpdate->schema_type, readUint32(reader));
+	}
+}
+
+static void readOp(RecordReader *reader, Worker_Op *op)
+{
+	memset(op, 0, sizeof(Worker_Op));
+	op->op_type = readUint8(reader);
+	if(reader->failed) {
+		return;
+	}
+
+	switch(op->op_type) {
+		case WORKER_OP_TYPE_DISCONNECT:
+			op->op.disconnect.connection_status_code = readUint8(reader);
+			op->op.disconnect.reason = readString(reader);
+			break;
+		case WORKER_OP_TYPE_FLAG_UPDATE:
+			op->op.flag_update.name = readString(reader);
+			op->op.flag_update.value = readString(reader);
+			break;
+		case WORKER_OP_TYPE_CRITICAL_SECTION:
+			op->op.critical_section.in_critical_section = readUint8(reader);
+			break;
+		case WORKER_OP_TYPE_ADD_ENTITY:
+			op->op.add_entity.entity_id = readInt64(reader);
+			break;
+		case WORKER_OP_TYPE_REMOVE_ENTITY:
+			op->op.remove_entity.entity_id = readInt64(reader);
+			break;
+		case WORKER_OP_TYPE_RESERVE_ENTITY_IDS_RESPONSE:
+			op->op.reserve_entity_ids_response.request_id = readInt64(reader);
+			op->op.reserve_entity_ids_response.status_code = readUint8(reader);
+			op->op.reserve_entity_ids_response.message = readString(reader);
+			op->op.reserve_entity_ids_response.first_entity_id = readInt64(reader);
+			op->op.reserve_entity_ids_response.number_of_entity_ids = readUint32(reader);
+			break;
+		case WORKER_OP_TYPE_CREATE_ENTITY_RESPONSE:
+			op->op.create_entity_response.request_id = readInt64(reader);
+			op->op.create_entity_response.status_code = readUint8(reader);
+			op->op.create_entity_response.message = readString(reader);
+			op->op.create_entity_response.entity_id = readInt64(reader);
+			break;
+		case WORKER_OP_TYPE_DELETE_ENTITY_RESPONSE:
+			op->op.delete_entity_response.request_id = readInt64(reader);
+			op->op.delete_entity_response.entity_id = readInt64(reader);
+			op->op.delete_entity_response.status_code = readUint8(reader);
+			op->op.delete_entity_response.message = readString(reader);
+			break;
+		case WORKER_OP_TYPE_ADD_COMPONENT:
+			op->op.add_component.entity_id = readInt64(reader);
+			readComponentData(reader, &op->op.add_component.data);
+			break;
+		case WORKER_OP_TYPE_REMOVE_COMPONENT:
+			op->op.remove_component.entity_id = readInt64(reader);
+			op->op.remove_component.component_id = readUint32(reader);
+			break;
+		case WORKER_OP_TYPE_COMPONENT_SET_AUTHORITY_CHANGE:
+			op->op.component_set_authority_change.entity_id = readInt64(reader);
+			op->op.component_set_authority_change.component_set_id = readUint32(reader);
+			op->op.component_set_authority_change.authority = readUint8(reader);
+			break;
+		case WORKER_OP_TYPE_COMPONENT_UPDATE:
+			op->op.component_update.entity_id = readInt64(reader);
+			readComponentUpdate(reader, &op->op.component_update.update);
+			break;
+		case WORKER_OP_TYPE_COMMAND_REQUEST:
+			op->op.command_request.request_id = readInt64(reader);
+			op->op.command_request.entity_id = readInt64(reader);
+			op->op.command_request.caller_worker_entity_id = readInt64(reader);
+			op->op.command_request.request.component_id = readUint32(reader);
+			op->op.command_request.request.command_index = readUint32(reader);
+			op->op.command_request.request.schema_type = Schema_CreateCommandRequest();
+			readObject(reader, Schema_GetCommandRequestObject(op->op.command_request.request.schema_type));
+			break;
+		case WORKER_OP_TYPE_COMMAND_RESPONSE:
+			op->op.command_response.request_id = readInt64(reader);
+			op->op.command_response.entity_id = readInt64(reader);
+			op->op.command_response.status_code = readUint8(reader);
+			op->op.command_response.message = readString(reader);
+			op->op.command_response.response.component_id = readUint32(reader);
+			op->op.command_response.response.command_index = readUint32(reader);
+			if(readUint8(reader)) {
+				op->op.command_response.response.schema_type = Schema_CreateCommandResponse();
+				readObject(reader, Schema_GetCommandResponseObject(op->op.command_response.response.schema_type));
+			}
+			break;
+		default:
+			reader->failed = true;
+			break;
+	}
+}
+
+static void freeOp(Worker_Op *op)
+{
+	switch(op->op_type) {
+		case WORKER_OP_TYPE_ADD_COMPONENT:
+			if(op->op.add_component.data.schema_type != NULL) {
+				Schema_DestroyComponentData(op->op.add_component.data.schema_type);
+			}
+			break;
+		case WORKER_OP_TYPE_COMPONENT_UPDATE:
+			if(op->op.component_update.update.schema_type != NULL) {
+				Schema_DestroyComponentUpdate(op->op.component_update.update.schema_type);
+			}
+			break;
+		case WORKER_OP_TYPE_COMMAND_REQUEST:
+			if(op->op.command_request.request.schema_type != NULL) {
+				Schema_DestroyCommandRequest(op->op.command_request.request.schema_type);
+			}
+			break;
+		case WORKER_OP_TYPE_COMMAND_RESPONSE:
+			if(op->op.command_response.response.schema_type != NULL) {
+				Schema_DestroyCommandResponse(op->op.command_response.response.schema_type);
+			}
+			break;
+		default:
+			break;
+	}
+}
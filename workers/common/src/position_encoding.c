@@ -0,0 +1,223 @@
+#include "shoveler/position_encoding.h"
+
+#include <math.h> // floorf
+
+#include <shoveler/position_quantizer.h>
+
+#define CELL_BITS 16
+#define CELL_CENTER (UINT64_C(1) << (63 - CELL_BITS))
+#define MAX_CELL ((INT64_C(1) << CELL_BITS) - 1)
+/* largest delta whose zigzag varint still fits into two bytes */
+#define MAX_DELTA 8191
+
+static bool quantizeChunk(const ShovelerWorkerPositionEncoding *encoding, float coordinate, float min, int numChunks, int64_t *outputChunk, int64_t *outputCell);
+static float dequantizeChunk(const ShovelerWorkerPositionEncoding *encoding, float min, int64_t chunk, int64_t cell);
+static ShovelerPositionQuantizer getHeightQuantizer(const ShovelerWorkerPositionEncoding *encoding);
+static void unpack(uint64_t quantized, int64_t *outputGlobal);
+static bool pack(const ShovelerWorkerPositionEncoding *encoding, const int64_t *global, uint64_t *outputQuantized);
+static int writeVarint(int64_t value, unsigned char *output);
+static int readVarint(const unsigned char *input, int inputLength, int64_t *outputValue);
+
+ShovelerWorkerPositionEncoding shovelerWorkerPositionEncoding(ShovelerVector2 worldMin, float chunkSize, int numChunkColumns, int numChunkRows, float heightMin, float heightSize)
+{
+	ShovelerWorkerPositionEncoding encoding;
+	encoding.worldMin = worldMin;
+	encoding.chunkSize = chunkSize;
+	encoding.numChunkColumns = numChunkColumns;
+	encoding.numChunkRows = numChunkRows;
+	encoding.heightMin = heightMin;
+	encoding.heightSize = heightSize;
+	return encoding;
+}
+
+bool shovelerWorkerPositionEncodingQuantize(const ShovelerWorkerPositionEncoding *encoding, ShovelerVector3 coordinates, uint64_t *outputQuantized)
+{
+	int64_t chunkX;
+	int64_t cellX;
+	if(!quantizeChunk(encoding, coordinates.values[0], encoding->worldMin.values[0], encoding->numChunkColumns, &chunkX, &cellX)) {
+		return false;
+	}
+
+	int64_t chunkY;
+	int64_t cellY;
+	if(!quantizeChunk(encoding, coordinates.values[1], encoding->worldMin.values[1], encoding->numChunkRows, &chunkY, &cellY)) {
+		return false;
+	}
+
+	float height = coordinates.values[2];
+	if(!(height >= encoding->heightMin && height < encoding->heightMin + encoding->heightSize)) {
+		return false;
+	}
+
+	ShovelerPositionQuantizer heightQuantizer = getHeightQuantizer(encoding);
+	uint64_t cellZ = shovelerPositionQuantizerFromWorldX(&heightQuantizer, height) >> (64 - CELL_BITS);
+
+	*outputQuantized = ((uint64_t) chunkX << 56) | ((uint64_t) chunkY << 48) | ((uint64_t) cellX << 32) | ((uint64_t) cellY << 16) | cellZ;
+	return true;
+}
+
+ShovelerVector3 shovelerWorkerPositionEncodingDequantize(const ShovelerWorkerPositionEncoding *encoding, uint64_t quantized)
+{
+	ShovelerPositionQuantizer heightQuantizer = getHeightQuantizer(encoding);
+	uint64_t cellZ = quantized & MAX_CELL;
+
+	return shovelerVector3(
+		dequantizeChunk(encoding, encoding->worldMin.values[0], (int64_t) (quantized >> 56), (int64_t) ((quantized >> 32) & MAX_CELL)),
+		dequantizeChunk(encoding, encoding->worldMin.values[1], (int64_t) ((quantized >> 48) & 0xff), (int64_t) ((quantized >> 16) & MAX_CELL)),
+		shovelerPositionQuantizerToWorldX(&heightQuantizer, (cellZ << (64 - CELL_BITS)) | CELL_CENTER));
+}
+
+int shovelerWorkerPositionEncodingEncode(const ShovelerWorkerPositionEncoding *encoding, ShovelerWorkerPositionStream *stream, ShovelerVector3 coordinates, bool *outputNewOrigin, unsigned char *outputDelta)
+{
+	uint64_t quantized;
+	if(!shovelerWorkerPositionEncodingQuantize(encoding, coordinates, &quantized)) {
+		return -1;
+	}
+
+	int64_t global[3];
+	unpack(quantized, global);
+
+	*outputNewOrigin = !stream->hasOrigin;
+	if(stream->hasOrigin) {
+		int64_t origin[3];
+		unpack(stream->origin, origin);
+
+		for(int i = 0; i < 3; i++) {
+			int64_t delta = global[i] - origin[i];
+			if(delta < -MAX_DELTA || delta > MAX_DELTA) {
+				*outputNewOrigin = true;
+				break;
+			}
+		}
+	}
+
+	if(*outputNewOrigin) {
+		stream->hasOrigin = true;
+		stream->origin = quantized;
+	}
+
+	int64_t origin[3];
+	unpack(stream->origin, origin);
+
+	int length = 0;
+	for(int i = 0; i < 3; i++) {
+		length += writeVarint(global[i] - origin[i], outputDelta + length);
+	}
+
+	return length;
+}
+
+bool shovelerWorkerPositionEncodingDecode(const ShovelerWorkerPositionEncoding *encoding, const ShovelerWorkerPositionStream *stream, const unsigned char *delta, int deltaLength, ShovelerVector3 *outputCoordinates)
+{
+	if(!stream->hasOrigin) {
+		return false;
+	}
+
+	int64_t global[3];
+	unpack(stream->origin, global);
+
+	int position = 0;
+	for(int i = 0; i < 3; i++) {
+		int64_t value;
+		int length = readVarint(delta + position, deltaLength - position, &value);
+		if(length == 0) {
+			return false;
+		}
+
+		global[i] += value;
+		position += length;
+	}
+
+	if(position != deltaLength) {
+		return false;
+	}
+
+	uint64_t quantized;
+	if(!pack(encoding, global, &quantized)) {
+		return false;
+	}
+
+	*outputCoordinates = shovelerWorkerPositionEncodingDequantize(encoding, quantized);
+	return true;
+}
+
+static bool quantizeChunk(const ShovelerWorkerPositionEncoding *encoding, float coordinate, float min, int numChunks, int64_t *outputChunk, int64_t *outputCell)
+{
+	float chunk = floorf((coordinate - min) / encoding->chunkSize);
+	if(!(chunk >= 0.0f && chunk < (float) numChunks)) {
+		return false;
+	}
+
+	float chunkMin = min + chunk * encoding->chunkSize;
+	ShovelerPositionQuantizer quantizer = shovelerPositionQuantizer(shovelerVector2(chunkMin, 0.0f), shovelerVector2(encoding->chunkSize, 1.0f));
+
+	*outputChunk = (int64_t) chunk;
+	*outputCell = (int64_t) (shovelerPositionQuantizerFromWorldX(&quantizer, coordinate) >> (64 - CELL_BITS));
+	return true;
+}
+
+static float dequantizeChunk(const ShovelerWorkerPositionEncoding *encoding, float min, int64_t chunk, int64_t cell)
+{
+	float chunkMin = min + (float) chunk * encoding->chunkSize;
+	ShovelerPositionQuantizer quantizer = shovelerPositionQuantizer(shovelerVector2(chunkMin, 0.0f), shovelerVector2(encoding->chunkSize, 1.0f));
+
+	return shovelerPositionQuantizerToWorldX(&quantizer, ((uint64_t) cell << (64 - CELL_BITS)) | CELL_CENTER);
+}
+
+static ShovelerPositionQuantizer getHeightQuantizer(const ShovelerWorkerPositionEncoding *encoding)
+{
+	return shovelerPositionQuantizer(shovelerVector2(encoding->heightMin, 0.0f), shovelerVector2(encoding->heightSize, 1.0f));
+}
+
+/** Unpacks into global cell coordinates that continue across chunk borders. */
+static void unpack(uint64_t quantized, int64_t *outputGlobal)
+{
+	outputGlobal[0] = (int64_t) ((quantized >> 56) << CELL_BITS) | (int64_t) ((quantized >> 32) & MAX_CELL);
+	outputGlobal[1] = (int64_t) (((quantized >> 48) & 0xff) << CELL_BITS) | (int64_t) ((quantized >> 16) & MAX_CELL);
+	outputGlobal[2] = (int64_t) (quantized & MAX_CELL);
+}
+
+static bool pack(const ShovelerWorkerPositionEncoding *encoding, const int64_t *global, uint64_t *outputQuantized)
+{
+	if(global[0] < 0 || global[0] >= ((int64_t) encoding->numChunkColumns << CELL_BITS)
+		|| global[1] < 0 || global[1] >= ((int64_t) encoding->numChunkRows << CELL_BITS)
+		|| global[2] < 0 || global[2] > MAX_CELL) {
+		return false;
+	}
+
+	*outputQuantized = ((uint64_t) (global[0] >> CELL_BITS) << 56)
+		| ((uint64_t) (global[1] >> CELL_BITS) << 48)
+		| ((uint64_t) (global[0] & MAX_CELL) << 32)
+		| ((uint64_t) (global[1] & MAX_CELL) << 16)
+		| (uint64_t) global[2];
+	return true;
+}
+
+static int writeVarint(int64_t value, unsigned char *output)
+{
+	uint64_t zigzag = ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+
+	int length = 0;
+	do {
+		unsigned char byte = zigzag & 0x7f;
+		zigzag >>= 7;
+		output[length++] = zigzag != 0 ? (byte | 0x80) : byte;
+	} while(zigzag != 0);
+
+	return length;
+}
+
+/** Returns the number of bytes read, or zero if the input ends before the varint does. */
+static int readVarint(const unsigned char *input, int inputLength, int64_t *outputValue)
+{
+	uint64_t zigzag = 0;
+	for(int i = 0; i < inputLength && i < 10; i++) {
+		zigzag |= (uint64_t) (input[i] & 0x7f) << (7 * i);
+		if((input[i] & 0x80) == 0) {
+			*outputValue = (int64_t) (zigzag >> 1) ^ -(int64_t) (zigzag & 1);
+			return i + 1;
+		}
+	}
+
+	return 0;
+}
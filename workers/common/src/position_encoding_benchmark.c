@@ -0,0 +1,186 @@
+/**
+ * Compares plain and quantized position component updates for a crowd of entities walking around
+ * the world, reporting the serialized update size and the time it takes to build and read them.
+ *
+ * Usage: position_encoding_benchmark [num entities] [num ticks]
+ */
+#include <stdbool.h> // bool
+#include <stdint.h> // int64_t uint32_t
+#include <stdio.h> // fprintf printf
+#include <stdlib.h> // atoi malloc free EXIT_FAILURE EXIT_SUCCESS
+
+#include <glib.h>
+#include <improbable/c_schema.h>
+#include <shoveler/spatialos_schema.h>
+#include <shoveler/types.h>
+
+typedef struct {
+	ShovelerVector3 position;
+	ShovelerVector3 direction;
+	ShovelerWorkerPositionStream senderStream;
+	ShovelerWorkerPositionStream receiverStream;
+} Walker;
+
+typedef struct {
+	int64_t totalBytes;
+	int64_t buildUs;
+	int64_t readUs;
+	int numMismatches;
+} Result;
+
+static Result runWalkers(Walker *walkers, int numWalkers, int numTicks, bool quantized);
+static void resetWalkers(Walker *walkers, int numWalkers);
+static void step(Walker *walker, uint32_t *randomState);
+static bool readPlainCoordinates(Schema_Object *fields, ShovelerVector3 *outputCoordinates);
+static uint32_t nextRandom(uint32_t *state);
+
+static const float velocity = 1.5f;
+static const int tickRateHz = 30;
+
+int main(int argc, char **argv)
+{
+	if(argc != 1 && argc != 3) {
+		fprintf(stderr, "Usage:\n\t%s\n\t%s <num entities> <num ticks>\n", argv[0], argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	int numWalkers = argc == 3 ? atoi(argv[1]) : 1000;
+	int numTicks = argc == 3 ? atoi(argv[2]) : 300;
+	if(numWalkers <= 0 || numTicks <= 0) {
+		fprintf(stderr, "Number of entities and ticks must be positive.\n");
+		return EXIT_FAILURE;
+	}
+
+	Walker *walkers = malloc(numWalkers * sizeof(Walker));
+
+	resetWalkers(walkers, numWalkers);
+	Result plain = runWalkers(walkers, numWalkers, numTicks, /* quantized */ false);
+
+	resetWalkers(walkers, numWalkers);
+	Result quantized = runWalkers(walkers, numWalkers, numTicks, /* quantized */ true);
+
+	free(walkers);
+
+	int64_t numUpdates = (int64_t) numWalkers * numTicks;
+	printf("%d entities for %d ticks (%lld updates):\n", numWalkers, numTicks, (long long int) numUpdates);
+	printf(
+		"\tplain:     %.2f bytes per update, %.3fus to build and %.3fus to read per update\n",
+		(double) plain.totalBytes / numUpdates,
+		(double) plain.buildUs / numUpdates,
+		(double) plain.readUs / numUpdates);
+	printf(
+		"\tquantized: %.2f bytes per update, %.3fus to build and %.3fus to read per update\n",
+		(double) quantized.totalBytes / numUpdates,
+		(double) quantized.buildUs / numUpdates,
+		(double) quantized.readUs / numUpdates);
+	printf("\tquantized updates are %.1f%% of the plain size\n", 100.0 * quantized.totalBytes / plain.totalBytes);
+
+	if(plain.numMismatches > 0 || quantized.numMismatches > 0) {
+		fprintf(stderr, "%d plain and %d quantized updates didn't read back correctly.\n", plain.numMismatches, quantized.numMismatches);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+static Result runWalkers(Walker *walkers, int numWalkers, int numTicks, bool quantized)
+{
+	Result result = {0, 0, 0, 0};
+	uint32_t randomState = 42;
+	Schema_ComponentUpdate **componentUpdates = malloc(numWalkers * sizeof(Schema_ComponentUpdate *));
+	// half a quantization cell of the coarser height axis
+	float tolerance = quantized ? 0.5f * 256.0f / 65536.0f : 0.0f;
+
+	for(int tick = 0; tick < numTicks; tick++) {
+		for(int i = 0; i < numWalkers; i++) {
+			step(&walkers[i], &randomState);
+		}
+
+		int64_t buildStart = g_get_monotonic_time();
+		for(int i = 0; i < numWalkers; i++) {
+			componentUpdates[i] = Schema_CreateComponentUpdate();
+			shovelerWorkerSchemaAddPositionUpdateCoordinates(componentUpdates[i], &walkers[i].senderStream, quantized, walkers[i].position);
+		}
+		result.buildUs += g_get_monotonic_time() - buildStart;
+
+		for(int i = 0; i < numWalkers; i++) {
+			result.totalBytes += Schema_GetWriteBufferLength(Schema_GetComponentUpdateFields(componentUpdates[i]));
+		}
+
+		int64_t readStart = g_get_monotonic_time();
+		for(int i = 0; i < numWalkers; i++) {
+			Schema_Object *fields = Schema_GetComponentUpdateFields(componentUpdates[i]);
+
+			ShovelerVector3 coordinates;
+			if(!shovelerWorkerSchemaGetPositionQuantizedCoordinates(fields, &walkers[i].receiverStream, &coordinates)
+				&& !readPlainCoordinates(fields, &coordinates)) {
+				result.numMismatches++;
+				continue;
+			}
+
+			ShovelerVector3 difference = shovelerVector3LinearCombination(1.0f, coordinates, -1.0f, walkers[i].position);
+			if(shovelerVector3Dot(difference, difference) > 3.0f * tolerance * tolerance) {
+				result.numMismatches++;
+			}
+		}
+		result.readUs += g_get_monotonic_time() - readStart;
+
+		for(int i = 0; i < numWalkers; i++) {
+			Schema_DestroyComponentUpdate(componentUpdates[i]);
+		}
+	}
+
+	free(componentUpdates);
+	return result;
+}
+
+static void resetWalkers(Walker *walkers, int numWalkers)
+{
+	uint32_t randomState = 1337;
+	for(int i = 0; i < numWalkers; i++) {
+		walkers[i].position = shovelerVector3(
+			(float) (nextRandom(&randomState) % 19000) / 100.0f - 95.0f,
+			(float) (nextRandom(&randomState) % 19000) / 100.0f - 95.0f,
+			0.5f);
+		walkers[i].direction = shovelerVector3(1.0f, 0.0f, 0.0f);
+		walkers[i].senderStream.hasOrigin = false;
+		walkers[i].senderStream.origin = 0;
+		walkers[i].receiverStream.hasOrigin = false;
+		walkers[i].receiverStream.origin = 0;
+	}
+}
+
+static void step(Walker *walker, uint32_t *randomState)
+{
+	// like the bots: keep walking straight, occasionally turning and bouncing off the world's border
+	if(nextRandom(randomState) % 100 < 3) {
+		walker->direction = shovelerVector3(-walker->direction.values[1], walker->direction.values[0], 0.0f);
+	}
+
+	ShovelerVector3 next = shovelerVector3LinearCombination(1.0f, walker->position, velocity / tickRateHz, walker->direction);
+	if(next.values[0] < -99.0f || next.values[0] > 99.0f || next.values[1] < -99.0f || next.values[1] > 99.0f) {
+		walker->direction = shovelerVector3LinearCombination(-1.0f, walker->direction, 0.0f, walker->direction);
+		return;
+	}
+
+	walker->position = next;
+}
+
+static bool readPlainCoordinates(Schema_Object *fields, ShovelerVector3 *outputCoordinates)
+{
+	Schema_Object *coordinates = Schema_GetObject(fields, shovelerWorkerSchemaPositionFieldIdCoordinates);
+	if(coordinates == NULL) {
+		return false;
+	}
+
+	outputCoordinates->values[0] = Schema_GetFloat(coordinates, shovelerWorkerSchemaVector3FieldIdX);
+	outputCoordinates->values[1] = Schema_GetFloat(coordinates, shovelerWorkerSchemaVector3FieldIdY);
+	outputCoordinates->values[2] = Schema_GetFloat(coordinates, shovelerWorkerSchemaVector3FieldIdZ);
+	return true;
+}
+
+static uint32_t nextRandom(uint32_t *state)
+{
+	*state = *state * 1664525u + 1013904223u;
+	return *state >> 8;
+}
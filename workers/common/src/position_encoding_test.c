@@ -0,0 +1,245 @@
+/**
+ * Checks that quantized positions round trip, that deltas decode back to the encoded positions along
+ * a walk across chunk borders, and that the encoder moves its origin before deltas get too large.
+ *
+ * Usage: position_encoding_test
+ */
+#include <math.h> // fabsf
+#include <stdbool.h> // bool
+#include <stdint.h> // uint64_t
+#include <stdio.h> // fprintf printf
+#include <stdlib.h> // EXIT_FAILURE EXIT_SUCCESS
+
+#include <shoveler/position_encoding.h>
+#include <shoveler/types.h>
+
+static bool testQuantizeRoundTrip(const ShovelerWorkerPositionEncoding *encoding);
+static bool testQuantizeOutOfRange(const ShovelerWorkerPositionEncoding *encoding);
+static bool testDeltaWalk(const ShovelerWorkerPositionEncoding *encoding);
+static bool testDecodeMalformed(const ShovelerWorkerPositionEncoding *encoding);
+static bool isClose(ShovelerVector3 a, ShovelerVector3 b, float tolerance);
+
+static const float chunkSize = 10.0f;
+static const float heightSize = 128.0f;
+
+int main(int argc, char **argv)
+{
+	if(argc != 1) {
+		fprintf(stderr, "Usage:\n\t%s\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	ShovelerWorkerPositionEncoding encoding = shovelerWorkerPositionEncoding(
+		shovelerVector2(-100.0f, -100.0f),
+		chunkSize,
+		/* numChunkColumns */ 20,
+		/* numChunkRows */ 20,
+		/* heightMin */ -64.0f,
+		heightSize);
+
+	bool success = true;
+	success = testQuantizeRoundTrip(&encoding) && success;
+	success = testQuantizeOutOfRange(&encoding) && success;
+	success = testDeltaWalk(&encoding) && success;
+	success = testDecodeMalformed(&encoding) && success;
+
+	if(!success) {
+		return EXIT_FAILURE;
+	}
+
+	printf("All position encoding checks passed.\n");
+	return EXIT_SUCCESS;
+}
+
+static bool testQuantizeRoundTrip(const ShovelerWorkerPositionEncoding *encoding)
+{
+	float tolerance = chunkSize / 65536.0f;
+	for(float x = -100.0f; x < 100.0f; x += 0.37f) {
+		for(float y = -99.99f; y < 100.0f; y += 3.1f) {
+			ShovelerVector3 coordinates = shovelerVector3(x, y, x * 0.25f);
+
+			uint64_t quantized;
+			if(!shovelerWorkerPositionEncodingQuantize(encoding, coordinates, &quantized)) {
+				fprintf(stderr, "failed to quantize (%f, %f, %f)\n", coordinates.values[0], coordinates.values[1], coordinates.values[2]);
+				return false;
+			}
+
+			ShovelerVector3 dequantized = shovelerWorkerPositionEncodingDequantize(encoding, quantized);
+			if(!isClose(coordinates, dequantized, tolerance)) {
+				fprintf(
+					stderr,
+					"(%f, %f, %f) dequantized to (%f, %f, %f)\n",
+					coordinates.values[0],
+					coordinates.values[1],
+					coordinates.values[2],
+					dequantized.values[0],
+					dequantized.values[1],
+					dequantized.values[2]);
+				return false;
+			}
+
+			uint64_t requantized;
+			if(!shovelerWorkerPositionEncodingQuantize(encoding, dequantized, &requantized) || requantized != quantized) {
+				fprintf(stderr, "(%f, %f, %f) didn't quantize back to the same value\n", dequantized.values[0], dequantized.values[1], dequantized.values[2]);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static bool testQuantizeOutOfRange(const ShovelerWorkerPositionEncoding *encoding)
+{
+	ShovelerVector3 outside[] = {
+		shovelerVector3(-100.01f, 0.0f, 0.0f),
+		shovelerVector3(100.0f, 0.0f, 0.0f),
+		shovelerVector3(0.0f, -150.0f, 0.0f),
+		shovelerVector3(0.0f, 100.5f, 0.0f),
+		shovelerVector3(0.0f, 0.0f, -64.5f),
+		shovelerVector3(0.0f, 0.0f, 64.0f),
+		shovelerVector3(NAN, 0.0f, 0.0f),
+	};
+
+	for(int i = 0; i < (int) (sizeof(outside) / sizeof(outside[0])); i++) {
+		uint64_t quantized;
+		if(shovelerWorkerPositionEncodingQuantize(encoding, outside[i], &quantized)) {
+			fprintf(stderr, "(%f, %f, %f) outside of the world was quantized\n", outside[i].values[0], outside[i].values[1], outside[i].values[2]);
+			return false;
+		}
+
+		ShovelerWorkerPositionStream stream = {false, 0};
+		bool newOrigin;
+		unsigned char delta[SHOVELER_WORKER_POSITION_ENCODING_MAX_DELTA_LENGTH];
+		if(shovelerWorkerPositionEncodingEncode(encoding, &stream, outside[i], &newOrigin, delta) != -1) {
+			fprintf(stderr, "(%f, %f, %f) outside of the world was encoded\n", outside[i].values[0], outside[i].values[1], outside[i].values[2]);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool testDeltaWalk(const ShovelerWorkerPositionEncoding *encoding)
+{
+	ShovelerWorkerPositionStream encoderStream = {false, 0};
+	ShovelerWorkerPositionStream decoderStream = {false, 0};
+
+	int numOrigins = 0;
+	int totalLength = 0;
+	int numPositions = 0;
+	float tolerance = chunkSize / 65536.0f;
+
+	// walk diagonally across several chunk borders at a bot's pace, one position per 30Hz tick
+	ShovelerVector3 coordinates = shovelerVector3(-31.0f, 12.0f, 5.0f);
+	for(int tick = 0; tick < 900; tick++) {
+		coordinates.values[0] += 0.05f;
+		coordinates.values[1] -= 0.03f;
+
+		bool newOrigin;
+		unsigned char delta[SHOVELER_WORKER_POSITION_ENCODING_MAX_DELTA_LENGTH];
+		int length = shovelerWorkerPositionEncodingEncode(encoding, &encoderStream, coordinates, &newOrigin, delta);
+		if(length < 0 || length > SHOVELER_WORKER_POSITION_ENCODING_MAX_DELTA_LENGTH) {
+			fprintf(stderr, "tick %d: encoding (%f, %f, %f) returned length %d\n", tick, coordinates.values[0], coordinates.values[1], coordinates.values[2], length);
+			return false;
+		}
+
+		if(tick == 0 && !newOrigin) {
+			fprintf(stderr, "the first encoded position didn't start a new origin\n");
+			return false;
+		}
+
+		if(newOrigin) {
+			decoderStream.hasOrigin = true;
+			decoderStream.origin = encoderStream.origin;
+			numOrigins++;
+		}
+
+		ShovelerVector3 decoded;
+		if(!shovelerWorkerPositionEncodingDecode(encoding, &decoderStream, delta, length, &decoded)) {
+			fprintf(stderr, "tick %d: failed to decode delta of length %d\n", tick, length);
+			return false;
+		}
+
+		if(!isClose(coordinates, decoded, tolerance)) {
+			fprintf(
+				stderr,
+				"tick %d: (%f, %f, %f) decoded to (%f, %f, %f)\n",
+				tick,
+				coordinates.values[0],
+				coordinates.values[1],
+				coordinates.values[2],
+				decoded.values[0],
+				decoded.values[1],
+				decoded.values[2]);
+			return false;
+		}
+
+		totalLength += length;
+		numPositions++;
+	}
+
+	// 45 units in x at 2^16 cells per 10 units and at most 8191 cells per delta
+	if(numOrigins < 36 || numOrigins > 40) {
+		fprintf(stderr, "expected the walk to move the origin 36 to 40 times, but it did %d times\n", numOrigins);
+		return false;
+	}
+
+	printf(
+		"delta walk: %d positions with %d origins, %.2f delta bytes on average\n",
+		numPositions,
+		numOrigins,
+		(double) totalLength / numPositions);
+	return true;
+}
+
+static bool testDecodeMalformed(const ShovelerWorkerPositionEncoding *encoding)
+{
+	ShovelerVector3 decoded;
+	ShovelerWorkerPositionStream stream = {false, 0};
+	unsigned char zeros[3] = {0, 0, 0};
+	if(shovelerWorkerPositionEncodingDecode(encoding, &stream, zeros, 3, &decoded)) {
+		fprintf(stderr, "decoded a delta without an origin\n");
+		return false;
+	}
+
+	if(!shovelerWorkerPositionEncodingQuantize(encoding, shovelerVector3(99.99f, 0.0f, 0.0f), &stream.origin)) {
+		fprintf(stderr, "failed to quantize origin\n");
+		return false;
+	}
+	stream.hasOrigin = true;
+
+	unsigned char truncated[2] = {0, 0x80};
+	if(shovelerWorkerPositionEncodingDecode(encoding, &stream, truncated, 2, &decoded)) {
+		fprintf(stderr, "decoded a truncated delta\n");
+		return false;
+	}
+
+	unsigned char trailing[4] = {0, 0, 0, 0};
+	if(shovelerWorkerPositionEncodingDecode(encoding, &stream, trailing, 4, &decoded)) {
+		fprintf(stderr, "decoded a delta with trailing bytes\n");
+		return false;
+	}
+
+	// zigzag 0x3ffe is +8191 cells, which leaves the last chunk column
+	unsigned char outside[4] = {0xfe, 0x7f, 0, 0};
+	if(shovelerWorkerPositionEncodingDecode(encoding, &stream, outside, 4, &decoded)) {
+		fprintf(stderr, "decoded a delta leaving the world\n");
+		return false;
+	}
+
+	return true;
+}
+
+static bool isClose(ShovelerVector3 a, ShovelerVector3 b, float tolerance)
+{
+	for(int i = 0; i < 3; i++) {
+		// the height has coarser cells than the chunked coordinates
+		float axisTolerance = i == 2 ? tolerance * heightSize / chunkSize : tolerance;
+		if(fabsf(a.values[i] - b.values[i]) > axisTolerance) {
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,113 @@
+#include "shoveler/position_publisher.h"
+
+static bool publish(ShovelerWorkerPositionPublisher *publisher, ShovelerVector3 position, ShovelerVector3 velocity, int64_t now);
+static bool positionEquals(ShovelerVector3 a, ShovelerVector3 b);
+static float distanceSquared(ShovelerVector3 a, ShovelerVector3 b);
+
+ShovelerWorkerPositionPublisherSettings shovelerWorkerPositionPublisherDefaultSettings()
+{
+	ShovelerWorkerPositionPublisherSettings settings;
+	settings.minIntervalUs = 1000 * 1000 / 30;
+	settings.minDistance = 0.01f;
+	settings.extrapolationTolerance = 0.05f;
+	settings.maxExtrapolationUs = 250 * 1000;
+	return settings;
+}
+
+void shovelerWorkerPositionPublisherInit(ShovelerWorkerPositionPublisher *publisher, ShovelerWorkerPositionPublisherSettings settings, ShovelerWorkerPositionPublishFunction *publish, void *userData)
+{
+	publisher->settings = settings;
+	publisher->publish = publish;
+	publisher->userData = userData;
+	publisher->numUpdates = 0;
+	publisher->numPublished = 0;
+	shovelerWorkerPositionPublisherReset(publisher);
+}
+
+bool shovelerWorkerPositionPublisherUpdate(ShovelerWorkerPositionPublisher *publisher, ShovelerVector3 position, int64_t now)
+{
+	ShovelerWorkerPositionPublisherSettings *settings = &publisher->settings;
+	publisher->numUpdates++;
+
+	bool moving = false;
+	ShovelerVector3 velocity = shovelerVector3(0.0f, 0.0f, 0.0f);
+	if(publisher->hasPosition && !positionEquals(position, publisher->position)) {
+		moving = true;
+
+		int64_t dtUs = now - publisher->time;
+		if(dtUs > 0) {
+			velocity = shovelerVector3LinearCombination(1000000.0f / dtUs, position, -1000000.0f / dtUs, publisher->position);
+		}
+	}
+
+	publisher->hasPosition = true;
+	publisher->position = position;
+	publisher->time = now;
+
+	if(!publisher->hasPublished) {
+		return publish(publisher, position, velocity, now);
+	}
+
+	if(!moving && positionEquals(position, publisher->publishedPosition)) {
+		// resting where we last published, so there is nothing left to extrapolate
+		publisher->publishedVelocity = velocity;
+		return false;
+	}
+
+	int64_t sincePublishedUs = now - publisher->publishedTime;
+	if(sincePublishedUs < settings->minIntervalUs) {
+		return false;
+	}
+
+	if(!moving) {
+		// we stopped, so make sure the final resting position is the last one published
+		return publish(publisher, position, velocity, now);
+	}
+
+	if(distanceSquared(position, publisher->publishedPosition) < settings->minDistance * settings->minDistance) {
+		return false;
+	}
+
+	if(settings->extrapolationTolerance > 0.0f && sincePublishedUs < settings->maxExtrapolationUs) {
+		ShovelerVector3 extrapolatedPosition = shovelerVector3LinearCombination(1.0f, publisher->publishedPosition, 0.000001f * sincePublishedUs, publisher->publishedVelocity);
+		if(distanceSquared(position, extrapolatedPosition) <= settings->extrapolationTolerance * settings->extrapolationTolerance) {
+			return false;
+		}
+	}
+
+	return publish(publisher, position, velocity, now);
+}
+
+void shovelerWorkerPositionPublisherReset(ShovelerWorkerPositionPublisher *publisher)
+{
+	publisher->hasPosition = false;
+	publisher->position = shovelerVector3(0.0f, 0.0f, 0.0f);
+	publisher->time = 0;
+	publisher->hasPublished = false;
+	publisher->publishedPosition = shovelerVector3(0.0f, 0.0f, 0.0f);
+	publisher->publishedVelocity = shovelerVector3(0.0f, 0.0f, 0.0f);
+	publisher->publishedTime = 0;
+}
+
+static bool publish(ShovelerWorkerPositionPublisher *publisher, ShovelerVector3 position, ShovelerVector3 velocity, int64_t now)
+{
+	publisher->hasPublished = true;
+	publisher->publishedPosition = position;
+	publisher->publishedVelocity = velocity;
+	publisher->publishedTime = now;
+	publisher->numPublished++;
+
+	publisher->publish(position, publisher->userData);
+	return true;
+}
+
+static bool positionEquals(ShovelerVector3 a, ShovelerVector3 b)
+{
+	return a.values[0] == b.values[0] && a.values[1] == b.values[1] && a.values[2] == b.values[2];
+}
+
+static float distanceSquared(ShovelerVector3 a, ShovelerVector3 b)
+{
+	ShovelerVector3 difference = shovelerVector3LinearCombination(1.0f, a, -1.0f, b);
+	return shovelerVector3Dot(difference, difference);
+}
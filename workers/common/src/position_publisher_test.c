@@ -0,0 +1,239 @@
+/**
+ * Drives position publishers along scripted movement paths and checks how many of the per tick
+ * positions they let through, that the final resting position is always published, and that the
+ * rate limit is respected.
+ *
+ * Usage: position_publisher_test
+ */
+#include <inttypes.h> // PRId64
+#include <stdbool.h> // bool
+#include <stdint.h> // int64_t uint32_t
+#include <stdio.h> // fprintf printf
+#include <stdlib.h> // EXIT_FAILURE EXIT_SUCCESS
+
+#include <shoveler/position_publisher.h>
+#include <shoveler/types.h>
+
+typedef enum {
+	kUp,
+	kDown,
+	kLeft,
+	kRight,
+	kStop,
+} Direction;
+
+typedef struct {
+	const char *name;
+	int tickRateHz;
+	int numTicks;
+	Direction (*getDirection)(int tick, uint32_t *randomState);
+	/* minimum factor by which the publisher must reduce the number of sent updates */
+	double minReduction;
+} Path;
+
+typedef struct {
+	ShovelerVector3 position;
+	int64_t time;
+	int64_t lastReceiveTime;
+	int64_t minIntervalUs;
+	int numPublished;
+	bool rateViolated;
+} Receiver;
+
+static bool runPath(const Path *path, const char *publisherName, ShovelerWorkerPositionPublisherSettings settings);
+static Direction straightThenStop(int tick, uint32_t *randomState);
+static Direction square(int tick, uint32_t *randomState);
+static Direction stopAndGo(int tick, uint32_t *randomState);
+static Direction randomWalk(int tick, uint32_t *randomState);
+static void receive(ShovelerVector3 position, void *receiverPointer);
+static uint32_t nextRandom(uint32_t *state);
+
+static const float velocity = 1.5f;
+
+int main(int argc, char **argv)
+{
+	if(argc != 1) {
+		fprintf(stderr, "Usage:\n\t%s\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	ShovelerWorkerPositionPublisherSettings positionSettings = shovelerWorkerPositionPublisherDefaultSettings();
+
+	ShovelerWorkerPositionPublisherSettings improbablePositionSettings = shovelerWorkerPositionPublisherDefaultSettings();
+	improbablePositionSettings.minDistance = 1.0f;
+	improbablePositionSettings.extrapolationTolerance = 0.0f;
+
+	Path paths[] = {
+		{"straight line then stop", 30, 180, straightThenStop, 8.0},
+		{"square", 30, 240, square, 6.0},
+		{"stop and go", 30, 240, stopAndGo, 6.0},
+		{"random walk", 30, 900, randomWalk, 6.0},
+		{"random walk at 60Hz", 60, 1800, randomWalk, 10.0},
+	};
+	int numPaths = sizeof(paths) / sizeof(paths[0]);
+
+	bool success = true;
+	for(int i = 0; i < numPaths; i++) {
+		success = runPath(&paths[i], "position", positionSettings) && success;
+
+		Path improbablePositionPath = paths[i];
+		improbablePositionPath.minReduction = 15.0;
+		success = runPath(&improbablePositionPath, "Improbable position", improbablePositionSettings) && success;
+	}
+
+	if(!success) {
+		return EXIT_FAILURE;
+	}
+
+	printf("All position publisher paths passed.\n");
+	return EXIT_SUCCESS;
+}
+
+static bool runPath(const Path *path, const char *publisherName, ShovelerWorkerPositionPublisherSettings settings)
+{
+	Receiver receiver;
+	receiver.position = shovelerVector3(0.0f, 0.0f, 0.0f);
+	receiver.time = 0;
+	receiver.lastReceiveTime = 0;
+	receiver.minIntervalUs = settings.minIntervalUs;
+	receiver.numPublished = 0;
+	receiver.rateViolated = false;
+
+	ShovelerWorkerPositionPublisher publisher;
+	shovelerWorkerPositionPublisherInit(&publisher, settings, receive, &receiver);
+
+	uint32_t randomState = 42;
+	int64_t tickUs = 1000 * 1000 / path->tickRateHz;
+	float step = velocity / path->tickRateHz;
+	ShovelerVector3 position = shovelerVector3(3.0f, 7.0f, 0.0f);
+	for(int tick = 0; tick < path->numTicks; tick++) {
+		switch(path->getDirection(tick, &randomState)) {
+			case kUp:
+				position.values[1] += step;
+				break;
+			case kDown:
+				position.values[1] -= step;
+				break;
+			case kLeft:
+				position.values[0] -= step;
+				break;
+			case kRight:
+				position.values[0] += step;
+				break;
+			case kStop:
+				break;
+		}
+
+		receiver.time = tick * tickUs;
+		shovelerWorkerPositionPublisherUpdate(&publisher, position, receiver.time);
+	}
+
+	// come to rest for a second to give the final update time to go out
+	for(int tick = path->numTicks; tick < path->numTicks + path->tickRateHz; tick++) {
+		receiver.time = tick * tickUs;
+		shovelerWorkerPositionPublisherUpdate(&publisher, position, receiver.time);
+	}
+
+	double reduction = (double) publisher.numUpdates / publisher.numPublished;
+	printf(
+		"%s %s: published %d of %d positions (%.1fx fewer)\n",
+		path->name,
+		publisherName,
+		publisher.numPublished,
+		publisher.numUpdates,
+		reduction);
+
+	bool success = true;
+	if(publisher.numPublished != receiver.numPublished) {
+		fprintf(stderr, "%s %s: publisher counted %d positions but %d were received\n", path->name, publisherName, publisher.numPublished, receiver.numPublished);
+		success = false;
+	}
+
+	if(reduction < path->minReduction) {
+		fprintf(stderr, "%s %s: expected at least %.1fx fewer positions\n", path->name, publisherName, path->minReduction);
+		success = false;
+	}
+
+	if(receiver.rateViolated) {
+		fprintf(stderr, "%s %s: positions were published more often than every %"PRId64"us\n", path->name, publisherName, settings.minIntervalUs);
+		success = false;
+	}
+
+	if(receiver.position.values[0] != position.values[0] || receiver.position.values[1] != position.values[1] || receiver.position.values[2] != position.values[2]) {
+		fprintf(
+			stderr,
+			"%s %s: final position (%.3f, %.3f, %.3f) wasn't published, last received (%.3f, %.3f, %.3f)\n",
+			path->name,
+			publisherName,
+			position.values[0],
+			position.values[1],
+			position.values[2],
+			receiver.position.values[0],
+			receiver.position.values[1],
+			receiver.position.values[2]);
+		success = false;
+	}
+
+	return success;
+}
+
+static Direction straightThenStop(int tick, uint32_t *randomState)
+{
+	return tick < 150 ? kRight : kStop;
+}
+
+static Direction square(int tick, uint32_t *randomState)
+{
+	return (Direction) ((tick / 60) % 4);
+}
+
+static Direction stopAndGo(int tick, uint32_t *randomState)
+{
+	// walk for half a second, then stand still for a fifth of a second
+	return tick % 21 < 15 ? kUp : kStop;
+}
+
+static Direction randomWalk(int tick, uint32_t *randomState)
+{
+	// like the bots: keep walking straight, occasionally turning and running into obstacles
+	static Direction direction = kUp;
+	static int blockedTicks = 0;
+
+	if(tick == 0) {
+		direction = kUp;
+		blockedTicks = 0;
+	}
+
+	if(blockedTicks > 0) {
+		blockedTicks--;
+		return kStop;
+	}
+
+	uint32_t random = nextRandom(randomState) % 1000;
+	if(random < 30) {
+		direction = (Direction) ((direction + 1 + random % 3) % 4);
+	} else if(random < 35) {
+		blockedTicks = 5 + random % 20;
+		return kStop;
+	}
+
+	return direction;
+}
+
+static void receive(ShovelerVector3 position, void *receiverPointer)
+{
+	Receiver *receiver = (Receiver *) receiverPointer;
+	if(receiver->numPublished > 0 && receiver->time - receiver->lastReceiveTime < receiver->minIntervalUs) {
+		receiver->rateViolated = true;
+	}
+
+	receiver->position = position;
+	receiver->numPublished++;
+	receiver->lastReceiveTime = receiver->time;
+}
+
+static uint32_t nextRandom(uint32_t *state)
+{
+	*state = *state * 1664525u + 1013904223u;
+	return *state >> 8;
+}
@@ -0,0 +1,537 @@
+/**
+ * Stand-in for the Worker_Connection_* calls of the SpatialOS C worker SDK, linked into a worker
+ * with -Wl,--wrap for every function below so that the worker's own code stays untouched.
+ *
+ * If SHOVELER_WORKER_REPLAY_FILE is set, no connection is made at all. Instead, the recorded op
+ * lists are handed out one per Worker_Connection_GetOpList call without waiting, followed by a
+ * disconnect op once the recording is exhausted. Send calls return the request IDs of the recorded
+ * run, and are written to SHOVELER_WORKER_REPLAY_OUTPUT_FILE if set so that runs can be compared.
+ * Recorded worker flags can be overridden with SHOVELER_WORKER_REPLAY_FLAGS, a comma separated list
+ * of name=value pairs, to replay the same ops against a differently configured worker.
+ *
+ * Otherwise, if SHOVELER_WORKER_RECORD_FILE is set, all calls are forwarded to the real SDK and
+ * everything received and sent is recorded to that file.
+ */
+#include <assert.h> // assert
+#include <stdlib.h> // getenv malloc free
+#include <string.h> // strchr strcmp strlen strncmp
+
+#include <glib.h>
+#include <improbable/c_schema.h>
+#include <improbable/c_worker.h>
+#include <shoveler/log.h>
+#include <shoveler/op_recording.h>
+
+typedef struct {
+	ShovelerWorkerRecording *recording;
+	ShovelerWorkerOpRecorder *outputRecorder;
+	Worker_EntityId workerEntityId;
+	guint nextRecordIndex;
+	/* per record type, index of the first recorded send that wasn't replayed yet */
+	guint nextSendRecordIndices[SHOVELER_WORKER_RECORD_TYPE_NUM_TYPES];
+	Worker_RequestId nextUnrecordedRequestId;
+	bool finished;
+	int numOpLists;
+	int numOps;
+	int64_t startTime;
+} ReplayConnection;
+
+typedef struct {
+	const char *name;
+	void *userData;
+	Worker_GetWorkerFlagCallback *callback;
+} RecordedWorkerFlag;
+
+Worker_ConnectionFuture *__real_Worker_ConnectAsync(const char *hostname, uint16_t port, const char *worker_id, const Worker_ConnectionParameters *params);
+Worker_Connection *__real_Worker_ConnectionFuture_Get(Worker_ConnectionFuture *future, const uint32_t *timeout_millis);
+void __real_Worker_ConnectionFuture_Destroy(Worker_ConnectionFuture *future);
+void __real_Worker_Connection_Destroy(Worker_Connection *connection);
+uint8_t __real_Worker_Connection_GetConnectionStatusCode(const Worker_Connection *connection);
+const char *__real_Worker_Connection_GetConnectionStatusDetailString(const Worker_Connection *connection);
+Worker_EntityId __real_Worker_Connection_GetWorkerEntityId(const Worker_Connection *connection);
+void __real_Worker_Connection_GetWorkerFlag(Worker_Connection *connection, const char *name, void *user_data, Worker_GetWorkerFlagCallback *callback);
+Worker_OpList *__real_Worker_Connection_GetOpList(Worker_Connection *connection, uint32_t timeout_millis);
+void __real_Worker_OpList_Destroy(Worker_OpList *op_list);
+void __real_Worker_Connection_SendMetrics(Worker_Connection *connection, const Worker_Metrics *metrics);
+int8_t __real_Worker_Connection_SendComponentUpdate(Worker_Connection *connection, Worker_EntityId entity_id, Worker_ComponentUpdate *component_update);
+Worker_RequestId __real_Worker_Connection_SendCommandRequest(Worker_Connection *connection, Worker_EntityId entity_id, Worker_CommandRequest *request, const uint32_t *timeout_millis);
+int8_t __real_Worker_Connection_SendCommandResponse(Worker_Connection *connection, Worker_RequestId request_id, Worker_CommandResponse *response);
+int8_t __real_Worker_Connection_SendCommandFailure(Worker_Connection *connection, Worker_RequestId request_id, const char *message);
+Worker_RequestId __real_Worker_Connection_SendCreateEntityRequest(Worker_Connection *connection, uint32_t component_count, Worker_ComponentData *components, const Worker_EntityId *entity_id, const uint32_t *timeout_millis);
+Worker_RequestId __real_Worker_Connection_SendDeleteEntityRequest(Worker_Connection *connection, Worker_EntityId entity_id, const uint32_t *timeout_millis);
+Worker_RequestId __real_Worker_Connection_SendReserveEntityIdsRequest(Worker_Connection *connection, uint32_t number_of_entity_ids, const uint32_t *timeout_millis);
+
+static bool isReplay(const Worker_Connection *connection);
+static Worker_OpList *createDisconnectOpList(void);
+static int64_t replaySend(ShovelerWorkerRecordType type, int64_t unrecordedResult);
+static void recordWorkerFlag(void *recordedWorkerFlagPointer, const char *value);
+static bool lookupWorkerFlagOverride(const char *name, GString *outputValue);
+
+static ReplayConnection *replayConnection = NULL;
+static ShovelerWorkerOpRecorder *recorder = NULL;
+static Worker_OpList *disconnectOpList = NULL;
+
+Worker_ConnectionFuture *__wrap_Worker_ConnectAsync(const char *hostname, uint16_t port, const char *worker_id, const Worker_ConnectionParameters *params)
+{
+	const char *replayFilename = getenv("SHOVELER_WORKER_REPLAY_FILE");
+	if(replayFilename == NULL) {
+		const char *recordFilename = getenv("SHOVELER_WORKER_RECORD_FILE");
+		if(recordFilename != NULL) {
+			recorder = shovelerWorkerOpRecorderCreate(recordFilename);
+		}
+
+		return __real_Worker_ConnectAsync(hostname, port, worker_id, params);
+	}
+
+	ShovelerWorkerRecording *recording = shovelerWorkerRecordingRead(replayFilename);
+	if(recording == NULL) {
+		return NULL;
+	}
+
+	replayConnection = malloc(sizeof(ReplayConnection));
+	replayConnection->recording = recording;
+	replayConnection->outputRecorder = NULL;
+	replayConnection->workerEntityId = 0;
+	replayConnection->nextRecordIndex = 0;
+	for(int i = 0; i < SHOVELER_WORKER_RECORD_TYPE_NUM_TYPES; i++) {
+		replayConnection->nextSendRecordIndices[i] = 0;
+	}
+	replayConnection->nextUnrecordedRequestId = 1;
+	replayConnection->finished = false;
+	replayConnection->numOpLists = 0;
+	replayConnection->numOps = 0;
+	replayConnection->startTime = g_get_monotonic_time();
+
+	for(guint i = 0; i < recording->records->len; i++) {
+		const ShovelerWorkerRecord *record = &g_array_index(recording->records, ShovelerWorkerRecord, i);
+		if(shovelerWorkerRecordDecodeConnect(record, &replayConnection->workerEntityId)) {
+			break;
+		}
+	}
+
+	for(guint i = 0; i < recording->records->len; i++) {
+		const ShovelerWorkerRecord *record = &g_array_index(recording->records, ShovelerWorkerRecord, i);
+		if(shovelerWorkerRecordIsSend(record) && record->sendResult >= replayConnection->nextUnrecordedRequestId) {
+			replayConnection->nextUnrecordedRequestId = record->sendResult + 1;
+		}
+	}
+
+	const char *outputFilename = getenv("SHOVELER_WORKER_REPLAY_OUTPUT_FILE");
+	if(outputFilename != NULL) {
+		replayConnection->outputRecorder = shovelerWorkerOpRecorderCreate(outputFilename);
+	}
+
+	shovelerLogInfo("Replaying worker connection from '%s' instead of connecting to %s:%u.", replayFilename, hostname, port);
+	return (Worker_ConnectionFuture *) replayConnection;
+}
+
+Worker_Connection *__wrap_Worker_ConnectionFuture_Get(Worker_ConnectionFuture *future, const uint32_t *timeout_millis)
+{
+	if(replayConnection != NULL && future == (Worker_ConnectionFuture *) replayConnection) {
+		if(replayConnection->outputRecorder != NULL) {
+			shovelerWorkerOpRecorderWriteConnect(replayConnection->outputRecorder, replayConnection->workerEntityId);
+		}
+
+		return (Worker_Connection *) replayConnection;
+	}
+
+	Worker_Connection *connection = __real_Worker_ConnectionFuture_Get(future, timeout_millis);
+	if(recorder != NULL && connection != NULL) {
+		shovelerWorkerOpRecorderWriteConnect(recorder, __real_Worker_Connection_GetWorkerEntityId(connection));
+	}
+
+	return connection;
+}
+
+void __wrap_Worker_ConnectionFuture_Destroy(Worker_ConnectionFuture *future)
+{
+	if(replayConnection != NULL && future == (Worker_ConnectionFuture *) replayConnection) {
+		return;
+	}
+
+	__real_Worker_ConnectionFuture_Destroy(future);
+}
+
+void __wrap_Worker_Connection_Destroy(Worker_Connection *connection)
+{
+	if(!isReplay(connection)) {
+		__real_Worker_Connection_Destroy(connection);
+		shovelerWorkerOpRecorderFree(recorder);
+		recorder = NULL;
+		return;
+	}
+
+	double elapsedSeconds = (double) (g_get_monotonic_time() - replayConnection->startTime) / 1000000.0;
+	shovelerLogInfo(
+		"Replayed %d op lists with %d ops in %.3fs (%.0f ops/s).",
+		replayConnection->numOpLists,
+		replayConnection->numOps,
+		elapsedSeconds,
+		elapsedSeconds > 0.0 ? (double) replayConnection->numOps / elapsedSeconds : 0.0);
+
+	shovelerWorkerOpRecorderFree(replayConnection->outputRecorder);
+	shovelerWorkerRecordingFree(replayConnection->recording);
+	free(replayConnection);
+	replayConnection = NULL;
+}
+
+uint8_t __wrap_Worker_Connection_GetConnectionStatusCode(const Worker_Connection *connection)
+{
+	if(isReplay(connection)) {
+		return WORKER_CONNECTION_STATUS_CODE_SUCCESS;
+	}
+
+	return __real_Worker_Connection_GetConnectionStatusCode(connection);
+}
+
+const char *__wrap_Worker_Connection_GetConnectionStatusDetailString(const Worker_Connection *connection)
+{
+	if(isReplay(connection)) {
+		return "replaying recorded connection";
+	}
+
+	return __real_Worker_Connection_GetConnectionStatusDetailString(connection);
+}
+
+Worker_EntityId __wrap_Worker_Connection_GetWorkerEntityId(const Worker_Connection *connection)
+{
+	if(isReplay(connection)) {
+		return replayConnection->workerEntityId;
+	}
+
+	return __real_Worker_Connection_GetWorkerEntityId(connection);
+}
+
+void __wrap_Worker_Connection_GetWorkerFlag(Worker_Connection *connection, const char *name, void *user_data, Worker_GetWorkerFlagCallback *callback)
+{
+	if(!isReplay(connection)) {
+		if(recorder == NULL) {
+			__real_Worker_Connection_GetWorkerFlag(connection, name, user_data, callback);
+			return;
+		}
+
+		RecordedWorkerFlag recordedWorkerFlag = {name, user_data, callback};
+		__real_Worker_Connection_GetWorkerFlag(connection, name, &recordedWorkerFlag, recordWorkerFlag);
+		return;
+	}
+
+	const char *value = NULL;
+	GString *overrideValue = g_string_new("");
+	if(lookupWorkerFlagOverride(name, overrideValue)) {
+		value = overrideValue->str;
+	} else {
+		const ShovelerWorkerRecording *recording = replayConnection->recording;
+		for(guint i = 0; i < recording->records->len; i++) {
+			const ShovelerWorkerRecord *record = &g_array_index(recording->records, ShovelerWorkerRecord, i);
+
+			const char *recordedName;
+			const char *recordedValue;
+			if(shovelerWorkerRecordDecodeWorkerFlag(record, &recordedName, &recordedValue) && strcmp(recordedName, name) == 0) {
+				value = recordedValue;
+				break;
+			}
+		}
+	}
+
+	if(replayConnection->outputRecorder != NULL) {
+		shovelerWorkerOpRecorderWriteWorkerFlag(replayConnection->outputRecorder, name, value);
+	}
+
+	callback(user_data, value);
+	g_string_free(overrideValue, true);
+}
+
+Worker_OpList *__wrap_Worker_Connection_GetOpList(Worker_Connection *connection, uint32_t timeout_millis)
+{
+	if(!isReplay(connection)) {
+		Worker_OpList *opList = __real_Worker_Connection_GetOpList(connection, timeout_millis);
+		if(recorder != NULL) {
+			shovelerWorkerOpRecorderWriteOpList(recorder, opList);
+		}
+
+		return opList;
+	}
+
+	// hand out recorded op lists back to back, ignoring the timeout
+	const ShovelerWorkerRecording *recording = replayConnection->recording;
+	while(replayConnection->nextRecordIndex < recording->records->len) {
+		const ShovelerWorkerRecord *record = &g_array_index(recording->records, ShovelerWorkerRecord, replayConnection->nextRecordIndex);
+		replayConnection->nextRecordIndex++;
+
+		Worker_OpList *opList = shovelerWorkerRecordDecodeOpList(record);
+		if(opList != NULL) {
+			replayConnection->numOpLists++;
+			replayConnection->numOps += opList->op_count;
+			return opList;
+		}
+	}
+
+	if(!replayConnection->finished) {
+		replayConnection->finished = true;
+		shovelerLogInfo("Reached end of op recording, disconnecting.");
+		return createDisconnectOpList();
+	}
+
+	Worker_OpList *opList = malloc(sizeof(Worker_OpList));
+	opList->ops = NULL;
+	opList->op_count = 0;
+	return opList;
+}
+
+void __wrap_Worker_OpList_Destroy(Worker_OpList *op_list)
+{
+	if(replayConnection == NULL) {
+		__real_Worker_OpList_Destroy(op_list);
+		return;
+	}
+
+	if(op_list == disconnectOpList) {
+		free(op_list->ops);
+		free(op_list);
+		disconnectOpList = NULL;
+		return;
+	}
+
+	shovelerWorkerRecordFreeOpList(op_list);
+}
+
+void __wrap_Worker_Connection_SendMetrics(Worker_Connection *connection, const Worker_Metrics *metrics)
+{
+	if(!isReplay(connection)) {
+		__real_Worker_Connection_SendMetrics(connection, metrics);
+	}
+}
+
+int8_t __wrap_Worker_Connection_SendComponentUpdate(Worker_Connection *connection, Worker_EntityId entity_id, Worker_ComponentUpdate *component_update)
+{
+	if(!isReplay(connection)) {
+		if(recorder != NULL) {
+			// the SDK takes ownership of the update, so record it before sending
+			shovelerWorkerOpRecorderWriteSendComponentUpdate(recorder, WORKER_RESULT_SUCCESS, entity_id, component_update);
+		}
+
+		return __real_Worker_Connection_SendComponentUpdate(connection, entity_id, component_update);
+	}
+
+	int8_t result = (int8_t) replaySend(SHOVELER_WORKER_RECORD_TYPE_SEND_COMPONENT_UPDATE, WORKER_RESULT_SUCCESS);
+	if(replayConnection->outputRecorder != NULL) {
+		shovelerWorkerOpRecorderWriteSendComponentUpdate(replayConnection->outputRecorder, result, entity_id, component_update);
+	}
+
+	Schema_DestroyComponentUpdate(component_update->schema_type);
+	return result;
+}
+
+Worker_RequestId __wrap_Worker_Connection_SendCommandRequest(Worker_Connection *connection, Worker_EntityId entity_id, Worker_CommandRequest *request, const uint32_t *timeout_millis)
+{
+	if(!isReplay(connection)) {
+		if(recorder == NULL) {
+			return __real_Worker_Connection_SendCommandRequest(connection, entity_id, request, timeout_millis);
+		}
+
+		// the SDK takes ownership of the request, so keep a copy to record once the request ID is known
+		Schema_CommandRequest *requestCopy = Schema_CopyCommandRequest(request->schema_type);
+		Worker_RequestId requestId = __real_Worker_Connection_SendCommandRequest(connection, entity_id, request, timeout_millis);
+
+		Worker_CommandRequest recordedRequest = *request;
+		recordedRequest.schema_type = requestCopy;
+		shovelerWorkerOpRecorderWriteSendCommandRequest(recorder, requestId, entity_id, &recordedRequest);
+		Schema_DestroyCommandRequest(requestCopy);
+		return requestId;
+	}
+
+	Worker_RequestId requestId = replaySend(SHOVELER_WORKER_RECORD_TYPE_SEND_COMMAND_REQUEST, replayConnection->nextUnrecordedRequestId);
+	if(replayConnection->outputRecorder != NULL) {
+		shovelerWorkerOpRecorderWriteSendCommandRequest(replayConnection->outputRecorder, requestId, entity_id, request);
+	}
+
+	Schema_DestroyCommandRequest(request->schema_type);
+	return requestId;
+}
+
+int8_t __wrap_Worker_Connection_SendCommandResponse(Worker_Connection *connection, Worker_RequestId request_id, Worker_CommandResponse *response)
+{
+	if(!isReplay(connection)) {
+		if(recorder != NULL) {
+			shovelerWorkerOpRecorderWriteSendCommandResponse(recorder, WORKER_RESULT_SUCCESS, request_id, response);
+		}
+
+		return __real_Worker_Connection_SendCommandResponse(connection, request_id, response);
+	}
+
+	int8_t result = (int8_t) replaySend(SHOVELER_WORKER_RECORD_TYPE_SEND_COMMAND_RESPONSE, WORKER_RESULT_SUCCESS);
+	if(replayConnection->outputRecorder != NULL) {
+		shovelerWorkerOpRecorderWriteSendCommandResponse(replayConnection->outputRecorder, result, request_id, response);
+	}
+
+	Schema_DestroyCommandResponse(response->schema_type);
+	return result;
+}
+
+int8_t __wrap_Worker_Connection_SendCommandFailure(Worker_Connection *connection, Worker_RequestId request_id, const char *message)
+{
+	if(!isReplay(connection)) {
+		int8_t result = __real_Worker_Connection_SendCommandFailure(connection, request_id, message);
+		if(recorder != NULL) {
+			shovelerWorkerOpRecorderWriteSendCommandFailure(recorder, result, request_id, message);
+		}
+
+		return result;
+	}
+
+	int8_t result = (int8_t) replaySend(SHOVELER_WORKER_RECORD_TYPE_SEND_COMMAND_FAILURE, WORKER_RESULT_SUCCESS);
+	if(replayConnection->outputRecorder != NULL) {
+		shovelerWorkerOpRecorderWriteSendCommandFailure(replayConnection->outputRecorder, result, request_id, message);
+	}
+
+	return result;
+}
+
+Worker_RequestId __wrap_Worker_Connection_SendCreateEntityRequest(Worker_Connection *connection, uint32_t component_count, Worker_ComponentData *components, const Worker_EntityId *entity_id, const uint32_t *timeout_millis)
+{
+	if(!isReplay(connection)) {
+		if(recorder == NULL) {
+			return __real_Worker_Connection_SendCreateEntityRequest(connection, component_count, components, entity_id, timeout_millis);
+		}
+
+		// the SDK takes ownership of the component data, so keep copies to record once the request ID is known
+		Worker_ComponentData *recordedComponents = malloc(component_count * sizeof(Worker_ComponentData));
+		for(uint32_t i = 0; i < component_count; i++) {
+			recordedComponents[i] = components[i];
+			recordedComponents[i].schema_type = Schema_CopyComponentData(components[i].schema_type);
+		}
+
+		Worker_RequestId requestId = __real_Worker_Connection_SendCreateEntityRequest(connection, component_count, components, entity_id, timeout_millis);
+		shovelerWorkerOpRecorderWriteSendCreateEntityRequest(recorder, requestId, component_count, recordedComponents, entity_id);
+
+		for(uint32_t i = 0; i < component_count; i++) {
+			Schema_DestroyComponentData(recordedComponents[i].schema_type);
+		}
+		free(recordedComponents);
+		return requestId;
+	}
+
+	Worker_RequestId requestId = replaySend(SHOVELER_WORKER_RECORD_TYPE_SEND_CREATE_ENTITY_REQUEST, replayConnection->nextUnrecordedRequestId);
+	if(replayConnection->outputRecorder != NULL) {
+		shovelerWorkerOpRecorderWriteSendCreateEntityRequest(replayConnection->outputRecorder, requestId, component_count, components, entity_id);
+	}
+
+	for(uint32_t i = 0; i < component_count; i++) {
+		Schema_DestroyComponentData(components[i].schema_type);
+	}
+	return requestId;
+}
+
+Worker_RequestId __wrap_Worker_Connection_SendDeleteEntityRequest(Worker_Connection *connection, Worker_EntityId entity_id, const uint32_t *timeout_millis)
+{
+	if(!isReplay(connection)) {
+		Worker_RequestId requestId = __real_Worker_Connection_SendDeleteEntityRequest(connection, entity_id, timeout_millis);
+		if(recorder != NULL) {
+			shovelerWorkerOpRecorderWriteSendDeleteEntityRequest(recorder, requestId, entity_id);
+		}
+
+		return requestId;
+	}
+
+	Worker_RequestId requestId = replaySend(SHOVELER_WORKER_RECORD_TYPE_SEND_DELETE_ENTITY_REQUEST, replayConnection->nextUnrecordedRequestId);
+	if(replayConnection->outputRecorder != NULL) {
+		shovelerWorkerOpRecorderWriteSendDeleteEntityRequest(replayConnection->outputRecorder, requestId, entity_id);
+	}
+
+	return requestId;
+}
+
+Worker_RequestId __wrap_Worker_Connection_SendReserveEntityIdsRequest(Worker_Connection *connection, uint32_t number_of_entity_ids, const uint32_t *timeout_millis)
+{
+	if(!isReplay(connection)) {
+		Worker_RequestId requestId = __real_Worker_Connection_SendReserveEntityIdsRequest(connection, number_of_entity_ids, timeout_millis);
+		if(recorder != NULL) {
+			shovelerWorkerOpRecorderWriteSendReserveEntityIdsRequest(recorder, requestId, number_of_entity_ids);
+		}
+
+		return requestId;
+	}
+
+	Worker_RequestId requestId = replaySend(SHOVELER_WORKER_RECORD_TYPE_SEND_RESERVE_ENTITY_IDS_REQUEST, replayConnection->nextUnrecordedRequestId);
+	if(replayConnection->outputRecorder != NULL) {
+		shovelerWorkerOpRecorderWriteSendReserveEntityIdsRequest(replayConnection->outputRecorder, requestId, number_of_entity_ids);
+	}
+
+	return requestId;
+}
+
+static bool isReplay(const Worker_Connection *connection)
+{
+	return replayConnection != NULL && connection == (const Worker_Connection *) replayConnection;
+}
+
+static Worker_OpList *createDisconnectOpList(void)
+{
+	assert(disconnectOpList == NULL);
+
+	disconnectOpList = malloc(sizeof(Worker_OpList));
+	disconnectOpList->op_count = 1;
+	disconnectOpList->ops = calloc(1, sizeof(Worker_Op));
+	disconnectOpList->ops[0].op_type = WORKER_OP_TYPE_DISCONNECT;
+	disconnectOpList->ops[0].op.disconnect.connection_status_code = WORKER_CONNECTION_STATUS_CODE_SUCCESS;
+	disconnectOpList->ops[0].op.disconnect.reason = "end of op recording";
+
+	return disconnectOpList;
+}
+
+/** Returns the result of the next recorded send of the same type, so that request IDs line up with the recorded ops. */
+static int64_t replaySend(ShovelerWorkerRecordType type, int64_t unrecordedResult)
+{
+	const ShovelerWorkerRecording *recording = replayConnection->recording;
+	guint *nextSendRecordIndex = &replayConnection->nextSendRecordIndices[type];
+	while(*nextSendRecordIndex < recording->records->len) {
+		const ShovelerWorkerRecord *record = &g_array_index(recording->records, ShovelerWorkerRecord, *nextSendRecordIndex);
+		(*nextSendRecordIndex)++;
+
+		if(record->type == type) {
+			return record->sendResult;
+		}
+	}
+
+	if(unrecordedResult == replayConnection->nextUnrecordedRequestId) {
+		replayConnection->nextUnrecordedRequestId++;
+	}
+
+	shovelerLogWarning("Replayed worker sent more messages of record type %d than were recorded, the replay has diverged.", type);
+	return unrecordedResult;
+}
+
+static void recordWorkerFlag(void *recordedWorkerFlagPointer, const char *value)
+{
+	RecordedWorkerFlag *recordedWorkerFlag = recordedWorkerFlagPointer;
+	shovelerWorkerOpRecorderWriteWorkerFlag(recorder, recordedWorkerFlag->name, value);
+	recordedWorkerFlag->callback(recordedWorkerFlag->userData, value);
+}
+
+static bool lookupWorkerFlagOverride(const char *name, GString *outputValue)
+{
+	const char *overrides = getenv("SHOVELER_WORKER_REPLAY_FLAGS");
+	if(overrides == NULL) {
+		return false;
+	}
+
+	size_t nameLength = strlen(name);
+	const char *entry = overrides;
+	while(*entry != '\0') {
+		const char *entryEnd = strchr(entry, ',');
+		if(entryEnd == NULL) {
+			entryEnd = entry + strlen(entry);
+		}
+
+		if((size_t) (entryEnd - entry) > nameLength && strncmp(entry, name, nameLength) == 0 && entry[nameLength] == '=') {
+			const char *valueStart = entry + nameLength + 1;
+			g_string_append_len(outputValue, valueStart, entryEnd - valueStart);
+			shovelerLogInfo("Overriding replayed worker flag '%s' with '%s'.", name, outputValue->str);
+			return true;
+		}
+
+		entry = *entryEnd == ',' ? entryEnd + 1 : entryEnd;
+	}
+
+	return false;
+}
@@ -2,8 +2,9 @@
 
 #include <assert.h> // assert
 #include <stdlib.h> // NULL
-#include <string.h> // strlen
+#include <string.h> // memcpy strlen
 
+#include <shoveler/map_layout.h>
 #include <shoveler/schema/base.h>
 
 // FIXME include from component data definition instead
@@ -108,6 +109,72 @@ Worker_ComponentData shovelerWorkerSchemaCreatePositionComponent(ShovelerVector3
 	return componentData;
 }
 
+ShovelerWorkerPositionEncoding shovelerWorkerSchemaGetPositionEncoding()
+{
+	float mapWidth = (float) (shovelerWorkerMapNumChunkColumns * shovelerWorkerMapChunkSize);
+	float mapHeight = (float) (shovelerWorkerMapNumChunkRows * shovelerWorkerMapChunkSize);
+
+	return shovelerWorkerPositionEncoding(
+		shovelerVector2(-0.5f * mapWidth, -0.5f * mapHeight),
+		(float) shovelerWorkerMapChunkSize,
+		shovelerWorkerMapNumChunkColumns,
+		shovelerWorkerMapNumChunkRows,
+		(float) shovelerWorkerMapHeightMin,
+		(float) shovelerWorkerMapHeightSize);
+}
+
+void shovelerWorkerSchemaAddPositionUpdateCoordinates(Schema_ComponentUpdate* componentUpdate, ShovelerWorkerPositionStream* stream, bool quantized, ShovelerVector3 coordinates)
+{
+	Schema_Object* fields = Schema_GetComponentUpdateFields(componentUpdate);
+
+	if (quantized) {
+		ShovelerWorkerPositionEncoding encoding = shovelerWorkerSchemaGetPositionEncoding();
+
+		bool newOrigin;
+		unsigned char delta[SHOVELER_WORKER_POSITION_ENCODING_MAX_DELTA_LENGTH];
+		int deltaLength = shovelerWorkerPositionEncodingEncode(&encoding, stream, coordinates, &newOrigin, delta);
+		if (deltaLength >= 0) {
+			if (newOrigin) {
+				Schema_AddUint64(fields, shovelerWorkerSchemaPositionFieldIdQuantizedOrigin, stream->origin);
+			}
+
+			uint8_t* allocatedDelta = Schema_AllocateBuffer(fields, (uint32_t) deltaLength);
+			memcpy(allocatedDelta, delta, deltaLength);
+			Schema_AddBytes(fields, shovelerWorkerSchemaPositionFieldIdQuantizedDelta, allocatedDelta, (uint32_t) deltaLength);
+			return;
+		}
+	}
+
+	if (stream->hasOrigin) {
+		// otherwise the stale quantized coordinates would take precedence for workers checking the entity out later
+		Schema_AddComponentUpdateClearedField(componentUpdate, shovelerWorkerSchemaPositionFieldIdQuantizedOrigin);
+		Schema_AddComponentUpdateClearedField(componentUpdate, shovelerWorkerSchemaPositionFieldIdQuantizedDelta);
+		stream->hasOrigin = false;
+	}
+
+	Schema_Object* coordinatesObject = Schema_AddObject(fields, shovelerWorkerSchemaPositionFieldIdCoordinates);
+	Schema_AddFloat(coordinatesObject, shovelerWorkerSchemaVector3FieldIdX, coordinates.values[0]);
+	Schema_AddFloat(coordinatesObject, shovelerWorkerSchemaVector3FieldIdY, coordinates.values[1]);
+	Schema_AddFloat(coordinatesObject, shovelerWorkerSchemaVector3FieldIdZ, coordinates.values[2]);
+}
+
+bool shovelerWorkerSchemaGetPositionQuantizedCoordinates(Schema_Object* positionFields, ShovelerWorkerPositionStream* stream, ShovelerVector3* outputCoordinates)
+{
+	if (Schema_GetUint64Count(positionFields, shovelerWorkerSchemaPositionFieldIdQuantizedOrigin) > 0) {
+		stream->hasOrigin = true;
+		stream->origin = Schema_GetUint64(positionFields, shovelerWorkerSchemaPositionFieldIdQuantizedOrigin);
+	}
+
+	if (Schema_GetBytesCount(positionFields, shovelerWorkerSchemaPositionFieldIdQuantizedDelta) == 0) {
+		return false;
+	}
+
+	ShovelerWorkerPositionEncoding encoding = shovelerWorkerSchemaGetPositionEncoding();
+	const uint8_t* delta = Schema_GetBytes(positionFields, shovelerWorkerSchemaPositionFieldIdQuantizedDelta);
+	uint32_t deltaLength = Schema_GetBytesLength(positionFields, shovelerWorkerSchemaPositionFieldIdQuantizedDelta);
+	return shovelerWorkerPositionEncodingDecode(&encoding, stream, delta, (int) deltaLength, outputCoordinates);
+}
+
 Worker_ComponentData shovelerWorkerSchemaCreateBootstrapComponent()
 {
 	Worker_ComponentData componentData;
@@ -0,0 +1,146 @@
+#include "client_index.h"
+
+#include <assert.h> // assert
+#include <math.h> // floorf
+#include <stdlib.h> // malloc free
+
+static int getCellCoordinate(float coordinate, float min, float cellSize, int numCells);
+static int visitBox(ShovelerServerClientIndex *index, ShovelerVector2 min, ShovelerVector2 max, ShovelerVector2 center, float radius, ShovelerServerClientIndexVisitFunction *visit, void *userData);
+
+ShovelerServerClientIndex *shovelerServerClientIndexCreate(ShovelerVector2 min, float cellSize, int numCellsX, int numCellsZ)
+{
+	assert(cellSize > 0.0f);
+	assert(numCellsX > 0);
+	assert(numCellsZ > 0);
+
+	ShovelerServerClientIndex *index = malloc(sizeof(ShovelerServerClientIndex));
+	index->min = min;
+	index->cellSize = cellSize;
+	index->numCellsX = numCellsX;
+	index->numCellsZ = numCellsZ;
+	index->cells = malloc(numCellsX * numCellsZ * sizeof(ShovelerServerClientIndexEntry));
+
+	for(int i = 0; i < numCellsX * numCellsZ; i++) {
+		shovelerServerClientIndexEntryInit(&index->cells[i], /* entityId */ 0);
+	}
+
+	return index;
+}
+
+void shovelerServerClientIndexEntryInit(ShovelerServerClientIndexEntry *entry, int64_t entityId)
+{
+	entry->entityId = entityId;
+	entry->position = shovelerVector2(0.0f, 0.0f);
+	entry->previous = entry;
+	entry->next = entry;
+}
+
+void shovelerServerClientIndexUpdate(ShovelerServerClientIndex *index, ShovelerServerClientIndexEntry *entry, ShovelerVector2 position)
+{
+	int cellX = getCellCoordinate(position.values[0], index->min.values[0], index->cellSize, index->numCellsX);
+	int cellZ = getCellCoordinate(position.values[1], index->min.values[1], index->cellSize, index->numCellsZ);
+	ShovelerServerClientIndexEntry *cell = &index->cells[cellX * index->numCellsZ + cellZ];
+
+	if(shovelerServerClientIndexEntryIsIndexed(entry)) {
+		int previousCellX = getCellCoordinate(entry->position.values[0], index->min.values[0], index->cellSize, index->numCellsX);
+		int previousCellZ = getCellCoordinate(entry->position.values[1], index->min.values[1], index->cellSize, index->numCellsZ);
+		if(previousCellX == cellX && previousCellZ == cellZ) {
+			// most updates move within the same cell
+			entry->position = position;
+			return;
+		}
+
+		shovelerServerClientIndexEntryRemove(entry);
+	}
+
+	entry->position = position;
+	entry->previous = cell->previous;
+	entry->next = cell;
+	cell->previous->next = entry;
+	cell->previous = entry;
+}
+
+int shovelerServerClientIndexQueryRadius(ShovelerServerClientIndex *index, ShovelerVector2 center, float radius, ShovelerServerClientIndexVisitFunction *visit, void *userData)
+{
+	ShovelerVector2 min = shovelerVector2(center.values[0] - radius, center.values[1] - radius);
+	ShovelerVector2 max = shovelerVector2(center.values[0] + radius, center.values[1] + radius);
+	return visitBox(index, min, max, center, radius, visit, userData);
+}
+
+int shovelerServerClientIndexQueryBox(ShovelerServerClientIndex *index, ShovelerVector2 min, ShovelerVector2 max, ShovelerServerClientIndexVisitFunction *visit, void *userData)
+{
+	return visitBox(index, min, max, /* center */ shovelerVector2(0.0f, 0.0f), /* radius */ -1.0f, visit, userData);
+}
+
+void shovelerServerClientIndexFree(ShovelerServerClientIndex *index)
+{
+	for(int i = 0; i < index->numCellsX * index->numCellsZ; i++) {
+		while(shovelerServerClientIndexEntryIsIndexed(&index->cells[i])) {
+			shovelerServerClientIndexEntryRemove(index->cells[i].next);
+		}
+	}
+
+	free(index->cells);
+	free(index);
+}
+
+void shovelerServerClientIndexEntryRemove(ShovelerServerClientIndexEntry *entry)
+{
+	entry->previous->next = entry->next;
+	entry->next->previous = entry->previous;
+	entry->previous = entry;
+	entry->next = entry;
+}
+
+static int getCellCoordinate(float coordinate, float min, float cellSize, int numCells)
+{
+	float cell = floorf((coordinate - min) / cellSize);
+	if(!(cell >= 0.0f)) { // also catches NaN
+		return 0;
+	}
+
+	if(cell >= (float) numCells) {
+		return numCells - 1;
+	}
+
+	return (int) cell;
+}
+
+/** Visits the entries in the box, additionally filtering them by distance to center if radius isn't negative. */
+static int visitBox(ShovelerServerClientIndex *index, ShovelerVector2 min, ShovelerVector2 max, ShovelerVector2 center, float radius, ShovelerServerClientIndexVisitFunction *visit, void *userData)
+{
+	int minCellX = getCellCoordinate(min.values[0], index->min.values[0], index->cellSize, index->numCellsX);
+	int minCellZ = getCellCoordinate(min.values[1], index->min.values[1], index->cellSize, index->numCellsZ);
+	int maxCellX = getCellCoordinate(max.values[0], index->min.values[0], index->cellSize, index->numCellsX);
+	int maxCellZ = getCellCoordinate(max.values[1], index->min.values[1], index->cellSize, index->numCellsZ);
+	float radiusSquared = radius * radius;
+
+	int numVisited = 0;
+	for(int cellX = minCellX; cellX <= maxCellX; cellX++) {
+		for(int cellZ = minCellZ; cellZ <= maxCellZ; cellZ++) {
+			ShovelerServerClientIndexEntry *cell = &index->cells[cellX * index->numCellsZ + cellZ];
+			for(ShovelerServerClientIndexEntry *entry = cell->next; entry != cell; entry = entry->next) {
+				float x = entry->position.values[0];
+				float z = entry->position.values[1];
+				if(radius < 0.0f) {
+					if(x < min.values[0] || x >= max.values[0] || z < min.values[1] || z >= max.values[1]) {
+						continue;
+					}
+				} else {
+					float dx = x - center.values[0];
+					float dz = z - center.values[1];
+					if(dx * dx + dz * dz > radiusSquared) {
+						continue;
+					}
+				}
+
+				if(visit != NULL) {
+					visit(entry, userData);
+				}
+				numVisited++;
+			}
+		}
+	}
+
+	return numVisited;
+}
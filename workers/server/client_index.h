@@ -0,0 +1,60 @@
+#ifndef SHOVELER_SERVER_CLIENT_INDEX_H
+#define SHOVELER_SERVER_CLIENT_INDEX_H
+
+#include <stdbool.h> // bool
+#include <stdint.h> // int64_t
+
+#include <shoveler/types.h>
+
+typedef struct ShovelerServerClientIndexEntryStruct {
+	int64_t entityId;
+	/* position on the ground plane */
+	ShovelerVector2 position;
+	/* intrusive links into the circular list of the grid cell, pointing to itself if not indexed */
+	struct ShovelerServerClientIndexEntryStruct *previous;
+	struct ShovelerServerClientIndexEntryStruct *next;
+} ShovelerServerClientIndexEntry;
+
+typedef void (ShovelerServerClientIndexVisitFunction)(ShovelerServerClientIndexEntry *entry, void *userData);
+
+/**
+ * Uniform grid over the ground plane indexing client positions.
+ *
+ * Every cell holds an intrusive list of the entries whose position falls into it, so moving an
+ * entry is O(1) and queries only visit the cells overlapping the queried area. With cells about
+ * the size of a query, that makes queries O(k) in the number of clients near the area rather than
+ * in the number of all clients. Positions outside of the grid are kept in the nearest border cell,
+ * which queries always check against the exact position.
+ */
+typedef struct {
+	ShovelerVector2 min;
+	float cellSize;
+	int numCellsX;
+	int numCellsZ;
+	/* array of numCellsX * numCellsZ sentinel entries, indexed by cellX * numCellsZ + cellZ */
+	ShovelerServerClientIndexEntry *cells;
+} ShovelerServerClientIndex;
+
+ShovelerServerClientIndex *shovelerServerClientIndexCreate(ShovelerVector2 min, float cellSize, int numCellsX, int numCellsZ);
+void shovelerServerClientIndexEntryInit(ShovelerServerClientIndexEntry *entry, int64_t entityId);
+/** Inserts the entry at the given position or moves it there if it is already indexed, in O(1). */
+void shovelerServerClientIndexUpdate(ShovelerServerClientIndex *index, ShovelerServerClientIndexEntry *entry, ShovelerVector2 position);
+/**
+ * Calls visit on every entry within radius of center, and returns their number.
+ *
+ * Visit may be NULL to only count the entries. It must not update or remove entries.
+ */
+int shovelerServerClientIndexQueryRadius(ShovelerServerClientIndex *index, ShovelerVector2 center, float radius, ShovelerServerClientIndexVisitFunction *visit, void *userData);
+/** Like shovelerServerClientIndexQueryRadius, but for entries in the box [min, max). */
+int shovelerServerClientIndexQueryBox(ShovelerServerClientIndex *index, ShovelerVector2 min, ShovelerVector2 max, ShovelerServerClientIndexVisitFunction *visit, void *userData);
+void shovelerServerClientIndexFree(ShovelerServerClientIndex *index);
+
+/** Removes the entry from its index if it is indexed, which doesn't require access to the index. */
+void shovelerServerClientIndexEntryRemove(ShovelerServerClientIndexEntry *entry);
+
+static inline bool shovelerServerClientIndexEntryIsIndexed(ShovelerServerClientIndexEntry *entry)
+{
+	return entry->next != entry;
+}
+
+#endif
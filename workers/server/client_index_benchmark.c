@@ -0,0 +1,208 @@
+/**
+ * Moves simulated clients around the world at bot speed and compares radius and box queries on the
+ * client index against scanning a hash table of all clients, checking that both agree.
+ *
+ * Usage: client_index_benchmark [num clients] [num ticks]
+ */
+#include <stdbool.h> // bool
+#include <stdint.h> // int64_t uint32_t
+#include <stdio.h> // fprintf printf
+#include <stdlib.h> // atoi malloc free EXIT_FAILURE EXIT_SUCCESS
+
+#include <glib.h>
+#include <shoveler/types.h>
+
+#include "client_index.h"
+
+typedef struct {
+	ShovelerServerClientIndexEntry entry;
+	ShovelerVector2 direction;
+} SimulatedClient;
+
+static void step(ShovelerServerClientIndex *index, SimulatedClient *client, uint32_t *randomState);
+static int scanRadius(GHashTable *clients, ShovelerVector2 center, float radius);
+static int scanBox(GHashTable *clients, ShovelerVector2 min, ShovelerVector2 max);
+static uint32_t nextRandom(uint32_t *state);
+
+static const float velocity = 1.5f;
+static const int tickRateHz = 30;
+static const int numChunkRows = 20;
+static const int numChunkColumns = 20;
+static const int chunkSize = 10;
+/* half the edge length of the relative box interest of clients */
+static const float queryRadius = 20.5f;
+static const int numRadiusQueriesPerTick = 100;
+
+int main(int argc, char **argv)
+{
+	if(argc != 1 && argc != 3) {
+		fprintf(stderr, "Usage:\n\t%s\n\t%s <num clients> <num ticks>\n", argv[0], argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	int numClients = argc == 3 ? atoi(argv[1]) : 10000;
+	int numTicks = argc == 3 ? atoi(argv[2]) : 300;
+	if(numClients <= 0 || numTicks <= 0) {
+		fprintf(stderr, "Number of clients and ticks must be positive.\n");
+		return EXIT_FAILURE;
+	}
+
+	float halfMapWidth = 0.5f * numChunkColumns * chunkSize;
+	float halfMapHeight = 0.5f * numChunkRows * chunkSize;
+	ShovelerServerClientIndex *index = shovelerServerClientIndexCreate(
+		shovelerVector2(-halfMapWidth, -halfMapHeight), (float) chunkSize, numChunkColumns, numChunkRows);
+	GHashTable *clients = g_hash_table_new(g_int64_hash, g_int64_equal);
+
+	uint32_t randomState = 42;
+	SimulatedClient *simulatedClients = malloc(numClients * sizeof(SimulatedClient));
+	for(int i = 0; i < numClients; i++) {
+		SimulatedClient *client = &simulatedClients[i];
+		shovelerServerClientIndexEntryInit(&client->entry, /* entityId */ 1000 + i);
+		client->direction = shovelerVector2(1.0f, 0.0f);
+
+		ShovelerVector2 position = shovelerVector2(
+			(float) (nextRandom(&randomState) % 19800) / 100.0f - 99.0f,
+			(float) (nextRandom(&randomState) % 19800) / 100.0f - 99.0f);
+		shovelerServerClientIndexUpdate(index, &client->entry, position);
+		g_hash_table_insert(clients, &client->entry.entityId, &client->entry);
+	}
+
+	int numQueriesPerTick = numRadiusQueriesPerTick + numChunkColumns * numChunkRows;
+	int *indexCounts = malloc(numQueriesPerTick * sizeof(int));
+	int *scanCounts = malloc(numQueriesPerTick * sizeof(int));
+	ShovelerVector2 *centers = malloc(numRadiusQueriesPerTick * sizeof(ShovelerVector2));
+
+	int64_t updateUs = 0;
+	int64_t indexQueryUs = 0;
+	int64_t scanQueryUs = 0;
+	int64_t numQueried = 0;
+	int numQueries = 0;
+	int numMismatches = 0;
+	for(int tick = 0; tick < numTicks; tick++) {
+		int64_t updateStart = g_get_monotonic_time();
+		for(int i = 0; i < numClients; i++) {
+			step(index, &simulatedClients[i], &randomState);
+		}
+		updateUs += g_get_monotonic_time() - updateStart;
+
+		// radius queries around random clients, plus a spawn style occupancy count of every chunk
+		for(int i = 0; i < numRadiusQueriesPerTick; i++) {
+			centers[i] = simulatedClients[nextRandom(&randomState) % numClients].entry.position;
+		}
+
+		int64_t indexStart = g_get_monotonic_time();
+		int query = 0;
+		for(int i = 0; i < numRadiusQueriesPerTick; i++) {
+			indexCounts[query++] = shovelerServerClientIndexQueryRadius(index, centers[i], queryRadius, /* visit */ NULL, /* userData */ NULL);
+		}
+		for(int chunkX = 0; chunkX < numChunkColumns; chunkX++) {
+			for(int chunkZ = 0; chunkZ < numChunkRows; chunkZ++) {
+				ShovelerVector2 min = shovelerVector2(-halfMapWidth + chunkX * chunkSize, -halfMapHeight + chunkZ * chunkSize);
+				ShovelerVector2 max = shovelerVector2(min.values[0] + chunkSize, min.values[1] + chunkSize);
+				indexCounts[query++] = shovelerServerClientIndexQueryBox(index, min, max, /* visit */ NULL, /* userData */ NULL);
+			}
+		}
+		indexQueryUs += g_get_monotonic_time() - indexStart;
+
+		int64_t scanStart = g_get_monotonic_time();
+		query = 0;
+		for(int i = 0; i < numRadiusQueriesPerTick; i++) {
+			scanCounts[query++] = scanRadius(clients, centers[i], queryRadius);
+		}
+		for(int chunkX = 0; chunkX < numChunkColumns; chunkX++) {
+			for(int chunkZ = 0; chunkZ < numChunkRows; chunkZ++) {
+				ShovelerVector2 min = shovelerVector2(-halfMapWidth + chunkX * chunkSize, -halfMapHeight + chunkZ * chunkSize);
+				ShovelerVector2 max = shovelerVector2(min.values[0] + chunkSize, min.values[1] + chunkSize);
+				scanCounts[query++] = scanBox(clients, min, max);
+			}
+		}
+		scanQueryUs += g_get_monotonic_time() - scanStart;
+
+		for(int i = 0; i < query; i++) {
+			if(indexCounts[i] != scanCounts[i]) {
+				numMismatches++;
+			}
+			numQueried += indexCounts[i];
+		}
+		numQueries += query;
+	}
+
+	printf("%d clients for %d ticks, %d queries returning %.1f clients on average:\n", numClients, numTicks, numQueries, (double) numQueried / numQueries);
+	printf("\tposition updates: %.3fus per client update\n", (double) updateUs / ((int64_t) numClients * numTicks));
+	printf("\tclient index:     %.3fus per query\n", (double) indexQueryUs / numQueries);
+	printf("\thash table scan:  %.3fus per query\n", (double) scanQueryUs / numQueries);
+
+	g_hash_table_destroy(clients);
+	shovelerServerClientIndexFree(index);
+	free(simulatedClients);
+	free(indexCounts);
+	free(scanCounts);
+	free(centers);
+
+	if(numMismatches > 0) {
+		fprintf(stderr, "%d queries returned different clients from the index and the hash table scan.\n", numMismatches);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+static void step(ShovelerServerClientIndex *index, SimulatedClient *client, uint32_t *randomState)
+{
+	// like the bots: keep walking straight, occasionally turning and bouncing off the world's border
+	if(nextRandom(randomState) % 100 < 3) {
+		client->direction = shovelerVector2(-client->direction.values[1], client->direction.values[0]);
+	}
+
+	ShovelerVector2 position = client->entry.position;
+	position.values[0] += client->direction.values[0] * velocity / tickRateHz;
+	position.values[1] += client->direction.values[1] * velocity / tickRateHz;
+	if(position.values[0] < -99.0f || position.values[0] > 99.0f || position.values[1] < -99.0f || position.values[1] > 99.0f) {
+		client->direction = shovelerVector2(-client->direction.values[0], -client->direction.values[1]);
+		return;
+	}
+
+	shovelerServerClientIndexUpdate(index, &client->entry, position);
+}
+
+static int scanRadius(GHashTable *clients, ShovelerVector2 center, float radius)
+{
+	int numFound = 0;
+
+	GHashTableIter iter;
+	ShovelerServerClientIndexEntry *entry;
+	g_hash_table_iter_init(&iter, clients);
+	while(g_hash_table_iter_next(&iter, NULL, (gpointer *) &entry)) {
+		float dx = entry->position.values[0] - center.values[0];
+		float dz = entry->position.values[1] - center.values[1];
+		if(dx * dx + dz * dz <= radius * radius) {
+			numFound++;
+		}
+	}
+
+	return numFound;
+}
+
+static int scanBox(GHashTable *clients, ShovelerVector2 min, ShovelerVector2 max)
+{
+	int numFound = 0;
+
+	GHashTableIter iter;
+	ShovelerServerClientIndexEntry *entry;
+	g_hash_table_iter_init(&iter, clients);
+	while(g_hash_table_iter_next(&iter, NULL, (gpointer *) &entry)) {
+		float x = entry->position.values[0];
+		float z = entry->position.values[1];
+		if(x >= min.values[0] && x < max.values[0] && z >= min.values[1] && z < max.values[1]) {
+			numFound++;
+		}
+	}
+
+	return numFound;
+}
+
+static uint32_t nextRandom(uint32_t *state)
+{
+	*state = *state * 1664525u + 1013904223u;
+	return *state >> 8;
+}
@@ -0,0 +1,230 @@
+#include "command_pipeline.h"
+
+#include <stdbool.h> // bool
+#include <stdlib.h> // malloc free
+#include <string.h> // strerror
+
+#include <glib.h>
+#include <shoveler/log.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+typedef struct {
+	ShovelerServerHandler handler;
+	ShovelerServerCommandHandlerFunction *handlerFunction;
+	const Worker_CommandRequestOp *op;
+	void *userData;
+	ShovelerServerOutbox outbox;
+	int64_t duration;
+} Command;
+
+#ifndef _WIN32
+typedef struct {
+	ShovelerServerCommandPipeline *pipeline;
+	pthread_t thread;
+	pthread_cond_t wakeCondition;
+	/* queue of Command pointers, protected by the pipeline mutex */
+	GQueue *queue;
+} Shard;
+#endif
+
+struct ShovelerServerCommandPipelineStruct {
+	Worker_Connection *connection;
+	ShovelerServerMetrics *metrics;
+	int numShards;
+	/* queue of Command pointers in dispatch order, only accessed from the dispatching thread */
+	GQueue *commands;
+#ifndef _WIN32
+	Shard *shards;
+	pthread_mutex_t mutex;
+	pthread_cond_t finishedCondition;
+	int numUnfinished;
+	bool shutdown;
+#endif
+};
+
+static void runCommand(Command *command);
+static void finishCommand(ShovelerServerCommandPipeline *pipeline, Command *command);
+#ifndef _WIN32
+static int getShardIndex(ShovelerServerCommandPipeline *pipeline, int64_t shardKey);
+static void *runShard(void *shardPointer);
+#endif
+
+ShovelerServerCommandPipeline *shovelerServerCommandPipelineCreate(Worker_Connection *connection, ShovelerServerMetrics *metrics, int numThreads)
+{
+	ShovelerServerCommandPipeline *pipeline = malloc(sizeof(ShovelerServerCommandPipeline));
+	pipeline->connection = connection;
+	pipeline->metrics = metrics;
+	pipeline->numShards = 0;
+	pipeline->commands = g_queue_new();
+
+#ifdef _WIN32
+	if(numThreads > 0) {
+		shovelerLogWarning("Command pipeline threads are not supported on this platform, handling commands inline.");
+	}
+#else
+	pipeline->shards = NULL;
+	pthread_mutex_init(&pipeline->mutex, NULL);
+	pthread_cond_init(&pipeline->finishedCondition, NULL);
+	pipeline->numUnfinished = 0;
+	pipeline->shutdown = false;
+
+	if(numThreads > 0) {
+		pipeline->shards = malloc(numThreads * sizeof(Shard));
+		for(int i = 0; i < numThreads; i++) {
+			Shard *shard = &pipeline->shards[i];
+			shard->pipeline = pipeline;
+			pthread_cond_init(&shard->wakeCondition, NULL);
+			shard->queue = g_queue_new();
+
+			int error = pthread_create(&shard->thread, NULL, runShard, shard);
+			if(error != 0) {
+				shovelerLogError("Failed to start command pipeline thread %d: %s", i, strerror(error));
+				pthread_cond_destroy(&shard->wakeCondition);
+				g_queue_free(shard->queue);
+				break;
+			}
+
+			pipeline->numShards++;
+		}
+	}
+
+	if(pipeline->numShards > 0) {
+		shovelerLogInfo("Handling commands on %d pipeline threads.", pipeline->numShards);
+	}
+#endif
+
+	return pipeline;
+}
+
+void shovelerServerCommandPipelineDispatch(ShovelerServerCommandPipeline *pipeline, int64_t shardKey, ShovelerServerHandler handler, ShovelerServerCommandHandlerFunction *handlerFunction, const Worker_CommandRequestOp *op, void *userData)
+{
+	Command *command = malloc(sizeof(Command));
+	command->handler = handler;
+	command->handlerFunction = handlerFunction;
+	command->op = op;
+	command->userData = userData;
+	shovelerServerOutboxInit(&command->outbox, op->request_id);
+	command->duration = 0;
+
+	if(pipeline->numShards == 0) {
+		runCommand(command);
+		finishCommand(pipeline, command);
+		return;
+	}
+
+#ifndef _WIN32
+	g_queue_push_tail(pipeline->commands, command);
+
+	Shard *shard = &pipeline->shards[getShardIndex(pipeline, shardKey)];
+	pthread_mutex_lock(&pipeline->mutex);
+	g_queue_push_tail(shard->queue, command);
+	pipeline->numUnfinished++;
+	pthread_cond_signal(&shard->wakeCondition);
+	pthread_mutex_unlock(&pipeline->mutex);
+#endif
+}
+
+void shovelerServerCommandPipelineDrain(ShovelerServerCommandPipeline *pipeline)
+{
+	if(g_queue_is_empty(pipeline->commands)) {
+		return;
+	}
+
+#ifndef _WIN32
+	pthread_mutex_lock(&pipeline->mutex);
+	while(pipeline->numUnfinished > 0) {
+		pthread_cond_wait(&pipeline->finishedCondition, &pipeline->mutex);
+	}
+	pthread_mutex_unlock(&pipeline->mutex);
+#endif
+
+	Command *command;
+	while((command = g_queue_pop_head(pipeline->commands)) != NULL) {
+		finishCommand(pipeline, command);
+	}
+}
+
+void shovelerServerCommandPipelineFree(ShovelerServerCommandPipeline *pipeline)
+{
+	shovelerServerCommandPipelineDrain(pipeline);
+
+#ifndef _WIN32
+	pthread_mutex_lock(&pipeline->mutex);
+	pipeline->shutdown = true;
+	for(int i = 0; i < pipeline->numShards; i++) {
+		pthread_cond_signal(&pipeline->shards[i].wakeCondition);
+	}
+	pthread_mutex_unlock(&pipeline->mutex);
+
+	for(int i = 0; i < pipeline->numShards; i++) {
+		Shard *shard = &pipeline->shards[i];
+		pthread_join(shard->thread, NULL);
+		pthread_cond_destroy(&shard->wakeCondition);
+		g_queue_free(shard->queue);
+	}
+
+	free(pipeline->shards);
+	pthread_cond_destroy(&pipeline->finishedCondition);
+	pthread_mutex_destroy(&pipeline->mutex);
+#endif
+
+	g_queue_free(pipeline->commands);
+	free(pipeline);
+}
+
+static void runCommand(Command *command)
+{
+	int64_t start = g_get_monotonic_time();
+	command->handlerFunction(command->op, &command->outbox, command->userData);
+	command->duration = g_get_monotonic_time() - start;
+}
+
+static void finishCommand(ShovelerServerCommandPipeline *pipeline, Command *command)
+{
+	shovelerServerOutboxFlush(&command->outbox, pipeline->connection, pipeline->metrics);
+	shovelerServerMetricsRecordHandler(pipeline->metrics, command->handler, command->duration);
+	free(command);
+}
+
+#ifndef _WIN32
+static int getShardIndex(ShovelerServerCommandPipeline *pipeline, int64_t shardKey)
+{
+	// chunk entity IDs are evenly spaced, so mix the key before reducing it to a shard
+	uint64_t hash = (uint64_t) shardKey * UINT64_C(0x9E3779B97F4A7C15);
+	return (int) ((hash >> 32) % (uint64_t) pipeline->numShards);
+}
+
+static void *runShard(void *shardPointer)
+{
+	Shard *shard = shardPointer;
+	ShovelerServerCommandPipeline *pipeline = shard->pipeline;
+
+	pthread_mutex_lock(&pipeline->mutex);
+	while(true) {
+		while(g_queue_is_empty(shard->queue) && !pipeline->shutdown) {
+			pthread_cond_wait(&shard->wakeCondition, &pipeline->mutex);
+		}
+
+		if(g_queue_is_empty(shard->queue)) {
+			break;
+		}
+
+		Command *command = g_queue_pop_head(shard->queue);
+		pthread_mutex_unlock(&pipeline->mutex);
+
+		runCommand(command);
+
+		pthread_mutex_lock(&pipeline->mutex);
+		pipeline->numUnfinished--;
+		if(pipeline->numUnfinished == 0) {
+			pthread_cond_signal(&pipeline->finishedCondition);
+		}
+	}
+	pthread_mutex_unlock(&pipeline->mutex);
+
+	return NULL;
+}
+#endif
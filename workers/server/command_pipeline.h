@@ -0,0 +1,38 @@
+#ifndef SHOVELER_SERVER_COMMAND_PIPELINE_H
+#define SHOVELER_SERVER_COMMAND_PIPELINE_H
+
+#include <stdint.h> // int64_t
+
+#include <improbable/c_worker.h>
+
+#include "metrics.h"
+#include "outbox.h"
+
+typedef void (ShovelerServerCommandHandlerFunction)(const Worker_CommandRequestOp *op, ShovelerServerOutbox *outbox, void *userData);
+
+typedef struct ShovelerServerCommandPipelineStruct ShovelerServerCommandPipeline;
+
+/**
+ * Runs command handlers on a fixed number of shard threads while the main thread keeps draining op
+ * lists from the connection.
+ *
+ * Every command is dispatched with a shard key naming the entity or chunk whose state its handler
+ * touches, and commands with the same key run on the same shard in dispatch order. Handlers don't
+ * send anything themselves but fill an outbox, and draining the pipeline sends all outboxes from
+ * the calling thread in dispatch order. The connection therefore sees exactly the same sequence of
+ * messages as if the handlers had run inline, one after another.
+ *
+ * Handlers may read shared state concurrently, so the caller must drain the pipeline before
+ * modifying anything a handler might look at, and before destroying the op list a dispatched op
+ * points into.
+ *
+ * With zero threads, or on platforms without pthreads, handlers run inline on dispatch and their
+ * outboxes are sent right away.
+ */
+ShovelerServerCommandPipeline *shovelerServerCommandPipelineCreate(Worker_Connection *connection, ShovelerServerMetrics *metrics, int numThreads);
+void shovelerServerCommandPipelineDispatch(ShovelerServerCommandPipeline *pipeline, int64_t shardKey, ShovelerServerHandler handler, ShovelerServerCommandHandlerFunction *handlerFunction, const Worker_CommandRequestOp *op, void *userData);
+/** Waits for all dispatched commands to finish and sends their outboxes in dispatch order. */
+void shovelerServerCommandPipelineDrain(ShovelerServerCommandPipeline *pipeline);
+void shovelerServerCommandPipelineFree(ShovelerServerCommandPipeline *pipeline);
+
+#endif
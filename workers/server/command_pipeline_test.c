@@ -0,0 +1,352 @@
+/**
+ * Replays a synthetic op recording full of commands against the server, once handling commands
+ * inline and once on the command pipeline, and checks that both runs send exactly the same messages
+ * in the same order.
+ *
+ * Usage: command_pipeline_test SERVER_REPLAY_BINARY [WORKING_DIRECTORY]
+ *
+ * The working directory defaults to the TEST_TMPDIR passed by Bazel.
+ */
+#include <stdbool.h> // bool
+#include <stdio.h> // fprintf printf
+#include <stdlib.h> // free getenv realloc setenv system
+#include <string.h> // memcmp memcpy memset
+
+#include <glib.h>
+#include <improbable/c_schema.h>
+#include <improbable/c_worker.h>
+#include <shoveler/log.h>
+#include <shoveler/op_recording.h>
+#include <shoveler/spatialos_schema.h>
+
+static const Worker_EntityId workerEntityId = 100;
+static const Worker_EntityId bootstrapEntityId = 3;
+static const Worker_EntityId firstClientEntityId = 20000;
+static const Worker_EntityId firstResourceEntityId = 30000;
+static const Worker_EntityId firstReservedEntityId = 40000;
+static const int numClients = 8;
+static const int numResources = 16;
+static const int minChunk = 8;
+static const int maxChunk = 12;
+static const int numCommandOpLists = 50;
+static const int numCommandsPerOpList = 40;
+
+typedef struct {
+	Worker_Op *ops;
+	uint32_t opCount;
+	uint32_t capacity;
+} OpListBuilder;
+
+static bool writeRecording(const char *filename);
+static bool runServer(const char *serverBinary, const char *workingDirectory, const char *name, const char *flags, GString *outputFilename);
+static bool compareSends(const char *expectedFilename, const char *actualFilename);
+static void writeOpList(ShovelerWorkerOpRecorder *recorder, OpListBuilder *builder);
+static Worker_Op *addOp(OpListBuilder *builder, uint8_t opType);
+static void addEntityWithComponent(OpListBuilder *builder, Worker_EntityId entityId, Worker_ComponentData componentData);
+static void addReserveEntityIdsResponse(OpListBuilder *builder, Worker_EntityId firstEntityId);
+static Schema_Object *addCommandRequest(OpListBuilder *builder, Worker_RequestId requestId, uint32_t commandIndex);
+static void addVector3(Schema_Object *object, Schema_FieldId fieldId, float x, float y, float z);
+static uint32_t nextRandom(uint32_t *state);
+
+int main(int argc, char **argv)
+{
+	const char *workingDirectory = argc == 3 ? argv[2] : getenv("TEST_TMPDIR");
+	if(argc < 2 || argc > 3 || workingDirectory == NULL) {
+		fprintf(stderr, "Usage:\n\t%s SERVER_REPLAY_BINARY [WORKING_DIRECTORY]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	const char *serverBinary = argv[1];
+
+	shovelerLogInit("shoveler-spatialos/", SHOVELER_LOG_LEVEL_WARNING_UP, stderr);
+
+	GString *recordingFilename = g_string_new("");
+	g_string_append_printf(recordingFilename, "%s/command_pipeline_test.recording", workingDirectory);
+	GString *inlineOutputFilename = g_string_new("");
+	GString *pipelineOutputFilename = g_string_new("");
+
+	bool success = writeRecording(recordingFilename->str)
+		&& runServer(serverBinary, workingDirectory, "inline", "command_threads=0,random_seed=1", inlineOutputFilename)
+		&& runServer(serverBinary, workingDirectory, "pipeline", "command_threads=4,random_seed=1", pipelineOutputFilename)
+		&& compareSends(inlineOutputFilename->str, pipelineOutputFilename->str);
+
+	g_string_free(pipelineOutputFilename, true);
+	g_string_free(inlineOutputFilename, true);
+	g_string_free(recordingFilename, true);
+	shovelerLogTerminate();
+
+	if(!success) {
+		return EXIT_FAILURE;
+	}
+
+	printf("Inline and pipelined command handling sent identical messages.\n");
+	return EXIT_SUCCESS;
+}
+
+static bool writeRecording(const char *filename)
+{
+	ShovelerWorkerOpRecorder *recorder = shovelerWorkerOpRecorderCreate(filename);
+	if(recorder == NULL) {
+		return false;
+	}
+
+	shovelerWorkerOpRecorderWriteConnect(recorder, workerEntityId);
+	shovelerWorkerOpRecorderWriteWorkerFlag(recorder, "game_type", "tiles");
+
+	OpListBuilder builder = {NULL, 0, 0};
+	uint32_t randomState = 1337;
+
+	// the view: chunk backgrounds with a mix of grass and other tiles, clients and resources
+	addReserveEntityIdsResponse(&builder, firstReservedEntityId);
+	for(int chunkX = minChunk; chunkX < maxChunk; chunkX++) {
+		for(int chunkZ = minChunk; chunkZ < maxChunk; chunkZ++) {
+			unsigned char columns[100];
+			unsigned char rows[100];
+			unsigned char ids[100];
+			for(int i = 0; i < 100; i++) {
+				columns[i] = (unsigned char) (nextRandom(&randomState) % 4);
+				rows[i] = 0;
+				ids[i] = 1;
+			}
+
+			Worker_EntityId chunkBackgroundEntityId = 12 + 3 * chunkX * 20 + 3 * chunkZ;
+			addEntityWithComponent(&builder, chunkBackgroundEntityId, shovelerWorkerSchemaCreateTilemapTilesDirectComponent(10, 10, columns, rows, ids));
+		}
+	}
+	for(int i = 0; i < numClients; i++) {
+		addEntityWithComponent(&builder, firstClientEntityId + i, shovelerWorkerSchemaCreateClientInfoComponent(workerEntityId, (float) i / numClients, 0.5f));
+	}
+	writeOpList(recorder, &builder);
+
+	Worker_RequestId nextRequestId = 1;
+	for(int opListIndex = 0; opListIndex < numCommandOpLists; opListIndex++) {
+		for(int commandIndex = 0; commandIndex < numCommandsPerOpList; commandIndex++) {
+			// clients leaving in between commands must be seen by all commands after them
+			if(opListIndex % 7 == 3 && commandIndex == numCommandsPerOpList / 2) {
+				Worker_Op *removeEntityOp = addOp(&builder, WORKER_OP_TYPE_REMOVE_ENTITY);
+				removeEntityOp->op.remove_entity.entity_id = firstClientEntityId + (opListIndex / 7) % numClients;
+			}
+
+			// entity creation runs alone and depends on the tiles dug before it
+			if(opListIndex % 10 == 5 && commandIndex == numCommandsPerOpList / 4) {
+				addCommandRequest(&builder, nextRequestId++, shovelerWorkerSchemaBootstrapCommandIdCreateClientEntity);
+				addReserveEntityIdsResponse(&builder, firstReservedEntityId + opListIndex);
+			}
+
+			Worker_EntityId clientEntityId = firstClientEntityId + nextRandom(&randomState) % numClients;
+			switch(nextRandom(&randomState) % 3) {
+				case 0: {
+					// dig holes within and around the chunks in view, hitting the same tiles again and again
+					Schema_Object *request = addCommandRequest(&builder, nextRequestId++, shovelerWorkerSchemaBootstrapCommandIdDigHole);
+					Schema_AddEntityId(request, shovelerWorkerSchemaDigHoleRequestFieldIdClient, clientEntityId);
+					float x = (float) (nextRandom(&randomState) % 50) - 25.0f + 0.5f;
+					float y = (float) (nextRandom(&randomState) % 50) - 25.0f + 0.5f;
+					addVector3(request, shovelerWorkerSchemaDigHoleRequestFieldIdPosition, x, y, 0.0f);
+				} break;
+				case 1: {
+					Schema_Object *request = addCommandRequest(&builder, nextRequestId++, shovelerWorkerSchemaBootstrapCommandIdClientSpawnCube);
+					Schema_AddEntityId(request, shovelerWorkerSchemaClientSpawnCubeRequestFieldIdClient, clientEntityId);
+					addVector3(request, shovelerWorkerSchemaClientSpawnCubeRequestFieldIdPosition, (float) commandIndex, 1.0f, (float) opListIndex);
+					addVector3(request, shovelerWorkerSchemaClientSpawnCubeRequestFieldIdDirection, 0.0f, 0.0f, 1.0f);
+					addVector3(request, shovelerWorkerSchemaClientSpawnCubeRequestFieldIdRotation, 0.0f, (float) commandIndex, 0.0f);
+				} break;
+				case 2: {
+					Schema_Object *request = addCommandRequest(&builder, nextRequestId++, shovelerWorkerSchemaBootstrapCommandIdUpdateResource);
+					Schema_AddEntityId(request, shovelerWorkerSchemaUpdateResourceRequestFieldIdResource, firstResourceEntityId + nextRandom(&randomState) % numResources);
+					if(commandIndex % 9 != 0) {
+						uint8_t content[64];
+						memset(content, opListIndex * numCommandsPerOpList + commandIndex, sizeof(content));
+						uint8_t *contentBuffer = Schema_AllocateBuffer(request, sizeof(content));
+						memcpy(contentBuffer, content, sizeof(content));
+						Schema_AddBytes(request, shovelerWorkerSchemaUpdateResourceRequestFieldIdContent, contentBuffer, sizeof(content));
+					}
+				} break;
+			}
+		}
+
+		writeOpList(recorder, &builder);
+	}
+
+	free(builder.ops);
+	shovelerWorkerOpRecorderFree(recorder);
+	return true;
+}
+
+static bool runServer(const char *serverBinary, const char *workingDirectory, const char *name, const char *flags, GString *outputFilename)
+{
+	GString *recordingFilename = g_string_new("");
+	g_string_append_printf(recordingFilename, "%s/command_pipeline_test.recording", workingDirectory);
+	g_string_append_printf(outputFilename, "%s/command_pipeline_test_%s.output", workingDirectory, name);
+	GString *command = g_string_new("");
+	g_string_append_printf(command, "\"%s\" \"%s/command_pipeline_test_%s.log\" server localhost 7777", serverBinary, workingDirectory, name);
+
+	setenv("SHOVELER_WORKER_REPLAY_FILE", recordingFilename->str, /* overwrite */ 1);
+	setenv("SHOVELER_WORKER_REPLAY_OUTPUT_FILE", outputFilename->str, /* overwrite */ 1);
+	setenv("SHOVELER_WORKER_REPLAY_FLAGS", flags, /* overwrite */ 1);
+
+	int status = system(command->str);
+	if(status != 0) {
+		fprintf(stderr, "Server replay '%s' with flags '%s' failed with status %d.\n", command->str, flags, status);
+	}
+
+	g_string_free(command, true);
+	g_string_free(recordingFilename, true);
+	return status == 0;
+}
+
+static bool compareSends(const char *expectedFilename, const char *actualFilename)
+{
+	ShovelerWorkerRecording *expected = shovelerWorkerRecordingRead(expectedFilename);
+	ShovelerWorkerRecording *actual = shovelerWorkerRecordingRead(actualFilename);
+	if(expected == NULL || actual == NULL) {
+		fprintf(stderr, "Failed to read replay outputs '%s' and '%s'.\n", expectedFilename, actualFilename);
+		shovelerWorkerRecordingFree(expected);
+		shovelerWorkerRecordingFree(actual);
+		return false;
+	}
+
+	int numComparedSends = 0;
+	int numSends[SHOVELER_WORKER_RECORD_TYPE_NUM_TYPES] = {0};
+	bool success = true;
+	guint expectedIndex = 0;
+	guint actualIndex = 0;
+	while(success) {
+		// worker flags legitimately differ between the runs, so only compare sends
+		while(expectedIndex < expected->records->len && !shovelerWorkerRecordIsSend(&g_array_index(expected->records, ShovelerWorkerRecord, expectedIndex))) {
+			expectedIndex++;
+		}
+		while(actualIndex < actual->records->len && !shovelerWorkerRecordIsSend(&g_array_index(actual->records, ShovelerWorkerRecord, actualIndex))) {
+			actualIndex++;
+		}
+
+		bool expectedFinished = expectedIndex >= expected->records->len;
+		bool actualFinished = actualIndex >= actual->records->len;
+		if(expectedFinished || actualFinished) {
+			if(expectedFinished != actualFinished) {
+				fprintf(stderr, "Pipelined run sent %s messages than the inline run.\n", actualFinished ? "fewer" : "more");
+				success = false;
+			}
+			break;
+		}
+
+		const ShovelerWorkerRecord *expectedRecord = &g_array_index(expected->records, ShovelerWorkerRecord, expectedIndex);
+		const ShovelerWorkerRecord *actualRecord = &g_array_index(actual->records, ShovelerWorkerRecord, actualIndex);
+		if(expectedRecord->type != actualRecord->type
+			|| expectedRecord->sendResult != actualRecord->sendResult
+			|| expectedRecord->payloadLength != actualRecord->payloadLength
+			|| memcmp(expectedRecord->payload, actualRecord->payload, expectedRecord->payloadLength) != 0) {
+			fprintf(
+				stderr,
+				"Send %d differs: inline run sent record type %d with %u bytes, pipelined run sent record type %d with %u bytes.\n",
+				numComparedSends,
+				expectedRecord->type,
+				expectedRecord->payloadLength,
+				actualRecord->type,
+				actualRecord->payloadLength);
+			success = false;
+			break;
+		}
+
+		numComparedSends++;
+		numSends[expectedRecord->type]++;
+		expectedIndex++;
+		actualIndex++;
+	}
+
+	if(success) {
+		printf(
+			"Compared %d sends: %d component updates, %d create entity requests, %d command responses, %d command failures.\n",
+			numComparedSends,
+			numSends[SHOVELER_WORKER_RECORD_TYPE_SEND_COMPONENT_UPDATE],
+			numSends[SHOVELER_WORKER_RECORD_TYPE_SEND_CREATE_ENTITY_REQUEST],
+			numSends[SHOVELER_WORKER_RECORD_TYPE_SEND_COMMAND_RESPONSE],
+			numSends[SHOVELER_WORKER_RECORD_TYPE_SEND_COMMAND_FAILURE]);
+
+		// make sure the recording actually exercised both the success and the failure paths
+		if(numSends[SHOVELER_WORKER_RECORD_TYPE_SEND_COMMAND_RESPONSE] == 0 || numSends[SHOVELER_WORKER_RECORD_TYPE_SEND_COMMAND_FAILURE] == 0) {
+			fprintf(stderr, "Server didn't both respond to and fail commands, the test recording is broken.\n");
+			success = false;
+		}
+	}
+
+	shovelerWorkerRecordingFree(expected);
+	shovelerWorkerRecordingFree(actual);
+	return success;
+}
+
+static void writeOpList(ShovelerWorkerOpRecorder *recorder, OpListBuilder *builder)
+{
+	Worker_OpList opList;
+	opList.ops = builder->ops;
+	opList.op_count = builder->opCount;
+	shovelerWorkerOpRecorderWriteOpList(recorder, &opList);
+
+	for(uint32_t i = 0; i < builder->opCount; i++) {
+		Worker_Op *op = &builder->ops[i];
+		if(op->op_type == WORKER_OP_TYPE_ADD_COMPONENT) {
+			Schema_DestroyComponentData(op->op.add_component.data.schema_type);
+		} else if(op->op_type == WORKER_OP_TYPE_COMMAND_REQUEST) {
+			Schema_DestroyCommandRequest(op->op.command_request.request.schema_type);
+		}
+	}
+	builder->opCount = 0;
+}
+
+static Worker_Op *addOp(OpListBuilder *builder, uint8_t opType)
+{
+	if(builder->opCount == builder->capacity) {
+		builder->capacity = builder->capacity == 0 ? 64 : 2 * builder->capacity;
+		builder->ops = realloc(builder->ops, builder->capacity * sizeof(Worker_Op));
+	}
+
+	Worker_Op *op = &builder->ops[builder->opCount++];
+	memset(op, 0, sizeof(Worker_Op));
+	op->op_type = opType;
+	return op;
+}
+
+static void addEntityWithComponent(OpListBuilder *builder, Worker_EntityId entityId, Worker_ComponentData componentData)
+{
+	Worker_Op *addEntityOp = addOp(builder, WORKER_OP_TYPE_ADD_ENTITY);
+	addEntityOp->op.add_entity.entity_id = entityId;
+
+	Worker_Op *addComponentOp = addOp(builder, WORKER_OP_TYPE_ADD_COMPONENT);
+	addComponentOp->op.add_component.entity_id = entityId;
+	addComponentOp->op.add_component.data = componentData;
+}
+
+static void addReserveEntityIdsResponse(OpListBuilder *builder, Worker_EntityId firstEntityId)
+{
+	Worker_Op *op = addOp(builder, WORKER_OP_TYPE_RESERVE_ENTITY_IDS_RESPONSE);
+	op->op.reserve_entity_ids_response.status_code = WORKER_STATUS_CODE_SUCCESS;
+	op->op.reserve_entity_ids_response.message = "";
+	op->op.reserve_entity_ids_response.first_entity_id = firstEntityId;
+	op->op.reserve_entity_ids_response.number_of_entity_ids = 1;
+}
+
+static Schema_Object *addCommandRequest(OpListBuilder *builder, Worker_RequestId requestId, uint32_t commandIndex)
+{
+	Worker_Op *op = addOp(builder, WORKER_OP_TYPE_COMMAND_REQUEST);
+	op->op.command_request.request_id = requestId;
+	op->op.command_request.entity_id = bootstrapEntityId;
+	op->op.command_request.caller_worker_entity_id = workerEntityId + 1;
+	op->op.command_request.request.component_id = shovelerWorkerSchemaComponentIdBootstrap;
+	op->op.command_request.request.command_index = commandIndex;
+	op->op.command_request.request.schema_type = Schema_CreateCommandRequest();
+
+	return Schema_GetCommandRequestObject(op->op.command_request.request.schema_type);
+}
+
+static void addVector3(Schema_Object *object, Schema_FieldId fieldId, float x, float y, float z)
+{
+	Schema_Object *vector = Schema_AddObject(object, fieldId);
+	Schema_AddFloat(vector, shovelerWorkerSchemaVector3FieldIdX, x);
+	Schema_AddFloat(vector, shovelerWorkerSchemaVector3FieldIdY, y);
+	Schema_AddFloat(vector, shovelerWorkerSchemaVector3FieldIdZ, z);
+}
+
+static uint32_t nextRandom(uint32_t *state)
+{
+	*state = *state * 1664525u + 1013904223u;
+	return *state >> 8;
+}
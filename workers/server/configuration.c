@@ -1,10 +1,26 @@
 #include "configuration.h"
 
+#include <stdlib.h> // free
+
 bool shovelerServerGetWorkerConfiguration(Worker_Connection *connection, ShovelerServerConfiguration *outputServerConfiguration)
 {
 	outputServerConfiguration->gameType = SHOVELER_WORKER_GAME_TYPE_LIGHTS;
+	outputServerConfiguration->metricsFile = NULL;
+	outputServerConfiguration->metricsFlushPeriodMs = 10000;
+	outputServerConfiguration->commandThreads = 0;
+	outputServerConfiguration->randomSeed = 0;
 
 	shovelerWorkerConfigurationParseGameTypeFlag(connection, "game_type", &outputServerConfiguration->gameType);
+	shovelerWorkerConfigurationParseStringFlag(connection, "metrics_file", &outputServerConfiguration->metricsFile);
+	shovelerWorkerConfigurationParseIntFlag(connection, "metrics_flush_period_ms", &outputServerConfiguration->metricsFlushPeriodMs);
+	shovelerWorkerConfigurationParseIntFlag(connection, "command_threads", &outputServerConfiguration->commandThreads);
+	shovelerWorkerConfigurationParseIntFlag(connection, "random_seed", &outputServerConfiguration->randomSeed);
 
 	return true;
 }
+
+void shovelerServerClearWorkerConfiguration(ShovelerServerConfiguration *serverConfiguration)
+{
+	free(serverConfiguration->metricsFile);
+	serverConfiguration->metricsFile = NULL;
+}
@@ -8,8 +8,16 @@
 
 typedef struct {
 	ShovelerWorkerGameType gameType;
+	/* JSON lines file to append server metrics to, or NULL to only collect them */
+	char *metricsFile;
+	int metricsFlushPeriodMs;
+	/* number of threads handling commands, or zero to handle them inline */
+	int commandThreads;
+	/* seed for player placement and colors, or zero to seed from the current time */
+	int randomSeed;
 } ShovelerServerConfiguration;
 
 bool shovelerServerGetWorkerConfiguration(Worker_Connection *connection, ShovelerServerConfiguration *outputServerConfiguration);
+void shovelerServerClearWorkerConfiguration(ShovelerServerConfiguration *serverConfiguration);
 
 #endif
@@ -0,0 +1,125 @@
+#include "heartbeat_wheel.h"
+
+#include <assert.h> // assert
+#include <stdlib.h> // malloc free
+
+static void linkEntry(ShovelerServerHeartbeatEntry *slot, ShovelerServerHeartbeatEntry *entry);
+
+ShovelerServerHeartbeatWheel *shovelerServerHeartbeatWheelCreate(int64_t slotDuration, int64_t horizon, int64_t now)
+{
+	assert(slotDuration > 0);
+	assert(now >= 0);
+
+	ShovelerServerHeartbeatWheel *wheel = malloc(sizeof(ShovelerServerHeartbeatWheel));
+	wheel->slotDuration = slotDuration;
+	wheel->numSlots = (int) (horizon / slotDuration) + 1;
+	wheel->slots = malloc(wheel->numSlots * sizeof(ShovelerServerHeartbeatEntry));
+	wheel->currentTick = now / slotDuration;
+
+	for(int i = 0; i < wheel->numSlots; i++) {
+		shovelerServerHeartbeatEntryInit(&wheel->slots[i], /* data */ NULL);
+	}
+
+	return wheel;
+}
+
+void shovelerServerHeartbeatEntryInit(ShovelerServerHeartbeatEntry *entry, void *data)
+{
+	entry->deadline = 0;
+	entry->data = data;
+	entry->previous = entry;
+	entry->next = entry;
+}
+
+void shovelerServerHeartbeatWheelSchedule(ShovelerServerHeartbeatWheel *wheel, ShovelerServerHeartbeatEntry *entry, int64_t deadline)
+{
+	shovelerServerHeartbeatEntryCancel(entry);
+
+	int64_t tick = deadline / wheel->slotDuration;
+	if(tick < wheel->currentTick) {
+		// already overdue, make sure the next expire call visits it
+		tick = wheel->currentTick;
+	}
+
+	entry->deadline = deadline;
+	linkEntry(&wheel->slots[tick % wheel->numSlots], entry);
+}
+
+int shovelerServerHeartbeatWheelExpire(ShovelerServerHeartbeatWheel *wheel, int64_t now, ShovelerServerHeartbeatExpireFunction *expire, void *userData)
+{
+	int64_t nowTick = now / wheel->slotDuration;
+	if(nowTick < wheel->currentTick) {
+		return 0;
+	}
+
+	int64_t lastTick = nowTick;
+	if(nowTick - wheel->currentTick >= wheel->numSlots) {
+		// fell behind by more than a revolution, visit every slot once
+		lastTick = wheel->currentTick + wheel->numSlots - 1;
+	}
+
+	// advance first so that entries rescheduled by the callback into the past land in the current slot
+	int64_t firstTick = wheel->currentTick;
+	wheel->currentTick = nowTick;
+
+	int numExpired = 0;
+	for(int64_t tick = firstTick; tick <= lastTick; tick++) {
+		ShovelerServerHeartbeatEntry *slot = &wheel->slots[tick % wheel->numSlots];
+
+		// detach the slot so the callback can safely reschedule into it
+		ShovelerServerHeartbeatEntry pending;
+		shovelerServerHeartbeatEntryInit(&pending, /* data */ NULL);
+		if(shovelerServerHeartbeatEntryIsScheduled(slot)) {
+			pending.next = slot->next;
+			pending.previous = slot->previous;
+			pending.next->previous = &pending;
+			pending.previous->next = &pending;
+			slot->next = slot;
+			slot->previous = slot;
+		}
+
+		while(shovelerServerHeartbeatEntryIsScheduled(&pending)) {
+			ShovelerServerHeartbeatEntry *entry = pending.next;
+			shovelerServerHeartbeatEntryCancel(entry);
+
+			if(entry->deadline > now) {
+				// later in this slot's tick or in a future revolution
+				linkEntry(slot, entry);
+				continue;
+			}
+
+			numExpired++;
+			expire(entry, now, userData);
+		}
+	}
+
+	return numExpired;
+}
+
+void shovelerServerHeartbeatWheelFree(ShovelerServerHeartbeatWheel *wheel)
+{
+	for(int i = 0; i < wheel->numSlots; i++) {
+		while(shovelerServerHeartbeatEntryIsScheduled(&wheel->slots[i])) {
+			shovelerServerHeartbeatEntryCancel(wheel->slots[i].next);
+		}
+	}
+
+	free(wheel->slots);
+	free(wheel);
+}
+
+void shovelerServerHeartbeatEntryCancel(ShovelerServerHeartbeatEntry *entry)
+{
+	entry->previous->next = entry->next;
+	entry->next->previous = entry->previous;
+	entry->previous = entry;
+	entry->next = entry;
+}
+
+static void linkEntry(ShovelerServerHeartbeatEntry *slot, ShovelerServerHeartbeatEntry *entry)
+{
+	entry->previous = slot->previous;
+	entry->next = slot;
+	slot->previous->next = entry;
+	slot->previous = entry;
+}
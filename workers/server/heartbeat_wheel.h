@@ -0,0 +1,54 @@
+#ifndef SHOVELER_SERVER_HEARTBEAT_WHEEL_H
+#define SHOVELER_SERVER_HEARTBEAT_WHEEL_H
+
+#include <stdbool.h> // bool
+#include <stdint.h> // int64_t
+
+typedef struct ShovelerServerHeartbeatEntryStruct {
+	int64_t deadline;
+	void *data;
+	/* intrusive links into the circular list of the wheel slot, pointing to itself if unscheduled */
+	struct ShovelerServerHeartbeatEntryStruct *previous;
+	struct ShovelerServerHeartbeatEntryStruct *next;
+} ShovelerServerHeartbeatEntry;
+
+typedef void (ShovelerServerHeartbeatExpireFunction)(ShovelerServerHeartbeatEntry *entry, int64_t now, void *userData);
+
+/**
+ * Hashed timing wheel tracking heartbeat deadlines.
+ *
+ * Every slot covers slotDuration of time and holds an intrusive list of the entries whose deadline
+ * falls into it, so rescheduling an entry on a received heartbeat is O(1), and expiring only visits
+ * the slots that passed since the last call. Deadlines further away than numSlots * slotDuration
+ * are allowed, they just stay in their slot for another revolution.
+ */
+typedef struct {
+	int64_t slotDuration;
+	int numSlots;
+	/* array of numSlots sentinel entries */
+	ShovelerServerHeartbeatEntry *slots;
+	/* tick (time / slotDuration) of the earliest slot that may still contain unexpired entries */
+	int64_t currentTick;
+} ShovelerServerHeartbeatWheel;
+
+ShovelerServerHeartbeatWheel *shovelerServerHeartbeatWheelCreate(int64_t slotDuration, int64_t horizon, int64_t now);
+void shovelerServerHeartbeatEntryInit(ShovelerServerHeartbeatEntry *entry, void *data);
+/** Schedules or reschedules the entry to expire at the given deadline in O(1). */
+void shovelerServerHeartbeatWheelSchedule(ShovelerServerHeartbeatWheel *wheel, ShovelerServerHeartbeatEntry *entry, int64_t deadline);
+/**
+ * Unschedules all entries with a deadline at or before now and calls expire on each of them.
+ *
+ * The callback may reschedule or cancel the expired entry. Returns the number of expired entries.
+ */
+int shovelerServerHeartbeatWheelExpire(ShovelerServerHeartbeatWheel *wheel, int64_t now, ShovelerServerHeartbeatExpireFunction *expire, void *userData);
+void shovelerServerHeartbeatWheelFree(ShovelerServerHeartbeatWheel *wheel);
+
+/** Unschedules the entry if it is scheduled, which doesn't require access to its wheel. */
+void shovelerServerHeartbeatEntryCancel(ShovelerServerHeartbeatEntry *entry);
+
+static inline bool shovelerServerHeartbeatEntryIsScheduled(ShovelerServerHeartbeatEntry *entry)
+{
+	return entry->next != entry;
+}
+
+#endif
@@ -0,0 +1,266 @@
+/**
+ * Checks that the heartbeat wheel expires entries in the tick of their deadline, that rescheduling
+ * on a received heartbeat moves the deadline, and that deadlines beyond the horizon survive the
+ * revolutions before them.
+ *
+ * Usage: heartbeat_wheel_test
+ */
+#include <inttypes.h> // PRId64
+#include <stdbool.h> // bool
+#include <stdint.h> // int64_t
+#include <stdio.h> // fprintf printf
+#include <stdlib.h> // EXIT_FAILURE EXIT_SUCCESS
+
+#include "heartbeat_wheel.h"
+
+typedef struct {
+	int numExpired;
+	int64_t lastExpireTime;
+	/* deadline to reschedule expired entries to, or zero to leave them unscheduled */
+	int64_t rescheduleDeadline;
+	ShovelerServerHeartbeatWheel *wheel;
+} Expirer;
+
+static bool testExpireInDeadlineTick();
+static bool testReschedule();
+static bool testRescheduleOnExpire();
+static bool testWrapAround();
+static bool testFallBehind();
+static bool checkExpire(const char *testName, ShovelerServerHeartbeatWheel *wheel, Expirer *expirer, int64_t now, int expectedNumExpired);
+static void expire(ShovelerServerHeartbeatEntry *entry, int64_t now, void *expirerPointer);
+
+/* the server's defaults: cleanup at 2Hz with a maximum heartbeat timeout of 5s, i.e. 21 slots */
+static const int64_t slotDuration = 500000;
+static const int64_t horizon = 2 * 1000 * 5000;
+static const int64_t startTime = 1000000;
+
+int main(int argc, char **argv)
+{
+	if(argc != 1) {
+		fprintf(stderr, "Usage:\n\t%s\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	bool success = true;
+	success = testExpireInDeadlineTick() && success;
+	success = testReschedule() && success;
+	success = testRescheduleOnExpire() && success;
+	success = testWrapAround() && success;
+	success = testFallBehind() && success;
+
+	if(!success) {
+		return EXIT_FAILURE;
+	}
+
+	printf("All heartbeat wheel tests passed.\n");
+	return EXIT_SUCCESS;
+}
+
+static bool testExpireInDeadlineTick()
+{
+	const char *testName = "expire in deadline tick";
+	ShovelerServerHeartbeatWheel *wheel = shovelerServerHeartbeatWheelCreate(slotDuration, horizon, startTime);
+	Expirer expirer = {0, 0, 0, wheel};
+
+	// in the middle of the fourth slot after the start
+	int64_t deadline = startTime + 3 * slotDuration + slotDuration / 2;
+	ShovelerServerHeartbeatEntry entry;
+	shovelerServerHeartbeatEntryInit(&entry, /* data */ NULL);
+	shovelerServerHeartbeatWheelSchedule(wheel, &entry, deadline);
+
+	bool success = true;
+	for(int64_t now = startTime; now < deadline; now += slotDuration / 4) {
+		success = checkExpire(testName, wheel, &expirer, now, 0) && success;
+	}
+	success = checkExpire(testName, wheel, &expirer, deadline - 1, 0) && success;
+	success = checkExpire(testName, wheel, &expirer, deadline, 1) && success;
+	success = checkExpire(testName, wheel, &expirer, deadline + slotDuration, 0) && success;
+
+	if(expirer.lastExpireTime != deadline) {
+		fprintf(stderr, "%s: expired at %" PRId64 " instead of %" PRId64 "\n", testName, expirer.lastExpireTime, deadline);
+		success = false;
+	}
+
+	if(shovelerServerHeartbeatEntryIsScheduled(&entry)) {
+		fprintf(stderr, "%s: entry is still scheduled after expiring\n", testName);
+		success = false;
+	}
+
+	shovelerServerHeartbeatWheelFree(wheel);
+	return success;
+}
+
+static bool testReschedule()
+{
+	const char *testName = "reschedule";
+	ShovelerServerHeartbeatWheel *wheel = shovelerServerHeartbeatWheelCreate(slotDuration, horizon, startTime);
+	Expirer expirer = {0, 0, 0, wheel};
+
+	ShovelerServerHeartbeatEntry entry;
+	shovelerServerHeartbeatEntryInit(&entry, /* data */ NULL);
+	shovelerServerHeartbeatWheelSchedule(wheel, &entry, startTime + 2 * slotDuration);
+
+	// a heartbeat arrives before the deadline and pushes it back by a few slots
+	bool success = checkExpire(testName, wheel, &expirer, startTime + slotDuration, 0);
+	int64_t deadline = startTime + 6 * slotDuration;
+	shovelerServerHeartbeatWheelSchedule(wheel, &entry, deadline);
+
+	success = checkExpire(testName, wheel, &expirer, startTime + 2 * slotDuration, 0) && success;
+	success = checkExpire(testName, wheel, &expirer, deadline - 1, 0) && success;
+	success = checkExpire(testName, wheel, &expirer, deadline, 1) && success;
+
+	// rescheduling an expired entry schedules it again, even with an overdue deadline
+	shovelerServerHeartbeatWheelSchedule(wheel, &entry, deadline - 3 * slotDuration);
+	success = checkExpire(testName, wheel, &expirer, deadline, 1) && success;
+
+	// a cancelled entry never expires
+	shovelerServerHeartbeatWheelSchedule(wheel, &entry, deadline + slotDuration);
+	shovelerServerHeartbeatEntryCancel(&entry);
+	success = checkExpire(testName, wheel, &expirer, deadline + 2 * slotDuration, 0) && success;
+
+	shovelerServerHeartbeatWheelFree(wheel);
+	return success;
+}
+
+static bool testRescheduleOnExpire()
+{
+	const char *testName = "reschedule on expire";
+	ShovelerServerHeartbeatWheel *wheel = shovelerServerHeartbeatWheelCreate(slotDuration, horizon, startTime);
+	Expirer expirer = {0, 0, 0, wheel};
+
+	// like the grace period of a new client being replaced by its regular heartbeat timeout
+	int64_t deadline = startTime + slotDuration;
+	int64_t rescheduleDeadline = deadline + 4 * slotDuration;
+	ShovelerServerHeartbeatEntry entry;
+	shovelerServerHeartbeatEntryInit(&entry, /* data */ NULL);
+	shovelerServerHeartbeatWheelSchedule(wheel, &entry, deadline);
+
+	expirer.rescheduleDeadline = rescheduleDeadline;
+	bool success = checkExpire(testName, wheel, &expirer, deadline, 1);
+	expirer.rescheduleDeadline = 0;
+
+	if(!shovelerServerHeartbeatEntryIsScheduled(&entry)) {
+		fprintf(stderr, "%s: entry rescheduled by the expire callback isn't scheduled\n", testName);
+		success = false;
+	}
+
+	success = checkExpire(testName, wheel, &expirer, rescheduleDeadline - 1, 0) && success;
+	success = checkExpire(testName, wheel, &expirer, rescheduleDeadline, 1) && success;
+
+	shovelerServerHeartbeatWheelFree(wheel);
+	return success;
+}
+
+static bool testWrapAround()
+{
+	const char *testName = "wrap around";
+	ShovelerServerHeartbeatWheel *wheel = shovelerServerHeartbeatWheelCreate(slotDuration, horizon, startTime);
+	Expirer expirer = {0, 0, 0, wheel};
+
+	bool success = true;
+	if(wheel->numSlots != 21) {
+		fprintf(stderr, "%s: expected 21 slots but got %d\n", testName, wheel->numSlots);
+		success = false;
+	}
+
+	// deadlines one and two revolutions ahead share their slot with the slot of the first tick
+	int64_t revolution = wheel->numSlots * slotDuration;
+	ShovelerServerHeartbeatEntry nearEntry;
+	ShovelerServerHeartbeatEntry farEntry;
+	ShovelerServerHeartbeatEntry furthestEntry;
+	shovelerServerHeartbeatEntryInit(&nearEntry, /* data */ NULL);
+	shovelerServerHeartbeatEntryInit(&farEntry, /* data */ NULL);
+	shovelerServerHeartbeatEntryInit(&furthestEntry, /* data */ NULL);
+	shovelerServerHeartbeatWheelSchedule(wheel, &nearEntry, startTime + slotDuration / 2);
+	shovelerServerHeartbeatWheelSchedule(wheel, &farEntry, startTime + revolution + slotDuration / 2);
+	shovelerServerHeartbeatWheelSchedule(wheel, &furthestEntry, startTime + 2 * revolution + slotDuration / 2);
+
+	// expire every tick, passing the shared slot three times
+	int numExpiredNear = 0;
+	int numExpiredFar = 0;
+	int numExpiredFurthest = 0;
+	for(int64_t now = startTime; now <= startTime + 2 * revolution + slotDuration; now += slotDuration / 2) {
+		expirer.numExpired = 0;
+		shovelerServerHeartbeatWheelExpire(wheel, now, expire, &expirer);
+		if(expirer.numExpired == 0) {
+			continue;
+		}
+
+		if(now == startTime + slotDuration / 2) {
+			numExpiredNear += expirer.numExpired;
+		} else if(now == startTime + revolution + slotDuration / 2) {
+			numExpiredFar += expirer.numExpired;
+		} else if(now == startTime + 2 * revolution + slotDuration / 2) {
+			numExpiredFurthest += expirer.numExpired;
+		} else {
+			fprintf(stderr, "%s: %d entries expired at unexpected time %" PRId64 "\n", testName, expirer.numExpired, now);
+			success = false;
+		}
+	}
+
+	if(numExpiredNear != 1 || numExpiredFar != 1 || numExpiredFurthest != 1) {
+		fprintf(stderr, "%s: expected one expiry per revolution but got %d, %d and %d\n", testName, numExpiredNear, numExpiredFar, numExpiredFurthest);
+		success = false;
+	}
+
+	shovelerServerHeartbeatWheelFree(wheel);
+	return success;
+}
+
+static bool testFallBehind()
+{
+	const char *testName = "fall behind";
+	ShovelerServerHeartbeatWheel *wheel = shovelerServerHeartbeatWheelCreate(slotDuration, horizon, startTime);
+	Expirer expirer = {0, 0, 0, wheel};
+
+	// one entry in every slot, and one more than a revolution ahead of the late expire call
+	ShovelerServerHeartbeatEntry entries[21];
+	int numEntries = sizeof(entries) / sizeof(entries[0]);
+	for(int i = 0; i < numEntries; i++) {
+		shovelerServerHeartbeatEntryInit(&entries[i], /* data */ NULL);
+		shovelerServerHeartbeatWheelSchedule(wheel, &entries[i], startTime + i * slotDuration);
+	}
+
+	int64_t lateTime = startTime + 3 * wheel->numSlots * slotDuration;
+	ShovelerServerHeartbeatEntry laterEntry;
+	shovelerServerHeartbeatEntryInit(&laterEntry, /* data */ NULL);
+	shovelerServerHeartbeatWheelSchedule(wheel, &laterEntry, lateTime + wheel->numSlots * slotDuration);
+
+	// the server stalled for three revolutions, so the next call visits every slot once
+	bool success = checkExpire(testName, wheel, &expirer, lateTime, numEntries);
+	success = checkExpire(testName, wheel, &expirer, lateTime + wheel->numSlots * slotDuration - 1, 0) && success;
+	success = checkExpire(testName, wheel, &expirer, lateTime + wheel->numSlots * slotDuration, 1) && success;
+
+	shovelerServerHeartbeatWheelFree(wheel);
+	return success;
+}
+
+static bool checkExpire(const char *testName, ShovelerServerHeartbeatWheel *wheel, Expirer *expirer, int64_t now, int expectedNumExpired)
+{
+	expirer->numExpired = 0;
+	int numExpired = shovelerServerHeartbeatWheelExpire(wheel, now, expire, expirer);
+
+	bool success = true;
+	if(numExpired != expectedNumExpired) {
+		fprintf(stderr, "%s: expected %d entries to expire at %" PRId64 " but %d did\n", testName, expectedNumExpired, now, numExpired);
+		success = false;
+	}
+
+	if(expirer->numExpired != numExpired) {
+		fprintf(stderr, "%s: expire returned %d entries but called back %d times\n", testName, numExpired, expirer->numExpired);
+		success = false;
+	}
+
+	return success;
+}
+
+static void expire(ShovelerServerHeartbeatEntry *entry, int64_t now, void *expirerPointer)
+{
+	Expirer *expirer = expirerPointer;
+	expirer->numExpired++;
+	expirer->lastExpireTime = now;
+
+	if(expirer->rescheduleDeadline > 0) {
+		shovelerServerHeartbeatWheelSchedule(expirer->wheel, entry, expirer->rescheduleDeadline);
+	}
+}
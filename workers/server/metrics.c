@@ -0,0 +1,277 @@
+#include "metrics.h"
+
+#include <errno.h> // errno
+#include <inttypes.h> // PRId64
+#include <stdbool.h> // bool
+#include <stdlib.h> // malloc free
+#include <string.h> // memset strerror
+
+#include <glib.h>
+#include <improbable/c_worker.h>
+#include <shoveler/log.h>
+
+#define NUM_LINEAR_BUCKETS 8
+#define SUB_BUCKET_BITS 3
+
+static const char *handlerNames[SHOVELER_SERVER_NUM_HANDLERS] = {
+	"add_component",
+	"component_update",
+	"authority_change",
+	"create_client_entity",
+	"client_spawn_cube",
+	"dig_hole",
+	"update_resource",
+	"client_cleanup",
+};
+
+static void clearMetrics(ShovelerServerMetrics *metrics, int64_t now);
+static void writeHistogram(FILE *file, const char *name, const ShovelerServerHistogram *histogram);
+static const char *getOpTypeName(uint8_t opType);
+static int getBucket(int64_t value);
+static int64_t getBucketUpperBound(int bucket);
+
+ShovelerServerMetrics *shovelerServerMetricsCreate(const char *filename, int64_t now)
+{
+	FILE *file = NULL;
+	if(filename != NULL) {
+		file = fopen(filename, "a");
+		if(file == NULL) {
+			shovelerLogWarning("Failed to open server metrics file '%s', only collecting metrics: %s", filename, strerror(errno));
+		} else {
+			shovelerLogInfo("Writing server metrics to '%s'.", filename);
+		}
+	}
+
+	ShovelerServerMetrics *metrics = malloc(sizeof(ShovelerServerMetrics));
+	metrics->file = file;
+	clearMetrics(metrics, now);
+
+	return metrics;
+}
+
+void shovelerServerMetricsBeginTick(ShovelerServerMetrics *metrics, int64_t now)
+{
+	metrics->tickStart = now;
+	metrics->numOpsThisTick = 0;
+}
+
+void shovelerServerMetricsEndTick(ShovelerServerMetrics *metrics, int64_t now)
+{
+	shovelerServerHistogramAdd(&metrics->tickDurations, now - metrics->tickStart);
+	shovelerServerHistogramAdd(&metrics->opsPerTick, metrics->numOpsThisTick);
+}
+
+void shovelerServerMetricsRecordOp(ShovelerServerMetrics *metrics, uint8_t opType)
+{
+	if(opType < SHOVELER_SERVER_METRICS_NUM_OP_TYPES) {
+		metrics->opCounts[opType]++;
+	}
+	metrics->numOpsThisTick++;
+}
+
+void shovelerServerMetricsRecordHandler(ShovelerServerMetrics *metrics, ShovelerServerHandler handler, int64_t duration)
+{
+	shovelerServerHistogramAdd(&metrics->handlerDurations[handler], duration);
+}
+
+void shovelerServerMetricsRecordComponentUpdateSent(ShovelerServerMetrics *metrics, int64_t numBytes)
+{
+	metrics->numComponentUpdatesSent++;
+	metrics->componentUpdateBytesSent += numBytes;
+}
+
+void shovelerServerMetricsFlush(ShovelerServerMetrics *metrics, int64_t now)
+{
+	if(metrics->file != NULL) {
+		FILE *file = metrics->file;
+
+		fprintf(file, "{\"timestamp_us\":%"PRId64",\"interval_us\":%"PRId64",", g_get_real_time(), now - metrics->intervalStart);
+		writeHistogram(file, "tick_duration_us", &metrics->tickDurations);
+		fprintf(file, ",");
+		writeHistogram(file, "ops_per_tick", &metrics->opsPerTick);
+
+		fprintf(file, ",\"ops\":{");
+		bool first = true;
+		for(int opType = 0; opType < SHOVELER_SERVER_METRICS_NUM_OP_TYPES; opType++) {
+			if(metrics->opCounts[opType] == 0) {
+				continue;
+			}
+
+			fprintf(file, "%s\"%s\":%"PRId64, first ? "" : ",", getOpTypeName((uint8_t) opType), metrics->opCounts[opType]);
+			first = false;
+		}
+
+		fprintf(file, "},\"handler_duration_us\":{");
+		for(int handler = 0; handler < SHOVELER_SERVER_NUM_HANDLERS; handler++) {
+			if(handler > 0) {
+				fprintf(file, ",");
+			}
+			writeHistogram(file, handlerNames[handler], &metrics->handlerDurations[handler]);
+		}
+
+		fprintf(
+			file,
+			"},\"component_updates_sent\":%"PRId64",\"component_update_bytes_sent\":%"PRId64"}\n",
+			metrics->numComponentUpdatesSent,
+			metrics->componentUpdateBytesSent);
+		fflush(file);
+	}
+
+	clearMetrics(metrics, now);
+}
+
+void shovelerServerMetricsFree(ShovelerServerMetrics *metrics)
+{
+	if(metrics->file != NULL) {
+		fclose(metrics->file);
+	}
+
+	free(metrics);
+}
+
+void shovelerServerHistogramAdd(ShovelerServerHistogram *histogram, int64_t value)
+{
+	if(value < 0) {
+		value = 0;
+	}
+
+	histogram->count++;
+	histogram->sum += value;
+	if(value > histogram->max) {
+		histogram->max = value;
+	}
+	histogram->buckets[getBucket(value)]++;
+}
+
+int64_t shovelerServerHistogramGetQuantile(const ShovelerServerHistogram *histogram, double quantile)
+{
+	if(histogram->count == 0) {
+		return 0;
+	}
+
+	int64_t rank = (int64_t) (quantile * (double) histogram->count + 0.5);
+	if(rank < 1) {
+		rank = 1;
+	}
+
+	int64_t numSeen = 0;
+	for(int bucket = 0; bucket < SHOVELER_SERVER_HISTOGRAM_NUM_BUCKETS; bucket++) {
+		numSeen += histogram->buckets[bucket];
+		if(numSeen >= rank) {
+			if(bucket == SHOVELER_SERVER_HISTOGRAM_NUM_BUCKETS - 1) {
+				// the last bucket also holds everything that overflowed
+				return histogram->max;
+			}
+
+			int64_t upperBound = getBucketUpperBound(bucket);
+			return upperBound < histogram->max ? upperBound : histogram->max;
+		}
+	}
+
+	return histogram->max;
+}
+
+void shovelerServerHistogramClear(ShovelerServerHistogram *histogram)
+{
+	memset(histogram, 0, sizeof(ShovelerServerHistogram));
+}
+
+static void clearMetrics(ShovelerServerMetrics *metrics, int64_t now)
+{
+	metrics->intervalStart = now;
+	metrics->tickStart = now;
+	metrics->numOpsThisTick = 0;
+	shovelerServerHistogramClear(&metrics->tickDurations);
+	shovelerServerHistogramClear(&metrics->opsPerTick);
+	memset(metrics->opCounts, 0, sizeof(metrics->opCounts));
+	for(int handler = 0; handler < SHOVELER_SERVER_NUM_HANDLERS; handler++) {
+		shovelerServerHistogramClear(&metrics->handlerDurations[handler]);
+	}
+	metrics->numComponentUpdatesSent = 0;
+	metrics->componentUpdateBytesSent = 0;
+}
+
+static void writeHistogram(FILE *file, const char *name, const ShovelerServerHistogram *histogram)
+{
+	fprintf(
+		file,
+		"\"%s\":{\"count\":%"PRId64",\"sum\":%"PRId64",\"p50\":%"PRId64",\"p99\":%"PRId64",\"max\":%"PRId64"}",
+		name,
+		histogram->count,
+		histogram->sum,
+		shovelerServerHistogramGetQuantile(histogram, 0.5),
+		shovelerServerHistogramGetQuantile(histogram, 0.99),
+		histogram->max);
+}
+
+static const char *getOpTypeName(uint8_t opType)
+{
+	switch(opType) {
+		case WORKER_OP_TYPE_DISCONNECT:
+			return "disconnect";
+		case WORKER_OP_TYPE_FLAG_UPDATE:
+			return "flag_update";
+		case WORKER_OP_TYPE_METRICS:
+			return "metrics";
+		case WORKER_OP_TYPE_CRITICAL_SECTION:
+			return "critical_section";
+		case WORKER_OP_TYPE_ADD_ENTITY:
+			return "add_entity";
+		case WORKER_OP_TYPE_REMOVE_ENTITY:
+			return "remove_entity";
+		case WORKER_OP_TYPE_RESERVE_ENTITY_IDS_RESPONSE:
+			return "reserve_entity_ids_response";
+		case WORKER_OP_TYPE_CREATE_ENTITY_RESPONSE:
+			return "create_entity_response";
+		case WORKER_OP_TYPE_DELETE_ENTITY_RESPONSE:
+			return "delete_entity_response";
+		case WORKER_OP_TYPE_ENTITY_QUERY_RESPONSE:
+			return "entity_query_response";
+		case WORKER_OP_TYPE_ADD_COMPONENT:
+			return "add_component";
+		case WORKER_OP_TYPE_REMOVE_COMPONENT:
+			return "remove_component";
+		case WORKER_OP_TYPE_COMPONENT_SET_AUTHORITY_CHANGE:
+			return "component_set_authority_change";
+		case WORKER_OP_TYPE_COMPONENT_UPDATE:
+			return "component_update";
+		case WORKER_OP_TYPE_COMMAND_REQUEST:
+			return "command_request";
+		case WORKER_OP_TYPE_COMMAND_RESPONSE:
+			return "command_response";
+		default:
+			return "unknown";
+	}
+}
+
+static int getBucket(int64_t value)
+{
+	if(value < NUM_LINEAR_BUCKETS) {
+		return (int) value;
+	}
+
+	int exponent = 0;
+	for(int64_t remaining = value; remaining > 1; remaining >>= 1) {
+		exponent++;
+	}
+
+	int subBucket = (int) ((value >> (exponent - SUB_BUCKET_BITS)) & (NUM_LINEAR_BUCKETS - 1));
+	int bucket = NUM_LINEAR_BUCKETS + (exponent - SUB_BUCKET_BITS) * NUM_LINEAR_BUCKETS + subBucket;
+	if(bucket >= SHOVELER_SERVER_HISTOGRAM_NUM_BUCKETS) {
+		return SHOVELER_SERVER_HISTOGRAM_NUM_BUCKETS - 1;
+	}
+
+	return bucket;
+}
+
+static int64_t getBucketUpperBound(int bucket)
+{
+	if(bucket < NUM_LINEAR_BUCKETS) {
+		return bucket;
+	}
+
+	int shift = (bucket - NUM_LINEAR_BUCKETS) / NUM_LINEAR_BUCKETS;
+	int subBucket = (bucket - NUM_LINEAR_BUCKETS) % NUM_LINEAR_BUCKETS;
+	int64_t lowerBound = ((int64_t) (NUM_LINEAR_BUCKETS + subBucket)) << shift;
+	return lowerBound + (((int64_t) 1) << shift) - 1;
+}
@@ -0,0 +1,70 @@
+#ifndef SHOVELER_SERVER_METRICS_H
+#define SHOVELER_SERVER_METRICS_H
+
+#include <stdint.h> // int64_t uint8_t
+#include <stdio.h> // FILE
+
+#define SHOVELER_SERVER_METRICS_NUM_OP_TYPES 32
+#define SHOVELER_SERVER_HISTOGRAM_NUM_BUCKETS 304
+
+typedef enum {
+	SHOVELER_SERVER_HANDLER_ADD_COMPONENT,
+	SHOVELER_SERVER_HANDLER_COMPONENT_UPDATE,
+	SHOVELER_SERVER_HANDLER_AUTHORITY_CHANGE,
+	SHOVELER_SERVER_HANDLER_CREATE_CLIENT_ENTITY,
+	SHOVELER_SERVER_HANDLER_CLIENT_SPAWN_CUBE,
+	SHOVELER_SERVER_HANDLER_DIG_HOLE,
+	SHOVELER_SERVER_HANDLER_UPDATE_RESOURCE,
+	SHOVELER_SERVER_HANDLER_CLIENT_CLEANUP,
+	SHOVELER_SERVER_NUM_HANDLERS,
+} ShovelerServerHandler;
+
+/**
+ * Log-linear histogram of non-negative values, with eight buckets per power of two so that
+ * quantiles are accurate to within 12.5%.
+ */
+typedef struct {
+	int64_t count;
+	int64_t sum;
+	int64_t max;
+	int64_t buckets[SHOVELER_SERVER_HISTOGRAM_NUM_BUCKETS];
+} ShovelerServerHistogram;
+
+/**
+ * Tick and op handling instrumentation of the server worker.
+ *
+ * Everything is accumulated over a flush interval, after which it is appended as a single JSON
+ * line to the metrics file, if one was given, and reset. Tick durations only cover processing an
+ * op list and the work following it, not waiting for the next op list. All times are in
+ * microseconds of g_get_monotonic_time.
+ */
+typedef struct {
+	FILE *file;
+	int64_t intervalStart;
+	int64_t tickStart;
+	int64_t numOpsThisTick;
+	ShovelerServerHistogram tickDurations;
+	ShovelerServerHistogram opsPerTick;
+	int64_t opCounts[SHOVELER_SERVER_METRICS_NUM_OP_TYPES];
+	ShovelerServerHistogram handlerDurations[SHOVELER_SERVER_NUM_HANDLERS];
+	int64_t numComponentUpdatesSent;
+	int64_t componentUpdateBytesSent;
+} ShovelerServerMetrics;
+
+/** Creates metrics that are appended to the given file on flush, or only collected if filename is NULL. */
+ShovelerServerMetrics *shovelerServerMetricsCreate(const char *filename, int64_t now);
+void shovelerServerMetricsBeginTick(ShovelerServerMetrics *metrics, int64_t now);
+void shovelerServerMetricsEndTick(ShovelerServerMetrics *metrics, int64_t now);
+void shovelerServerMetricsRecordOp(ShovelerServerMetrics *metrics, uint8_t opType);
+void shovelerServerMetricsRecordHandler(ShovelerServerMetrics *metrics, ShovelerServerHandler handler, int64_t duration);
+void shovelerServerMetricsRecordComponentUpdateSent(ShovelerServerMetrics *metrics, int64_t numBytes);
+/** Writes the metrics accumulated since the last flush as one JSON line and resets them. */
+void shovelerServerMetricsFlush(ShovelerServerMetrics *metrics, int64_t now);
+void shovelerServerMetricsFree(ShovelerServerMetrics *metrics);
+
+void shovelerServerHistogramAdd(ShovelerServerHistogram *histogram, int64_t value);
+/** Returns an upper bound for the given quantile in [0, 1], which is exact for the maximum. */
+int64_t shovelerServerHistogramGetQuantile(const ShovelerServerHistogram *histogram, double quantile);
+void shovelerServerHistogramClear(ShovelerServerHistogram *histogram);
+
+#endif
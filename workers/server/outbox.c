@@ -0,0 +1,145 @@
+#include "outbox.h"
+
+#include <inttypes.h> // PRId64
+#include <stdlib.h> // malloc free
+#include <string.h> // memcpy strdup
+
+#include <improbable/c_schema.h>
+#include <shoveler/log.h>
+
+static void destroyMessage(ShovelerServerMessage *message);
+
+void shovelerServerOutboxInit(ShovelerServerOutbox *outbox, Worker_RequestId requestId)
+{
+	outbox->requestId = requestId;
+	outbox->messages = g_array_new(/* zeroTerminated */ false, /* clear */ false, sizeof(ShovelerServerMessage));
+}
+
+void shovelerServerOutboxAddComponentUpdate(ShovelerServerOutbox *outbox, Worker_EntityId entityId, Worker_ComponentUpdate *componentUpdate)
+{
+	ShovelerServerMessage message;
+	message.type = SHOVELER_SERVER_MESSAGE_TYPE_COMPONENT_UPDATE;
+	message.componentUpdate.entityId = entityId;
+	message.componentUpdate.componentUpdate = *componentUpdate;
+	g_array_append_val(outbox->messages, message);
+}
+
+void shovelerServerOutboxAddCreateEntityRequest(ShovelerServerOutbox *outbox, uint32_t componentCount, const Worker_ComponentData *components, const Worker_EntityId *entityId)
+{
+	ShovelerServerMessage message;
+	message.type = SHOVELER_SERVER_MESSAGE_TYPE_CREATE_ENTITY_REQUEST;
+	message.createEntityRequest.componentCount = componentCount;
+	message.createEntityRequest.components = malloc(componentCount * sizeof(Worker_ComponentData));
+	memcpy(message.createEntityRequest.components, components, componentCount * sizeof(Worker_ComponentData));
+	message.createEntityRequest.hasEntityId = entityId != NULL;
+	message.createEntityRequest.entityId = entityId != NULL ? *entityId : 0;
+	g_array_append_val(outbox->messages, message);
+}
+
+void shovelerServerOutboxAddCommandResponse(ShovelerServerOutbox *outbox, Worker_CommandResponse *commandResponse, const char *commandName)
+{
+	ShovelerServerMessage message;
+	message.type = SHOVELER_SERVER_MESSAGE_TYPE_COMMAND_RESPONSE;
+	message.commandResponse.commandResponse = *commandResponse;
+	message.commandResponse.commandName = commandName;
+	g_array_append_val(outbox->messages, message);
+}
+
+void shovelerServerOutboxAddCommandFailure(ShovelerServerOutbox *outbox, const char *message)
+{
+	ShovelerServerMessage failureMessage;
+	failureMessage.type = SHOVELER_SERVER_MESSAGE_TYPE_COMMAND_FAILURE;
+	failureMessage.commandFailure.message = strdup(message);
+	g_array_append_val(outbox->messages, failureMessage);
+}
+
+void shovelerServerOutboxFlush(ShovelerServerOutbox *outbox, Worker_Connection *connection, ShovelerServerMetrics *metrics)
+{
+	guint i = 0;
+	for(; i < outbox->messages->len; i++) {
+		ShovelerServerMessage *message = &g_array_index(outbox->messages, ShovelerServerMessage, i);
+
+		bool aborted = false;
+		switch(message->type) {
+			case SHOVELER_SERVER_MESSAGE_TYPE_COMPONENT_UPDATE: {
+				// measure before sending since the connection takes ownership of the update
+				Worker_ComponentUpdate *componentUpdate = &message->componentUpdate.componentUpdate;
+				Schema_Object *fields = Schema_GetComponentUpdateFields(componentUpdate->schema_type);
+				shovelerServerMetricsRecordComponentUpdateSent(metrics, Schema_GetWriteBufferLength(fields));
+
+				Worker_Connection_SendComponentUpdate(connection, message->componentUpdate.entityId, componentUpdate);
+			} break;
+			case SHOVELER_SERVER_MESSAGE_TYPE_CREATE_ENTITY_REQUEST: {
+				Worker_RequestId createEntityRequestId = Worker_Connection_SendCreateEntityRequest(
+					connection,
+					message->createEntityRequest.componentCount,
+					message->createEntityRequest.components,
+					message->createEntityRequest.hasEntityId ? &message->createEntityRequest.entityId : NULL,
+					/* timeout_millis */ NULL);
+				free(message->createEntityRequest.components);
+
+				if(createEntityRequestId == -1) {
+					shovelerLogError("Failed to send create entity request.");
+					Worker_Connection_SendCommandFailure(connection, outbox->requestId, "entity creation failure");
+					aborted = true;
+					break;
+				}
+
+				shovelerLogInfo("Sent create entity request %"PRId64"", createEntityRequestId);
+			} break;
+			case SHOVELER_SERVER_MESSAGE_TYPE_COMMAND_RESPONSE: {
+				int8_t result = Worker_Connection_SendCommandResponse(connection, outbox->requestId, &message->commandResponse.commandResponse);
+				if(result == WORKER_RESULT_FAILURE) {
+					shovelerLogError("Failed to send %s response.", message->commandResponse.commandName);
+				}
+			} break;
+			case SHOVELER_SERVER_MESSAGE_TYPE_COMMAND_FAILURE:
+				Worker_Connection_SendCommandFailure(connection, outbox->requestId, message->commandFailure.message);
+				free(message->commandFailure.message);
+				break;
+		}
+
+		if(aborted) {
+			break;
+		}
+	}
+
+	// the failed message was already consumed, only destroy the ones after it
+	for(i++; i < outbox->messages->len; i++) {
+		destroyMessage(&g_array_index(outbox->messages, ShovelerServerMessage, i));
+	}
+
+	g_array_free(outbox->messages, /* freeSegment */ true);
+	outbox->messages = NULL;
+}
+
+void shovelerServerOutboxDiscard(ShovelerServerOutbox *outbox)
+{
+	for(guint i = 0; i < outbox->messages->len; i++) {
+		destroyMessage(&g_array_index(outbox->messages, ShovelerServerMessage, i));
+	}
+
+	g_array_free(outbox->messages, /* freeSegment */ true);
+	outbox->messages = NULL;
+}
+
+static void destroyMessage(ShovelerServerMessage *message)
+{
+	switch(message->type) {
+		case SHOVELER_SERVER_MESSAGE_TYPE_COMPONENT_UPDATE:
+			Schema_DestroyComponentUpdate(message->componentUpdate.componentUpdate.schema_type);
+			break;
+		case SHOVELER_SERVER_MESSAGE_TYPE_CREATE_ENTITY_REQUEST:
+			for(uint32_t i = 0; i < message->createEntityRequest.componentCount; i++) {
+				Schema_DestroyComponentData(message->createEntityRequest.components[i].schema_type);
+			}
+			free(message->createEntityRequest.components);
+			break;
+		case SHOVELER_SERVER_MESSAGE_TYPE_COMMAND_RESPONSE:
+			Schema_DestroyCommandResponse(message->commandResponse.commandResponse.schema_type);
+			break;
+		case SHOVELER_SERVER_MESSAGE_TYPE_COMMAND_FAILURE:
+			free(message->commandFailure.message);
+			break;
+	}
+}
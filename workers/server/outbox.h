@@ -0,0 +1,70 @@
+#ifndef SHOVELER_SERVER_OUTBOX_H
+#define SHOVELER_SERVER_OUTBOX_H
+
+#include <stdbool.h> // bool
+#include <stdint.h> // uint32_t
+
+#include <glib.h>
+#include <improbable/c_worker.h>
+
+#include "metrics.h"
+
+typedef enum {
+	SHOVELER_SERVER_MESSAGE_TYPE_COMPONENT_UPDATE,
+	SHOVELER_SERVER_MESSAGE_TYPE_CREATE_ENTITY_REQUEST,
+	SHOVELER_SERVER_MESSAGE_TYPE_COMMAND_RESPONSE,
+	SHOVELER_SERVER_MESSAGE_TYPE_COMMAND_FAILURE,
+} ShovelerServerMessageType;
+
+typedef struct {
+	ShovelerServerMessageType type;
+	union {
+		struct {
+			Worker_EntityId entityId;
+			Worker_ComponentUpdate componentUpdate;
+		} componentUpdate;
+		struct {
+			uint32_t componentCount;
+			Worker_ComponentData *components;
+			bool hasEntityId;
+			Worker_EntityId entityId;
+		} createEntityRequest;
+		struct {
+			Worker_CommandResponse commandResponse;
+			/* static description of the command for error logging */
+			const char *commandName;
+		} commandResponse;
+		struct {
+			char *message;
+		} commandFailure;
+	};
+} ShovelerServerMessage;
+
+/**
+ * Messages sent while handling a single command request, buffered so that the handler doesn't need
+ * access to the connection and can run on another thread.
+ *
+ * Flushing sends the messages in the order they were added. If a create entity request fails to
+ * send, the remaining messages are dropped and a command failure is sent for the request instead,
+ * just like the handlers do when sending directly.
+ */
+typedef struct {
+	Worker_RequestId requestId;
+	/* array of ShovelerServerMessage */
+	GArray *messages;
+} ShovelerServerOutbox;
+
+void shovelerServerOutboxInit(ShovelerServerOutbox *outbox, Worker_RequestId requestId);
+/** Takes ownership of the update's schema object. */
+void shovelerServerOutboxAddComponentUpdate(ShovelerServerOutbox *outbox, Worker_EntityId entityId, Worker_ComponentUpdate *componentUpdate);
+/** Takes ownership of the components' schema objects, but not of the passed array. */
+void shovelerServerOutboxAddCreateEntityRequest(ShovelerServerOutbox *outbox, uint32_t componentCount, const Worker_ComponentData *components, const Worker_EntityId *entityId);
+/** Takes ownership of the response's schema object. */
+void shovelerServerOutboxAddCommandResponse(ShovelerServerOutbox *outbox, Worker_CommandResponse *commandResponse, const char *commandName);
+void shovelerServerOutboxAddCommandFailure(ShovelerServerOutbox *outbox, const char *message);
+/** Sends all buffered messages in order and frees the outbox contents. */
+void shovelerServerOutboxFlush(ShovelerServerOutbox *outbox, Worker_Connection *connection, ShovelerServerMetrics *metrics);
+/** Frees the outbox contents without sending any of the buffered messages. */
+void shovelerServerOutboxDiscard(ShovelerServerOutbox *outbox);
+
+#endif
@@ -12,21 +12,27 @@
 #include <shoveler/connect.h>
 #include <shoveler/executor.h>
 #include <shoveler/log.h>
+#include <shoveler/map_layout.h>
 #include <shoveler/schema/base.h>
 #include <shoveler/spatialos_schema.h>
 #include <shoveler/types.h>
 #include <shoveler/worker_log.h>
 
+#include "client_index.h"
+#include "command_pipeline.h"
 #include "configuration.h"
+#include "heartbeat_wheel.h"
+#include "metrics.h"
+#include "outbox.h"
+#include "tile_store.h"
 
 static const int tickRateHz = 100;
 static const int64_t maxHeartbeatTimeoutMs = 5000;
 static const int clientCleanupTickRateHz = 2;
-static const int halfMapWidth = 100;
-static const int halfMapHeight = 100;
-static const int chunkSize = 10;
+static const int numChunkRows = shovelerWorkerMapNumChunkRows;
+static const int numChunkColumns = shovelerWorkerMapNumChunkColumns;
+static const int chunkSize = shovelerWorkerMapChunkSize;
 static const int64_t firstChunkEntityId = 12;
-static const int numPlayerPositionAttempts = 10;
 static const int64_t cubeDrawableEntityId = 2;
 static const int64_t pointDrawableEntityId = 4;
 static const int64_t characterAnimationTilesetEntityId = 5;
@@ -37,23 +43,22 @@ static const int64_t canvasEntityId = 9;
 static const int64_t serverPartitionEntityId = 1;
 static const uint32_t entityReservationBatchSize = 1;
 
-typedef struct {
-	GString *tilesetRows;
-	GString *tilesetColumns;
-	GString *tilesetIds;
-} TilemapTiles;
-
 typedef struct {
 	float colorHue;
 	float colorSaturation;
 } ClientInfo;
 
+typedef struct {
+	ShovelerWorkerPositionStream stream;
+	ShovelerServerClientIndexEntry indexEntry;
+} ClientPosition;
+
 typedef struct {
 	uint32_t componentId;
 	bool authoritative;
 	union {
-		TilemapTiles tilemapTiles;
 		ClientInfo clientInfo;
+		ClientPosition clientPosition;
 	};
 } Component;
 
@@ -66,6 +71,7 @@ typedef struct {
 	int64_t entityId;
 	char *workerId;
 	int64_t lastPong;
+	ShovelerServerHeartbeatEntry heartbeat;
 } Client;
 
 typedef struct {
@@ -73,6 +79,11 @@ typedef struct {
 	ShovelerServerConfiguration configuration;
 	GHashTable *entities;
 	GHashTable *clients;
+	ShovelerServerHeartbeatWheel *heartbeatWheel;
+	ShovelerServerMetrics *metrics;
+	ShovelerServerCommandPipeline *commandPipeline;
+	ShovelerServerTileStore *tileStore;
+	ShovelerServerClientIndex *clientIndex;
 	Worker_EntityId nextReservedEntityId;
 	int numReservedEntityIds;
 	int numAuthoritativeComponents;
@@ -83,34 +94,38 @@ typedef struct {
 } ServerContext;
 
 static void clientCleanupTick(void *contextPointer);
+static void flushMetricsTick(void *contextPointer);
+static void expireClient(ShovelerServerHeartbeatEntry *heartbeat, int64_t now, void *contextPointer);
 static void updateTickMetrics(ServerContext *context);
 static void onAddComponent(ServerContext *context, const Worker_AddComponentOp *op);
+static void onRemoveTilemapTiles(ServerContext *context, int64_t entityId);
 static void onComponentUpdate(ServerContext *context, const Worker_ComponentUpdateOp *op);
+static void updateClientPosition(ServerContext *context, int64_t entityId, Component *component, Schema_Object *fields);
 static void onAuthorityChange(ServerContext *context, const Worker_ComponentSetAuthorityChangeOp *op);
 static void onComponentAuthorityChange(ServerContext *context, const Worker_ComponentSetAuthorityChangeOp *op, Entity *entity, Worker_ComponentId componentId);
 static void onCreateEntityResponse(ServerContext *context, const Worker_CreateEntityResponseOp *op);
 static void onCommandRequest(ServerContext *context, const Worker_CommandRequestOp *op);
 static void onCreateClientEntityRequest(ServerContext *context, const Worker_CommandRequestOp *op);
-static void onClientSpawnCubeRequest(ServerContext *context, const Worker_CommandRequestOp *op);
-static void onDigHoleRequest(ServerContext *context, const Worker_CommandRequestOp *op);
-static void onUpdateResourceRequest(ServerContext *context, const Worker_CommandRequestOp *op);
+static void onClientSpawnCubeRequest(const Worker_CommandRequestOp *op, ShovelerServerOutbox *outbox, void *contextPointer);
+static void onDigHoleRequest(const Worker_CommandRequestOp *op, ShovelerServerOutbox *outbox, void *contextPointer);
+static void onUpdateResourceRequest(const Worker_CommandRequestOp *op, ShovelerServerOutbox *outbox, void *contextPointer);
+static int64_t getDigHoleShardKey(ServerContext *context, Schema_Object *requestObject);
+static bool getDigHolePosition(Schema_Object *requestObject, ShovelerVector2 *outputPosition);
 static Client *getOrCreateClient(ServerContext *context, int64_t entityId);
+static void updateClientLastPong(ServerContext *context, Client *client, int64_t lastPong);
 static ShovelerVector3 getNewPlayerPosition(ServerContext *context, Schema_Object *requestObject);
-static int64_t getChunkBackgroundEntityId(int chunkX, int chunkZ);
-static TilemapTiles *getChunkBackgroundTiles(ServerContext *context, int64_t chunkBackgroundEntityId);
-static ShovelerVector2 tileToWorld(int chunkX, int chunkZ, int tileX, int tileZ);
-static void worldToTile(double x, double z, int *outputChunkX, int *outputChunkZ, int *outputTileX, int *outputTileZ);
+static int collectLeastCrowdedChunkTiles(ServerContext *context, int minChunkX, int minChunkZ, int numChunksX, int numChunksZ, GArray *outputTiles);
+static bool isGrassTile(ShovelerMapTileData tileData, void *unused);
 static ShovelerVector3 remapImprobablePosition(const ShovelerVector3 *coordinates, bool isTiles);
 static ShovelerVector3 remapPosition(const ShovelerVector3 *coordinates, bool isTiles);
 static ShovelerVector4 colorFromHsv(float h, float s, float v);
+static void sendComponentUpdate(ServerContext *context, Worker_EntityId entityId, Worker_ComponentUpdate *componentUpdate);
 static void freeEntity(void *entityPointer);
 static void freeComponent(void *componentPointer);
 static void freeClient(void *clientPointer);
 
 int main(int argc, char **argv)
 {
-	srand(time(NULL));
-
 	if(argc != 5) {
 		fprintf(stderr, "Usage:\n\t%s LOG_FILE_LOCATION WORKER_ID HOSTNAME PORT", argv[0]);
 		return 1;
@@ -158,8 +173,26 @@ int main(int argc, char **argv)
 	ServerContext context;
 	context.connection = connection;
 	shovelerServerGetWorkerConfiguration(connection, &context.configuration);
+	if(context.configuration.randomSeed != 0) {
+		shovelerLogInfo("Using fixed random seed %d.", context.configuration.randomSeed);
+		srand((unsigned int) context.configuration.randomSeed);
+	} else {
+		srand(time(NULL));
+	}
 	context.entities = g_hash_table_new_full(g_int64_hash, g_int64_equal, /* key_destroy_func */ NULL, freeEntity);
 	context.clients = g_hash_table_new_full(g_int64_hash, g_int64_equal, /* key_destroy_func */ NULL, freeClient);
+	context.heartbeatWheel = shovelerServerHeartbeatWheelCreate(
+		/* slotDuration */ 1000000 / clientCleanupTickRateHz,
+		/* horizon */ 2 * 1000 * maxHeartbeatTimeoutMs, // includes the grace period of new clients
+		g_get_monotonic_time());
+	context.metrics = shovelerServerMetricsCreate(context.configuration.metricsFile, g_get_monotonic_time());
+	context.commandPipeline = shovelerServerCommandPipelineCreate(connection, context.metrics, context.configuration.commandThreads);
+	context.tileStore = shovelerServerTileStoreCreate(chunkSize, numChunkRows, numChunkColumns, firstChunkEntityId);
+	context.clientIndex = shovelerServerClientIndexCreate(
+		shovelerVector2(-0.5f * numChunkColumns * chunkSize, -0.5f * numChunkRows * chunkSize),
+		(float) chunkSize,
+		numChunkColumns,
+		numChunkRows);
 	context.nextReservedEntityId = 0;
 	context.numReservedEntityIds = 0;
 	context.numAuthoritativeComponents = 0;
@@ -192,12 +225,24 @@ int main(int argc, char **argv)
 	ShovelerExecutor *tickExecutor = shovelerExecutorCreateDirect();
 	int clientCleanupTickPeriod = (int) (1000.0 / (double) clientCleanupTickRateHz);
 	shovelerExecutorSchedulePeriodic(tickExecutor, 0, clientCleanupTickPeriod, clientCleanupTick, &context);
+	if(context.configuration.metricsFlushPeriodMs > 0) {
+		shovelerExecutorSchedulePeriodic(tickExecutor, context.configuration.metricsFlushPeriodMs, context.configuration.metricsFlushPeriodMs, flushMetricsTick, &context);
+	}
 
 	const uint32_t tickTimeoutMillis = 1000 / tickRateHz;
 	while(!context.disconnected) {
 		Worker_OpList *opList = Worker_Connection_GetOpList(connection, tickTimeoutMillis);
+		shovelerServerMetricsBeginTick(context.metrics, g_get_monotonic_time());
 		for(size_t i = 0; i < opList->op_count; ++i) {
 			Worker_Op *op = &opList->ops[i];
+			shovelerServerMetricsRecordOp(context.metrics, op->op_type);
+
+			if(op->op_type != WORKER_OP_TYPE_COMMAND_REQUEST) {
+				// commands still running on the pipeline might read state that this op changes
+				shovelerServerCommandPipelineDrain(context.commandPipeline);
+			}
+
+			int64_t handlerStart;
 			switch(op->op_type) {
 				case WORKER_OP_TYPE_DISCONNECT:
 					shovelerLogInfo("Disconnected from SpatialOS with code %d: %s", op->op.disconnect.connection_status_code, op->op.disconnect.reason);
@@ -220,6 +265,7 @@ int main(int argc, char **argv)
 					g_hash_table_insert(context.entities, &entity->entityId, entity);
 				} break;
 				case WORKER_OP_TYPE_REMOVE_ENTITY:
+					onRemoveTilemapTiles(&context, op->op.remove_entity.entity_id);
 					g_hash_table_remove(context.entities, &op->op.remove_entity.entity_id);
 					break;
 				case WORKER_OP_TYPE_RESERVE_ENTITY_IDS_RESPONSE:
@@ -253,7 +299,9 @@ int main(int argc, char **argv)
 					shovelerLogTrace("WORKER_OP_TYPE_ENTITY_QUERY_RESPONSE");
 					break;
 				case WORKER_OP_TYPE_ADD_COMPONENT:
+					handlerStart = g_get_monotonic_time();
 					onAddComponent(&context, &op->op.add_component);
+					shovelerServerMetricsRecordHandler(context.metrics, SHOVELER_SERVER_HANDLER_ADD_COMPONENT, g_get_monotonic_time() - handlerStart);
 					break;
 				case WORKER_OP_TYPE_REMOVE_COMPONENT: {
 					Entity *entity = g_hash_table_lookup(context.entities, &op->op.remove_component.entity_id);
@@ -265,13 +313,21 @@ int main(int argc, char **argv)
 						break;
 					}
 
+					if(op->op.remove_component.component_id == shovelerWorkerSchemaComponentIdTilemapTiles) {
+						onRemoveTilemapTiles(&context, op->op.remove_component.entity_id);
+					}
+
 					g_hash_table_remove(entity->components, &op->op.remove_component.component_id);
 				} break;
 				case WORKER_OP_TYPE_COMPONENT_SET_AUTHORITY_CHANGE:
+					handlerStart = g_get_monotonic_time();
 					onAuthorityChange(&context, &op->op.component_set_authority_change);
+					shovelerServerMetricsRecordHandler(context.metrics, SHOVELER_SERVER_HANDLER_AUTHORITY_CHANGE, g_get_monotonic_time() - handlerStart);
 					break;
 				case WORKER_OP_TYPE_COMPONENT_UPDATE:
+					handlerStart = g_get_monotonic_time();
 					onComponentUpdate(&context, &op->op.component_update);
+					shovelerServerMetricsRecordHandler(context.metrics, SHOVELER_SERVER_HANDLER_COMPONENT_UPDATE, g_get_monotonic_time() - handlerStart);
 					break;
 				case WORKER_OP_TYPE_COMMAND_REQUEST:
 					onCommandRequest(&context, &op->op.command_request);
@@ -306,6 +362,7 @@ int main(int argc, char **argv)
 					break;
 			}
 		}
+		shovelerServerCommandPipelineDrain(context.commandPipeline);
 		Worker_OpList_Destroy(opList);
 
 		shovelerExecutorUpdateNow(tickExecutor);
@@ -318,13 +375,21 @@ int main(int argc, char **argv)
 		}
 
 		updateTickMetrics(&context);
+		shovelerServerMetricsEndTick(context.metrics, g_get_monotonic_time());
 	}
 	shovelerLogInfo("Exiting main loop, goodbye.");
 
+	shovelerServerCommandPipelineFree(context.commandPipeline);
 	Worker_Connection_Destroy(connection);
+	shovelerServerTileStoreFree(context.tileStore);
 	shovelerExecutorFree(tickExecutor);
 	g_hash_table_destroy(context.entities);
 	g_hash_table_destroy(context.clients);
+	shovelerServerClientIndexFree(context.clientIndex);
+	shovelerServerHeartbeatWheelFree(context.heartbeatWheel);
+	shovelerServerMetricsFlush(context.metrics, g_get_monotonic_time());
+	shovelerServerMetricsFree(context.metrics);
+	shovelerServerClearWorkerConfiguration(&context.configuration);
 	shovelerLogTerminate();
 
 	return EXIT_SUCCESS;
@@ -335,26 +400,34 @@ static void clientCleanupTick(void *contextPointer)
 	ServerContext *context = contextPointer;
 
 	int64_t now = g_get_monotonic_time();
+	shovelerServerHeartbeatWheelExpire(context->heartbeatWheel, now, expireClient, context);
+	shovelerServerMetricsRecordHandler(context->metrics, SHOVELER_SERVER_HANDLER_CLIENT_CLEANUP, g_get_monotonic_time() - now);
+}
 
-	GHashTableIter iter;
-	uint64_t *entityId;
-	Client *client;
-	g_hash_table_iter_init(&iter, context->clients);
-	while(g_hash_table_iter_next(&iter, (gpointer *) &entityId, (gpointer *) &client)) {
-		int64_t diff = now - client->lastPong;
-		if(diff > 1000 * maxHeartbeatTimeoutMs) {
-			Worker_RequestId requestId = Worker_Connection_SendDeleteEntityRequest(context->connection, client->entityId, NULL);
+static void flushMetricsTick(void *contextPointer)
+{
+	ServerContext *context = contextPointer;
+	shovelerServerMetricsFlush(context->metrics, g_get_monotonic_time());
+}
 
-			shovelerLogWarning(
-				"Sent remove client entity %lld request %lld of worker %s because it exceeded the maximum heartbeat timeout of %lldms: Last pong = %lld, now = %lld.",
-				client->entityId,
-				requestId,
-				client->workerId,
-				maxHeartbeatTimeoutMs,
-				client->lastPong,
-				now);
-		}
-	}
+static void expireClient(ShovelerServerHeartbeatEntry *heartbeat, int64_t now, void *contextPointer)
+{
+	ServerContext *context = contextPointer;
+	Client *client = heartbeat->data;
+
+	Worker_RequestId requestId = Worker_Connection_SendDeleteEntityRequest(context->connection, client->entityId, NULL);
+
+	shovelerLogWarning(
+		"Sent remove client entity %lld request %lld of worker %s because it exceeded the maximum heartbeat timeout of %lldms: Last pong = %lld, now = %lld.",
+		client->entityId,
+		requestId,
+		client->workerId,
+		maxHeartbeatTimeoutMs,
+		client->lastPong,
+		now);
+
+	// retry after another timeout in case the client is still around by then
+	shovelerServerHeartbeatWheelSchedule(context->heartbeatWheel, heartbeat, now + 1000 * maxHeartbeatTimeoutMs);
 }
 
 static void updateTickMetrics(ServerContext *context)
@@ -397,40 +470,35 @@ static void onAddComponent(ServerContext *context, const Worker_AddComponentOp *
 
 	Schema_Object *fields = Schema_GetComponentDataFields(op->data.schema_type);
 
-	if(component->componentId == shovelerWorkerSchemaComponentIdTilemapTiles) {
-		component->tilemapTiles.tilesetColumns = g_string_new("");
-		component->tilemapTiles.tilesetRows = g_string_new("");
-		component->tilemapTiles.tilesetIds = g_string_new("");
-
-		uint32_t numTilesetColumns = Schema_GetBytesCount(fields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetColumns);
-		uint32_t numTilesetRows = Schema_GetBytesCount(fields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetRows);
-		uint32_t numTilesetIds = Schema_GetBytesCount(fields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetIds);
-		if (numTilesetColumns != 1 || numTilesetRows != 1 || numTilesetIds != 1) {
+	int chunkX, chunkZ;
+	if(component->componentId == shovelerWorkerSchemaComponentIdTilemapTiles
+		&& shovelerServerTileStoreGetBackgroundEntityChunk(context->tileStore, op->entity_id, &chunkX, &chunkZ)) {
+		if(!shovelerServerTileStoreLoadChunk(context->tileStore, chunkX, chunkZ, fields)) {
 			shovelerLogWarning(
-				"Received add entity %"PRId64" tilemap tiles component without tileset columns, rows or ids.",
-				op->entity_id);
-			return;
+				"Received add entity %"PRId64" tilemap tiles component without tileset columns, rows or ids for chunk (%d, %d).",
+				op->entity_id,
+				chunkX,
+				chunkZ);
 		}
-
-		uint32_t tilesetColumnsLength = Schema_GetBytesLength(fields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetColumns);
-		uint32_t tilesetRowsLength = Schema_GetBytesLength(fields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetRows);
-		uint32_t tilesetIdsLength = Schema_GetBytesLength(fields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetIds);
-
-		const uint8_t *tilesetColumnsBytes = Schema_GetBytes(fields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetColumns);
-		const uint8_t *tilesetRowsBytes = Schema_GetBytes(fields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetRows);
-		const uint8_t *tilesetIdsBytes = Schema_GetBytes(fields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetIds);
-
-		g_string_append_len(component->tilemapTiles.tilesetColumns, (const char *) tilesetColumnsBytes, tilesetColumnsLength);
-		g_string_append_len(component->tilemapTiles.tilesetRows, (const char *) tilesetRowsBytes, tilesetRowsLength);
-		g_string_append_len(component->tilemapTiles.tilesetIds, (const char *) tilesetIdsBytes, tilesetIdsLength);
 	} else if (component->componentId == shovelerWorkerSchemaComponentIdClientInfo) {
 		component->clientInfo.colorHue = Schema_GetFloat(fields, shovelerWorkerSchemaClientInfoFieldIdColorHue);
 		component->clientInfo.colorSaturation = Schema_GetFloat(fields, shovelerWorkerSchemaClientInfoFieldIdColorSaturation);
+	} else if(component->componentId == shovelerWorkerSchemaComponentIdPosition) {
+		shovelerServerClientIndexEntryInit(&component->clientPosition.indexEntry, op->entity_id);
+		updateClientPosition(context, op->entity_id, component, fields);
 	}
 
 	g_hash_table_insert(entity->components, &component->componentId, component);
 }
 
+static void onRemoveTilemapTiles(ServerContext *context, int64_t entityId)
+{
+	int chunkX, chunkZ;
+	if(shovelerServerTileStoreGetBackgroundEntityChunk(context->tileStore, entityId, &chunkX, &chunkZ)) {
+		shovelerServerTileStoreUnloadChunk(context->tileStore, chunkX, chunkZ);
+	}
+}
+
 static void onComponentUpdate(ServerContext *context, const Worker_ComponentUpdateOp *op)
 {
 	Entity *entity = g_hash_table_lookup(context->entities, &op->entity_id);
@@ -465,14 +533,40 @@ static void onComponentUpdate(ServerContext *context, const Worker_ComponentUpda
 		Schema_Object *pongFields = Schema_GetComponentUpdateFields(pongComponentUpdate.schema_type);
 		Schema_AddInt64(pongFields, shovelerWorkerSchemaClientHeartbeatPongFieldIdLastUpdatedTime, lastUpdatedTime);
 
-		Worker_Connection_SendComponentUpdate(context->connection, op->entity_id, &pongComponentUpdate);
+		sendComponentUpdate(context, op->entity_id, &pongComponentUpdate);
 
 		Client *client = getOrCreateClient(context, op->entity_id);
-		client->lastPong = g_get_monotonic_time();
+		updateClientLastPong(context, client, g_get_monotonic_time());
 		shovelerLogTrace("Reflected client %"PRId64" heartbeat pong update.", op->entity_id);
+	} else if(op->update.component_id == shovelerWorkerSchemaComponentIdPosition) {
+		updateClientPosition(context, op->entity_id, component, fields);
 	}
 }
 
+/** Moves the client in the client index if the position fields carry new coordinates. */
+static void updateClientPosition(ServerContext *context, int64_t entityId, Component *component, Schema_Object *fields)
+{
+	ShovelerVector3 coordinates;
+	if(!shovelerWorkerSchemaGetPositionQuantizedCoordinates(fields, &component->clientPosition.stream, &coordinates)) {
+		Schema_Object *coordinatesObject = Schema_GetObject(fields, shovelerWorkerSchemaPositionFieldIdCoordinates);
+		if(coordinatesObject == NULL) {
+			return;
+		}
+
+		coordinates = shovelerVector3(
+			Schema_GetFloat(coordinatesObject, shovelerWorkerSchemaVector3FieldIdX),
+			Schema_GetFloat(coordinatesObject, shovelerWorkerSchemaVector3FieldIdY),
+			Schema_GetFloat(coordinatesObject, shovelerWorkerSchemaVector3FieldIdZ));
+	}
+
+	// the ground plane of tiles is spanned by the first two coordinates, the one of lights by the first and last
+	ShovelerVector2 groundPosition = context->configuration.gameType == SHOVELER_WORKER_GAME_TYPE_TILES
+		? shovelerVector2(coordinates.values[0], coordinates.values[1])
+		: shovelerVector2(coordinates.values[0], coordinates.values[2]);
+	shovelerServerClientIndexUpdate(context->clientIndex, &component->clientPosition.indexEntry, groundPosition);
+	shovelerLogTrace("Updated client %"PRId64" index position to (%.2f, %.2f).", entityId, groundPosition.values[0], groundPosition.values[1]);
+}
+
 static void onAuthorityChange(ServerContext *context, const Worker_ComponentSetAuthorityChangeOp *op)
 {
 	Entity *entity = g_hash_table_lookup(context->entities, &op->entity_id);
@@ -532,7 +626,7 @@ static void onComponentAuthorityChange(ServerContext *context, const Worker_Comp
 	if(component->componentId == shovelerWorkerSchemaComponentIdClientHeartbeatPong) {
 		if(component->authoritative) {
 			Client *client = getOrCreateClient(context, op->entity_id);
-			client->lastPong = g_get_monotonic_time() + 1000 * maxHeartbeatTimeoutMs;
+			updateClientLastPong(context, client, g_get_monotonic_time() + 1000 * maxHeartbeatTimeoutMs);
 			shovelerLogInfo("Added authoritative client %lld, last pong initialized with grace period to %lld.", op->entity_id, client->lastPong);
 		} else {
 			g_hash_table_remove(context->clients, &op->entity_id);
@@ -561,18 +655,43 @@ static void onCommandRequest(ServerContext *context, const Worker_CommandRequest
 		return;
 	}
 
+	// commands are sharded by the entity or chunk whose state they touch
+	Schema_Object *requestObject = Schema_GetCommandRequestObject(op->request.schema_type);
 	switch(op->request.command_index) {
-		case shovelerWorkerSchemaBootstrapCommandIdCreateClientEntity:
+		case shovelerWorkerSchemaBootstrapCommandIdCreateClientEntity: {
+			// consumes reserved entity IDs and rolls positions across all chunks, so it runs alone
+			shovelerServerCommandPipelineDrain(context->commandPipeline);
+
+			int64_t handlerStart = g_get_monotonic_time();
 			onCreateClientEntityRequest(context, op);
-			break;
+			shovelerServerMetricsRecordHandler(context->metrics, SHOVELER_SERVER_HANDLER_CREATE_CLIENT_ENTITY, g_get_monotonic_time() - handlerStart);
+		} break;
 		case shovelerWorkerSchemaBootstrapCommandIdClientSpawnCube:
-			onClientSpawnCubeRequest(context, op);
+			shovelerServerCommandPipelineDispatch(
+				context->commandPipeline,
+				Schema_GetEntityId(requestObject, shovelerWorkerSchemaClientSpawnCubeRequestFieldIdClient),
+				SHOVELER_SERVER_HANDLER_CLIENT_SPAWN_CUBE,
+				onClientSpawnCubeRequest,
+				op,
+				context);
 			break;
 		case shovelerWorkerSchemaBootstrapCommandIdDigHole:
-			onDigHoleRequest(context, op);
+			shovelerServerCommandPipelineDispatch(
+				context->commandPipeline,
+				getDigHoleShardKey(context, requestObject),
+				SHOVELER_SERVER_HANDLER_DIG_HOLE,
+				onDigHoleRequest,
+				op,
+				context);
 			break;
 		case shovelerWorkerSchemaBootstrapCommandIdUpdateResource:
-			onUpdateResourceRequest(context, op);
+			shovelerServerCommandPipelineDispatch(
+				context->commandPipeline,
+				Schema_GetEntityId(requestObject, shovelerWorkerSchemaUpdateResourceRequestFieldIdResource),
+				SHOVELER_SERVER_HANDLER_UPDATE_RESOURCE,
+				onUpdateResourceRequest,
+				op,
+				context);
 			break;
 	}
 }
@@ -738,8 +857,10 @@ static void onCreateClientEntityRequest(ServerContext *context, const Worker_Com
 	}
 }
 
-static void onClientSpawnCubeRequest(ServerContext *context, const Worker_CommandRequestOp *op)
+static void onClientSpawnCubeRequest(const Worker_CommandRequestOp *op, ShovelerServerOutbox *outbox, void *contextPointer)
 {
+	ServerContext *context = contextPointer;
+
 	shovelerLogInfo("Received client spawn cube request from %"PRId64".", op->caller_worker_entity_id);
 
 	Schema_Object *requestObject = Schema_GetCommandRequestObject(op->request.schema_type);
@@ -748,7 +869,7 @@ static void onClientSpawnCubeRequest(ServerContext *context, const Worker_Comman
 	Entity *clientEntity = g_hash_table_lookup(context->entities, &clientEntityId);
 	if(clientEntity == NULL) {
 		shovelerLogWarning("Received client spawn cube from %"PRId64" for unknown client entity %"PRId64", ignoring.", op->caller_worker_entity_id, clientEntityId);
-		Worker_Connection_SendCommandFailure(context->connection, op->request_id, "unknown client entity");
+		shovelerServerOutboxAddCommandFailure(outbox, "unknown client entity");
 		return;
 	}
 
@@ -756,7 +877,7 @@ static void onClientSpawnCubeRequest(ServerContext *context, const Worker_Comman
 	Component *clientInfoComponent = g_hash_table_lookup(clientEntity->components, &clientInfoComponentId);
 	if(clientInfoComponent == NULL) {
 		shovelerLogWarning("Received client spawn cube from %"PRId64" for client entity %"PRId64" without client info component, ignoring.", op->caller_worker_entity_id, clientEntityId);
-		Worker_Connection_SendCommandFailure(context->connection, op->request_id, "no client info component");
+		shovelerServerOutboxAddCommandFailure(outbox, "no client info component");
 		return;
 	}
 
@@ -765,7 +886,7 @@ static void onClientSpawnCubeRequest(ServerContext *context, const Worker_Comman
 	Schema_Object *rotationObject = Schema_GetObject(requestObject, shovelerWorkerSchemaClientSpawnCubeRequestFieldIdRotation);
 	if(positionObject == NULL || directionObject == NULL || rotationObject == NULL) {
 		shovelerLogWarning("Client spawn cube request doesn't contain position, direction and rotation - ignoring.");
-		Worker_Connection_SendCommandFailure(context->connection, op->request_id, "no position, direction and rotation");
+		shovelerServerOutboxAddCommandFailure(outbox, "no position, direction and rotation");
 		return;
 	}
 
@@ -806,35 +927,23 @@ static void onClientSpawnCubeRequest(ServerContext *context, const Worker_Comman
 		/* castsShadow */ true,
 		shovelerWorkerSchemaPolygonModeFill);
 
-	Worker_RequestId createEntityRequestId = Worker_Connection_SendCreateEntityRequest(
-		context->connection,
+	shovelerServerOutboxAddCreateEntityRequest(
+		outbox,
 		sizeof(cubeEntityComponentData) / sizeof(cubeEntityComponentData[0]),
 		cubeEntityComponentData,
-		/* entity_id */ NULL,
-		/* timeout_millis */ NULL);
-	if(createEntityRequestId == -1) {
-		shovelerLogError("Failed to send create entity request.");
-		Worker_Connection_SendCommandFailure(context->connection, op->request_id, "entity creation failure");
-		return;
-	}
-
-	shovelerLogInfo("Sent create entity request %"PRId64"", createEntityRequestId);
+		/* entityId */ NULL);
 
 	Worker_CommandResponse commandResponse;
 	commandResponse.component_id = op->request.component_id;
 	commandResponse.command_index = op->request.command_index;
 	commandResponse.schema_type = Schema_CreateCommandResponse();
 
-	int8_t result = Worker_Connection_SendCommandResponse(context->connection, op->request_id, &commandResponse);
-	if(result == WORKER_RESULT_FAILURE) {
-		shovelerLogError("Failed to send client spawn cube response.");
-	}
+	shovelerServerOutboxAddCommandResponse(outbox, &commandResponse, "client spawn cube");
 }
 
-static void onDigHoleRequest(ServerContext *context, const Worker_CommandRequestOp *op)
+static void onDigHoleRequest(const Worker_CommandRequestOp *op, ShovelerServerOutbox *outbox, void *contextPointer)
 {
-	const int numChunkColumns = 2 * halfMapWidth / chunkSize;
-	const int numChunkRows = 2 * halfMapHeight / chunkSize;
+	ServerContext *context = contextPointer;
 
 	shovelerLogInfo("Received dig hole request from %"PRId64".", op->caller_worker_entity_id);
 
@@ -844,84 +953,55 @@ static void onDigHoleRequest(ServerContext *context, const Worker_CommandRequest
 	Entity *clientEntity = g_hash_table_lookup(context->entities, &clientEntityId);
 	if(clientEntity == NULL) {
 		shovelerLogWarning("Received dig hole request from %"PRId64" for unknown client entity %"PRId64", ignoring.", op->caller_worker_entity_id, clientEntityId);
-		Worker_Connection_SendCommandFailure(context->connection, op->request_id, "unknown client entity");
+		shovelerServerOutboxAddCommandFailure(outbox, "unknown client entity");
 		return;
 	}
 
-	Schema_Object *positionObject = Schema_GetObject(requestObject, shovelerWorkerSchemaDigHoleRequestFieldIdPosition);
-	if(positionObject == NULL) {
+	ShovelerVector2 position;
+	if(!getDigHolePosition(requestObject, &position)) {
 		shovelerLogWarning("Dig hole request doesn't contain position - ignoring.");
-		Worker_Connection_SendCommandFailure(context->connection, op->request_id, "no position");
+		shovelerServerOutboxAddCommandFailure(outbox, "no position");
 		return;
 	}
 
-	ShovelerVector3 requestPosition = shovelerVector3(
-		Schema_GetFloat(positionObject, shovelerWorkerSchemaVector3FieldIdX),
-		Schema_GetFloat(positionObject, shovelerWorkerSchemaVector3FieldIdY),
-		Schema_GetFloat(positionObject, shovelerWorkerSchemaVector3FieldIdZ));
-
-	ShovelerVector3 improbablePosition = remapPosition(&requestPosition, /* isTiles */ true);
-
-	double x = improbablePosition.values[0];
-	double z = improbablePosition.values[2];
-	int chunkX, chunkZ, tileX, tileZ;
-	worldToTile(x, z, &chunkX, &chunkZ, &tileX, &tileZ);
-
-	if(chunkX < 0 || chunkX >= numChunkColumns || chunkZ < 0 || chunkZ >= numChunkRows || tileX < 0 || tileX >= chunkSize || tileZ < 0 || tileZ >= chunkSize) {
-		shovelerLogWarning("Received dig hole request from %s for client entity %"PRId64" which is out of range at (%f, %f), ignoring.", op->caller_worker_entity_id, clientEntityId, x, z);
-		Worker_Connection_SendCommandFailure(context->connection, op->request_id, "out of range");
+	ShovelerMapTileCoordinate tile = shovelerMapWorldToTile(&context->tileStore->map->dimensions, position);
+	if(!shovelerMapIsTileInBounds(&context->tileStore->map->dimensions, tile)) {
+		shovelerLogWarning("Received dig hole request from %"PRId64" for client entity %"PRId64" which is out of range at (%f, %f), ignoring.", op->caller_worker_entity_id, clientEntityId, position.values[0], position.values[1]);
+		shovelerServerOutboxAddCommandFailure(outbox, "out of range");
 		return;
 	}
 
-	int64_t chunkBackgroundEntityId = getChunkBackgroundEntityId(chunkX, chunkZ);
-	TilemapTiles *tiles = getChunkBackgroundTiles(context, chunkBackgroundEntityId);
-	if(tiles == NULL) {
-		shovelerLogError("Received dig hole request from %"PRId64" for client entity %"PRId64", but failed to resolve chunk background entity %lld tilemap tiles.", op->caller_worker_entity_id, clientEntityId, chunkBackgroundEntityId);
-		Worker_Connection_SendCommandFailure(context->connection, op->request_id, "no background tilemap tiles");
+	int64_t chunkBackgroundEntityId = shovelerServerTileStoreGetChunkBackgroundEntityId(context->tileStore, tile.chunkX, tile.chunkY);
+	if(!shovelerServerTileStoreIsChunkLoaded(context->tileStore, tile.chunkX, tile.chunkY)) {
+		shovelerLogError("Received dig hole request from %"PRId64" for client entity %"PRId64", but failed to resolve chunk background entity %"PRId64" tilemap tiles.", op->caller_worker_entity_id, clientEntityId, chunkBackgroundEntityId);
+		shovelerServerOutboxAddCommandFailure(outbox, "no background tilemap tiles");
 		return;
 	}
 
-	char *tilesetColumn = &tiles->tilesetColumns->str[tileZ * chunkSize + tileX];
-	char *tilesetRows = &tiles->tilesetRows->str[tileZ * chunkSize + tileX];
-	char *tilesetIds = &tiles->tilesetIds->str[tileZ * chunkSize + tileX];
-	if(*tilesetColumn > 2) {
+	ShovelerMapTileData tileData = shovelerServerTileStoreLookupTile(context->tileStore, tile);
+	if(!isGrassTile(tileData, NULL)) {
 		shovelerLogWarning("Received dig hole request from %"PRId64" for client entity %"PRId64", but its current tile is not grass.", op->caller_worker_entity_id, clientEntityId);
-		Worker_Connection_SendCommandFailure(context->connection, op->request_id, "not grass");
+		shovelerServerOutboxAddCommandFailure(outbox, "not grass");
 		return;
 	}
 
-	*tilesetColumn = 6;
-	*tilesetRows = 1;
-	*tilesetIds = 2;
-
-	Worker_ComponentUpdate tilemapTilesUpdate;
-	tilemapTilesUpdate.component_id = shovelerWorkerSchemaComponentIdTilemapTiles;
-	tilemapTilesUpdate.schema_type = Schema_CreateComponentUpdate();
-	Schema_Object *tilemapTilesFields = Schema_GetComponentUpdateFields(tilemapTilesUpdate.schema_type);
-	uint8_t *tilesetColumnsBuffer = Schema_AllocateBuffer(tilemapTilesFields, tiles->tilesetColumns->len);
-	uint8_t *tilesetRowsBuffer = Schema_AllocateBuffer(tilemapTilesFields, tiles->tilesetRows->len);
-	uint8_t *tilesetIdsBuffer = Schema_AllocateBuffer(tilemapTilesFields, tiles->tilesetIds->len);
-	memcpy(tilesetColumnsBuffer, tiles->tilesetColumns->str, tiles->tilesetColumns->len);
-	memcpy(tilesetRowsBuffer, tiles->tilesetRows->str, tiles->tilesetRows->len);
-	memcpy(tilesetIdsBuffer, tiles->tilesetIds->str, tiles->tilesetIds->len);
-	Schema_AddBytes(tilemapTilesFields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetColumns, tilesetColumnsBuffer, tiles->tilesetColumns->len);
-	Schema_AddBytes(tilemapTilesFields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetRows, tilesetRowsBuffer, tiles->tilesetRows->len);
-	Schema_AddBytes(tilemapTilesFields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetIds, tilesetIdsBuffer, tiles->tilesetIds->len);
-
-	Worker_Connection_SendComponentUpdate(context->connection, chunkBackgroundEntityId, &tilemapTilesUpdate);
+	tileData.tilesetColumn = 6;
+	tileData.tilesetRow = 1;
+	tileData.tilesetId = 2;
+	shovelerServerTileStoreWriteTile(context->tileStore, tile, tileData);
+
+	Worker_ComponentUpdate tilemapTilesUpdate = shovelerServerTileStoreCreateTilemapTilesUpdate(context->tileStore, tile.chunkX, tile.chunkY);
+	shovelerServerOutboxAddComponentUpdate(outbox, chunkBackgroundEntityId, &tilemapTilesUpdate);
 
 	Worker_CommandResponse commandResponse;
 	commandResponse.component_id = op->request.component_id;
 	commandResponse.command_index = op->request.command_index;
 	commandResponse.schema_type = Schema_CreateCommandResponse();
 
-	int8_t result = Worker_Connection_SendCommandResponse(context->connection, op->request_id, &commandResponse);
-	if(result == WORKER_RESULT_FAILURE) {
-		shovelerLogError("Failed to send dig hole response.");
-	}
+	shovelerServerOutboxAddCommandResponse(outbox, &commandResponse, "dig hole");
 }
 
-static void onUpdateResourceRequest(ServerContext *context, const Worker_CommandRequestOp *op)
+static void onUpdateResourceRequest(const Worker_CommandRequestOp *op, ShovelerServerOutbox *outbox, void *contextPointer)
 {
 	shovelerLogInfo("Received update resource from %"PRId64".", op->caller_worker_entity_id);
 
@@ -931,7 +1011,7 @@ static void onUpdateResourceRequest(ServerContext *context, const Worker_Command
 	uint32_t contentCount = Schema_GetBytesCount(requestObject, shovelerWorkerSchemaUpdateResourceRequestFieldIdContent);
 	if(contentCount == 0) {
 		shovelerLogWarning("Received update resource request from %"PRId64" for resource entity %"PRId64", but no content was provided.", op->caller_worker_entity_id, resourceEntityId);
-		Worker_Connection_SendCommandFailure(context->connection, op->request_id, "no content");
+		shovelerServerOutboxAddCommandFailure(outbox, "no content");
 		return;
 	}
 
@@ -946,17 +1026,46 @@ static void onUpdateResourceRequest(ServerContext *context, const Worker_Command
 	memcpy(resourceBuffer, contentBytes, contentLength);
 	Schema_AddBytes(resourceFields, shovelerWorkerSchemaResourceFieldIdBuffer, resourceBuffer, contentLength);
 
-	Worker_Connection_SendComponentUpdate(context->connection, resourceEntityId, &resourceUpdate);
+	shovelerServerOutboxAddComponentUpdate(outbox, resourceEntityId, &resourceUpdate);
 
 	Worker_CommandResponse commandResponse;
 	commandResponse.component_id = op->request.component_id;
 	commandResponse.command_index = op->request.command_index;
 	commandResponse.schema_type = Schema_CreateCommandResponse();
 
-	int8_t result = Worker_Connection_SendCommandResponse(context->connection, op->request_id, &commandResponse);
-	if(result == WORKER_RESULT_FAILURE) {
-		shovelerLogError("Failed to send update resource response.");
+	shovelerServerOutboxAddCommandResponse(outbox, &commandResponse, "update resource");
+}
+
+static int64_t getDigHoleShardKey(ServerContext *context, Schema_Object *requestObject)
+{
+	ShovelerVector2 position;
+	if(!getDigHolePosition(requestObject, &position)) {
+		return 0; // rejected without touching any chunk
+	}
+
+	ShovelerMapTileCoordinate tile = shovelerMapWorldToTile(&context->tileStore->map->dimensions, position);
+	if(!shovelerMapIsTileInBounds(&context->tileStore->map->dimensions, tile)) {
+		return 0; // rejected without touching any chunk
 	}
+
+	return shovelerServerTileStoreGetChunkBackgroundEntityId(context->tileStore, tile.chunkX, tile.chunkY);
+}
+
+static bool getDigHolePosition(Schema_Object *requestObject, ShovelerVector2 *outputPosition)
+{
+	Schema_Object *positionObject = Schema_GetObject(requestObject, shovelerWorkerSchemaDigHoleRequestFieldIdPosition);
+	if(positionObject == NULL) {
+		return false;
+	}
+
+	ShovelerVector3 requestPosition = shovelerVector3(
+		Schema_GetFloat(positionObject, shovelerWorkerSchemaVector3FieldIdX),
+		Schema_GetFloat(positionObject, shovelerWorkerSchemaVector3FieldIdY),
+		Schema_GetFloat(positionObject, shovelerWorkerSchemaVector3FieldIdZ));
+	ShovelerVector3 improbablePosition = remapPosition(&requestPosition, /* isTiles */ true);
+
+	*outputPosition = shovelerVector2(improbablePosition.values[0], improbablePosition.values[2]);
+	return true;
 }
 
 static Client *getOrCreateClient(ServerContext *context, int64_t entityId)
@@ -967,6 +1076,7 @@ static Client *getOrCreateClient(ServerContext *context, int64_t entityId)
 		client->entityId = entityId;
 		client->workerId = NULL;
 		client->lastPong = 0;
+		shovelerServerHeartbeatEntryInit(&client->heartbeat, client);
 
 		g_hash_table_insert(context->clients, &client->entityId, client);
 
@@ -976,105 +1086,94 @@ static Client *getOrCreateClient(ServerContext *context, int64_t entityId)
 	return client;
 }
 
+static void updateClientLastPong(ServerContext *context, Client *client, int64_t lastPong)
+{
+	client->lastPong = lastPong;
+	shovelerServerHeartbeatWheelSchedule(context->heartbeatWheel, &client->heartbeat, lastPong + 1000 * maxHeartbeatTimeoutMs);
+}
+
 static ShovelerVector3 getNewPlayerPosition(ServerContext *context, Schema_Object *requestObject)
 {
 	if(context->configuration.gameType == SHOVELER_WORKER_GAME_TYPE_LIGHTS) {
 		return shovelerVector3(0.0f, 5.0f, 0.0f);
 	}
 
-	for(int i = 0; i < numPlayerPositionAttempts; i++) {
-		int minX = 9;
-		int minZ = 9;
-		int sizeX = 2;
-		int sizeZ = 2;
-		if(Schema_GetObjectCount(requestObject, shovelerWorkerSchemaCreateClientEntityRequestFieldIdStartingChunkRegion) != 0) {
-			Schema_Object *startingChunkRegion = Schema_GetObject(requestObject, shovelerWorkerSchemaCreateClientEntityRequestFieldIdStartingChunkRegion);
-
-			minX = Schema_GetInt32(startingChunkRegion, shovelerWorkerSchemaChunkRegionFieldIdMinX);
-			minZ = Schema_GetInt32(startingChunkRegion, shovelerWorkerSchemaChunkRegionFieldIdMaxX);
-			sizeX = Schema_GetInt32(startingChunkRegion, shovelerWorkerSchemaChunkRegionFieldIdSizeX);
-			sizeZ = Schema_GetInt32(startingChunkRegion, shovelerWorkerSchemaChunkRegionFieldIdSizeZ);
-			shovelerLogInfo("Overriding starting chunk region to min (%d, %d) and size (%d, %d).", minX, minZ, sizeX, sizeZ);
-		}
-
-		int startingChunkX = minX + (rand() % sizeX);
-		int startingChunkZ = minZ + (rand() % sizeZ);
-
-		int64_t backgroundChunkEntityId = getChunkBackgroundEntityId(startingChunkX, startingChunkZ);
-
-		TilemapTiles *tilemapTiles = getChunkBackgroundTiles(context, backgroundChunkEntityId);
-		if(!tilemapTiles) {
-			shovelerLogWarning("Failed to find chunk background tiles on entity %"PRId64".", backgroundChunkEntityId);
-			continue;
-		}
+	int minX = 9;
+	int minZ = 9;
+	int sizeX = 2;
+	int sizeZ = 2;
+	if(Schema_GetObjectCount(requestObject, shovelerWorkerSchemaCreateClientEntityRequestFieldIdStartingChunkRegion) != 0) {
+		Schema_Object *startingChunkRegion = Schema_GetObject(requestObject, shovelerWorkerSchemaCreateClientEntityRequestFieldIdStartingChunkRegion);
+
+		minX = Schema_GetInt32(startingChunkRegion, shovelerWorkerSchemaChunkRegionFieldIdMinX);
+		minZ = Schema_GetInt32(startingChunkRegion, shovelerWorkerSchemaChunkRegionFieldIdMaxX);
+		sizeX = Schema_GetInt32(startingChunkRegion, shovelerWorkerSchemaChunkRegionFieldIdSizeX);
+		sizeZ = Schema_GetInt32(startingChunkRegion, shovelerWorkerSchemaChunkRegionFieldIdSizeZ);
+		shovelerLogInfo("Overriding starting chunk region to min (%d, %d) and size (%d, %d).", minX, minZ, sizeX, sizeZ);
+	}
 
-		int startingTileX = rand() % 10;
-		int startingTileZ = rand() % 10;
-		unsigned char tilesetColumn = tilemapTiles->tilesetColumns->str[startingTileZ * chunkSize + startingTileX];
-		if(tilesetColumn > 2) { // not grass
-			continue;
-		}
+	// pick uniformly among all free tiles of the region's least crowded chunks rather than rolling tiles until one is free
+	GArray *grassTiles = g_array_new(/* zeroTerminated */ false, /* clear */ false, sizeof(ShovelerMapTileCoordinate));
+	int numNearbyClients = collectLeastCrowdedChunkTiles(context, minX, minZ, sizeX, sizeZ, grassTiles);
+	if(grassTiles->len == 0 && numNearbyClients >= 0) {
+		shovelerLogInfo("Least crowded chunks of the starting chunk region have no free tiles, falling back to all of its chunks.");
+		shovelerServerTileStoreCollectTiles(context->tileStore, minX, minZ, sizeX, sizeZ, isGrassTile, /* userData */ NULL, grassTiles);
+	}
 
-		ShovelerVector2 worldPosition2 = tileToWorld(startingChunkX, startingChunkZ, startingTileX, startingTileZ);
-		shovelerLogInfo("Rolled new player position in tile (%d, %d) of chunk (%d, %d) after %d iterations: (%.2f, %.2f)", startingTileX, startingTileZ, startingChunkX, startingChunkZ, i + 1, worldPosition2.values[0], worldPosition2.values[1]);
+	if(grassTiles->len == 0) {
+		g_array_free(grassTiles, /* freeSegment */ true);
+		shovelerLogInfo("Using default position because the starting chunk region has no free tiles.");
+		return shovelerVector3(0.5f, 5.0f, 0.5f);
+	}
 
-		int chunkX, chunkZ, tileX, tileZ;
-		worldToTile(worldPosition2.values[0] + 0.5, worldPosition2.values[1] + 0.5, &chunkX, &chunkZ, &tileX, &tileZ);
-		shovelerLogInfo("Back translation: tile (%d, %d) chunk (%d, %d)", tileX, tileZ, chunkX, chunkZ);
+	guint numGrassTiles = grassTiles->len;
+	ShovelerMapTileCoordinate tile = g_array_index(grassTiles, ShovelerMapTileCoordinate, rand() % numGrassTiles);
+	g_array_free(grassTiles, /* freeSegment */ true);
 
-		return shovelerVector3(worldPosition2.values[0] + 0.5f, 5.0f, worldPosition2.values[1] + 0.5f);
-	}
+	ShovelerVector2 worldPosition2 = shovelerMapTileToWorld(&context->tileStore->map->dimensions, tile);
+	shovelerLogInfo("Rolled new player position in tile (%d, %d) of chunk (%d, %d) out of %u free tiles, least crowded chunks hold %d clients: (%.2f, %.2f)", tile.tileX, tile.tileY, tile.chunkX, tile.chunkY, numGrassTiles, numNearbyClients, worldPosition2.values[0], worldPosition2.values[1]);
 
-	shovelerLogInfo("Using default position after %d failed attempts to roll new player position.", numPlayerPositionAttempts);
-	return shovelerVector3(0.5f, 5.0f, 0.5f);
+	return shovelerVector3(worldPosition2.values[0] + 0.5f, 5.0f, worldPosition2.values[1] + 0.5f);
 }
 
-static int64_t getChunkBackgroundEntityId(int chunkX, int chunkZ)
+/**
+ * Appends the free tiles of the loaded chunks in the region that hold the fewest clients to
+ * outputTiles, and returns that number of clients, or -1 if none of them is loaded. The appended
+ * tiles can be empty if these chunks have no free tiles.
+ */
+static int collectLeastCrowdedChunkTiles(ServerContext *context, int minChunkX, int minChunkZ, int numChunksX, int numChunksZ, GArray *outputTiles)
 {
-	const int numChunkColumns = 2 * halfMapWidth / chunkSize;
-	const int numChunkRows = 2 * halfMapHeight / chunkSize;
+	ShovelerMapDimensions *dimensions = &context->tileStore->map->dimensions;
 
-	if(chunkX < 0 || chunkX >= numChunkColumns || chunkZ < 0 || chunkZ >= numChunkRows) {
-		shovelerLogWarning("Cannot resolve chunk background entity id for out of range chunk at (%d, %d).", chunkX, chunkZ);
-		return 0;
-	}
+	int minNumClients = -1;
+	for(int chunkX = minChunkX; chunkX < minChunkX + numChunksX; chunkX++) {
+		for(int chunkZ = minChunkZ; chunkZ < minChunkZ + numChunksZ; chunkZ++) {
+			if(!shovelerServerTileStoreIsChunkLoaded(context->tileStore, chunkX, chunkZ)) {
+				continue;
+			}
 
-	return firstChunkEntityId + 3 * chunkX * numChunkColumns + 3 * chunkZ;
-}
+			ShovelerMapTileCoordinate chunkOrigin = {chunkX, chunkZ, 0, 0};
+			ShovelerVector2 chunkMin = shovelerMapTileToWorld(dimensions, chunkOrigin);
+			ShovelerVector2 chunkMax = shovelerVector2(chunkMin.values[0] + dimensions->chunkSize, chunkMin.values[1] + dimensions->chunkSize);
+			int numClients = shovelerServerClientIndexQueryBox(context->clientIndex, chunkMin, chunkMax, /* visit */ NULL, /* userData */ NULL);
 
-static TilemapTiles *getChunkBackgroundTiles(ServerContext *context, int64_t chunkBackgroundEntityId)
-{
-	Entity *entity = g_hash_table_lookup(context->entities, &chunkBackgroundEntityId);
-	if(entity == NULL) {
-		return NULL;
-	}
+			if(minNumClients < 0 || numClients < minNumClients) {
+				minNumClients = numClients;
+				g_array_set_size(outputTiles, 0);
+			}
 
-	int32_t componentId = shovelerWorkerSchemaComponentIdTilemapTiles;
-	Component *component = g_hash_table_lookup(entity->components, &componentId);
-	if(component == NULL) {
-		return NULL;
+			if(numClients == minNumClients) {
+				shovelerServerTileStoreCollectTiles(context->tileStore, chunkX, chunkZ, /* numChunksX */ 1, /* numChunksZ */ 1, isGrassTile, /* userData */ NULL, outputTiles);
+			}
+		}
 	}
 
-	return &component->tilemapTiles;
-}
-
-static ShovelerVector2 tileToWorld(int chunkX, int chunkZ, int tileX, int tileZ)
-{
-	return shovelerVector2(
-		(float) (-halfMapWidth + chunkX * chunkSize + tileX),
-		(float) (-halfMapHeight + chunkZ * chunkSize + tileZ));
+	return minNumClients;
 }
 
-static void worldToTile(double x, double z, int *outputChunkX, int *outputChunkZ, int *outputTileX, int *outputTileZ)
+static bool isGrassTile(ShovelerMapTileData tileData, void *unused)
 {
-	double diffX = x + halfMapWidth;
-	double diffZ = z + halfMapHeight;
-
-	*outputChunkX = (int) floor(diffX / chunkSize);
-	*outputChunkZ = (int) floor(diffZ / chunkSize);
-
-	*outputTileX = (int) floor(diffX - *outputChunkX * chunkSize);
-	*outputTileZ = (int) floor(diffZ - *outputChunkZ * chunkSize);
+	return tileData.tilesetColumn <= 2;
 }
 
 static ShovelerVector3 remapImprobablePosition(const ShovelerVector3 *coordinates, bool isTiles)
@@ -1115,6 +1214,15 @@ static ShovelerVector4 colorFromHsv(float h, float s, float v)
 	return shovelerVector4(colorFloat.values[0], colorFloat.values[1], colorFloat.values[2], 1.0f);
 }
 
+static void sendComponentUpdate(ServerContext *context, Worker_EntityId entityId, Worker_ComponentUpdate *componentUpdate)
+{
+	// measure before sending since the connection takes ownership of the update
+	Schema_Object *fields = Schema_GetComponentUpdateFields(componentUpdate->schema_type);
+	shovelerServerMetricsRecordComponentUpdateSent(context->metrics, Schema_GetWriteBufferLength(fields));
+
+	Worker_Connection_SendComponentUpdate(context->connection, entityId, componentUpdate);
+}
+
 static void freeEntity(void *entityPointer)
 {
 	Entity *entity = entityPointer;
@@ -1125,19 +1233,16 @@ static void freeEntity(void *entityPointer)
 static void freeComponent(void *componentPointer)
 {
 	Component *component = componentPointer;
-
-	if(component->componentId == shovelerWorkerSchemaComponentIdTilemapTiles) {
-		g_string_free(component->tilemapTiles.tilesetRows, /* free_segment */ true);
-		g_string_free(component->tilemapTiles.tilesetColumns, /* free_segment */ true);
-		g_string_free(component->tilemapTiles.tilesetIds, /* free_segment */ true);
+	if(component->componentId == shovelerWorkerSchemaComponentIdPosition) {
+		shovelerServerClientIndexEntryRemove(&component->clientPosition.indexEntry);
 	}
-
 	free(component);
 }
 
 static void freeClient(void *clientPointer)
 {
 	Client *client = clientPointer;
+	shovelerServerHeartbeatEntryCancel(&client->heartbeat);
 	free(client->workerId);
 	free(client);
 }
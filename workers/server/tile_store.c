@@ -0,0 +1,144 @@
+#include "tile_store.h"
+
+#include <stdlib.h> // malloc free
+#include <string.h> // memcpy
+
+#include <shoveler/log.h>
+#include <shoveler/spatialos_schema.h>
+
+static bool copyTilemapTilesField(Schema_Object *tilemapTilesFields, Schema_FieldId fieldId, int numTiles, unsigned char *outputTiles);
+static void addTilemapTilesField(Schema_Object *tilemapTilesFields, Schema_FieldId fieldId, int numTiles, const unsigned char *tiles);
+
+ShovelerServerTileStore *shovelerServerTileStoreCreate(int chunkSize, int numChunkRows, int numChunkColumns, int64_t firstChunkEntityId)
+{
+	ShovelerServerTileStore *tileStore = malloc(sizeof(ShovelerServerTileStore));
+	tileStore->map = shovelerMapCreate(chunkSize, numChunkRows, numChunkColumns);
+	tileStore->firstChunkEntityId = firstChunkEntityId;
+	tileStore->chunkLoaded = calloc(numChunkRows * numChunkColumns, sizeof(bool));
+
+	return tileStore;
+}
+
+bool shovelerServerTileStoreGetBackgroundEntityChunk(ShovelerServerTileStore *tileStore, int64_t entityId, int *outputChunkX, int *outputChunkZ)
+{
+	ShovelerMapDimensions *dimensions = &tileStore->map->dimensions;
+
+	int64_t diff = entityId - tileStore->firstChunkEntityId;
+	if(diff < 0 || diff % 3 != 0) {
+		return false;
+	}
+
+	int64_t chunkIndex = diff / 3;
+	if(chunkIndex >= dimensions->numChunkRows * dimensions->numChunkColumns) {
+		return false;
+	}
+
+	*outputChunkX = (int) (chunkIndex / dimensions->numChunkRows);
+	*outputChunkZ = (int) (chunkIndex % dimensions->numChunkRows);
+	return true;
+}
+
+int64_t shovelerServerTileStoreGetChunkBackgroundEntityId(ShovelerServerTileStore *tileStore, int chunkX, int chunkZ)
+{
+	ShovelerMapDimensions *dimensions = &tileStore->map->dimensions;
+
+	if(chunkX < 0 || chunkX >= dimensions->numChunkColumns || chunkZ < 0 || chunkZ >= dimensions->numChunkRows) {
+		shovelerLogWarning("Cannot resolve chunk background entity id for out of range chunk at (%d, %d).", chunkX, chunkZ);
+		return 0;
+	}
+
+	// the seeder creates background, foreground and chunk entities for each chunk in turn
+	return tileStore->firstChunkEntityId + 3 * (chunkX * dimensions->numChunkRows + chunkZ);
+}
+
+bool shovelerServerTileStoreLoadChunk(ShovelerServerTileStore *tileStore, int chunkX, int chunkZ, Schema_Object *tilemapTilesFields)
+{
+	int chunkSize = tileStore->map->dimensions.chunkSize;
+	int numTiles = chunkSize * chunkSize;
+	ShovelerMapChunk *chunk = shovelerMapGetChunk(tileStore->map, chunkX, chunkZ);
+
+	if(!copyTilemapTilesField(tilemapTilesFields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetColumns, numTiles, chunk->backgroundTiles.tilesetColumns)
+		|| !copyTilemapTilesField(tilemapTilesFields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetRows, numTiles, chunk->backgroundTiles.tilesetRows)
+		|| !copyTilemapTilesField(tilemapTilesFields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetIds, numTiles, chunk->backgroundTiles.tilesetIds)) {
+		shovelerServerTileStoreUnloadChunk(tileStore, chunkX, chunkZ);
+		return false;
+	}
+
+	tileStore->chunkLoaded[chunkX * tileStore->map->dimensions.numChunkRows + chunkZ] = true;
+	return true;
+}
+
+void shovelerServerTileStoreUnloadChunk(ShovelerServerTileStore *tileStore, int chunkX, int chunkZ)
+{
+	tileStore->chunkLoaded[chunkX * tileStore->map->dimensions.numChunkRows + chunkZ] = false;
+}
+
+int shovelerServerTileStoreCollectTiles(ShovelerServerTileStore *tileStore, int minChunkX, int minChunkZ, int numChunksX, int numChunksZ, ShovelerMapTilePredicate *predicate, void *userData, GArray *outputTiles)
+{
+	int numCollected = 0;
+	for(int chunkX = minChunkX; chunkX < minChunkX + numChunksX; chunkX++) {
+		for(int chunkZ = minChunkZ; chunkZ < minChunkZ + numChunksZ; chunkZ++) {
+			if(!shovelerServerTileStoreIsChunkLoaded(tileStore, chunkX, chunkZ)) {
+				continue;
+			}
+
+			numCollected += shovelerMapCollectTiles(
+				tileStore->map,
+				chunkX,
+				chunkZ,
+				/* numChunksX */ 1,
+				/* numChunksY */ 1,
+				/* background */ true,
+				predicate,
+				userData,
+				outputTiles);
+		}
+	}
+
+	return numCollected;
+}
+
+Worker_ComponentUpdate shovelerServerTileStoreCreateTilemapTilesUpdate(ShovelerServerTileStore *tileStore, int chunkX, int chunkZ)
+{
+	int chunkSize = tileStore->map->dimensions.chunkSize;
+	int numTiles = chunkSize * chunkSize;
+	ShovelerMapChunk *chunk = shovelerMapGetChunk(tileStore->map, chunkX, chunkZ);
+
+	Worker_ComponentUpdate tilemapTilesUpdate;
+	tilemapTilesUpdate.component_id = shovelerWorkerSchemaComponentIdTilemapTiles;
+	tilemapTilesUpdate.schema_type = Schema_CreateComponentUpdate();
+	Schema_Object *tilemapTilesFields = Schema_GetComponentUpdateFields(tilemapTilesUpdate.schema_type);
+	addTilemapTilesField(tilemapTilesFields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetColumns, numTiles, chunk->backgroundTiles.tilesetColumns);
+	addTilemapTilesField(tilemapTilesFields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetRows, numTiles, chunk->backgroundTiles.tilesetRows);
+	addTilemapTilesField(tilemapTilesFields, shovelerWorkerSchemaTilemapTilesFieldIdTilesetIds, numTiles, chunk->backgroundTiles.tilesetIds);
+
+	return tilemapTilesUpdate;
+}
+
+void shovelerServerTileStoreFree(ShovelerServerTileStore *tileStore)
+{
+	free(tileStore->chunkLoaded);
+	shovelerMapFree(tileStore->map);
+	free(tileStore);
+}
+
+static bool copyTilemapTilesField(Schema_Object *tilemapTilesFields, Schema_FieldId fieldId, int numTiles, unsigned char *outputTiles)
+{
+	if(Schema_GetBytesCount(tilemapTilesFields, fieldId) != 1) {
+		return false;
+	}
+
+	if(Schema_GetBytesLength(tilemapTilesFields, fieldId) != (uint32_t) numTiles) {
+		return false;
+	}
+
+	memcpy(outputTiles, Schema_GetBytes(tilemapTilesFields, fieldId), numTiles);
+	return true;
+}
+
+static void addTilemapTilesField(Schema_Object *tilemapTilesFields, Schema_FieldId fieldId, int numTiles, const unsigned char *tiles)
+{
+	uint8_t *buffer = Schema_AllocateBuffer(tilemapTilesFields, (uint32_t) numTiles);
+	memcpy(buffer, tiles, numTiles);
+	Schema_AddBytes(tilemapTilesFields, fieldId, buffer, (uint32_t) numTiles);
+}
@@ -0,0 +1,68 @@
+#ifndef SHOVELER_SERVER_TILE_STORE_H
+#define SHOVELER_SERVER_TILE_STORE_H
+
+#include <stdbool.h> // bool
+#include <stdint.h> // int64_t
+
+#include <improbable/c_schema.h>
+#include <improbable/c_worker.h>
+#include <shoveler/map.h>
+
+/**
+ * Authoritative copy of the background tiles of all chunks in the world, laid out as a ShovelerMap.
+ *
+ * Each chunk is stored in the contiguous tile arrays of its ShovelerMapChunk, so looking up or
+ * writing a tile is O(1) from its coordinate, chunk tiles can be serialized in bulk, and queries
+ * over many tiles scan the arrays directly. Chunks only count as loaded once the tilemap tiles
+ * component of their background entity was received. Colliders aren't part of that component and
+ * are left zeroed.
+ *
+ * Writes to different chunks don't interfere, so handlers can modify tiles concurrently as long as
+ * no two of them touch the same chunk.
+ */
+typedef struct {
+	ShovelerMap *map;
+	/* entity ID of the background entity of chunk (0, 0), followed by each chunk's foreground and chunk entities */
+	int64_t firstChunkEntityId;
+	/* indexed like the map's chunks */
+	bool *chunkLoaded;
+} ShovelerServerTileStore;
+
+ShovelerServerTileStore *shovelerServerTileStoreCreate(int chunkSize, int numChunkRows, int numChunkColumns, int64_t firstChunkEntityId);
+/** Returns the chunk whose background entity has the given ID, or false if it isn't one. */
+bool shovelerServerTileStoreGetBackgroundEntityChunk(ShovelerServerTileStore *tileStore, int64_t entityId, int *outputChunkX, int *outputChunkZ);
+int64_t shovelerServerTileStoreGetChunkBackgroundEntityId(ShovelerServerTileStore *tileStore, int chunkX, int chunkZ);
+/** Copies the chunk's tiles out of tilemap tiles component fields, failing if they don't cover the chunk. */
+bool shovelerServerTileStoreLoadChunk(ShovelerServerTileStore *tileStore, int chunkX, int chunkZ, Schema_Object *tilemapTilesFields);
+void shovelerServerTileStoreUnloadChunk(ShovelerServerTileStore *tileStore, int chunkX, int chunkZ);
+/**
+ * Appends the coordinates of all tiles in loaded chunks of the given region that match the
+ * predicate to outputTiles, an array of ShovelerMapTileCoordinate. Returns the number of appended
+ * tiles.
+ */
+int shovelerServerTileStoreCollectTiles(ShovelerServerTileStore *tileStore, int minChunkX, int minChunkZ, int numChunksX, int numChunksZ, ShovelerMapTilePredicate *predicate, void *userData, GArray *outputTiles);
+/** Creates a tilemap tiles update carrying all of the chunk's tiles. */
+Worker_ComponentUpdate shovelerServerTileStoreCreateTilemapTilesUpdate(ShovelerServerTileStore *tileStore, int chunkX, int chunkZ);
+void shovelerServerTileStoreFree(ShovelerServerTileStore *tileStore);
+
+static inline bool shovelerServerTileStoreIsChunkLoaded(ShovelerServerTileStore *tileStore, int chunkX, int chunkZ)
+{
+	ShovelerMapDimensions *dimensions = &tileStore->map->dimensions;
+	if(chunkX < 0 || chunkX >= dimensions->numChunkColumns || chunkZ < 0 || chunkZ >= dimensions->numChunkRows) {
+		return false;
+	}
+
+	return tileStore->chunkLoaded[chunkX * dimensions->numChunkRows + chunkZ];
+}
+
+static inline ShovelerMapTileData shovelerServerTileStoreLookupTile(ShovelerServerTileStore *tileStore, ShovelerMapTileCoordinate tile)
+{
+	return shovelerMapLookupTile(tileStore->map, tile, /* background */ true);
+}
+
+static inline void shovelerServerTileStoreWriteTile(ShovelerServerTileStore *tileStore, ShovelerMapTileCoordinate tile, ShovelerMapTileData tileData)
+{
+	shovelerMapWriteTile(tileStore->map, tile, /* background */ true, tileData);
+}
+
+#endif